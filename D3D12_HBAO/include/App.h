@@ -18,6 +18,7 @@
 #include <gfx/asdxRootSignature.h>
 #include <gfx/asdxPipelineState.h>
 #include <gfx/asdxConstantBuffer.h>
+#include <MeshBatcher.h>
 
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -71,6 +72,8 @@ private:
     };
 
     std::vector<Mesh>       m_Meshes;
+    Mesh                    m_BatchedMesh;
+    std::vector<MeshBatch>  m_Batches;
     asdx::RootSignature     m_RootSig;
     asdx::PipelineState     m_SimplePSO;
     asdx::PipelineState     m_SsaoPSO;
@@ -90,9 +93,12 @@ private:
     float m_Intensity       = 2.0f;
     float m_Bias            = 0.0f;
     float m_BlurSharpenss   = 1.0f;
+    bool  m_EnableBatch     = true;
+    float m_DrawTime        = 0.0f;
+    UINT  m_DrawCount       = 0;
 
     //=============================================================================================
     // private methods.
     //=============================================================================================
-
+    bool InitMesh(const ResMesh& mesh, Mesh& result);
 };
@@ -0,0 +1,295 @@
+﻿//-----------------------------------------------------------------------------
+// File : MeshBatcher.h
+// Desc : Static Mesh Batcher.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include <cfloat>
+#include <MeshLoader.h>
+
+
+///////////////////////////////////////////////////////////////////////////////
+// MeshBatch structure
+///////////////////////////////////////////////////////////////////////////////
+struct MeshBatch
+{
+    uint64_t        SortKey;        // ソートキー(上位32bit:パイプラインキー, 下位32bit:マテリアルID).
+    uint32_t        PipelineKey;    // パイプラインキー.
+    uint32_t        MaterialId;     // マテリアルID.
+    uint32_t        IndexOffset;    // 結合したインデックスの先頭からのオフセット(StartIndexLocation).
+    uint32_t        IndexCount;     // インデックス数.
+    uint32_t        BaseVertex;     // インデックスに加算する頂点番号(BaseVertexLocation).
+    uint32_t        VertexCount;    // 頂点数.
+    uint32_t        MeshCount;      // 結合した元のメッシュ数.
+    asdx::Vector3   BoundsMin;      // バウンディングボックスの最小値.
+    asdx::Vector3   BoundsMax;      // バウンディングボックスの最大値.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// BatchedModel structure
+///////////////////////////////////////////////////////////////////////////////
+struct BatchedModel
+{
+    ResMesh                     Mesh;               // 全バッチの頂点・インデックスを結合したメッシュ.
+    std::vector<MeshBatch>      Batches;            // ソート済みの描画リスト.
+    uint32_t                    SourceDrawCount;    // 結合前の描画数.
+
+    //-------------------------------------------------------------------------
+    //! @brief      破棄処理を行います.
+    //-------------------------------------------------------------------------
+    void Dispose()
+    {
+        Mesh.Dispose();
+
+        Batches.clear();
+        Batches.shrink_to_fit();
+
+        SourceDrawCount = 0;
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// MeshBatcher class
+///////////////////////////////////////////////////////////////////////////////
+class MeshBatcher
+{
+    //=========================================================================
+    // list of friend classes and methods.
+    //=========================================================================
+    /* NOTHING */
+
+public:
+    //=========================================================================
+    // public variables.
+    //=========================================================================
+    /* NOTHING */
+
+    //=========================================================================
+    // public methods.
+    //=========================================================================
+
+    //-------------------------------------------------------------------------
+    //! @brief      マテリアルとパイプラインが同じメッシュを結合します.
+    //!
+    //! @param[in]      model           結合するモデルです.
+    //! @param[in]      pTransforms     メッシュごとのワールド行列です(nullptrの場合は単位行列).
+    //! @param[in]      pPipelineKeys   メッシュごとのパイプラインキーです(nullptrの場合は全て0).
+    //! @param[out]     result          結合結果の格納先です.
+    //! @retval true    結合に成功.
+    //! @retval false   結合に失敗.
+    //! @note       頂点は事前にワールド変換するため, 描画時は単位行列を使用します.
+    //!             描画リストはパイプラインキー, マテリアルIDの順にソートします.
+    //!             いずれかのメッシュが持つ属性は全頂点に格納し, 持たないメッシュは既定値で埋めます.
+    //!             鏡像変換を含むワールド行列のメッシュは, 三角形の巻き順を入れ替えて表裏を保ちます.
+    //-------------------------------------------------------------------------
+    static bool Build
+    (
+        const ResModel&         model,
+        const asdx::Matrix*     pTransforms,
+        const uint32_t*         pPipelineKeys,
+        BatchedModel&           result
+    )
+    {
+        result.Dispose();
+        result.Mesh.Name       = model.Name;
+        result.SourceDrawCount = 0;
+
+        // 空メッシュを除いてソートキーでまとめる.
+        struct Entry
+        {
+            uint64_t    SortKey;
+            uint32_t    MeshIndex;
+        };
+
+        std::vector<Entry> entries;
+        entries.reserve(model.Meshes.size());
+
+        auto hasNormal   = false;
+        auto hasTangent  = false;
+        auto hasColor    = false;
+        bool hasTexCoord[4] = {};
+
+        for(size_t i=0; i<model.Meshes.size(); ++i)
+        {
+            const auto& mesh = model.Meshes[i];
+            if (mesh.Positions.empty() || mesh.Indices.empty())
+            { continue; }
+
+            auto vertexCount = mesh.Positions.size();
+            for(size_t j=0; j<mesh.Indices.size(); ++j)
+            {
+                if (mesh.Indices[j] >= vertexCount)
+                { return false; }
+            }
+
+            hasNormal  |= (mesh.Normals .size() == vertexCount);
+            hasTangent |= (mesh.Tangents.size() == vertexCount);
+            hasColor   |= (mesh.Colors  .size() == vertexCount);
+            for(auto j=0; j<4; ++j)
+            { hasTexCoord[j] |= (mesh.TexCoords[j].size() == vertexCount); }
+
+            auto pipelineKey = (pPipelineKeys != nullptr) ? pPipelineKeys[i] : 0u;
+
+            Entry entry;
+            entry.SortKey   = (uint64_t(pipelineKey) << 32) | mesh.MaterialId;
+            entry.MeshIndex = uint32_t(i);
+            entries.push_back(entry);
+
+            result.SourceDrawCount++;
+        }
+
+        // 同じキー内では元の順番を保つ.
+        std::stable_sort(entries.begin(), entries.end(),
+            [](const Entry& a, const Entry& b) { return a.SortKey < b.SortKey; });
+
+        auto& dst = result.Mesh;
+        dst.MaterialId = UINT32_MAX;
+
+        for(size_t i=0; i<entries.size(); ++i)
+        {
+            const auto& entry = entries[i];
+            const auto& mesh  = model.Meshes[entry.MeshIndex];
+
+            auto vertexStart = dst.Positions.size();
+            if (vertexStart + mesh.Positions.size() > UINT32_MAX)
+            { return false; }
+
+            if (result.Batches.empty() || result.Batches.back().SortKey != entry.SortKey)
+            {
+                MeshBatch batch = {};
+                batch.SortKey     = entry.SortKey;
+                batch.PipelineKey = uint32_t(entry.SortKey >> 32);
+                batch.MaterialId  = mesh.MaterialId;
+                batch.IndexOffset = uint32_t(dst.Indices.size());
+                batch.BaseVertex  = uint32_t(vertexStart);
+                batch.BoundsMin   = asdx::Vector3( FLT_MAX,  FLT_MAX,  FLT_MAX);
+                batch.BoundsMax   = asdx::Vector3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+                result.Batches.push_back(batch);
+            }
+
+            auto& batch = result.Batches.back();
+
+            AppendVertices(
+                mesh,
+                (pTransforms != nullptr) ? &pTransforms[entry.MeshIndex] : nullptr,
+                hasNormal,
+                hasTangent,
+                hasColor,
+                hasTexCoord,
+                dst);
+
+            for(size_t j=vertexStart; j<dst.Positions.size(); ++j)
+            {
+                batch.BoundsMin = asdx::Vector3::Min(batch.BoundsMin, dst.Positions[j]);
+                batch.BoundsMax = asdx::Vector3::Max(batch.BoundsMax, dst.Positions[j]);
+            }
+
+            // インデックスはバッチ先頭の頂点からの相対値にする.
+            auto offset = uint32_t(vertexStart) - batch.BaseVertex;
+            auto start  = dst.Indices.size();
+            for(size_t j=0; j<mesh.Indices.size(); ++j)
+            { dst.Indices.push_back(mesh.Indices[j] + offset); }
+
+            // 鏡像変換(行列式が負)では巻き順が反転するので, 三角形ごとに2頂点を入れ替えて戻す.
+            if (pTransforms != nullptr && pTransforms[entry.MeshIndex].Determinant() < 0.0f)
+            {
+                for(auto j=start; j+2<dst.Indices.size(); j+=3)
+                { std::swap(dst.Indices[j + 1], dst.Indices[j + 2]); }
+            }
+
+            batch.IndexCount  += uint32_t(mesh.Indices.size());
+            batch.VertexCount += uint32_t(mesh.Positions.size());
+            batch.MeshCount++;
+        }
+
+        return true;
+    }
+
+private:
+    //=========================================================================
+    // private variables.
+    //=========================================================================
+    /* NOTHING */
+
+    //=========================================================================
+    // private methods.
+    //=========================================================================
+
+    //-------------------------------------------------------------------------
+    //      ワールド変換した頂点を追加します.
+    //-------------------------------------------------------------------------
+    static void AppendVertices
+    (
+        const ResMesh&          mesh,
+        const asdx::Matrix*     pTransform,
+        bool                    hasNormal,
+        bool                    hasTangent,
+        bool                    hasColor,
+        const bool*             hasTexCoord,
+        ResMesh&                dst
+    )
+    {
+        auto vertexCount = mesh.Positions.size();
+
+        // 法線は逆転置行列で変換する.
+        auto world  = (pTransform != nullptr) ? *pTransform : asdx::Matrix::CreateIdentity();
+        auto normal = asdx::Matrix::Transpose(asdx::Matrix::Invert(world));
+        auto identity = (pTransform == nullptr) || asdx::Matrix::IsIdentity(world);
+
+        for(size_t i=0; i<vertexCount; ++i)
+        {
+            auto p = mesh.Positions[i];
+            if (!identity)
+            { p = asdx::Vector3::Transform(p, world); }
+            dst.Positions.push_back(p);
+        }
+
+        if (hasNormal)
+        {
+            auto exist = (mesh.Normals.size() == vertexCount);
+            for(size_t i=0; i<vertexCount; ++i)
+            {
+                auto n = (exist) ? mesh.Normals[i] : asdx::Vector3(0.0f, 1.0f, 0.0f);
+                if (exist && !identity)
+                { n = asdx::Vector3::SafeNormalize(asdx::Vector3::TransformNormal(n, normal), n); }
+                dst.Normals.push_back(n);
+            }
+        }
+
+        if (hasTangent)
+        {
+            auto exist = (mesh.Tangents.size() == vertexCount);
+            for(size_t i=0; i<vertexCount; ++i)
+            {
+                auto t = (exist) ? mesh.Tangents[i] : asdx::Vector3(1.0f, 0.0f, 0.0f);
+                if (exist && !identity)
+                { t = asdx::Vector3::SafeNormalize(asdx::Vector3::TransformNormal(t, world), t); }
+                dst.Tangents.push_back(t);
+            }
+        }
+
+        if (hasColor)
+        {
+            auto exist = (mesh.Colors.size() == vertexCount);
+            for(size_t i=0; i<vertexCount; ++i)
+            { dst.Colors.push_back((exist) ? mesh.Colors[i] : asdx::Vector4(1.0f, 1.0f, 1.0f, 1.0f)); }
+        }
+
+        for(auto j=0; j<4; ++j)
+        {
+            if (!hasTexCoord[j])
+            { continue; }
+
+            auto exist = (mesh.TexCoords[j].size() == vertexCount);
+            for(size_t i=0; i<vertexCount; ++i)
+            { dst.TexCoords[j].push_back((exist) ? mesh.TexCoords[j][i] : asdx::Vector2(0.0f, 0.0f)); }
+        }
+    }
+};
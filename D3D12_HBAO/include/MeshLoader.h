@@ -11,11 +11,18 @@
 #include <cstdint>
 #include <vector>
 #include <string>
+#include <fstream>
+#include <cstring>
+#if __has_include(<fnd/asdxMath.h>)
+#include <fnd/asdxMath.h>   // asdx12 と同時に使う場合は同じ数学型を使用します.
+#else
 #include <asdxMath.h>
+#endif
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 #include <assimp/cimport.h>
+#include <assimp/DefaultIOSystem.h>
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -88,6 +95,162 @@ struct ResModel
     }
 };
 
+///////////////////////////////////////////////////////////////////////////////
+// MeshCacheString structure
+///////////////////////////////////////////////////////////////////////////////
+struct MeshCacheString
+{
+    uint64_t    Offset;     // ファイル先頭からのオフセット(終端文字を含む).
+    uint32_t    Length;     // 文字数(終端文字を含まない).
+    uint32_t    Reserved;   // 予約領域.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// MeshCacheMesh structure
+///////////////////////////////////////////////////////////////////////////////
+struct MeshCacheMesh
+{
+    MeshCacheString     Name;               // メッシュ名.
+    uint32_t            MaterialId;         // マテリアルID.
+    uint32_t            VertexCount;        // 頂点数.
+    uint32_t            IndexCount;         // インデックス数.
+    uint32_t            Reserved;           // 予約領域.
+    uint64_t            Positions;          // 頂点位置のオフセット.
+    uint64_t            Normals;            // 法線ベクトルのオフセット(無い場合は0).
+    uint64_t            Tangents;           // 接線ベクトルのオフセット(無い場合は0).
+    uint64_t            Colors;             // 頂点カラーのオフセット(無い場合は0).
+    uint64_t            TexCoords[4];       // テクスチャ座標のオフセット(無い場合は0).
+    uint64_t            Indices;            // 頂点インデックスのオフセット.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// MeshCacheDependency structure
+///////////////////////////////////////////////////////////////////////////////
+struct MeshCacheDependency
+{
+    MeshCacheString     Path;               // 依存ファイルのパス.
+    uint64_t            Time;               // 依存ファイルの更新日時.
+    uint64_t            Size;               // 依存ファイルのサイズ.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// MeshCacheHeader structure
+///////////////////////////////////////////////////////////////////////////////
+struct MeshCacheHeader
+{
+    uint32_t    Magic;              // マジック('MCHE').
+    uint32_t    Version;            // ファイルバージョン.
+    uint64_t    SourceTime;         // 元ファイルの更新日時.
+    uint64_t    SourceSize;         // 元ファイルのサイズ.
+    uint32_t    LoaderFlags;        // 読み込みに使用した aiPostProcessSteps.
+    uint32_t    MeshCount;          // メッシュ数.
+    uint32_t    MaterialCount;      // マテリアル数.
+    uint32_t    DependencyCount;    // 依存ファイル数.
+    uint64_t    MeshOffset;         // MeshCacheMesh 配列のオフセット.
+    uint64_t    MaterialOffset;     // マテリアル名(MeshCacheString)配列のオフセット.
+    uint64_t    DependencyOffset;   // MeshCacheDependency 配列のオフセット.
+    uint64_t    Reserved;           // 予約領域.
+    uint64_t    TotalSize;          // ファイル全体のサイズ.
+};
+
+static const uint32_t kMeshCacheMagic       = uint32_t('M')
+                                            | (uint32_t('C') << 8)
+                                            | (uint32_t('H') << 16)
+                                            | (uint32_t('E') << 24);
+static const uint32_t kMeshCacheVersion     = 3;
+static const uint64_t kMeshCacheAlignment   = 16;
+
+static_assert(sizeof(MeshCacheString)     == 16, "Invalid MeshCacheString Size.");
+static_assert(sizeof(MeshCacheMesh)       == 104, "Invalid MeshCacheMesh Size.");
+static_assert(sizeof(MeshCacheDependency) == 32, "Invalid MeshCacheDependency Size.");
+static_assert(sizeof(MeshCacheHeader)     == 80, "Invalid MeshCacheHeader Size.");
+
+
+///////////////////////////////////////////////////////////////////////////////
+// MappedView class
+///////////////////////////////////////////////////////////////////////////////
+class MappedView
+{
+public:
+    //-------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //-------------------------------------------------------------------------
+    MappedView() = default;
+
+    //-------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //-------------------------------------------------------------------------
+    ~MappedView()
+    { Close(); }
+
+    MappedView(const MappedView&) = delete;
+    MappedView& operator = (const MappedView&) = delete;
+
+    //-------------------------------------------------------------------------
+    //! @brief      ファイルを読み取り専用でメモリにマッピングします.
+    //-------------------------------------------------------------------------
+    bool Open(const char* path);
+
+    //-------------------------------------------------------------------------
+    //! @brief      マッピングを解除します.
+    //-------------------------------------------------------------------------
+    void Close();
+
+    //-------------------------------------------------------------------------
+    //! @brief      データの先頭ポインタを取得します(ページ境界にアライメントされています).
+    //-------------------------------------------------------------------------
+    const uint8_t* GetData() const
+    { return m_pData; }
+
+    //-------------------------------------------------------------------------
+    //! @brief      ファイルサイズを取得します.
+    //-------------------------------------------------------------------------
+    uint64_t GetSize() const
+    { return m_Size; }
+
+private:
+    const uint8_t*  m_pData     = nullptr;
+    uint64_t        m_Size      = 0;
+#if defined(_WIN32)
+    void*           m_hFile     = nullptr;  // HANDLE.
+    void*           m_hMapping  = nullptr;  // HANDLE.
+#else
+    int             m_File      = -1;
+#endif
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+// DependencyIOSystem class
+///////////////////////////////////////////////////////////////////////////////
+class DependencyIOSystem : public Assimp::DefaultIOSystem
+{
+public:
+    //-------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //!
+    //! @param[out]     pPaths      開いたファイルパスの格納先です.
+    //-------------------------------------------------------------------------
+    explicit DependencyIOSystem(std::vector<std::string>* pPaths)
+    : m_pPaths(pPaths)
+    { /* DO_NOTHING */ }
+
+    //-------------------------------------------------------------------------
+    //! @brief      ファイルを開き, そのパスを記録します.
+    //-------------------------------------------------------------------------
+    Assimp::IOStream* Open(const char* pFile, const char* pMode = "rb") override
+    {
+        auto pStream = Assimp::DefaultIOSystem::Open(pFile, pMode);
+        if (pStream != nullptr && m_pPaths != nullptr)
+        { m_pPaths->push_back(pFile); }
+
+        return pStream;
+    }
+
+private:
+    std::vector<std::string>*   m_pPaths = nullptr;
+};
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // MeshLoader class
@@ -103,7 +266,14 @@ public:
     //=========================================================================
     // public variables.
     //=========================================================================
-    /* NOTHING */
+    static const uint32_t kLoadFlags =
+          aiProcess_Triangulate
+        | aiProcess_PreTransformVertices
+        | aiProcess_CalcTangentSpace
+        | aiProcess_GenSmoothNormals
+        | aiProcess_GenUVCoords
+        | aiProcess_RemoveRedundantMaterials
+        | aiProcess_OptimizeMeshes;
 
     //=========================================================================
     // public methods.
@@ -113,24 +283,78 @@ public:
 
     //-------------------------------------------------------------------------
     //! @brief      モデルをロードします.
+    //!
+    //! @param[in]      path        モデルファイルのパスです.
+    //! @param[out]     model       モデルの格納先です.
+    //! @param[in]      useCache    キャッシュを使用するかどうか.
+    //! @note       useCache が true の場合, 元ファイルと assimp が開いた依存ファイル(マテリアルファイル等)の
+    //!             更新日時・サイズと読み込みフラグが一致するキャッシュ(path + ".cache")があれば
+    //!             assimp を使わずに読み込みます.
+    //!             一致しない場合は assimp で読み込み, キャッシュを作り直します.
+    //!             テクスチャはキャッシュの内容に影響しないため対象外です.
     //-------------------------------------------------------------------------
-    bool Load(const char* path, ResModel& model)
+    bool Load(const char* path, ResModel& model, bool useCache = true)
     {
         if (path == nullptr)
         { return false; }
 
+        if (!useCache)
+        { return Import(path, model, nullptr); }
+
+        uint64_t sourceTime = 0;
+        uint64_t sourceSize = 0;
+        if (!GetFileStamp(path, sourceTime, sourceSize))
+        { return false; }
+
+        std::string cachePath = path;
+        cachePath += ".cache";
+
+        if (LoadCache(cachePath.c_str(), sourceTime, sourceSize, model))
+        { return true; }
+
+        std::vector<std::string> dependencies;
+        if (!Import(path, model, &dependencies))
+        { return false; }
+
+        // キャッシュが書けなくてもロード自体は成功扱い.
+        SaveCache(cachePath.c_str(), sourceTime, sourceSize, dependencies, model);
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    //! @brief      ファイルの更新日時とサイズを取得します.
+    //! @note       ファイルの内容は読まないため, 起動ごとの判定コストはファイル数に比例します.
+    //-------------------------------------------------------------------------
+    static bool GetFileStamp(const char* path, uint64_t& time, uint64_t& size);
+
+private:
+    //=========================================================================
+    // private variables.
+    //=========================================================================
+    const aiScene*  m_pScene = nullptr;
+
+    //=========================================================================
+    // private methods.
+    //=========================================================================
+
+    //-------------------------------------------------------------------------
+    //! @brief      assimp でモデルを読み込みます.
+    //!
+    //! @param[in]      path            モデルファイルのパスです.
+    //! @param[out]     model           モデルの格納先です.
+    //! @param[out]     pDependencies   依存ファイルパスの格納先です(不要な場合は nullptr).
+    //-------------------------------------------------------------------------
+    bool Import(const char* path, ResModel& model, std::vector<std::string>* pDependencies)
+    {
         Assimp::Importer importer;
-        unsigned int flag = 0;
-        flag |= aiProcess_Triangulate;
-        flag |= aiProcess_PreTransformVertices;
-        flag |= aiProcess_CalcTangentSpace;
-        flag |= aiProcess_GenSmoothNormals;
-        flag |= aiProcess_GenUVCoords;
-        flag |= aiProcess_RemoveRedundantMaterials;
-        flag |= aiProcess_OptimizeMeshes;
+
+        // assimp が開いたファイルを記録(I/O システムの所有権は importer に移ります).
+        std::vector<std::string> openedPaths;
+        if (pDependencies != nullptr)
+        { importer.SetIOHandler(new DependencyIOSystem(&openedPaths)); }
 
         // ファイルを読み込み.
-        m_pScene = importer.ReadFile(path, flag);
+        m_pScene = importer.ReadFile(path, kLoadFlags);
 
         // チェック.
         if (m_pScene == nullptr)
@@ -158,6 +382,14 @@ public:
             model.MaterialNames[i] = name.C_Str();
         }
 
+        // 依存ファイルを収集.
+        if (pDependencies != nullptr)
+        {
+            pDependencies->clear();
+            for(size_t i=0; i<openedPaths.size(); ++i)
+            { AddDependency(*pDependencies, path, openedPaths[i]); }
+        }
+
         // 不要になったのでクリア.
         importer.FreeScene();
         m_pScene = nullptr;
@@ -166,15 +398,331 @@ public:
         return true;
     }
 
-private:
-    //=========================================================================
-    // private variables.
-    //=========================================================================
-    const aiScene*  m_pScene = nullptr;
+    //-------------------------------------------------------------------------
+    //! @brief      依存ファイルを追加します(元ファイルと重複は除外します).
+    //-------------------------------------------------------------------------
+    static void AddDependency(std::vector<std::string>& dependencies, const char* path, const std::string& dependency)
+    {
+        if (dependency == path)
+        { return; }
+
+        for(size_t i=0; i<dependencies.size(); ++i)
+        {
+            if (dependencies[i] == dependency)
+            { return; }
+        }
+
+        dependencies.push_back(dependency);
+    }
+
+    //-------------------------------------------------------------------------
+    //! @brief      キャッシュからモデルを読み込みます.
+    //-------------------------------------------------------------------------
+    bool LoadCache(const char* path, uint64_t sourceTime, uint64_t sourceSize, ResModel& model)
+    {
+        MappedView view;
+        if (!view.Open(path))
+        { return false; }
+
+        auto pBase = view.GetData();
+        auto size  = view.GetSize();
+        if (size < sizeof(MeshCacheHeader))
+        { return false; }
+
+        MeshCacheHeader header;
+        memcpy(&header, pBase, sizeof(header));
+
+        // 元ファイル・読み込み設定・破損をチェック.
+        if (header.Magic       != kMeshCacheMagic
+         || header.Version     != kMeshCacheVersion
+         || header.SourceTime  != sourceTime
+         || header.SourceSize  != sourceSize
+         || header.LoaderFlags != kLoadFlags
+         || header.TotalSize   != size)
+        { return false; }
+
+        if (!InRange(view, header.MeshOffset, uint64_t(header.MeshCount) * sizeof(MeshCacheMesh))
+         || !InRange(view, header.MaterialOffset, uint64_t(header.MaterialCount) * sizeof(MeshCacheString))
+         || !InRange(view, header.DependencyOffset, uint64_t(header.DependencyCount) * sizeof(MeshCacheDependency)))
+        { return false; }
+
+        auto pMeshes       = reinterpret_cast<const MeshCacheMesh*>(pBase + header.MeshOffset);
+        auto pMaterials    = reinterpret_cast<const MeshCacheString*>(pBase + header.MaterialOffset);
+        auto pDependencies = reinterpret_cast<const MeshCacheDependency*>(pBase + header.DependencyOffset);
+
+        // 依存ファイルが更新されていないかチェック.
+        for(uint32_t i=0; i<header.DependencyCount; ++i)
+        {
+            const auto& dependency = pDependencies[i];
+
+            std::string dependencyPath;
+            uint64_t    time = 0;
+            uint64_t    size = 0;
+            if (!ReadString(view, dependency.Path, dependencyPath)
+             || !GetFileStamp(dependencyPath.c_str(), time, size)
+             || time != dependency.Time
+             || size != dependency.Size)
+            { return false; }
+        }
+
+        model.Meshes.clear();
+        model.Meshes.resize(header.MeshCount);
+
+        for(uint32_t i=0; i<header.MeshCount; ++i)
+        {
+            const auto& src = pMeshes[i];
+            auto& dst = model.Meshes[i];
+
+            auto vertexCount = src.VertexCount;
+
+            dst.MaterialId = src.MaterialId;
+            if (!ReadString(view, src.Name, dst.Name)
+             || !ReadArray(view, src.Positions, vertexCount, dst.Positions)
+             || !ReadArray(view, src.Normals,   vertexCount, dst.Normals)
+             || !ReadArray(view, src.Tangents,  vertexCount, dst.Tangents)
+             || !ReadArray(view, src.Colors,    vertexCount, dst.Colors)
+             || !ReadArray(view, src.Indices,   src.IndexCount, dst.Indices))
+            {
+                model.Dispose();
+                return false;
+            }
+
+            for(auto c=0; c<4; ++c)
+            {
+                if (!ReadArray(view, src.TexCoords[c], vertexCount, dst.TexCoords[c]))
+                {
+                    model.Dispose();
+                    return false;
+                }
+            }
+        }
+
+        model.MaterialNames.resize(header.MaterialCount);
+        for(uint32_t i=0; i<header.MaterialCount; ++i)
+        {
+            if (!ReadString(view, pMaterials[i], model.MaterialNames[i]))
+            {
+                model.Dispose();
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    //! @brief      キャッシュを書き出します.
+    //! @note       セクションは kMeshCacheAlignment 境界に配置し, マッピングしたまま参照できる
+    //!             フラットなレイアウトで書き出します.
+    //!             読み取れない依存ファイルは記録しません.
+    //-------------------------------------------------------------------------
+    bool SaveCache
+    (
+        const char*                     path,
+        uint64_t                        sourceTime,
+        uint64_t                        sourceSize,
+        const std::vector<std::string>& dependencyPaths,
+        const ResModel&                 model
+    )
+    {
+        std::vector<MeshCacheDependency>    dependencies;
+        std::vector<std::string>            validPaths;
+        for(size_t i=0; i<dependencyPaths.size(); ++i)
+        {
+            MeshCacheDependency dependency = {};
+            if (!GetFileStamp(dependencyPaths[i].c_str(), dependency.Time, dependency.Size))
+            { continue; }
+
+            dependencies.push_back(dependency);
+            validPaths.push_back(dependencyPaths[i]);
+        }
+
+        auto meshCount       = uint32_t(model.Meshes.size());
+        auto materialCount   = uint32_t(model.MaterialNames.size());
+        auto dependencyCount = uint32_t(dependencies.size());
+
+        MeshCacheHeader header = {};
+        header.Magic          = kMeshCacheMagic;
+        header.Version        = kMeshCacheVersion;
+        header.SourceTime     = sourceTime;
+        header.SourceSize     = sourceSize;
+        header.LoaderFlags    = kLoadFlags;
+        header.MeshCount      = meshCount;
+        header.MaterialCount  = materialCount;
+        header.DependencyCount = dependencyCount;
+
+        // 先にレイアウトを決定.
+        uint64_t offset = Align(sizeof(MeshCacheHeader));
+        header.MeshOffset = offset;
+        offset = Align(offset + sizeof(MeshCacheMesh) * meshCount);
+        header.MaterialOffset = offset;
+        offset = Align(offset + sizeof(MeshCacheString) * materialCount);
+        header.DependencyOffset = offset;
+        offset = Align(offset + sizeof(MeshCacheDependency) * dependencyCount);
+
+        std::vector<MeshCacheMesh>   meshes   (meshCount);
+        std::vector<MeshCacheString> materials(materialCount);
+
+        for(uint32_t i=0; i<meshCount; ++i)
+        {
+            const auto& src = model.Meshes[i];
+            auto& dst = meshes[i];
+            memset(&dst, 0, sizeof(dst));
+
+            dst.MaterialId  = src.MaterialId;
+            dst.VertexCount = uint32_t(src.Positions.size());
+            dst.IndexCount  = uint32_t(src.Indices.size());
+            dst.Name        = PlaceString(src.Name, offset);
+            dst.Positions   = PlaceArray(src.Positions, offset);
+            dst.Normals     = PlaceArray(src.Normals,   offset);
+            dst.Tangents    = PlaceArray(src.Tangents,  offset);
+            dst.Colors      = PlaceArray(src.Colors,    offset);
+            for(auto c=0; c<4; ++c)
+            { dst.TexCoords[c] = PlaceArray(src.TexCoords[c], offset); }
+            dst.Indices     = PlaceArray(src.Indices, offset);
+        }
+
+        for(uint32_t i=0; i<materialCount; ++i)
+        { materials[i] = PlaceString(model.MaterialNames[i], offset); }
+
+        for(uint32_t i=0; i<dependencyCount; ++i)
+        { dependencies[i].Path = PlaceString(validPaths[i], offset); }
+
+        header.TotalSize = offset;
+
+        // 配置したオフセットに従ってバッファを構築.
+        std::vector<uint8_t> blob(size_t(header.TotalSize), 0);
+        auto pBase = blob.data();
+
+        memcpy(pBase, &header, sizeof(header));
+        if (meshCount > 0)
+        { memcpy(pBase + header.MeshOffset, meshes.data(), sizeof(MeshCacheMesh) * meshCount); }
+        if (materialCount > 0)
+        { memcpy(pBase + header.MaterialOffset, materials.data(), sizeof(MeshCacheString) * materialCount); }
+        if (dependencyCount > 0)
+        { memcpy(pBase + header.DependencyOffset, dependencies.data(), sizeof(MeshCacheDependency) * dependencyCount); }
+
+        for(uint32_t i=0; i<meshCount; ++i)
+        {
+            const auto& src = model.Meshes[i];
+            const auto& dst = meshes[i];
+
+            WriteString(pBase, dst.Name, src.Name);
+            WriteArray (pBase, dst.Positions, src.Positions);
+            WriteArray (pBase, dst.Normals,   src.Normals);
+            WriteArray (pBase, dst.Tangents,  src.Tangents);
+            WriteArray (pBase, dst.Colors,    src.Colors);
+            for(auto c=0; c<4; ++c)
+            { WriteArray(pBase, dst.TexCoords[c], src.TexCoords[c]); }
+            WriteArray (pBase, dst.Indices, src.Indices);
+        }
+
+        for(uint32_t i=0; i<materialCount; ++i)
+        { WriteString(pBase, materials[i], model.MaterialNames[i]); }
+
+        for(uint32_t i=0; i<dependencyCount; ++i)
+        { WriteString(pBase, dependencies[i].Path, validPaths[i]); }
+
+        // 途中で失敗した場合は TotalSize が一致しないため, 次回の読み込みで破棄されます.
+        std::ofstream stream(path, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!stream.is_open())
+        { return false; }
+
+        stream.write(reinterpret_cast<const char*>(pBase), std::streamsize(blob.size()));
+        return stream.good();
+    }
+
+    //-------------------------------------------------------------------------
+    //! @brief      アライメントを揃えます.
+    //-------------------------------------------------------------------------
+    static uint64_t Align(uint64_t offset)
+    { return (offset + kMeshCacheAlignment - 1) & ~(kMeshCacheAlignment - 1); }
+
+    //-------------------------------------------------------------------------
+    //! @brief      文字列の配置先を決定します.
+    //-------------------------------------------------------------------------
+    static MeshCacheString PlaceString(const std::string& value, uint64_t& offset)
+    {
+        MeshCacheString result = {};
+        result.Offset = offset;
+        result.Length = uint32_t(value.size());
+        offset = Align(offset + value.size() + 1);
+        return result;
+    }
+
+    //-------------------------------------------------------------------------
+    //! @brief      配列の配置先を決定します.
+    //-------------------------------------------------------------------------
+    template<typename T>
+    static uint64_t PlaceArray(const std::vector<T>& values, uint64_t& offset)
+    {
+        if (values.empty())
+        { return 0; }
+
+        auto result = offset;
+        offset = Align(offset + sizeof(T) * values.size());
+        return result;
+    }
+
+    //-------------------------------------------------------------------------
+    //! @brief      文字列を書き込みます.
+    //-------------------------------------------------------------------------
+    static void WriteString(uint8_t* pBase, const MeshCacheString& place, const std::string& value)
+    { memcpy(pBase + place.Offset, value.c_str(), value.size() + 1); }
+
+    //-------------------------------------------------------------------------
+    //! @brief      配列を書き込みます.
+    //-------------------------------------------------------------------------
+    template<typename T>
+    static void WriteArray(uint8_t* pBase, uint64_t offset, const std::vector<T>& values)
+    {
+        if (values.empty())
+        { return; }
+
+        memcpy(pBase + offset, values.data(), sizeof(T) * values.size());
+    }
+
+    //-------------------------------------------------------------------------
+    //! @brief      範囲内かどうかチェックします.
+    //-------------------------------------------------------------------------
+    static bool InRange(const MappedView& view, uint64_t offset, uint64_t bytes)
+    {
+        auto size = view.GetSize();
+        return offset <= size && bytes <= size - offset;
+    }
+
+    //-------------------------------------------------------------------------
+    //! @brief      文字列を読み込みます.
+    //-------------------------------------------------------------------------
+    static bool ReadString(const MappedView& view, const MeshCacheString& place, std::string& value)
+    {
+        if (!InRange(view, place.Offset, uint64_t(place.Length) + 1))
+        { return false; }
+
+        value.assign(reinterpret_cast<const char*>(view.GetData() + place.Offset), place.Length);
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    //! @brief      配列を読み込みます.
+    //-------------------------------------------------------------------------
+    template<typename T>
+    static bool ReadArray(const MappedView& view, uint64_t offset, uint32_t count, std::vector<T>& values)
+    {
+        values.clear();
+
+        // オフセット0は要素無し.
+        if (offset == 0)
+        { return true; }
+
+        if ((offset % kMeshCacheAlignment) != 0 || !InRange(view, offset, uint64_t(sizeof(T)) * count))
+        { return false; }
+
+        values.resize(count);
+        memcpy(values.data(), view.GetData() + offset, sizeof(T) * count);
+        return true;
+    }
 
-    //=========================================================================
-    // private methods.
-    //=========================================================================
 
     //-------------------------------------------------------------------------
     //! @brief      メッシュを解析します.
@@ -12,10 +12,12 @@
 #include <App.h>
 #include <cstdio>
 #include <array>
+#include <chrono>
 #include <fnd/asdxLogger.h>
 #include <fnd/asdxMath.h>
 #include <fnd/asdxMisc.h>
 #include <res/asdxResModel.h>
+#include <MeshLoader.h>
 #include <gfx/asdxCommandQueue.h>
 #include <gfx/asdxSampler.h>
 #include <fw/asdxCameraController.h>
@@ -382,10 +384,11 @@ bool App::OnInit()
         }
     }
 
-    asdx::ResModel model;
+    ResModel model;
     // fǂݍ.
     {
-        asdx::MeshLoader loader;
+        // LbVt̃[_[œǂݍ, 2ڈȍ~ assimp oRȂ.
+        MeshLoader loader;
         if (!loader.Load("../res/models/sponza.obj", model))
         {
             ELOG("Error : Model Load Failed.");
@@ -398,85 +401,35 @@ bool App::OnInit()
         auto meshCount = model.Meshes.size();
         m_Meshes.resize(meshCount);
 
-        auto matrix = asdx::Matrix::CreateIdentity();
-
         for(size_t i=0; i<meshCount; ++i)
         {
-            auto& mesh = model.Meshes[i];
-
-            // _obt@.
-            {
-                std::vector<MeshVertex> vertices;
-                vertices.resize(mesh.Positions.size());
-
-                auto hasTexCoord = (mesh.TexCoords[0].empty() == false);
-                auto hasTangent  = (mesh.Tangents.empty() == false);
-
-                auto vertexCount = mesh.Positions.size();
-                for(size_t idx=0; idx<vertexCount; ++idx)
-                {
-                    vertices[idx].Position    = mesh.Positions[idx];
-                    vertices[idx].Normal      = mesh.Normals[idx];
-                    vertices[idx].Tangent     = (hasTangent) ? mesh.Tangents[idx] : asdx::Vector3(1.0f, 0.0f, 0.0f);
-                    vertices[idx].TexCoord    = (hasTexCoord) ? mesh.TexCoords[0][idx] : asdx::Vector2(0.0f, 0.0f);
-                }
-
-                if (!m_Meshes[i].VB.Init(sizeof(MeshVertex) * vertices.size(), sizeof(MeshVertex)))
-                {
-                    return false;
-                }
-
-                uint8_t* ptr = m_Meshes[i].VB.Map<uint8_t>();
-                if (ptr == nullptr)
-                {
-                    ELOG("Error : VertexBuffer::Map() Failed.");
-                    return false;
-                }
-
-                memcpy(ptr, vertices.data(), sizeof(MeshVertex) * vertices.size());
-
-                m_Meshes[i].VB.Unmap();
-            }
-
-            // CfbNXobt@.
+            if (!InitMesh(model.Meshes[i], m_Meshes[i]))
             {
-                if (!m_Meshes[i].IB.Init(sizeof(uint32_t) * mesh.Indices.size(), false))
-                {
-                    ELOG("Error : IndexBuffer::Init() Failed.");
-                    return false;
-                }
-
-                uint8_t* ptr = m_Meshes[i].IB.Map<uint8_t>();
-                if (ptr == nullptr)
-                {
-                    ELOG("Error : IndexBuffer::Map() Failed.");
-                    return false;
-                }
-
-                memcpy(ptr, mesh.Indices.data(), sizeof(uint32_t) * mesh.Indices.size());
-
-                m_Meshes[i].IB.Unmap();
+                ELOG("Error : InitMesh() Failed. index = %zu", i);
+                return false;
             }
+        }
+    }
 
-            // 萔obt@.
-            {
-                auto size = asdx::RoundUp(sizeof(asdx::Matrix), 256);
-                if (!m_Meshes[i].CB.Init(size))
-                {
-                    ELOG("Error : ConstantBuffer::Init() Failed.");
-                    return false;
-                }
-
-                for(auto j=0; j<2; ++j)
-                {
-                    uint8_t* ptr = m_Meshes[i].CB.MapAs<uint8_t>(j);
-                    memcpy(ptr, &matrix, sizeof(matrix));
-                    m_Meshes[i].CB.Unmap(j);
-                }
-            }
+    // }eAbV.
+    {
+        BatchedModel batched;
+        if (!MeshBatcher::Build(model, nullptr, nullptr, batched))
+        {
+            ELOG("Error : MeshBatcher::Build() Failed.");
+            return false;
+        }
 
-            m_Meshes[i].IndexCount = UINT(mesh.Indices.size());
+        if (!InitMesh(batched.Mesh, m_BatchedMesh))
+        {
+            ELOG("Error : InitMesh() Failed.");
+            return false;
         }
+
+        m_Batches = batched.Batches;
+        ILOG("Info : Mesh Batching. draw count = %u -> %zu", batched.SourceDrawCount, m_Batches.size());
+
+        batched.Dispose();
     }
     // f̃.
     model.Dispose();
@@ -515,6 +468,88 @@ bool App::OnInit()
     return true;
 }
 
+//-------------------------------------------------------------------------------------------------
+//      bV̕`pobt@܂.
+//-------------------------------------------------------------------------------------------------
+bool App::InitMesh(const ResMesh& mesh, Mesh& result)
+{
+    auto matrix = asdx::Matrix::CreateIdentity();
+
+    // _obt@.
+    {
+        std::vector<MeshVertex> vertices;
+        vertices.resize(mesh.Positions.size());
+
+        auto hasTexCoord = (mesh.TexCoords[0].empty() == false);
+        auto hasTangent  = (mesh.Tangents.empty() == false);
+
+        auto vertexCount = mesh.Positions.size();
+        for(size_t idx=0; idx<vertexCount; ++idx)
+        {
+            vertices[idx].Position    = mesh.Positions[idx];
+            vertices[idx].Normal      = mesh.Normals[idx];
+            vertices[idx].Tangent     = (hasTangent) ? mesh.Tangents[idx] : asdx::Vector3(1.0f, 0.0f, 0.0f);
+            vertices[idx].TexCoord    = (hasTexCoord) ? mesh.TexCoords[0][idx] : asdx::Vector2(0.0f, 0.0f);
+        }
+
+        if (!result.VB.Init(sizeof(MeshVertex) * vertices.size(), sizeof(MeshVertex)))
+        {
+            return false;
+        }
+
+        uint8_t* ptr = result.VB.Map<uint8_t>();
+        if (ptr == nullptr)
+        {
+            ELOG("Error : VertexBuffer::Map() Failed.");
+            return false;
+        }
+
+        memcpy(ptr, vertices.data(), sizeof(MeshVertex) * vertices.size());
+
+        result.VB.Unmap();
+    }
+
+    // CfbNXobt@.
+    {
+        if (!result.IB.Init(sizeof(uint32_t) * mesh.Indices.size(), false))
+        {
+            ELOG("Error : IndexBuffer::Init() Failed.");
+            return false;
+        }
+
+        uint8_t* ptr = result.IB.Map<uint8_t>();
+        if (ptr == nullptr)
+        {
+            ELOG("Error : IndexBuffer::Map() Failed.");
+            return false;
+        }
+
+        memcpy(ptr, mesh.Indices.data(), sizeof(uint32_t) * mesh.Indices.size());
+
+        result.IB.Unmap();
+    }
+
+    // 萔obt@.
+    {
+        auto size = asdx::RoundUp(sizeof(asdx::Matrix), 256);
+        if (!result.CB.Init(size))
+        {
+            ELOG("Error : ConstantBuffer::Init() Failed.");
+            return false;
+        }
+
+        for(auto j=0; j<2; ++j)
+        {
+            uint8_t* ptr = result.CB.MapAs<uint8_t>(j);
+            memcpy(ptr, &matrix, sizeof(matrix));
+            result.CB.Unmap(j);
+        }
+    }
+
+    result.IndexCount = UINT(mesh.Indices.size());
+    return true;
+}
+
 //-------------------------------------------------------------------------------------------------
 //      AvP[VŗL̏Ił.
 //-------------------------------------------------------------------------------------------------
@@ -531,6 +566,11 @@ void App::OnTerm()
 
     m_Meshes.clear();
 
+    m_BatchedMesh.VB.Term();
+    m_BatchedMesh.IB.Term();
+    m_BatchedMesh.IndexCount = 0;
+    m_Batches.clear();
+
     m_SimplePSO.Term();
     m_SsaoPSO.Term();
     m_BlurPSO.Term();
@@ -635,20 +675,50 @@ void App::OnFrameRender(asdx::FrameEventArgs& param)
         // fBXNv^ݒ.
         m_GfxCmdList.SetCBV(PARAM_INDEX_B1, m_SceneParam.GetView()); 
 
+        auto begin = std::chrono::high_resolution_clock::now();
+
         // bV`.
-        auto count = m_Meshes.size();
-        for(size_t i=0; i<count; ++i)
+        if (m_EnableBatch)
         {
-            m_GfxCmdList.SetCBV(PARAM_INDEX_B0, m_Meshes[i].CB.GetView());
+            // ς݂̃obt@1xݒ肵, ob`Ƃɔ͈͂w肵ĕ`.
+            m_GfxCmdList.SetCBV(PARAM_INDEX_B0, m_BatchedMesh.CB.GetView());
 
-            auto vbv = m_Meshes[i].VB.GetView();
-            auto ibv = m_Meshes[i].IB.GetView();
-            auto indexCount = m_Meshes[i].IndexCount;
+            auto vbv = m_BatchedMesh.VB.GetView();
+            auto ibv = m_BatchedMesh.IB.GetView();
             m_GfxCmdList.SetVertexBuffers(0, 1, &vbv);
             m_GfxCmdList.SetIndexBuffer(&ibv);
 
-            m_GfxCmdList.DrawIndexedInstanced(indexCount, 1, 0, 0, 0);
+            for(size_t i=0; i<m_Batches.size(); ++i)
+            {
+                const auto& batch = m_Batches[i];
+                m_GfxCmdList.DrawIndexedInstanced(batch.IndexCount, 1, batch.IndexOffset, INT(batch.BaseVertex), 0);
+            }
+
+            m_DrawCount = UINT(m_Batches.size());
         }
+        else
+        {
+            auto count = m_Meshes.size();
+            for(size_t i=0; i<count; ++i)
+            {
+                m_GfxCmdList.SetCBV(PARAM_INDEX_B0, m_Meshes[i].CB.GetView());
+
+                auto vbv = m_Meshes[i].VB.GetView();
+                auto ibv = m_Meshes[i].IB.GetView();
+                auto indexCount = m_Meshes[i].IndexCount;
+                m_GfxCmdList.SetVertexBuffers(0, 1, &vbv);
+                m_GfxCmdList.SetIndexBuffer(&ibv);
+
+                m_GfxCmdList.DrawIndexedInstanced(indexCount, 1, 0, 0, 0);
+            }
+
+            m_DrawCount = UINT(count);
+        }
+
+        // `R}h̋L^ɂCPUԂ𕽊ĕ\.
+        auto end  = std::chrono::high_resolution_clock::now();
+        auto msec = std::chrono::duration<float, std::milli>(end - begin).count();
+        m_DrawTime = m_DrawTime * 0.95f + msec * 0.05f;
     }
 
     // HBAO`.
@@ -774,13 +844,17 @@ void App::OnFrameRender(asdx::FrameEventArgs& param)
         m_GfxCmdList.DrawInstanced(3, 1, 0, 0);
 
         asdx::GuiMgr::Instance().Update(m_Width, m_Height);
-        ImGui::SetNextWindowSize(ImVec2(240, 120), ImGuiCond_Once);
+        ImGui::SetNextWindowSize(ImVec2(240, 180), ImGuiCond_Once);
         if (ImGui::Begin(u8"SSAO p[^"))
         {
             ImGui::DragFloat(u8"a", &m_Radius, 0.1f, 0.0f, 1000.0f, "%.2f");
             ImGui::DragFloat(u8"x", &m_Intensity, 0.1f, 0.0f, 1000.0f, "%.2f");
             ImGui::DragFloat(u8"oCAX", &m_Bias, 0.01f, -1000.0f, 1000.0f, "%.2f");
             ImGui::DragFloat(u8"Nx", &m_BlurSharpenss, 1.0f, 0.1f, 10000.0f, "%.2f");
+            ImGui::Separator();
+            ImGui::Checkbox(u8"bV", &m_EnableBatch);
+            ImGui::Text(u8"`搔 : %u", m_DrawCount);
+            ImGui::Text(u8"L^ : %.3f ms", m_DrawTime);
             ImGui::End();
         }
         asdx::GuiMgr::Instance().Draw(pCmd);
@@ -0,0 +1,164 @@
+﻿//-----------------------------------------------------------------------------
+// File : MeshLoader.cpp
+// Desc : Mesh Loader.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <MeshLoader.h>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif//NOMINMAX
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif//WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+
+///////////////////////////////////////////////////////////////////////////////
+// MappedView class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      ファイルを読み取り専用でメモリにマッピングします.
+//-----------------------------------------------------------------------------
+bool MappedView::Open(const char* path)
+{
+    Close();
+
+    if (path == nullptr)
+    { return false; }
+
+#if defined(_WIN32)
+    auto hFile = CreateFileA(
+        path,
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+        nullptr);
+    if (hFile == INVALID_HANDLE_VALUE)
+    { return false; }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(hFile, &size) || size.QuadPart == 0)
+    {
+        CloseHandle(hFile);
+        return false;
+    }
+
+    auto hMapping = CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (hMapping == nullptr)
+    {
+        CloseHandle(hFile);
+        return false;
+    }
+
+    auto pData = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+    if (pData == nullptr)
+    {
+        CloseHandle(hMapping);
+        CloseHandle(hFile);
+        return false;
+    }
+
+    m_hFile    = hFile;
+    m_hMapping = hMapping;
+    m_pData    = static_cast<const uint8_t*>(pData);
+    m_Size     = uint64_t(size.QuadPart);
+#else
+    auto fd = open(path, O_RDONLY);
+    if (fd < 0)
+    { return false; }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    auto pData = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    if (pData == MAP_FAILED)
+    {
+        close(fd);
+        return false;
+    }
+
+    m_File  = fd;
+    m_pData = static_cast<const uint8_t*>(pData);
+    m_Size  = uint64_t(st.st_size);
+#endif
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      マッピングを解除します.
+//-----------------------------------------------------------------------------
+void MappedView::Close()
+{
+    if (m_pData == nullptr)
+    { return; }
+
+#if defined(_WIN32)
+    UnmapViewOfFile(m_pData);
+    CloseHandle(m_hMapping);
+    CloseHandle(m_hFile);
+    m_hMapping = nullptr;
+    m_hFile    = nullptr;
+#else
+    munmap(const_cast<uint8_t*>(m_pData), size_t(m_Size));
+    close(m_File);
+    m_File = -1;
+#endif
+
+    m_pData = nullptr;
+    m_Size  = 0;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// MeshLoader class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      ファイルの更新日時とサイズを取得します.
+//-----------------------------------------------------------------------------
+bool MeshLoader::GetFileStamp(const char* path, uint64_t& time, uint64_t& size)
+{
+    if (path == nullptr)
+    { return false; }
+
+#if defined(_WIN32)
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!GetFileAttributesExA(path, GetFileExInfoStandard, &data))
+    { return false; }
+
+    if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+    { return false; }
+
+    time = (uint64_t(data.ftLastWriteTime.dwHighDateTime) << 32) | data.ftLastWriteTime.dwLowDateTime;
+    size = (uint64_t(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+#else
+    struct stat st;
+    if (stat(path, &st) != 0 || !S_ISREG(st.st_mode))
+    { return false; }
+
+    time = uint64_t(st.st_mtim.tv_sec) * 1000000000ull + uint64_t(st.st_mtim.tv_nsec);
+    size = uint64_t(st.st_size);
+#endif
+
+    return true;
+}
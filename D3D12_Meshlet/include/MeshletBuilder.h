@@ -0,0 +1,159 @@
+﻿//-----------------------------------------------------------------------------
+// File : MeshletBuilder.h
+// Desc : Offline Meshlet Builder.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <vector>
+#include <fnd/asdxMath.h>
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Meshlet structure
+///////////////////////////////////////////////////////////////////////////////
+struct Meshlet
+{
+    uint32_t    VertexOffset;       //!< 頂点番号オフセット.
+    uint32_t    VertexCount;        //!< 出力頂点数.
+    uint32_t    PrimitiveOffset;    //!< プリミティブ番号オフセット.
+    uint32_t    PrimitiveCount;     //!< 出力プリミティブ数.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// CullInfo structure
+///////////////////////////////////////////////////////////////////////////////
+struct CullInfo
+{
+    asdx::Vector4   BoundingSphere; //!< バウンディングスフィア(xyz:中心, w:半径).
+    uint32_t        NormalCone;     //!< UnpackSnorm4()形式の法錐(xyz:軸, w:sin(半角)).
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// MeshletSubset structure
+///////////////////////////////////////////////////////////////////////////////
+struct MeshletSubset
+{
+    uint32_t    IndexOffset;        //!< インデックスオフセット.
+    uint32_t    IndexCount;         //!< インデックス数.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// MeshletBuildDesc structure
+///////////////////////////////////////////////////////////////////////////////
+struct MeshletBuildDesc
+{
+    uint32_t    MaxVertices     = 64;   //!< メッシュレットあたりの最大頂点数(最大256).
+    uint32_t    MaxPrimitives   = 126;  //!< メッシュレットあたりの最大プリミティブ数.
+    float       ConeWeight      = 0.5f; //!< 法線の揃い具合を優先する度合い[0, 1].
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// MeshletData structure
+///////////////////////////////////////////////////////////////////////////////
+struct MeshletData
+{
+    std::vector<Meshlet>    Meshlets;               //!< メッシュレット.
+    std::vector<uint32_t>   UniqueVertexIndices;    //!< メッシュレットが参照する頂点番号.
+    std::vector<uint32_t>   Primitives;             //!< 10bitずつパックしたローカル頂点番号.
+    std::vector<CullInfo>   CullInfos;              //!< カリング情報.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// MeshletStatistics structure
+///////////////////////////////////////////////////////////////////////////////
+struct MeshletStatistics
+{
+    uint32_t    MeshletCount        = 0;    //!< メッシュレット数.
+    float       VertexFillRate      = 0.0f; //!< 頂点数の充填率[0, 1].
+    float       PrimitiveFillRate   = 0.0f; //!< プリミティブ数の充填率[0, 1].
+    float       AverageConeAngle    = 0.0f; //!< 縮退していない法錐の平均半角(度).
+    float       DegenerateConeRate  = 0.0f; //!< 法錐が縮退したメッシュレットの割合[0, 1].
+    float       AverageRadius       = 0.0f; //!< バウンディングスフィアの平均半径.
+};
+
+//-----------------------------------------------------------------------------
+//! @brief      ローカル頂点番号をUnpackPrimitiveIndex()形式にパックします.
+//-----------------------------------------------------------------------------
+inline uint32_t PackPrimitiveIndex(uint32_t i0, uint32_t i1, uint32_t i2)
+{ return (i0 & 0x3ff) | ((i1 & 0x3ff) << 10) | ((i2 & 0x3ff) << 20); }
+
+//-----------------------------------------------------------------------------
+//! @brief      [-1, 1]の値をUnpackSnorm4()形式にパックします.
+//!
+//! @note       各要素は (v * 0.5 + 0.5) を 8bit unorm に丸めて格納します.
+//-----------------------------------------------------------------------------
+uint32_t PackSnorm4(const asdx::Vector4& value);
+
+//-----------------------------------------------------------------------------
+//! @brief      UnpackSnorm4()形式の値を展開します.
+//-----------------------------------------------------------------------------
+asdx::Vector4 UnpackSnorm4(uint32_t value);
+
+//-----------------------------------------------------------------------------
+//! @brief      法錐が縮退しているかどうかチェックします.
+//!
+//! @note       SampleAS.hlsl の IsConeDegenerate() と同じ判定です.
+//-----------------------------------------------------------------------------
+inline bool IsConeDegenerate(uint32_t packedCone)
+{ return (packedCone >> 24) == 0xff; }
+
+//-----------------------------------------------------------------------------
+//! @brief      インデックス列からメッシュレットを構築します.
+//!
+//! @param[in]      pPositions      位置座標です.
+//! @param[in]      vertexCount     頂点数です.
+//! @param[in]      pIndices        三角形リストのインデックスです.
+//! @param[in]      indexCount      インデックス数です.
+//! @param[in]      desc            構築設定です.
+//! @param[out]     result          構築結果の格納先です.
+//! @retval true    構築に成功.
+//! @retval false   構築に失敗.
+//! @note       隣接三角形を新規頂点数の少なさ, 中心からの距離, 法線の揃い具合で
+//!             評価して貪欲に取り込み, 候補が無くなった場合は空間的に近い
+//!             三角形から次のメッシュレットを開始します.
+//-----------------------------------------------------------------------------
+bool BuildMeshlets(
+    const asdx::Vector3*    pPositions,
+    uint32_t                vertexCount,
+    const uint32_t*         pIndices,
+    uint32_t                indexCount,
+    const MeshletBuildDesc& desc,
+    MeshletData&            result);
+
+//-----------------------------------------------------------------------------
+//! @brief      サブセットごとに並列でメッシュレットを構築します.
+//!
+//! @param[in]      pPositions      位置座標です.
+//! @param[in]      vertexCount     頂点数です.
+//! @param[in]      pIndices        三角形リストのインデックスです.
+//! @param[in]      pSubsets        サブセットです.
+//! @param[in]      subsetCount     サブセット数です.
+//! @param[in]      desc            構築設定です.
+//! @param[out]     results         サブセットごとの構築結果の格納先です.
+//! @retval true    全サブセットの構築に成功.
+//! @retval false   いずれかのサブセットの構築に失敗.
+//-----------------------------------------------------------------------------
+bool BuildMeshlets(
+    const asdx::Vector3*        pPositions,
+    uint32_t                    vertexCount,
+    const uint32_t*             pIndices,
+    const MeshletSubset*        pSubsets,
+    uint32_t                    subsetCount,
+    const MeshletBuildDesc&     desc,
+    std::vector<MeshletData>&   results);
+
+//-----------------------------------------------------------------------------
+//! @brief      メッシュレットの品質指標を求めます.
+//!
+//! @param[in]      data            構築結果です.
+//! @param[in]      desc            構築に用いた設定です.
+//! @return     品質指標を返却します.
+//-----------------------------------------------------------------------------
+MeshletStatistics ComputeMeshletStatistics(
+    const MeshletData&      data,
+    const MeshletBuildDesc& desc);
@@ -0,0 +1,189 @@
+﻿//-----------------------------------------------------------------------------
+// File : MeshletCulling.h
+// Desc : CPU Emulation of Meshlet Culling.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <vector>
+#include <fnd/asdxMath.h>
+#include <MeshletBuilder.h>
+
+
+///////////////////////////////////////////////////////////////////////////////
+// CullParam structure
+///////////////////////////////////////////////////////////////////////////////
+struct CullParam
+{
+    asdx::Matrix    World;          //!< ワールド行列(MeshParam::World).
+    float           Scale;          //!< 半径に掛けるスケール(MeshParam::Scale).
+    asdx::Vector3   CameraPos;      //!< カメラ位置(SceneParam::CameraPos).
+    asdx::Vector4   Planes[6];      //!< 視錐台平面(SceneParam::Planes).
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// CullStatistics structure
+///////////////////////////////////////////////////////////////////////////////
+struct CullStatistics
+{
+    uint32_t    MeshletCount        = 0;    //!< 全メッシュレット数.
+    uint32_t    TriangleCount       = 0;    //!< 全三角形数.
+    uint32_t    VisibleMeshlets     = 0;    //!< 可視メッシュレット数.
+    uint32_t    VisibleTriangles    = 0;    //!< 可視メッシュレットの三角形数.
+    uint32_t    FrustumCulled       = 0;    //!< 視錐台カリングで除外されたメッシュレット数.
+    uint32_t    ConeCulled          = 0;    //!< 法錐カリングで除外されたメッシュレット数.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// CameraKey structure
+///////////////////////////////////////////////////////////////////////////////
+struct CameraKey
+{
+    asdx::Matrix    View;           //!< ビュー行列.
+    asdx::Vector3   Position;       //!< カメラ位置.
+    float           FieldOfView;    //!< 垂直画角(ラジアン).
+    float           AspectRatio;    //!< アスペクト比.
+    float           NearClip;       //!< ニアクリップ.
+    float           FarClip;        //!< ファークリップ.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// ReplayReport structure
+///////////////////////////////////////////////////////////////////////////////
+struct ReplayReport
+{
+    uint32_t    FrameCount          = 0;    //!< フレーム数.
+    float       AverageCullRatio    = 0.0f; //!< 除外されたメッシュレットの平均割合.
+    float       MinCullRatio        = 0.0f; //!< 除外されたメッシュレットの最小割合.
+    float       MaxCullRatio        = 0.0f; //!< 除外されたメッシュレットの最大割合.
+    float       FrustumCullRatio    = 0.0f; //!< 視錐台カリングで除外された平均割合.
+    float       ConeCullRatio       = 0.0f; //!< 法錐カリングで除外された平均割合.
+    float       TriangleSavings     = 0.0f; //!< 削減された三角形の平均割合.
+};
+
+//-----------------------------------------------------------------------------
+//! @brief      球が視錐台に含まれるかどうかチェックします.
+//!
+//! @note       Math.hlsli の Contains() と同じ判定です(平面の法線は内向き).
+//-----------------------------------------------------------------------------
+bool Contains(const asdx::Vector4* planes, const asdx::Vector4& sphere);
+
+//-----------------------------------------------------------------------------
+//! @brief      法錐により全面が裏向きとなるかどうかチェックします.
+//!
+//! @param[in]      normalCone      法錐です(xyz:軸, w:sin(半角)).
+//! @param[in]      viewDir         メッシュレットからカメラへの単位ベクトルです.
+//! @retval true    カリングできる.
+//! @retval false   カリングできない.
+//-----------------------------------------------------------------------------
+bool NormalConeCulling(const asdx::Vector4& normalCone, const asdx::Vector3& viewDir);
+
+//-----------------------------------------------------------------------------
+//! @brief      SampleAS.hlsl の IsVisible() を CPU で評価します.
+//-----------------------------------------------------------------------------
+bool IsVisible(const CullInfo& cullInfo, const CullParam& param);
+
+
+///////////////////////////////////////////////////////////////////////////////
+// MeshletCuller class
+///////////////////////////////////////////////////////////////////////////////
+class MeshletCuller
+{
+    //=========================================================================
+    // list of friend classes and methods.
+    //=========================================================================
+    /* NOTHING */
+
+public:
+    //=========================================================================
+    // public variables.
+    //=========================================================================
+    /* NOTHING */
+
+    //=========================================================================
+    // public methods.
+    //=========================================================================
+
+    //-------------------------------------------------------------------------
+    //! @brief      初期化処理を行います.
+    //!
+    //! @param[in]      pMeshlets       メッシュレットです.
+    //! @param[in]      pCullInfos      カリング情報です.
+    //! @param[in]      count           メッシュレット数です.
+    //-------------------------------------------------------------------------
+    void Init(const Meshlet* pMeshlets, const CullInfo* pCullInfos, uint32_t count);
+
+    //-------------------------------------------------------------------------
+    //! @brief      終了処理を行います.
+    //-------------------------------------------------------------------------
+    void Term();
+
+    //-------------------------------------------------------------------------
+    //! @brief      全メッシュレットを4つずつSIMDでカリングします.
+    //!
+    //! @param[in]      param           カリングパラメータです.
+    //! @param[out]     pVisibility     メッシュレットごとの可視フラグの格納先です(nullptr可).
+    //! @return     カリング結果の統計を返却します.
+    //-------------------------------------------------------------------------
+    CullStatistics Cull(const CullParam& param, std::vector<uint8_t>* pVisibility = nullptr) const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      メッシュレット数を取得します.
+    //-------------------------------------------------------------------------
+    uint32_t GetMeshletCount() const;
+
+private:
+    //=========================================================================
+    // private variables.
+    //=========================================================================
+    uint32_t              m_Count         = 0;
+    uint32_t              m_TriangleCount = 0;
+    std::vector<float>    m_CenterX;
+    std::vector<float>    m_CenterY;
+    std::vector<float>    m_CenterZ;
+    std::vector<float>    m_Radius;
+    std::vector<float>    m_AxisX;
+    std::vector<float>    m_AxisY;
+    std::vector<float>    m_AxisZ;
+    std::vector<float>    m_CutOff;
+    std::vector<uint32_t> m_NormalCone;
+    std::vector<int>      m_Degenerate;
+    std::vector<int>      m_Primitives;
+
+    //=========================================================================
+    // private methods.
+    //=========================================================================
+    /* NOTHING */
+};
+
+//-----------------------------------------------------------------------------
+//! @brief      カメラパスをテキストファイルに保存します.
+//!
+//! @note       1行1フレームで, ビュー行列(16), 位置(3), 画角, アスペクト比,
+//!             ニアクリップ, ファークリップを空白区切りで出力します.
+//-----------------------------------------------------------------------------
+bool SaveCameraPath(const char* path, const std::vector<CameraKey>& keys);
+
+//-----------------------------------------------------------------------------
+//! @brief      カメラパスをテキストファイルから読み込みます.
+//-----------------------------------------------------------------------------
+bool LoadCameraPath(const char* path, std::vector<CameraKey>& keys);
+
+//-----------------------------------------------------------------------------
+//! @brief      カメラパスを再生してカリング率を集計します.
+//!
+//! @param[in]      culler          カリングを行うオブジェクトです.
+//! @param[in]      world           ワールド行列です.
+//! @param[in]      scale           半径に掛けるスケールです.
+//! @param[in]      keys            カメラパスです.
+//! @return     集計結果を返却します.
+//-----------------------------------------------------------------------------
+ReplayReport ReplayCameraPath(
+    const MeshletCuller&            culler,
+    const asdx::Matrix&             world,
+    float                           scale,
+    const std::vector<CameraKey>&   keys);
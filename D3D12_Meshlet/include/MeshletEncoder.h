@@ -0,0 +1,131 @@
+﻿//-----------------------------------------------------------------------------
+// File : MeshletEncoder.h
+// Desc : Compressed Meshlet Encoding.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <vector>
+#include <MeshletBuilder.h>
+
+
+///////////////////////////////////////////////////////////////////////////////
+// MESHLET_PRIMITIVE_FORMAT enum
+///////////////////////////////////////////////////////////////////////////////
+enum MESHLET_PRIMITIVE_FORMAT
+{
+    MESHLET_PRIMITIVE_U8X3      = 0,    //!< 8bitローカル番号を3バイトで格納します.
+    MESHLET_PRIMITIVE_PACKED10  = 1,    //!< 10:10:10 で4バイトに格納します(UnpackPrimitiveIndex形式).
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// MESHLET_POSITION_FORMAT enum
+///////////////////////////////////////////////////////////////////////////////
+enum MESHLET_POSITION_FORMAT
+{
+    MESHLET_POSITION_UNORM16        = 0,    //!< メッシュレット範囲内の 16:16:16 unorm (6バイト).
+    MESHLET_POSITION_UNORM11_11_10  = 1,    //!< メッシュレット範囲内の 11:11:10 unorm (4バイト).
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// MeshletEncodeDesc structure
+///////////////////////////////////////////////////////////////////////////////
+struct MeshletEncodeDesc
+{
+    MESHLET_PRIMITIVE_FORMAT    PrimitiveFormat = MESHLET_PRIMITIVE_U8X3;
+    MESHLET_POSITION_FORMAT     PositionFormat  = MESHLET_POSITION_UNORM16;
+    bool                        Reorder         = true;     //!< 圧縮しやすい順序に並べ替えるかどうか.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// EncodedMeshlet structure
+///////////////////////////////////////////////////////////////////////////////
+struct EncodedMeshlet
+{
+    uint32_t    VertexOffset;       //!< 頂点番号・位置座標の要素オフセット.
+    uint32_t    PrimitiveOffset;    //!< プリミティブのバイトオフセット.
+    uint16_t    VertexCount;        //!< 頂点数.
+    uint16_t    PrimitiveCount;     //!< プリミティブ数.
+    float       BoundsMin[3];       //!< 位置座標の量子化範囲の最小値.
+    float       BoundsSize[3];      //!< 位置座標の量子化範囲の大きさ.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// EncodedMeshletData structure
+///////////////////////////////////////////////////////////////////////////////
+struct EncodedMeshletData
+{
+    MESHLET_PRIMITIVE_FORMAT    PrimitiveFormat = MESHLET_PRIMITIVE_U8X3;
+    MESHLET_POSITION_FORMAT     PositionFormat  = MESHLET_POSITION_UNORM16;
+    std::vector<EncodedMeshlet> Meshlets;           //!< メッシュレット.
+    std::vector<uint32_t>       VertexIndices;      //!< 他の頂点属性を参照するための頂点番号.
+    std::vector<uint8_t>        Primitives;         //!< ローカル頂点番号.
+    std::vector<uint8_t>        Positions;          //!< メッシュレットごとに量子化した位置座標.
+    std::vector<CullInfo>       CullInfos;          //!< カリング情報.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// MeshletSizeReport structure
+///////////////////////////////////////////////////////////////////////////////
+struct MeshletSizeReport
+{
+    size_t      SourceBytes     = 0;    //!< 現在のレイアウトのサイズ(共有頂点の位置座標を含む).
+    size_t      EncodedBytes    = 0;    //!< 圧縮後のサイズ.
+    size_t      MeshletBytes    = 0;    //!< 圧縮後のメッシュレットヘッダのサイズ.
+    size_t      IndexBytes      = 0;    //!< 圧縮後の頂点番号のサイズ.
+    size_t      PrimitiveBytes  = 0;    //!< 圧縮後のプリミティブのサイズ.
+    size_t      PositionBytes   = 0;    //!< 圧縮後の位置座標のサイズ.
+    size_t      CullInfoBytes   = 0;    //!< カリング情報のサイズ.
+    float       Ratio           = 0.0f; //!< 圧縮率(EncodedBytes / SourceBytes).
+};
+
+//-----------------------------------------------------------------------------
+//! @brief      メッシュレットを圧縮形式に変換します.
+//!
+//! @param[in]      pPositions      位置座標です.
+//! @param[in]      vertexCount     頂点数です.
+//! @param[in]      source          BuildMeshlets() で構築したメッシュレットです.
+//! @param[in]      desc            圧縮設定です.
+//! @param[out]     result          圧縮結果の格納先です.
+//! @retval true    変換に成功.
+//! @retval false   変換に失敗.
+//! @note       並べ替えを有効にすると, 辺を共有する三角形が連続し, ローカル頂点番号が
+//!             初出順に増加するよう並べ替えます(巻き順は保持します).
+//-----------------------------------------------------------------------------
+bool EncodeMeshlets(
+    const asdx::Vector3*        pPositions,
+    uint32_t                    vertexCount,
+    const MeshletData&          source,
+    const MeshletEncodeDesc&    desc,
+    EncodedMeshletData&         result);
+
+//-----------------------------------------------------------------------------
+//! @brief      圧縮形式からメッシュレットを復元します.
+//!
+//! @param[in]      source          圧縮したメッシュレットです.
+//! @param[out]     result          復元したメッシュレットの格納先です.
+//! @param[out]     pPositions      UniqueVertexIndices と同じ並びで復元した位置座標の格納先です(nullptr可).
+//! @retval true    復元に成功.
+//! @retval false   復元に失敗.
+//-----------------------------------------------------------------------------
+bool DecodeMeshlets(
+    const EncodedMeshletData&   source,
+    MeshletData&                result,
+    std::vector<asdx::Vector3>* pPositions);
+
+//-----------------------------------------------------------------------------
+//! @brief      現在のレイアウトに対するサイズを集計します.
+//!
+//! @param[in]      source          圧縮前のメッシュレットです.
+//! @param[in]      vertexCount     共有頂点数です.
+//! @param[in]      encoded         圧縮したメッシュレットです.
+//! @return     集計結果を返却します.
+//-----------------------------------------------------------------------------
+MeshletSizeReport ComputeMeshletSizeReport(
+    const MeshletData&          source,
+    uint32_t                    vertexCount,
+    const EncodedMeshletData&   encoded);
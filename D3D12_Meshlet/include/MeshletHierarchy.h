@@ -0,0 +1,121 @@
+﻿//-----------------------------------------------------------------------------
+// File : MeshletHierarchy.h
+// Desc : Hierarchical Cluster LOD.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <vector>
+#include <MeshletBuilder.h>
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ClusterLod structure
+///////////////////////////////////////////////////////////////////////////////
+struct ClusterLod
+{
+    asdx::Vector4   LodBounds;      //!< 自身の誤差を評価するバウンディングスフィア.
+    float           LodError;       //!< 自身の簡略化誤差(オブジェクト空間の距離). 最詳細は0.
+    asdx::Vector4   ParentBounds;   //!< 親グループのバウンディングスフィア.
+    float           ParentError;    //!< 親グループの簡略化誤差. 親が無い場合は FLT_MAX.
+    uint32_t        Level;          //!< 階層番号(0が最詳細).
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// MeshletHierarchyDesc structure
+///////////////////////////////////////////////////////////////////////////////
+struct MeshletHierarchyDesc
+{
+    MeshletBuildDesc    Meshlet;                    //!< メッシュレットの構築設定.
+    uint32_t            GroupSize       = 8;        //!< 同時に簡略化するメッシュレット数.
+    float               ReductionRatio  = 0.5f;     //!< 1階層あたりの目標三角形比率.
+    uint32_t            MaxLevels       = 16;       //!< 最大階層数.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// MeshletHierarchy structure
+///////////////////////////////////////////////////////////////////////////////
+struct MeshletHierarchy
+{
+    MeshletData                 Clusters;       //!< 全階層のメッシュレット(頂点バッファは元メッシュと共有).
+    std::vector<ClusterLod>     Lods;           //!< メッシュレットごとの詳細度情報.
+    uint32_t                    LevelCount = 0; //!< 階層数.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// LodView structure
+///////////////////////////////////////////////////////////////////////////////
+struct LodView
+{
+    asdx::Vector3   CameraPos;          //!< オブジェクト空間のカメラ位置.
+    float           ProjectionScale;    //!< 画面高さ / (2 * tan(fovY / 2)).
+    float           ErrorThreshold;     //!< 許容する画面上の誤差(ピクセル).
+};
+
+//-----------------------------------------------------------------------------
+//! @brief      メッシュレットの階層(DAG)を構築します.
+//!
+//! @param[in]      pPositions      位置座標です.
+//! @param[in]      vertexCount     頂点数です.
+//! @param[in]      pIndices        三角形リストのインデックスです.
+//! @param[in]      indexCount      インデックス数です.
+//! @param[in]      desc            構築設定です.
+//! @param[out]     result          構築結果の格納先です.
+//! @retval true    構築に成功.
+//! @retval false   構築に失敗.
+//! @note       隣接するメッシュレットをグループ化し, グループ境界を固定したまま簡略化して
+//!             再分割することを繰り返します. 簡略化は既存の頂点へ縮約するため,
+//!             全階層で同じ頂点バッファを参照します.
+//-----------------------------------------------------------------------------
+bool BuildMeshletHierarchy(
+    const asdx::Vector3*        pPositions,
+    uint32_t                    vertexCount,
+    const uint32_t*             pIndices,
+    uint32_t                    indexCount,
+    const MeshletHierarchyDesc& desc,
+    MeshletHierarchy&           result);
+
+//-----------------------------------------------------------------------------
+//! @brief      画面上の誤差を求めます.
+//!
+//! @param[in]      bounds          バウンディングスフィアです.
+//! @param[in]      error           オブジェクト空間の誤差です.
+//! @param[in]      view            ビュー情報です.
+//! @return     画面上の誤差(ピクセル)を返却します. カメラが球の内側にある場合は FLT_MAX です.
+//-----------------------------------------------------------------------------
+float ComputeProjectedError(const asdx::Vector4& bounds, float error, const LodView& view);
+
+//-----------------------------------------------------------------------------
+//! @brief      許容誤差を満たす最も粗いカットを選択します.
+//!
+//! @param[in]      hierarchy       メッシュレット階層です.
+//! @param[in]      view            ビュー情報です.
+//! @param[out]     selected        選択したメッシュレット番号の格納先です.
+//! @return     選択したメッシュレット数を返却します.
+//! @note       自身の誤差が閾値以下かつ親の誤差が閾値を超えるメッシュレットを選択します.
+//!             誤差と境界球は親に向かって単調に増加するため, 同じグループの
+//!             メッシュレットは常に揃って切り替わり, ひび割れが生じません.
+//-----------------------------------------------------------------------------
+uint32_t SelectMeshletLod(
+    const MeshletHierarchy& hierarchy,
+    const LodView&          view,
+    std::vector<uint32_t>&  selected);
+
+//-----------------------------------------------------------------------------
+//! @brief      選択したメッシュレットを描画用に詰めます.
+//!
+//! @param[in]      hierarchy       メッシュレット階層です.
+//! @param[in]      selected        選択したメッシュレット番号です.
+//! @param[out]     meshlets        Meshlets バッファに転送するデータの格納先です.
+//! @param[out]     cullInfos       CullInfos バッファに転送するデータの格納先です.
+//! @note       頂点番号とプリミティブは hierarchy.Clusters のバッファをそのまま参照します.
+//-----------------------------------------------------------------------------
+void GatherMeshlets(
+    const MeshletHierarchy&         hierarchy,
+    const std::vector<uint32_t>&    selected,
+    std::vector<Meshlet>&           meshlets,
+    std::vector<CullInfo>&          cullInfos);
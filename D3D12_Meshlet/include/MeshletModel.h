@@ -0,0 +1,76 @@
+﻿//-----------------------------------------------------------------------------
+// File : MeshletModel.h
+// Desc : Meshlet Model File (*.mdl) Reader/Writer.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <vector>
+#include <MeshletBuilder.h>
+
+
+///////////////////////////////////////////////////////////////////////////////
+// MeshletMesh structure
+///////////////////////////////////////////////////////////////////////////////
+struct MeshletMesh
+{
+    uint32_t                    MaterialId = 0;     //!< マテリアル番号(マテリアル名のハッシュ値).
+    std::vector<asdx::Vector3>  Positions;          //!< 位置座標.
+    std::vector<uint32_t>       TangentSpaces;      //!< UnpackTN()形式の接線空間.
+    std::vector<uint32_t>       Colors;             //!< 頂点カラー.
+    std::vector<uint32_t>       TexCoords[4];       //!< UnpackHalf2()形式のテクスチャ座標.
+    MeshletData                 Meshlets;           //!< メッシュレット.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// MeshletModel structure
+///////////////////////////////////////////////////////////////////////////////
+struct MeshletModel
+{
+    std::vector<MeshletMesh>    Meshes;             //!< メッシュ.
+};
+
+//-----------------------------------------------------------------------------
+//! @brief      モデルファイルを読み込みます.
+//!
+//! @param[in]      path            ファイルパスです.
+//! @param[out]     model           読み込み結果の格納先です.
+//! @retval true    読み込みに成功.
+//! @retval false   読み込みに失敗.
+//! @note       サンプルが asdx::LoadModel() で読み込む *.mdl 形式です.
+//!             ボーンを持つメッシュには対応していません.
+//-----------------------------------------------------------------------------
+bool LoadMeshletModel(const char* path, MeshletModel& model);
+
+//-----------------------------------------------------------------------------
+//! @brief      モデルファイルに書き出します.
+//!
+//! @param[in]      path            ファイルパスです.
+//! @param[in]      model           書き出すモデルです.
+//! @retval true    書き出しに成功.
+//! @retval false   書き出しに失敗.
+//-----------------------------------------------------------------------------
+bool SaveMeshletModel(const char* path, const MeshletModel& model);
+
+//-----------------------------------------------------------------------------
+//! @brief      メッシュレットから三角形リストを復元します.
+//!
+//! @param[in]      data            メッシュレットです.
+//! @param[out]     indices         三角形リストのインデックスの格納先です.
+//-----------------------------------------------------------------------------
+void ExtractTriangles(const MeshletData& data, std::vector<uint32_t>& indices);
+
+//-----------------------------------------------------------------------------
+//! @brief      全メッシュのメッシュレットを再構築します.
+//!
+//! @param[in]      desc            構築設定です.
+//! @param[in,out]  model           再構築するモデルです.
+//! @retval true    再構築に成功.
+//! @retval false   再構築に失敗.
+//! @note       頂点データはそのままで, 三角形リストを復元して BuildMeshlets() で構築し直します.
+//-----------------------------------------------------------------------------
+bool RebuildMeshlets(const MeshletBuildDesc& desc, MeshletModel& model);
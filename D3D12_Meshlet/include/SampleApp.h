@@ -14,6 +14,32 @@
 #include <gfx/asdxPipelineState.h>
 #include <gfx/asdxConstantBuffer.h>
 #include <gfx/asdxFence.h>
+#include <gfx/asdxBuffer.h>
+#include <gfx/asdxView.h>
+#include <MeshletCulling.h>
+#include <MeshletHierarchy.h>
+
+
+///////////////////////////////////////////////////////////////////////////////
+// LodMesh structure
+///////////////////////////////////////////////////////////////////////////////
+struct LodMesh
+{
+    static const uint32_t BufferCount = 2;      //!< フレーム間で使い回すバッファ数.
+
+    MeshletHierarchy                        Hierarchy;                  //!< メッシュレット階層.
+    asdx::RefPtr<ID3D12Resource>            Indices;                    //!< 全階層の頂点番号.
+    asdx::RefPtr<ID3D12Resource>            Primitives;                 //!< 全階層のプリミティブ.
+    asdx::RefPtr<ID3D12Resource>            Meshlets [BufferCount];     //!< 選択したメッシュレット.
+    asdx::RefPtr<ID3D12Resource>            CullInfos[BufferCount];     //!< 選択したメッシュレットのカリング情報.
+    asdx::RefPtr<asdx::IShaderResourceView> IndicesSRV;
+    asdx::RefPtr<asdx::IShaderResourceView> PrimitivesSRV;
+    asdx::RefPtr<asdx::IShaderResourceView> MeshletsSRV [BufferCount];
+    asdx::RefPtr<asdx::IShaderResourceView> CullInfosSRV[BufferCount];
+    std::vector<uint32_t>                   Selected;                   //!< 選択したメッシュレット番号.
+    std::vector<Meshlet>                    SelectedMeshlets;           //!< 転送用のメッシュレット.
+    std::vector<CullInfo>                   SelectedCullInfos;          //!< 転送用のカリング情報.
+};
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -60,6 +86,11 @@ private:
     asdx::ConstantBuffer    m_SceneBuffer;
     asdx::ConstantBuffer    m_DebugSceneBuffer;
     bool                    m_DebugPause = false;
+    bool                    m_RecordCamera = false;
+    std::vector<CameraKey>  m_CameraPath;
+    std::vector<LodMesh>    m_LodMeshes;
+    bool                    m_EnableLod = true;
+    uint32_t                m_LodBufferIndex = 0;
 
     //=========================================================================
     // private methods.
@@ -100,4 +131,14 @@ private:
     //-------------------------------------------------------------------------
     void OnTyping(uint32_t keyCode) override;
 
+    //-------------------------------------------------------------------------
+    //! @brief      メッシュレット階層を構築します.
+    //-------------------------------------------------------------------------
+    bool InitLod(const char* path);
+
+    //-------------------------------------------------------------------------
+    //! @brief      カメラ位置に応じてメッシュレット階層のカットを選択します.
+    //-------------------------------------------------------------------------
+    void UpdateLod(const asdx::Vector3& cameraPos, const asdx::Vector3& scale);
+
 };
\ No newline at end of file
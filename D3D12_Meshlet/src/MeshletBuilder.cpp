@@ -0,0 +1,808 @@
+﻿//-----------------------------------------------------------------------------
+// File : MeshletBuilder.cpp
+// Desc : Offline Meshlet Builder.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <MeshletBuilder.h>
+#include <fnd/asdxLogger.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <cmath>
+#include <cfloat>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t kInvalidIndex     = ~0u;
+static const float    kDegenerateCone   = 0.1f;   // 法錐の最小内積がこれ以下なら縮退扱い.
+static const float    kLastWeight       = 1.0f;   // 取り残される頂点を減らすための優先度.
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Sphere structure
+///////////////////////////////////////////////////////////////////////////////
+struct Sphere
+{
+    asdx::Vector3   Center;
+    float           Radius;
+};
+
+//-----------------------------------------------------------------------------
+//      球が点を含むかどうかチェックします.
+//-----------------------------------------------------------------------------
+bool Contains(const Sphere& sphere, const asdx::Vector3& point)
+{
+    auto d = point - sphere.Center;
+    auto r = sphere.Radius * 1.00001f + 1e-6f;
+    return sphere.Radius >= 0.0f && asdx::Vector3::Dot(d, d) <= r * r;
+}
+
+//-----------------------------------------------------------------------------
+//      境界上の点(最大4点)から球を求めます.
+//-----------------------------------------------------------------------------
+Sphere SphereFromBoundary(const asdx::Vector3* points, uint32_t count)
+{
+    Sphere result;
+    result.Center = asdx::Vector3(0.0f, 0.0f, 0.0f);
+    result.Radius = -1.0f;
+
+    if (count == 0)
+    { return result; }
+
+    if (count == 1)
+    {
+        result.Center = points[0];
+        result.Radius = 0.0f;
+        return result;
+    }
+
+    auto p0 = points[0];
+    auto a  = points[1] - p0;
+
+    if (count == 2)
+    {
+        result.Center = p0 + a * 0.5f;
+        result.Radius = a.Length() * 0.5f;
+        return result;
+    }
+
+    auto b = points[2] - p0;
+
+    if (count == 4)
+    {
+        auto c = points[3] - p0;
+        auto denom = 2.0f * asdx::Vector3::Dot(a, asdx::Vector3::Cross(b, c));
+        if (fabsf(denom) > 1e-12f)
+        {
+            auto offset = (asdx::Vector3::Cross(b, c) * asdx::Vector3::Dot(a, a)
+                         + asdx::Vector3::Cross(c, a) * asdx::Vector3::Dot(b, b)
+                         + asdx::Vector3::Cross(a, b) * asdx::Vector3::Dot(c, c)) * (1.0f / denom);
+            result.Center = p0 + offset;
+            result.Radius = offset.Length();
+            return result;
+        }
+
+        // 同一平面上の4点は外接円で代用し, 残りは最後に半径を補正する.
+    }
+
+    auto axb   = asdx::Vector3::Cross(a, b);
+    auto denom = 2.0f * asdx::Vector3::Dot(axb, axb);
+    if (denom > 1e-12f)
+    {
+        auto offset = (asdx::Vector3::Cross(axb, a) * asdx::Vector3::Dot(b, b)
+                     + asdx::Vector3::Cross(b, axb) * asdx::Vector3::Dot(a, a)) * (1.0f / denom);
+        result.Center = p0 + offset;
+        result.Radius = offset.Length();
+        return result;
+    }
+
+    // 一直線上の3点は最も離れた2点から求める.
+    auto c  = points[2] - points[1];
+    auto la = asdx::Vector3::Dot(a, a);
+    auto lb = asdx::Vector3::Dot(b, b);
+    auto lc = asdx::Vector3::Dot(c, c);
+    if (la >= lb && la >= lc)
+    {
+        result.Center = p0 + a * 0.5f;
+        result.Radius = sqrtf(la) * 0.5f;
+    }
+    else if (lb >= lc)
+    {
+        result.Center = p0 + b * 0.5f;
+        result.Radius = sqrtf(lb) * 0.5f;
+    }
+    else
+    {
+        result.Center = points[1] + c * 0.5f;
+        result.Radius = sqrtf(lc) * 0.5f;
+    }
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      Welzlのアルゴリズムで最小包含球を求めます.
+//-----------------------------------------------------------------------------
+Sphere Welzl
+(
+    const asdx::Vector3*    points,
+    uint32_t                count,
+    asdx::Vector3*          boundary,
+    uint32_t                boundaryCount
+)
+{
+    if (count == 0 || boundaryCount == 4)
+    { return SphereFromBoundary(boundary, boundaryCount); }
+
+    auto sphere = Welzl(points, count - 1, boundary, boundaryCount);
+    if (Contains(sphere, points[count - 1]))
+    { return sphere; }
+
+    boundary[boundaryCount] = points[count - 1];
+    return Welzl(points, count - 1, boundary, boundaryCount + 1);
+}
+
+//-----------------------------------------------------------------------------
+//      点群を包含する最小の球を求めます.
+//-----------------------------------------------------------------------------
+Sphere ComputeBoundingSphere(std::vector<asdx::Vector3>& points)
+{
+    // 期待計算量を線形にするため順番を決定的に入れ替える.
+    uint32_t seed = 0x9e3779b9u;
+    for (auto i = uint32_t(points.size()); i > 1; --i)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        std::swap(points[i - 1], points[(seed >> 8) % i]);
+    }
+
+    asdx::Vector3 boundary[4];
+    auto sphere = Welzl(points.data(), uint32_t(points.size()), boundary, 0);
+
+    // 数値誤差で外れた点を確実に含むよう半径を補正する.
+    auto radiusSq = 0.0f;
+    for (auto& point : points)
+    {
+        auto d = point - sphere.Center;
+        radiusSq = std::max(radiusSq, asdx::Vector3::Dot(d, d));
+    }
+    sphere.Radius = sqrtf(radiusSq);
+
+    return sphere;
+}
+
+//-----------------------------------------------------------------------------
+//      [0, 1]の値を3軸10bitに量子化してモートンコードを求めます.
+//-----------------------------------------------------------------------------
+uint32_t EncodeMorton(float x, float y, float z)
+{
+    auto expand = [](float value)
+    {
+        auto v = uint32_t(std::min(std::max(value, 0.0f), 1.0f) * 1023.0f);
+        v = (v | (v << 16)) & 0x030000ff;
+        v = (v | (v <<  8)) & 0x0300f00f;
+        v = (v | (v <<  4)) & 0x030c30c3;
+        v = (v | (v <<  2)) & 0x09249249;
+        return v;
+    };
+
+    return expand(x) | (expand(y) << 1) | (expand(z) << 2);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// MeshletContext class
+///////////////////////////////////////////////////////////////////////////////
+class MeshletContext
+{
+public:
+    //-------------------------------------------------------------------------
+    //      コンストラクタです.
+    //-------------------------------------------------------------------------
+    MeshletContext
+    (
+        const asdx::Vector3*    pPositions,
+        uint32_t                vertexCount,
+        const MeshletBuildDesc& desc,
+        MeshletData&            result
+    )
+    : m_pPositions  (pPositions)
+    , m_Desc        (desc)
+    , m_Result      (result)
+    , m_LocalIndices(vertexCount, kInvalidIndex)
+    { /* DO_NOTHING */ }
+
+    //-------------------------------------------------------------------------
+    //      メッシュレットを構築します.
+    //-------------------------------------------------------------------------
+    void Build(const uint32_t* pIndices, uint32_t indexCount)
+    {
+        // 頂点を共有しない縮退三角形は描画されないので除外する.
+        m_Triangles.reserve(indexCount);
+        for (auto i = 0u; i + 2 < indexCount; i += 3)
+        {
+            auto i0 = pIndices[i + 0];
+            auto i1 = pIndices[i + 1];
+            auto i2 = pIndices[i + 2];
+            if (i0 == i1 || i1 == i2 || i2 == i0)
+            { continue; }
+
+            m_Triangles.push_back(i0);
+            m_Triangles.push_back(i1);
+            m_Triangles.push_back(i2);
+        }
+
+        auto triangleCount = uint32_t(m_Triangles.size() / 3);
+        if (triangleCount == 0)
+        { return; }
+
+        SetupTriangles(triangleCount);
+        SetupAdjacency(triangleCount);
+
+        // 候補が尽きた時の開始三角形はモートン順に選び, 空間的な局所性を保つ.
+        std::vector<uint64_t> order(triangleCount);
+        {
+            auto mini = m_Centroids[0];
+            auto maxi = m_Centroids[0];
+            for (auto& centroid : m_Centroids)
+            {
+                mini = asdx::Vector3::Min(mini, centroid);
+                maxi = asdx::Vector3::Max(maxi, centroid);
+            }
+
+            auto size  = maxi - mini;
+            auto scale = std::max(std::max(size.x, size.y), std::max(size.z, 1e-6f));
+            for (auto i = 0u; i < triangleCount; ++i)
+            {
+                auto p = (m_Centroids[i] - mini) * (1.0f / scale);
+                order[i] = (uint64_t(EncodeMorton(p.x, p.y, p.z)) << 32) | i;
+            }
+            std::sort(order.begin(), order.end());
+        }
+
+        m_Emitted .resize(triangleCount, false);
+        m_Stamps  .resize(triangleCount, kInvalidIndex);
+
+        m_LiveCounts.resize(m_LocalIndices.size());
+        for (size_t i = 0; i < m_LiveCounts.size(); ++i)
+        { m_LiveCounts[i] = m_AdjacencyOffsets[i + 1] - m_AdjacencyOffsets[i]; }
+
+        auto cursor = 0u;
+        auto remain = triangleCount;
+        while (remain > 0)
+        {
+            auto triangle = FindCandidate();
+            if (triangle == kInvalidIndex)
+            {
+                while (m_Emitted[uint32_t(order[cursor])])
+                { cursor++; }
+
+                triangle = uint32_t(order[cursor]);
+
+                // 離れすぎた三角形は取り込まず, 新しいメッシュレットを開始する.
+                if (!m_Primitives.empty() && !IsNear(triangle))
+                { Flush(); }
+            }
+
+            if (!CanAppend(triangle))
+            { Flush(); }
+
+            Append(triangle);
+            remain--;
+
+            if (m_Primitives.size() >= m_Desc.MaxPrimitives)
+            { Flush(); }
+        }
+
+        Flush();
+    }
+
+private:
+    //=========================================================================
+    // private variables.
+    //=========================================================================
+    const asdx::Vector3*        m_pPositions;
+    const MeshletBuildDesc&     m_Desc;
+    MeshletData&                m_Result;
+    std::vector<uint32_t>       m_Triangles;
+    std::vector<asdx::Vector3>  m_Centroids;
+    std::vector<asdx::Vector3>  m_Normals;
+    std::vector<uint32_t>       m_AdjacencyOffsets;
+    std::vector<uint32_t>       m_Adjacency;
+    std::vector<bool>           m_Emitted;
+    std::vector<uint32_t>       m_Stamps;
+    std::vector<uint32_t>       m_LiveCounts;
+    std::vector<uint32_t>       m_LocalIndices;
+    std::vector<uint32_t>       m_Vertices;
+    std::vector<uint32_t>       m_Primitives;
+    std::vector<uint32_t>       m_Candidates;
+    asdx::Vector3               m_PositionSum   = asdx::Vector3(0.0f, 0.0f, 0.0f);
+    asdx::Vector3               m_NormalSum     = asdx::Vector3(0.0f, 0.0f, 0.0f);
+    float                       m_RadiusSq      = 0.0f;
+
+    //=========================================================================
+    // private methods.
+    //=========================================================================
+
+    //-------------------------------------------------------------------------
+    //      三角形の重心と法線を求めます.
+    //-------------------------------------------------------------------------
+    void SetupTriangles(uint32_t triangleCount)
+    {
+        m_Centroids.resize(triangleCount);
+        m_Normals  .resize(triangleCount);
+
+        for (auto i = 0u; i < triangleCount; ++i)
+        {
+            auto& p0 = m_pPositions[m_Triangles[i * 3 + 0]];
+            auto& p1 = m_pPositions[m_Triangles[i * 3 + 1]];
+            auto& p2 = m_pPositions[m_Triangles[i * 3 + 2]];
+
+            m_Centroids[i] = (p0 + p1 + p2) / 3.0f;
+
+            // 面積ゼロの三角形は法錐に寄与させない.
+            auto n = asdx::Vector3::Cross(p1 - p0, p2 - p0);
+            auto l = n.Length();
+            m_Normals[i] = (l > 1e-12f) ? n * (1.0f / l) : asdx::Vector3(0.0f, 0.0f, 0.0f);
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //      頂点から三角形への隣接情報を構築します.
+    //-------------------------------------------------------------------------
+    void SetupAdjacency(uint32_t triangleCount)
+    {
+        m_AdjacencyOffsets.resize(m_LocalIndices.size() + 1, 0);
+        for (auto index : m_Triangles)
+        { m_AdjacencyOffsets[index + 1]++; }
+
+        for (size_t i = 1; i < m_AdjacencyOffsets.size(); ++i)
+        { m_AdjacencyOffsets[i] += m_AdjacencyOffsets[i - 1]; }
+
+        std::vector<uint32_t> fill(m_AdjacencyOffsets.begin(), m_AdjacencyOffsets.end() - 1);
+        m_Adjacency.resize(m_Triangles.size());
+        for (auto i = 0u; i < triangleCount; ++i)
+        {
+            for (auto j = 0u; j < 3; ++j)
+            { m_Adjacency[fill[m_Triangles[i * 3 + j]]++] = i; }
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //      三角形を追加した場合に増える頂点数を求めます.
+    //-------------------------------------------------------------------------
+    uint32_t CountNewVertices(uint32_t triangle) const
+    {
+        auto count = 0u;
+        for (auto j = 0u; j < 3; ++j)
+        {
+            if (m_LocalIndices[m_Triangles[triangle * 3 + j]] == kInvalidIndex)
+            { count++; }
+        }
+        return count;
+    }
+
+    //-------------------------------------------------------------------------
+    //      この三角形が最後の未出力三角形となる頂点の数を求めます.
+    //-------------------------------------------------------------------------
+    uint32_t CountLastVertices(uint32_t triangle) const
+    {
+        auto count = 0u;
+        for (auto j = 0u; j < 3; ++j)
+        {
+            if (m_LiveCounts[m_Triangles[triangle * 3 + j]] == 1)
+            { count++; }
+        }
+        return count;
+    }
+
+    //-------------------------------------------------------------------------
+    //      現在のメッシュレットに三角形を追加できるかどうかチェックします.
+    //-------------------------------------------------------------------------
+    bool CanAppend(uint32_t triangle) const
+    {
+        return m_Vertices.size() + CountNewVertices(triangle) <= m_Desc.MaxVertices
+            && m_Primitives.size() < m_Desc.MaxPrimitives;
+    }
+
+    //-------------------------------------------------------------------------
+    //      三角形が現在のメッシュレットの近傍にあるかどうかチェックします.
+    //-------------------------------------------------------------------------
+    bool IsNear(uint32_t triangle) const
+    {
+        auto center = m_PositionSum / float(m_Vertices.size());
+        auto d = m_Centroids[triangle] - center;
+        return asdx::Vector3::Dot(d, d) <= m_RadiusSq * 4.0f;
+    }
+
+    //-------------------------------------------------------------------------
+    //      隣接する三角形から最も評価の良いものを探します.
+    //-------------------------------------------------------------------------
+    uint32_t FindCandidate()
+    {
+        if (m_Primitives.empty())
+        { return kInvalidIndex; }
+
+        auto center = m_PositionSum / float(m_Vertices.size());
+        auto radius = std::max(sqrtf(m_RadiusSq), 1e-6f);
+        auto axis   = asdx::Vector3(0.0f, 0.0f, 0.0f);
+        auto length = m_NormalSum.Length();
+        if (length > 1e-6f)
+        { axis = m_NormalSum / length; }
+
+        auto best      = kInvalidIndex;
+        auto bestScore = FLT_MAX;
+
+        size_t count = 0;
+        for (auto triangle : m_Candidates)
+        {
+            if (m_Emitted[triangle])
+            { continue; }
+
+            m_Candidates[count++] = triangle;
+
+            auto newVertices = CountNewVertices(triangle);
+            if (m_Vertices.size() + newVertices > m_Desc.MaxVertices)
+            { continue; }
+
+            // 新規頂点数を最優先し, 中心からの距離と法線のばらつきで順位付けする.
+            auto distance = (m_Centroids[triangle] - center).Length() / radius;
+            auto spread   = 1.0f - asdx::Vector3::Dot(m_Normals[triangle], axis);
+            auto score    = float(newVertices)
+                          + (1.0f - m_Desc.ConeWeight) * distance
+                          + m_Desc.ConeWeight * spread
+                          - kLastWeight * float(CountLastVertices(triangle));
+
+            if (score < bestScore)
+            {
+                best      = triangle;
+                bestScore = score;
+            }
+        }
+        m_Candidates.resize(count);
+
+        return best;
+    }
+
+    //-------------------------------------------------------------------------
+    //      三角形を現在のメッシュレットに追加します.
+    //-------------------------------------------------------------------------
+    void Append(uint32_t triangle)
+    {
+        uint32_t local[3];
+        for (auto j = 0u; j < 3; ++j)
+        {
+            auto index = m_Triangles[triangle * 3 + j];
+            if (m_LocalIndices[index] == kInvalidIndex)
+            {
+                m_LocalIndices[index] = uint32_t(m_Vertices.size());
+                m_Vertices.push_back(index);
+                m_PositionSum += m_pPositions[index];
+            }
+            local[j] = m_LocalIndices[index];
+        }
+
+        m_Primitives.push_back(PackPrimitiveIndex(local[0], local[1], local[2]));
+        m_NormalSum += m_Normals[triangle];
+        m_Emitted[triangle] = true;
+
+        for (auto j = 0u; j < 3; ++j)
+        { m_LiveCounts[m_Triangles[triangle * 3 + j]]--; }
+
+        auto center = m_PositionSum / float(m_Vertices.size());
+        for (auto j = 0u; j < 3; ++j)
+        {
+            auto d = m_pPositions[m_Triangles[triangle * 3 + j]] - center;
+            m_RadiusSq = std::max(m_RadiusSq, asdx::Vector3::Dot(d, d));
+        }
+
+        // 追加した頂点に隣接する三角形を候補に加える.
+        auto id = uint32_t(m_Result.Meshlets.size());
+        for (auto j = 0u; j < 3; ++j)
+        {
+            auto index = m_Triangles[triangle * 3 + j];
+            for (auto k = m_AdjacencyOffsets[index]; k < m_AdjacencyOffsets[index + 1]; ++k)
+            {
+                auto neighbor = m_Adjacency[k];
+                if (m_Emitted[neighbor] || m_Stamps[neighbor] == id)
+                { continue; }
+
+                m_Stamps[neighbor] = id;
+                m_Candidates.push_back(neighbor);
+            }
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //      現在のメッシュレットを確定します.
+    //-------------------------------------------------------------------------
+    void Flush()
+    {
+        if (m_Primitives.empty())
+        { return; }
+
+        Meshlet meshlet;
+        meshlet.VertexOffset    = uint32_t(m_Result.UniqueVertexIndices.size());
+        meshlet.VertexCount     = uint32_t(m_Vertices.size());
+        meshlet.PrimitiveOffset = uint32_t(m_Result.Primitives.size());
+        meshlet.PrimitiveCount  = uint32_t(m_Primitives.size());
+
+        m_Result.Meshlets.push_back(meshlet);
+        m_Result.UniqueVertexIndices.insert(
+            m_Result.UniqueVertexIndices.end(), m_Vertices.begin(), m_Vertices.end());
+        m_Result.Primitives.insert(
+            m_Result.Primitives.end(), m_Primitives.begin(), m_Primitives.end());
+        m_Result.CullInfos.push_back(ComputeCullInfo(meshlet));
+
+        for (auto index : m_Vertices)
+        { m_LocalIndices[index] = kInvalidIndex; }
+
+        m_Vertices  .clear();
+        m_Primitives.clear();
+        m_Candidates.clear();
+        m_PositionSum = asdx::Vector3(0.0f, 0.0f, 0.0f);
+        m_NormalSum   = asdx::Vector3(0.0f, 0.0f, 0.0f);
+        m_RadiusSq    = 0.0f;
+    }
+
+    //-------------------------------------------------------------------------
+    //      カリング情報を求めます.
+    //-------------------------------------------------------------------------
+    CullInfo ComputeCullInfo(const Meshlet& meshlet) const
+    {
+        CullInfo result;
+
+        std::vector<asdx::Vector3> points;
+        points.reserve(std::max(meshlet.VertexCount, meshlet.PrimitiveCount));
+        for (auto index : m_Vertices)
+        { points.push_back(m_pPositions[index]); }
+
+        auto sphere = ComputeBoundingSphere(points);
+        result.BoundingSphere = asdx::Vector4(sphere.Center, sphere.Radius);
+
+        // 縮退時は w = 1 (0xff) とし, シェーダ側で法錐カリングを行わない.
+        result.NormalCone = PackSnorm4(asdx::Vector4(0.0f, 0.0f, 0.0f, 1.0f));
+
+        // 単位球上の法線を包含する最小球の中心方向を軸とする.
+        points.clear();
+        for (auto primitive : m_Primitives)
+        {
+            auto i0 = m_Vertices[(primitive >>  0) & 0x3ff];
+            auto i1 = m_Vertices[(primitive >> 10) & 0x3ff];
+            auto i2 = m_Vertices[(primitive >> 20) & 0x3ff];
+            auto n  = asdx::Vector3::Cross(
+                m_pPositions[i1] - m_pPositions[i0],
+                m_pPositions[i2] - m_pPositions[i0]);
+            auto l = n.Length();
+            if (l > 1e-12f)
+            { points.push_back(n * (1.0f / l)); }
+        }
+
+        if (points.empty())
+        { return result; }
+
+        auto cone = ComputeBoundingSphere(points);
+        auto length = cone.Center.Length();
+        if (length < 1e-3f)
+        { return result; }
+
+        // 量子化後の軸で最小内積を求め, 保守的な値にする.
+        auto packedAxis = PackSnorm4(asdx::Vector4(cone.Center / length, 0.0f)) & 0x00ffffff;
+        auto unpacked   = UnpackSnorm4(packedAxis);
+        auto axis       = asdx::Vector3::Normalize(
+            asdx::Vector3(unpacked.x, unpacked.y, unpacked.z));
+
+        auto minDot = 1.0f;
+        for (auto& normal : points)
+        { minDot = std::min(minDot, asdx::Vector3::Dot(axis, normal)); }
+
+        if (minDot <= kDegenerateCone)
+        { return result; }
+
+        // dot(-view, axis) > sin(半角) の時に全面が裏向きとなる. 切り上げて保守的にする.
+        auto sinAngle = sqrtf(std::max(1.0f - minDot * minDot, 0.0f));
+        auto w = uint32_t(ceilf((sinAngle * 0.5f + 0.5f) * 255.0f));
+        w = std::min(w, 255u);
+
+        result.NormalCone = packedAxis | (w << 24);
+        return result;
+    }
+};
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      UnpackSnorm4()形式にパックします.
+//-----------------------------------------------------------------------------
+uint32_t PackSnorm4(const asdx::Vector4& value)
+{
+    auto pack = [](float v)
+    {
+        auto unorm = std::min(std::max(v * 0.5f + 0.5f, 0.0f), 1.0f);
+        return uint32_t(unorm * 255.0f + 0.5f);
+    };
+
+    return pack(value.x)
+        | (pack(value.y) << 8)
+        | (pack(value.z) << 16)
+        | (pack(value.w) << 24);
+}
+
+//-----------------------------------------------------------------------------
+//      UnpackSnorm4()形式の値を展開します.
+//-----------------------------------------------------------------------------
+asdx::Vector4 UnpackSnorm4(uint32_t value)
+{
+    auto unpack = [](uint32_t v)
+    { return float(v & 0xff) / 255.0f * 2.0f - 1.0f; };
+
+    return asdx::Vector4(
+        unpack(value),
+        unpack(value >> 8),
+        unpack(value >> 16),
+        unpack(value >> 24));
+}
+
+//-----------------------------------------------------------------------------
+//      メッシュレットを構築します.
+//-----------------------------------------------------------------------------
+bool BuildMeshlets
+(
+    const asdx::Vector3*    pPositions,
+    uint32_t                vertexCount,
+    const uint32_t*         pIndices,
+    uint32_t                indexCount,
+    const MeshletBuildDesc& desc,
+    MeshletData&            result
+)
+{
+    result = MeshletData();
+
+    if (pPositions == nullptr || pIndices == nullptr || (indexCount % 3) != 0)
+    {
+        ELOG("Error : Invalid Argument.");
+        return false;
+    }
+
+    // 出力頂点・プリミティブ数はメッシュシェーダの上限(256)に収める.
+    if (desc.MaxVertices < 3 || desc.MaxVertices > 256
+     || desc.MaxPrimitives < 1 || desc.MaxPrimitives > 256)
+    {
+        ELOG("Error : Invalid Meshlet Limits. MaxVertices = %u, MaxPrimitives = %u",
+            desc.MaxVertices, desc.MaxPrimitives);
+        return false;
+    }
+
+    for (auto i = 0u; i < indexCount; ++i)
+    {
+        if (pIndices[i] >= vertexCount)
+        {
+            ELOG("Error : Index Out Of Range. index = %u, vertexCount = %u",
+                pIndices[i], vertexCount);
+            return false;
+        }
+    }
+
+    MeshletContext context(pPositions, vertexCount, desc, result);
+    context.Build(pIndices, indexCount);
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      サブセットごとに並列でメッシュレットを構築します.
+//-----------------------------------------------------------------------------
+bool BuildMeshlets
+(
+    const asdx::Vector3*        pPositions,
+    uint32_t                    vertexCount,
+    const uint32_t*             pIndices,
+    const MeshletSubset*        pSubsets,
+    uint32_t                    subsetCount,
+    const MeshletBuildDesc&     desc,
+    std::vector<MeshletData>&   results
+)
+{
+    results.clear();
+    results.resize(subsetCount);
+
+    if (subsetCount == 0)
+    { return true; }
+
+    if (pSubsets == nullptr)
+    {
+        ELOG("Error : Invalid Argument.");
+        return false;
+    }
+
+    std::atomic<uint32_t> next(0);
+    std::atomic<bool>     succeeded(true);
+
+    auto worker = [&]()
+    {
+        for (auto i = next++; i < subsetCount; i = next++)
+        {
+            auto& subset = pSubsets[i];
+            if (!BuildMeshlets(
+                pPositions,
+                vertexCount,
+                pIndices + subset.IndexOffset,
+                subset.IndexCount,
+                desc,
+                results[i]))
+            { succeeded = false; }
+        }
+    };
+
+    auto threadCount = std::min(std::max(std::thread::hardware_concurrency(), 1u), subsetCount);
+
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount - 1);
+    for (auto i = 1u; i < threadCount; ++i)
+    { threads.emplace_back(worker); }
+
+    worker();
+
+    for (auto& thread : threads)
+    { thread.join(); }
+
+    return succeeded;
+}
+
+//-----------------------------------------------------------------------------
+//      メッシュレットの品質指標を求めます.
+//-----------------------------------------------------------------------------
+MeshletStatistics ComputeMeshletStatistics
+(
+    const MeshletData&      data,
+    const MeshletBuildDesc& desc
+)
+{
+    MeshletStatistics result;
+    result.MeshletCount = uint32_t(data.Meshlets.size());
+
+    if (data.Meshlets.empty())
+    { return result; }
+
+    auto vertexCount     = 0.0;
+    auto primitiveCount  = 0.0;
+    auto coneAngle       = 0.0;
+    auto radius          = 0.0;
+    auto degenerateCount = 0u;
+
+    for (size_t i = 0; i < data.Meshlets.size(); ++i)
+    {
+        vertexCount    += data.Meshlets[i].VertexCount;
+        primitiveCount += data.Meshlets[i].PrimitiveCount;
+        radius         += data.CullInfos[i].BoundingSphere.w;
+
+        auto packed = data.CullInfos[i].NormalCone;
+        if (IsConeDegenerate(packed))
+        {
+            degenerateCount++;
+            continue;
+        }
+
+        // w = sin(半角).
+        auto w = std::min(std::max(UnpackSnorm4(packed).w, 0.0f), 1.0f);
+        coneAngle += asinf(w) * 180.0 / 3.14159265358979;
+    }
+
+    auto count = double(data.Meshlets.size());
+    result.VertexFillRate     = float(vertexCount / (count * desc.MaxVertices));
+    result.PrimitiveFillRate  = float(primitiveCount / (count * desc.MaxPrimitives));
+    result.DegenerateConeRate = float(degenerateCount / count);
+    result.AverageRadius      = float(radius / count);
+
+    if (degenerateCount < data.Meshlets.size())
+    { result.AverageConeAngle = float(coneAngle / (count - degenerateCount)); }
+
+    return result;
+}
@@ -0,0 +1,472 @@
+﻿//-----------------------------------------------------------------------------
+// File : MeshletCulling.cpp
+// Desc : CPU Emulation of Meshlet Culling.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <MeshletCulling.h>
+#include <fnd/asdxLogger.h>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cmath>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define MESHLET_CULLING_SSE     (1)
+#include <emmintrin.h>
+#endif
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+//      HLSL の normalize() と同様に正規化します(ゼロベクトルは非数になります).
+//-----------------------------------------------------------------------------
+asdx::Vector3 NormalizeHLSL(const asdx::Vector3& value)
+{
+    auto invLength = 1.0f / sqrtf(value.x * value.x + value.y * value.y + value.z * value.z);
+    return asdx::Vector3(value.x * invLength, value.y * invLength, value.z * invLength);
+}
+
+//-----------------------------------------------------------------------------
+//      mul(world, float4(value, 1.0f)).xyz を求めます.
+//-----------------------------------------------------------------------------
+asdx::Vector3 TransformCoord(const asdx::Vector3& value, const asdx::Matrix& m)
+{
+    return asdx::Vector3(
+        value.x * m._11 + value.y * m._21 + value.z * m._31 + m._41,
+        value.x * m._12 + value.y * m._22 + value.z * m._32 + m._42,
+        value.x * m._13 + value.y * m._23 + value.z * m._33 + m._43);
+}
+
+//-----------------------------------------------------------------------------
+//      mul((float3x3)world, value) を求めます.
+//-----------------------------------------------------------------------------
+asdx::Vector3 TransformNormal(const asdx::Vector3& value, const asdx::Matrix& m)
+{
+    return asdx::Vector3(
+        value.x * m._11 + value.y * m._21 + value.z * m._31,
+        value.x * m._12 + value.y * m._22 + value.z * m._32,
+        value.x * m._13 + value.y * m._23 + value.z * m._33);
+}
+
+#if MESHLET_CULLING_SSE
+//-----------------------------------------------------------------------------
+//      4要素の積和を求めます.
+//-----------------------------------------------------------------------------
+inline __m128 Dot3(__m128 ax, __m128 ay, __m128 az, __m128 bx, __m128 by, __m128 bz)
+{
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)), _mm_mul_ps(az, bz));
+}
+
+//-----------------------------------------------------------------------------
+//      4ビットのマスクに含まれるビット数を求めます.
+//-----------------------------------------------------------------------------
+inline uint32_t CountBits4(int mask)
+{ return uint32_t((mask & 0x1) + ((mask >> 1) & 0x1) + ((mask >> 2) & 0x1) + ((mask >> 3) & 0x1)); }
+#endif
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      球が視錐台に含まれるかどうかチェックします.
+//-----------------------------------------------------------------------------
+bool Contains(const asdx::Vector4* planes, const asdx::Vector4& sphere)
+{
+    for (auto i = 0; i < 6; ++i)
+    {
+        auto& plane = planes[i];
+        auto d = plane.x * sphere.x + plane.y * sphere.y + plane.z * sphere.z + plane.w;
+        if (d < -sphere.w)
+        { return false; }
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      法錐により全面が裏向きとなるかどうかチェックします.
+//-----------------------------------------------------------------------------
+bool NormalConeCulling(const asdx::Vector4& normalCone, const asdx::Vector3& viewDir)
+{
+    auto d = -viewDir.x * normalCone.x - viewDir.y * normalCone.y - viewDir.z * normalCone.z;
+    return d > normalCone.w;
+}
+
+//-----------------------------------------------------------------------------
+//      SampleAS.hlsl の IsVisible() を CPU で評価します.
+//-----------------------------------------------------------------------------
+bool IsVisible(const CullInfo& cullInfo, const CullParam& param)
+{
+    // [-1, 1]に展開.
+    auto normalCone = UnpackSnorm4(cullInfo.NormalCone);
+
+    // ワールド空間に変換.
+    auto& sphere = cullInfo.BoundingSphere;
+    auto center = TransformCoord(asdx::Vector3(sphere.x, sphere.y, sphere.z), param.World);
+    auto axis   = NormalizeHLSL(TransformNormal(
+        asdx::Vector3(normalCone.x, normalCone.y, normalCone.z), param.World));
+
+    // スケールを考慮した半径を求める.
+    auto radius = sphere.w * param.Scale;
+
+    // 視錐台カリング.
+    if (!Contains(param.Planes, asdx::Vector4(center, radius)))
+    { return false; }
+
+    // 縮退チェック.
+    if (IsConeDegenerate(cullInfo.NormalCone))
+    { return true; }
+
+    // 視線ベクトルを求める.
+    auto viewDir = NormalizeHLSL(param.CameraPos - center);
+
+    // 法錐カリング.
+    if (NormalConeCulling(asdx::Vector4(axis, normalCone.w), viewDir))
+    { return false; }
+
+    return true;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// MeshletCuller class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      初期化処理を行います.
+//-----------------------------------------------------------------------------
+void MeshletCuller::Init(const Meshlet* pMeshlets, const CullInfo* pCullInfos, uint32_t count)
+{
+    Term();
+
+    if (pMeshlets == nullptr || pCullInfos == nullptr)
+    { count = 0; }
+
+    // 4要素単位で処理できるよう SoA に並べ替えて末尾をゼロで埋める.
+    auto padded = (count + 3) & ~3u;
+    m_Count = count;
+    m_CenterX   .resize(padded, 0.0f);
+    m_CenterY   .resize(padded, 0.0f);
+    m_CenterZ   .resize(padded, 0.0f);
+    m_Radius    .resize(padded, 0.0f);
+    m_AxisX     .resize(padded, 0.0f);
+    m_AxisY     .resize(padded, 0.0f);
+    m_AxisZ     .resize(padded, 0.0f);
+    m_CutOff    .resize(padded, 0.0f);
+    m_NormalCone.resize(padded, 0);
+    m_Degenerate.resize(padded, 0);
+    m_Primitives.resize(padded, 0);
+
+    for (auto i = 0u; i < count; ++i)
+    {
+        auto& info = pCullInfos[i];
+        auto  cone = UnpackSnorm4(info.NormalCone);
+
+        m_CenterX   [i] = info.BoundingSphere.x;
+        m_CenterY   [i] = info.BoundingSphere.y;
+        m_CenterZ   [i] = info.BoundingSphere.z;
+        m_Radius    [i] = info.BoundingSphere.w;
+        m_AxisX     [i] = cone.x;
+        m_AxisY     [i] = cone.y;
+        m_AxisZ     [i] = cone.z;
+        m_CutOff    [i] = cone.w;
+        m_NormalCone[i] = info.NormalCone;
+        m_Degenerate[i] = IsConeDegenerate(info.NormalCone) ? -1 : 0;
+        m_Primitives[i] = int(pMeshlets[i].PrimitiveCount);
+
+        m_TriangleCount += pMeshlets[i].PrimitiveCount;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      終了処理を行います.
+//-----------------------------------------------------------------------------
+void MeshletCuller::Term()
+{
+    m_Count         = 0;
+    m_TriangleCount = 0;
+    m_CenterX   .clear();
+    m_CenterY   .clear();
+    m_CenterZ   .clear();
+    m_Radius    .clear();
+    m_AxisX     .clear();
+    m_AxisY     .clear();
+    m_AxisZ     .clear();
+    m_CutOff    .clear();
+    m_NormalCone.clear();
+    m_Degenerate.clear();
+    m_Primitives.clear();
+}
+
+//-----------------------------------------------------------------------------
+//      全メッシュレットをカリングします.
+//-----------------------------------------------------------------------------
+CullStatistics MeshletCuller::Cull(const CullParam& param, std::vector<uint8_t>* pVisibility) const
+{
+    CullStatistics result;
+    result.MeshletCount  = m_Count;
+    result.TriangleCount = m_TriangleCount;
+
+    if (pVisibility != nullptr)
+    { pVisibility->resize(m_Count); }
+
+#if MESHLET_CULLING_SSE
+    auto& m = param.World;
+    auto m11 = _mm_set1_ps(m._11), m12 = _mm_set1_ps(m._12), m13 = _mm_set1_ps(m._13);
+    auto m21 = _mm_set1_ps(m._21), m22 = _mm_set1_ps(m._22), m23 = _mm_set1_ps(m._23);
+    auto m31 = _mm_set1_ps(m._31), m32 = _mm_set1_ps(m._32), m33 = _mm_set1_ps(m._33);
+    auto m41 = _mm_set1_ps(m._41), m42 = _mm_set1_ps(m._42), m43 = _mm_set1_ps(m._43);
+
+    auto camX  = _mm_set1_ps(param.CameraPos.x);
+    auto camY  = _mm_set1_ps(param.CameraPos.y);
+    auto camZ  = _mm_set1_ps(param.CameraPos.z);
+    auto scale = _mm_set1_ps(param.Scale);
+    auto one   = _mm_set1_ps(1.0f);
+    auto zero  = _mm_setzero_ps();
+    auto full  = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+    auto triangles = _mm_setzero_si128();
+
+    for (auto i = 0u; i < m_Count; i += 4)
+    {
+        auto cx = _mm_loadu_ps(&m_CenterX[i]);
+        auto cy = _mm_loadu_ps(&m_CenterY[i]);
+        auto cz = _mm_loadu_ps(&m_CenterZ[i]);
+
+        // ワールド空間に変換.
+        auto wx = _mm_add_ps(Dot3(cx, cy, cz, m11, m21, m31), m41);
+        auto wy = _mm_add_ps(Dot3(cx, cy, cz, m12, m22, m32), m42);
+        auto wz = _mm_add_ps(Dot3(cx, cy, cz, m13, m23, m33), m43);
+
+        // スケールを考慮した半径を求める.
+        auto negR = _mm_sub_ps(zero, _mm_mul_ps(_mm_loadu_ps(&m_Radius[i]), scale));
+
+        // 視錐台カリング. HLSL と同じく d < -r の時のみ外側とする.
+        auto inside = full;
+        for (auto j = 0; j < 6; ++j)
+        {
+            auto& plane = param.Planes[j];
+            auto d = _mm_add_ps(Dot3(wx, wy, wz,
+                _mm_set1_ps(plane.x), _mm_set1_ps(plane.y), _mm_set1_ps(plane.z)),
+                _mm_set1_ps(plane.w));
+            inside = _mm_and_ps(inside, _mm_cmpnlt_ps(d, negR));
+        }
+
+        // 軸をワールド空間に変換して正規化.
+        auto nx = _mm_loadu_ps(&m_AxisX[i]);
+        auto ny = _mm_loadu_ps(&m_AxisY[i]);
+        auto nz = _mm_loadu_ps(&m_AxisZ[i]);
+        auto ax = Dot3(nx, ny, nz, m11, m21, m31);
+        auto ay = Dot3(nx, ny, nz, m12, m22, m32);
+        auto az = Dot3(nx, ny, nz, m13, m23, m33);
+        auto invA = _mm_div_ps(one, _mm_sqrt_ps(Dot3(ax, ay, az, ax, ay, az)));
+
+        // 視線ベクトルを求める.
+        auto vx = _mm_sub_ps(camX, wx);
+        auto vy = _mm_sub_ps(camY, wy);
+        auto vz = _mm_sub_ps(camZ, wz);
+        auto invV = _mm_div_ps(one, _mm_sqrt_ps(Dot3(vx, vy, vz, vx, vy, vz)));
+
+        // 法錐カリング: dot(-viewDir, axis) > w.
+        auto d = _mm_mul_ps(_mm_mul_ps(Dot3(vx, vy, vz, ax, ay, az), invA), invV);
+        auto culled = _mm_cmpgt_ps(_mm_sub_ps(zero, d), _mm_loadu_ps(&m_CutOff[i]));
+
+        auto degenerate = _mm_castsi128_ps(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(&m_Degenerate[i])));
+        auto visible = _mm_and_ps(inside, _mm_or_ps(degenerate, _mm_andnot_ps(culled, full)));
+
+        // 端数のレーンを除外する.
+        auto valid = (m_Count - i >= 4) ? 0xf : int((1u << (m_Count - i)) - 1);
+        auto visibleMask = _mm_movemask_ps(visible) & valid;
+        auto insideMask  = _mm_movemask_ps(inside)  & valid;
+        auto coneMask    = _mm_movemask_ps(_mm_andnot_ps(degenerate, culled)) & insideMask;
+
+        result.VisibleMeshlets += CountBits4(visibleMask);
+        result.FrustumCulled   += CountBits4(valid & ~insideMask);
+        result.ConeCulled      += CountBits4(coneMask);
+
+        // パディングのプリミティブ数はゼロなので有効レーンのマスクは不要.
+        auto primitives = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&m_Primitives[i]));
+        triangles = _mm_add_epi32(triangles, _mm_and_si128(primitives, _mm_castps_si128(visible)));
+
+        if (pVisibility != nullptr)
+        {
+            for (auto j = 0u; j < 4 && i + j < m_Count; ++j)
+            { (*pVisibility)[i + j] = uint8_t((visibleMask >> j) & 0x1); }
+        }
+    }
+
+    alignas(16) int sum[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(sum), triangles);
+    result.VisibleTriangles = uint32_t(sum[0] + sum[1] + sum[2] + sum[3]);
+#else
+    for (auto i = 0u; i < m_Count; ++i)
+    {
+        CullInfo info;
+        info.BoundingSphere = asdx::Vector4(m_CenterX[i], m_CenterY[i], m_CenterZ[i], m_Radius[i]);
+        info.NormalCone     = m_NormalCone[i];
+
+        auto center = TransformCoord(asdx::Vector3(m_CenterX[i], m_CenterY[i], m_CenterZ[i]), param.World);
+        auto inside = Contains(param.Planes, asdx::Vector4(center, m_Radius[i] * param.Scale));
+        auto visible = IsVisible(info, param);
+
+        if (!inside)
+        { result.FrustumCulled++; }
+        else if (!visible)
+        { result.ConeCulled++; }
+        else
+        {
+            result.VisibleMeshlets++;
+            result.VisibleTriangles += uint32_t(m_Primitives[i]);
+        }
+
+        if (pVisibility != nullptr)
+        { (*pVisibility)[i] = visible ? 1 : 0; }
+    }
+#endif
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      メッシュレット数を取得します.
+//-----------------------------------------------------------------------------
+uint32_t MeshletCuller::GetMeshletCount() const
+{ return m_Count; }
+
+//-----------------------------------------------------------------------------
+//      カメラパスをテキストファイルに保存します.
+//-----------------------------------------------------------------------------
+bool SaveCameraPath(const char* path, const std::vector<CameraKey>& keys)
+{
+    std::ofstream stream(path);
+    if (!stream.is_open())
+    {
+        ELOG("Error : File Open Failed. path = %s", path);
+        return false;
+    }
+
+    stream << std::setprecision(9);
+    for (auto& key : keys)
+    {
+        for (auto i = 0; i < 16; ++i)
+        { stream << key.View.m[i / 4][i % 4] << " "; }
+
+        stream << key.Position.x << " " << key.Position.y << " " << key.Position.z << " ";
+        stream << key.FieldOfView << " " << key.AspectRatio << " ";
+        stream << key.NearClip    << " " << key.FarClip     << "\n";
+    }
+
+    return stream.good();
+}
+
+//-----------------------------------------------------------------------------
+//      カメラパスをテキストファイルから読み込みます.
+//-----------------------------------------------------------------------------
+bool LoadCameraPath(const char* path, std::vector<CameraKey>& keys)
+{
+    keys.clear();
+
+    std::ifstream stream(path);
+    if (!stream.is_open())
+    {
+        ELOG("Error : File Open Failed. path = %s", path);
+        return false;
+    }
+
+    std::string line;
+    auto lineNo = 0u;
+    while (std::getline(stream, line))
+    {
+        lineNo++;
+        if (line.empty() || line[0] == '#')
+        { continue; }
+
+        CameraKey key;
+        std::istringstream values(line);
+        for (auto i = 0; i < 16; ++i)
+        { values >> key.View.m[i / 4][i % 4]; }
+
+        values >> key.Position.x >> key.Position.y >> key.Position.z;
+        values >> key.FieldOfView >> key.AspectRatio >> key.NearClip >> key.FarClip;
+
+        if (values.fail())
+        {
+            ELOG("Error : Invalid Camera Key. path = %s, line = %u", path, lineNo);
+            return false;
+        }
+
+        keys.push_back(key);
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      カメラパスを再生してカリング率を集計します.
+//-----------------------------------------------------------------------------
+ReplayReport ReplayCameraPath
+(
+    const MeshletCuller&            culler,
+    const asdx::Matrix&             world,
+    float                           scale,
+    const std::vector<CameraKey>&   keys
+)
+{
+    ReplayReport result;
+    result.FrameCount = uint32_t(keys.size());
+
+    if (keys.empty() || culler.GetMeshletCount() == 0)
+    { return result; }
+
+    result.MinCullRatio = 1.0f;
+
+    auto sumCull     = 0.0;
+    auto sumFrustum  = 0.0;
+    auto sumCone     = 0.0;
+    auto sumTriangle = 0.0;
+
+    for (auto& key : keys)
+    {
+        auto proj = asdx::Matrix::CreatePerspectiveFieldOfView(
+            key.FieldOfView,
+            key.AspectRatio,
+            key.NearClip,
+            key.FarClip);
+
+        CullParam param;
+        param.World     = world;
+        param.Scale     = scale;
+        param.CameraPos = key.Position;
+        asdx::CalcFrustumPlanes(key.View, proj, param.Planes);
+
+        auto stats = culler.Cull(param);
+
+        auto count = float(stats.MeshletCount);
+        auto ratio = 1.0f - float(stats.VisibleMeshlets) / count;
+
+        result.MinCullRatio = std::min(result.MinCullRatio, ratio);
+        result.MaxCullRatio = std::max(result.MaxCullRatio, ratio);
+
+        sumCull    += ratio;
+        sumFrustum += float(stats.FrustumCulled) / count;
+        sumCone    += float(stats.ConeCulled)    / count;
+
+        if (stats.TriangleCount > 0)
+        { sumTriangle += 1.0 - double(stats.VisibleTriangles) / double(stats.TriangleCount); }
+    }
+
+    auto frames = double(keys.size());
+    result.AverageCullRatio = float(sumCull     / frames);
+    result.FrustumCullRatio = float(sumFrustum  / frames);
+    result.ConeCullRatio    = float(sumCone     / frames);
+    result.TriangleSavings  = float(sumTriangle / frames);
+
+    return result;
+}
@@ -0,0 +1,437 @@
+﻿//-----------------------------------------------------------------------------
+// File : MeshletEncoder.cpp
+// Desc : Compressed Meshlet Encoding.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <MeshletEncoder.h>
+#include <fnd/asdxLogger.h>
+#include <algorithm>
+#include <cstring>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t kUnassigned = ~0u;
+
+
+//-----------------------------------------------------------------------------
+//      1プリミティブあたりのバイト数を取得します.
+//-----------------------------------------------------------------------------
+uint32_t GetPrimitiveStride(MESHLET_PRIMITIVE_FORMAT format)
+{ return (format == MESHLET_PRIMITIVE_U8X3) ? 3 : 4; }
+
+//-----------------------------------------------------------------------------
+//      1頂点あたりの位置座標のバイト数を取得します.
+//-----------------------------------------------------------------------------
+uint32_t GetPositionStride(MESHLET_POSITION_FORMAT format)
+{ return (format == MESHLET_POSITION_UNORM16) ? 6 : 4; }
+
+//-----------------------------------------------------------------------------
+//      [0, 1]の値を指定ビット数のunormに変換します.
+//-----------------------------------------------------------------------------
+uint32_t ToUnorm(float value, uint32_t maxValue)
+{ return uint32_t(std::min(std::max(value, 0.0f), 1.0f) * float(maxValue) + 0.5f); }
+
+//-----------------------------------------------------------------------------
+//      範囲内の相対位置を求めます.
+//-----------------------------------------------------------------------------
+float ToRelative(float value, float mini, float size)
+{ return (size > 0.0f) ? (value - mini) / size : 0.0f; }
+
+//-----------------------------------------------------------------------------
+//      三角形の並びと頂点番号の割り当てを決めます.
+//-----------------------------------------------------------------------------
+void ReorderMeshlet
+(
+    const uint32_t*         pPrimitives,
+    uint32_t                primitiveCount,
+    uint32_t                vertexCount,
+    std::vector<uint32_t>&  triangles,
+    std::vector<uint32_t>&  remap
+)
+{
+    std::vector<uint32_t> source(primitiveCount * 3);
+    for (auto i = 0u; i < primitiveCount; ++i)
+    {
+        source[i * 3 + 0] = (pPrimitives[i] >>  0) & 0x3ff;
+        source[i * 3 + 1] = (pPrimitives[i] >> 10) & 0x3ff;
+        source[i * 3 + 2] = (pPrimitives[i] >> 20) & 0x3ff;
+    }
+
+    std::vector<bool>     used(primitiveCount, false);
+    std::vector<uint32_t> newIndex(vertexCount, kUnassigned);
+
+    triangles.clear();
+    remap.clear();
+
+    auto last = kUnassigned;
+    for (auto k = 0u; k < primitiveCount; ++k)
+    {
+        // 直前の三角形と共有する頂点が最も多い三角形を選ぶ.
+        auto best      = kUnassigned;
+        auto bestShare = -1;
+        for (auto i = 0u; i < primitiveCount; ++i)
+        {
+            if (used[i])
+            { continue; }
+
+            auto share = 0;
+            if (last != kUnassigned)
+            {
+                for (auto a = 0u; a < 3; ++a)
+                for (auto b = 0u; b < 3; ++b)
+                {
+                    if (source[i * 3 + a] == source[last * 3 + b])
+                    { share++; }
+                }
+            }
+
+            if (share > bestShare)
+            {
+                best      = i;
+                bestShare = share;
+                if (share >= 2)
+                { break; }
+            }
+        }
+
+        used[best] = true;
+        last = best;
+
+        // 割り当て済みで最小の番号が先頭に来るよう回転させる(巻き順は変わらない).
+        auto rotate = 0u;
+        for (auto r = 1u; r < 3; ++r)
+        {
+            if (newIndex[source[best * 3 + r]] < newIndex[source[best * 3 + rotate]])
+            { rotate = r; }
+        }
+
+        for (auto r = 0u; r < 3; ++r)
+        {
+            auto index = source[best * 3 + (rotate + r) % 3];
+            if (newIndex[index] == kUnassigned)
+            {
+                newIndex[index] = uint32_t(remap.size());
+                remap.push_back(index);
+            }
+            triangles.push_back(newIndex[index]);
+        }
+    }
+
+    // 三角形から参照されない頂点も保持する.
+    for (auto i = 0u; i < vertexCount; ++i)
+    {
+        if (newIndex[i] == kUnassigned)
+        {
+            newIndex[i] = uint32_t(remap.size());
+            remap.push_back(i);
+        }
+    }
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      メッシュレットを圧縮形式に変換します.
+//-----------------------------------------------------------------------------
+bool EncodeMeshlets
+(
+    const asdx::Vector3*        pPositions,
+    uint32_t                    vertexCount,
+    const MeshletData&          source,
+    const MeshletEncodeDesc&    desc,
+    EncodedMeshletData&         result
+)
+{
+    result = EncodedMeshletData();
+    result.PrimitiveFormat = desc.PrimitiveFormat;
+    result.PositionFormat  = desc.PositionFormat;
+
+    if (pPositions == nullptr || source.Meshlets.size() != source.CullInfos.size())
+    {
+        ELOG("Error : Invalid Argument.");
+        return false;
+    }
+
+    auto primitiveStride = GetPrimitiveStride(desc.PrimitiveFormat);
+    auto positionStride  = GetPositionStride (desc.PositionFormat);
+
+    result.Meshlets     .reserve(source.Meshlets.size());
+    result.VertexIndices.reserve(source.UniqueVertexIndices.size());
+    result.Primitives   .reserve(source.Primitives.size() * primitiveStride);
+    result.Positions    .reserve(source.UniqueVertexIndices.size() * positionStride);
+    result.CullInfos    = source.CullInfos;
+
+    std::vector<uint32_t> triangles;
+    std::vector<uint32_t> remap;
+
+    for (auto& meshlet : source.Meshlets)
+    {
+        if (meshlet.VertexOffset + meshlet.VertexCount > source.UniqueVertexIndices.size()
+         || meshlet.PrimitiveOffset + meshlet.PrimitiveCount > source.Primitives.size())
+        {
+            ELOG("Error : Meshlet Out Of Range.");
+            return false;
+        }
+
+        // 8bit に収まらないローカル番号は格納できない.
+        if (meshlet.VertexCount > 256 || meshlet.PrimitiveCount > 0xffff)
+        {
+            ELOG("Error : Meshlet Too Large. VertexCount = %u, PrimitiveCount = %u",
+                meshlet.VertexCount, meshlet.PrimitiveCount);
+            return false;
+        }
+
+        auto pIndices    = source.UniqueVertexIndices.data() + meshlet.VertexOffset;
+        auto pPrimitives = source.Primitives.data() + meshlet.PrimitiveOffset;
+
+        if (desc.Reorder)
+        {
+            ReorderMeshlet(pPrimitives, meshlet.PrimitiveCount, meshlet.VertexCount, triangles, remap);
+        }
+        else
+        {
+            triangles.resize(meshlet.PrimitiveCount * 3);
+            for (auto i = 0u; i < meshlet.PrimitiveCount; ++i)
+            {
+                triangles[i * 3 + 0] = (pPrimitives[i] >>  0) & 0x3ff;
+                triangles[i * 3 + 1] = (pPrimitives[i] >> 10) & 0x3ff;
+                triangles[i * 3 + 2] = (pPrimitives[i] >> 20) & 0x3ff;
+            }
+
+            remap.resize(meshlet.VertexCount);
+            for (auto i = 0u; i < meshlet.VertexCount; ++i)
+            { remap[i] = i; }
+        }
+
+        for (auto index : triangles)
+        {
+            if (index >= meshlet.VertexCount)
+            {
+                ELOG("Error : Local Index Out Of Range. index = %u", index);
+                return false;
+            }
+        }
+
+        for (auto i = 0u; i < meshlet.VertexCount; ++i)
+        {
+            if (pIndices[i] >= vertexCount)
+            {
+                ELOG("Error : Vertex Index Out Of Range. index = %u", pIndices[i]);
+                return false;
+            }
+        }
+
+        EncodedMeshlet encoded = {};
+        encoded.VertexOffset    = uint32_t(result.VertexIndices.size());
+        encoded.PrimitiveOffset = uint32_t(result.Primitives.size());
+        encoded.VertexCount     = uint16_t(meshlet.VertexCount);
+        encoded.PrimitiveCount  = uint16_t(meshlet.PrimitiveCount);
+
+        // 量子化範囲はメッシュレットのバウンディングボックスとする.
+        if (meshlet.VertexCount > 0)
+        {
+            auto mini = pPositions[pIndices[0]];
+            auto maxi = mini;
+            for (auto i = 1u; i < meshlet.VertexCount; ++i)
+            {
+                mini = asdx::Vector3::Min(mini, pPositions[pIndices[i]]);
+                maxi = asdx::Vector3::Max(maxi, pPositions[pIndices[i]]);
+            }
+
+            encoded.BoundsMin[0]  = mini.x;
+            encoded.BoundsMin[1]  = mini.y;
+            encoded.BoundsMin[2]  = mini.z;
+            encoded.BoundsSize[0] = maxi.x - mini.x;
+            encoded.BoundsSize[1] = maxi.y - mini.y;
+            encoded.BoundsSize[2] = maxi.z - mini.z;
+        }
+
+        for (auto i = 0u; i < meshlet.VertexCount; ++i)
+        {
+            auto index = pIndices[remap[i]];
+            result.VertexIndices.push_back(index);
+
+            auto& p = pPositions[index];
+            auto x = ToRelative(p.x, encoded.BoundsMin[0], encoded.BoundsSize[0]);
+            auto y = ToRelative(p.y, encoded.BoundsMin[1], encoded.BoundsSize[1]);
+            auto z = ToRelative(p.z, encoded.BoundsMin[2], encoded.BoundsSize[2]);
+
+            if (desc.PositionFormat == MESHLET_POSITION_UNORM16)
+            {
+                uint16_t q[3] = {
+                    uint16_t(ToUnorm(x, 0xffff)),
+                    uint16_t(ToUnorm(y, 0xffff)),
+                    uint16_t(ToUnorm(z, 0xffff))
+                };
+                auto offset = result.Positions.size();
+                result.Positions.resize(offset + sizeof(q));
+                memcpy(result.Positions.data() + offset, q, sizeof(q));
+            }
+            else
+            {
+                uint32_t q = ToUnorm(x, 0x7ff) | (ToUnorm(y, 0x7ff) << 11) | (ToUnorm(z, 0x3ff) << 22);
+                auto offset = result.Positions.size();
+                result.Positions.resize(offset + sizeof(q));
+                memcpy(result.Positions.data() + offset, &q, sizeof(q));
+            }
+        }
+
+        for (auto i = 0u; i < meshlet.PrimitiveCount; ++i)
+        {
+            auto i0 = triangles[i * 3 + 0];
+            auto i1 = triangles[i * 3 + 1];
+            auto i2 = triangles[i * 3 + 2];
+
+            if (desc.PrimitiveFormat == MESHLET_PRIMITIVE_U8X3)
+            {
+                result.Primitives.push_back(uint8_t(i0));
+                result.Primitives.push_back(uint8_t(i1));
+                result.Primitives.push_back(uint8_t(i2));
+            }
+            else
+            {
+                auto packed = PackPrimitiveIndex(i0, i1, i2);
+                auto offset = result.Primitives.size();
+                result.Primitives.resize(offset + sizeof(packed));
+                memcpy(result.Primitives.data() + offset, &packed, sizeof(packed));
+            }
+        }
+
+        result.Meshlets.push_back(encoded);
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      圧縮形式からメッシュレットを復元します.
+//-----------------------------------------------------------------------------
+bool DecodeMeshlets
+(
+    const EncodedMeshletData&   source,
+    MeshletData&                result,
+    std::vector<asdx::Vector3>* pPositions
+)
+{
+    result = MeshletData();
+    if (pPositions != nullptr)
+    { pPositions->clear(); }
+
+    auto primitiveStride = GetPrimitiveStride(source.PrimitiveFormat);
+    auto positionStride  = GetPositionStride (source.PositionFormat);
+
+    result.Meshlets .reserve(source.Meshlets.size());
+    result.CullInfos = source.CullInfos;
+    result.UniqueVertexIndices = source.VertexIndices;
+
+    if (pPositions != nullptr)
+    { pPositions->reserve(source.VertexIndices.size()); }
+
+    for (auto& encoded : source.Meshlets)
+    {
+        if (size_t(encoded.VertexOffset) + encoded.VertexCount > source.VertexIndices.size()
+         || (size_t(encoded.VertexOffset) + encoded.VertexCount) * positionStride > source.Positions.size()
+         || size_t(encoded.PrimitiveOffset) + size_t(encoded.PrimitiveCount) * primitiveStride > source.Primitives.size())
+        {
+            ELOG("Error : Encoded Meshlet Out Of Range.");
+            return false;
+        }
+
+        Meshlet meshlet;
+        meshlet.VertexOffset    = encoded.VertexOffset;
+        meshlet.VertexCount     = encoded.VertexCount;
+        meshlet.PrimitiveOffset = uint32_t(result.Primitives.size());
+        meshlet.PrimitiveCount  = encoded.PrimitiveCount;
+
+        auto pPrimitive = source.Primitives.data() + encoded.PrimitiveOffset;
+        for (auto i = 0u; i < encoded.PrimitiveCount; ++i, pPrimitive += primitiveStride)
+        {
+            uint32_t packed;
+            if (source.PrimitiveFormat == MESHLET_PRIMITIVE_U8X3)
+            { packed = PackPrimitiveIndex(pPrimitive[0], pPrimitive[1], pPrimitive[2]); }
+            else
+            { memcpy(&packed, pPrimitive, sizeof(packed)); }
+
+            result.Primitives.push_back(packed);
+        }
+
+        if (pPositions != nullptr)
+        {
+            auto pPosition = source.Positions.data() + size_t(encoded.VertexOffset) * positionStride;
+            for (auto i = 0u; i < encoded.VertexCount; ++i, pPosition += positionStride)
+            {
+                float x, y, z;
+                if (source.PositionFormat == MESHLET_POSITION_UNORM16)
+                {
+                    uint16_t q[3];
+                    memcpy(q, pPosition, sizeof(q));
+                    x = float(q[0]) / 65535.0f;
+                    y = float(q[1]) / 65535.0f;
+                    z = float(q[2]) / 65535.0f;
+                }
+                else
+                {
+                    uint32_t q;
+                    memcpy(&q, pPosition, sizeof(q));
+                    x = float((q >>  0) & 0x7ff) / 2047.0f;
+                    y = float((q >> 11) & 0x7ff) / 2047.0f;
+                    z = float((q >> 22) & 0x3ff) / 1023.0f;
+                }
+
+                pPositions->push_back(asdx::Vector3(
+                    encoded.BoundsMin[0] + x * encoded.BoundsSize[0],
+                    encoded.BoundsMin[1] + y * encoded.BoundsSize[1],
+                    encoded.BoundsMin[2] + z * encoded.BoundsSize[2]));
+            }
+        }
+
+        result.Meshlets.push_back(meshlet);
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      現在のレイアウトに対するサイズを集計します.
+//-----------------------------------------------------------------------------
+MeshletSizeReport ComputeMeshletSizeReport
+(
+    const MeshletData&          source,
+    uint32_t                    vertexCount,
+    const EncodedMeshletData&   encoded
+)
+{
+    MeshletSizeReport result;
+
+    result.SourceBytes = source.Meshlets.size()            * sizeof(Meshlet)
+                       + source.UniqueVertexIndices.size() * sizeof(uint32_t)
+                       + source.Primitives.size()          * sizeof(uint32_t)
+                       + source.CullInfos.size()           * sizeof(CullInfo)
+                       + size_t(vertexCount)               * sizeof(float) * 3;
+
+    result.MeshletBytes   = encoded.Meshlets.size()      * sizeof(EncodedMeshlet);
+    result.IndexBytes     = encoded.VertexIndices.size() * sizeof(uint32_t);
+    result.PrimitiveBytes = encoded.Primitives.size();
+    result.PositionBytes  = encoded.Positions.size();
+    result.CullInfoBytes  = encoded.CullInfos.size()     * sizeof(CullInfo);
+
+    result.EncodedBytes = result.MeshletBytes
+                        + result.IndexBytes
+                        + result.PrimitiveBytes
+                        + result.PositionBytes
+                        + result.CullInfoBytes;
+
+    if (result.SourceBytes > 0)
+    { result.Ratio = float(double(result.EncodedBytes) / double(result.SourceBytes)); }
+
+    return result;
+}
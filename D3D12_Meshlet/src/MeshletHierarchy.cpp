@@ -0,0 +1,788 @@
+﻿//-----------------------------------------------------------------------------
+// File : MeshletHierarchy.cpp
+// Desc : Hierarchical Cluster LOD.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <MeshletHierarchy.h>
+#include <fnd/asdxLogger.h>
+#include <algorithm>
+#include <unordered_map>
+#include <cmath>
+#include <cfloat>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const float    kMinReduction = 0.85f;  // これより三角形が減らないグループは簡略化を打ち切る.
+static const uint32_t kOriginWeight = 4;      // 生成元のグループが異なる隣接メッシュレットの重み.
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Quadric structure
+///////////////////////////////////////////////////////////////////////////////
+struct Quadric
+{
+    double  A00 = 0.0, A01 = 0.0, A02 = 0.0, A03 = 0.0;
+    double  A11 = 0.0, A12 = 0.0, A13 = 0.0;
+    double  A22 = 0.0, A23 = 0.0;
+    double  A33 = 0.0;
+    double  Weight = 0.0;
+
+    //-------------------------------------------------------------------------
+    //      平面を追加します.
+    //-------------------------------------------------------------------------
+    void AddPlane(double a, double b, double c, double d, double w)
+    {
+        A00 += w * a * a; A01 += w * a * b; A02 += w * a * c; A03 += w * a * d;
+        A11 += w * b * b; A12 += w * b * c; A13 += w * b * d;
+        A22 += w * c * c; A23 += w * c * d;
+        A33 += w * d * d;
+        Weight += w;
+    }
+
+    //-------------------------------------------------------------------------
+    //      加算します.
+    //-------------------------------------------------------------------------
+    void Add(const Quadric& value)
+    {
+        A00 += value.A00; A01 += value.A01; A02 += value.A02; A03 += value.A03;
+        A11 += value.A11; A12 += value.A12; A13 += value.A13;
+        A22 += value.A22; A23 += value.A23;
+        A33 += value.A33;
+        Weight += value.Weight;
+    }
+
+    //-------------------------------------------------------------------------
+    //      点までの重み付き二乗距離の平均を求めます.
+    //-------------------------------------------------------------------------
+    double Evaluate(const asdx::Vector3& p) const
+    {
+        double x = p.x, y = p.y, z = p.z;
+        auto e = A00 * x * x + 2.0 * A01 * x * y + 2.0 * A02 * x * z + 2.0 * A03 * x
+               + A11 * y * y + 2.0 * A12 * y * z + 2.0 * A13 * y
+               + A22 * z * z + 2.0 * A23 * z
+               + A33;
+        return (Weight > 0.0) ? std::max(e, 0.0) / Weight : 0.0;
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Collapse structure
+///////////////////////////////////////////////////////////////////////////////
+struct Collapse
+{
+    double      Cost;
+    uint32_t    From;
+    uint32_t    To;
+
+    bool operator < (const Collapse& value) const
+    { return Cost < value.Cost; }
+};
+
+//-----------------------------------------------------------------------------
+//      無向辺のキーを求めます.
+//-----------------------------------------------------------------------------
+inline uint64_t EdgeKey(uint32_t a, uint32_t b)
+{ return (a < b) ? (uint64_t(a) << 32) | b : (uint64_t(b) << 32) | a; }
+
+//-----------------------------------------------------------------------------
+//      球の集合を包含する球を求めます.
+//-----------------------------------------------------------------------------
+asdx::Vector4 MergeSpheres(const std::vector<asdx::Vector4>& spheres)
+{
+    // 半径で重み付けした中心の平均を中心とし, 全ての球を含む半径を求める.
+    auto center = asdx::Vector3(0.0f, 0.0f, 0.0f);
+    auto weight = 0.0f;
+    for (auto& sphere : spheres)
+    {
+        auto w = sphere.w + 1e-6f;
+        center += asdx::Vector3(sphere.x, sphere.y, sphere.z) * w;
+        weight += w;
+    }
+    center = center * (1.0f / weight);
+
+    auto radius = 0.0f;
+    for (auto& sphere : spheres)
+    {
+        auto d = asdx::Vector3(sphere.x, sphere.y, sphere.z) - center;
+        radius = std::max(radius, d.Length() + sphere.w);
+    }
+
+    return asdx::Vector4(center, radius);
+}
+
+//-----------------------------------------------------------------------------
+//      メッシュレットの三角形をグローバルな頂点番号で取り出します.
+//-----------------------------------------------------------------------------
+void AppendTriangles(const MeshletData& data, uint32_t index, std::vector<uint32_t>& indices)
+{
+    auto& meshlet = data.Meshlets[index];
+    auto  pVertices = data.UniqueVertexIndices.data() + meshlet.VertexOffset;
+    for (auto i = 0u; i < meshlet.PrimitiveCount; ++i)
+    {
+        auto packed = data.Primitives[meshlet.PrimitiveOffset + i];
+        indices.push_back(pVertices[(packed >>  0) & 0x3ff]);
+        indices.push_back(pVertices[(packed >> 10) & 0x3ff]);
+        indices.push_back(pVertices[(packed >> 20) & 0x3ff]);
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      構築したメッシュレットを結果に追加します.
+//-----------------------------------------------------------------------------
+void AppendMeshlets(const MeshletData& source, MeshletData& result)
+{
+    auto vertexOffset    = uint32_t(result.UniqueVertexIndices.size());
+    auto primitiveOffset = uint32_t(result.Primitives.size());
+
+    for (auto meshlet : source.Meshlets)
+    {
+        meshlet.VertexOffset    += vertexOffset;
+        meshlet.PrimitiveOffset += primitiveOffset;
+        result.Meshlets.push_back(meshlet);
+    }
+
+    result.UniqueVertexIndices.insert(result.UniqueVertexIndices.end(),
+        source.UniqueVertexIndices.begin(), source.UniqueVertexIndices.end());
+    result.Primitives.insert(result.Primitives.end(),
+        source.Primitives.begin(), source.Primitives.end());
+    result.CullInfos.insert(result.CullInfos.end(),
+        source.CullInfos.begin(), source.CullInfos.end());
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// GroupSimplifier class
+///////////////////////////////////////////////////////////////////////////////
+class GroupSimplifier
+{
+public:
+    //-------------------------------------------------------------------------
+    //      境界を固定したままインデックスを簡略化します.
+    //-------------------------------------------------------------------------
+    float Simplify
+    (
+        const asdx::Vector3*    pPositions,
+        std::vector<uint32_t>&  indices,
+        uint32_t                targetTriangleCount
+    )
+    {
+        Setup(pPositions, indices);
+
+        auto maxCost = 0.0;
+        while (m_TriangleCount > targetTriangleCount)
+        {
+            auto collapses = CollectCollapses();
+            if (collapses.empty())
+            { break; }
+
+            // 1パスで同じ近傍を2度変更しないよう, 縮約した周囲の頂点を固定する.
+            std::fill(m_Touched.begin(), m_Touched.end(), false);
+
+            auto count = 0u;
+            for (auto& collapse : collapses)
+            {
+                if (m_TriangleCount <= targetTriangleCount)
+                { break; }
+
+                if (m_Touched[collapse.From] || m_Touched[collapse.To])
+                { continue; }
+
+                if (IsFlipped(collapse.From, collapse.To))
+                { continue; }
+
+                Apply(collapse.From, collapse.To);
+                maxCost = std::max(maxCost, collapse.Cost);
+                count++;
+            }
+
+            if (count == 0)
+            { break; }
+        }
+
+        indices.clear();
+        for (size_t i = 0; i < m_Alive.size(); ++i)
+        {
+            if (!m_Alive[i])
+            { continue; }
+
+            for (auto j = 0u; j < 3; ++j)
+            { indices.push_back(m_Vertices[m_Triangles[i * 3 + j]]); }
+        }
+
+        return float(sqrt(maxCost));
+    }
+
+private:
+    //=========================================================================
+    // private variables.
+    //=========================================================================
+    std::vector<uint32_t>               m_Vertices;     // ローカル番号からグローバル番号への変換.
+    std::vector<asdx::Vector3>          m_Positions;
+    std::vector<Quadric>                m_Quadrics;
+    std::vector<bool>                   m_Locked;
+    std::vector<bool>                   m_Touched;
+    std::vector<std::vector<uint32_t>>  m_VertexTriangles;
+    std::vector<uint32_t>               m_Triangles;
+    std::vector<bool>                   m_Alive;
+    uint32_t                            m_TriangleCount = 0;
+
+    //=========================================================================
+    // private methods.
+    //=========================================================================
+
+    //-------------------------------------------------------------------------
+    //      頂点と三角形の情報を構築します.
+    //-------------------------------------------------------------------------
+    void Setup(const asdx::Vector3* pPositions, const std::vector<uint32_t>& indices)
+    {
+        std::unordered_map<uint32_t, uint32_t> localIndices;
+        m_Triangles.resize(indices.size());
+        for (size_t i = 0; i < indices.size(); ++i)
+        {
+            auto itr = localIndices.find(indices[i]);
+            if (itr == localIndices.end())
+            {
+                itr = localIndices.emplace(indices[i], uint32_t(m_Vertices.size())).first;
+                m_Vertices .push_back(indices[i]);
+                m_Positions.push_back(pPositions[indices[i]]);
+            }
+            m_Triangles[i] = itr->second;
+        }
+
+        auto vertexCount   = m_Vertices.size();
+        auto triangleCount = uint32_t(indices.size() / 3);
+
+        m_Quadrics       .resize(vertexCount);
+        m_Locked         .resize(vertexCount, false);
+        m_Touched        .resize(vertexCount, false);
+        m_VertexTriangles.resize(vertexCount);
+        m_Alive          .resize(triangleCount, true);
+        m_TriangleCount  = triangleCount;
+
+        std::vector<uint64_t> edges;
+        edges.reserve(indices.size());
+
+        for (auto i = 0u; i < triangleCount; ++i)
+        {
+            auto i0 = m_Triangles[i * 3 + 0];
+            auto i1 = m_Triangles[i * 3 + 1];
+            auto i2 = m_Triangles[i * 3 + 2];
+
+            m_VertexTriangles[i0].push_back(i);
+            m_VertexTriangles[i1].push_back(i);
+            m_VertexTriangles[i2].push_back(i);
+
+            edges.push_back(EdgeKey(i0, i1));
+            edges.push_back(EdgeKey(i1, i2));
+            edges.push_back(EdgeKey(i2, i0));
+
+            // 面積で重み付けした平面の二次誤差.
+            auto& p0 = m_Positions[i0];
+            auto  n  = asdx::Vector3::Cross(m_Positions[i1] - p0, m_Positions[i2] - p0);
+            auto  l  = n.Length();
+            if (l <= 1e-12f)
+            { continue; }
+
+            double a = n.x / l, b = n.y / l, c = n.z / l;
+            double d = -(a * p0.x + b * p0.y + c * p0.z);
+
+            Quadric q;
+            q.AddPlane(a, b, c, d, l * 0.5);
+            m_Quadrics[i0].Add(q);
+            m_Quadrics[i1].Add(q);
+            m_Quadrics[i2].Add(q);
+        }
+
+        // 1つの三角形からしか参照されない辺はグループ境界か開いた境界なので固定する.
+        // 3つ以上から参照される非多様体の辺も固定する.
+        std::sort(edges.begin(), edges.end());
+        for (size_t i = 0; i < edges.size();)
+        {
+            auto j = i;
+            while (j < edges.size() && edges[j] == edges[i])
+            { j++; }
+
+            if (j - i != 2)
+            {
+                m_Locked[uint32_t(edges[i] >> 32)]        = true;
+                m_Locked[uint32_t(edges[i] & 0xffffffff)] = true;
+            }
+            i = j;
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //      縮約候補をコストの昇順に集めます.
+    //-------------------------------------------------------------------------
+    std::vector<Collapse> CollectCollapses() const
+    {
+        std::vector<uint64_t> edges;
+        for (size_t i = 0; i < m_Alive.size(); ++i)
+        {
+            if (!m_Alive[i])
+            { continue; }
+
+            auto i0 = m_Triangles[i * 3 + 0];
+            auto i1 = m_Triangles[i * 3 + 1];
+            auto i2 = m_Triangles[i * 3 + 2];
+            edges.push_back(EdgeKey(i0, i1));
+            edges.push_back(EdgeKey(i1, i2));
+            edges.push_back(EdgeKey(i2, i0));
+        }
+        std::sort(edges.begin(), edges.end());
+        edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+        std::vector<Collapse> result;
+        result.reserve(edges.size());
+        for (auto edge : edges)
+        {
+            auto a = uint32_t(edge >> 32);
+            auto b = uint32_t(edge & 0xffffffff);
+
+            // 固定されていない頂点を既存の頂点へ縮約する.
+            Collapse best = { DBL_MAX, a, b };
+            if (!m_Locked[a])
+            {
+                Quadric q = m_Quadrics[a];
+                q.Add(m_Quadrics[b]);
+                best.Cost = q.Evaluate(m_Positions[b]);
+            }
+            if (!m_Locked[b])
+            {
+                Quadric q = m_Quadrics[a];
+                q.Add(m_Quadrics[b]);
+                auto cost = q.Evaluate(m_Positions[a]);
+                if (cost < best.Cost)
+                {
+                    best.Cost = cost;
+                    best.From = b;
+                    best.To   = a;
+                }
+            }
+
+            if (best.Cost < DBL_MAX)
+            { result.push_back(best); }
+        }
+
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+    //-------------------------------------------------------------------------
+    //      縮約により三角形が裏返るかどうかチェックします.
+    //-------------------------------------------------------------------------
+    bool IsFlipped(uint32_t from, uint32_t to) const
+    {
+        for (auto t : m_VertexTriangles[from])
+        {
+            if (!m_Alive[t])
+            { continue; }
+
+            auto v = &m_Triangles[t * 3];
+            if (v[0] == to || v[1] == to || v[2] == to)
+            { continue; }
+
+            asdx::Vector3 p[3];
+            asdx::Vector3 q[3];
+            for (auto j = 0u; j < 3; ++j)
+            {
+                p[j] = m_Positions[v[j]];
+                q[j] = (v[j] == from) ? m_Positions[to] : p[j];
+            }
+
+            auto n0 = asdx::Vector3::Cross(p[1] - p[0], p[2] - p[0]);
+            auto n1 = asdx::Vector3::Cross(q[1] - q[0], q[2] - q[0]);
+            if (asdx::Vector3::Dot(n0, n1) <= 1e-3f * n0.Length() * n0.Length())
+            { return true; }
+        }
+
+        return false;
+    }
+
+    //-------------------------------------------------------------------------
+    //      縮約を適用します.
+    //-------------------------------------------------------------------------
+    void Apply(uint32_t from, uint32_t to)
+    {
+        for (auto t : m_VertexTriangles[from])
+        {
+            if (!m_Alive[t])
+            { continue; }
+
+            auto v = &m_Triangles[t * 3];
+            for (auto j = 0u; j < 3; ++j)
+            { m_Touched[v[j]] = true; }
+
+            if (v[0] == to || v[1] == to || v[2] == to)
+            {
+                m_Alive[t] = false;
+                m_TriangleCount--;
+                continue;
+            }
+
+            for (auto j = 0u; j < 3; ++j)
+            {
+                if (v[j] == from)
+                { v[j] = to; }
+            }
+            m_VertexTriangles[to].push_back(t);
+        }
+
+        m_Quadrics[to].Add(m_Quadrics[from]);
+        m_VertexTriangles[from].clear();
+    }
+};
+
+//-----------------------------------------------------------------------------
+//      共有頂点の多い隣接メッシュレットをグループ化します.
+//-----------------------------------------------------------------------------
+std::vector<std::vector<uint32_t>> GroupClusters
+(
+    const MeshletData&              data,
+    const std::vector<uint32_t>&    clusters,
+    const std::vector<uint32_t>&    origins,
+    uint32_t                        groupSize
+)
+{
+    // 頂点を共有するメッシュレットの組を数える.
+    std::vector<uint64_t> pairs;
+    for (auto i = 0u; i < uint32_t(clusters.size()); ++i)
+    {
+        auto& meshlet = data.Meshlets[clusters[i]];
+        for (auto j = 0u; j < meshlet.VertexCount; ++j)
+        {
+            auto index = data.UniqueVertexIndices[meshlet.VertexOffset + j];
+            pairs.push_back((uint64_t(index) << 32) | i);
+        }
+    }
+    std::sort(pairs.begin(), pairs.end());
+
+    std::vector<std::unordered_map<uint32_t, uint32_t>> neighbors(clusters.size());
+    for (size_t i = 0; i < pairs.size();)
+    {
+        auto j = i;
+        while (j < pairs.size() && (pairs[j] >> 32) == (pairs[i] >> 32))
+        { j++; }
+
+        for (auto a = i; a < j; ++a)
+        for (auto b = a + 1; b < j; ++b)
+        {
+            // 前の階層で固定されていた境界を内側に取り込めるよう,
+            // 異なるグループから生成されたメッシュレット同士を優先する.
+            auto ca = uint32_t(pairs[a] & 0xffffffff);
+            auto cb = uint32_t(pairs[b] & 0xffffffff);
+            auto weight = (origins[ca] != origins[cb]) ? kOriginWeight : 1u;
+            neighbors[ca][cb] += weight;
+            neighbors[cb][ca] += weight;
+        }
+        i = j;
+    }
+
+    std::vector<std::vector<uint32_t>> groups;
+    std::vector<bool> grouped(clusters.size(), false);
+
+    for (auto seed = 0u; seed < uint32_t(clusters.size()); ++seed)
+    {
+        if (grouped[seed])
+        { continue; }
+
+        std::vector<uint32_t> group;
+        std::unordered_map<uint32_t, uint32_t> gain;
+
+        auto current = seed;
+        while (current != ~0u)
+        {
+            grouped[current] = true;
+            group.push_back(current);
+            gain.erase(current);
+
+            for (auto& itr : neighbors[current])
+            {
+                if (!grouped[itr.first])
+                { gain[itr.first] += itr.second; }
+            }
+
+            if (group.size() >= groupSize)
+            { break; }
+
+            // 最も多くの頂点を共有するメッシュレットを追加する.
+            current = ~0u;
+            auto best = 0u;
+            for (auto& itr : gain)
+            {
+                if (itr.second > best || (itr.second == best && itr.first < current))
+                {
+                    current = itr.first;
+                    best    = itr.second;
+                }
+            }
+        }
+
+        groups.push_back(group);
+    }
+
+    // 隣接先が残っておらず小さくなったグループは, 最も多く頂点を共有するグループへ統合する.
+    std::vector<uint32_t> groupIds(clusters.size());
+    for (auto g = 0u; g < uint32_t(groups.size()); ++g)
+    {
+        for (auto index : groups[g])
+        { groupIds[index] = g; }
+    }
+
+    for (auto g = 0u; g < uint32_t(groups.size()); ++g)
+    {
+        if (groups[g].size() * 2 >= groupSize)
+        { continue; }
+
+        std::unordered_map<uint32_t, uint32_t> gain;
+        for (auto index : groups[g])
+        {
+            for (auto& itr : neighbors[index])
+            {
+                if (groupIds[itr.first] != g)
+                { gain[groupIds[itr.first]] += itr.second; }
+            }
+        }
+
+        auto target = ~0u;
+        auto best   = 0u;
+        for (auto& itr : gain)
+        {
+            if (itr.second > best || (itr.second == best && itr.first < target))
+            {
+                target = itr.first;
+                best   = itr.second;
+            }
+        }
+
+        if (target == ~0u)
+        { continue; }
+
+        for (auto index : groups[g])
+        {
+            groupIds[index] = target;
+            groups[target].push_back(index);
+        }
+        groups[g].clear();
+    }
+
+    std::vector<std::vector<uint32_t>> result;
+    for (auto& group : groups)
+    {
+        if (group.empty())
+        { continue; }
+
+        result.emplace_back();
+        for (auto index : group)
+        { result.back().push_back(clusters[index]); }
+    }
+
+    return result;
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      メッシュレットの階層を構築します.
+//-----------------------------------------------------------------------------
+bool BuildMeshletHierarchy
+(
+    const asdx::Vector3*        pPositions,
+    uint32_t                    vertexCount,
+    const uint32_t*             pIndices,
+    uint32_t                    indexCount,
+    const MeshletHierarchyDesc& desc,
+    MeshletHierarchy&           result
+)
+{
+    result = MeshletHierarchy();
+
+    if (desc.GroupSize < 2 || desc.ReductionRatio <= 0.0f || desc.ReductionRatio >= 1.0f)
+    {
+        ELOG("Error : Invalid Hierarchy Desc. GroupSize = %u, ReductionRatio = %f",
+            desc.GroupSize, desc.ReductionRatio);
+        return false;
+    }
+
+    // 最詳細の階層.
+    {
+        MeshletData leaf;
+        if (!BuildMeshlets(pPositions, vertexCount, pIndices, indexCount, desc.Meshlet, leaf))
+        {
+            ELOG("Error : BuildMeshlets() Failed.");
+            return false;
+        }
+
+        AppendMeshlets(leaf, result.Clusters);
+    }
+
+    std::vector<uint32_t> clusters;
+    std::vector<uint32_t> origins;
+    for (auto i = 0u; i < uint32_t(result.Clusters.Meshlets.size()); ++i)
+    {
+        ClusterLod lod;
+        lod.LodBounds    = result.Clusters.CullInfos[i].BoundingSphere;
+        lod.LodError     = 0.0f;
+        lod.ParentBounds = lod.LodBounds;
+        lod.ParentError  = FLT_MAX;
+        lod.Level        = 0;
+        result.Lods.push_back(lod);
+        clusters.push_back(i);
+        origins .push_back(i);
+    }
+
+    result.LevelCount = clusters.empty() ? 0 : 1;
+
+    GroupSimplifier simplifier;
+    std::vector<uint32_t> indices;
+    std::vector<asdx::Vector4> spheres;
+
+    for (auto level = 1u; level < desc.MaxLevels && clusters.size() > 1; ++level)
+    {
+        std::vector<uint32_t> next;
+        std::vector<uint32_t> nextOrigins;
+
+        auto groups = GroupClusters(result.Clusters, clusters, origins, desc.GroupSize);
+        for (auto g = 0u; g < uint32_t(groups.size()); ++g)
+        {
+            auto& group = groups[g];
+            indices.clear();
+            spheres.clear();
+            auto childError = 0.0f;
+            for (auto index : group)
+            {
+                AppendTriangles(result.Clusters, index, indices);
+                spheres.push_back(result.Lods[index].LodBounds);
+                childError = std::max(childError, result.Lods[index].LodError);
+            }
+
+            auto triangleCount = uint32_t(indices.size() / 3);
+            auto target = uint32_t(float(triangleCount) * desc.ReductionRatio);
+
+            // 境界を固定しているため減らせないグループは親を持たない.
+            simplifier = GroupSimplifier();
+            auto error = simplifier.Simplify(pPositions, indices, target);
+            if (indices.size() / 3 > size_t(float(triangleCount) * kMinReduction))
+            { continue; }
+
+            MeshletData coarse;
+            if (!BuildMeshlets(pPositions, vertexCount, indices.data(), uint32_t(indices.size()), desc.Meshlet, coarse))
+            {
+                ELOG("Error : BuildMeshlets() Failed.");
+                return false;
+            }
+
+            // 誤差と境界球は子を包含し, 親に向かって単調に増加させる.
+            auto bounds = MergeSpheres(spheres);
+            error = std::max(error, childError);
+
+            for (auto index : group)
+            {
+                result.Lods[index].ParentBounds = bounds;
+                result.Lods[index].ParentError  = error;
+            }
+
+            auto first = uint32_t(result.Clusters.Meshlets.size());
+            AppendMeshlets(coarse, result.Clusters);
+
+            for (auto i = first; i < uint32_t(result.Clusters.Meshlets.size()); ++i)
+            {
+                ClusterLod lod;
+                lod.LodBounds    = bounds;
+                lod.LodError     = error;
+                lod.ParentBounds = bounds;
+                lod.ParentError  = FLT_MAX;
+                lod.Level        = level;
+                result.Lods.push_back(lod);
+                next       .push_back(i);
+                nextOrigins.push_back(g);
+            }
+        }
+
+        if (next.empty())
+        { break; }
+
+        result.LevelCount = level + 1;
+        clusters.swap(next);
+        origins .swap(nextOrigins);
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      画面上の誤差を求めます.
+//-----------------------------------------------------------------------------
+float ComputeProjectedError(const asdx::Vector4& bounds, float error, const LodView& view)
+{
+    if (error <= 0.0f)
+    { return 0.0f; }
+
+    if (error == FLT_MAX)
+    { return FLT_MAX; }
+
+    auto d = (asdx::Vector3(bounds.x, bounds.y, bounds.z) - view.CameraPos).Length() - bounds.w;
+    if (d <= 0.0f)
+    { return FLT_MAX; }
+
+    return error * view.ProjectionScale / d;
+}
+
+//-----------------------------------------------------------------------------
+//      許容誤差を満たす最も粗いカットを選択します.
+//-----------------------------------------------------------------------------
+uint32_t SelectMeshletLod
+(
+    const MeshletHierarchy& hierarchy,
+    const LodView&          view,
+    std::vector<uint32_t>&  selected
+)
+{
+    selected.clear();
+
+    for (auto i = 0u; i < uint32_t(hierarchy.Lods.size()); ++i)
+    {
+        auto& lod = hierarchy.Lods[i];
+        if (ComputeProjectedError(lod.LodBounds, lod.LodError, view) > view.ErrorThreshold)
+        { continue; }
+
+        if (ComputeProjectedError(lod.ParentBounds, lod.ParentError, view) <= view.ErrorThreshold)
+        { continue; }
+
+        selected.push_back(i);
+    }
+
+    return uint32_t(selected.size());
+}
+
+//-----------------------------------------------------------------------------
+//      選択したメッシュレットを描画用に詰めます.
+//-----------------------------------------------------------------------------
+void GatherMeshlets
+(
+    const MeshletHierarchy&         hierarchy,
+    const std::vector<uint32_t>&    selected,
+    std::vector<Meshlet>&           meshlets,
+    std::vector<CullInfo>&          cullInfos
+)
+{
+    meshlets .clear();
+    cullInfos.clear();
+    meshlets .reserve(selected.size());
+    cullInfos.reserve(selected.size());
+
+    for (auto index : selected)
+    {
+        meshlets .push_back(hierarchy.Clusters.Meshlets [index]);
+        cullInfos.push_back(hierarchy.Clusters.CullInfos[index]);
+    }
+}
@@ -0,0 +1,320 @@
+﻿//-----------------------------------------------------------------------------
+// File : MeshletModel.cpp
+// Desc : Meshlet Model File (*.mdl) Reader/Writer.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <MeshletModel.h>
+#include <fnd/asdxLogger.h>
+#include <fstream>
+#include <cstring>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint8_t  kMagic[4] = { 'M', 'D', 'L', '\0' };
+static const uint32_t kVersion  = 1;
+
+
+///////////////////////////////////////////////////////////////////////////////
+// MDL_FILE_HEADER structure
+///////////////////////////////////////////////////////////////////////////////
+struct MDL_FILE_HEADER
+{
+    uint8_t     Magic[4];           //!< マジック("MDL\0").
+    uint32_t    Version;            //!< バージョン.
+    uint32_t    MeshCount;          //!< メッシュ数.
+    uint32_t    Reserved;           //!< 予約領域.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// MDL_MESH_HEADER structure
+///////////////////////////////////////////////////////////////////////////////
+struct MDL_MESH_HEADER
+{
+    uint32_t    MaterialId;         //!< マテリアル番号.
+    uint32_t    PositionCount;      //!< 位置座標数.
+    uint32_t    TangentSpaceCount;  //!< 接線空間数.
+    uint32_t    ColorCount;         //!< 頂点カラー数.
+    uint32_t    TexCoordCount[4];   //!< テクスチャ座標数.
+    uint32_t    BoneIndexCount;     //!< ボーン番号数.
+    uint32_t    BoneWeightCount;    //!< ボーン重み数.
+    uint32_t    IndexCount;         //!< 頂点番号数.
+    uint32_t    PrimitiveCount;     //!< プリミティブ数.
+    uint32_t    MeshletCount;       //!< メッシュレット数.
+    uint32_t    CullInfoCount;      //!< カリング情報数.
+};
+
+// ファイル上のレイアウトと一致していることを保証する.
+static_assert(sizeof(MDL_FILE_HEADER) == 16, "Invalid File Header Size.");
+static_assert(sizeof(MDL_MESH_HEADER) == 56, "Invalid Mesh Header Size.");
+static_assert(sizeof(asdx::Vector3)   == 12, "Invalid Position Size.");
+static_assert(sizeof(Meshlet)         == 16, "Invalid Meshlet Size.");
+static_assert(sizeof(CullInfo)        == 20, "Invalid CullInfo Size.");
+
+//-----------------------------------------------------------------------------
+//      配列を読み込みます.
+//-----------------------------------------------------------------------------
+template<typename T>
+bool ReadArray(std::ifstream& stream, uint32_t count, uint64_t& remain, std::vector<T>& result)
+{
+    // 壊れたヘッダで巨大なメモリを確保しないよう残りサイズと比較する.
+    auto size = uint64_t(count) * sizeof(T);
+    if (size > remain)
+    { return false; }
+
+    remain -= size;
+    result.resize(count);
+    if (count == 0)
+    { return true; }
+
+    stream.read(reinterpret_cast<char*>(result.data()), std::streamsize(size));
+    return stream.good();
+}
+
+//-----------------------------------------------------------------------------
+//      メッシュレットが範囲外を参照していないかチェックします.
+//-----------------------------------------------------------------------------
+bool ValidateMeshlets(const MeshletData& data, uint32_t vertexCount)
+{
+    if (data.Meshlets.size() != data.CullInfos.size())
+    { return false; }
+
+    for (auto index : data.UniqueVertexIndices)
+    {
+        if (index >= vertexCount)
+        { return false; }
+    }
+
+    for (auto& meshlet : data.Meshlets)
+    {
+        if (uint64_t(meshlet.VertexOffset) + meshlet.VertexCount > data.UniqueVertexIndices.size()
+         || uint64_t(meshlet.PrimitiveOffset) + meshlet.PrimitiveCount > data.Primitives.size())
+        { return false; }
+
+        for (auto i = 0u; i < meshlet.PrimitiveCount; ++i)
+        {
+            auto packed = data.Primitives[meshlet.PrimitiveOffset + i];
+            if (((packed >>  0) & 0x3ff) >= meshlet.VertexCount
+             || ((packed >> 10) & 0x3ff) >= meshlet.VertexCount
+             || ((packed >> 20) & 0x3ff) >= meshlet.VertexCount)
+            { return false; }
+        }
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      配列を書き出します.
+//-----------------------------------------------------------------------------
+template<typename T>
+void WriteArray(std::ofstream& stream, const std::vector<T>& values)
+{
+    if (values.empty())
+    { return; }
+
+    stream.write(reinterpret_cast<const char*>(values.data()), std::streamsize(values.size() * sizeof(T)));
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      モデルファイルを読み込みます.
+//-----------------------------------------------------------------------------
+bool LoadMeshletModel(const char* path, MeshletModel& model)
+{
+    model.Meshes.clear();
+
+    std::ifstream stream(path, std::ios::binary | std::ios::ate);
+    if (!stream.is_open())
+    {
+        ELOG("Error : File Open Failed. path = %s", path);
+        return false;
+    }
+
+    auto remain = uint64_t(stream.tellg());
+    stream.seekg(0, std::ios::beg);
+
+    MDL_FILE_HEADER header = {};
+    if (remain < sizeof(header) || !stream.read(reinterpret_cast<char*>(&header), sizeof(header)))
+    {
+        ELOG("Error : Unexpected End of File. path = %s", path);
+        return false;
+    }
+    remain -= sizeof(header);
+
+    if (memcmp(header.Magic, kMagic, sizeof(kMagic)) != 0 || header.Version != kVersion)
+    {
+        ELOG("Error : Invalid File. path = %s, version = %u", path, header.Version);
+        return false;
+    }
+
+    // メッシュヘッダ分のサイズも無い場合は壊れている.
+    if (uint64_t(header.MeshCount) * sizeof(MDL_MESH_HEADER) > remain)
+    {
+        ELOG("Error : Invalid Mesh Count. path = %s, count = %u", path, header.MeshCount);
+        return false;
+    }
+
+    model.Meshes.resize(header.MeshCount);
+    for (auto i = 0u; i < header.MeshCount; ++i)
+    {
+        MDL_MESH_HEADER info = {};
+        if (!stream.read(reinterpret_cast<char*>(&info), sizeof(info)))
+        {
+            ELOG("Error : Unexpected End of File. path = %s", path);
+            model.Meshes.clear();
+            return false;
+        }
+        remain -= sizeof(info);
+
+        if (info.BoneIndexCount > 0 || info.BoneWeightCount > 0)
+        {
+            ELOG("Error : Skinned Mesh Is Not Supported. path = %s, mesh = %u", path, i);
+            model.Meshes.clear();
+            return false;
+        }
+
+        auto& mesh = model.Meshes[i];
+        mesh.MaterialId = info.MaterialId;
+
+        auto ret = ReadArray(stream, info.PositionCount,     remain, mesh.Positions)
+                && ReadArray(stream, info.TangentSpaceCount, remain, mesh.TangentSpaces)
+                && ReadArray(stream, info.ColorCount,        remain, mesh.Colors)
+                && ReadArray(stream, info.TexCoordCount[0],  remain, mesh.TexCoords[0])
+                && ReadArray(stream, info.TexCoordCount[1],  remain, mesh.TexCoords[1])
+                && ReadArray(stream, info.TexCoordCount[2],  remain, mesh.TexCoords[2])
+                && ReadArray(stream, info.TexCoordCount[3],  remain, mesh.TexCoords[3])
+                && ReadArray(stream, info.IndexCount,        remain, mesh.Meshlets.UniqueVertexIndices)
+                && ReadArray(stream, info.PrimitiveCount,    remain, mesh.Meshlets.Primitives)
+                && ReadArray(stream, info.MeshletCount,      remain, mesh.Meshlets.Meshlets)
+                && ReadArray(stream, info.CullInfoCount,     remain, mesh.Meshlets.CullInfos);
+        if (!ret)
+        {
+            ELOG("Error : Unexpected End of File. path = %s, mesh = %u", path, i);
+            model.Meshes.clear();
+            return false;
+        }
+
+        if (!ValidateMeshlets(mesh.Meshlets, info.PositionCount))
+        {
+            ELOG("Error : Invalid Meshlet. path = %s, mesh = %u", path, i);
+            model.Meshes.clear();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      モデルファイルに書き出します.
+//-----------------------------------------------------------------------------
+bool SaveMeshletModel(const char* path, const MeshletModel& model)
+{
+    std::ofstream stream(path, std::ios::binary);
+    if (!stream.is_open())
+    {
+        ELOG("Error : File Open Failed. path = %s", path);
+        return false;
+    }
+
+    MDL_FILE_HEADER header = {};
+    memcpy(header.Magic, kMagic, sizeof(kMagic));
+    header.Version   = kVersion;
+    header.MeshCount = uint32_t(model.Meshes.size());
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    for (auto& mesh : model.Meshes)
+    {
+        MDL_MESH_HEADER info = {};
+        info.MaterialId         = mesh.MaterialId;
+        info.PositionCount      = uint32_t(mesh.Positions    .size());
+        info.TangentSpaceCount  = uint32_t(mesh.TangentSpaces.size());
+        info.ColorCount         = uint32_t(mesh.Colors       .size());
+        for (auto i = 0; i < 4; ++i)
+        { info.TexCoordCount[i] = uint32_t(mesh.TexCoords[i].size()); }
+        info.IndexCount         = uint32_t(mesh.Meshlets.UniqueVertexIndices.size());
+        info.PrimitiveCount     = uint32_t(mesh.Meshlets.Primitives         .size());
+        info.MeshletCount       = uint32_t(mesh.Meshlets.Meshlets           .size());
+        info.CullInfoCount      = uint32_t(mesh.Meshlets.CullInfos          .size());
+        stream.write(reinterpret_cast<const char*>(&info), sizeof(info));
+
+        WriteArray(stream, mesh.Positions);
+        WriteArray(stream, mesh.TangentSpaces);
+        WriteArray(stream, mesh.Colors);
+        for (auto i = 0; i < 4; ++i)
+        { WriteArray(stream, mesh.TexCoords[i]); }
+        WriteArray(stream, mesh.Meshlets.UniqueVertexIndices);
+        WriteArray(stream, mesh.Meshlets.Primitives);
+        WriteArray(stream, mesh.Meshlets.Meshlets);
+        WriteArray(stream, mesh.Meshlets.CullInfos);
+    }
+
+    if (!stream.good())
+    {
+        ELOG("Error : File Write Failed. path = %s", path);
+        return false;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      メッシュレットから三角形リストを復元します.
+//-----------------------------------------------------------------------------
+void ExtractTriangles(const MeshletData& data, std::vector<uint32_t>& indices)
+{
+    indices.clear();
+
+    for (auto& meshlet : data.Meshlets)
+    {
+        auto pVertices = data.UniqueVertexIndices.data() + meshlet.VertexOffset;
+        for (auto i = 0u; i < meshlet.PrimitiveCount; ++i)
+        {
+            auto packed = data.Primitives[meshlet.PrimitiveOffset + i];
+            indices.push_back(pVertices[(packed >>  0) & 0x3ff]);
+            indices.push_back(pVertices[(packed >> 10) & 0x3ff]);
+            indices.push_back(pVertices[(packed >> 20) & 0x3ff]);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      全メッシュのメッシュレットを再構築します.
+//-----------------------------------------------------------------------------
+bool RebuildMeshlets(const MeshletBuildDesc& desc, MeshletModel& model)
+{
+    std::vector<uint32_t> indices;
+
+    for (size_t i = 0; i < model.Meshes.size(); ++i)
+    {
+        auto& mesh = model.Meshes[i];
+        ExtractTriangles(mesh.Meshlets, indices);
+
+        MeshletData result;
+        if (!BuildMeshlets(
+            mesh.Positions.data(),
+            uint32_t(mesh.Positions.size()),
+            indices.data(),
+            uint32_t(indices.size()),
+            desc,
+            result))
+        {
+            ELOG("Error : BuildMeshlets() Failed. mesh = %zu", i);
+            return false;
+        }
+
+        mesh.Meshlets = std::move(result);
+    }
+
+    return true;
+}
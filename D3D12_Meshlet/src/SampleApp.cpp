@@ -11,6 +11,8 @@
 #include <fnd/asdxMath.h>
 #include <fnd/asdxLogger.h>
 #include <fnd/asdxMisc.h>
+#include <MeshletModel.h>
+#include <cstring>
 
 
 namespace {
@@ -22,6 +24,8 @@ namespace {
 #include "../res/Compiled/SampleMS.inc"
 #include "../res/Compiled/SamplePS.inc"
 
+static const float kLodErrorThreshold = 1.0f;   // LOD選択で許容する画面上の誤差(ピクセル).
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // MeshParam structure
@@ -57,6 +61,66 @@ struct alignas(256) LightingParam
     float           LightIntensity;
 };
 
+//-----------------------------------------------------------------------------
+//      データを書き込んだアップロードバッファとSRVを生成します.
+//-----------------------------------------------------------------------------
+bool CreateBuffer
+(
+    ID3D12Device*               pDevice,
+    const void*                 pData,
+    uint32_t                    count,
+    uint32_t                    stride,
+    ID3D12Resource**            ppResource,
+    asdx::IShaderResourceView** ppView
+)
+{
+    // 空のバッファは作れないので最低1要素確保する.
+    auto size = uint64_t(asdx::Max(count, 1u)) * stride;
+    if (!asdx::CreateUploadBuffer(pDevice, size, ppResource))
+    {
+        ELOGA("Error : CreateUploadBuffer() Failed.");
+        return false;
+    }
+
+    if (pData != nullptr && count > 0)
+    {
+        void* ptr = nullptr;
+        auto hr = (*ppResource)->Map(0, nullptr, &ptr);
+        if (FAILED(hr))
+        {
+            ELOGA("Error : ID3D12Resource::Map() Failed. errcode = 0x%x", hr);
+            return false;
+        }
+
+        memcpy(ptr, pData, size_t(count) * stride);
+        (*ppResource)->Unmap(0, nullptr);
+    }
+
+    if (!asdx::CreateBufferSRV(pDevice, *ppResource, asdx::Max(count, 1u), stride, ppView))
+    {
+        ELOGA("Error : CreateBufferSRV() Failed.");
+        return false;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      アップロードバッファにデータを書き込みます.
+//-----------------------------------------------------------------------------
+void WriteBuffer(ID3D12Resource* pResource, const void* pData, size_t size)
+{
+    if (size == 0)
+    { return; }
+
+    void* ptr = nullptr;
+    if (SUCCEEDED(pResource->Map(0, nullptr, &ptr)))
+    {
+        memcpy(ptr, pData, size);
+        pResource->Unmap(0, nullptr);
+    }
+}
+
 } // namespace
 
 
@@ -119,6 +183,12 @@ bool SampleApp::OnInit()
             ELOG("Error : Model::Init() Failed.");
             return false;
         }
+
+        if (!InitLod(path.c_str()))
+        {
+            ELOG("Error : InitLod() Failed.");
+            return false;
+        }
     }
 
     // ルートシグニチャの生成.
@@ -222,6 +292,8 @@ void SampleApp::OnTerm()
     m_SceneBuffer   .Term();
     m_DebugSceneBuffer.Term();
 
+    m_LodMeshes.clear();
+
     m_Model  .Term();
     m_RootSig.Term();
     m_PSO    .Term();
@@ -259,11 +331,11 @@ void SampleApp::OnFrameRender(asdx::FrameEventArgs& param)
         asdx::SetRenderTarget(pCmd, pRTV, pDSV);
         asdx::SetViewport(pCmd, pRTV);
 
+        // メリタ製サイズに戻す.
+        auto scale = asdx::Vector3(1.0f, 4.0f / 3.0f, 1.0f);
+
         // メッシュバッファ更新.
         {
-            // メリタ製サイズに戻す.
-            auto scale = asdx::Vector3(1.0f, 4.0f / 3.0f, 1.0f);
-
             auto ptr = m_MeshBuffer.MapAs<MeshParam>();
             ptr->World = asdx::Matrix::CreateScale(scale);
             ptr->Scale = asdx::Max(scale.x, asdx::Max(scale.y, scale.z));
@@ -284,11 +356,26 @@ void SampleApp::OnFrameRender(asdx::FrameEventArgs& param)
             ptr->CameraPos = m_CameraController.GetPosition();
             asdx::CalcFrustumPlanes(ptr->View, ptr->Proj, ptr->Planes);
 
+            // カリング検証用にカメラパスを記録.
+            if (m_RecordCamera)
+            {
+                CameraKey key;
+                key.View        = ptr->View;
+                key.Position    = ptr->CameraPos;
+                key.FieldOfView = asdx::F_PIDIV4;
+                key.AspectRatio = m_AspectRatio;
+                key.NearClip    = m_CameraController.GetNearClip();
+                key.FarClip     = m_CameraController.GetFarClip();
+                m_CameraPath.push_back(key);
+            }
+
             if (!m_DebugPause)
             {
                 ptr->DebugCamearPos = ptr->CameraPos;
                 for(auto i=0; i<6; ++i)
                 { ptr->DebugPlanes[i] = ptr->Planes[i]; }
+
+                UpdateLod(ptr->CameraPos, scale);
             }
 
             m_SceneBuffer.Unmap();
@@ -322,12 +409,26 @@ void SampleApp::OnFrameRender(asdx::FrameEventArgs& param)
             asdx::SetTable(pCmd, idxPosition,       mesh.GetPositions    ().GetView());
             asdx::SetTable(pCmd, idxTangentSpaces,  mesh.GetTangentSpaces().GetView());
             asdx::SetTable(pCmd, idxTexCoord,       mesh.GetTexCoords   (0).GetView());
-            asdx::SetTable(pCmd, idxIndices,        mesh.GetInindices    ().GetView());
-            asdx::SetTable(pCmd, idxPrimitives,     mesh.GetPrimitives   ().GetView());
-            asdx::SetTable(pCmd, idxMeshlets,       mesh.GetMeshlets     ().GetView());
-            asdx::SetTable(pCmd, idxCullInfo,       mesh.GetCullingInfos ().GetView());
 
             auto meshletCount = mesh.GetMeshletCount();
+            if (m_EnableLod && i < m_LodMeshes.size())
+            {
+                // 頂点バッファは共有し, 選択したカットのメッシュレットを描画する.
+                auto& lod = m_LodMeshes[i];
+                asdx::SetTable(pCmd, idxIndices,    lod.IndicesSRV   .GetPtr());
+                asdx::SetTable(pCmd, idxPrimitives, lod.PrimitivesSRV.GetPtr());
+                asdx::SetTable(pCmd, idxMeshlets,   lod.MeshletsSRV [m_LodBufferIndex].GetPtr());
+                asdx::SetTable(pCmd, idxCullInfo,   lod.CullInfosSRV[m_LodBufferIndex].GetPtr());
+                meshletCount = uint32_t(lod.SelectedMeshlets.size());
+            }
+            else
+            {
+                asdx::SetTable(pCmd, idxIndices,    mesh.GetInindices    ().GetView());
+                asdx::SetTable(pCmd, idxPrimitives, mesh.GetPrimitives   ().GetView());
+                asdx::SetTable(pCmd, idxMeshlets,   mesh.GetMeshlets     ().GetView());
+                asdx::SetTable(pCmd, idxCullInfo,   mesh.GetCullingInfos ().GetView());
+            }
+
             asdx::SetConstant(pCmd, idxMeshletInfo, meshletCount, 0);
 
             auto dipatchCount = asdx::DivRoundUp(meshletCount, 32);
@@ -386,6 +487,20 @@ void SampleApp::OnKey(const asdx::KeyEventArgs& param)
     {
         if (param.KeyCode == 'S')
         { m_DebugPause = !m_DebugPause; }
+
+        // メッシュレット階層の有効/無効.
+        if (param.KeyCode == 'L')
+        { m_EnableLod = !m_EnableLod; }
+
+        // カメラパスの記録開始/終了.
+        if (param.KeyCode == 'R')
+        {
+            m_RecordCamera = !m_RecordCamera;
+            if (m_RecordCamera)
+            { m_CameraPath.clear(); }
+            else if (SaveCameraPath("camera_path.txt", m_CameraPath))
+            { ILOG("Info : Camera Path Saved. frames = %zu", m_CameraPath.size()); }
+        }
     }
 }
 
@@ -394,4 +509,109 @@ void SampleApp::OnKey(const asdx::KeyEventArgs& param)
 //-----------------------------------------------------------------------------
 void SampleApp::OnTyping(uint32_t keyCode)
 {
-}
\ No newline at end of file
+}
+
+//-----------------------------------------------------------------------------
+//      メッシュレット階層を構築します.
+//-----------------------------------------------------------------------------
+bool SampleApp::InitLod(const char* path)
+{
+    // asdx::Model と同じファイルから三角形リストを復元する.
+    MeshletModel model;
+    if (!LoadMeshletModel(path, model))
+    {
+        ELOG("Error : LoadMeshletModel() Failed.");
+        return false;
+    }
+
+    auto pDevice = asdx::GetD3D12Device();
+
+    MeshletHierarchyDesc desc;
+    std::vector<uint32_t> indices;
+
+    m_LodMeshes.resize(model.Meshes.size());
+    for (size_t i = 0; i < model.Meshes.size(); ++i)
+    {
+        auto& src = model.Meshes[i];
+        auto& dst = m_LodMeshes[i];
+
+        ExtractTriangles(src.Meshlets, indices);
+        if (!BuildMeshletHierarchy(
+            src.Positions.data(),
+            uint32_t(src.Positions.size()),
+            indices.data(),
+            uint32_t(indices.size()),
+            desc,
+            dst.Hierarchy))
+        {
+            ELOG("Error : BuildMeshletHierarchy() Failed. mesh = %zu", i);
+            return false;
+        }
+
+        auto& clusters = dst.Hierarchy.Clusters;
+        auto  count    = uint32_t(clusters.Meshlets.size());
+
+        auto ret = CreateBuffer(pDevice,
+                        clusters.UniqueVertexIndices.data(),
+                        uint32_t(clusters.UniqueVertexIndices.size()),
+                        sizeof(uint32_t),
+                        dst.Indices.GetAddress(),
+                        dst.IndicesSRV.GetAddress())
+                && CreateBuffer(pDevice,
+                        clusters.Primitives.data(),
+                        uint32_t(clusters.Primitives.size()),
+                        sizeof(uint32_t),
+                        dst.Primitives.GetAddress(),
+                        dst.PrimitivesSRV.GetAddress());
+
+        // 選択結果は毎フレーム書き換えるので, 全クラスタ分を確保して GPU と交互に使う.
+        for (auto j = 0u; ret && j < LodMesh::BufferCount; ++j)
+        {
+            ret = CreateBuffer(pDevice, nullptr, count, sizeof(Meshlet),
+                        dst.Meshlets[j].GetAddress(), dst.MeshletsSRV[j].GetAddress())
+               && CreateBuffer(pDevice, nullptr, count, sizeof(CullInfo),
+                        dst.CullInfos[j].GetAddress(), dst.CullInfosSRV[j].GetAddress());
+        }
+
+        if (!ret)
+        {
+            ELOG("Error : CreateBuffer() Failed. mesh = %zu", i);
+            return false;
+        }
+
+        ILOG("Info : Meshlet Hierarchy Built. mesh = %zu, levels = %u, clusters = %u",
+            i, dst.Hierarchy.LevelCount, count);
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      カメラ位置に応じてメッシュレット階層のカットを選択します.
+//-----------------------------------------------------------------------------
+void SampleApp::UpdateLod(const asdx::Vector3& cameraPos, const asdx::Vector3& scale)
+{
+    if (!m_EnableLod || m_LodMeshes.empty())
+    { return; }
+
+    // 前フレームの描画が参照しているバッファには書き込まない.
+    m_LodBufferIndex = (m_LodBufferIndex + 1) % LodMesh::BufferCount;
+
+    // 誤差はオブジェクト空間で評価する. 非一様スケールは最大スケールで保守的に扱う.
+    LodView view;
+    view.CameraPos       = asdx::Vector3(cameraPos.x / scale.x, cameraPos.y / scale.y, cameraPos.z / scale.z);
+    view.ProjectionScale = asdx::Max(scale.x, asdx::Max(scale.y, scale.z))
+                         * float(m_Height) / (2.0f * tanf(asdx::F_PIDIV4 * 0.5f));
+    view.ErrorThreshold  = kLodErrorThreshold;
+
+    for (auto& lod : m_LodMeshes)
+    {
+        SelectMeshletLod(lod.Hierarchy, view, lod.Selected);
+        GatherMeshlets(lod.Hierarchy, lod.Selected, lod.SelectedMeshlets, lod.SelectedCullInfos);
+
+        WriteBuffer(lod.Meshlets [m_LodBufferIndex].GetPtr(),
+            lod.SelectedMeshlets.data(), lod.SelectedMeshlets.size() * sizeof(Meshlet));
+        WriteBuffer(lod.CullInfos[m_LodBufferIndex].GetPtr(),
+            lod.SelectedCullInfos.data(), lod.SelectedCullInfos.size() * sizeof(CullInfo));
+    }
+}
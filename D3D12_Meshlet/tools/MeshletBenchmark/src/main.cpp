@@ -0,0 +1,386 @@
+﻿//-----------------------------------------------------------------------------
+// File : main.cpp
+// Desc : Meshlet Module Benchmark.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdio>
+#include <cmath>
+#include <cstring>
+#include <array>
+#include <algorithm>
+#include <chrono>
+#include <MeshletBuilder.h>
+#include <MeshletEncoder.h>
+#include <MeshletCulling.h>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t kStacks = 200;    //!< 検証用メッシュの緯度方向の分割数です.
+static const uint32_t kSlices = 200;    //!< 検証用メッシュの経度方向の分割数です.
+static const uint32_t kFrames = 600;    //!< 生成するカメラパスのフレーム数です.
+static const float    kPi     = 3.14159265f;
+
+///////////////////////////////////////////////////////////////////////////////
+// Triangle type
+///////////////////////////////////////////////////////////////////////////////
+using Triangle = std::array<uint32_t, 3>;
+
+//-----------------------------------------------------------------------------
+//      凹凸のある球を作成します.
+//-----------------------------------------------------------------------------
+void CreateBumpySphere
+(
+    std::vector<asdx::Vector3>& positions,
+    std::vector<uint32_t>&      indices
+)
+{
+    positions.clear();
+    indices.clear();
+
+    for (auto i = 0u; i <= kStacks; ++i)
+    {
+        for (auto j = 0u; j <= kSlices; ++j)
+        {
+            auto theta = kPi * float(i) / float(kStacks);
+            auto phi   = 2.0f * kPi * float(j) / float(kSlices);
+            auto r     = 1.0f + 0.05f * sinf(7.0f * theta) * cosf(5.0f * phi);
+            positions.push_back(asdx::Vector3(
+                r * sinf(theta) * cosf(phi),
+                r * cosf(theta),
+                r * sinf(theta) * sinf(phi)));
+        }
+    }
+
+    for (auto i = 0u; i < kStacks; ++i)
+    {
+        for (auto j = 0u; j < kSlices; ++j)
+        {
+            auto a = i * (kSlices + 1) + j;
+            auto b = a + 1;
+            auto c = a + kSlices + 1;
+            auto d = c + 1;
+            indices.insert(indices.end(), { a, c, b, b, c, d });
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      巻き順を保ったまま先頭が最小の頂点番号になるように回転します.
+//-----------------------------------------------------------------------------
+Triangle Canonicalize(uint32_t i0, uint32_t i1, uint32_t i2)
+{
+    if (i1 < i0 && i1 < i2) { return Triangle{ i1, i2, i0 }; }
+    if (i2 < i0 && i2 < i1) { return Triangle{ i2, i0, i1 }; }
+    return Triangle{ i0, i1, i2 };
+}
+
+//-----------------------------------------------------------------------------
+//      メッシュレットの三角形を頂点番号で列挙します.
+//-----------------------------------------------------------------------------
+void CollectTriangles(const MeshletData& data, size_t index, std::vector<Triangle>& result)
+{
+    auto& meshlet = data.Meshlets[index];
+
+    result.clear();
+    for (auto i = 0u; i < meshlet.PrimitiveCount; ++i)
+    {
+        auto packed = data.Primitives[meshlet.PrimitiveOffset + i];
+        auto base   = &data.UniqueVertexIndices[meshlet.VertexOffset];
+        result.push_back(Canonicalize(
+            base[(packed >>  0) & 0x3ff],
+            base[(packed >> 10) & 0x3ff],
+            base[(packed >> 20) & 0x3ff]));
+    }
+    std::sort(result.begin(), result.end());
+}
+
+//-----------------------------------------------------------------------------
+//      量子化による位置座標の許容誤差を求めます.
+//-----------------------------------------------------------------------------
+float GetTolerance(MESHLET_POSITION_FORMAT format, const EncodedMeshlet& meshlet, uint32_t axis)
+{
+    auto maxValue = 65535.0f;
+    if (format == MESHLET_POSITION_UNORM11_11_10)
+    { maxValue = (axis == 2) ? 1023.0f : 2047.0f; }
+
+    // 丸め誤差は半ステップ. 浮動小数の演算誤差分だけ余裕を持たせる.
+    return meshlet.BoundsSize[axis] / maxValue * 0.5f + 1e-5f;
+}
+
+//-----------------------------------------------------------------------------
+//      圧縮して復元したメッシュレットが元と一致するかチェックします.
+//-----------------------------------------------------------------------------
+bool CheckRoundTrip
+(
+    const std::vector<asdx::Vector3>&   positions,
+    const MeshletData&                  source,
+    const MeshletEncodeDesc&            desc
+)
+{
+    EncodedMeshletData encoded;
+    if (!EncodeMeshlets(positions.data(), uint32_t(positions.size()), source, desc, encoded))
+    {
+        printf("encode failed.\n");
+        return false;
+    }
+
+    MeshletData                decoded;
+    std::vector<asdx::Vector3> decodedPositions;
+    if (!DecodeMeshlets(encoded, decoded, &decodedPositions))
+    {
+        printf("decode failed.\n");
+        return false;
+    }
+
+    auto result = decoded.Meshlets.size() == source.Meshlets.size()
+               && decoded.CullInfos.size() == source.CullInfos.size()
+               && decodedPositions.size() == decoded.UniqueVertexIndices.size();
+
+    auto triangleMismatch = 0u;
+    auto cullMismatch     = 0u;
+    auto positionOver     = 0u;
+    auto maxError         = 0.0f;
+
+    std::vector<Triangle> expected;
+    std::vector<Triangle> actual;
+    for (size_t i = 0; result && i < source.Meshlets.size(); ++i)
+    {
+        // 並べ替えでローカル番号と三角形の順序は変わるが, 三角形の集合と巻き順は変わらない.
+        CollectTriangles(source,  i, expected);
+        CollectTriangles(decoded, i, actual);
+        if (expected != actual)
+        { triangleMismatch++; }
+
+        auto& s = source .CullInfos[i];
+        auto& d = decoded.CullInfos[i];
+        if (memcmp(&s, &d, sizeof(CullInfo)) != 0)
+        { cullMismatch++; }
+
+        auto& meshlet = decoded.Meshlets[i];
+        for (auto j = 0u; j < meshlet.VertexCount; ++j)
+        {
+            auto  index = meshlet.VertexOffset + j;
+            auto& p     = positions[decoded.UniqueVertexIndices[index]];
+            auto& q     = decodedPositions[index];
+
+            float error[3] = { fabsf(p.x - q.x), fabsf(p.y - q.y), fabsf(p.z - q.z) };
+            for (auto k = 0u; k < 3; ++k)
+            {
+                maxError = std::max(maxError, error[k]);
+                if (error[k] > GetTolerance(encoded.PositionFormat, encoded.Meshlets[i], k))
+                { positionOver++; }
+            }
+        }
+    }
+
+    result &= (triangleMismatch == 0) && (cullMismatch == 0) && (positionOver == 0);
+
+    auto report = ComputeMeshletSizeReport(source, uint32_t(positions.size()), encoded);
+    printf("  primitive = %s, position = %-8s, reorder = %d : ratio = %.3f, max error = %.2e ... %s\n",
+        (desc.PrimitiveFormat == MESHLET_PRIMITIVE_U8X3) ? "u8x3    " : "packed10",
+        (desc.PositionFormat  == MESHLET_POSITION_UNORM16) ? "unorm16" : "11_11_10",
+        desc.Reorder ? 1 : 0,
+        report.Ratio,
+        maxError,
+        result ? "OK" : "NG");
+
+    if (!result)
+    {
+        printf("    triangle mismatch = %u, cull info mismatch = %u, position over = %u\n",
+            triangleMismatch, cullMismatch, positionOver);
+    }
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      メッシュの周りを回りながら近づいて離れるカメラパスを作成します.
+//-----------------------------------------------------------------------------
+void CreateOrbitPath(std::vector<CameraKey>& keys)
+{
+    keys.resize(kFrames);
+    for (auto i = 0u; i < kFrames; ++i)
+    {
+        auto t      = float(i) / float(kFrames);
+        auto angle  = 2.0f * kPi * t;
+        auto radius = 2.25f + 1.0f * cosf(3.0f * angle);
+        auto height = 0.75f * sinf(2.0f * angle);
+
+        auto& key = keys[i];
+        key.Position    = asdx::Vector3(radius * cosf(angle), height, radius * sinf(angle));
+        key.View        = asdx::Matrix::CreateLookAt(
+            key.Position,
+            asdx::Vector3(0.3f * sinf(5.0f * angle), 0.0f, 0.0f),
+            asdx::Vector3(0.0f, 1.0f, 0.0f));
+        key.FieldOfView = kPi / 4.0f;
+        key.AspectRatio = 16.0f / 9.0f;
+        key.NearClip    = 0.1f;
+        key.FarClip     = 1000.0f;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      カメラキーからカリングパラメータを求めます.
+//-----------------------------------------------------------------------------
+CullParam CreateCullParam(const CameraKey& key)
+{
+    auto proj = asdx::Matrix::CreatePerspectiveFieldOfView(
+        key.FieldOfView,
+        key.AspectRatio,
+        key.NearClip,
+        key.FarClip);
+
+    CullParam result;
+    result.World     = asdx::Matrix::CreateIdentity();
+    result.Scale     = 1.0f;
+    result.CameraPos = key.Position;
+    asdx::CalcFrustumPlanes(key.View, proj, result.Planes);
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      一括カリングの結果が IsVisible() と一致するかチェックします.
+//-----------------------------------------------------------------------------
+bool CheckCulling
+(
+    const MeshletCuller&            culler,
+    const MeshletData&              meshlets,
+    const std::vector<CameraKey>&   keys
+)
+{
+    std::vector<uint8_t> visibility;
+    auto mismatch = 0u;
+    auto total    = 0u;
+
+    for (auto& key : keys)
+    {
+        auto param = CreateCullParam(key);
+        auto stats = culler.Cull(param, &visibility);
+
+        auto visible   = 0u;
+        auto triangles = 0u;
+        for (size_t i = 0; i < meshlets.CullInfos.size(); ++i)
+        {
+            auto expected = IsVisible(meshlets.CullInfos[i], param);
+            if (expected != (visibility[i] != 0))
+            { mismatch++; }
+
+            if (expected)
+            {
+                visible++;
+                triangles += meshlets.Meshlets[i].PrimitiveCount;
+            }
+        }
+        total += uint32_t(meshlets.CullInfos.size());
+
+        if (stats.VisibleMeshlets != visible || stats.VisibleTriangles != triangles)
+        { mismatch++; }
+    }
+
+    auto result = (mismatch == 0);
+    printf("culling vs IsVisible() : %u frames, %u tests, %u mismatch ... %s\n",
+        uint32_t(keys.size()), total, mismatch, result ? "OK" : "NG");
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      カメラパスを再生してカリング率と処理時間を計測します.
+//-----------------------------------------------------------------------------
+void MeasureReplay(const MeshletCuller& culler, const std::vector<CameraKey>& keys)
+{
+    auto world = asdx::Matrix::CreateIdentity();
+
+    auto begin  = std::chrono::high_resolution_clock::now();
+    auto report = ReplayCameraPath(culler, world, 1.0f, keys);
+    auto end    = std::chrono::high_resolution_clock::now();
+
+    auto elapsed = std::chrono::duration<double, std::micro>(end - begin).count();
+    auto tests   = double(report.FrameCount) * double(culler.GetMeshletCount());
+
+    printf("replay : %u frames\n", report.FrameCount);
+    printf("  cull ratio        = %.3f (min %.3f, max %.3f)\n",
+        report.AverageCullRatio, report.MinCullRatio, report.MaxCullRatio);
+    printf("  frustum / cone    = %.3f / %.3f\n", report.FrustumCullRatio, report.ConeCullRatio);
+    printf("  triangle savings  = %.3f\n", report.TriangleSavings);
+    printf("  time              = %.1f us/frame, %.2f ns/meshlet\n",
+        elapsed / double(report.FrameCount), elapsed * 1000.0 / tests);
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    std::vector<asdx::Vector3> positions;
+    std::vector<uint32_t>      indices;
+    CreateBumpySphere(positions, indices);
+
+    MeshletBuildDesc desc;
+    MeshletData      meshlets;
+    if (!BuildMeshlets(
+        positions.data(), uint32_t(positions.size()),
+        indices.data(), uint32_t(indices.size()),
+        desc, meshlets))
+    {
+        printf("build failed.\n");
+        return -1;
+    }
+
+    printf("vertices = %zu, triangles = %zu, meshlets = %zu\n",
+        positions.size(), indices.size() / 3, meshlets.Meshlets.size());
+
+    printf("encode -> decode round trip\n");
+    auto result = true;
+    for (auto primitive : { MESHLET_PRIMITIVE_U8X3, MESHLET_PRIMITIVE_PACKED10 })
+    {
+        for (auto position : { MESHLET_POSITION_UNORM16, MESHLET_POSITION_UNORM11_11_10 })
+        {
+            for (auto reorder : { false, true })
+            {
+                MeshletEncodeDesc encodeDesc;
+                encodeDesc.PrimitiveFormat = primitive;
+                encodeDesc.PositionFormat  = position;
+                encodeDesc.Reorder         = reorder;
+                result &= CheckRoundTrip(positions, meshlets, encodeDesc);
+            }
+        }
+    }
+
+    // サンプルで記録したカメラパスを指定された場合はそれを再生する.
+    std::vector<CameraKey> keys;
+    if (argc > 1)
+    {
+        if (!LoadCameraPath(argv[1], keys))
+        {
+            printf("camera path load failed. path = %s\n", argv[1]);
+            return -1;
+        }
+    }
+    else
+    {
+        CreateOrbitPath(keys);
+    }
+
+    MeshletCuller culler;
+    culler.Init(meshlets.Meshlets.data(), meshlets.CullInfos.data(), uint32_t(meshlets.Meshlets.size()));
+
+    result &= CheckCulling(culler, meshlets, keys);
+    MeasureReplay(culler, keys);
+
+    culler.Term();
+
+    return (result) ? 0 : -1;
+}
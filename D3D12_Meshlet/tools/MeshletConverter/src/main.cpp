@@ -0,0 +1,127 @@
+﻿//-----------------------------------------------------------------------------
+// File : main.cpp
+// Desc : Meshlet Model Converter.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <MeshletModel.h>
+#include <fnd/asdxLogger.h>
+
+
+namespace {
+
+///////////////////////////////////////////////////////////////////////////////
+// Option structure
+///////////////////////////////////////////////////////////////////////////////
+struct Option
+{
+    MeshletBuildDesc    Desc;           //!< 構築設定.
+    std::string         InputPath;      //!< 入力ファイルパス.
+    std::string         OutputPath;     //!< 出力ファイルパス.
+};
+
+//-----------------------------------------------------------------------------
+//      使い方を表示します.
+//-----------------------------------------------------------------------------
+void PrintUsage()
+{
+    MeshletBuildDesc desc;
+    printf("Usage : MeshletConverter [options] <input.mdl> <output.mdl>\n");
+    printf("  rebuilds the meshlets of a model with BuildMeshlets().\n");
+    printf("Options :\n");
+    printf("  -v <count>   max vertices per meshlet (default: %u, max 256).\n", desc.MaxVertices);
+    printf("  -p <count>   max primitives per meshlet (default: %u).\n", desc.MaxPrimitives);
+    printf("  -c <weight>  normal cone weight [0, 1] (default: %g).\n", desc.ConeWeight);
+}
+
+//-----------------------------------------------------------------------------
+//      コマンドライン引数を解析します.
+//-----------------------------------------------------------------------------
+bool ParseArgs(int argc, char** argv, Option& option)
+{
+    std::vector<const char*> paths;
+
+    for (auto i = 1; i < argc; ++i)
+    {
+        auto hasValue = (i + 1 < argc);
+
+        if (strcmp(argv[i], "-v") == 0 && hasValue)
+        { option.Desc.MaxVertices = uint32_t(atoi(argv[++i])); }
+        else if (strcmp(argv[i], "-p") == 0 && hasValue)
+        { option.Desc.MaxPrimitives = uint32_t(atoi(argv[++i])); }
+        else if (strcmp(argv[i], "-c") == 0 && hasValue)
+        { option.Desc.ConeWeight = float(atof(argv[++i])); }
+        else if (argv[i][0] == '-')
+        {
+            ELOG("Error : Unknown Option. option = %s", argv[i]);
+            return false;
+        }
+        else
+        { paths.push_back(argv[i]); }
+    }
+
+    if (paths.size() != 2)
+    { return false; }
+
+    option.InputPath  = paths[0];
+    option.OutputPath = paths[1];
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      メッシュレットの品質指標を表示します.
+//-----------------------------------------------------------------------------
+void PrintStatistics(const char* tag, const MeshletModel& model, const MeshletBuildDesc& desc)
+{
+    for (size_t i = 0; i < model.Meshes.size(); ++i)
+    {
+        auto stats = ComputeMeshletStatistics(model.Meshes[i].Meshlets, desc);
+        printf("%s mesh %zu : meshlets = %u, vertex fill = %.2f, primitive fill = %.2f, cone = %.1f deg, degenerate = %.2f\n",
+            tag,
+            i,
+            stats.MeshletCount,
+            stats.VertexFillRate,
+            stats.PrimitiveFillRate,
+            stats.AverageConeAngle,
+            stats.DegenerateConeRate);
+    }
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    Option option;
+    if (!ParseArgs(argc, argv, option))
+    {
+        PrintUsage();
+        return -1;
+    }
+
+    MeshletModel model;
+    if (!LoadMeshletModel(option.InputPath.c_str(), model))
+    { return -1; }
+
+    PrintStatistics("before", model, option.Desc);
+
+    if (!RebuildMeshlets(option.Desc, model))
+    { return -1; }
+
+    PrintStatistics("after ", model, option.Desc);
+
+    if (!SaveMeshletModel(option.OutputPath.c_str(), model))
+    { return -1; }
+
+    return 0;
+}
@@ -48,6 +48,8 @@ private:
         asdx::Matrix    World;
         asdx::Matrix    View;
         asdx::Matrix    Proj;
+        asdx::Vector4   PositionScale;      //!< 位置座標の復元スケールです.
+        asdx::Vector4   PositionOffset;     //!< 位置座標の復元オフセットです.
     };
 
     //=============================================================================================
@@ -72,6 +74,8 @@ private:
     TransformParam                      m_TransformParam;
     asdx::DescHandle                    m_TransformHandle;
     bool                                m_IsPlay;
+    asdx::Vector3                       m_CameraPos;        //!< カメラ位置です.
+    asdx::Vector3                       m_CameraTarget;     //!< カメラ注視点です.
     asdx::StopWatch                     m_StopWatch;
 
     //=============================================================================================
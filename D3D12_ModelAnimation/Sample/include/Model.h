@@ -16,6 +16,9 @@
 #include <asdxIndexBuffer.h>
 #include <asdxConstantBuffer.h>
 #include <asdxResMesh.h>
+#include <asdxMeshOptimizer.h>
+#include <asdxMeshQuantizer.h>
+#include <asdxRenderQueue.h>
 #include <vector>
 #include <d3d12.h>
 
@@ -40,12 +43,13 @@ struct Material
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 struct SkinningVertex
 {
-    asdx::Vector3   Position;       //!< 位置座標.
-    asdx::Vector3   Normal;         //!< 法線ベクトル.
-    asdx::Vector2   TexCoord;       //!< テクスチャ座標.
-    asdx::uint2     BoneIndices;    //!< ボーン番号.
-    asdx::Vector2   BoneWeights;    //!< ボーンの重み.
+    u16             Position[4];    //!< 位置座標(AABB 基準の unorm16, w は未使用).
+    s16             Normal[2];      //!< 法線ベクトル(八面体表現の snorm16).
+    f16             TexCoord[2];    //!< テクスチャ座標(half).
+    u8              BoneIndices[2]; //!< ボーン番号.
+    u8              BoneWeights[2]; //!< ボーンの重み(unorm8).
 };
+static_assert( sizeof(SkinningVertex) == 20, "Invalid Vertex Size." );
 
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -103,6 +107,16 @@ public:
     //---------------------------------------------------------------------------------------------
     void DrawCmd( ID3D12GraphicsCommandList* pCmd );
 
+    //---------------------------------------------------------------------------------------------
+    //! @brief      画面上の誤差から描画する詳細度を選択します.
+    //!
+    //! @param[in]      eye             カメラ位置です.
+    //! @param[in]      fovY            垂直画角(ラジアン)です.
+    //! @param[in]      screenHeight    画面の高さ(ピクセル)です.
+    //! @return     選択した詳細度を返却します(0 の場合は元メッシュ).
+    //---------------------------------------------------------------------------------------------
+    u32 SelectLod( const asdx::Vector3& eye, f32 fovY, f32 screenHeight );
+
     //---------------------------------------------------------------------------------------------
     //! @brief      ボーンを取得します.
     //---------------------------------------------------------------------------------------------
@@ -110,17 +124,24 @@ public:
 
     u32 GetBoneCount() const;
 
+    //---------------------------------------------------------------------------------------------
+    //! @brief      位置座標の復元パラメータを取得します.
+    //---------------------------------------------------------------------------------------------
+    const asdx::PositionQuantization& GetQuantization() const;
+
 private:
     //=============================================================================================
     // private variables.
     //=============================================================================================
     std::vector<SkinningVertex>     m_Vertices;     //!< 頂点データ.
-    std::vector<u32>                m_Indices;      //!< インデックスデータ.
+    asdx::PackedIndices             m_Indices;      //!< インデックスデータ.
     std::vector<asdx::ResBone>      m_Bones;        //!< ボーンです.
-    std::vector<asdx::ResSubset>    m_Subsets;      //!< サブセットです.
-    std::vector<asdx::ResTexture>   m_ResTextures;  //!< テクスチャ.
+    std::vector<asdx::PackedSubset> m_Subsets;      //!< サブセットです.
+    std::vector<asdx::ResLod>       m_Lods;         //!< 詳細度です.
+    u32                             m_LodIndex;     //!< 描画する詳細度です(0 の場合は元メッシュ).
     std::vector<Material>           m_Materials;    //!< マテリアルです.
     u8*                             m_pHeadCB;      //!< 定数バッファの戦闘ポインタ.
+    asdx::PositionQuantization      m_Quantization; //!< 位置座標の復元パラメータです.
 
     asdx::VertexBuffer              m_VB;
     asdx::IndexBuffer               m_IB;
@@ -131,6 +152,15 @@ private:
     asdx::ResTexture                m_DummyResTexture;
     asdx::RefPtr<ID3D12Resource>    m_DummyTexture;
     asdx::DescHandle                m_DummySRV;
+    std::vector<asdx::RenderQueue>  m_Queues;           //!< 詳細度ごとのサブセットの描画キューです.
+    std::vector<D3D12_GPU_DESCRIPTOR_HANDLE> m_MaterialTables;  //!< マテリアルごとのディスクリプタテーブル(SRV, CBV)です.
+
+    bool LoadTexture(
+        asdx::Device& device,
+        asdx::DeviceContext& context,
+        const char16* path,
+        ID3D12Resource** ppResource,
+        asdx::DescHandle* pHandle ) const;
 
     bool CreateTexture(
         asdx::Device& device,
@@ -9,11 +9,11 @@
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 struct VSInput
 {
-    float3 Position   : POSITION;
-    float3 Normal     : NORMAL;
-    float2 TexCoord   : TEXCOORD;
+    float4 Position   : POSITION;       // AABB relative unorm16.
+    float2 Normal     : NORMAL;         // Octahedral snorm16.
+    float2 TexCoord   : TEXCOORD;       // half2.
     uint2  BoneIndex  : BONE_INDEX;
-    float2 BoneWeight : BONE_WEIGHT;
+    float2 BoneWeight : BONE_WEIGHT;    // unorm8.
 };
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -40,6 +40,8 @@ cbuffer Transform : register( b0 )
     float4x4 World;
     float4x4 View;
     float4x4 Proj;
+    float4   PositionScale;
+    float4   PositionOffset;
     float4x4 Bones[256];
 };
 
@@ -55,3 +57,21 @@ cbuffer Material : register( b1 )
 Texture2D       ColorMap : register( t0 );
 SamplerState    ColorSmp : register( s0 );
 
+
+//-------------------------------------------------------------------------------------------------
+//      Decodes the quantized position.
+//-------------------------------------------------------------------------------------------------
+float3 DecodePosition(float4 value)
+{ return value.xyz * PositionScale.xyz + PositionOffset.xyz; }
+
+//-------------------------------------------------------------------------------------------------
+//      Decodes the octahedral normal.
+//-------------------------------------------------------------------------------------------------
+float3 DecodeNormal(float2 value)
+{
+    float3 n = float3(value.x, value.y, 1.0f - abs(value.x) - abs(value.y));
+    float  t = saturate(-n.z);
+    n.xy += (n.xy >= 0.0f) ? -t : t;
+    return normalize(n);
+}
+
@@ -17,7 +17,7 @@ VSOutput VSFunc(VSInput input)
 {
     VSOutput output = (VSOutput)0;
 
-    float4 localPos = float4(input.Position, 1.0f);
+    float4 localPos = float4(DecodePosition(input.Position), 1.0f);
 
     float4x4 skinning = (float4x4)0;
     skinning += Bones[input.BoneIndex.x] * input.BoneWeight.x;
@@ -28,7 +28,7 @@ VSOutput VSFunc(VSInput input)
     float4 viewPos  = mul(View, worldPos);
     float4 projPos  = mul(Proj, viewPos);
 
-    float3 transNormal = mul((float3x3)skinning, input.Normal);
+    float3 transNormal = mul((float3x3)skinning, DecodeNormal(input.Normal));
     float3 worldNormal = mul((float3x3)World, transNormal);
     worldNormal = normalize(worldNormal);
 
@@ -242,11 +242,11 @@ bool App::OnInit()
 
         // 入力レイアウトの設定.
         D3D12_INPUT_ELEMENT_DESC inputElements[] = {
-            { "POSITION",    0, DXGI_FORMAT_R32G32B32_FLOAT,    0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-            { "NORMAL",      0, DXGI_FORMAT_R32G32B32_FLOAT,    0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-            { "TEXCOORD",    0, DXGI_FORMAT_R32G32_FLOAT,       0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-            { "BONE_INDEX",  0, DXGI_FORMAT_R32G32_UINT,        0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-            { "BONE_WEIGHT", 0, DXGI_FORMAT_R32G32_FLOAT,       0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+            { "POSITION",    0, DXGI_FORMAT_R16G16B16A16_UNORM, 0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+            { "NORMAL",      0, DXGI_FORMAT_R16G16_SNORM,       0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+            { "TEXCOORD",    0, DXGI_FORMAT_R16G16_FLOAT,       0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+            { "BONE_INDEX",  0, DXGI_FORMAT_R8G8_UINT,          0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+            { "BONE_WEIGHT", 0, DXGI_FORMAT_R8G8_UNORM,         0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
         };
 
         // パイプラインステートの設定.
@@ -277,10 +277,13 @@ bool App::OnInit()
     // アスペクト比算出.
     auto aspectRatio = static_cast<FLOAT>( m_Width ) / static_cast<FLOAT>( m_Height );
 
+    m_CameraPos    = asdx::Vector3(0.0f, 15.0f, -35.0f);
+    m_CameraTarget = asdx::Vector3(0.0f, 10.0f, 0.0f);
+
     m_TransformParam.World = asdx::Matrix::CreateIdentity();
     m_TransformParam.View  = asdx::Matrix::CreateLookAt( 
-        asdx::Vector3(0.0f, 15.0f, -35.0f),
-        asdx::Vector3(0.0f, 10.0f, 0.0f),
+        m_CameraPos,
+        m_CameraTarget,
         asdx::Vector3(0.0f, 1.0f, 0.0f));
     m_TransformParam.Proj  = asdx::Matrix::CreatePerspectiveFieldOfView( asdx::F_PIDIV4, aspectRatio, 1.0f, 1000.0f );
 
@@ -319,6 +322,10 @@ bool App::InitModel()
             ELOG( "Error : Model::Init() Failed." );
             return false;
         }
+
+        const auto& quantization = m_Model.GetQuantization();
+        m_TransformParam.PositionScale  = asdx::Vector4( quantization.Scale,  0.0f );
+        m_TransformParam.PositionOffset = asdx::Vector4( quantization.Offset, 0.0f );
     }
 
     // モーション ファイル読み込み.
@@ -468,6 +475,8 @@ void App::OnFrameRender(const asdx::FrameEventArgs& args)
     auto handleCBV = m_TransformHandle.GetHandleGpu();
     m_DeviceContext->SetGraphicsRootDescriptorTable( 0, handleCBV );
 
+    // カメラからの距離に応じて詳細度を切り替える.
+    m_Model.SelectLod( m_CameraPos, asdx::F_PIDIV4, static_cast<f32>( m_Height ) );
     m_Model.DrawCmd( m_DeviceContext.GetGraphicsCommandList() );
 
     m_DeviceContext.Transition(
@@ -505,5 +514,19 @@ void App::OnKey(const asdx::KeyEventArgs& args)
                 m_StopWatch.Start();
             }
         }
+        else if ( args.KeyCode == VK_UP || args.KeyCode == VK_DOWN )
+        {
+            // カメラを前後に移動して詳細度の切り替えを確認する.
+            auto scale = ( args.KeyCode == VK_UP ) ? 0.8f : 1.25f;
+            auto dir   = ( m_CameraPos - m_CameraTarget ) * scale;
+            if ( dir.Length() > 5.0f && dir.Length() < 800.0f )
+            { m_CameraPos = m_CameraTarget + dir; }
+
+            m_TransformParam.View = asdx::Matrix::CreateLookAt(
+                m_CameraPos,
+                m_CameraTarget,
+                asdx::Vector3(0.0f, 1.0f, 0.0f));
+            m_TransformCB.Update( &m_TransformParam, sizeof(m_TransformParam) );
+        }
     }
 }
\ No newline at end of file
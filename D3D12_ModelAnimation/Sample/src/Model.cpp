@@ -10,6 +10,7 @@
 #include <Model.h>
 #include <asdxLogger.h>
 #include <asdxMisc.h>
+#include <asdxFile.h>
 #include <asdxResMaterial.h>
 
 
@@ -22,6 +23,7 @@
 //      コンストラクタです.
 //-------------------------------------------------------------------------------------------------
 Model::Model()
+: m_LodIndex( 0 )
 { /* DO_NOTHING */ }
 
 //-------------------------------------------------------------------------------------------------
@@ -49,26 +51,69 @@ bool Model::Init
         return false;
     }
 
+    // 重複頂点を統合し, 描画順を最適化してからインデックスを詰める.
+    asdx::WeldVertices( &mesh );
+    asdx::OptimizeMesh( &mesh );
+    asdx::PackIndices( &mesh, &m_Indices );
+    if ( m_Indices.Levels.empty() )
     {
-        m_Vertices.resize( mesh.Positions.size() );
+        ELOG( "Error : Mesh Has No Indices." );
+        return false;
+    }
+
+    {
+        auto vertexCount = static_cast<u32>( mesh.Positions.size() );
+        m_Vertices.resize( vertexCount );
+        m_Quantization = asdx::ComputePositionQuantization( mesh.Positions.data(), vertexCount );
+
+        for( u32 i=0; i<vertexCount; ++i )
+        {
+            auto& dst = m_Vertices[i];
+
+            asdx::QuantizePosition( mesh.Positions[i], m_Quantization, dst.Position );
+            dst.Position[3] = 0;
+
+            asdx::EncodeOctahedral( mesh.Normals[i], dst.Normal );
+
+            dst.TexCoord[0] = asdx::EncodeHalf( mesh.TexCoords[i].x );
+            dst.TexCoord[1] = asdx::EncodeHalf( mesh.TexCoords[i].y );
+
+            assert( mesh.BoneIndices[i].x <= 0xff && mesh.BoneIndices[i].y <= 0xff );
+            dst.BoneIndices[0] = static_cast<u8>( mesh.BoneIndices[i].x );
+            dst.BoneIndices[1] = static_cast<u8>( mesh.BoneIndices[i].y );
+
+            const f32 weights[2] = { mesh.BoneWeights[i].x, mesh.BoneWeights[i].y };
+            asdx::QuantizeBoneWeights( weights, 2, dst.BoneWeights );
+        }
 
-        for( size_t i=0; i<mesh.Positions.size(); ++i )
+        // 量子化誤差を確認.
+        auto maxPosError    = 0.0f;
+        auto maxNormalError = 0.0f;
+        auto maxUVError     = 0.0f;
+        for( u32 i=0; i<vertexCount; ++i )
         {
-            m_Vertices[i].Position = mesh.Positions[i];
-            m_Vertices[i].Normal = mesh.Normals[i];
-            m_Vertices[i].TexCoord = mesh.TexCoords[i];
-            m_Vertices[i].BoneIndices.x = mesh.BoneIndices[i].x;
-            m_Vertices[i].BoneIndices.y = mesh.BoneIndices[i].y;
-            m_Vertices[i].BoneWeights.x = mesh.BoneWeights[i].x;
-            m_Vertices[i].BoneWeights.y = mesh.BoneWeights[i].y;
+            const auto& v = m_Vertices[i];
+
+            auto p = asdx::DequantizePosition( v.Position, m_Quantization );
+            auto n = asdx::DecodeOctahedral( v.Normal );
+            auto u = asdx::Vector2( asdx::DecodeHalf( v.TexCoord[0] ), asdx::DecodeHalf( v.TexCoord[1] ) );
+
+            maxPosError    = asdx::Max( maxPosError,    asdx::Vector3::Distance( p, mesh.Positions[i] ) );
+            maxNormalError = asdx::Max( maxNormalError, 1.0f - asdx::Vector3::Dot( n, asdx::Vector3::SafeNormalize( mesh.Normals[i], n ) ) );
+            maxUVError     = asdx::Max( maxUVError,     asdx::Vector2::Distance( u, mesh.TexCoords[i] ) );
         }
 
-        m_Subsets = mesh.Subsets;
-        m_Indices = mesh.VertexIndices;
-        m_Bones   = mesh.Bones;
+        ILOG( "Info : Vertex Quantization. stride = %u, position error = %f, normal error(1 - cos) = %f, texcoord error = %f",
+            u32(sizeof(SkinningVertex)), maxPosError, maxNormalError, maxUVError );
+
+        m_Subsets  = m_Indices.Subsets;
+        m_Bones    = mesh.Bones;
+        m_Lods     = mesh.Lods;
+        m_LodIndex = 0;
     }
 
     u32 materialCount = 0;
+    std::vector<std::wstring> texturePaths;
     {
         asdx::ResMaterial material;
 
@@ -93,19 +138,16 @@ bool Model::Init
 
         auto dir = asdx::GetDirectoryPath( materialFile );
 
-        m_ResTextures.resize( material.Paths.size() );
+        texturePaths.resize( material.Paths.size() );
 
         for( size_t i=0; i<material.Paths.size(); ++i )
         {
-            std::wstring path;
             auto temp = dir + L"/" + material.Paths[i];
-            if ( !asdx::SearchFilePath( temp.c_str(), path ) )
+            if ( !asdx::SearchFilePath( temp.c_str(), texturePaths[i] ) )
             {
                 assert( false );
                 continue;
             }
-
-            asdx::TextureFactory::Create( path.c_str(), &m_ResTextures[i] );
         }
     }
 
@@ -122,9 +164,9 @@ bool Model::Init
 
     if ( !m_IB.Init( 
         device.GetDevice(),
-        sizeof(u32) * m_Indices.size(),
-        DXGI_FORMAT_R32_UINT,
-        &m_Indices[0]))
+        m_Indices.GetSize(),
+        m_Indices.Use16Bit ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT,
+        m_Indices.GetData()))
     {
         ELOG( "Error : IndexBuffer::Init() Failed." );
         return false;
@@ -154,27 +196,14 @@ bool Model::Init
         cbvDesc.BufferLocation += sizeof(Material);
     }
 
-    auto textureCount = static_cast<u32>( m_ResTextures.size() );
+    auto textureCount = static_cast<u32>( texturePaths.size() );
     m_Textures.resize( textureCount );
     m_SRV.resize( textureCount );
     for( u32 i=0; i<textureCount; ++i )
     {
-        if ( !CreateTexture( device, m_ResTextures[i], m_Textures[i].GetAddress(), &m_SRV[i] ) )
+        if ( !LoadTexture( device, context, texturePaths[i].c_str(), m_Textures[i].GetAddress(), &m_SRV[i] ) )
         {
-            ELOG( "Error : CreateTexture() Failed. index = %u", i );
-            return false;
-        }
-
-        context.Clear( nullptr );
-
-        D3D12_SUBRESOURCE_DATA subRes;
-        subRes.pData      = m_ResTextures[i].pSurfaces->pPixels;
-        subRes.RowPitch   = m_ResTextures[i].pSurfaces->RowPitch;
-        subRes.SlicePitch = m_ResTextures[i].pSurfaces->SlicePitch;
-
-        if ( !context.UpdateSubRes( m_Textures[i].GetPtr(), 0, 1, &subRes ) )
-        {
-            ELOG( "Error : DeviceContext::UpdateSubRes() Failed. index = %u", i );
+            ELOG( "Error : LoadTexture() Failed. index = %u", i );
             return false;
         }
     }
@@ -220,6 +249,52 @@ bool Model::Init
         }
     }
 
+    // 描画キューを構築.
+    {
+        // マテリアルごとに SRV, CBV の順でディスクリプタテーブルを並べる.
+        m_MaterialTables.resize( materialCount * 2 );
+        for( u32 i=0; i<materialCount; ++i )
+        {
+            auto textureId = m_Materials[i].TextureId;
+            m_MaterialTables[i * 2 + 0] = ( textureId != U32_MAX ) ? m_SRV[textureId].GetHandleGpu() : m_DummySRV.GetHandleGpu();
+            m_MaterialTables[i * 2 + 1] = m_CBV[i].GetHandleGpu();
+        }
+
+        // マテリアル番号はファイル上の順番なので, 半透明を含めて元の描画順を保つ.
+        // 詳細度ごとにキューを用意し, 描画時に切り替える.
+        const auto& levels = m_Indices.Levels;
+        m_Queues.resize( levels.size() - 1 );
+        for( size_t l=0; l<m_Queues.size(); ++l )
+        {
+            auto& queue = m_Queues[l];
+            queue.Clear();
+            queue.Reserve( levels[l + 1] - levels[l] );
+
+            u32 indexCount = 0;
+            for( auto i=levels[l]; i<levels[l + 1]; ++i )
+            {
+                asdx::RenderItem item = {};
+                item.PipelineId    = 0;
+                item.MaterialId    = m_Subsets[i].MaterialId;
+                item.GeometryId    = 0;
+                item.IndexCount    = m_Subsets[i].Count;
+                item.StartIndex    = m_Subsets[i].Offset;
+                item.BaseVertex    = static_cast<s32>( m_Subsets[i].BaseVertex );
+                item.InstanceCount = 1;
+                item.StartInstance = 0;
+
+                queue.Push( asdx::MakeRenderKey( 0, false, 0, item.MaterialId, 0.0f ), item );
+                indexCount += item.IndexCount;
+            }
+            queue.Sort();
+
+            const auto& stats = queue.GetStatistics();
+            ILOG( "Info : Render Queue. lod = %u, error = %f, triangle count = %u, draw count = %u, material binds = %u, geometry binds = %u",
+                u32( l ), ( l == 0 ) ? 0.0f : m_Lods[l - 1].Error, indexCount / 3,
+                stats.DrawCount, stats.MaterialBinds, stats.GeometryBinds );
+        }
+    }
+
     // 正常終了.
     return true;
 }
@@ -234,16 +309,98 @@ void Model::Term()
     m_CB.Term();
 
     m_Vertices .clear();
-    m_Indices  .clear();
+    m_Indices  = asdx::PackedIndices();
     m_Materials.clear();
     m_Subsets  .clear();
     m_Bones    .clear();
+    m_Lods     .clear();
+    m_LodIndex = 0;
 
-    m_ResTextures.clear();
-    m_Textures   .clear();
+    m_Textures.clear();
 
     m_CBV.clear();
     m_SRV.clear();
+
+    m_Queues.clear();
+    m_MaterialTables.clear();
+}
+
+//-------------------------------------------------------------------------------------------------
+//      テクスチャを読み込みます.
+//-------------------------------------------------------------------------------------------------
+bool Model::LoadTexture
+(
+    asdx::Device& device,
+    asdx::DeviceContext& context,
+    const char16* path,
+    ID3D12Resource** ppResource,
+    asdx::DescHandle* pHandle
+) const
+{
+    // DDS はファイルをマッピングし, ステージングバッファに直接書き込む.
+    if ( asdx::GetExt( path ) == L"dds" )
+    {
+        asdx::MappedFile     file;
+        asdx::ResTextureView view;
+        if ( !asdx::TextureFactory::Map( path, &file, &view ) )
+        {
+            ELOG( "Error : TextureFactory::Map() Failed. path = %ls", path );
+            return false;
+        }
+
+        asdx::ResTexture texture;
+        texture.Width        = view.Width;
+        texture.Height       = view.Height;
+        texture.Depth        = view.Depth;
+        texture.SurfaceCount = view.SurfaceCount;
+        texture.MipMapCount  = view.MipMapCount;
+        texture.Format       = view.Format;
+        texture.Option       = view.Option;
+
+        if ( !CreateTexture( device, texture, ppResource, pHandle ) )
+        {
+            ELOG( "Error : CreateTexture() Failed. path = %ls", path );
+            return false;
+        }
+
+        context.Clear( nullptr );
+
+        if ( !context.UpdateSubRes( *ppResource, view ) )
+        {
+            ELOG( "Error : DeviceContext::UpdateSubRes() Failed. path = %ls", path );
+            return false;
+        }
+
+        return true;
+    }
+
+    auto pTexture = new asdx::ResTexture();
+    if ( !asdx::TextureFactory::Create( path, pTexture ) )
+    {
+        ELOG( "Error : TextureFactory::Create() Failed. path = %ls", path );
+        asdx::TextureFactory::Dispose( pTexture );
+        return false;
+    }
+
+    auto ret = CreateTexture( device, *pTexture, ppResource, pHandle );
+    if ( ret )
+    {
+        context.Clear( nullptr );
+
+        D3D12_SUBRESOURCE_DATA subRes;
+        subRes.pData      = pTexture->pSurfaces->pPixels;
+        subRes.RowPitch   = pTexture->pSurfaces->RowPitch;
+        subRes.SlicePitch = pTexture->pSurfaces->SlicePitch;
+
+        ret = context.UpdateSubRes( *ppResource, 0, 1, &subRes );
+        if ( !ret )
+        { ELOG( "Error : DeviceContext::UpdateSubRes() Failed. path = %ls", path ); }
+    }
+    else
+    { ELOG( "Error : CreateTexture() Failed. path = %ls", path ); }
+
+    asdx::TextureFactory::Dispose( pTexture );
+    return ret;
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -332,20 +489,38 @@ void Model::DrawCmd( ID3D12GraphicsCommandList* pCmd )
     auto vbv = m_VB.GetView();
     auto ibv = m_IB.GetView();
 
-    pCmd->IASetPrimitiveTopology( D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST );
-    pCmd->IASetVertexBuffers( 0, 1, &vbv );
-    pCmd->IASetIndexBuffer( &ibv );
+    // 同じマテリアルが続くサブセットではディスクリプタテーブルを設定し直さない.
+    asdx::RenderStateTable table = {};
+    table.ppPipelineStates   = nullptr;
+    table.pMaterialTables    = m_MaterialTables.data();
+    table.MaterialTableCount = 2;
+    table.MaterialRootIndex  = 1;
+    table.pVertexBufferViews = &vbv;
+    table.pIndexBufferViews  = &ibv;
 
-    for( size_t i=0; i<m_Subsets.size(); ++i )
-    {
-        auto materialId = m_Subsets[i].MaterialId;
-        auto textureId = m_Materials[materialId].TextureId;
+    pCmd->IASetPrimitiveTopology( D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST );
+    m_Queues[m_LodIndex].Execute( pCmd, table );
+}
 
-        auto handleSRV = ( textureId != U32_MAX ) ? m_SRV[textureId].GetHandleGpu() : m_DummySRV.GetHandleGpu();
-        pCmd->SetGraphicsRootDescriptorTable( 1, handleSRV );
-        pCmd->SetGraphicsRootDescriptorTable( 2, m_CBV[materialId].GetHandleGpu() );
-        pCmd->DrawIndexedInstanced( m_Subsets[i].Count, 1, m_Subsets[i].Offset, 0, 0 );
-    }
+u32 Model::SelectLod( const asdx::Vector3& eye, f32 fovY, f32 screenHeight )
+{
+    // 量子化範囲の中心までの距離で判定する.
+    auto center   = m_Quantization.Offset + m_Quantization.Scale * 0.5f;
+    auto distance = asdx::Vector3::Distance( eye, center );
+
+    m_LodIndex = asdx::SelectMeshLod(
+        m_Lods.data(),
+        static_cast<u32>( m_Lods.size() ),
+        1.0f,
+        distance,
+        fovY,
+        screenHeight );
+
+    // 詳細度数とキュー数が一致しない場合は元メッシュを描画する.
+    if ( m_LodIndex >= m_Queues.size() )
+    { m_LodIndex = 0; }
+
+    return m_LodIndex;
 }
 
 asdx::ResBone* Model::GetBones()
@@ -353,3 +528,6 @@ asdx::ResBone* Model::GetBones()
 
 u32 Model::GetBoneCount() const
 { return static_cast<u32>( m_Bones.size() ); }
+
+const asdx::PositionQuantization& Model::GetQuantization() const
+{ return m_Quantization; }
@@ -12,6 +12,7 @@
 #include <asdxFence.h>
 #include <asdxCommandList.h>
 #include <asdxDescHeap.h>
+#include <asdxResTexture.h>
 #include <d3d12.h>
 
 
@@ -81,6 +82,20 @@ public:
         const u32               subResourceCount,
         D3D12_SUBRESOURCE_DATA* pSrcData );
 
+    //---------------------------------------------------------------------------------------------
+    //! @brief      テクスチャビューの全サブリソースを更新します.
+    //!
+    //! @param[in]      pResource       更新するテクスチャリソースです.
+    //! @param[in]      view            テクスチャビューです.
+    //! @retval true    更新に成功.
+    //! @retval false   更新に失敗.
+    //! @note       WriteToStagingBuffer() でマッピングしたファイルから直接ステージングバッファに
+    //!             書き込み, view.Footprints の配置でコピーします.
+    //---------------------------------------------------------------------------------------------
+    bool UpdateSubRes(
+        ID3D12Resource*         pResource,
+        const ResTextureView&   view );
+
     //---------------------------------------------------------------------------------------------
     //! @brief      遷移によるリソースバリアを設定します.
     //!
@@ -0,0 +1,147 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxFile.h
+// Desc : File Utility Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+#pragma once
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxTypedef.h>
+#include <cstdio>
+#include <string>
+
+
+namespace asdx {
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      ワイド文字列をUTF-8に変換します.
+//!
+//! @param[in]      value           変換する文字列です.
+//! @return     UTF-8 文字列を返却します.
+//-------------------------------------------------------------------------------------------------
+std::string ToUtf8( const char16* value );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      ワイド文字列をUTF-16の固定長バッファに格納します.
+//!
+//! @param[in]      value           変換する文字列です.
+//! @param[out]     pBuffer         格納先のバッファです.
+//! @param[in]      count           バッファの要素数です.
+//! @note       収まらない分は切り捨て, 残りは 0 で埋めます. 常にヌル終端されます.
+//-------------------------------------------------------------------------------------------------
+void ToUtf16( const std::wstring& value, u16* pBuffer, size_t count );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      ワイド文字列をUTF-16の固定長バッファに格納します.
+//!
+//! @param[in]      value           変換する文字列です.
+//! @param[out]     buffer          格納先のバッファです.
+//-------------------------------------------------------------------------------------------------
+template<size_t N>
+inline void ToUtf16( const std::wstring& value, u16 (&buffer)[N] )
+{ ToUtf16( value, buffer, N ); }
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      UTF-16の固定長バッファからワイド文字列に変換します.
+//!
+//! @param[in]      pBuffer         UTF-16 のバッファです.
+//! @param[in]      count           バッファの要素数です. ヌル文字があればそこで終了します.
+//! @return     ワイド文字列を返却します.
+//-------------------------------------------------------------------------------------------------
+std::wstring FromUtf16( const u16* pBuffer, size_t count );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      ファイルを開きます.
+//!
+//! @param[in]      filename        ファイル名です.
+//! @param[in]      mode            オープンモードです(L"rb", L"wb" など).
+//! @return     ファイルポインタを返却します. 失敗した場合は nullptr を返却します.
+//! @note       Windows 以外ではファイル名を UTF-8 に変換して開きます.
+//-------------------------------------------------------------------------------------------------
+FILE* FileOpen( const char16* filename, const char16* mode );
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// MappedFile class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class MappedFile : NonCopyable
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    /* NOTHING */
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    /* NOTHING */
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    MappedFile();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //---------------------------------------------------------------------------------------------
+    ~MappedFile();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ファイルを読み取り専用でメモリにマッピングします.
+    //!
+    //! @param[in]      filename        ファイル名です.
+    //! @retval true    マッピングに成功.
+    //! @retval false   マッピングに失敗.
+    //---------------------------------------------------------------------------------------------
+    bool Open( const char16* filename );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      マッピングを解除します.
+    //---------------------------------------------------------------------------------------------
+    void Close();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      マッピングされたデータの先頭ポインタを取得します.
+    //!
+    //! @return     データの先頭ポインタを返却します. ページ境界にアライメントされています.
+    //---------------------------------------------------------------------------------------------
+    const u8* GetData() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ファイルサイズを取得します.
+    //!
+    //! @return     ファイルサイズ(バイト単位)を返却します.
+    //---------------------------------------------------------------------------------------------
+    u64 GetSize() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      マッピング済みかどうかチェックします.
+    //!
+    //! @retval true    マッピング済みです.
+    //! @retval false   マッピングされていません.
+    //---------------------------------------------------------------------------------------------
+    bool IsOpen() const;
+
+private:
+    //=============================================================================================
+    // private variables.
+    //=============================================================================================
+    const u8*   m_pData;        //!< マッピングされたデータです.
+    u64         m_Size;         //!< ファイルサイズです.
+    void*       m_hFile;        //!< ファイルハンドルです.
+    void*       m_hMapping;     //!< ファイルマッピングハンドルです.
+
+    //=============================================================================================
+    // private methods.
+    //=============================================================================================
+    /* NOTHING */
+};
+
+} // namespace asdx
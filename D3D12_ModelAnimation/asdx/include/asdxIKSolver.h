@@ -0,0 +1,230 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxIKSolver.h
+// Desc : CCD Inverse Kinematics Solver Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+#pragma once
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxMath.h>
+#include <vector>
+
+
+namespace asdx {
+
+//-------------------------------------------------------------------------------------------------
+// Forward Declarations.
+//-------------------------------------------------------------------------------------------------
+struct ResBone;
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// IKLink structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct IKLink
+{
+    u32         BoneIndex;      //!< ボーン番号です.
+    bool        IsHinge;        //!< ヒンジ軸で回転を制限するかどうか.
+    Vector3     HingeAxis;      //!< ヒンジ軸です(親ボーン基準).
+    f32         MinAngle;       //!< ヒンジ軸回りの最小角度(ラジアン)です.
+    f32         MaxAngle;       //!< ヒンジ軸回りの最大角度(ラジアン)です.
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// IKChain structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct IKChain
+{
+    u32                 GoalBone;       //!< 目標位置とするIKボーン番号です(PMD_IK::BoneIndex).
+    u32                 EffectorBone;   //!< 目標位置に近づけるボーン番号です(PMD_IK::TargetBoneIndex).
+    u32                 Iterations;     //!< 最大反復回数です(PMD_IK::RecursiveCount).
+    f32                 LimitAngle;     //!< 1回の回転で許容する最大角度(ラジアン)です(PMD_IK::ControlWeight の4倍).
+    std::vector<IKLink> Links;          //!< エフェクタ側から順に並んだ回転させるボーンです(ResPmdIK::ChildBoneIndices).
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// IKPose structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct IKPose
+{
+    Matrix*     pBoneTransforms;    //!< ボーン行列です(親ボーン基準の行列).
+    Matrix*     pWorldTransforms;   //!< ワールド行列です(ボーン行列から計算済みである必要があります).
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// IKStatistics structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct IKStatistics
+{
+    u32     SolveCount;         //!< 解いたチェーン数です.
+    u32     ConvergedCount;     //!< 許容誤差内に収束したチェーン数です.
+    u32     IterationCount;     //!< 実行した反復回数の合計です.
+    u32     RotationCount;      //!< 回転させたリンク数の合計です.
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    IKStatistics()
+    : SolveCount    ( 0 )
+    , ConvergedCount( 0 )
+    , IterationCount( 0 )
+    , RotationCount ( 0 )
+    { /* DO_NOTHING */ }
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// IKSolver class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class IKSolver
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    /* NOTHING */
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    /* NOTHING */
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    IKSolver();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //---------------------------------------------------------------------------------------------
+    ~IKSolver();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      初期化処理を行います.
+    //!
+    //! @param[in]      boneCount       ボーン数です.
+    //! @param[in]      pBones          ボーンデータです(親は子より前に並んでいる必要があります).
+    //! @param[in]      pChains         IKチェーンです. 指定順に解きます.
+    //! @param[in]      chainCount      IKチェーン数です.
+    //! @retval true    初期化に成功.
+    //! @retval false   初期化に失敗.
+    //! @note       リンクはエフェクタの祖先である必要があります.
+    //---------------------------------------------------------------------------------------------
+    bool Init( u32 boneCount, const ResBone* pBones, const IKChain* pChains, u32 chainCount );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      終了処理を行います.
+    //---------------------------------------------------------------------------------------------
+    void Term();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      収束とみなす距離を設定します.
+    //!
+    //! @param[in]      value       エフェクタと目標位置の距離の許容値です.
+    //---------------------------------------------------------------------------------------------
+    void SetTolerance( f32 value );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      収束とみなす距離を取得します.
+    //---------------------------------------------------------------------------------------------
+    f32 GetTolerance() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      初期化時に指定したボーン数を取得します.
+    //---------------------------------------------------------------------------------------------
+    u32 GetBoneCount() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      IKチェーン数を取得します.
+    //---------------------------------------------------------------------------------------------
+    u32 GetChainCount() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      IKを解きます.
+    //!
+    //! @param[in,out]  pBoneTransforms     ボーン行列です. リンクの回転が書き換えられます.
+    //! @param[in,out]  pWorldTransforms    ワールド行列です. IKの影響を受けるボーンが更新されます.
+    //! @param[in,out]  pStatistics         統計情報の加算先です. nullptr を指定できます.
+    //! @note       ソルバーの状態は変更しないため, 別々の姿勢であれば複数スレッドから同時に呼び出せます.
+    //---------------------------------------------------------------------------------------------
+    void Solve( Matrix* pBoneTransforms, Matrix* pWorldTransforms, IKStatistics* pStatistics = nullptr ) const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      同じボーン構成の複数のキャラクターのIKをまとめて解きます.
+    //!
+    //! @param[in,out]  pPoses      キャラクターごとの姿勢です.
+    //! @param[in]      count       キャラクター数です.
+    //! @param[in,out]  pStatistics 統計情報の加算先です. nullptr を指定できます.
+    //---------------------------------------------------------------------------------------------
+    void Solve( const IKPose* pPoses, u32 count, IKStatistics* pStatistics = nullptr ) const;
+
+private:
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    // Chain structure
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    struct Chain
+    {
+        u32     GoalBone;       //!< 目標位置とするボーン番号です.
+        u32     EffectorBone;   //!< エフェクタのボーン番号です.
+        u32     Iterations;     //!< 最大反復回数です.
+        f32     LimitAngle;     //!< 1回の回転で許容する最大角度です.
+        u32     LinkOffset;     //!< m_Links の先頭番号です.
+        u32     LinkCount;      //!< リンク数です.
+        u32     UpdateOffset;   //!< m_UpdateBones の先頭番号です.
+        u32     UpdateCount;    //!< チェーン解決後にワールド行列を更新するボーン数です.
+    };
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    // Link structure
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    struct Link
+    {
+        IKLink  Desc;           //!< リンクの設定です.
+        u32     PathOffset;     //!< m_PathBones の先頭番号です.
+        u32     PathCount;      //!< 回転後にワールド行列を更新するボーン数です(リンクからエフェクタまで).
+    };
+
+    //=============================================================================================
+    // private variables.
+    //=============================================================================================
+    const ResBone*      m_pBones;           //!< ボーンデータです.
+    u32                 m_BoneCount;        //!< ボーン数です.
+    std::vector<Chain>  m_Chains;           //!< IKチェーンです.
+    std::vector<Link>   m_Links;            //!< リンクです.
+    std::vector<u32>    m_PathBones;        //!< リンクからエフェクタまでのボーン番号です(親から順).
+    std::vector<u32>    m_UpdateBones;      //!< チェーンの影響を受けるボーン番号です(親から順).
+    f32                 m_Tolerance;        //!< 収束とみなす距離です.
+
+    //=============================================================================================
+    // private methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      チェーンを解きます.
+    //---------------------------------------------------------------------------------------------
+    void SolveChain( const Chain& chain, Matrix* pBoneTransforms, Matrix* pWorldTransforms, IKStatistics& statistics ) const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ワールド行列を更新します.
+    //---------------------------------------------------------------------------------------------
+    void UpdateWorld( const u32* pIndices, u32 count, const Matrix* pBoneTransforms, Matrix* pWorldTransforms ) const;
+};
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      ひざボーンのリンクにヒンジ制限を設定します.
+//!
+//! @param[in]      pBones      ボーンデータです.
+//! @param[in,out]  chain       設定するIKチェーンです.
+//! @return     設定したリンク数を返却します.
+//! @note       名前に "ひざ" を含むボーンを X軸回りに -180度 ～ -0.5度 の範囲に制限します(MMDと同じ制限です).
+//-------------------------------------------------------------------------------------------------
+u32 SetupKneeLinks( const ResBone* pBones, IKChain& chain );
+
+
+} // namespace asdx
@@ -0,0 +1,190 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxMeshOptimizer.h
+// Desc : Mesh Optimizer Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+#pragma once
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxMath.h>
+#include <vector>
+
+
+namespace asdx {
+
+//-------------------------------------------------------------------------------------------------
+// Forward Declarations.
+//-------------------------------------------------------------------------------------------------
+struct ResMesh;
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// VertexCacheStatistics structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct VertexCacheStatistics
+{
+    u32     Misses;     //!< キャッシュミス数(頂点シェーダ実行回数)です.
+    f32     ACMR;       //!< 三角形あたりの平均キャッシュミス数です(理想値 0.5 付近).
+    f32     ATVR;       //!< 参照頂点あたりの平均シェーダ実行回数です(理想値 1.0).
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// PackedSubset structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct PackedSubset
+{
+    u32     MaterialId;     //!< マテリアル番号です.
+    u32     Offset;         //!< インデックスバッファ先頭からのオフセットです.
+    u32     Count;          //!< 描画インデックス数です.
+    u32     BaseVertex;     //!< インデックスに加算する頂点番号です.
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// PackedIndices structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct PackedIndices
+{
+    bool                        Use16Bit;   //!< 16bit インデックスを使用する場合は true です.
+    std::vector<u16>            Indices16;  //!< 16bit インデックスです(Use16Bit が true の場合のみ有効).
+    std::vector<u32>            Indices32;  //!< 32bit インデックスです(Use16Bit が false の場合のみ有効).
+    std::vector<PackedSubset>   Subsets;    //!< サブセットです.
+    std::vector<u32>            Levels;     //!< 詳細度ごとの Subsets の開始番号です(先頭は元メッシュ, 末尾は Subsets の要素数).
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    PackedIndices()
+    : Use16Bit( false )
+    { /* DO_NOTHING */ }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      インデックスデータの先頭ポインタを取得します.
+    //---------------------------------------------------------------------------------------------
+    const void* GetData() const
+    {
+        if ( Use16Bit )
+        { return Indices16.empty() ? nullptr : &Indices16[0]; }
+
+        return Indices32.empty() ? nullptr : &Indices32[0];
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      インデックス1つあたりのバイト数を取得します.
+    //---------------------------------------------------------------------------------------------
+    u32 GetStride() const
+    { return Use16Bit ? sizeof(u16) : sizeof(u32); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      インデックスデータのバイト数を取得します.
+    //---------------------------------------------------------------------------------------------
+    u64 GetSize() const
+    { return u64( Use16Bit ? Indices16.size() : Indices32.size() ) * GetStride(); }
+};
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      FIFOキャッシュを模擬して頂点キャッシュ効率を求めます.
+//!
+//! @param[in]      pIndices        インデックスです.
+//! @param[in]      indexCount      インデックス数です.
+//! @param[in]      vertexCount     頂点数です.
+//! @param[in]      cacheSize       模擬するキャッシュサイズです.
+//! @return     頂点キャッシュ効率を返却します.
+//-------------------------------------------------------------------------------------------------
+VertexCacheStatistics AnalyzeVertexCache(
+    const u32*  pIndices,
+    u32         indexCount,
+    u32         vertexCount,
+    u32         cacheSize = 16 );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      頂点の再利用率が高くなるように三角形を並べ替えます(Forsyth法).
+//!
+//! @param[in,out]  pIndices        並べ替えるインデックスです.
+//! @param[in]      indexCount      インデックス数です.
+//! @param[in]      vertexCount     頂点数です.
+//-------------------------------------------------------------------------------------------------
+void OptimizeVertexCache( u32* pIndices, u32 indexCount, u32 vertexCount );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      視点に依存しないオーバードロー削減のために三角形のクラスタを並べ替えます.
+//!
+//! @param[in,out]  pIndices        並べ替えるインデックスです. OptimizeVertexCache() 適用済みである必要があります.
+//! @param[in]      indexCount      インデックス数です.
+//! @param[in]      pPositions      位置座標です.
+//! @param[in]      vertexCount     頂点数です.
+//! @param[in]      threshold       許容する ACMR の悪化率です(1.05 なら 5% まで).
+//-------------------------------------------------------------------------------------------------
+void OptimizeOverdraw(
+    u32*            pIndices,
+    u32             indexCount,
+    const Vector3*  pPositions,
+    u32             vertexCount,
+    f32             threshold = 1.05f );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      頂点を初出順に並べ替える再マップテーブルを生成します.
+//!
+//! @param[out]     pRemap          旧頂点番号から新頂点番号への変換テーブルです(vertexCount 個).
+//! @param[in]      pIndices        インデックスです.
+//! @param[in]      indexCount      インデックス数です.
+//! @param[in]      vertexCount     頂点数です.
+//! @return     参照されている頂点数を返却します. 参照されない頂点は末尾に元の順序で配置されます.
+//-------------------------------------------------------------------------------------------------
+u32 CreateVertexFetchRemap( u32* pRemap, const u32* pIndices, u32 indexCount, u32 vertexCount );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      サブセットごとに頂点キャッシュ最適化を行います.
+//!
+//! @param[in,out]  pMesh           最適化するメッシュです.
+//-------------------------------------------------------------------------------------------------
+void OptimizeVertexCache( ResMesh* pMesh );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      サブセットごとにオーバードロー最適化を行います.
+//!
+//! @param[in,out]  pMesh           最適化するメッシュです.
+//! @param[in]      threshold       許容する ACMR の悪化率です.
+//-------------------------------------------------------------------------------------------------
+void OptimizeOverdraw( ResMesh* pMesh, f32 threshold = 1.05f );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      頂点データを初出順に並べ替え, インデックスを更新します.
+//!
+//! @param[in,out]  pMesh           最適化するメッシュです.
+//! @note       構築済みの頂点ストリームは破棄されます.
+//-------------------------------------------------------------------------------------------------
+void OptimizeVertexFetch( ResMesh* pMesh );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      頂点キャッシュ, オーバードロー, 頂点フェッチの順に全ての最適化を行います.
+//!
+//! @param[in,out]  pMesh           最適化するメッシュです.
+//! @param[in]      threshold       オーバードロー最適化で許容する ACMR の悪化率です.
+//-------------------------------------------------------------------------------------------------
+void OptimizeMesh( ResMesh* pMesh, f32 threshold = 1.05f );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      全ての頂点属性が完全に一致する頂点を統合し, インデックスを更新します.
+//!
+//! @param[in,out]  pMesh           処理するメッシュです.
+//! @return     削除した頂点数を返却します.
+//! @note       要素数が頂点数と一致しない頂点属性は比較対象外となります.
+//!             頂点を統合した場合, 構築済みの頂点ストリームは破棄されます.
+//-------------------------------------------------------------------------------------------------
+u32 WeldVertices( ResMesh* pMesh );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      ベース頂点を用いてインデックスを可能な限り 16bit に詰めます.
+//!
+//! @param[in]      pMesh           処理するメッシュです.
+//! @param[out]     pResult         パックしたインデックスの格納先です.
+//! @note       参照範囲が 65536 頂点を超えるサブセットは三角形単位で分割します.
+//!             1つの三角形でも範囲を超える場合のみ 32bit インデックスを出力します.
+//!             詳細度を持つ場合は元メッシュの後ろに LodIndices を連結し, 詳細度 i のサブセットは
+//!             Subsets[Levels[i]] から Subsets[Levels[i + 1] - 1] となります.
+//-------------------------------------------------------------------------------------------------
+void PackIndices( const ResMesh* pMesh, PackedIndices* pResult );
+
+} // namespace asdx
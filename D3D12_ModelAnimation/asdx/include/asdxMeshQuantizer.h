@@ -0,0 +1,95 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxMeshQuantizer.h
+// Desc : Vertex Quantization Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+#pragma once
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxMath.h>
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// PositionQuantization structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct PositionQuantization
+{
+    Vector3     Scale;      //!< 復元時のスケールです(position = unorm * Scale + Offset).
+    Vector3     Offset;     //!< 復元時のオフセットです.
+};
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      バウンディングボックスから位置座標の量子化パラメータを求めます.
+//!
+//! @param[in]      pPositions      位置座標です.
+//! @param[in]      count           位置座標数です.
+//! @return     量子化パラメータを返却します.
+//-------------------------------------------------------------------------------------------------
+PositionQuantization ComputePositionQuantization( const Vector3* pPositions, u32 count );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      位置座標を 16bit unorm に量子化します.
+//!
+//! @param[in]      value           位置座標です.
+//! @param[in]      param           量子化パラメータです.
+//! @param[out]     pResult         量子化した値の格納先です(3要素).
+//-------------------------------------------------------------------------------------------------
+void QuantizePosition( const Vector3& value, const PositionQuantization& param, u16* pResult );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      量子化した位置座標を復元します.
+//!
+//! @param[in]      pValue          量子化した値です(3要素).
+//! @param[in]      param           量子化パラメータです.
+//! @return     復元した位置座標を返却します.
+//-------------------------------------------------------------------------------------------------
+Vector3 DequantizePosition( const u16* pValue, const PositionQuantization& param );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      単位ベクトルを 16bit snorm の八面体表現に変換します.
+//!
+//! @param[in]      value           単位ベクトルです.
+//! @param[out]     pResult         量子化した値の格納先です(2要素).
+//! @note       丸め方向の4通りから復元誤差が最小となるものを選択します.
+//-------------------------------------------------------------------------------------------------
+void EncodeOctahedral( const Vector3& value, s16* pResult );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      16bit snorm の八面体表現から単位ベクトルを復元します.
+//!
+//! @param[in]      pValue          量子化した値です(2要素).
+//! @return     復元した単位ベクトルを返却します.
+//-------------------------------------------------------------------------------------------------
+Vector3 DecodeOctahedral( const s16* pValue );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      単精度浮動小数を半精度浮動小数に変換します.
+//!
+//! @param[in]      value           変換する値です.
+//! @return     半精度浮動小数を返却します(最近接偶数丸め).
+//-------------------------------------------------------------------------------------------------
+f16 EncodeHalf( f32 value );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      半精度浮動小数を単精度浮動小数に変換します.
+//!
+//! @param[in]      value           変換する値です.
+//! @return     単精度浮動小数を返却します.
+//-------------------------------------------------------------------------------------------------
+f32 DecodeHalf( f16 value );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      ボーンの重みを 8bit unorm に量子化します.
+//!
+//! @param[in]      pWeights        ボーンの重みです.
+//! @param[in]      count           重みの数です(最大4).
+//! @param[out]     pResult         量子化した値の格納先です(count 要素).
+//! @note       量子化後の合計が元の合計の丸め値と一致するよう最大の重みで誤差を吸収します.
+//-------------------------------------------------------------------------------------------------
+void QuantizeBoneWeights( const f32* pWeights, u32 count, u8* pResult );
+
+} // namespace asdx
@@ -0,0 +1,72 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxMeshSimplifier.h
+// Desc : Mesh Simplifier Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+#pragma once
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxMath.h>
+
+
+namespace asdx {
+
+//-------------------------------------------------------------------------------------------------
+// Forward Declarations.
+//-------------------------------------------------------------------------------------------------
+struct ResMesh;
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SIMPLIFY_FLAG enum
+///////////////////////////////////////////////////////////////////////////////////////////////////
+enum SIMPLIFY_FLAG
+{
+    SIMPLIFY_FLAG_NONE          = 0x0,      //!< 指定なし.
+    SIMPLIFY_FLAG_LOCK_BORDER   = 0x1,      //!< 境界(開いたエッジ, サブセット境界)の頂点を固定します.
+};
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      二次誤差計量(QEM)による辺縮約でインデックスを削減します.
+//!
+//! @param[in]      pMesh               頂点属性を参照するメッシュです.
+//! @param[in]      pIndices            簡略化するインデックスです.
+//! @param[in]      pGroups             三角形ごとのグループ番号です(nullptr 可). 異なるグループ間の辺は境界として扱います.
+//! @param[in]      indexCount          インデックス数です.
+//! @param[in]      targetIndexCount    目標インデックス数です.
+//! @param[in]      targetError         許容する誤差(オブジェクト空間での距離)です.
+//! @param[in]      flags               SIMPLIFY_FLAG の組み合わせです.
+//! @param[out]     pResult             簡略化したインデックスの格納先です(indexCount 個以上).
+//! @param[out]     pResultGroups       簡略化した三角形ごとのグループ番号の格納先です(nullptr 可).
+//! @param[out]     pResultError        最終的な誤差の格納先です(nullptr 可).
+//! @return     簡略化後のインデックス数を返却します.
+//! @note       頂点は新たに生成せず既存の頂点へ縮約するため, 頂点バッファを全詳細度で共有できます.
+//!             UVシームや法線の分割により同じ位置に複数の頂点がある場合, その頂点は固定されます.
+//!             ボーンを持つメッシュでは最大重みのボーンが異なる頂点間の縮約は行いません.
+//-------------------------------------------------------------------------------------------------
+u32 SimplifyIndices(
+    const ResMesh*  pMesh,
+    const u32*      pIndices,
+    const u32*      pGroups,
+    u32             indexCount,
+    u32             targetIndexCount,
+    f32             targetError,
+    u32             flags,
+    u32*            pResult,
+    u32*            pResultGroups,
+    f32*            pResultError );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      目標誤差ごとに詳細度を生成し, メッシュに格納します.
+//!
+//! @param[in,out]  pMesh               詳細度を生成するメッシュです.
+//! @param[in]      pTargetErrors       詳細度ごとの目標誤差(バウンディング半径に対する比率)です. 昇順に並べてください.
+//! @param[in]      lodCount            生成する詳細度数です.
+//! @param[in]      flags               SIMPLIFY_FLAG の組み合わせです.
+//! @return     生成した詳細度数を返却します. 三角形数が減らない詳細度は生成されません.
+//-------------------------------------------------------------------------------------------------
+u32 GenerateMeshLods( ResMesh* pMesh, const f32* pTargetErrors, u32 lodCount, u32 flags );
+
+} // namespace asdx
@@ -0,0 +1,364 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxMotionBlender.h
+// Desc : Motion Blender Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+#pragma once
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxMath.h>
+#include <asdxResMotion.h>
+#include <vector>
+
+
+namespace asdx {
+
+//-------------------------------------------------------------------------------------------------
+// Forward Declarations.
+//-------------------------------------------------------------------------------------------------
+struct ResBone;
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// BLEND_MODE enum
+///////////////////////////////////////////////////////////////////////////////////////////////////
+enum BLEND_MODE
+{
+    BLEND_MODE_OVERRIDE = 0,    //!< 下位レイヤーの姿勢を重みに応じて上書きします.
+    BLEND_MODE_ADDITIVE,        //!< 先頭フレームからの差分を下位レイヤーの姿勢に加算します.
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// BonePose structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct BonePose
+{
+    Vector4     Translation;    //!< 平行移動量です(w成分は未使用).
+    Quaternion  Rotation;       //!< 回転量です.
+    Vector4     Scale;          //!< 拡大縮小量です(w成分は未使用).
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// MotionClip class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class MotionClip
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    friend class MotionBlender;
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    /* NOTHING */
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    MotionClip();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //---------------------------------------------------------------------------------------------
+    ~MotionClip();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      初期化処理を行います.
+    //!
+    //! @param[in]      motion      変換元のモーションデータです.
+    //! @note       キーフレームの変換行列を平行移動・回転・拡大縮小に分解して保持します.
+    //---------------------------------------------------------------------------------------------
+    void Init( const ResMotion& motion );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      終了処理を行います.
+    //---------------------------------------------------------------------------------------------
+    void Term();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      最大キーフレーム番号を取得します.
+    //---------------------------------------------------------------------------------------------
+    u32 GetDuration() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ボーン数を取得します.
+    //---------------------------------------------------------------------------------------------
+    u32 GetBoneCount() const;
+
+private:
+    //=============================================================================================
+    // private variables.
+    //=============================================================================================
+    u32                     m_Duration;     //!< 最大キーフレーム番号です.
+    std::vector<u32>        m_KeyOffsets;   //!< ボーンごとのキーフレーム開始位置です(ボーン数+1).
+    std::vector<u32>        m_KeyTimes;     //!< キーフレーム番号です.
+    std::vector<BonePose>   m_KeyPoses;     //!< キーフレームの姿勢です.
+
+    //=============================================================================================
+    // private methods.
+    //=============================================================================================
+    /* NOTHING */
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// MotionBlender class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class MotionBlender
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    /* NOTHING */
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    /* NOTHING */
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    MotionBlender();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //---------------------------------------------------------------------------------------------
+    ~MotionBlender();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ボーンを関連付けします.
+    //!
+    //! @param[in]      boneCount       ボーン数です.
+    //! @param[in]      pBones          ボーンデータへのポインタです.
+    //! @param[in]      layerCount      ブレンドレイヤーの最大数です.
+    //! @note       作業領域はここで全て確保され, Update()ではメモリ確保を行いません.
+    //---------------------------------------------------------------------------------------------
+    void Bind( u32 boneCount, const ResBone* pBones, u32 layerCount );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ボーンの関連付けを解除します.
+    //---------------------------------------------------------------------------------------------
+    void Unbind();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      レイヤーにモーションを設定します.
+    //!
+    //! @param[in]      layer       レイヤー番号です.
+    //! @param[in]      pClip       設定するモーションクリップです.
+    //! @param[in]      mode        ブレンドモードです.
+    //! @param[in]      weight      ブレンド重みです.
+    //! @param[in]      pBoneMask   ボーンごとの重み(ボーン数分)です. nullptrの場合は全ボーン1.0です.
+    //! @note       ボーンマスクは呼び出し側で保持してください.
+    //---------------------------------------------------------------------------------------------
+    void SetLayer(
+        u32                 layer,
+        const MotionClip*   pClip,
+        BLEND_MODE          mode,
+        f32                 weight,
+        const f32*          pBoneMask = nullptr );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      レイヤーを無効化します.
+    //!
+    //! @param[in]      layer       レイヤー番号です.
+    //---------------------------------------------------------------------------------------------
+    void ClearLayer( u32 layer );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      レイヤーのブレンド重みを指定時間かけて変化させます.
+    //!
+    //! @param[in]      layer       レイヤー番号です.
+    //! @param[in]      weight      目標とするブレンド重みです.
+    //! @param[in]      duration    変化にかける時間です. 0以下の場合は即座に反映します.
+    //! @note       重み0へのフェードアウトが完了したレイヤーは無効化されます.
+    //!             重み0で設定しただけのレイヤーは有効なままなので, 後からフェードインできます.
+    //---------------------------------------------------------------------------------------------
+    void FadeLayer( u32 layer, f32 weight, f32 duration );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ベースレイヤーのモーションをクロスフェードで切り替えます.
+    //!
+    //! @param[in]      pClip       切り替え先のモーションクリップです.
+    //! @param[in]      duration    クロスフェードにかける時間です.
+    //! @note       レイヤー0と1をクロスフェード用に使用します.
+    //!             前回のクロスフェード中に呼び出した場合は, その時点のブレンド結果を固定して
+    //!             そこから切り替え先へフェードします.
+    //---------------------------------------------------------------------------------------------
+    void CrossFade( const MotionClip* pClip, f32 duration );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      レイヤーのループ再生フラグを設定します.
+    //!
+    //! @param[in]      layer       レイヤー番号です.
+    //! @param[in]      isLoop      ループ再生する場合は true を指定.
+    //---------------------------------------------------------------------------------------------
+    void SetLoop( u32 layer, bool isLoop );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      レイヤーの再生速度を設定します.
+    //!
+    //! @param[in]      layer       レイヤー番号です.
+    //! @param[in]      speed       再生速度です. 負値の場合は逆再生します.
+    //---------------------------------------------------------------------------------------------
+    void SetSpeed( u32 layer, f32 speed );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      レイヤーの再生時間を設定します.
+    //!
+    //! @param[in]      layer       レイヤー番号です.
+    //! @param[in]      time        再生時間です.
+    //---------------------------------------------------------------------------------------------
+    void SetFrameTime( u32 layer, f32 time );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      レイヤーの再生時間を取得します.
+    //!
+    //! @param[in]      layer       レイヤー番号です.
+    //! @return     再生時間を返却します.
+    //---------------------------------------------------------------------------------------------
+    f32 GetFrameTime( u32 layer ) const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      レイヤーのブレンド重みを取得します.
+    //!
+    //! @param[in]      layer       レイヤー番号です.
+    //! @return     現在のブレンド重みを返却します.
+    //---------------------------------------------------------------------------------------------
+    f32 GetWeight( u32 layer ) const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      有効なレイヤー数を取得します.
+    //---------------------------------------------------------------------------------------------
+    u32 GetActiveLayerCount() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      更新処理を行います.
+    //!
+    //! @param[in]      elapsedTime     加算する経過時間(キーフレーム単位).
+    //---------------------------------------------------------------------------------------------
+    void Update( f32 elapsedTime );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      変換行列の数を取得します.
+    //!
+    //! @return     変換行列の数を返却します.
+    //---------------------------------------------------------------------------------------------
+    u32 GetTransformCount() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ブレンド後の姿勢を取得します.
+    //!
+    //! @return     ブレンド後の姿勢を返却します(親ボーン基準).
+    //---------------------------------------------------------------------------------------------
+    const BonePose* GetPoses() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ボーン行列を取得します.
+    //!
+    //! @return     ボーン行列を返却します.
+    //---------------------------------------------------------------------------------------------
+    const Matrix* GetBoneTransforms() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ワールド行列を取得します.
+    //!
+    //! @return     ワールド行列を返却します.
+    //---------------------------------------------------------------------------------------------
+    const Matrix* GetWorldTransforms() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      スキニング行列を取得します.
+    //!
+    //! @return     スキニング行列を返却します.
+    //---------------------------------------------------------------------------------------------
+    const Matrix* GetSkinTransforms() const;
+
+private:
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    // Layer structure
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    struct Layer
+    {
+        const MotionClip*   pClip;          //!< モーションクリップです.
+        const f32*          pBoneMask;      //!< ボーンマスクです.
+        BLEND_MODE          Mode;           //!< ブレンドモードです.
+        f32                 FrameTime;      //!< 現在時刻です.
+        f32                 Speed;          //!< 再生速度です.
+        f32                 Weight;         //!< ブレンド重みです.
+        f32                 TargetWeight;   //!< 目標ブレンド重みです.
+        f32                 FadeSpeed;      //!< 単位時間当たりの重みの変化量です.
+        bool                IsLoop;         //!< ループ再生フラグです.
+        bool                IsActive;       //!< 有効フラグです.
+        bool                IsFadeOut;      //!< フェードアウト中フラグです.
+        u32*                pCursors;       //!< ボーンごとのキーフレーム探索位置です.
+    };
+
+    //=============================================================================================
+    // private variables.
+    //=============================================================================================
+    u32                     m_BoneCount;        //!< ボーン数です.
+    const ResBone*          m_pBones;           //!< ボーンデータです.
+    std::vector<Layer>      m_Layers;           //!< ブレンドレイヤーです.
+    std::vector<u32>        m_Cursors;          //!< キーフレーム探索位置の作業領域です(レイヤー数×ボーン数).
+    std::vector<BonePose>   m_SamplePoses;      //!< サンプリング結果の作業領域です.
+    std::vector<BonePose>   m_Poses;            //!< ブレンド後の姿勢です.
+    std::vector<BonePose>   m_FrozenPoses;      //!< 中断したクロスフェードの姿勢です.
+    bool                    m_IsFrozen;         //!< レイヤー0が固定姿勢かどうか.
+    std::vector<Matrix>     m_BoneTransforms;   //!< ボーン行列です(親ボーン基準の行列).
+    std::vector<Matrix>     m_WorldTransforms;  //!< ワールド行列です(ワールド座標基準の行列).
+    std::vector<Matrix>     m_SkinTransforms;   //!< スキニング行列です(バインドポーズ基準の行列).
+
+    //=============================================================================================
+    // private methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      レイヤーの時間と重みを進めます.
+    //---------------------------------------------------------------------------------------------
+    void AdvanceLayer( Layer& layer, f32 elapsedTime );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      レイヤーのモーションをサンプリングします.
+    //---------------------------------------------------------------------------------------------
+    void SampleLayer( Layer& layer, BonePose* pResult );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      サンプリング結果を上書きモードでブレンドします.
+    //---------------------------------------------------------------------------------------------
+    void BlendOverride( const Layer& layer, const BonePose* pSample, BonePose* pResult );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      レイヤー0と1の現在のブレンド結果をレイヤー0の固定姿勢にします.
+    //---------------------------------------------------------------------------------------------
+    void FreezeBasePose();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ボーン行列を更新します.
+    //---------------------------------------------------------------------------------------------
+    void UpdateBoneTransforms();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ワールド行列を更新します.
+    //---------------------------------------------------------------------------------------------
+    void UpdateWorldTransforms();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      スキニング行列を更新します.
+    //---------------------------------------------------------------------------------------------
+    void UpdateSkinTransforms();
+};
+
+} // namespace asdx
@@ -0,0 +1,213 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxMotionDatabase.h
+// Desc : Motion Matching Database Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+#pragma once
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxMath.h>
+#include <asdxResMotion.h>
+#include <vector>
+
+
+namespace asdx {
+
+//-------------------------------------------------------------------------------------------------
+// Forward Declarations.
+//-------------------------------------------------------------------------------------------------
+struct ResBone;
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// MotionFeatureDesc structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct MotionFeatureDesc
+{
+    u32                 RootBone;           //!< キャラクター空間の基準とするボーン番号です.
+    std::vector<u32>    FeatureBones;       //!< 位置と速度を特徴量とするボーン番号です(足首や腰など).
+    std::vector<u32>    TrajectoryFrames;   //!< 将来軌道をサンプリングするフレーム数です(例 : 10, 20, 30).
+    f32                 PositionWeight;     //!< ボーン位置の重みです.
+    f32                 VelocityWeight;     //!< ボーン速度の重みです.
+    f32                 TrajectoryWeight;   //!< 将来軌道の重みです.
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    MotionFeatureDesc()
+    : RootBone          ( 0 )
+    , FeatureBones      ()
+    , TrajectoryFrames  ()
+    , PositionWeight    ( 1.0f )
+    , VelocityWeight    ( 1.0f )
+    , TrajectoryWeight  ( 1.0f )
+    { /* DO_NOTHING */ }
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// MotionMatchResult structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct MotionMatchResult
+{
+    u32     MotionId;       //!< モーション番号です.
+    u32     Frame;          //!< フレーム番号です.
+    f32     Cost;           //!< 特徴量の二乗距離です.
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// MotionDatabase class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class MotionDatabase
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    /* NOTHING */
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    /* NOTHING */
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    MotionDatabase();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //---------------------------------------------------------------------------------------------
+    ~MotionDatabase();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      初期化処理を行います.
+    //!
+    //! @param[in]      desc        特徴量の設定です.
+    //! @param[in]      boneCount   ボーン数です.
+    //! @param[in]      pBones      ボーンデータです.
+    //! @retval true    初期化に成功.
+    //! @retval false   初期化に失敗.
+    //---------------------------------------------------------------------------------------------
+    bool Init( const MotionFeatureDesc& desc, u32 boneCount, const ResBone* pBones );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      終了処理を行います.
+    //---------------------------------------------------------------------------------------------
+    void Term();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      モーションを追加し, 全フレームの特徴量を抽出します.
+    //!
+    //! @param[in]      motion      追加するモーションです.
+    //! @return     追加したモーションのモーション番号を返却します.
+    //! @note       追加後は Build() を呼び出すまで検索できません.
+    //---------------------------------------------------------------------------------------------
+    u32 AddMotion( const ResMotion& motion );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      特徴量を正規化し, 検索用の木構造を構築します.
+    //---------------------------------------------------------------------------------------------
+    void Build();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      検索クエリを生成します.
+    //!
+    //! @param[in]      pWorldTransforms        現在のワールド行列です.
+    //! @param[in]      pPrevWorldTransforms    1フレーム前のワールド行列です.
+    //! @param[in]      pTrajectoryPositions    将来軌道の位置(ワールド空間)です. TrajectoryFrames と同数必要です.
+    //! @param[in]      pTrajectoryDirections   将来軌道の向き(ワールド空間)です. TrajectoryFrames と同数必要です.
+    //! @param[out]     pResult                 GetFeatureStride() 個の要素を持つクエリの格納先です.
+    //! @note       Build() 前に呼び出した場合は全要素が0のクエリを出力します.
+    //---------------------------------------------------------------------------------------------
+    void CreateQuery(
+        const Matrix*   pWorldTransforms,
+        const Matrix*   pPrevWorldTransforms,
+        const Vector3*  pTrajectoryPositions,
+        const Vector3*  pTrajectoryDirections,
+        f32*            pResult ) const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      最も近い姿勢を検索します.
+    //!
+    //! @param[in]      pQuery      CreateQuery() で生成したクエリです.
+    //! @param[out]     result      検索結果です.
+    //! @retval true    検索に成功.
+    //! @retval false   検索に失敗.
+    //---------------------------------------------------------------------------------------------
+    bool Search( const f32* pQuery, MotionMatchResult& result ) const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      特徴量の次元数を取得します.
+    //---------------------------------------------------------------------------------------------
+    u32 GetFeatureDimension() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      特徴量1つあたりの要素数(SIMD用に4の倍数に切り上げた数)を取得します.
+    //---------------------------------------------------------------------------------------------
+    u32 GetFeatureStride() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      登録されているフレーム数を取得します.
+    //---------------------------------------------------------------------------------------------
+    u32 GetEntryCount() const;
+
+private:
+    //=============================================================================================
+    // private variables.
+    //=============================================================================================
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    // Entry structure
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    struct Entry
+    {
+        u32     MotionId;       //!< モーション番号です.
+        u32     Frame;          //!< フレーム番号です.
+    };
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    // Node structure
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    struct Node
+    {
+        u32     Axis;           //!< 分割軸です. 葉の場合は U32_MAX.
+        f32     Split;          //!< 分割位置です.
+        u32     Child;          //!< 左の子ノード番号(葉の場合は先頭エントリ番号)です.
+        u32     Count;          //!< 右の子ノード番号(葉の場合はエントリ数)です.
+    };
+
+    MotionFeatureDesc       m_Desc;         //!< 特徴量の設定です.
+    u32                     m_BoneCount;    //!< ボーン数です.
+    const ResBone*          m_pBones;       //!< ボーンデータです.
+    u32                     m_MotionCount;  //!< 登録モーション数です.
+    u32                     m_Dimension;    //!< 特徴量の次元数です.
+    u32                     m_Stride;       //!< 特徴量1つあたりの要素数です.
+    std::vector<f32>        m_Features;     //!< 特徴量です(Build() 後は正規化済みで木の葉の順に並ぶ).
+    std::vector<Entry>      m_Entries;      //!< 特徴量に対応するフレームです.
+    std::vector<f32>        m_Offset;       //!< 正規化用のオフセット(平均値)です.
+    std::vector<f32>        m_Scale;        //!< 正規化用のスケール(重み / 標準偏差)です.
+    std::vector<Node>       m_Nodes;        //!< 木構造のノードです.
+
+    //=============================================================================================
+    // private methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ノードを構築します.
+    //---------------------------------------------------------------------------------------------
+    u32 BuildNode( std::vector<u32>& indices, u32 begin, u32 end );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ノードを探索します.
+    //---------------------------------------------------------------------------------------------
+    void SearchNode( u32 index, const f32* pQuery, f32& bestCost, u32& bestEntry ) const;
+};
+
+} // namespace asdx
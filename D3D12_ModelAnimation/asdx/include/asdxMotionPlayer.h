@@ -10,6 +10,7 @@
 //-------------------------------------------------------------------------------------------------
 #include <asdxMath.h>
 #include <asdxResMotion.h>
+#include <asdxIKSolver.h>
 #include <vector>
 #include <map>
 
@@ -22,6 +23,19 @@ namespace asdx {
 struct ResBone;
 
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// MOTION_LOD enum
+///////////////////////////////////////////////////////////////////////////////////////////////////
+enum MOTION_LOD
+{
+    MOTION_LOD_FULL = 0,        //!< 毎フレーム更新します.
+    MOTION_LOD_HALF,            //!< 2フレームに1回更新します.
+    MOTION_LOD_QUARTER,         //!< 4フレームに1回更新します.
+    MOTION_LOD_EIGHTH,          //!< 8フレームに1回更新します.
+    MOTION_LOD_COUNT,
+};
+
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 // MotionPlayer class
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -87,6 +101,49 @@ public:
     //---------------------------------------------------------------------------------------------
     bool IsLoop() const;
 
+    //---------------------------------------------------------------------------------------------
+    //! @brief      モーションLODを設定します.
+    //!
+    //! @param[in]      lod         モーションLODです.
+    //! @note       間引いたフレームは前後のサンプリング結果を補間した姿勢になります.
+    //!             変更直後のフレームでサンプリングし, 次の担当フレームまで補間して位相を揃えます.
+    //---------------------------------------------------------------------------------------------
+    void SetLod( MOTION_LOD lod );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      モーションLODを取得します.
+    //---------------------------------------------------------------------------------------------
+    MOTION_LOD GetLod() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      更新フレームのずらし量を設定します.
+    //!
+    //! @param[in]      phase       ずらし量です. インスタンス番号などを指定すると更新負荷が分散されます.
+    //---------------------------------------------------------------------------------------------
+    void SetUpdatePhase( u32 phase );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ボーンマスクを設定します.
+    //!
+    //! @param[in]      pMask       ボーン数分のマスクです. 0 のボーンはサンプリングされず直前の姿勢を保持します.
+    //!                             nullptr を指定すると全ボーンを更新します.
+    //! @note       設定後の最初の更新ではマスクに関わらず全ボーンをサンプリングします.
+    //!             マスクの内容を書き換えた場合も再度設定してください.
+    //---------------------------------------------------------------------------------------------
+    void SetBoneMask( const u8* pMask );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      IKソルバーを設定します.
+    //!
+    //! @param[in]      pSolver     IKソルバーです. nullptr を指定するとIKを解きません.
+    //! @retval true    設定に成功.
+    //! @retval false   関連付け済みのボーン数とソルバーのボーン数が異なるため設定しませんでした.
+    //! @note       サンプリングした姿勢は保持したまま, IKを適用した結果を別のバッファに出力します.
+    //!             ソルバーは変更されないため, 複数のプレイヤーで共有できます.
+    //!             Bind() 前に設定した場合は Bind() でボーン数を検証し, 異なる場合は設定を解除します.
+    //---------------------------------------------------------------------------------------------
+    bool SetIKSolver( const IKSolver* pSolver );
+
     //---------------------------------------------------------------------------------------------
     //! @brief      更新処理を行います.
     //!
@@ -127,6 +184,13 @@ public:
     //---------------------------------------------------------------------------------------------
     const Matrix* GetSkinTransforms() const;
 
+    //---------------------------------------------------------------------------------------------
+    //! @brief      直前の更新でのIKの統計情報を取得します.
+    //!
+    //! @return     IKの統計情報を返却します.
+    //---------------------------------------------------------------------------------------------
+    const IKStatistics& GetIKStatistics() const;
+
 private:
     //=============================================================================================
     // private variables.
@@ -135,10 +199,22 @@ private:
     u32                 m_BoneCount;            //!< ボーン数です.
     const ResBone*      m_pBones;               //!< ボーンデータです.
     const ResMotion*    m_pMotion;              //!< モーションです.
+    const u8*           m_pBoneMask;            //!< ボーンマスクです.
+    MOTION_LOD          m_Lod;                  //!< モーションLODです.
+    u32                 m_UpdatePhase;          //!< 更新フレームのずらし量です.
+    u32                 m_FrameCount;           //!< 更新回数です.
+    u32                 m_LodStep;              //!< 前回のサンプリングからの経過フレーム数です.
+    u32                 m_LodSpan;              //!< 前回のサンプリングから次のサンプリングまでのフレーム数です.
+    bool                m_IsDirty;              //!< 次の更新で全ボーンをサンプリングするかどうか.
     std::vector<Matrix> m_BoneTransforms;       //!< ボーン行列です(親ボーン基準の行列).
+    std::vector<Matrix> m_PrevTransforms;       //!< 補間元のボーン行列です.
+    std::vector<Matrix> m_NextTransforms;       //!< 補間先のボーン行列です.
     std::vector<Matrix> m_WorldTransforms;      //!< ワールド行列です(ワールド座標基準の行列).
     std::vector<Matrix> m_SkinTransforms;       //!< スキニング行列です(バインドポーズ基準の行列).
     bool                m_IsLoop;               //!< ループ再生フラグです.
+    const IKSolver*     m_pIKSolver;            //!< IKソルバーです.
+    std::vector<Matrix> m_IKTransforms;         //!< IKを適用したボーン行列です.
+    IKStatistics        m_IKStatistics;         //!< 直前の更新でのIKの統計情報です.
 
     //=============================================================================================
     // private methods.
@@ -153,21 +229,67 @@ private:
     //---------------------------------------------------------------------------------------------
     Matrix CalcBoneMatrix( f32 time, const ResKeyFrameSet& bone ) const;
 
+    //---------------------------------------------------------------------------------------------
+    //! @brief      指定された時間のボーン行列をサンプリングします.
+    //!
+    //! @param[in]          time        フレーム時間.
+    //! @param[out]         pResult     ボーン行列の格納先です.
+    //---------------------------------------------------------------------------------------------
+    void SampleBoneTransforms( f32 time, Matrix* pResult ) const;
+
     //---------------------------------------------------------------------------------------------
     //! @brief      ボーン行列を更新します.
+    //!
+    //! @param[in]          elapsedTime     経過時間です.
     //---------------------------------------------------------------------------------------------
-    void UpdateBoneTransforms();
+    void UpdateBoneTransforms( f32 elapsedTime );
 
     //---------------------------------------------------------------------------------------------
     //! @brief      ワールド行列を更新します.
     //---------------------------------------------------------------------------------------------
     void UpdateWorldTransforms();
 
+    //---------------------------------------------------------------------------------------------
+    //! @brief      IKを適用します.
+    //---------------------------------------------------------------------------------------------
+    void UpdateIKTransforms();
+
     //---------------------------------------------------------------------------------------------
     //! @brief      スキニング行列を更新します.
     //---------------------------------------------------------------------------------------------
     void UpdateSkinTransforms();
 };
 
+//-------------------------------------------------------------------------------------------------
+//! @brief      画面上の大きさからモーションLODを選択します.
+//!
+//! @param[in]      radius      バウンディングスフィアの半径です.
+//! @param[in]      distance    カメラからの距離です.
+//! @param[in]      fovY        垂直画角(ラジアン)です.
+//! @return     選択したモーションLODを返却します.
+//-------------------------------------------------------------------------------------------------
+MOTION_LOD SelectMotionLod( f32 radius, f32 distance, f32 fovY );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      指定したボーン以下を除外した簡略化ボーンマスクを生成します.
+//!
+//! @param[in]      boneCount   ボーン数です.
+//! @param[in]      pBones      ボーンデータです(親は子より前に並んでいる必要があります).
+//! @param[in]      pDropNames  除外する部分木の根となるボーン名です(指の付け根, 目, 舌など).
+//! @param[in]      dropCount   除外するボーン名の数です.
+//! @param[in]      pKeepNames  除外範囲に含まれていても更新するボーン名です(IKターゲットなど). nullptr を指定できます.
+//! @param[in]      keepCount   更新するボーン名の数です.
+//! @param[out]     result      ボーンマスクの格納先です.
+//! @note       頭やつま先などの末端ボーンは指定しない限り除外されません.
+//-------------------------------------------------------------------------------------------------
+void CreateReducedBoneMask(
+    u32                     boneCount,
+    const ResBone*          pBones,
+    const char16* const*    pDropNames,
+    u32                     dropCount,
+    const char16* const*    pKeepNames,
+    u32                     keepCount,
+    std::vector<u8>&        result );
+
 
 } // namespace asdx
@@ -0,0 +1,255 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxRenderQueue.h
+// Desc : Render Queue Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+#pragma once
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <d3d12.h>
+#include <vector>
+#include <asdxTypedef.h>
+
+
+namespace asdx {
+
+//-------------------------------------------------------------------------------------------------
+// Constant Values.
+//-------------------------------------------------------------------------------------------------
+static constexpr u32 RENDER_KEY_PASS_BITS       = 4;    //!< パス番号のビット数です.
+static constexpr u32 RENDER_KEY_PIPELINE_BITS   = 16;   //!< パイプライン番号のビット数です.
+static constexpr u32 RENDER_KEY_MATERIAL_BITS   = 20;   //!< マテリアル番号のビット数です.
+static constexpr u32 RENDER_KEY_DEPTH_BITS      = 23;   //!< 深度バケットのビット数です.
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// RENDER_BIND_FLAG enum
+///////////////////////////////////////////////////////////////////////////////////////////////////
+enum RENDER_BIND_FLAG
+{
+    RENDER_BIND_FLAG_NONE       = 0x0,      //!< 直前と同じステートです.
+    RENDER_BIND_FLAG_PIPELINE   = 0x1,      //!< パイプラインステートの設定が必要です.
+    RENDER_BIND_FLAG_MATERIAL   = 0x2,      //!< マテリアルのディスクリプタテーブルの設定が必要です.
+    RENDER_BIND_FLAG_GEOMETRY   = 0x4,      //!< 頂点バッファ・インデックスバッファの設定が必要です.
+    RENDER_BIND_FLAG_ALL        = 0x7,
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// RenderItem structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct RenderItem
+{
+    u32     PipelineId;         //!< パイプラインステート番号です.
+    u32     MaterialId;         //!< マテリアル番号です.
+    u32     GeometryId;         //!< 頂点バッファ・インデックスバッファ番号です.
+    u32     IndexCount;         //!< 描画インデックス数です.
+    u32     StartIndex;         //!< インデックスバッファ先頭からのオフセットです.
+    s32     BaseVertex;         //!< インデックスに加算する頂点番号です.
+    u32     InstanceCount;      //!< インスタンス数です.
+    u32     StartInstance;      //!< 開始インスタンス番号です.
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// RenderStateTable structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct RenderStateTable
+{
+    ID3D12PipelineState* const*         ppPipelineStates;       //!< PipelineId で参照するパイプラインステートです(nullptr の場合は設定しません).
+    const D3D12_GPU_DESCRIPTOR_HANDLE*  pMaterialTables;        //!< MaterialId * MaterialTableCount + i で参照するディスクリプタテーブルです(nullptr の場合は設定しません).
+    u32                                 MaterialTableCount;     //!< マテリアルあたりのディスクリプタテーブル数です.
+    u32                                 MaterialRootIndex;      //!< 先頭のディスクリプタテーブルを設定するルートパラメータ番号です.
+    const D3D12_VERTEX_BUFFER_VIEW*     pVertexBufferViews;     //!< GeometryId で参照する頂点バッファビューです(nullptr の場合は設定しません).
+    const D3D12_INDEX_BUFFER_VIEW*      pIndexBufferViews;      //!< GeometryId で参照するインデックスバッファビューです(nullptr の場合は設定しません).
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// RenderQueueStatistics structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct RenderQueueStatistics
+{
+    u32     DrawCount;          //!< 描画数です.
+    u32     PipelineBinds;      //!< パイプラインステートの設定回数です.
+    u32     MaterialBinds;      //!< マテリアルの設定回数です.
+    u32     GeometryBinds;      //!< 頂点バッファ・インデックスバッファの設定回数です.
+    f64     SortTime;           //!< ソートにかかった時間(ミリ秒)です.
+    f64     DedupeTime;         //!< 冗長なステート設定の除去にかかった時間(ミリ秒)です.
+};
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      ソートキーを生成します.
+//!
+//! @param[in]      pass            パス番号です(上位ほど先に描画されます).
+//! @param[in]      translucent     半透明の場合は true を指定します.
+//! @param[in]      pipelineId      パイプラインステート番号です.
+//! @param[in]      materialId      マテリアル番号です.
+//! @param[in]      depth           [0, 1] に正規化したビュー空間の深度です.
+//! @return     ソートキーを返却します.
+//! @note       不透明は パス | 0 | パイプライン | マテリアル | 深度(手前から奥) の順,
+//!             半透明は パス | 1 | 深度(奥から手前) | パイプライン | マテリアル の順にビットを詰めます.
+//!             ビット数を超える番号は下位ビットのみ使用します.
+//-------------------------------------------------------------------------------------------------
+u64 MakeRenderKey( u32 pass, bool translucent, u32 pipelineId, u32 materialId, f32 depth );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      ソートキーからパス番号を取得します.
+//-------------------------------------------------------------------------------------------------
+u32 GetRenderKeyPass( u64 key );
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// RenderQueue class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class RenderQueue
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    /* NOTHING */
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    static constexpr u32 kParallelThreshold = 32768;    //!< 並列ソートを行う最小の描画数です.
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    RenderQueue();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //---------------------------------------------------------------------------------------------
+    ~RenderQueue();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      メモリを予約します.
+    //!
+    //! @param[in]      count       予約する描画数です.
+    //---------------------------------------------------------------------------------------------
+    void Reserve( u32 count );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ソートに使用するスレッド数を設定します.
+    //!
+    //! @param[in]      count       スレッド数です(0 の場合はハードウェアスレッド数).
+    //---------------------------------------------------------------------------------------------
+    void SetThreadCount( u32 count );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      キューを空にします(メモリは解放しません).
+    //---------------------------------------------------------------------------------------------
+    void Clear();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      描画を追加します.
+    //!
+    //! @param[in]      key         MakeRenderKey() で生成したソートキーです.
+    //! @param[in]      item        描画データです.
+    //---------------------------------------------------------------------------------------------
+    void Push( u64 key, const RenderItem& item );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ソートキーの昇順に並べ, 直前と同じステートの設定を除去します.
+    //!
+    //! @note       8bit ずつの LSD 基数ソートです. 全要素で同じ値となる桁は処理しません.
+    //!             kParallelThreshold 以上の場合はブロックごとに並列でヒストグラムを作成し, 散布します.
+    //!             同じキーの描画は追加した順番を保ちます.
+    //---------------------------------------------------------------------------------------------
+    void Sort();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      指定パスの範囲を検索します.
+    //!
+    //! @param[in]      pass        パス番号です.
+    //! @param[out]     pBegin      先頭の番号の格納先です.
+    //! @param[out]     pEnd        終端の番号の格納先です.
+    //! @return     描画数を返却します.
+    //! @note       Sort() の後に呼び出してください.
+    //---------------------------------------------------------------------------------------------
+    u32 FindPassRange( u32 pass, u32* pBegin, u32* pEnd ) const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      描画コマンドを発行します.
+    //!
+    //! @param[in]      pCmd        コマンドリストです.
+    //! @param[in]      table       番号からステートを参照するテーブルです.
+    //! @param[in]      begin       先頭の番号です.
+    //! @param[in]      end         終端の番号です.
+    //! @note       Sort() の後に呼び出してください. 先頭の描画では全てのステートを設定します.
+    //---------------------------------------------------------------------------------------------
+    void Execute(
+        ID3D12GraphicsCommandList*  pCmd,
+        const RenderStateTable&     table,
+        u32                         begin = 0,
+        u32                         end   = U32_MAX ) const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      描画数を取得します.
+    //---------------------------------------------------------------------------------------------
+    u32 GetCount() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ソート後の描画データを取得します.
+    //---------------------------------------------------------------------------------------------
+    const RenderItem& GetItem( u32 index ) const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ソート後のソートキーを取得します.
+    //---------------------------------------------------------------------------------------------
+    u64 GetKey( u32 index ) const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ソート後の描画で必要なステート設定(RENDER_BIND_FLAG の組み合わせ)を取得します.
+    //---------------------------------------------------------------------------------------------
+    u32 GetBindFlags( u32 index ) const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      直前の Sort() の統計情報を取得します.
+    //---------------------------------------------------------------------------------------------
+    const RenderQueueStatistics& GetStatistics() const;
+
+private:
+    //=============================================================================================
+    // private variables.
+    //=============================================================================================
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    // Entry structure
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    struct Entry
+    {
+        u64     Key;            //!< ソートキーです.
+        u32     Index;          //!< 描画データの番号です.
+        u32     BindFlags;      //!< 必要なステート設定です.
+    };
+
+    std::vector<RenderItem>     m_Items;        //!< 追加した順の描画データです.
+    std::vector<Entry>          m_Entries;      //!< ソート済みのエントリです.
+    std::vector<Entry>          m_Temp;         //!< ソート用の作業領域です.
+    std::vector<u32>            m_Histograms;   //!< スレッドごとのヒストグラムです.
+    u32                         m_ThreadCount;  //!< ソートに使用するスレッド数です.
+    RenderQueueStatistics       m_Statistics;   //!< 統計情報です.
+
+    //=============================================================================================
+    // private methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      基数ソートを行います.
+    //---------------------------------------------------------------------------------------------
+    void RadixSort( u32 threadCount );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      冗長なステート設定を除去します.
+    //---------------------------------------------------------------------------------------------
+    void Dedupe();
+};
+
+} // namespace asdx
@@ -15,6 +15,12 @@
 
 namespace asdx {
 
+//-------------------------------------------------------------------------------------------------
+// Forward Declarations.
+//-------------------------------------------------------------------------------------------------
+class MappedFile;
+
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 // ResBone structure
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -36,6 +42,80 @@ struct ResSubset
     u32     Count;          //!< 描画インデックス数.
 };
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ResLod structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct ResLod
+{
+    f32     Error;          //!< 元メッシュに対する誤差(オブジェクト空間での距離)です.
+    u32     SubsetOffset;   //!< LodSubsets 先頭からのオフセットです.
+    u32     SubsetCount;    //!< サブセット数です.
+    u32     Reserved;       //!< 予約領域です.
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// VERTEX_ATTRIBUTE enum
+///////////////////////////////////////////////////////////////////////////////////////////////////
+enum VERTEX_ATTRIBUTE
+{
+    VERTEX_ATTRIBUTE_POSITION = 0,      //!< 位置座標です.
+    VERTEX_ATTRIBUTE_NORMAL,            //!< 法線ベクトルです.
+    VERTEX_ATTRIBUTE_TEXCOORD,          //!< テクスチャ座標です.
+    VERTEX_ATTRIBUTE_BONE_INDEX,        //!< ボーン番号です.
+    VERTEX_ATTRIBUTE_BONE_WEIGHT,       //!< ボーン重みです.
+    VERTEX_ATTRIBUTE_COUNT,
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// VERTEX_PASS enum
+///////////////////////////////////////////////////////////////////////////////////////////////////
+enum VERTEX_PASS
+{
+    VERTEX_PASS_DEPTH = 0,              //!< 深度プリパスです(位置座標のみ).
+    VERTEX_PASS_SHADOW,                 //!< シャドウパスです(位置座標のみ).
+    VERTEX_PASS_ALPHA_TEST,             //!< 抜きありの深度・シャドウパスです(位置座標 + テクスチャ座標).
+    VERTEX_PASS_FORWARD,                //!< 通常描画パスです(全属性).
+    VERTEX_PASS_COUNT,
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ResVertexElement structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct ResVertexElement
+{
+    u32     Attribute;      //!< 頂点属性(VERTEX_ATTRIBUTE)です.
+    u32     Format;         //!< フォーマット(DXGI_FORMAT の値)です.
+    u32     Stream;         //!< 格納先のストリーム番号です.
+    u32     Offset;         //!< ストリームの要素先頭からのオフセットです.
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ResVertexStream structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct ResVertexStream
+{
+    u32     Stride;         //!< 1頂点あたりのバイト数です.
+    u32     PassMask;       //!< このストリームを使用するパス(1 << VERTEX_PASS)の組み合わせです.
+    u32     Offset;         //!< VertexStreams 先頭からのオフセットです(16バイト境界).
+    u32     Size;           //!< データサイズです.
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ResVertexLayout structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct ResVertexLayout
+{
+    u32                 VertexCount;                            //!< 頂点数です.
+    u32                 ElementCount;                           //!< 頂点要素数です.
+    u32                 StreamCount;                            //!< ストリーム数です(0 の場合は未構築).
+    u32                 Flags;                                  //!< 構築時のフラグです.
+    ResVertexElement    Elements[VERTEX_ATTRIBUTE_COUNT];       //!< 頂点要素です.
+    ResVertexStream     Streams [VERTEX_ATTRIBUTE_COUNT];       //!< ストリームです.
+    Vector3             QuantizeScale;                          //!< 位置座標の復元スケールです(position = unorm * QuantizeScale + QuantizeOffset).
+    Vector3             QuantizeOffset;                         //!< 位置座標の復元オフセットです.
+    u32                 Reserved[2];                            //!< 予約領域です.
+};
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 // ResMesh structure
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -49,6 +129,80 @@ struct ResMesh
     std::vector<u32>        VertexIndices;  //!< 頂点インデックスです.
     std::vector<ResSubset>  Subsets;        //!< サブセットデータです.
     std::vector<ResBone>    Bones;          //!< ボーン.
+    std::vector<ResLod>     Lods;           //!< 詳細度です(詳細なものから順に格納. 元メッシュは含みません).
+    std::vector<u32>        LodIndices;     //!< 詳細度ごとの頂点インデックスです.
+    std::vector<ResSubset>  LodSubsets;     //!< 詳細度ごとのサブセットです(Offset は LodIndices 先頭からのオフセット).
+    ResVertexLayout         VertexLayout;   //!< 頂点ストリームのレイアウトです(StreamCount が 0 の場合は未構築).
+    std::vector<u8>         VertexStreams;  //!< レイアウトに従って格納した頂点ストリームです.
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    ResMesh()
+    : VertexLayout()
+    { /* DO_NOTHING */ }
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ResSpan structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename T>
+struct ResSpan
+{
+    const T*    pData;      //!< 先頭要素へのポインタです.
+    u32         Count;      //!< 要素数です.
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    ResSpan()
+    : pData( nullptr )
+    , Count( 0 )
+    { /* DO_NOTHING */ }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      要素を取得します.
+    //---------------------------------------------------------------------------------------------
+    const T& operator[] ( u32 index ) const
+    { return pData[index]; }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      先頭要素へのポインタを取得します.
+    //---------------------------------------------------------------------------------------------
+    const T* begin() const
+    { return pData; }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      終端要素の次へのポインタを取得します.
+    //---------------------------------------------------------------------------------------------
+    const T* end() const
+    { return pData + Count; }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      要素が空かどうかチェックします.
+    //---------------------------------------------------------------------------------------------
+    bool empty() const
+    { return Count == 0; }
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ResMeshView structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct ResMeshView
+{
+    ResSpan<Vector3>        Positions;      //!< 位置座標です.
+    ResSpan<Vector3>        Normals;        //!< 法線ベクトル.
+    ResSpan<Vector2>        TexCoords;      //!< テクスチャ座標.
+    ResSpan<uint4>          BoneIndices;    //!< ボーン番号.
+    ResSpan<Vector4>        BoneWeights;    //!< ボーン重み.
+    ResSpan<u32>            VertexIndices;  //!< 頂点インデックスです.
+    ResSpan<ResSubset>      Subsets;        //!< サブセットデータです.
+    std::vector<ResBone>    Bones;          //!< ボーン(要素数が少ないためコピーして保持します).
+    ResSpan<ResLod>         Lods;           //!< 詳細度です.
+    ResSpan<u32>            LodIndices;     //!< 詳細度ごとの頂点インデックスです.
+    ResSpan<ResSubset>      LodSubsets;     //!< 詳細度ごとのサブセットです.
+    ResSpan<ResVertexLayout> VertexLayout;  //!< 頂点ストリームのレイアウトです(0 または 1 要素).
+    ResSpan<u8>             VertexStreams;  //!< 頂点ストリームです.
 };
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -81,6 +235,17 @@ public:
     //---------------------------------------------------------------------------------------------
     static bool Create( const char16* filename, ResMesh* pResult );
 
+    //---------------------------------------------------------------------------------------------
+    //! @brief      メッシュファイルをメモリにマッピングし, コピーせずに参照します.
+    //!
+    //! @param[in]      filename        メッシュファイル名です.
+    //! @param[out]     pFile           マッピングしたファイルの格納先です. 参照中は破棄しないでください.
+    //! @param[out]     pResult         メッシュビューの格納先です.
+    //! @retval true    マッピングに成功.
+    //! @retval false   マッピングに失敗.
+    //---------------------------------------------------------------------------------------------
+    static bool Map( const char16* filename, MappedFile* pFile, ResMeshView* pResult );
+
     //---------------------------------------------------------------------------------------------
     //! @brief      メッシュリソースを破棄します.
     //!
@@ -89,4 +254,25 @@ public:
     static void Dispose( ResMesh*& ptr );
 };
 
+//-------------------------------------------------------------------------------------------------
+//! @brief      画面上の誤差が閾値以下となる最も粗い詳細度を選択します.
+//!
+//! @param[in]      pLods           詳細度です.
+//! @param[in]      lodCount        詳細度数です.
+//! @param[in]      scale           ワールド変換のスケールです.
+//! @param[in]      distance        カメラからの距離です.
+//! @param[in]      fovY            垂直画角(ラジアン)です.
+//! @param[in]      screenHeight    画面の高さ(ピクセル)です.
+//! @param[in]      pixelThreshold  許容する画面上の誤差(ピクセル)です.
+//! @return     0 の場合は元メッシュ, それ以外は pLods[戻り値 - 1] を使用します.
+//-------------------------------------------------------------------------------------------------
+u32 SelectMeshLod(
+    const ResLod*   pLods,
+    u32             lodCount,
+    f32             scale,
+    f32             distance,
+    f32             fovY,
+    f32             screenHeight,
+    f32             pixelThreshold = 1.0f );
+
 } // namespace asdx
@@ -10,10 +10,17 @@
 // Includes
 //-------------------------------------------------------------------------------------------------
 #include <asdxSurface.h>
+#include <vector>
 
 
 namespace asdx {
 
+//-------------------------------------------------------------------------------------------------
+// Forward Declarations.
+//-------------------------------------------------------------------------------------------------
+class MappedFile;
+
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 // RESTEXTURE_OPTION enum
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -53,6 +60,51 @@ struct ResTexture
     { /* DO_NOTHING */ }
 };
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ResSubresourceFootprint structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct ResSubresourceFootprint
+{
+    u64     Offset;         //!< ステージングバッファ先頭からのオフセットです(512byte境界).
+    u32     Width;          //!< 横幅です(ブロック圧縮の場合はブロック境界に切り上げます).
+    u32     Height;         //!< 縦幅です(ブロック圧縮の場合はブロック境界に切り上げます).
+    u32     Depth;          //!< 奥行きです.
+    u32     RowPitch;       //!< ステージングバッファ上の1行あたりのサイズ(byte)です(256byte境界).
+    u32     RowCount;       //!< 行数です(ブロック圧縮の場合はブロックの行数).
+    u32     RowSize;        //!< 1行あたりの有効なデータサイズ(byte)です.
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ResTextureView structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct ResTextureView
+{
+    u32                                     Width;          //!< 横幅です.
+    u32                                     Height;         //!< 縦幅です.
+    u32                                     Depth;          //!< 奥行きです.
+    u32                                     SurfaceCount;   //!< 配列要素数です(キューブマップの場合は面数を含みます).
+    u32                                     MipMapCount;    //!< ミップレベル数です.
+    u32                                     Format;         //!< フォーマット(DXGI_FORMAT の値)です.
+    u32                                     Option;         //!< オプション(RESTEXTURE_OPTION の組み合わせ)です.
+    std::vector<Surface>                    Surfaces;       //!< マッピングしたデータを指すサーフェイスです(読み取り専用).
+    std::vector<ResSubresourceFootprint>    Footprints;     //!< ステージングバッファ上の配置です.
+    u64                                     StagingSize;    //!< ステージングバッファに必要なサイズ(byte)です.
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    ResTextureView()
+    : Width         ( 0 )
+    , Height        ( 0 )
+    , Depth         ( 0 )
+    , SurfaceCount  ( 0 )
+    , MipMapCount   ( 0 )
+    , Format        ( 0 )
+    , Option        ( RESTEXTURE_OPTION_NONE )
+    , StagingSize   ( 0 )
+    { /* DO_NOTHING */ }
+};
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 // TextureFactory class
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -83,6 +135,18 @@ public:
     //---------------------------------------------------------------------------------------------
     static bool Create( const char16* filename, ResTexture* pResult );
 
+    //---------------------------------------------------------------------------------------------
+    //! @brief      テクスチャファイルをメモリにマッピングし, コピーせずに参照します.
+    //!
+    //! @param[in]      filename        テクスチャファイル名です.
+    //! @param[out]     pFile           マッピングしたファイルの格納先です. 参照中は破棄しないでください.
+    //! @param[out]     pResult         テクスチャビューの格納先です.
+    //! @retval true    マッピングに成功.
+    //! @retval false   マッピングに失敗.
+    //! @note       DDSファイルのみ対応しています.
+    //---------------------------------------------------------------------------------------------
+    static bool Map( const char16* filename, MappedFile* pFile, ResTextureView* pResult );
+
     //---------------------------------------------------------------------------------------------
     //! @brief      テクスチャリソースを破棄します.
     //!
@@ -91,5 +155,15 @@ public:
     static void Dispose( ResTexture*& ptr );
 };
 
+//-------------------------------------------------------------------------------------------------
+//! @brief      テクスチャビューのピクセルデータをステージングバッファに書き込みます.
+//!
+//! @param[in]      view            テクスチャビューです.
+//! @param[out]     pDst            書き込み先です. view.StagingSize 以上のサイズが必要です.
+//! @note       サブリソースごとに view.Footprints の配置で書き込みます.
+//!             行ピッチが一致する場合はサブリソース単位でまとめてコピーします.
+//-------------------------------------------------------------------------------------------------
+void WriteToStagingBuffer( const ResTextureView& view, void* pDst );
+
 
 } // namespace asdx
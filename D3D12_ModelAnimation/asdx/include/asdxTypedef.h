@@ -137,8 +137,8 @@
 #endif//ASDX_WIDE
 
 
-#if defined(_M_IX86) || defined(_M_AMD64)
-  #if defined(_M_IX86_FP)
+#if defined(_M_IX86) || defined(_M_AMD64) || defined(__i386__) || defined(__x86_64__)
+  #if defined(_M_IX86_FP) || defined(_M_AMD64) || defined(__SSE2__)
     #define ASDX_IS_SSE2   (1)     // SSE2有効.
     #define ASDX_IS_NEON   (0)     // NEON無効.
   #else
@@ -290,27 +290,35 @@ using char16 = wchar_t;
 //! @typedef    sptr
 //! @brief      符号付き整数ポインタです.
 //-------------------------------------------------------------------------------------------------
-#ifdef _WIN64
+#if defined(_WIN64)
 using sptr = __int64;
-#else
+#elif defined(_MSC_VER)
 using sptr = _w64 int;
+#else
+using sptr = decltype( static_cast<char*>(nullptr) - static_cast<char*>(nullptr) );
 #endif
 
 //-------------------------------------------------------------------------------------------------
 //! @typedef    uptr
 //! @brief      符号なし整数ポインタです.
 //-------------------------------------------------------------------------------------------------
-#ifdef _WIN64 
+#if defined(_WIN64)
 using uptr = unsigned __int64;
-#else
+#elif defined(_MSC_VER)
 using uptr = _w64 unsigned int;
+#else
+using uptr = decltype( sizeof(void*) );
 #endif
 
 //-------------------------------------------------------------------------------------------------
 //! @typedef    nullptr_type
 //! @brief      nullptr型です。
 //-------------------------------------------------------------------------------------------------
+#if defined(_MSC_VER)
 using nullptr_type = decltype(__nullptr);
+#else
+using nullptr_type = decltype(nullptr);
+#endif
 
 
 //--------------------------------------------------------------------------------------------------
@@ -318,7 +326,11 @@ using nullptr_type = decltype(__nullptr);
 //! @brief      符号付き8bit整数型の最小値です.
 //--------------------------------------------------------------------------------------------------
 #ifndef S8_MIN
+#if defined(_MSC_VER)
 #define S8_MIN          (-127i8 - 1)
+#else
+#define S8_MIN          (-127 - 1)
+#endif
 #endif//S8_MIN
 
 //--------------------------------------------------------------------------------------------------
@@ -326,7 +338,11 @@ using nullptr_type = decltype(__nullptr);
 //! @brief      符号付き16bit整数型の最小値です.
 //--------------------------------------------------------------------------------------------------
 #ifndef S16_MIN
+#if defined(_MSC_VER)
 #define S16_MIN         (-32767i16 - 1)
+#else
+#define S16_MIN         (-32767 - 1)
+#endif
 #endif//S16_MIN
 
 //--------------------------------------------------------------------------------------------------
@@ -334,7 +350,11 @@ using nullptr_type = decltype(__nullptr);
 //! @brief      符号付き32bit整数型の最小値です.
 //--------------------------------------------------------------------------------------------------
 #ifndef S32_MIN
+#if defined(_MSC_VER)
 #define S32_MIN         (-2147483647i32 - 1)
+#else
+#define S32_MIN         (-2147483647 - 1)
+#endif
 #endif//S32_MIN
 
 //--------------------------------------------------------------------------------------------------
@@ -342,7 +362,11 @@ using nullptr_type = decltype(__nullptr);
 //! @brief      符号付き64bit整数型の最小値です.
 //--------------------------------------------------------------------------------------------------
 #ifndef S64_MIN
+#if defined(_MSC_VER)
 #define S64_MIN         (-9223372036854775807i64 - 1)
+#else
+#define S64_MIN         (-9223372036854775807LL - 1)
+#endif
 #endif//S64_MIN
 
 //--------------------------------------------------------------------------------------------------
@@ -350,7 +374,11 @@ using nullptr_type = decltype(__nullptr);
 //! @brief      符号付8bit整数型の最大値です.
 //--------------------------------------------------------------------------------------------------
 #ifndef S8_MAX
+#if defined(_MSC_VER)
 #define S8_MAX          127i8
+#else
+#define S8_MAX          127
+#endif
 #endif//S8_MAX
 
 //--------------------------------------------------------------------------------------------------
@@ -358,7 +386,11 @@ using nullptr_type = decltype(__nullptr);
 //! @brief      符号付き16bit整数型の最大値です.
 //--------------------------------------------------------------------------------------------------
 #ifndef S16_MAX
+#if defined(_MSC_VER)
 #define S16_MAX         32767i16
+#else
+#define S16_MAX         32767
+#endif
 #endif//S16_MAX
 
 //--------------------------------------------------------------------------------------------------
@@ -366,7 +398,11 @@ using nullptr_type = decltype(__nullptr);
 //! @brief      符号付き32bit整数型の最大値です.
 //--------------------------------------------------------------------------------------------------
 #ifndef S32_MAX
+#if defined(_MSC_VER)
 #define S32_MAX         2147483647i32
+#else
+#define S32_MAX         2147483647
+#endif
 #endif//S32_MAX
 
 //--------------------------------------------------------------------------------------------------
@@ -374,7 +410,11 @@ using nullptr_type = decltype(__nullptr);
 //! @brief      符号付き64bit整数型の最大値です.
 //--------------------------------------------------------------------------------------------------
 #ifndef S64_MAX
+#if defined(_MSC_VER)
 #define S64_MAX         9223372036854775807i64
+#else
+#define S64_MAX         9223372036854775807LL
+#endif
 #endif//S64_MAX
 
 //--------------------------------------------------------------------------------------------------
@@ -382,7 +422,11 @@ using nullptr_type = decltype(__nullptr);
 //! @brief      符号無し8bit整数型の最大値です.
 //--------------------------------------------------------------------------------------------------
 #ifndef U8_MAX
+#if defined(_MSC_VER)
 #define U8_MAX          0xffui8
+#else
+#define U8_MAX          0xffu
+#endif
 #endif//U8_MAX
 
 //--------------------------------------------------------------------------------------------------
@@ -390,7 +434,11 @@ using nullptr_type = decltype(__nullptr);
 //! @brief      符号無し16bit整数型の最大値です.
 //--------------------------------------------------------------------------------------------------
 #ifndef U16_MAX
+#if defined(_MSC_VER)
 #define U16_MAX         0xffffui16
+#else
+#define U16_MAX         0xffffu
+#endif
 #endif//U16_MAX
 
 //--------------------------------------------------------------------------------------------------
@@ -398,7 +446,11 @@ using nullptr_type = decltype(__nullptr);
 //! @brief      符号無し32bit整数型の最大値です.
 //--------------------------------------------------------------------------------------------------
 #ifndef U32_MAX
+#if defined(_MSC_VER)
 #define U32_MAX         0xffffffffui32
+#else
+#define U32_MAX         0xffffffffu
+#endif
 #endif//U32_MAX
 
 //--------------------------------------------------------------------------------------------------
@@ -406,7 +458,11 @@ using nullptr_type = decltype(__nullptr);
 //! @brief      符号無し64bit整数型の最大値です.
 //--------------------------------------------------------------------------------------------------
 #ifndef U64_MAX
+#if defined(_MSC_VER)
 #define U64_MAX         0xffffffffffffffffui64
+#else
+#define U64_MAX         0xffffffffffffffffull
+#endif
 #endif//U64_MAX
 
 //--------------------------------------------------------------------------------------------------
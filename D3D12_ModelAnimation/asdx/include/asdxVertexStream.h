@@ -0,0 +1,103 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxVertexStream.h
+// Desc : Vertex Stream Layout Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+#pragma once
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <d3d12.h>
+#include <vector>
+#include <asdxResMesh.h>
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// VERTEX_STREAM_FLAG enum
+///////////////////////////////////////////////////////////////////////////////////////////////////
+enum VERTEX_STREAM_FLAG
+{
+    VERTEX_STREAM_FLAG_NONE         = 0x0,      //!< 指定なし(32bit 浮動小数で格納します).
+    VERTEX_STREAM_FLAG_QUANTIZE     = 0x1,      //!< 位置座標を 16bit unorm, 法線を八面体 16bit snorm, テクスチャ座標を半精度, ボーン重みを 8bit unorm で格納します.
+};
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      頂点属性をパスごとの使用状況でストリームに振り分けます.
+//!
+//! @param[in]      pMesh           頂点属性を参照するメッシュです.
+//! @param[in]      flags           VERTEX_STREAM_FLAG の組み合わせです.
+//! @param[out]     pResult         レイアウトの格納先です.
+//! @retval true    計画に成功.
+//! @retval false   計画に失敗.
+//! @note       位置座標は常に単独のストリーム 0 に詰めて格納します.
+//!             それ以外の属性は使用するパスが同じもの同士を1つのストリームにまとめます.
+//!             スキニングを行うメッシュではボーン番号と重みも全パスで使用します.
+//-------------------------------------------------------------------------------------------------
+bool PlanVertexStreams( const ResMesh* pMesh, u32 flags, ResVertexLayout* pResult );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      頂点ストリームを構築し, メッシュに格納します.
+//!
+//! @param[in,out]  pMesh           頂点ストリームを構築するメッシュです.
+//! @param[in]      flags           VERTEX_STREAM_FLAG の組み合わせです.
+//! @retval true    構築に成功.
+//! @retval false   構築に失敗.
+//! @note       頂点を並べ替える最適化(OptimizeMesh() など)の後に呼び出してください.
+//!             構築結果は SaveResMeshToMSH() でメッシュファイルに保存されます.
+//-------------------------------------------------------------------------------------------------
+bool BuildVertexStreams( ResMesh* pMesh, u32 flags );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      パスで使用するストリーム番号を取得します.
+//!
+//! @param[in]      layout          頂点レイアウトです.
+//! @param[in]      pass            描画パスです.
+//! @param[out]     pStreams        ストリーム番号の格納先です(VERTEX_ATTRIBUTE_COUNT 要素以上, nullptr 可).
+//! @return     ストリーム数を返却します. 戻り値の順番が入力スロット番号になります.
+//-------------------------------------------------------------------------------------------------
+u32 GetVertexStreams( const ResVertexLayout& layout, VERTEX_PASS pass, u32* pStreams );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      パスで読み込む1頂点あたりのバイト数を取得します.
+//!
+//! @param[in]      layout          頂点レイアウトです.
+//! @param[in]      pass            描画パスです.
+//! @return     1頂点あたりのバイト数を返却します.
+//-------------------------------------------------------------------------------------------------
+u32 GetVertexFetchSize( const ResVertexLayout& layout, VERTEX_PASS pass );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      パスに対応する入力要素を取得します.
+//!
+//! @param[in]      layout          頂点レイアウトです.
+//! @param[in]      pass            描画パスです.
+//! @param[out]     elementDesc     入力要素の格納先です.
+//! @retval true    取得に成功.
+//! @retval false   取得に失敗.
+//! @note       セマンティクスは POSITION, NORMAL, TEXCOORD, BONE_INDEX, BONE_WEIGHT です.
+//!             入力スロットは GetVertexStreams() の順番に合わせて詰めて割り当てます.
+//-------------------------------------------------------------------------------------------------
+bool GetInputElements(
+    const ResVertexLayout&                  layout,
+    VERTEX_PASS                             pass,
+    std::vector<D3D12_INPUT_ELEMENT_DESC>&  elementDesc );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      パスに対応する頂点バッファビューを取得します.
+//!
+//! @param[in]      layout          頂点レイアウトです.
+//! @param[in]      pass            描画パスです.
+//! @param[in]      address         VertexStreams をそのまま転送した頂点バッファの GPU 仮想アドレスです.
+//! @param[out]     pViews          頂点バッファビューの格納先です(VERTEX_ATTRIBUTE_COUNT 要素以上).
+//! @return     頂点バッファビュー数を返却します. IASetVertexBuffers() の開始スロットは 0 としてください.
+//-------------------------------------------------------------------------------------------------
+u32 GetVertexBufferViews(
+    const ResVertexLayout&      layout,
+    VERTEX_PASS                 pass,
+    D3D12_GPU_VIRTUAL_ADDRESS   address,
+    D3D12_VERTEX_BUFFER_VIEW*   pViews );
+
+} // namespace asdx
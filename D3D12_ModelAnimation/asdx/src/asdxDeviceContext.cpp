@@ -10,6 +10,7 @@
 #include <asdxDeviceContext.h>
 #include <asdxLogger.h>
 #include <cassert>
+#include <vector>
 
 
 namespace /* anonymous */ {
@@ -411,6 +412,136 @@ bool DeviceContext::UpdateSubRes
     return true;
 }
 
+//-------------------------------------------------------------------------------------------------
+//      テクスチャビューの全サブリソースを更新します.
+//-------------------------------------------------------------------------------------------------
+bool DeviceContext::UpdateSubRes
+(
+    ID3D12Resource*         pResource,
+    const ResTextureView&   view
+)
+{
+    if ( pResource == nullptr || view.Surfaces.empty() || view.Footprints.size() != view.Surfaces.size() )
+    {
+        ELOG( "Error : Invalid Argument." );
+        return false;
+    }
+
+    RefPtr<ID3D12Device> device;
+    pResource->GetDevice( IID_PPV_ARGS( device.GetAddress() ));
+
+    auto desc  = pResource->GetDesc();
+    auto count = static_cast<u32>( view.Footprints.size() );
+
+    // ビューの配置がリソースのコピー可能な配置と一致するかチェック.
+    std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> layouts( count );
+    u64 requiredSize = 0;
+    device->GetCopyableFootprints( &desc, 0, count, 0, layouts.data(), nullptr, nullptr, &requiredSize );
+
+    if ( requiredSize > view.StagingSize )
+    {
+        ELOG( "Error : Staging Size Mismatch. required = %llu, view = %llu", requiredSize, view.StagingSize );
+        return false;
+    }
+
+    for( u32 i=0; i<count; ++i )
+    {
+        const auto& footprint = view.Footprints[i];
+        if ( layouts[i].Offset             != footprint.Offset
+          || layouts[i].Footprint.RowPitch != footprint.RowPitch
+          || layouts[i].Footprint.Depth    != footprint.Depth )
+        {
+            ELOG( "Error : Footprint Mismatch. subresource = %u", i );
+            return false;
+        }
+    }
+
+    RefPtr<ID3D12Resource> intermediate;
+    {
+        // アップロード用リソースを生成.
+        D3D12_RESOURCE_DESC uploadDesc = {
+            D3D12_RESOURCE_DIMENSION_BUFFER,
+            0,
+            view.StagingSize,
+            1,
+            1,
+            1,
+            DXGI_FORMAT_UNKNOWN,
+            { 1, 0 },
+            D3D12_TEXTURE_LAYOUT_ROW_MAJOR,
+            D3D12_RESOURCE_FLAG_NONE
+        };
+
+        D3D12_HEAP_PROPERTIES props = {
+            D3D12_HEAP_TYPE_UPLOAD,
+            D3D12_CPU_PAGE_PROPERTY_UNKNOWN,
+            D3D12_MEMORY_POOL_UNKNOWN,
+            1,
+            1
+        };
+
+        auto hr = device->CreateCommittedResource(
+            &props,
+            D3D12_HEAP_FLAG_NONE,
+            &uploadDesc,
+            D3D12_RESOURCE_STATE_GENERIC_READ,
+            nullptr,
+            IID_PPV_ARGS(intermediate.GetAddress()));
+        if ( FAILED( hr ) )
+        {
+            ELOG( "Error : ID3D12Device::CreateCommittedResource() Failed." );
+            return false;
+        }
+    }
+
+    // マッピングしたファイルからステージングバッファに直接書き込む.
+    {
+        void* pData = nullptr;
+        auto hr = intermediate->Map( 0, nullptr, &pData );
+        if ( FAILED( hr ) )
+        {
+            ELOG( "Error : ID3D12Resource::Map() Failed." );
+            return false;
+        }
+
+        WriteToStagingBuffer( view, pData );
+
+        intermediate->Unmap( 0, nullptr );
+    }
+
+    Transition(
+        pResource,
+        D3D12_RESOURCE_STATE_COMMON,
+        D3D12_RESOURCE_STATE_COPY_DEST );
+
+    for( u32 i=0; i<count; ++i )
+    {
+        D3D12_TEXTURE_COPY_LOCATION dst = {};
+        dst.pResource        = pResource;
+        dst.Type             = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+        dst.SubresourceIndex = i;
+
+        D3D12_TEXTURE_COPY_LOCATION src = {};
+        src.pResource       = intermediate.GetPtr();
+        src.Type            = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+        src.PlacedFootprint = layouts[i];
+
+        m_Immediate.GetList()->CopyTextureRegion( &dst, 0, 0, 0, &src, nullptr );
+    }
+
+    Transition( 
+        pResource,
+        D3D12_RESOURCE_STATE_COPY_DEST,
+        D3D12_RESOURCE_STATE_GENERIC_READ );
+
+    m_Immediate->Close();
+
+    Execute();
+    Wait( INFINITE );
+
+    return true;
+}
+
 //-------------------------------------------------------------------------------------------------
 //      遷移によるリソースバリアを設定します.
 //-------------------------------------------------------------------------------------------------
@@ -0,0 +1,305 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxFile.cpp
+// Desc : File Utility Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxFile.h>
+#include <asdxLogger.h>
+
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+
+namespace asdx {
+
+//-------------------------------------------------------------------------------------------------
+//      ワイド文字列をUTF-8に変換します.
+//-------------------------------------------------------------------------------------------------
+std::string ToUtf8( const char16* value )
+{
+    std::string result;
+    if ( value == nullptr )
+    { return result; }
+
+    for( auto p = value; *p != L'\0'; ++p )
+    {
+        auto c = static_cast<u32>( *p );
+
+        // wchar_t が UTF-16 の環境ではサロゲートペアを結合する.
+        if ( 0xD800 <= c && c < 0xDC00 && 0xDC00 <= static_cast<u32>( p[1] ) && static_cast<u32>( p[1] ) < 0xE000 )
+        {
+            c = 0x10000 + ( ( c - 0xD800 ) << 10 ) + ( static_cast<u32>( p[1] ) - 0xDC00 );
+            ++p;
+        }
+
+        if ( c < 0x80 )
+        { result.push_back( static_cast<char>( c ) ); }
+        else if ( c < 0x800 )
+        {
+            result.push_back( static_cast<char>( 0xC0 | ( c >> 6 ) ) );
+            result.push_back( static_cast<char>( 0x80 | ( c & 0x3F ) ) );
+        }
+        else if ( c < 0x10000 )
+        {
+            result.push_back( static_cast<char>( 0xE0 | ( c >> 12 ) ) );
+            result.push_back( static_cast<char>( 0x80 | ( ( c >> 6 ) & 0x3F ) ) );
+            result.push_back( static_cast<char>( 0x80 | ( c & 0x3F ) ) );
+        }
+        else
+        {
+            result.push_back( static_cast<char>( 0xF0 | ( c >> 18 ) ) );
+            result.push_back( static_cast<char>( 0x80 | ( ( c >> 12 ) & 0x3F ) ) );
+            result.push_back( static_cast<char>( 0x80 | ( ( c >> 6 ) & 0x3F ) ) );
+            result.push_back( static_cast<char>( 0x80 | ( c & 0x3F ) ) );
+        }
+    }
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ワイド文字列をUTF-16の固定長バッファに格納します.
+//-------------------------------------------------------------------------------------------------
+void ToUtf16( const std::wstring& value, u16* pBuffer, size_t count )
+{
+    if ( pBuffer == nullptr || count == 0 )
+    { return; }
+
+    size_t length = 0;
+    for( size_t i=0; i<value.size(); ++i )
+    {
+        auto c = static_cast<u32>( value[i] );
+
+        // wchar_t が UTF-32 の環境ではサロゲートペアに分割する. ペアは途中で切らない.
+        if ( c >= 0x10000 )
+        {
+            if ( length + 2 > count - 1 )
+            { break; }
+
+            c -= 0x10000;
+            pBuffer[length++] = static_cast<u16>( 0xD800 + ( c >> 10 ) );
+            pBuffer[length++] = static_cast<u16>( 0xDC00 + ( c & 0x3FF ) );
+        }
+        else
+        {
+            if ( length + 1 > count - 1 )
+            { break; }
+
+            pBuffer[length++] = static_cast<u16>( c );
+        }
+    }
+
+    for( ; length<count; ++length )
+    { pBuffer[length] = 0; }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      UTF-16の固定長バッファからワイド文字列に変換します.
+//-------------------------------------------------------------------------------------------------
+std::wstring FromUtf16( const u16* pBuffer, size_t count )
+{
+    std::wstring result;
+    if ( pBuffer == nullptr )
+    { return result; }
+
+    for( size_t i=0; i<count && pBuffer[i] != 0; ++i )
+    {
+        u32 c = pBuffer[i];
+
+    #if !defined(_WIN32)
+        // wchar_t が UTF-32 の環境ではサロゲートペアを結合する.
+        if ( 0xD800 <= c && c < 0xDC00 && i + 1 < count && 0xDC00 <= pBuffer[i + 1] && pBuffer[i + 1] < 0xE000 )
+        {
+            c = 0x10000 + ( ( c - 0xD800 ) << 10 ) + ( pBuffer[i + 1] - 0xDC00u );
+            ++i;
+        }
+    #endif
+
+        result.push_back( static_cast<char16>( c ) );
+    }
+
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ファイルを開きます.
+//-------------------------------------------------------------------------------------------------
+FILE* FileOpen( const char16* filename, const char16* mode )
+{
+    if ( filename == nullptr || mode == nullptr )
+    { return nullptr; }
+
+#if defined(_WIN32)
+    FILE* pFile = nullptr;
+    if ( _wfopen_s( &pFile, filename, mode ) != 0 )
+    { return nullptr; }
+    return pFile;
+#else
+    return fopen( ToUtf8( filename ).c_str(), ToUtf8( mode ).c_str() );
+#endif
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// MappedFile class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+//-------------------------------------------------------------------------------------------------
+//      コンストラクタです.
+//-------------------------------------------------------------------------------------------------
+MappedFile::MappedFile()
+: m_pData   ( nullptr )
+, m_Size    ( 0 )
+, m_hFile   ( nullptr )
+, m_hMapping( nullptr )
+{ /* DO_NOTHING */ }
+
+//-------------------------------------------------------------------------------------------------
+//      デストラクタです.
+//-------------------------------------------------------------------------------------------------
+MappedFile::~MappedFile()
+{ Close(); }
+
+//-------------------------------------------------------------------------------------------------
+//      ファイルをマッピングします.
+//-------------------------------------------------------------------------------------------------
+bool MappedFile::Open( const char16* filename )
+{
+    if ( filename == nullptr )
+    {
+        ELOG( "Error : Invalid Argument." );
+        return false;
+    }
+
+    Close();
+
+#if defined(_WIN32)
+    auto hFile = CreateFileW(
+        filename,
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+        nullptr );
+    if ( hFile == INVALID_HANDLE_VALUE )
+    {
+        ELOGW( "Error : File Open Failed. filename = %ls", filename );
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if ( !GetFileSizeEx( hFile, &size ) || size.QuadPart == 0 )
+    {
+        ELOGW( "Error : Invalid File Size. filename = %ls", filename );
+        CloseHandle( hFile );
+        return false;
+    }
+
+    auto hMapping = CreateFileMappingW( hFile, nullptr, PAGE_READONLY, 0, 0, nullptr );
+    if ( hMapping == nullptr )
+    {
+        ELOG( "Error : CreateFileMappingW() Failed." );
+        CloseHandle( hFile );
+        return false;
+    }
+
+    auto pData = MapViewOfFile( hMapping, FILE_MAP_READ, 0, 0, 0 );
+    if ( pData == nullptr )
+    {
+        ELOG( "Error : MapViewOfFile() Failed." );
+        CloseHandle( hMapping );
+        CloseHandle( hFile );
+        return false;
+    }
+
+    m_hFile    = hFile;
+    m_hMapping = hMapping;
+    m_pData    = static_cast<const u8*>( pData );
+    m_Size     = static_cast<u64>( size.QuadPart );
+#else
+    auto fd = open( ToUtf8( filename ).c_str(), O_RDONLY );
+    if ( fd < 0 )
+    {
+        ELOGW( "Error : File Open Failed. filename = %ls", filename );
+        return false;
+    }
+
+    struct stat info;
+    if ( fstat( fd, &info ) != 0 || info.st_size <= 0 )
+    {
+        ELOGW( "Error : Invalid File Size. filename = %ls", filename );
+        close( fd );
+        return false;
+    }
+
+    auto pData = mmap( nullptr, static_cast<size_t>( info.st_size ), PROT_READ, MAP_PRIVATE, fd, 0 );
+    if ( pData == MAP_FAILED )
+    {
+        ELOG( "Error : mmap() Failed." );
+        close( fd );
+        return false;
+    }
+
+    madvise( pData, static_cast<size_t>( info.st_size ), MADV_SEQUENTIAL );
+
+    m_hFile    = reinterpret_cast<void*>( static_cast<intptr_t>( fd ) );
+    m_hMapping = pData;
+    m_pData    = static_cast<const u8*>( pData );
+    m_Size     = static_cast<u64>( info.st_size );
+#endif
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      マッピングを解除します.
+//-------------------------------------------------------------------------------------------------
+void MappedFile::Close()
+{
+    if ( m_pData == nullptr )
+    { return; }
+
+#if defined(_WIN32)
+    UnmapViewOfFile( m_pData );
+    CloseHandle( m_hMapping );
+    CloseHandle( m_hFile );
+#else
+    munmap( m_hMapping, static_cast<size_t>( m_Size ) );
+    close( static_cast<int>( reinterpret_cast<intptr_t>( m_hFile ) ) );
+#endif
+
+    m_pData    = nullptr;
+    m_Size     = 0;
+    m_hFile    = nullptr;
+    m_hMapping = nullptr;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      データの先頭ポインタを取得します.
+//-------------------------------------------------------------------------------------------------
+const u8* MappedFile::GetData() const
+{ return m_pData; }
+
+//-------------------------------------------------------------------------------------------------
+//      ファイルサイズを取得します.
+//-------------------------------------------------------------------------------------------------
+u64 MappedFile::GetSize() const
+{ return m_Size; }
+
+//-------------------------------------------------------------------------------------------------
+//      マッピング済みかどうかチェックします.
+//-------------------------------------------------------------------------------------------------
+bool MappedFile::IsOpen() const
+{ return m_pData != nullptr; }
+
+} // namespace asdx
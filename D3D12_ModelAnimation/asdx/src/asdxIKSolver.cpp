@@ -0,0 +1,402 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxIKSolver.cpp
+// Desc : CCD Inverse Kinematics Solver Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxIKSolver.h>
+#include <asdxResMesh.h>
+#include <asdxLogger.h>
+#include <algorithm>
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------------
+// Constant Values.
+//-------------------------------------------------------------------------------------------------
+static const f32 kMinLengthSq   = 1e-12f;   // これより短いベクトルは方向を求めない.
+static const f32 kMinAngle      = 1e-6f;    // これより角度が小さい場合は回転しない.
+
+//-------------------------------------------------------------------------------------------------
+//      平行移動成分を取得します.
+//-------------------------------------------------------------------------------------------------
+inline asdx::Vector3 GetTranslation( const asdx::Matrix& value )
+{ return asdx::Vector3( value._41, value._42, value._43 ); }
+
+//-------------------------------------------------------------------------------------------------
+//      軸に垂直なベクトルを求めます.
+//-------------------------------------------------------------------------------------------------
+inline asdx::Vector3 GetPerpendicular( const asdx::Vector3& axis )
+{
+    auto up = ( fabsf( axis.x ) < 0.9f ) ? asdx::Vector3( 1.0f, 0.0f, 0.0f ) : asdx::Vector3( 0.0f, 1.0f, 0.0f );
+    return asdx::Vector3::Normalize( asdx::Vector3::Cross( axis, up ) );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      軸回りの符号付き角度を求めます.
+//-------------------------------------------------------------------------------------------------
+inline f32 SignedAngle( const asdx::Vector3& a, const asdx::Vector3& b, const asdx::Vector3& axis )
+{
+    auto c = asdx::Vector3::Cross( a, b );
+    return atan2f( asdx::Vector3::Dot( c, axis ), asdx::Vector3::Dot( a, b ) );
+}
+
+} // namespace /* anonymous */
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// IKSolver class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+//-------------------------------------------------------------------------------------------------
+//      コンストラクタです.
+//-------------------------------------------------------------------------------------------------
+IKSolver::IKSolver()
+: m_pBones      ( nullptr )
+, m_BoneCount   ( 0 )
+, m_Chains      ()
+, m_Links       ()
+, m_PathBones   ()
+, m_UpdateBones ()
+, m_Tolerance   ( 1e-4f )
+{ /* DO_NOTHING */ }
+
+//-------------------------------------------------------------------------------------------------
+//      デストラクタです.
+//-------------------------------------------------------------------------------------------------
+IKSolver::~IKSolver()
+{ Term(); }
+
+//-------------------------------------------------------------------------------------------------
+//      初期化処理を行います.
+//-------------------------------------------------------------------------------------------------
+bool IKSolver::Init( u32 boneCount, const ResBone* pBones, const IKChain* pChains, u32 chainCount )
+{
+    Term();
+
+    if ( boneCount == 0 || pBones == nullptr || ( chainCount > 0 && pChains == nullptr ) )
+    {
+        ELOG( "Error : Invalid Argument." );
+        return false;
+    }
+
+    for( u32 i=0; i<boneCount; ++i )
+    {
+        if ( pBones[i].ParentId != U32_MAX && pBones[i].ParentId >= i )
+        {
+            ELOG( "Error : Parent Bone Must Precede Child. bone = %u", i );
+            return false;
+        }
+    }
+
+    m_pBones    = pBones;
+    m_BoneCount = boneCount;
+    m_Chains.reserve( chainCount );
+
+    std::vector<u8> inTree( boneCount );
+
+    for( u32 i=0; i<chainCount; ++i )
+    {
+        const auto& src = pChains[i];
+        if ( src.GoalBone >= boneCount || src.EffectorBone >= boneCount || src.Links.empty() )
+        {
+            ELOG( "Error : Invalid IK Chain. chain = %u", i );
+            Term();
+            return false;
+        }
+
+        Chain chain;
+        chain.GoalBone      = src.GoalBone;
+        chain.EffectorBone  = src.EffectorBone;
+        chain.Iterations    = src.Iterations;
+        chain.LimitAngle    = src.LimitAngle;
+        chain.LinkOffset    = u32( m_Links.size() );
+        chain.LinkCount     = u32( src.Links.size() );
+
+        auto top = src.EffectorBone;
+
+        for( size_t j=0; j<src.Links.size(); ++j )
+        {
+            Link link;
+            link.Desc       = src.Links[j];
+            link.PathOffset = u32( m_PathBones.size() );
+
+            if ( link.Desc.IsHinge )
+            { link.Desc.HingeAxis = Vector3::Normalize( link.Desc.HingeAxis ); }
+
+            // エフェクタから親をたどってリンクまでの経路を求める.
+            auto bone = src.EffectorBone;
+            while( bone != U32_MAX && bone != link.Desc.BoneIndex )
+            {
+                m_PathBones.push_back( bone );
+                bone = pBones[bone].ParentId;
+            }
+
+            if ( bone == U32_MAX )
+            {
+                ELOG( "Error : IK Link Is Not Ancestor Of Effector. chain = %u, link = %u", i, u32(j) );
+                Term();
+                return false;
+            }
+
+            m_PathBones.push_back( bone );
+            std::reverse( m_PathBones.begin() + link.PathOffset, m_PathBones.end() );
+
+            link.PathCount = u32( m_PathBones.size() ) - link.PathOffset;
+            m_Links.push_back( link );
+
+            if ( bone < top )
+            { top = bone; }
+        }
+
+        // 最も根元のリンク以下のボーンはチェーン解決後にワールド行列を更新する.
+        chain.UpdateOffset = u32( m_UpdateBones.size() );
+        for( u32 j=0; j<boneCount; ++j )
+        {
+            auto parent = pBones[j].ParentId;
+            inTree[j] = ( j == top ) || ( j > top && parent != U32_MAX && inTree[parent] != 0 );
+            if ( inTree[j] )
+            { m_UpdateBones.push_back( j ); }
+        }
+        chain.UpdateCount = u32( m_UpdateBones.size() ) - chain.UpdateOffset;
+
+        m_Chains.push_back( chain );
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      終了処理を行います.
+//-------------------------------------------------------------------------------------------------
+void IKSolver::Term()
+{
+    m_pBones    = nullptr;
+    m_BoneCount = 0;
+
+    m_Chains     .clear();
+    m_Links      .clear();
+    m_PathBones  .clear();
+    m_UpdateBones.clear();
+}
+
+//-------------------------------------------------------------------------------------------------
+//      収束とみなす距離を設定します.
+//-------------------------------------------------------------------------------------------------
+void IKSolver::SetTolerance( f32 value )
+{ m_Tolerance = Max( value, 0.0f ); }
+
+//-------------------------------------------------------------------------------------------------
+//      収束とみなす距離を取得します.
+//-------------------------------------------------------------------------------------------------
+f32 IKSolver::GetTolerance() const
+{ return m_Tolerance; }
+
+//-------------------------------------------------------------------------------------------------
+//      初期化時に指定したボーン数を取得します.
+//-------------------------------------------------------------------------------------------------
+u32 IKSolver::GetBoneCount() const
+{ return m_BoneCount; }
+
+//-------------------------------------------------------------------------------------------------
+//      IKチェーン数を取得します.
+//-------------------------------------------------------------------------------------------------
+u32 IKSolver::GetChainCount() const
+{ return u32( m_Chains.size() ); }
+
+//-------------------------------------------------------------------------------------------------
+//      IKを解きます.
+//-------------------------------------------------------------------------------------------------
+void IKSolver::Solve( Matrix* pBoneTransforms, Matrix* pWorldTransforms, IKStatistics* pStatistics ) const
+{
+    if ( pBoneTransforms == nullptr || pWorldTransforms == nullptr )
+    { return; }
+
+    // 統計情報は呼び出し側に加算する(ソルバーを複数スレッドで共有できるようにするため).
+    IKStatistics statistics;
+
+    // 前のチェーンの結果を後のチェーンが参照するため, 指定順に解く.
+    for( size_t i=0; i<m_Chains.size(); ++i )
+    { SolveChain( m_Chains[i], pBoneTransforms, pWorldTransforms, statistics ); }
+
+    if ( pStatistics != nullptr )
+    {
+        pStatistics->SolveCount     += statistics.SolveCount;
+        pStatistics->ConvergedCount += statistics.ConvergedCount;
+        pStatistics->IterationCount += statistics.IterationCount;
+        pStatistics->RotationCount  += statistics.RotationCount;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      同じボーン構成の複数のキャラクターのIKをまとめて解きます.
+//-------------------------------------------------------------------------------------------------
+void IKSolver::Solve( const IKPose* pPoses, u32 count, IKStatistics* pStatistics ) const
+{
+    if ( pPoses == nullptr )
+    { return; }
+
+    for( u32 i=0; i<count; ++i )
+    { Solve( pPoses[i].pBoneTransforms, pPoses[i].pWorldTransforms, pStatistics ); }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      チェーンを解きます.
+//-------------------------------------------------------------------------------------------------
+void IKSolver::SolveChain
+(
+    const Chain&    chain,
+    Matrix*         pBoneTransforms,
+    Matrix*         pWorldTransforms,
+    IKStatistics&   statistics
+) const
+{
+    auto goal      = GetTranslation( pWorldTransforms[chain.GoalBone] );
+    auto tolerance = m_Tolerance * m_Tolerance;
+    auto converged = false;
+
+    statistics.SolveCount++;
+
+    for( u32 iter=0; iter<chain.Iterations; ++iter )
+    {
+        // 収束していれば打ち切る.
+        auto effector = GetTranslation( pWorldTransforms[chain.EffectorBone] );
+        if ( ( goal - effector ).LengthSq() <= tolerance )
+        {
+            converged = true;
+            break;
+        }
+
+        statistics.IterationCount++;
+
+        for( u32 i=0; i<chain.LinkCount; ++i )
+        {
+            const auto& link = m_Links[chain.LinkOffset + i];
+            auto bone = link.Desc.BoneIndex;
+
+            // リンクの座標系で回転を求める.
+            auto invWorld    = Matrix::Invert( pWorldTransforms[bone] );
+            auto localEffect = Vector3::Transform( effector, invWorld );
+            auto localGoal   = Vector3::Transform( goal,     invWorld );
+
+            auto& local = pBoneTransforms[bone];
+
+            if ( link.Desc.IsHinge )
+            {
+                const auto& axis = link.Desc.HingeAxis;
+
+                // ヒンジ軸に垂直な平面に射影して回転角を求める.
+                auto pe = localEffect - axis * Vector3::Dot( localEffect, axis );
+                auto pg = localGoal   - axis * Vector3::Dot( localGoal,   axis );
+                if ( pe.LengthSq() < kMinLengthSq || pg.LengthSq() < kMinLengthSq )
+                { continue; }
+
+                auto delta = Clamp( SignedAngle( pe, pg, axis ), -chain.LimitAngle, chain.LimitAngle );
+
+                // 現在の回転角から制限範囲内に収める. ヒンジ軸以外の回転成分は取り除く.
+                auto e       = GetPerpendicular( axis );
+                auto current = SignedAngle( e, Vector3::TransformNormal( e, local ), axis );
+                auto angle   = Clamp( current + delta, link.Desc.MinAngle, link.Desc.MaxAngle );
+
+                auto rotation = Matrix::CreateFromAxisAngle( axis, angle );
+                rotation._41 = local._41;
+                rotation._42 = local._42;
+                rotation._43 = local._43;
+                local = rotation;
+            }
+            else
+            {
+                if ( localEffect.LengthSq() < kMinLengthSq || localGoal.LengthSq() < kMinLengthSq )
+                { continue; }
+
+                auto de = Vector3::Normalize( localEffect );
+                auto dg = Vector3::Normalize( localGoal );
+
+                // 小さな角度でも精度が落ちないよう atan2 で求める.
+                auto axis  = Vector3::Cross( de, dg );
+                auto sine  = axis.Length();
+                auto angle = atan2f( sine, Vector3::Dot( de, dg ) );
+                if ( angle < kMinAngle || sine < kMinAngle )
+                { continue; }
+
+                angle = Min( angle, chain.LimitAngle );
+                local = Matrix::CreateFromAxisAngle( axis / sine, angle ) * local;
+            }
+
+            // リンクからエフェクタまでのワールド行列を更新.
+            UpdateWorld( &m_PathBones[link.PathOffset], link.PathCount, pBoneTransforms, pWorldTransforms );
+            effector = GetTranslation( pWorldTransforms[chain.EffectorBone] );
+
+            statistics.RotationCount++;
+        }
+    }
+
+    if ( !converged )
+    {
+        auto effector = GetTranslation( pWorldTransforms[chain.EffectorBone] );
+        converged = ( ( goal - effector ).LengthSq() <= tolerance );
+    }
+
+    if ( converged )
+    { statistics.ConvergedCount++; }
+
+    // エフェクタ以外の子ボーンにも反映する.
+    UpdateWorld( &m_UpdateBones[chain.UpdateOffset], chain.UpdateCount, pBoneTransforms, pWorldTransforms );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ワールド行列を更新します.
+//-------------------------------------------------------------------------------------------------
+void IKSolver::UpdateWorld
+(
+    const u32*      pIndices,
+    u32             count,
+    const Matrix*   pBoneTransforms,
+    Matrix*         pWorldTransforms
+) const
+{
+    for( u32 i=0; i<count; ++i )
+    {
+        auto bone   = pIndices[i];
+        auto parent = m_pBones[bone].ParentId;
+
+        if ( parent != U32_MAX )
+        { pWorldTransforms[bone] = pBoneTransforms[bone] * pWorldTransforms[parent]; }
+        else
+        { pWorldTransforms[bone] = pBoneTransforms[bone]; }
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+//      ひざボーンのリンクにヒンジ制限を設定します.
+//-------------------------------------------------------------------------------------------------
+u32 SetupKneeLinks( const ResBone* pBones, IKChain& chain )
+{
+    if ( pBones == nullptr )
+    { return 0; }
+
+    u32 count = 0;
+    for( size_t i=0; i<chain.Links.size(); ++i )
+    {
+        auto& link = chain.Links[i];
+        if ( pBones[link.BoneIndex].Name.find( L"ひざ" ) == std::wstring::npos )
+        { continue; }
+
+        link.IsHinge    = true;
+        link.HingeAxis  = Vector3( 1.0f, 0.0f, 0.0f );
+        link.MinAngle   = -F_PI;
+        link.MaxAngle   = ToRadian( -0.5f );
+        count++;
+    }
+
+    return count;
+}
+
+} // namespace asdx
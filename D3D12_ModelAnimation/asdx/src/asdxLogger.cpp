@@ -9,12 +9,19 @@
 //-------------------------------------------------------------------------------------------------
 #include <cstdio>
 #include <cstdarg>
-#include <Windows.h>
+#include <cwchar>
 #include <asdxLogger.h>
 
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <asdxFile.h>
+#endif
+
 
 namespace /* anonymous */ {
 
+#if defined(_WIN32)
 // スクリーンバッファ情報.
 static CONSOLE_SCREEN_BUFFER_INFO  g_ScreenBuffer;
 
@@ -61,6 +68,19 @@ void UnBindColor()
     HANDLE handle = GetStdHandle( STD_OUTPUT_HANDLE );
     SetConsoleTextAttribute( handle, g_ScreenBuffer.wAttributes );
 }
+#else
+//-------------------------------------------------------------------------------------------------
+//      カラーを設定します(Windows 以外では何もしません).
+//-------------------------------------------------------------------------------------------------
+void BindColor( asdx::LogLevel )
+{ /* DO_NOTHING */ }
+
+//-------------------------------------------------------------------------------------------------
+//      カラー設定を解除します(Windows 以外では何もしません).
+//-------------------------------------------------------------------------------------------------
+void UnBindColor()
+{ /* DO_NOTHING */ }
+#endif
 
 }// namespace /* anonymous */
 
@@ -101,12 +121,20 @@ void SystemLogger::LogA( const LogLevel level, const char8* format, ... )
             va_list arg;
 
             va_start( arg, format );
+        #if defined(_WIN32)
             vsprintf_s( msg, format, arg );
+        #else
+            vsnprintf( msg, sizeof(msg), format, arg );
+        #endif
             va_end( arg );
 
+        #if defined(_WIN32)
             printf_s( "%s", msg );
 
             OutputDebugStringA( msg );
+        #else
+            fputs( msg, stdout );
+        #endif
         }
 
         // カラー設定解除.
@@ -131,12 +159,22 @@ void SystemLogger::LogW( const LogLevel level, const char16* format, ... )
             va_list arg;
 
             va_start( arg, format );
+        #if defined(_WIN32)
             vswprintf_s( msg, format, arg );
+        #else
+            vswprintf( msg, sizeof(msg) / sizeof(msg[0]), format, arg );
+        #endif
             va_end( arg );
 
+        #if defined(_WIN32)
             wprintf_s( L"%s", msg );
 
             OutputDebugStringW( msg );
+        #else
+            // ストリームの向きが混在すると後から出力した方が捨てられるため,
+            // ワイド文字列もUTF-8に変換してバイト出力する.
+            fputs( ToUtf8( msg ).c_str(), stdout );
+        #endif
         }
 
         // カラー設定解除.
@@ -0,0 +1,842 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxMeshOptimizer.cpp
+// Desc : Mesh Optimizer Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxMeshOptimizer.h>
+#include <asdxResMesh.h>
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------------
+// Constant Values.
+//-------------------------------------------------------------------------------------------------
+static const u32 FORSYTH_CACHE_SIZE     = 32;       // スコア計算に用いるキャッシュサイズです.
+static const u32 FORSYTH_VALENCE_SIZE   = 32;       // 事前計算する残り三角形数のスコア数です.
+static const u32 OVERDRAW_CACHE_SIZE    = 16;       // クラスタ分割に用いるキャッシュサイズです.
+static const u32 INDEX16_RANGE          = 0xFFFF;   // 16bit インデックスで表現できる最大範囲です.
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ForsythScore class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class ForsythScore
+{
+public:
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    ForsythScore()
+    {
+        const f32 scaler = 1.0f / static_cast<f32>( FORSYTH_CACHE_SIZE - 3 );
+        for( u32 i=0; i<FORSYTH_CACHE_SIZE; ++i )
+        {
+            // 直前の三角形の頂点は再度使われても次の三角形に連続しにくいので少し抑える.
+            m_Cache[i] = ( i < 3 )
+                ? 0.75f
+                : powf( 1.0f - static_cast<f32>( i - 3 ) * scaler, 1.5f );
+        }
+
+        m_Valence[0] = 0.0f;
+        for( u32 i=1; i<FORSYTH_VALENCE_SIZE; ++i )
+        { m_Valence[i] = 2.0f * powf( static_cast<f32>( i ), -0.5f ); }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      頂点スコアを求めます.
+    //---------------------------------------------------------------------------------------------
+    f32 Calc( u32 cachePos, u32 remaining ) const
+    {
+        if ( remaining == 0 )
+        { return -1.0f; }
+
+        auto score = ( cachePos < FORSYTH_CACHE_SIZE ) ? m_Cache[cachePos] : 0.0f;
+        score += ( remaining < FORSYTH_VALENCE_SIZE )
+            ? m_Valence[remaining]
+            : 2.0f * powf( static_cast<f32>( remaining ), -0.5f );
+
+        return score;
+    }
+
+private:
+    f32     m_Cache  [FORSYTH_CACHE_SIZE];      //!< キャッシュ位置によるスコアです.
+    f32     m_Valence[FORSYTH_VALENCE_SIZE];    //!< 残り三角形数によるスコアです.
+};
+
+//-------------------------------------------------------------------------------------------------
+//      インデックスを局所頂点番号に変換します.
+//-------------------------------------------------------------------------------------------------
+u32 CreateLocalIndices( const u32* pIndices, u32 indexCount, std::vector<u32>& result )
+{
+    std::vector<u32> unique( pIndices, pIndices + indexCount );
+    std::sort( unique.begin(), unique.end() );
+    unique.erase( std::unique( unique.begin(), unique.end() ), unique.end() );
+
+    result.resize( indexCount );
+    for( u32 i=0; i<indexCount; ++i )
+    {
+        auto itr = std::lower_bound( unique.begin(), unique.end(), pIndices[i] );
+        result[i] = static_cast<u32>( itr - unique.begin() );
+    }
+
+    return static_cast<u32>( unique.size() );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      再マップテーブルに従って頂点データを並べ替えます.
+//-------------------------------------------------------------------------------------------------
+template<typename T>
+void ApplyRemap( const std::vector<u32>& remap, std::vector<T>& values )
+{
+    if ( values.size() != remap.size() )
+    { return; }
+
+    std::vector<T> result( values.size() );
+    for( size_t i=0; i<values.size(); ++i )
+    { result[remap[i]] = values[i]; }
+
+    values.swap( result );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      頂点属性のハッシュ値を加算します(FNV-1a).
+//-------------------------------------------------------------------------------------------------
+template<typename T>
+void HashAttribute( const std::vector<T>& values, size_t count, u32 index, u64& hash )
+{
+    if ( values.size() != count )
+    { return; }
+
+    auto ptr = reinterpret_cast<const u8*>( &values[index] );
+    for( size_t i=0; i<sizeof(T); ++i )
+    {
+        hash ^= ptr[i];
+        hash *= 0x100000001b3ull;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      頂点属性が一致するかどうかチェックします.
+//-------------------------------------------------------------------------------------------------
+template<typename T>
+bool EqualAttribute( const std::vector<T>& values, size_t count, u32 a, u32 b )
+{
+    if ( values.size() != count )
+    { return true; }
+
+    return memcmp( &values[a], &values[b], sizeof(T) ) == 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      頂点のハッシュ値を求めます.
+//-------------------------------------------------------------------------------------------------
+u64 HashVertex( const asdx::ResMesh* pMesh, size_t count, u32 index )
+{
+    u64 hash = 0xcbf29ce484222325ull;
+    HashAttribute( pMesh->Positions,   count, index, hash );
+    HashAttribute( pMesh->Normals,     count, index, hash );
+    HashAttribute( pMesh->TexCoords,   count, index, hash );
+    HashAttribute( pMesh->BoneIndices, count, index, hash );
+    HashAttribute( pMesh->BoneWeights, count, index, hash );
+    return hash;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      頂点が一致するかどうかチェックします.
+//-------------------------------------------------------------------------------------------------
+bool EqualVertex( const asdx::ResMesh* pMesh, size_t count, u32 a, u32 b )
+{
+    return EqualAttribute( pMesh->Positions,   count, a, b )
+        && EqualAttribute( pMesh->Normals,     count, a, b )
+        && EqualAttribute( pMesh->TexCoords,   count, a, b )
+        && EqualAttribute( pMesh->BoneIndices, count, a, b )
+        && EqualAttribute( pMesh->BoneWeights, count, a, b );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      再マップテーブルに従って頂点データを詰めます.
+//-------------------------------------------------------------------------------------------------
+template<typename T>
+void CompactAttribute( const std::vector<u32>& remap, u32 uniqueCount, std::vector<T>& values )
+{
+    if ( values.size() != remap.size() )
+    { return; }
+
+    // remap[i] <= i なので前から順に上書きしてよい(重複頂点は同じ値を書き込むだけ).
+    for( size_t i=0; i<values.size(); ++i )
+    { values[remap[i]] = values[i]; }
+
+    values.resize( uniqueCount );
+    values.shrink_to_fit();
+}
+
+//-------------------------------------------------------------------------------------------------
+//      サブセットごとに処理を行います.
+//-------------------------------------------------------------------------------------------------
+template<typename Func>
+void ForEachSubset( asdx::ResMesh* pMesh, Func func )
+{
+    auto indexCount = static_cast<u32>( pMesh->VertexIndices.size() );
+    if ( indexCount == 0 )
+    { return; }
+
+    if ( pMesh->Subsets.empty() )
+    {
+        func( &pMesh->VertexIndices[0], indexCount );
+        return;
+    }
+
+    for( size_t i=0; i<pMesh->Subsets.size(); ++i )
+    {
+        const auto& subset = pMesh->Subsets[i];
+        if ( subset.Count == 0 || subset.Offset + subset.Count > indexCount )
+        { continue; }
+
+        func( &pMesh->VertexIndices[subset.Offset], subset.Count );
+    }
+
+    // 詳細度のサブセット.
+    auto lodIndexCount = static_cast<u32>( pMesh->LodIndices.size() );
+    for( size_t i=0; i<pMesh->LodSubsets.size(); ++i )
+    {
+        const auto& subset = pMesh->LodSubsets[i];
+        if ( subset.Count == 0 || subset.Offset + subset.Count > lodIndexCount )
+        { continue; }
+
+        func( &pMesh->LodIndices[subset.Offset], subset.Count );
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      頂点の並べ替えで古くなった頂点ストリームを破棄します.
+//-------------------------------------------------------------------------------------------------
+void InvalidateVertexStreams( asdx::ResMesh* pMesh )
+{
+    // 必要であれば BuildVertexStreams() で構築し直す.
+    pMesh->VertexLayout = asdx::ResVertexLayout();
+    pMesh->VertexStreams.clear();
+}
+
+} // namespace /* anonymous */
+
+
+namespace asdx {
+
+//-------------------------------------------------------------------------------------------------
+//      頂点キャッシュ効率を求めます.
+//-------------------------------------------------------------------------------------------------
+VertexCacheStatistics AnalyzeVertexCache
+(
+    const u32*  pIndices,
+    u32         indexCount,
+    u32         vertexCount,
+    u32         cacheSize
+)
+{
+    VertexCacheStatistics result = {};
+    if ( pIndices == nullptr || indexCount < 3 || vertexCount == 0 )
+    { return result; }
+
+    // 最後にキャッシュに入った時刻で FIFO を模擬する.
+    std::vector<u32> cacheTime( vertexCount, 0 );
+    u32 time  = cacheSize + 1;
+    u32 used  = 0;
+
+    for( u32 i=0; i<indexCount; ++i )
+    {
+        auto v = pIndices[i];
+        assert( v < vertexCount );
+
+        if ( cacheTime[v] == 0 )
+        { used++; }
+
+        if ( time - cacheTime[v] > cacheSize )
+        {
+            cacheTime[v] = time++;
+            result.Misses++;
+        }
+    }
+
+    result.ACMR = static_cast<f32>( result.Misses ) / static_cast<f32>( indexCount / 3 );
+    result.ATVR = ( used > 0 ) ? static_cast<f32>( result.Misses ) / static_cast<f32>( used ) : 0.0f;
+
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      頂点キャッシュ最適化を行います.
+//-------------------------------------------------------------------------------------------------
+void OptimizeVertexCache( u32* pIndices, u32 indexCount, u32 vertexCount )
+{
+    ASDX_UNUSED_VAR( vertexCount );
+
+    auto triCount = indexCount / 3;
+    if ( pIndices == nullptr || triCount < 2 )
+    { return; }
+
+    static const ForsythScore scorer;
+
+    std::vector<u32> indices;
+    auto localCount = CreateLocalIndices( pIndices, triCount * 3, indices );
+
+    // 頂点ごとの隣接三角形リスト.
+    std::vector<u32> remaining( localCount, 0 );
+    for( u32 i=0; i<triCount * 3; ++i )
+    { remaining[indices[i]]++; }
+
+    std::vector<u32> adjOffset( localCount + 1, 0 );
+    for( u32 i=0; i<localCount; ++i )
+    { adjOffset[i + 1] = adjOffset[i] + remaining[i]; }
+
+    std::vector<u32> adjTris( triCount * 3 );
+    {
+        std::vector<u32> cursor( adjOffset.begin(), adjOffset.end() - 1 );
+        for( u32 i=0; i<triCount * 3; ++i )
+        { adjTris[cursor[indices[i]]++] = i / 3; }
+    }
+
+    std::vector<u32> cachePos   ( localCount, U32_MAX );
+    std::vector<f32> vertexScore( localCount );
+    std::vector<f32> triScore   ( triCount );
+    std::vector<u8>  triAdded   ( triCount, 0 );
+
+    for( u32 i=0; i<localCount; ++i )
+    { vertexScore[i] = scorer.Calc( U32_MAX, remaining[i] ); }
+
+    auto bestTri   = 0u;
+    auto bestScore = -1.0f;
+    for( u32 i=0; i<triCount; ++i )
+    {
+        triScore[i] = vertexScore[indices[i * 3 + 0]]
+                    + vertexScore[indices[i * 3 + 1]]
+                    + vertexScore[indices[i * 3 + 2]];
+        if ( triScore[i] > bestScore )
+        {
+            bestScore = triScore[i];
+            bestTri   = i;
+        }
+    }
+
+    u32 cache   [FORSYTH_CACHE_SIZE + 3];
+    u32 newCache[FORSYTH_CACHE_SIZE + 3];
+    u32 cacheCount = 0;
+    u32 scanCursor = 0;
+
+    std::vector<u32> result( triCount * 3 );
+
+    for( u32 emitted=0; emitted<triCount; ++emitted )
+    {
+        // キャッシュ内に候補が無ければ未出力の三角形から選ぶ.
+        if ( bestTri == U32_MAX )
+        {
+            while( triAdded[scanCursor] )
+            { scanCursor++; }
+            bestTri = scanCursor;
+        }
+
+        auto tri = bestTri;
+        triAdded[tri] = 1;
+
+        const u32* pTri = &indices[tri * 3];
+        result[emitted * 3 + 0] = pIndices[tri * 3 + 0];
+        result[emitted * 3 + 1] = pIndices[tri * 3 + 1];
+        result[emitted * 3 + 2] = pIndices[tri * 3 + 2];
+
+        // 隣接リストから取り除く.
+        for( u32 k=0; k<3; ++k )
+        {
+            auto v     = pTri[k];
+            auto begin = adjOffset[v];
+            auto end   = begin + remaining[v];
+            for( auto j=begin; j<end; ++j )
+            {
+                if ( adjTris[j] == tri )
+                {
+                    std::swap( adjTris[j], adjTris[end - 1] );
+                    remaining[v]--;
+                    break;
+                }
+            }
+        }
+
+        // キャッシュを更新.
+        u32 newCount = 0;
+        newCache[newCount++] = pTri[0];
+        newCache[newCount++] = pTri[1];
+        newCache[newCount++] = pTri[2];
+        for( u32 j=0; j<cacheCount; ++j )
+        {
+            auto v = cache[j];
+            if ( v != pTri[0] && v != pTri[1] && v != pTri[2] )
+            { newCache[newCount++] = v; }
+        }
+
+        cacheCount = Min( newCount, FORSYTH_CACHE_SIZE );
+        for( u32 j=0; j<newCount; ++j )
+        {
+            auto v = newCache[j];
+            cachePos[v] = ( j < FORSYTH_CACHE_SIZE ) ? j : U32_MAX;
+            vertexScore[v] = scorer.Calc( cachePos[v], remaining[v] );
+            if ( j < FORSYTH_CACHE_SIZE )
+            { cache[j] = v; }
+        }
+
+        // スコアが変化した三角形から次の候補を選ぶ.
+        bestTri   = U32_MAX;
+        bestScore = -1.0f;
+        for( u32 j=0; j<newCount; ++j )
+        {
+            auto v     = newCache[j];
+            auto begin = adjOffset[v];
+            auto end   = begin + remaining[v];
+            for( auto a=begin; a<end; ++a )
+            {
+                auto t = adjTris[a];
+                triScore[t] = vertexScore[indices[t * 3 + 0]]
+                            + vertexScore[indices[t * 3 + 1]]
+                            + vertexScore[indices[t * 3 + 2]];
+                if ( triScore[t] > bestScore )
+                {
+                    bestScore = triScore[t];
+                    bestTri   = t;
+                }
+            }
+        }
+    }
+
+    std::copy( result.begin(), result.end(), pIndices );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      オーバードロー最適化を行います.
+//-------------------------------------------------------------------------------------------------
+void OptimizeOverdraw
+(
+    u32*            pIndices,
+    u32             indexCount,
+    const Vector3*  pPositions,
+    u32             vertexCount,
+    f32             threshold
+)
+{
+    auto triCount = indexCount / 3;
+    if ( pIndices == nullptr || pPositions == nullptr || triCount < 2 )
+    { return; }
+
+    // 全キャッシュミスする三角形をハード境界とする.
+    std::vector<u32> cacheTime( vertexCount, 0 );
+    std::vector<u32> misses( triCount );
+    u32 time  = OVERDRAW_CACHE_SIZE + 1;
+    u32 total = 0;
+
+    auto simulate = [&]( u32 tri )
+    {
+        u32 count = 0;
+        for( u32 k=0; k<3; ++k )
+        {
+            auto v = pIndices[tri * 3 + k];
+            if ( time - cacheTime[v] > OVERDRAW_CACHE_SIZE )
+            {
+                cacheTime[v] = time++;
+                count++;
+            }
+        }
+        return count;
+    };
+
+    for( u32 i=0; i<triCount; ++i )
+    {
+        misses[i] = simulate( i );
+        total += misses[i];
+    }
+
+    // ACMR が閾値以下に収まる所でソフト境界を追加.
+    auto limit = static_cast<f32>( total ) / static_cast<f32>( triCount ) * threshold;
+
+    std::vector<u32> clusters;
+    {
+        u32 clusterMisses = 0;
+        u32 clusterStart  = 0;
+
+        std::fill( cacheTime.begin(), cacheTime.end(), 0 );
+        time += OVERDRAW_CACHE_SIZE + 1;
+
+        for( u32 i=0; i<triCount; ++i )
+        {
+            if ( i == 0 || misses[i] == 3 )
+            {
+                clusters.push_back( i );
+                clusterMisses = 0;
+                clusterStart  = i;
+                time += OVERDRAW_CACHE_SIZE + 1;
+            }
+
+            clusterMisses += simulate( i );
+
+            auto acmr = static_cast<f32>( clusterMisses ) / static_cast<f32>( i - clusterStart + 1 );
+            if ( acmr <= limit && i + 1 < triCount && misses[i + 1] != 3 )
+            {
+                clusters.push_back( i + 1 );
+                clusterMisses = 0;
+                clusterStart  = i + 1;
+                time += OVERDRAW_CACHE_SIZE + 1;
+            }
+        }
+    }
+    clusters.push_back( triCount );
+
+    // 外側を向いたクラスタから描画されるように並べ替える.
+    auto clusterCount = static_cast<u32>( clusters.size() - 1 );
+
+    std::vector<Vector3> centroids( clusterCount );
+    std::vector<Vector3> normals  ( clusterCount );
+    auto meshCentroid = Vector3( 0.0f, 0.0f, 0.0f );
+    auto meshArea     = 0.0f;
+
+    for( u32 c=0; c<clusterCount; ++c )
+    {
+        auto centroid = Vector3( 0.0f, 0.0f, 0.0f );
+        auto normal   = Vector3( 0.0f, 0.0f, 0.0f );
+        auto area     = 0.0f;
+
+        for( auto i=clusters[c]; i<clusters[c + 1]; ++i )
+        {
+            const auto& p0 = pPositions[pIndices[i * 3 + 0]];
+            const auto& p1 = pPositions[pIndices[i * 3 + 1]];
+            const auto& p2 = pPositions[pIndices[i * 3 + 2]];
+
+            auto n = Vector3::Cross( p1 - p0, p2 - p0 );
+            auto a = n.Length();
+
+            centroid += ( p0 + p1 + p2 ) * ( a / 3.0f );
+            normal   += n;
+            area     += a;
+        }
+
+        meshCentroid += centroid;
+        meshArea     += area;
+
+        centroids[c] = ( area > 0.0f ) ? centroid / area : pPositions[pIndices[clusters[c] * 3]];
+        normals  [c] = normal;
+    }
+
+    if ( meshArea > 0.0f )
+    { meshCentroid /= meshArea; }
+
+    std::vector<f32> keys ( clusterCount );
+    std::vector<u32> order( clusterCount );
+    for( u32 c=0; c<clusterCount; ++c )
+    {
+        auto length = normals[c].Length();
+        keys [c] = ( length > 0.0f ) ? Vector3::Dot( centroids[c] - meshCentroid, normals[c] ) / length : 0.0f;
+        order[c] = c;
+    }
+
+    std::stable_sort( order.begin(), order.end(), [&]( u32 a, u32 b ) { return keys[a] > keys[b]; } );
+
+    std::vector<u32> result;
+    result.reserve( triCount * 3 );
+    for( u32 c=0; c<clusterCount; ++c )
+    {
+        auto begin = clusters[order[c]] * 3;
+        auto end   = clusters[order[c] + 1] * 3;
+        result.insert( result.end(), pIndices + begin, pIndices + end );
+    }
+
+    std::copy( result.begin(), result.end(), pIndices );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      頂点を初出順に並べ替える再マップテーブルを生成します.
+//-------------------------------------------------------------------------------------------------
+u32 CreateVertexFetchRemap( u32* pRemap, const u32* pIndices, u32 indexCount, u32 vertexCount )
+{
+    if ( pRemap == nullptr || vertexCount == 0 )
+    { return 0; }
+
+    for( u32 i=0; i<vertexCount; ++i )
+    { pRemap[i] = U32_MAX; }
+
+    u32 next = 0;
+    for( u32 i=0; i<indexCount; ++i )
+    {
+        auto v = pIndices[i];
+        if ( pRemap[v] == U32_MAX )
+        { pRemap[v] = next++; }
+    }
+
+    auto used = next;
+
+    for( u32 i=0; i<vertexCount; ++i )
+    {
+        if ( pRemap[i] == U32_MAX )
+        { pRemap[i] = next++; }
+    }
+
+    return used;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      サブセットごとに頂点キャッシュ最適化を行います.
+//-------------------------------------------------------------------------------------------------
+void OptimizeVertexCache( ResMesh* pMesh )
+{
+    if ( pMesh == nullptr )
+    { return; }
+
+    auto vertexCount = static_cast<u32>( pMesh->Positions.size() );
+    ForEachSubset( pMesh, [&]( u32* pIndices, u32 count )
+    { OptimizeVertexCache( pIndices, count, vertexCount ); });
+}
+
+//-------------------------------------------------------------------------------------------------
+//      サブセットごとにオーバードロー最適化を行います.
+//-------------------------------------------------------------------------------------------------
+void OptimizeOverdraw( ResMesh* pMesh, f32 threshold )
+{
+    if ( pMesh == nullptr || pMesh->Positions.empty() )
+    { return; }
+
+    auto vertexCount = static_cast<u32>( pMesh->Positions.size() );
+    ForEachSubset( pMesh, [&]( u32* pIndices, u32 count )
+    { OptimizeOverdraw( pIndices, count, &pMesh->Positions[0], vertexCount, threshold ); });
+}
+
+//-------------------------------------------------------------------------------------------------
+//      頂点データを初出順に並べ替えます.
+//-------------------------------------------------------------------------------------------------
+void OptimizeVertexFetch( ResMesh* pMesh )
+{
+    if ( pMesh == nullptr || pMesh->Positions.empty() || pMesh->VertexIndices.empty() )
+    { return; }
+
+    auto vertexCount = static_cast<u32>( pMesh->Positions.size() );
+    auto indexCount  = static_cast<u32>( pMesh->VertexIndices.size() );
+
+    std::vector<u32> remap( vertexCount );
+    CreateVertexFetchRemap( &remap[0], &pMesh->VertexIndices[0], indexCount, vertexCount );
+
+    ApplyRemap( remap, pMesh->Positions );
+    ApplyRemap( remap, pMesh->Normals );
+    ApplyRemap( remap, pMesh->TexCoords );
+    ApplyRemap( remap, pMesh->BoneIndices );
+    ApplyRemap( remap, pMesh->BoneWeights );
+
+    for( u32 i=0; i<indexCount; ++i )
+    { pMesh->VertexIndices[i] = remap[pMesh->VertexIndices[i]]; }
+
+    for( auto& index : pMesh->LodIndices )
+    { index = remap[index]; }
+
+    InvalidateVertexStreams( pMesh );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      全ての最適化を行います.
+//-------------------------------------------------------------------------------------------------
+void OptimizeMesh( ResMesh* pMesh, f32 threshold )
+{
+    OptimizeVertexCache( pMesh );
+    OptimizeOverdraw   ( pMesh, threshold );
+    OptimizeVertexFetch( pMesh );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      重複頂点を統合します.
+//-------------------------------------------------------------------------------------------------
+u32 WeldVertices( ResMesh* pMesh )
+{
+    if ( pMesh == nullptr || pMesh->Positions.empty() )
+    { return 0; }
+
+    auto count = pMesh->Positions.size();
+    auto vertexCount = static_cast<u32>( count );
+
+    // オープンアドレス法のハッシュテーブル.
+    u32 tableSize = 1;
+    while( tableSize < vertexCount * 2 )
+    { tableSize <<= 1; }
+
+    std::vector<u32> table( tableSize, U32_MAX );
+    std::vector<u32> remap( vertexCount );
+    u32 uniqueCount = 0;
+
+    for( u32 i=0; i<vertexCount; ++i )
+    {
+        auto slot = static_cast<u32>( HashVertex( pMesh, count, i ) ) & ( tableSize - 1 );
+        for( ;; )
+        {
+            auto v = table[slot];
+            if ( v == U32_MAX )
+            {
+                table[slot] = i;
+                remap[i] = uniqueCount++;
+                break;
+            }
+
+            if ( EqualVertex( pMesh, count, v, i ) )
+            {
+                remap[i] = remap[v];
+                break;
+            }
+
+            slot = ( slot + 1 ) & ( tableSize - 1 );
+        }
+    }
+
+    if ( uniqueCount == vertexCount )
+    { return 0; }
+
+    CompactAttribute( remap, uniqueCount, pMesh->Positions );
+    CompactAttribute( remap, uniqueCount, pMesh->Normals );
+    CompactAttribute( remap, uniqueCount, pMesh->TexCoords );
+    CompactAttribute( remap, uniqueCount, pMesh->BoneIndices );
+    CompactAttribute( remap, uniqueCount, pMesh->BoneWeights );
+
+    for( auto& index : pMesh->VertexIndices )
+    { index = remap[index]; }
+
+    for( auto& index : pMesh->LodIndices )
+    { index = remap[index]; }
+
+    InvalidateVertexStreams( pMesh );
+
+    return vertexCount - uniqueCount;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      インデックスを 16bit に詰めます.
+//-------------------------------------------------------------------------------------------------
+void PackIndices( const ResMesh* pMesh, PackedIndices* pResult )
+{
+    if ( pMesh == nullptr || pResult == nullptr )
+    { return; }
+
+    pResult->Use16Bit = false;
+    pResult->Indices16.clear();
+    pResult->Indices32.clear();
+    pResult->Subsets  .clear();
+    pResult->Levels   .clear();
+
+    auto baseCount = static_cast<u32>( pMesh->VertexIndices.size() );
+    if ( baseCount == 0 )
+    { return; }
+
+    std::vector<ResSubset> subsets = pMesh->Subsets;
+    if ( subsets.empty() )
+    {
+        ResSubset subset = { 0, 0, baseCount };
+        subsets.push_back( subset );
+    }
+
+    // 詳細度のインデックスを元メッシュの後ろに連結する.
+    std::vector<u32> indices = pMesh->VertexIndices;
+    indices.insert( indices.end(), pMesh->LodIndices.begin(), pMesh->LodIndices.end() );
+    auto indexCount = static_cast<u32>( indices.size() );
+
+    std::vector<u32> levels;
+    levels.push_back( 0 );
+    for( const auto& lod : pMesh->Lods )
+    {
+        levels.push_back( static_cast<u32>( subsets.size() ) );
+        for( auto i=lod.SubsetOffset; i<lod.SubsetOffset + lod.SubsetCount && i<pMesh->LodSubsets.size(); ++i )
+        {
+            auto subset = pMesh->LodSubsets[i];
+            subset.Offset += baseCount;
+            subsets.push_back( subset );
+        }
+    }
+    levels.push_back( static_cast<u32>( subsets.size() ) );
+
+    // 参照範囲が 16bit に収まるように三角形単位で分割.
+    auto use16Bit = true;
+    auto level    = 0u;
+    for( size_t i=0; i<subsets.size() && use16Bit; ++i )
+    {
+        while( levels[level] <= i )
+        {
+            pResult->Levels.push_back( static_cast<u32>( pResult->Subsets.size() ) );
+            level++;
+        }
+
+        auto begin = subsets[i].Offset;
+        auto end   = Min( subsets[i].Offset + subsets[i].Count, indexCount );
+
+        auto cursor = begin;
+        while( cursor < end )
+        {
+            auto chunkBegin = cursor;
+            auto minIndex   = U32_MAX;
+            auto maxIndex   = 0u;
+
+            while( cursor < end )
+            {
+                auto stride  = Min( 3u, end - cursor );
+                auto triMin  = minIndex;
+                auto triMax  = maxIndex;
+                for( u32 k=0; k<stride; ++k )
+                {
+                    triMin = Min( triMin, indices[cursor + k] );
+                    triMax = Max( triMax, indices[cursor + k] );
+                }
+
+                if ( triMax - triMin > INDEX16_RANGE )
+                { break; }
+
+                minIndex = triMin;
+                maxIndex = triMax;
+                cursor  += stride;
+            }
+
+            // 1つの三角形でも収まらない場合は 32bit とする.
+            if ( cursor == chunkBegin )
+            {
+                use16Bit = false;
+                break;
+            }
+
+            PackedSubset packed = { subsets[i].MaterialId, chunkBegin, cursor - chunkBegin, minIndex };
+            pResult->Subsets.push_back( packed );
+        }
+    }
+
+    if ( !use16Bit )
+    {
+        pResult->Subsets.clear();
+        for( size_t i=0; i<subsets.size(); ++i )
+        {
+            PackedSubset packed = { subsets[i].MaterialId, subsets[i].Offset, subsets[i].Count, 0 };
+            pResult->Subsets.push_back( packed );
+        }
+
+        pResult->Levels    = levels;
+        pResult->Indices32 = indices;
+        return;
+    }
+
+    // 空の詳細度が末尾にある場合も要素数を揃える.
+    while( level < levels.size() )
+    {
+        pResult->Levels.push_back( static_cast<u32>( pResult->Subsets.size() ) );
+        level++;
+    }
+
+    pResult->Use16Bit = true;
+    pResult->Indices16.resize( indexCount, 0 );
+    for( size_t i=0; i<pResult->Subsets.size(); ++i )
+    {
+        const auto& packed = pResult->Subsets[i];
+        for( auto j=packed.Offset; j<packed.Offset + packed.Count; ++j )
+        { pResult->Indices16[j] = static_cast<u16>( indices[j] - packed.BaseVertex ); }
+    }
+}
+
+} // namespace asdx
@@ -0,0 +1,264 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxMeshQuantizer.cpp
+// Desc : Vertex Quantization Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxMeshQuantizer.h>
+#include <cstring>
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------------
+//      [-32767, 32767] に収まるよう 16bit snorm に変換します.
+//-------------------------------------------------------------------------------------------------
+inline s16 ToSnorm16( f32 value )
+{ return static_cast<s16>( asdx::Clamp( value, -32767.0f, 32767.0f ) ); }
+
+//-------------------------------------------------------------------------------------------------
+//      符号を取得します(0 は正として扱います).
+//-------------------------------------------------------------------------------------------------
+inline f32 SignNotZero( f32 value )
+{ return ( value >= 0.0f ) ? 1.0f : -1.0f; }
+
+} // namespace /* anonymous */
+
+
+namespace asdx {
+
+//-------------------------------------------------------------------------------------------------
+//      位置座標の量子化パラメータを求めます.
+//-------------------------------------------------------------------------------------------------
+PositionQuantization ComputePositionQuantization( const Vector3* pPositions, u32 count )
+{
+    PositionQuantization result;
+    result.Scale  = Vector3( 1.0f, 1.0f, 1.0f );
+    result.Offset = Vector3( 0.0f, 0.0f, 0.0f );
+
+    if ( pPositions == nullptr || count == 0 )
+    { return result; }
+
+    auto mini = pPositions[0];
+    auto maxi = pPositions[0];
+    for( u32 i=1; i<count; ++i )
+    {
+        mini = Vector3::Min( mini, pPositions[i] );
+        maxi = Vector3::Max( maxi, pPositions[i] );
+    }
+
+    // 幅がゼロの軸は 0 除算を避けるためスケールを 1 とする.
+    auto size = maxi - mini;
+    result.Scale.x = ( size.x > 0.0f ) ? size.x : 1.0f;
+    result.Scale.y = ( size.y > 0.0f ) ? size.y : 1.0f;
+    result.Scale.z = ( size.z > 0.0f ) ? size.z : 1.0f;
+    result.Offset  = mini;
+
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      位置座標を量子化します.
+//-------------------------------------------------------------------------------------------------
+void QuantizePosition( const Vector3& value, const PositionQuantization& param, u16* pResult )
+{
+    auto x = ( value.x - param.Offset.x ) / param.Scale.x;
+    auto y = ( value.y - param.Offset.y ) / param.Scale.y;
+    auto z = ( value.z - param.Offset.z ) / param.Scale.z;
+
+    pResult[0] = static_cast<u16>( Saturate( x ) * 65535.0f + 0.5f );
+    pResult[1] = static_cast<u16>( Saturate( y ) * 65535.0f + 0.5f );
+    pResult[2] = static_cast<u16>( Saturate( z ) * 65535.0f + 0.5f );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      位置座標を復元します.
+//-------------------------------------------------------------------------------------------------
+Vector3 DequantizePosition( const u16* pValue, const PositionQuantization& param )
+{
+    return Vector3(
+        f32( pValue[0] ) / 65535.0f * param.Scale.x + param.Offset.x,
+        f32( pValue[1] ) / 65535.0f * param.Scale.y + param.Offset.y,
+        f32( pValue[2] ) / 65535.0f * param.Scale.z + param.Offset.z );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      八面体表現に変換します.
+//-------------------------------------------------------------------------------------------------
+void EncodeOctahedral( const Vector3& value, s16* pResult )
+{
+    auto l1 = fabsf( value.x ) + fabsf( value.y ) + fabsf( value.z );
+    if ( l1 <= F_EPSILON )
+    {
+        pResult[0] = 0;
+        pResult[1] = 0;
+        return;
+    }
+
+    auto x = value.x / l1;
+    auto y = value.y / l1;
+    if ( value.z < 0.0f )
+    {
+        auto tx = ( 1.0f - fabsf( y ) ) * SignNotZero( x );
+        auto ty = ( 1.0f - fabsf( x ) ) * SignNotZero( y );
+        x = tx;
+        y = ty;
+    }
+
+    // 切り捨て/切り上げの組み合わせから最も誤差の小さいものを選ぶ.
+    auto n = Vector3::Normalize( value );
+    auto fx = floorf( Clamp( x, -1.0f, 1.0f ) * 32767.0f );
+    auto fy = floorf( Clamp( y, -1.0f, 1.0f ) * 32767.0f );
+
+    auto best = -2.0f;
+    for( u32 i=0; i<4; ++i )
+    {
+        s16 candidate[2] = {
+            ToSnorm16( fx + f32( i & 0x1 ) ),
+            ToSnorm16( fy + f32( i >> 1  ) )
+        };
+
+        auto dot = Vector3::Dot( DecodeOctahedral( candidate ), n );
+        if ( dot > best )
+        {
+            best = dot;
+            pResult[0] = candidate[0];
+            pResult[1] = candidate[1];
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      八面体表現から復元します.
+//-------------------------------------------------------------------------------------------------
+Vector3 DecodeOctahedral( const s16* pValue )
+{
+    auto x = Max( f32( pValue[0] ) / 32767.0f, -1.0f );
+    auto y = Max( f32( pValue[1] ) / 32767.0f, -1.0f );
+    auto z = 1.0f - fabsf( x ) - fabsf( y );
+
+    if ( z < 0.0f )
+    {
+        auto tx = ( 1.0f - fabsf( y ) ) * SignNotZero( x );
+        auto ty = ( 1.0f - fabsf( x ) ) * SignNotZero( y );
+        x = tx;
+        y = ty;
+    }
+
+    return Vector3::Normalize( Vector3( x, y, z ) );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      半精度浮動小数に変換します.
+//-------------------------------------------------------------------------------------------------
+f16 EncodeHalf( f32 value )
+{
+    u32 bits;
+    memcpy( &bits, &value, sizeof(bits) );
+
+    auto sign     = ( bits >> 16 ) & 0x8000;
+    auto exponent = static_cast<s32>( ( bits >> 23 ) & 0xff ) - 127 + 15;
+    auto mantissa = bits & 0x7fffff;
+
+    // 無限大と非数.
+    if ( ( ( bits >> 23 ) & 0xff ) == 0xff )
+    { return static_cast<f16>( sign | 0x7c00 | ( mantissa ? 0x200 : 0 ) ); }
+
+    // オーバーフロー.
+    if ( exponent >= 31 )
+    { return static_cast<f16>( sign | 0x7c00 ); }
+
+    // 非正規化数またはアンダーフロー.
+    if ( exponent <= 0 )
+    {
+        if ( exponent < -10 )
+        { return static_cast<f16>( sign ); }
+
+        mantissa |= 0x800000;
+        auto shift = static_cast<u32>( 14 - exponent );
+        auto half  = mantissa >> shift;
+        auto rest  = mantissa & ( ( 1u << shift ) - 1 );
+        auto mid   = 1u << ( shift - 1 );
+        if ( rest > mid || ( rest == mid && ( half & 0x1 ) ) )
+        { half++; }
+
+        return static_cast<f16>( sign | half );
+    }
+
+    // 正規化数(最近接偶数丸め. 繰り上がりは指数部へ伝搬する).
+    auto half = ( static_cast<u32>( exponent ) << 10 ) | ( mantissa >> 13 );
+    auto rest = mantissa & 0x1fff;
+    if ( rest > 0x1000 || ( rest == 0x1000 && ( half & 0x1 ) ) )
+    { half++; }
+
+    return static_cast<f16>( sign | half );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      単精度浮動小数に変換します.
+//-------------------------------------------------------------------------------------------------
+f32 DecodeHalf( f16 value )
+{
+    auto sign     = static_cast<u32>( value & 0x8000 ) << 16;
+    auto exponent = static_cast<u32>( value >> 10 ) & 0x1f;
+    auto mantissa = static_cast<u32>( value & 0x3ff );
+
+    u32 bits;
+    if ( exponent == 0 )
+    {
+        if ( mantissa == 0 )
+        { bits = sign; }
+        else
+        {
+            // 非正規化数を正規化.
+            exponent = 127 - 15 + 1;
+            while( ( mantissa & 0x400 ) == 0 )
+            {
+                mantissa <<= 1;
+                exponent--;
+            }
+            bits = sign | ( exponent << 23 ) | ( ( mantissa & 0x3ff ) << 13 );
+        }
+    }
+    else if ( exponent == 0x1f )
+    { bits = sign | 0x7f800000 | ( mantissa << 13 ); }
+    else
+    { bits = sign | ( ( exponent + 127 - 15 ) << 23 ) | ( mantissa << 13 ); }
+
+    f32 result;
+    memcpy( &result, &bits, sizeof(result) );
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ボーンの重みを量子化します.
+//-------------------------------------------------------------------------------------------------
+void QuantizeBoneWeights( const f32* pWeights, u32 count, u8* pResult )
+{
+    count = Min( count, 4u );
+    if ( pWeights == nullptr || pResult == nullptr || count == 0 )
+    { return; }
+
+    auto sum     = 0.0f;
+    auto total   = 0;
+    u32  largest = 0;
+    for( u32 i=0; i<count; ++i )
+    {
+        auto w = Saturate( pWeights[i] );
+        pResult[i] = static_cast<u8>( w * 255.0f + 0.5f );
+
+        sum   += w;
+        total += pResult[i];
+        if ( pWeights[i] > pWeights[largest] )
+        { largest = i; }
+    }
+
+    auto target = static_cast<s32>( Saturate( sum ) * 255.0f + 0.5f );
+    auto value  = static_cast<s32>( pResult[largest] ) + ( target - total );
+    pResult[largest] = static_cast<u8>( Clamp( value, 0, 255 ) );
+}
+
+} // namespace asdx
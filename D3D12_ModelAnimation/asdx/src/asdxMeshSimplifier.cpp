@@ -0,0 +1,740 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxMeshSimplifier.cpp
+// Desc : Mesh Simplifier Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxMeshSimplifier.h>
+#include <asdxResMesh.h>
+#include <algorithm>
+#include <vector>
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------------
+// Constant Values.
+//-------------------------------------------------------------------------------------------------
+static const u8  VERTEX_KIND_MANIFOLD   = 0;        // 自由に縮約できる頂点です.
+static const u8  VERTEX_KIND_BORDER     = 1;        // 境界辺に沿ってのみ縮約できる頂点です.
+static const u8  VERTEX_KIND_LOCKED     = 2;        // 縮約しない頂点です.
+static const f64 BORDER_WEIGHT          = 10.0;     // 境界を保持するための重みです.
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Quadric structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct Quadric
+{
+    f64     A00, A11, A22;      //!< 対称行列の対角成分です.
+    f64     A01, A02, A12;      //!< 対称行列の非対角成分です.
+    f64     B0, B1, B2;         //!< 一次の項です.
+    f64     C;                  //!< 定数項です.
+    f64     Weight;             //!< 面積の重みです.
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Collapse structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct Collapse
+{
+    u32     Source;     //!< 縮約元の頂点です.
+    u32     Target;     //!< 縮約先の頂点です.
+    f64     Cost;       //!< 縮約による誤差(距離の二乗)です.
+};
+
+//-------------------------------------------------------------------------------------------------
+//      平面から二次誤差を加算します.
+//-------------------------------------------------------------------------------------------------
+void AddPlane( Quadric& q, f64 nx, f64 ny, f64 nz, f64 d, f64 scale, f64 weight )
+{
+    q.A00 += scale * nx * nx;
+    q.A11 += scale * ny * ny;
+    q.A22 += scale * nz * nz;
+    q.A01 += scale * nx * ny;
+    q.A02 += scale * nx * nz;
+    q.A12 += scale * ny * nz;
+    q.B0  += scale * nx * d;
+    q.B1  += scale * ny * d;
+    q.B2  += scale * nz * d;
+    q.C   += scale * d  * d;
+    q.Weight += weight;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      二次誤差を加算します.
+//-------------------------------------------------------------------------------------------------
+void AddQuadric( Quadric& q, const Quadric& r )
+{
+    q.A00 += r.A00; q.A11 += r.A11; q.A22 += r.A22;
+    q.A01 += r.A01; q.A02 += r.A02; q.A12 += r.A12;
+    q.B0  += r.B0;  q.B1  += r.B1;  q.B2  += r.B2;
+    q.C   += r.C;
+    q.Weight += r.Weight;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      二次誤差を評価します.
+//-------------------------------------------------------------------------------------------------
+f64 EvalQuadric( const Quadric& q, const asdx::Vector3& p )
+{
+    f64 x = p.x;
+    f64 y = p.y;
+    f64 z = p.z;
+
+    auto r = q.A00 * x * x + q.A11 * y * y + q.A22 * z * z
+           + 2.0 * ( q.A01 * x * y + q.A02 * x * z + q.A12 * y * z )
+           + 2.0 * ( q.B0 * x + q.B1 * y + q.B2 * z )
+           + q.C;
+
+    return fabs( r ) / asdx::Max( q.Weight, 1e-12 );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      辺のキーを生成します.
+//-------------------------------------------------------------------------------------------------
+inline u64 EdgeKey( u32 a, u32 b )
+{ return ( a < b ) ? ( u64(a) << 32 ) | b : ( u64(b) << 32 ) | a; }
+
+//-------------------------------------------------------------------------------------------------
+//      位置が一致する頂点を同じ番号にまとめます.
+//-------------------------------------------------------------------------------------------------
+void CreatePositionRemap
+(
+    const std::vector<asdx::Vector3>&   positions,
+    std::vector<u32>&                   posId,
+    std::vector<u32>&                   wedgeCount
+)
+{
+    auto count = static_cast<u32>( positions.size() );
+
+    std::vector<u32> order( count );
+    for( u32 i=0; i<count; ++i )
+    { order[i] = i; }
+
+    auto less = [&]( u32 a, u32 b )
+    {
+        const auto& pa = positions[a];
+        const auto& pb = positions[b];
+        if ( pa.x != pb.x ) return pa.x < pb.x;
+        if ( pa.y != pb.y ) return pa.y < pb.y;
+        if ( pa.z != pb.z ) return pa.z < pb.z;
+        return a < b;
+    };
+    std::sort( order.begin(), order.end(), less );
+
+    posId     .resize( count );
+    wedgeCount.assign( count, 0 );
+
+    for( u32 i=0; i<count; )
+    {
+        auto j = i + 1;
+        while( j < count
+            && positions[order[j]].x == positions[order[i]].x
+            && positions[order[j]].y == positions[order[i]].y
+            && positions[order[j]].z == positions[order[i]].z )
+        { j++; }
+
+        for( auto k=i; k<j; ++k )
+        { posId[order[k]] = order[i]; }
+
+        wedgeCount[order[i]] = j - i;
+        i = j;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      最大の重みを持つボーン番号を求めます.
+//-------------------------------------------------------------------------------------------------
+u32 GetDominantBone( const asdx::uint4& indices, const asdx::Vector4& weights )
+{
+    const f32 w[4] = { weights.x, weights.y, weights.z, weights.w };
+
+    u32 best = 0;
+    for( u32 i=1; i<4; ++i )
+    {
+        if ( w[i] > w[best] )
+        { best = i; }
+    }
+
+    return indices.data[best];
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Simplifier class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class Simplifier
+{
+public:
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    Simplifier( const asdx::ResMesh* pMesh, const u32* pIndices, const u32* pGroups, u32 indexCount, u32 flags )
+    : m_pMesh( pMesh )
+    {
+        auto triCount    = indexCount / 3;
+        auto vertexCount = static_cast<u32>( pMesh->Positions.size() );
+
+        m_Indices.assign( pIndices, pIndices + triCount * 3 );
+        m_Groups .resize( triCount, 0 );
+        if ( pGroups != nullptr )
+        { m_Groups.assign( pGroups, pGroups + triCount ); }
+
+        ClassifyVertices( vertexCount, flags );
+        ComputeQuadrics ( vertexCount );
+
+        // スキニング情報.
+        if ( pMesh->BoneIndices.size() == vertexCount && pMesh->BoneWeights.size() == vertexCount )
+        {
+            m_DominantBone.resize( vertexCount );
+            for( u32 i=0; i<vertexCount; ++i )
+            { m_DominantBone[i] = GetDominantBone( pMesh->BoneIndices[i], pMesh->BoneWeights[i] ); }
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      簡略化を行います.
+    //---------------------------------------------------------------------------------------------
+    f64 Simplify( u32 targetIndexCount, f64 maxCost )
+    {
+        auto vertexCount = static_cast<u32>( m_pMesh->Positions.size() );
+        auto result      = 0.0;
+
+        std::vector<u32>        remap ( vertexCount );
+        std::vector<u8>         locked( vertexCount );
+        std::vector<u64>        edges;
+        std::vector<Collapse>   collapses;
+
+        while( m_Indices.size() > targetIndexCount )
+        {
+            auto triCount = static_cast<u32>( m_Indices.size() / 3 );
+            BuildAdjacency( vertexCount );
+
+            // 縮約候補を列挙.
+            edges.clear();
+            for( u32 i=0; i<triCount * 3; i+=3 )
+            {
+                edges.push_back( EdgeKey( m_Indices[i + 0], m_Indices[i + 1] ) );
+                edges.push_back( EdgeKey( m_Indices[i + 1], m_Indices[i + 2] ) );
+                edges.push_back( EdgeKey( m_Indices[i + 2], m_Indices[i + 0] ) );
+            }
+            std::sort( edges.begin(), edges.end() );
+            edges.erase( std::unique( edges.begin(), edges.end() ), edges.end() );
+
+            collapses.clear();
+            for( auto key : edges )
+            {
+                auto a = static_cast<u32>( key >> 32 );
+                auto b = static_cast<u32>( key & 0xffffffff );
+
+                auto costAB = CalcCost( a, b );
+                auto costBA = CalcCost( b, a );
+                if ( costAB < 0.0 && costBA < 0.0 )
+                { continue; }
+
+                Collapse c;
+                if ( costBA < 0.0 || ( costAB >= 0.0 && costAB <= costBA ) )
+                {
+                    c.Source = a;
+                    c.Target = b;
+                    c.Cost   = costAB;
+                }
+                else
+                {
+                    c.Source = b;
+                    c.Target = a;
+                    c.Cost   = costBA;
+                }
+
+                if ( c.Cost <= maxCost )
+                { collapses.push_back( c ); }
+            }
+
+            if ( collapses.empty() )
+            { break; }
+
+            std::sort( collapses.begin(), collapses.end(),
+                []( const Collapse& l, const Collapse& r ) { return l.Cost < r.Cost; } );
+
+            // 1パスで同じ頂点に関わる縮約は1回のみ行う.
+            for( u32 i=0; i<vertexCount; ++i )
+            { remap[i] = i; }
+            std::fill( locked.begin(), locked.end(), 0 );
+
+            auto goal    = triCount - targetIndexCount / 3;
+            auto removed = 0u;
+            auto applied = 0u;
+
+            for( const auto& c : collapses )
+            {
+                if ( removed >= goal )
+                { break; }
+
+                if ( locked[c.Source] || locked[c.Target] )
+                { continue; }
+
+                u32 degenerate = 0;
+                if ( IsFlipped( c.Source, c.Target, remap, degenerate ) )
+                { continue; }
+
+                remap [c.Source] = c.Target;
+                locked[c.Source] = 1;
+                locked[c.Target] = 1;
+                AddQuadric( m_Quadrics[c.Target], m_Quadrics[c.Source] );
+
+                result   = asdx::Max( result, c.Cost );
+                removed += degenerate;
+                applied++;
+            }
+
+            if ( applied == 0 )
+            { break; }
+
+            // 縮約を反映し, 縮退した三角形を取り除く.
+            u32 count = 0;
+            for( u32 i=0; i<triCount; ++i )
+            {
+                auto a = remap[m_Indices[i * 3 + 0]];
+                auto b = remap[m_Indices[i * 3 + 1]];
+                auto c = remap[m_Indices[i * 3 + 2]];
+                if ( a == b || b == c || c == a )
+                { continue; }
+
+                m_Indices[count * 3 + 0] = a;
+                m_Indices[count * 3 + 1] = b;
+                m_Indices[count * 3 + 2] = c;
+                m_Groups [count] = m_Groups[i];
+                count++;
+            }
+
+            m_Indices.resize( count * 3 );
+            m_Groups .resize( count );
+        }
+
+        return sqrt( result );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      インデックスを取得します.
+    //---------------------------------------------------------------------------------------------
+    const std::vector<u32>& GetIndices() const
+    { return m_Indices; }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      グループ番号を取得します.
+    //---------------------------------------------------------------------------------------------
+    const std::vector<u32>& GetGroups() const
+    { return m_Groups; }
+
+private:
+    const asdx::ResMesh*    m_pMesh;            //!< メッシュです.
+    std::vector<u32>        m_Indices;          //!< インデックスです.
+    std::vector<u32>        m_Groups;           //!< 三角形ごとのグループ番号です.
+    std::vector<u32>        m_PosId;            //!< 位置が一致する代表頂点番号です.
+    std::vector<u8>         m_Kind;             //!< 頂点の種類です.
+    std::vector<u64>        m_BorderEdges;      //!< 境界辺です(ソート済み).
+    std::vector<Quadric>    m_Quadrics;         //!< 頂点ごとの二次誤差です.
+    std::vector<u32>        m_DominantBone;     //!< 頂点ごとの最大重みのボーン番号です.
+    std::vector<u32>        m_AdjOffset;        //!< 隣接三角形リストのオフセットです.
+    std::vector<u32>        m_AdjTris;          //!< 隣接三角形リストです.
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      頂点を分類します.
+    //---------------------------------------------------------------------------------------------
+    void ClassifyVertices( u32 vertexCount, u32 flags )
+    {
+        std::vector<u32> wedgeCount;
+        CreatePositionRemap( m_pMesh->Positions, m_PosId, wedgeCount );
+
+        struct Edge
+        {
+            u64 Key;
+            u32 Group;
+        };
+
+        auto triCount = static_cast<u32>( m_Groups.size() );
+
+        std::vector<Edge> edges;
+        edges.reserve( triCount * 3 );
+        for( u32 i=0; i<triCount; ++i )
+        {
+            for( u32 k=0; k<3; ++k )
+            {
+                auto a = m_PosId[m_Indices[i * 3 + k]];
+                auto b = m_PosId[m_Indices[i * 3 + ( k + 1 ) % 3]];
+                Edge e = { EdgeKey( a, b ), m_Groups[i] };
+                edges.push_back( e );
+            }
+        }
+        std::sort( edges.begin(), edges.end(), []( const Edge& l, const Edge& r ) { return l.Key < r.Key; } );
+
+        std::vector<u8> posKind( vertexCount, VERTEX_KIND_MANIFOLD );
+        auto mark = [&]( u64 key, u8 kind )
+        {
+            auto a = static_cast<u32>( key >> 32 );
+            auto b = static_cast<u32>( key & 0xffffffff );
+            posKind[a] = asdx::Max( posKind[a], kind );
+            posKind[b] = asdx::Max( posKind[b], kind );
+        };
+
+        for( size_t i=0; i<edges.size(); )
+        {
+            auto j = i + 1;
+            auto mixed = false;
+            while( j < edges.size() && edges[j].Key == edges[i].Key )
+            {
+                mixed |= ( edges[j].Group != edges[i].Group );
+                j++;
+            }
+
+            auto count = j - i;
+            if ( count > 2 )
+            {
+                // 非多様体辺は固定.
+                mark( edges[i].Key, VERTEX_KIND_LOCKED );
+            }
+            else if ( count == 1 || mixed )
+            {
+                // 開いた辺とサブセット境界.
+                mark( edges[i].Key, VERTEX_KIND_BORDER );
+                m_BorderEdges.push_back( edges[i].Key );
+            }
+
+            i = j;
+        }
+
+        m_Kind.resize( vertexCount );
+        for( u32 i=0; i<vertexCount; ++i )
+        {
+            auto p = m_PosId[i];
+            auto kind = posKind[p];
+
+            // UVシームや法線の分割がある頂点は固定.
+            if ( wedgeCount[p] > 1 )
+            { kind = VERTEX_KIND_LOCKED; }
+
+            if ( kind == VERTEX_KIND_BORDER && ( flags & asdx::SIMPLIFY_FLAG_LOCK_BORDER ) )
+            { kind = VERTEX_KIND_LOCKED; }
+
+            m_Kind[i] = kind;
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      二次誤差を計算します.
+    //---------------------------------------------------------------------------------------------
+    void ComputeQuadrics( u32 vertexCount )
+    {
+        const auto& positions = m_pMesh->Positions;
+
+        m_Quadrics.assign( vertexCount, Quadric() );
+
+        auto triCount = static_cast<u32>( m_Groups.size() );
+        for( u32 i=0; i<triCount; ++i )
+        {
+            u32 idx[3] = { m_Indices[i * 3 + 0], m_Indices[i * 3 + 1], m_Indices[i * 3 + 2] };
+
+            const auto& p0 = positions[idx[0]];
+            const auto& p1 = positions[idx[1]];
+            const auto& p2 = positions[idx[2]];
+
+            auto n = asdx::Vector3::Cross( p1 - p0, p2 - p0 );
+            auto length = n.Length();
+            if ( length <= asdx::F_EPSILON )
+            { continue; }
+
+            n /= length;
+            auto area = f64( length ) * 0.5;
+            auto d    = -f64( asdx::Vector3::Dot( n, p0 ) );
+
+            for( u32 k=0; k<3; ++k )
+            { AddPlane( m_Quadrics[idx[k]], n.x, n.y, n.z, d, area, area ); }
+
+            // 境界辺には面に垂直な平面を加えて形状を保持する.
+            for( u32 k=0; k<3; ++k )
+            {
+                auto a = idx[k];
+                auto b = idx[( k + 1 ) % 3];
+                if ( !IsBorderEdge( a, b ) )
+                { continue; }
+
+                auto e  = positions[b] - positions[a];
+                auto en = asdx::Vector3::Cross( e, n );
+                auto el = en.Length();
+                if ( el <= asdx::F_EPSILON )
+                { continue; }
+
+                en /= el;
+                auto ed = -f64( asdx::Vector3::Dot( en, positions[a] ) );
+                auto ew = f64( e.LengthSq() ) * BORDER_WEIGHT;
+
+                AddPlane( m_Quadrics[a], en.x, en.y, en.z, ed, ew, 0.0 );
+                AddPlane( m_Quadrics[b], en.x, en.y, en.z, ed, ew, 0.0 );
+            }
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      境界辺かどうかチェックします.
+    //---------------------------------------------------------------------------------------------
+    bool IsBorderEdge( u32 a, u32 b ) const
+    {
+        auto key = EdgeKey( m_PosId[a], m_PosId[b] );
+        return std::binary_search( m_BorderEdges.begin(), m_BorderEdges.end(), key );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      隣接三角形リストを構築します.
+    //---------------------------------------------------------------------------------------------
+    void BuildAdjacency( u32 vertexCount )
+    {
+        auto indexCount = static_cast<u32>( m_Indices.size() );
+
+        m_AdjOffset.assign( vertexCount + 1, 0 );
+        for( u32 i=0; i<indexCount; ++i )
+        { m_AdjOffset[m_Indices[i] + 1]++; }
+
+        for( u32 i=0; i<vertexCount; ++i )
+        { m_AdjOffset[i + 1] += m_AdjOffset[i]; }
+
+        m_AdjTris.resize( indexCount );
+        std::vector<u32> cursor( m_AdjOffset.begin(), m_AdjOffset.end() - 1 );
+        for( u32 i=0; i<indexCount; ++i )
+        { m_AdjTris[cursor[m_Indices[i]]++] = i / 3; }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      縮約コストを求めます. 縮約できない場合は負値を返却します.
+    //---------------------------------------------------------------------------------------------
+    f64 CalcCost( u32 source, u32 target ) const
+    {
+        auto kind = m_Kind[source];
+        if ( kind == VERTEX_KIND_LOCKED )
+        { return -1.0; }
+
+        if ( kind == VERTEX_KIND_BORDER && !IsBorderEdge( source, target ) )
+        { return -1.0; }
+
+        if ( !m_DominantBone.empty() && m_DominantBone[source] != m_DominantBone[target] )
+        { return -1.0; }
+
+        // 縮約後の頂点は両端の二次誤差の和を持つため, 和を縮約先の位置で評価する.
+        auto q = m_Quadrics[source];
+        AddQuadric( q, m_Quadrics[target] );
+        return EvalQuadric( q, m_pMesh->Positions[target] );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      縮約により三角形が裏返るかどうかチェックします.
+    //---------------------------------------------------------------------------------------------
+    bool IsFlipped( u32 source, u32 target, const std::vector<u32>& remap, u32& degenerate ) const
+    {
+        const auto& positions = m_pMesh->Positions;
+
+        degenerate = 0;
+        for( auto i=m_AdjOffset[source]; i<m_AdjOffset[source + 1]; ++i )
+        {
+            auto tri = m_AdjTris[i];
+            u32 idx[3] = {
+                remap[m_Indices[tri * 3 + 0]],
+                remap[m_Indices[tri * 3 + 1]],
+                remap[m_Indices[tri * 3 + 2]]
+            };
+
+            if ( idx[0] == target || idx[1] == target || idx[2] == target )
+            {
+                degenerate++;
+                continue;
+            }
+
+            if ( idx[0] == idx[1] || idx[1] == idx[2] || idx[2] == idx[0] )
+            { continue; }
+
+            const auto& p0 = positions[idx[0]];
+            const auto& p1 = positions[idx[1]];
+            const auto& p2 = positions[idx[2]];
+            auto n0 = asdx::Vector3::Cross( p1 - p0, p2 - p0 );
+
+            const auto& q0 = positions[( idx[0] == source ) ? target : idx[0]];
+            const auto& q1 = positions[( idx[1] == source ) ? target : idx[1]];
+            const auto& q2 = positions[( idx[2] == source ) ? target : idx[2]];
+            auto n1 = asdx::Vector3::Cross( q1 - q0, q2 - q0 );
+
+            if ( asdx::Vector3::Dot( n0, n1 ) <= 0.0f )
+            { return true; }
+        }
+
+        return false;
+    }
+};
+
+} // namespace /* anonymous */
+
+
+namespace asdx {
+
+//-------------------------------------------------------------------------------------------------
+//      インデックスを簡略化します.
+//-------------------------------------------------------------------------------------------------
+u32 SimplifyIndices
+(
+    const ResMesh*  pMesh,
+    const u32*      pIndices,
+    const u32*      pGroups,
+    u32             indexCount,
+    u32             targetIndexCount,
+    f32             targetError,
+    u32             flags,
+    u32*            pResult,
+    u32*            pResultGroups,
+    f32*            pResultError
+)
+{
+    if ( pResultError != nullptr )
+    { *pResultError = 0.0f; }
+
+    if ( pMesh == nullptr || pIndices == nullptr || pResult == nullptr || pMesh->Positions.empty() )
+    { return 0; }
+
+    Simplifier simplifier( pMesh, pIndices, pGroups, indexCount, flags );
+
+    auto maxCost = f64( targetError ) * f64( targetError );
+    auto error   = simplifier.Simplify( targetIndexCount, maxCost );
+
+    const auto& indices = simplifier.GetIndices();
+    const auto& groups  = simplifier.GetGroups();
+
+    std::copy( indices.begin(), indices.end(), pResult );
+    if ( pResultGroups != nullptr )
+    { std::copy( groups.begin(), groups.end(), pResultGroups ); }
+
+    if ( pResultError != nullptr )
+    { *pResultError = static_cast<f32>( error ); }
+
+    return static_cast<u32>( indices.size() );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      詳細度を生成します.
+//-------------------------------------------------------------------------------------------------
+u32 GenerateMeshLods( ResMesh* pMesh, const f32* pTargetErrors, u32 lodCount, u32 flags )
+{
+    if ( pMesh == nullptr || pTargetErrors == nullptr || pMesh->Positions.empty() )
+    { return 0; }
+
+    pMesh->Lods      .clear();
+    pMesh->LodIndices.clear();
+    pMesh->LodSubsets.clear();
+
+    std::vector<ResSubset> subsets = pMesh->Subsets;
+    if ( subsets.empty() )
+    {
+        ResSubset subset = { 0, 0, static_cast<u32>( pMesh->VertexIndices.size() ) };
+        subsets.push_back( subset );
+    }
+
+    // サブセット番号をグループとして元メッシュの三角形を集める.
+    std::vector<u32> indices;
+    std::vector<u32> groups;
+    for( u32 i=0; i<subsets.size(); ++i )
+    {
+        auto begin = subsets[i].Offset;
+        auto end   = Min( begin + subsets[i].Count / 3 * 3, static_cast<u32>( pMesh->VertexIndices.size() ) );
+        for( auto j=begin; j + 3 <= end; j+=3 )
+        {
+            indices.push_back( pMesh->VertexIndices[j + 0] );
+            indices.push_back( pMesh->VertexIndices[j + 1] );
+            indices.push_back( pMesh->VertexIndices[j + 2] );
+            groups .push_back( i );
+        }
+    }
+
+    if ( indices.empty() )
+    { return 0; }
+
+    // 目標誤差はバウンディングボックスの半径に対する比率.
+    auto mini = pMesh->Positions[0];
+    auto maxi = pMesh->Positions[0];
+    for( const auto& p : pMesh->Positions )
+    {
+        mini = Vector3::Min( mini, p );
+        maxi = Vector3::Max( maxi, p );
+    }
+    auto radius = ( maxi - mini ).Length() * 0.5f;
+
+    auto indexCount = static_cast<u32>( indices.size() );
+    auto prevCount  = indexCount;
+
+    std::vector<u32> resultIndices( indexCount );
+    std::vector<u32> resultGroups ( indexCount / 3 );
+    std::vector<u32> groupCount   ( subsets.size() );
+
+    for( u32 i=0; i<lodCount; ++i )
+    {
+        // 元メッシュから毎回簡略化して誤差が累積しないようにする.
+        f32  error = 0.0f;
+        auto count = SimplifyIndices(
+            pMesh,
+            &indices[0],
+            &groups[0],
+            indexCount,
+            0,
+            pTargetErrors[i] * radius,
+            flags,
+            &resultIndices[0],
+            &resultGroups[0],
+            &error );
+
+        if ( count == 0 || count >= prevCount )
+        { continue; }
+
+        prevCount = count;
+
+        ResLod lod;
+        lod.Error        = error;
+        lod.SubsetOffset = static_cast<u32>( pMesh->LodSubsets.size() );
+        lod.SubsetCount  = 0;
+        lod.Reserved     = 0;
+
+        // サブセット順に並べ直す.
+        auto triCount = count / 3;
+        std::fill( groupCount.begin(), groupCount.end(), 0 );
+        for( u32 j=0; j<triCount; ++j )
+        { groupCount[resultGroups[j]]++; }
+
+        auto base = static_cast<u32>( pMesh->LodIndices.size() );
+        pMesh->LodIndices.resize( base + count );
+
+        std::vector<u32> cursor( subsets.size() );
+        auto offset = base;
+        for( u32 j=0; j<subsets.size(); ++j )
+        {
+            cursor[j] = offset;
+            if ( groupCount[j] > 0 )
+            {
+                ResSubset subset = { subsets[j].MaterialId, offset, groupCount[j] * 3 };
+                pMesh->LodSubsets.push_back( subset );
+                lod.SubsetCount++;
+            }
+            offset += groupCount[j] * 3;
+        }
+
+        for( u32 j=0; j<triCount; ++j )
+        {
+            auto& dst = cursor[resultGroups[j]];
+            pMesh->LodIndices[dst + 0] = resultIndices[j * 3 + 0];
+            pMesh->LodIndices[dst + 1] = resultIndices[j * 3 + 1];
+            pMesh->LodIndices[dst + 2] = resultIndices[j * 3 + 2];
+            dst += 3;
+        }
+
+        pMesh->Lods.push_back( lod );
+    }
+
+    return static_cast<u32>( pMesh->Lods.size() );
+}
+
+} // namespace asdx
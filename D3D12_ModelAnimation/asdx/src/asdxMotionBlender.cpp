@@ -0,0 +1,831 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxMotionBlender.cpp
+// Desc : Motion Blender Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxMotionBlender.h>
+#include <asdxResMesh.h>
+#include <cassert>
+#include <utility>
+
+#if ASDX_IS_SSE2
+#include <emmintrin.h>
+#endif//ASDX_IS_SSE2
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------------
+//      単位姿勢を設定します.
+//-------------------------------------------------------------------------------------------------
+inline void SetIdentity( asdx::BonePose& pose )
+{
+    pose.Translation = asdx::Vector4( 0.0f, 0.0f, 0.0f, 0.0f );
+    pose.Rotation    = asdx::Quaternion( 0.0f, 0.0f, 0.0f, 1.0f );
+    pose.Scale       = asdx::Vector4( 1.0f, 1.0f, 1.0f, 0.0f );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      変換行列を平行移動・回転・拡大縮小に分解します.
+//-------------------------------------------------------------------------------------------------
+void Decompose( const asdx::Matrix& value, asdx::BonePose& result )
+{
+    auto sx = sqrtf( value._11 * value._11 + value._12 * value._12 + value._13 * value._13 );
+    auto sy = sqrtf( value._21 * value._21 + value._22 * value._22 + value._23 * value._23 );
+    auto sz = sqrtf( value._31 * value._31 + value._32 * value._32 + value._33 * value._33 );
+
+    auto rx = ( sx > 0.0f ) ? 1.0f / sx : 0.0f;
+    auto ry = ( sy > 0.0f ) ? 1.0f / sy : 0.0f;
+    auto rz = ( sz > 0.0f ) ? 1.0f / sz : 0.0f;
+
+    auto rotation = asdx::Matrix(
+        value._11 * rx, value._12 * rx, value._13 * rx, 0.0f,
+        value._21 * ry, value._22 * ry, value._23 * ry, 0.0f,
+        value._31 * rz, value._32 * rz, value._33 * rz, 0.0f,
+        0.0f,           0.0f,           0.0f,           1.0f );
+
+    result.Translation = asdx::Vector4( value._41, value._42, value._43, 0.0f );
+    result.Rotation    = asdx::Quaternion::Normalize( asdx::Quaternion::CreateFromRotationMatrix( rotation ) );
+    result.Scale       = asdx::Vector4( sx, sy, sz, 0.0f );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      平行移動・回転・拡大縮小から変換行列を合成します.
+//-------------------------------------------------------------------------------------------------
+void Compose( const asdx::BonePose& pose, asdx::Matrix& result )
+{
+    asdx::Matrix::CreateFromQuaternion( pose.Rotation, result );
+
+    result._11 *= pose.Scale.x; result._12 *= pose.Scale.x; result._13 *= pose.Scale.x;
+    result._21 *= pose.Scale.y; result._22 *= pose.Scale.y; result._23 *= pose.Scale.y;
+    result._31 *= pose.Scale.z; result._32 *= pose.Scale.z; result._33 *= pose.Scale.z;
+
+    result._41 = pose.Translation.x;
+    result._42 = pose.Translation.y;
+    result._43 = pose.Translation.z;
+    result._44 = 1.0f;
+}
+
+#if ASDX_IS_SSE2
+//-------------------------------------------------------------------------------------------------
+//      4成分の内積を全成分に展開して求めます.
+//-------------------------------------------------------------------------------------------------
+inline __m128 Dot4( __m128 a, __m128 b )
+{
+    auto m = _mm_mul_ps( a, b );
+    auto s = _mm_add_ps( m, _mm_shuffle_ps( m, m, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+    return _mm_add_ps( s, _mm_shuffle_ps( s, s, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      線形補間を行います.
+//-------------------------------------------------------------------------------------------------
+inline __m128 Lerp( __m128 a, __m128 b, __m128 t )
+{ return _mm_add_ps( a, _mm_mul_ps( _mm_sub_ps( b, a ), t ) ); }
+
+//-------------------------------------------------------------------------------------------------
+//      四元数の正規化線形補間を行います(最短経路).
+//-------------------------------------------------------------------------------------------------
+inline __m128 Nlerp( __m128 a, __m128 b, __m128 t )
+{
+    auto sign = _mm_and_ps( _mm_cmplt_ps( Dot4( a, b ), _mm_setzero_ps() ), _mm_set1_ps( -0.0f ) );
+    auto q    = Lerp( a, _mm_xor_ps( b, sign ), t );
+    return _mm_div_ps( q, _mm_sqrt_ps( Dot4( q, q ) ) );
+}
+#endif//ASDX_IS_SSE2
+
+//-------------------------------------------------------------------------------------------------
+//      四元数の正規化線形補間を行います(最短経路).
+//-------------------------------------------------------------------------------------------------
+inline void Nlerp( const asdx::Quaternion& a, const asdx::Quaternion& b, f32 t, asdx::Quaternion& result )
+{
+    auto dot = a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+    auto s   = ( dot < 0.0f ) ? -1.0f : 1.0f;
+
+    auto x = a.x + ( b.x * s - a.x ) * t;
+    auto y = a.y + ( b.y * s - a.y ) * t;
+    auto z = a.z + ( b.z * s - a.z ) * t;
+    auto w = a.w + ( b.w * s - a.w ) * t;
+
+    auto invLen = 1.0f / sqrtf( x * x + y * y + z * z + w * w );
+    result.x = x * invLen;
+    result.y = y * invLen;
+    result.z = z * invLen;
+    result.w = w * invLen;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      四元数の回転を合成します(aの回転の後にbの回転).
+//-------------------------------------------------------------------------------------------------
+inline asdx::Quaternion Concat( const asdx::Quaternion& a, const asdx::Quaternion& b )
+{
+    return asdx::Quaternion(
+        ( b.w * a.x ) + ( b.x * a.w ) + ( b.y * a.z ) - ( b.z * a.y ),
+        ( b.w * a.y ) - ( b.x * a.z ) + ( b.y * a.w ) + ( b.z * a.x ),
+        ( b.w * a.z ) + ( b.x * a.y ) - ( b.y * a.x ) + ( b.z * a.w ),
+        ( b.w * a.w ) - ( b.x * a.x ) - ( b.y * a.y ) - ( b.z * a.z ) );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      姿勢の補間を行います.
+//-------------------------------------------------------------------------------------------------
+inline void LerpPose( const asdx::BonePose& a, const asdx::BonePose& b, f32 t, asdx::BonePose& result )
+{
+#if ASDX_IS_SSE2
+    auto v = _mm_set1_ps( t );
+    _mm_storeu_ps( &result.Translation.x, Lerp ( _mm_loadu_ps( &a.Translation.x ), _mm_loadu_ps( &b.Translation.x ), v ) );
+    _mm_storeu_ps( &result.Rotation.x,    Nlerp( _mm_loadu_ps( &a.Rotation.x ),    _mm_loadu_ps( &b.Rotation.x ),    v ) );
+    _mm_storeu_ps( &result.Scale.x,       Lerp ( _mm_loadu_ps( &a.Scale.x ),       _mm_loadu_ps( &b.Scale.x ),       v ) );
+#else
+    asdx::Vector4::Lerp( a.Translation, b.Translation, t, result.Translation );
+    asdx::Vector4::Lerp( a.Scale,       b.Scale,       t, result.Scale );
+    Nlerp( a.Rotation, b.Rotation, t, result.Rotation );
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+//      差分姿勢を加算します.
+//-------------------------------------------------------------------------------------------------
+inline void AddPose
+(
+    const asdx::BonePose&   sample,
+    const asdx::BonePose&   reference,
+    f32                     weight,
+    asdx::BonePose&         result
+)
+{
+    // 基準姿勢からの差分回転.
+    auto delta = Concat( sample.Rotation, asdx::Quaternion::Conjugate( reference.Rotation ) );
+    Nlerp( asdx::Quaternion( 0.0f, 0.0f, 0.0f, 1.0f ), delta, weight, delta );
+
+#if ASDX_IS_SSE2
+    auto w   = _mm_set1_ps( weight );
+    auto one = _mm_set1_ps( 1.0f );
+
+    auto rs = _mm_loadu_ps( &reference.Scale.x );
+    auto ss = _mm_div_ps( _mm_loadu_ps( &sample.Scale.x ), _mm_max_ps( rs, _mm_set1_ps( asdx::F_EPSILON ) ) );
+
+    auto t = _mm_mul_ps( _mm_sub_ps( _mm_loadu_ps( &sample.Translation.x ), _mm_loadu_ps( &reference.Translation.x ) ), w );
+    _mm_storeu_ps( &result.Translation.x, _mm_add_ps( _mm_loadu_ps( &result.Translation.x ), t ) );
+    _mm_storeu_ps( &result.Scale.x,       _mm_mul_ps( _mm_loadu_ps( &result.Scale.x ), Lerp( one, ss, w ) ) );
+#else
+    result.Translation.x += ( sample.Translation.x - reference.Translation.x ) * weight;
+    result.Translation.y += ( sample.Translation.y - reference.Translation.y ) * weight;
+    result.Translation.z += ( sample.Translation.z - reference.Translation.z ) * weight;
+
+    result.Scale.x *= asdx::Lerp( 1.0f, sample.Scale.x / asdx::Max( reference.Scale.x, asdx::F_EPSILON ), weight );
+    result.Scale.y *= asdx::Lerp( 1.0f, sample.Scale.y / asdx::Max( reference.Scale.y, asdx::F_EPSILON ), weight );
+    result.Scale.z *= asdx::Lerp( 1.0f, sample.Scale.z / asdx::Max( reference.Scale.z, asdx::F_EPSILON ), weight );
+#endif
+
+    result.Rotation = Concat( delta, result.Rotation );
+}
+
+} // namespace /* anonymous */
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// MotionClip class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+//-------------------------------------------------------------------------------------------------
+//      コンストラクタです.
+//-------------------------------------------------------------------------------------------------
+MotionClip::MotionClip()
+: m_Duration    ( 0 )
+, m_KeyOffsets  ()
+, m_KeyTimes    ()
+, m_KeyPoses    ()
+{ /* DO_NOTHING */ }
+
+//-------------------------------------------------------------------------------------------------
+//      デストラクタです.
+//-------------------------------------------------------------------------------------------------
+MotionClip::~MotionClip()
+{ Term(); }
+
+//-------------------------------------------------------------------------------------------------
+//      初期化処理を行います.
+//-------------------------------------------------------------------------------------------------
+void MotionClip::Init( const ResMotion& motion )
+{
+    Term();
+
+    auto boneCount = static_cast<u32>( motion.Bones.size() );
+
+    u32 keyCount = 0;
+    for( u32 i=0; i<boneCount; ++i )
+    { keyCount += static_cast<u32>( motion.Bones[i].KeyFrames.size() ); }
+
+    m_Duration = motion.Duration;
+    m_KeyOffsets.resize( boneCount + 1 );
+    m_KeyTimes  .resize( keyCount );
+    m_KeyPoses  .resize( keyCount );
+
+    u32 offset = 0;
+    for( u32 i=0; i<boneCount; ++i )
+    {
+        m_KeyOffsets[i] = offset;
+
+        const auto& keys = motion.Bones[i].KeyFrames;
+        for( size_t j=0; j<keys.size(); ++j )
+        {
+            m_KeyTimes[offset] = keys[j].Time;
+            Decompose( keys[j].Transform, m_KeyPoses[offset] );
+
+            // 隣接キーとの補間が最短経路になるように符号を揃えておく.
+            if ( j > 0 )
+            {
+                const auto& prev = m_KeyPoses[offset - 1].Rotation;
+                auto&       curr = m_KeyPoses[offset].Rotation;
+                if ( Quaternion::Dot( prev, curr ) < 0.0f )
+                { curr = Quaternion( -curr.x, -curr.y, -curr.z, -curr.w ); }
+            }
+
+            offset++;
+        }
+    }
+
+    m_KeyOffsets[boneCount] = offset;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      終了処理を行います.
+//-------------------------------------------------------------------------------------------------
+void MotionClip::Term()
+{
+    m_KeyOffsets.clear();
+    m_KeyTimes  .clear();
+    m_KeyPoses  .clear();
+    m_Duration = 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      最大キーフレーム番号を取得します.
+//-------------------------------------------------------------------------------------------------
+u32 MotionClip::GetDuration() const
+{ return m_Duration; }
+
+//-------------------------------------------------------------------------------------------------
+//      ボーン数を取得します.
+//-------------------------------------------------------------------------------------------------
+u32 MotionClip::GetBoneCount() const
+{ return ( m_KeyOffsets.empty() ) ? 0 : static_cast<u32>( m_KeyOffsets.size() - 1 ); }
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// MotionBlender class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+//-------------------------------------------------------------------------------------------------
+//      コンストラクタです.
+//-------------------------------------------------------------------------------------------------
+MotionBlender::MotionBlender()
+: m_BoneCount       ( 0 )
+, m_pBones          ( nullptr )
+, m_Layers          ()
+, m_Cursors         ()
+, m_SamplePoses     ()
+, m_Poses           ()
+, m_FrozenPoses     ()
+, m_IsFrozen        ( false )
+, m_BoneTransforms  ()
+, m_WorldTransforms ()
+, m_SkinTransforms  ()
+{ /* DO_NOTHING */ }
+
+//-------------------------------------------------------------------------------------------------
+//      デストラクタです.
+//-------------------------------------------------------------------------------------------------
+MotionBlender::~MotionBlender()
+{ Unbind(); }
+
+//-------------------------------------------------------------------------------------------------
+//      ボーンを関連付けします.
+//-------------------------------------------------------------------------------------------------
+void MotionBlender::Bind( u32 boneCount, const ResBone* pBones, u32 layerCount )
+{
+    m_BoneCount = boneCount;
+    m_pBones    = pBones;
+
+    m_Layers         .resize( layerCount );
+    m_Cursors        .resize( size_t(layerCount) * boneCount );
+    m_SamplePoses    .resize( boneCount );
+    m_Poses          .resize( boneCount );
+    m_FrozenPoses    .resize( boneCount );
+    m_BoneTransforms .resize( boneCount );
+    m_WorldTransforms.resize( boneCount );
+    m_SkinTransforms .resize( boneCount );
+
+    m_IsFrozen = false;
+
+    for( u32 i=0; i<layerCount; ++i )
+    {
+        auto& layer = m_Layers[i];
+        layer.pClip         = nullptr;
+        layer.pBoneMask     = nullptr;
+        layer.Mode          = BLEND_MODE_OVERRIDE;
+        layer.FrameTime     = 0.0f;
+        layer.Speed         = 1.0f;
+        layer.Weight        = 0.0f;
+        layer.TargetWeight  = 0.0f;
+        layer.FadeSpeed     = 0.0f;
+        layer.IsLoop        = false;
+        layer.IsActive      = false;
+        layer.IsFadeOut     = false;
+        layer.pCursors      = ( boneCount > 0 ) ? &m_Cursors[size_t(i) * boneCount] : nullptr;
+    }
+
+    for( u32 i=0; i<boneCount; ++i )
+    {
+        SetIdentity( m_Poses[i] );
+        m_BoneTransforms [i].Identity();
+        m_WorldTransforms[i].Identity();
+        m_SkinTransforms [i].Identity();
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ボーンの関連付けを解除します.
+//-------------------------------------------------------------------------------------------------
+void MotionBlender::Unbind()
+{
+    m_Layers         .clear();
+    m_Cursors        .clear();
+    m_SamplePoses    .clear();
+    m_Poses          .clear();
+    m_FrozenPoses    .clear();
+    m_BoneTransforms .clear();
+    m_WorldTransforms.clear();
+    m_SkinTransforms .clear();
+
+    m_BoneCount = 0;
+    m_pBones    = nullptr;
+    m_IsFrozen  = false;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      レイヤーにモーションを設定します.
+//-------------------------------------------------------------------------------------------------
+void MotionBlender::SetLayer
+(
+    u32                 index,
+    const MotionClip*   pClip,
+    BLEND_MODE          mode,
+    f32                 weight,
+    const f32*          pBoneMask
+)
+{
+    assert( index < m_Layers.size() );
+    auto& layer = m_Layers[index];
+
+    if ( index == 0 )
+    { m_IsFrozen = false; }
+
+    layer.pClip         = pClip;
+    layer.pBoneMask     = pBoneMask;
+    layer.Mode          = mode;
+    layer.FrameTime     = 0.0f;
+    layer.Weight        = weight;
+    layer.TargetWeight  = weight;
+    layer.FadeSpeed     = 0.0f;
+    layer.IsActive      = ( pClip != nullptr );
+    layer.IsFadeOut     = false;
+
+    for( u32 i=0; i<m_BoneCount; ++i )
+    { layer.pCursors[i] = 0; }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      レイヤーを無効化します.
+//-------------------------------------------------------------------------------------------------
+void MotionBlender::ClearLayer( u32 index )
+{
+    assert( index < m_Layers.size() );
+    m_Layers[index].pClip     = nullptr;
+    m_Layers[index].IsActive  = false;
+    m_Layers[index].IsFadeOut = false;
+
+    if ( index == 0 )
+    { m_IsFrozen = false; }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      レイヤーのブレンド重みを指定時間かけて変化させます.
+//-------------------------------------------------------------------------------------------------
+void MotionBlender::FadeLayer( u32 index, f32 weight, f32 duration )
+{
+    assert( index < m_Layers.size() );
+    auto& layer = m_Layers[index];
+
+    layer.TargetWeight = weight;
+    layer.IsFadeOut    = ( weight <= 0.0f );
+
+    // フェードアウト済みのレイヤーもフェードインし直せるようにする.
+    if ( weight > 0.0f && layer.pClip != nullptr )
+    { layer.IsActive = true; }
+
+    if ( duration <= 0.0f )
+    {
+        layer.Weight    = weight;
+        layer.FadeSpeed = 0.0f;
+        if ( layer.IsFadeOut )
+        {
+            layer.IsActive  = false;
+            layer.IsFadeOut = false;
+        }
+        return;
+    }
+
+    layer.FadeSpeed = fabsf( weight - layer.Weight ) / duration;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ベースレイヤーのモーションをクロスフェードで切り替えます.
+//-------------------------------------------------------------------------------------------------
+void MotionBlender::CrossFade( const MotionClip* pClip, f32 duration )
+{
+    assert( m_Layers.size() >= 2 );
+
+    // 前回のクロスフェードが終わっていなければ, 現在のブレンド結果から切り替える.
+    auto isFading = m_Layers[1].IsActive && m_Layers[1].Mode == BLEND_MODE_OVERRIDE;
+    if ( isFading && duration > 0.0f && m_BoneCount > 0 )
+    { FreezeBasePose(); }
+
+    if ( !m_Layers[0].IsActive || duration <= 0.0f )
+    {
+        auto isLoop = m_Layers[0].IsLoop;
+        if ( isFading )
+        { ClearLayer( 1 ); }
+
+        SetLayer( 0, pClip, BLEND_MODE_OVERRIDE, 1.0f );
+        m_Layers[0].IsLoop = isLoop;
+        return;
+    }
+
+    SetLayer( 1, pClip, BLEND_MODE_OVERRIDE, 0.0f );
+    m_Layers[1].IsLoop = m_Layers[0].IsLoop;
+    FadeLayer( 1, 1.0f, duration );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      レイヤーのループ再生フラグを設定します.
+//-------------------------------------------------------------------------------------------------
+void MotionBlender::SetLoop( u32 index, bool isLoop )
+{
+    assert( index < m_Layers.size() );
+    m_Layers[index].IsLoop = isLoop;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      レイヤーの再生速度を設定します.
+//-------------------------------------------------------------------------------------------------
+void MotionBlender::SetSpeed( u32 index, f32 speed )
+{
+    assert( index < m_Layers.size() );
+    m_Layers[index].Speed = speed;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      レイヤーの再生時間を設定します.
+//-------------------------------------------------------------------------------------------------
+void MotionBlender::SetFrameTime( u32 index, f32 time )
+{
+    assert( index < m_Layers.size() );
+    m_Layers[index].FrameTime = time;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      レイヤーの再生時間を取得します.
+//-------------------------------------------------------------------------------------------------
+f32 MotionBlender::GetFrameTime( u32 index ) const
+{
+    assert( index < m_Layers.size() );
+    return m_Layers[index].FrameTime;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      レイヤーのブレンド重みを取得します.
+//-------------------------------------------------------------------------------------------------
+f32 MotionBlender::GetWeight( u32 index ) const
+{
+    assert( index < m_Layers.size() );
+    return m_Layers[index].Weight;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      有効なレイヤー数を取得します.
+//-------------------------------------------------------------------------------------------------
+u32 MotionBlender::GetActiveLayerCount() const
+{
+    u32 count = 0;
+    for( size_t i=0; i<m_Layers.size(); ++i )
+    {
+        if ( m_Layers[i].IsActive )
+        { count++; }
+    }
+    return count;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      変換行列の数を返却します.
+//-------------------------------------------------------------------------------------------------
+u32 MotionBlender::GetTransformCount() const
+{ return m_BoneCount; }
+
+//-------------------------------------------------------------------------------------------------
+//      ブレンド後の姿勢を取得します.
+//-------------------------------------------------------------------------------------------------
+const BonePose* MotionBlender::GetPoses() const
+{ return ( m_BoneCount > 0 ) ? &m_Poses[0] : nullptr; }
+
+//-------------------------------------------------------------------------------------------------
+//      ボーン行列を取得します.
+//-------------------------------------------------------------------------------------------------
+const Matrix* MotionBlender::GetBoneTransforms() const
+{ return ( m_BoneCount > 0 ) ? &m_BoneTransforms[0] : nullptr; }
+
+//-------------------------------------------------------------------------------------------------
+//      ワールド行列を取得します.
+//-------------------------------------------------------------------------------------------------
+const Matrix* MotionBlender::GetWorldTransforms() const
+{ return ( m_BoneCount > 0 ) ? &m_WorldTransforms[0] : nullptr; }
+
+//-------------------------------------------------------------------------------------------------
+//      スキニング行列を取得します.
+//-------------------------------------------------------------------------------------------------
+const Matrix* MotionBlender::GetSkinTransforms() const
+{ return ( m_BoneCount > 0 ) ? &m_SkinTransforms[0] : nullptr; }
+
+//-------------------------------------------------------------------------------------------------
+//      更新処理を行います.
+//-------------------------------------------------------------------------------------------------
+void MotionBlender::Update( f32 elapsedTime )
+{
+    if ( m_BoneCount == 0 )
+    { return; }
+
+    for( u32 i=0; i<m_BoneCount; ++i )
+    { SetIdentity( m_Poses[i] ); }
+
+    for( size_t i=0; i<m_Layers.size(); ++i )
+    {
+        auto& layer = m_Layers[i];
+        if ( !layer.IsActive )
+        { continue; }
+
+        // 中断したクロスフェードの姿勢はそのまま使う.
+        if ( i == 0 && m_IsFrozen )
+        {
+            for( u32 j=0; j<m_BoneCount; ++j )
+            { m_Poses[j] = m_FrozenPoses[j]; }
+            continue;
+        }
+
+        AdvanceLayer( layer, elapsedTime );
+
+        // フェードアウトが完了したレイヤーは無効化.
+        if ( layer.IsFadeOut && layer.FadeSpeed <= 0.0f )
+        {
+            layer.IsActive  = false;
+            layer.IsFadeOut = false;
+            continue;
+        }
+
+        // 重み0のレイヤーは時間だけ進めて, フェードインを待つ.
+        if ( layer.Weight <= 0.0f )
+        { continue; }
+
+        SampleLayer( layer, &m_SamplePoses[0] );
+
+        auto count = Min( m_BoneCount, layer.pClip->GetBoneCount() );
+
+        if ( layer.Mode == BLEND_MODE_ADDITIVE )
+        {
+            const auto& clip = *layer.pClip;
+            for( u32 j=0; j<count; ++j )
+            {
+                auto w = ( layer.pBoneMask != nullptr ) ? layer.Weight * layer.pBoneMask[j] : layer.Weight;
+                if ( w <= 0.0f || clip.m_KeyOffsets[j] == clip.m_KeyOffsets[j + 1] )
+                { continue; }
+
+                AddPose( m_SamplePoses[j], clip.m_KeyPoses[clip.m_KeyOffsets[j]], w, m_Poses[j] );
+            }
+        }
+        else
+        { BlendOverride( layer, &m_SamplePoses[0], &m_Poses[0] ); }
+    }
+
+    // クロスフェードが完了したらベースレイヤーに昇格.
+    if ( m_Layers.size() >= 2
+      && m_Layers[1].IsActive
+      && m_Layers[1].Mode == BLEND_MODE_OVERRIDE
+      && m_Layers[1].Weight >= 1.0f
+      && m_Layers[1].pBoneMask == nullptr )
+    {
+        std::swap( m_Layers[0], m_Layers[1] );
+        ClearLayer( 1 );
+        m_IsFrozen = false;
+    }
+
+    // 行列を更新.
+    UpdateBoneTransforms ();
+    UpdateWorldTransforms();
+    UpdateSkinTransforms ();
+}
+
+//-------------------------------------------------------------------------------------------------
+//      レイヤーの時間と重みを進めます.
+//-------------------------------------------------------------------------------------------------
+void MotionBlender::AdvanceLayer( Layer& layer, f32 elapsedTime )
+{
+    auto duration = static_cast<f32>( layer.pClip->GetDuration() );
+
+    layer.FrameTime += elapsedTime * layer.Speed;
+
+    if ( layer.FrameTime >= duration )
+    {
+        // ループ再生なら時間を戻す.
+        if ( layer.IsLoop && duration > 0.0f )
+        { layer.FrameTime = fmodf( layer.FrameTime, duration ); }
+        else
+        { layer.FrameTime = duration; }
+    }
+    else if ( layer.FrameTime < 0.0f )
+    {
+        // 逆再生で先頭を過ぎた場合は末尾から続ける.
+        if ( layer.IsLoop && duration > 0.0f )
+        {
+            layer.FrameTime = fmodf( layer.FrameTime, duration ) + duration;
+            if ( layer.FrameTime >= duration )
+            { layer.FrameTime = 0.0f; }
+        }
+        else
+        { layer.FrameTime = 0.0f; }
+    }
+
+    if ( layer.FadeSpeed > 0.0f )
+    {
+        auto step = layer.FadeSpeed * elapsedTime;
+        if ( layer.Weight < layer.TargetWeight )
+        { layer.Weight = Min( layer.Weight + step, layer.TargetWeight ); }
+        else
+        { layer.Weight = Max( layer.Weight - step, layer.TargetWeight ); }
+
+        if ( layer.Weight == layer.TargetWeight )
+        { layer.FadeSpeed = 0.0f; }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      レイヤーのモーションをサンプリングします.
+//-------------------------------------------------------------------------------------------------
+void MotionBlender::SampleLayer( Layer& layer, BonePose* pResult )
+{
+    const auto& clip = *layer.pClip;
+    auto time  = layer.FrameTime;
+    auto count = Min( m_BoneCount, clip.GetBoneCount() );
+
+    for( u32 i=0; i<count; ++i )
+    {
+        auto begin = clip.m_KeyOffsets[i];
+        auto end   = clip.m_KeyOffsets[i + 1];
+
+        if ( begin == end )
+        {
+            SetIdentity( pResult[i] );
+            continue;
+        }
+
+        // 前回の探索位置から進める. 逆再生などで時間が戻った場合は手前へ探索し直す.
+        auto idx = begin + layer.pCursors[i];
+        if ( idx >= end )
+        { idx = begin; }
+
+        while( idx > begin && static_cast<f32>( clip.m_KeyTimes[idx] ) > time )
+        { idx--; }
+
+        while( idx + 1 < end && static_cast<f32>( clip.m_KeyTimes[idx + 1] ) <= time )
+        { idx++; }
+
+        layer.pCursors[i] = idx - begin;
+
+        // 範囲外または同一キーであれば補間の必要はない.
+        if ( idx + 1 >= end || time <= static_cast<f32>( clip.m_KeyTimes[idx] ) )
+        {
+            pResult[i] = clip.m_KeyPoses[idx];
+            continue;
+        }
+
+        auto t0 = static_cast<f32>( clip.m_KeyTimes[idx] );
+        auto t1 = static_cast<f32>( clip.m_KeyTimes[idx + 1] );
+        auto ratio = Saturate( ( time - t0 ) / ( t1 - t0 ) );
+
+        LerpPose( clip.m_KeyPoses[idx], clip.m_KeyPoses[idx + 1], ratio, pResult[i] );
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      サンプリング結果を上書きモードでブレンドします.
+//-------------------------------------------------------------------------------------------------
+void MotionBlender::BlendOverride( const Layer& layer, const BonePose* pSample, BonePose* pResult )
+{
+    auto count = Min( m_BoneCount, layer.pClip->GetBoneCount() );
+
+    for( u32 i=0; i<count; ++i )
+    {
+        auto w = ( layer.pBoneMask != nullptr ) ? layer.Weight * layer.pBoneMask[i] : layer.Weight;
+        if ( w <= 0.0f )
+        { continue; }
+
+        if ( w >= 1.0f )
+        { pResult[i] = pSample[i]; }
+        else
+        { LerpPose( pResult[i], pSample[i], w, pResult[i] ); }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      レイヤー0と1の現在のブレンド結果をレイヤー0の固定姿勢にします.
+//-------------------------------------------------------------------------------------------------
+void MotionBlender::FreezeBasePose()
+{
+    // 直前の Update() と同じ時刻でサンプリングし直すので, 見た目は変わらない.
+    if ( !m_IsFrozen )
+    {
+        for( u32 i=0; i<m_BoneCount; ++i )
+        { SetIdentity( m_FrozenPoses[i] ); }
+
+        if ( m_Layers[0].IsActive )
+        {
+            SampleLayer( m_Layers[0], &m_SamplePoses[0] );
+            BlendOverride( m_Layers[0], &m_SamplePoses[0], &m_FrozenPoses[0] );
+        }
+    }
+
+    SampleLayer( m_Layers[1], &m_SamplePoses[0] );
+    BlendOverride( m_Layers[1], &m_SamplePoses[0], &m_FrozenPoses[0] );
+
+    // レイヤー1は切り替え先に使うので, ループ設定だけ引き継ぐ.
+    auto isLoop = m_Layers[1].IsLoop;
+    ClearLayer( 1 );
+
+    auto& layer = m_Layers[0];
+    layer.pClip         = nullptr;
+    layer.pBoneMask     = nullptr;
+    layer.Mode          = BLEND_MODE_OVERRIDE;
+    layer.FrameTime     = 0.0f;
+    layer.Weight        = 1.0f;
+    layer.TargetWeight  = 1.0f;
+    layer.FadeSpeed     = 0.0f;
+    layer.IsLoop        = isLoop;
+    layer.IsActive      = true;
+    layer.IsFadeOut     = false;
+
+    m_IsFrozen = true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ボーン行列を更新します.
+//-------------------------------------------------------------------------------------------------
+void MotionBlender::UpdateBoneTransforms()
+{
+    for( u32 i=0; i<m_BoneCount; ++i )
+    { Compose( m_Poses[i], m_BoneTransforms[i] ); }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ワールド行列を更新します.
+//-------------------------------------------------------------------------------------------------
+void MotionBlender::UpdateWorldTransforms()
+{
+    m_WorldTransforms[0] = m_BoneTransforms[0];
+
+    for( u32 i=1; i<m_BoneCount; ++i )
+    {
+        auto parent = m_pBones[i].ParentId;
+
+        // 親がいる場合は親のワールド行列をかける. いなければボーン行列をそのまま設定.
+        if ( parent != U32_MAX )
+        { m_WorldTransforms[i] = m_BoneTransforms[i] * m_WorldTransforms[parent]; }
+        else
+        { m_WorldTransforms[i] = m_BoneTransforms[i]; }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      スキニング行列を更新します.
+//-------------------------------------------------------------------------------------------------
+void MotionBlender::UpdateSkinTransforms()
+{
+    for( u32 i=0; i<m_BoneCount; ++i )
+    { m_SkinTransforms[i] = m_pBones[i].InvBindPose * m_WorldTransforms[i]; }
+}
+
+} // namespace asdx
@@ -0,0 +1,619 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxMotionDatabase.cpp
+// Desc : Motion Matching Database Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxMotionDatabase.h>
+#include <asdxMotionPlayer.h>
+#include <asdxResMesh.h>
+#include <asdxLogger.h>
+#include <algorithm>
+
+#if ASDX_IS_SSE2
+#include <emmintrin.h>
+#endif//ASDX_IS_SSE2
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------------
+// Constant Values.
+//-------------------------------------------------------------------------------------------------
+static const u32 MAX_LEAF_ENTRY_COUNT = 16;     // 葉に格納する最大エントリ数.
+static const f32 MIN_DEVIATION        = 1e-4f;  // 正規化に用いる標準偏差の下限値(ほぼ一定の要素で誤差を増幅しないため).
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// CharacterSpace structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct CharacterSpace
+{
+    asdx::Vector3   Origin;     //!< 地面に投影した基準ボーンの位置です.
+    asdx::Vector3   Forward;    //!< 地面に投影した基準ボーンの前方向です.
+    asdx::Vector3   Right;      //!< 地面に投影した基準ボーンの右方向です.
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      基準ボーンのワールド行列から設定します.
+    //---------------------------------------------------------------------------------------------
+    void Set( const asdx::Matrix& root )
+    {
+        Origin = asdx::Vector3( root._41, 0.0f, root._43 );
+
+        auto len = sqrtf( root._31 * root._31 + root._33 * root._33 );
+        Forward = ( len > asdx::F_EPSILON )
+            ? asdx::Vector3( root._31 / len, 0.0f, root._33 / len )
+            : asdx::Vector3( 0.0f, 0.0f, 1.0f );
+        Right = asdx::Vector3( Forward.z, 0.0f, -Forward.x );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      方向ベクトルをキャラクター空間に変換します.
+    //---------------------------------------------------------------------------------------------
+    asdx::Vector3 ToLocalDir( const asdx::Vector3& value ) const
+    {
+        return asdx::Vector3(
+            value.x * Right.x   + value.z * Right.z,
+            value.y,
+            value.x * Forward.x + value.z * Forward.z );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      位置座標をキャラクター空間に変換します.
+    //---------------------------------------------------------------------------------------------
+    asdx::Vector3 ToLocal( const asdx::Vector3& value ) const
+    { return ToLocalDir( value - Origin ); }
+};
+
+//-------------------------------------------------------------------------------------------------
+//      行列の平行移動成分を取得します.
+//-------------------------------------------------------------------------------------------------
+inline asdx::Vector3 GetTranslation( const asdx::Matrix& value )
+{ return asdx::Vector3( value._41, value._42, value._43 ); }
+
+//-------------------------------------------------------------------------------------------------
+//      行列の前方向成分を取得します.
+//-------------------------------------------------------------------------------------------------
+inline asdx::Vector3 GetForward( const asdx::Matrix& value )
+{ return asdx::Vector3( value._31, value._32, value._33 ); }
+
+//-------------------------------------------------------------------------------------------------
+//      正規化前の特徴量を抽出します.
+//
+//      [ボーン位置 x3][ボーン速度 x3][軌道位置 xz][軌道方向 xz] の順に格納します.
+//-------------------------------------------------------------------------------------------------
+template<typename GetPosition, typename GetVelocity>
+void ExtractFeature
+(
+    const asdx::Matrix&     root,
+    u32                     boneCount,
+    GetPosition             getPosition,
+    GetVelocity             getVelocity,
+    u32                     trajectoryCount,
+    const asdx::Vector3*    pTrajectoryPositions,
+    const asdx::Vector3*    pTrajectoryDirections,
+    f32*                    pResult
+)
+{
+    CharacterSpace space;
+    space.Set( root );
+
+    for( u32 i=0; i<boneCount; ++i )
+    {
+        auto pos = space.ToLocal( getPosition( i ) );
+        *(pResult++) = pos.x;
+        *(pResult++) = pos.y;
+        *(pResult++) = pos.z;
+    }
+
+    for( u32 i=0; i<boneCount; ++i )
+    {
+        auto vel = space.ToLocalDir( getVelocity( i ) );
+        *(pResult++) = vel.x;
+        *(pResult++) = vel.y;
+        *(pResult++) = vel.z;
+    }
+
+    for( u32 i=0; i<trajectoryCount; ++i )
+    {
+        auto pos = space.ToLocal( pTrajectoryPositions[i] );
+        *(pResult++) = pos.x;
+        *(pResult++) = pos.z;
+    }
+
+    for( u32 i=0; i<trajectoryCount; ++i )
+    {
+        auto dir = space.ToLocalDir( pTrajectoryDirections[i] );
+        auto len = sqrtf( dir.x * dir.x + dir.z * dir.z );
+        if ( len > asdx::F_EPSILON )
+        {
+            dir.x /= len;
+            dir.z /= len;
+        }
+        *(pResult++) = dir.x;
+        *(pResult++) = dir.z;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      特徴量の二乗距離を求めます.
+//-------------------------------------------------------------------------------------------------
+inline f32 CalcCost( const f32* a, const f32* b, u32 stride )
+{
+#if ASDX_IS_SSE2
+    auto sum = _mm_setzero_ps();
+    for( u32 i=0; i<stride; i+=4 )
+    {
+        auto d = _mm_sub_ps( _mm_loadu_ps( a + i ), _mm_loadu_ps( b + i ) );
+        sum = _mm_add_ps( sum, _mm_mul_ps( d, d ) );
+    }
+    sum = _mm_add_ps( sum, _mm_shuffle_ps( sum, sum, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+    sum = _mm_add_ps( sum, _mm_shuffle_ps( sum, sum, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+    return _mm_cvtss_f32( sum );
+#else
+    auto sum = 0.0f;
+    for( u32 i=0; i<stride; ++i )
+    {
+        auto d = a[i] - b[i];
+        sum += d * d;
+    }
+    return sum;
+#endif
+}
+
+} // namespace /* anonymous */
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// MotionDatabase class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+//-------------------------------------------------------------------------------------------------
+//      コンストラクタです.
+//-------------------------------------------------------------------------------------------------
+MotionDatabase::MotionDatabase()
+: m_Desc        ()
+, m_BoneCount   ( 0 )
+, m_pBones      ( nullptr )
+, m_MotionCount ( 0 )
+, m_Dimension   ( 0 )
+, m_Stride      ( 0 )
+, m_Features    ()
+, m_Entries     ()
+, m_Offset      ()
+, m_Scale       ()
+, m_Nodes       ()
+{ /* DO_NOTHING */ }
+
+//-------------------------------------------------------------------------------------------------
+//      デストラクタです.
+//-------------------------------------------------------------------------------------------------
+MotionDatabase::~MotionDatabase()
+{ Term(); }
+
+//-------------------------------------------------------------------------------------------------
+//      初期化処理を行います.
+//-------------------------------------------------------------------------------------------------
+bool MotionDatabase::Init( const MotionFeatureDesc& desc, u32 boneCount, const ResBone* pBones )
+{
+    if ( boneCount == 0 || pBones == nullptr || desc.RootBone >= boneCount )
+    {
+        ELOG( "Error : Invalid Argument." );
+        return false;
+    }
+
+    for( size_t i=0; i<desc.FeatureBones.size(); ++i )
+    {
+        if ( desc.FeatureBones[i] >= boneCount )
+        {
+            ELOG( "Error : Invalid Feature Bone. index = %u", desc.FeatureBones[i] );
+            return false;
+        }
+    }
+
+    auto dimension = static_cast<u32>( desc.FeatureBones.size() * 6 + desc.TrajectoryFrames.size() * 4 );
+    if ( dimension == 0 )
+    {
+        ELOG( "Error : Feature Dimension is Zero." );
+        return false;
+    }
+
+    Term();
+
+    m_Desc        = desc;
+    m_BoneCount   = boneCount;
+    m_pBones      = pBones;
+    m_Dimension   = dimension;
+    m_Stride      = ( dimension + 3 ) & ~3u;
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      終了処理を行います.
+//-------------------------------------------------------------------------------------------------
+void MotionDatabase::Term()
+{
+    m_Features.clear();
+    m_Entries .clear();
+    m_Offset  .clear();
+    m_Scale   .clear();
+    m_Nodes   .clear();
+
+    m_BoneCount   = 0;
+    m_pBones      = nullptr;
+    m_MotionCount = 0;
+    m_Dimension   = 0;
+    m_Stride      = 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      モーションを追加します.
+//-------------------------------------------------------------------------------------------------
+u32 MotionDatabase::AddMotion( const ResMotion& motion )
+{
+    // 構築済みであれば正規化を戻しておく.
+    if ( !m_Offset.empty() )
+    {
+        auto count = static_cast<u32>( m_Entries.size() );
+        for( u32 i=0; i<count; ++i )
+        {
+            auto pFeature = &m_Features[size_t(i) * m_Stride];
+            for( u32 d=0; d<m_Dimension; ++d )
+            {
+                // 重みが0の要素は元の値を復元できないため平均値に戻す(検索には寄与しない).
+                pFeature[d] = ( m_Scale[d] > 0.0f )
+                    ? pFeature[d] / m_Scale[d] + m_Offset[d]
+                    : m_Offset[d];
+            }
+        }
+
+        m_Offset.clear();
+        m_Scale .clear();
+    }
+
+    auto motionId        = m_MotionCount++;
+    auto frameCount      = motion.Duration + 1;
+    auto boneCount       = static_cast<u32>( m_Desc.FeatureBones.size() );
+    auto trajectoryCount = static_cast<u32>( m_Desc.TrajectoryFrames.size() );
+
+    // 全フレームの基準ボーンと特徴ボーンのワールド行列をサンプリング.
+    std::vector<Matrix>  roots    ( frameCount );
+    std::vector<Vector3> positions( size_t(frameCount) * boneCount );
+    {
+        MotionPlayer player;
+        player.Bind( m_BoneCount, m_pBones );
+        player.SetMotion( &motion );
+        player.SetLoop( false );
+
+        for( u32 f=0; f<frameCount; ++f )
+        {
+            player.Update( ( f == 0 ) ? 0.0f : 1.0f );
+
+            auto pWorld = player.GetWorldTransforms();
+            roots[f] = pWorld[m_Desc.RootBone];
+
+            for( u32 i=0; i<boneCount; ++i )
+            { positions[size_t(f) * boneCount + i] = GetTranslation( pWorld[m_Desc.FeatureBones[i]] ); }
+        }
+    }
+
+    std::vector<Vector3> trajectoryPositions ( trajectoryCount );
+    std::vector<Vector3> trajectoryDirections( trajectoryCount );
+
+    auto offset = m_Features.size();
+    m_Features.resize( offset + size_t(frameCount) * m_Stride, 0.0f );
+    m_Entries .reserve( m_Entries.size() + frameCount );
+
+    for( u32 f=0; f<frameCount; ++f )
+    {
+        for( u32 i=0; i<trajectoryCount; ++i )
+        {
+            auto g = Min( f + m_Desc.TrajectoryFrames[i], frameCount - 1 );
+            trajectoryPositions [i] = GetTranslation( roots[g] );
+            trajectoryDirections[i] = GetForward    ( roots[g] );
+        }
+
+        // 速度は後退差分で求める. 先頭フレームのみ前方差分.
+        auto f0 = ( f > 0 ) ? f - 1 : 0;
+        auto f1 = ( f > 0 ) ? f : Min( 1u, frameCount - 1 );
+        auto pCurr = &positions[size_t(f)  * boneCount];
+        auto pPrev = &positions[size_t(f0) * boneCount];
+        auto pNext = &positions[size_t(f1) * boneCount];
+
+        ExtractFeature(
+            roots[f],
+            boneCount,
+            [&]( u32 i ) { return pCurr[i]; },
+            [&]( u32 i ) { return pNext[i] - pPrev[i]; },
+            trajectoryCount,
+            ( trajectoryCount > 0 ) ? &trajectoryPositions [0] : nullptr,
+            ( trajectoryCount > 0 ) ? &trajectoryDirections[0] : nullptr,
+            &m_Features[offset + size_t(f) * m_Stride] );
+
+        Entry entry;
+        entry.MotionId = motionId;
+        entry.Frame    = f;
+        m_Entries.push_back( entry );
+    }
+
+    // 再構築が必要.
+    m_Nodes.clear();
+
+    return motionId;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      特徴量を正規化し, 木構造を構築します.
+//-------------------------------------------------------------------------------------------------
+void MotionDatabase::Build()
+{
+    auto count = static_cast<u32>( m_Entries.size() );
+    if ( count == 0 )
+    { return; }
+
+    // 構築済み.
+    if ( !m_Offset.empty() )
+    { return; }
+
+    m_Offset.resize( m_Stride );
+    m_Scale .resize( m_Stride );
+    std::fill( m_Offset.begin(), m_Offset.end(), 0.0f );
+    std::fill( m_Scale .begin(), m_Scale .end(), 0.0f );
+
+    // 平均値.
+    for( u32 i=0; i<count; ++i )
+    {
+        auto pFeature = &m_Features[size_t(i) * m_Stride];
+        for( u32 d=0; d<m_Dimension; ++d )
+        { m_Offset[d] += pFeature[d]; }
+    }
+    for( u32 d=0; d<m_Dimension; ++d )
+    { m_Offset[d] /= static_cast<f32>( count ); }
+
+    // 要素グループ(位置 xyz, 速度 xyz, 軌道 xz, 方向 xz)ごとに標準偏差を求め, 重みを掛けたスケールとする.
+    auto boneCount       = static_cast<u32>( m_Desc.FeatureBones.size() );
+    auto trajectoryCount = static_cast<u32>( m_Desc.TrajectoryFrames.size() );
+
+    auto normalizeGroup = [&]( u32 begin, u32 size, f32 weight )
+    {
+        auto variance = 0.0f;
+        for( u32 i=0; i<count; ++i )
+        {
+            auto pFeature = &m_Features[size_t(i) * m_Stride];
+            for( u32 d=begin; d<begin + size; ++d )
+            {
+                auto v = pFeature[d] - m_Offset[d];
+                variance += v * v;
+            }
+        }
+        variance /= static_cast<f32>( count ) * static_cast<f32>( size );
+
+        auto scale = weight / Max( sqrtf( variance ), MIN_DEVIATION );
+        for( u32 d=begin; d<begin + size; ++d )
+        { m_Scale[d] = scale; }
+    };
+
+    u32 index = 0;
+    for( u32 i=0; i<boneCount; ++i, index += 3 )
+    { normalizeGroup( index, 3, m_Desc.PositionWeight ); }
+    for( u32 i=0; i<boneCount; ++i, index += 3 )
+    { normalizeGroup( index, 3, m_Desc.VelocityWeight ); }
+    for( u32 i=0; i<trajectoryCount; ++i, index += 2 )
+    { normalizeGroup( index, 2, m_Desc.TrajectoryWeight ); }
+    for( u32 i=0; i<trajectoryCount; ++i, index += 2 )
+    { normalizeGroup( index, 2, m_Desc.TrajectoryWeight ); }
+
+    for( u32 i=0; i<count; ++i )
+    {
+        auto pFeature = &m_Features[size_t(i) * m_Stride];
+        for( u32 d=0; d<m_Dimension; ++d )
+        { pFeature[d] = ( pFeature[d] - m_Offset[d] ) * m_Scale[d]; }
+    }
+
+    // 木構造を構築.
+    std::vector<u32> indices( count );
+    for( u32 i=0; i<count; ++i )
+    { indices[i] = i; }
+
+    m_Nodes.clear();
+    m_Nodes.reserve( ( count / MAX_LEAF_ENTRY_COUNT + 1 ) * 4 );
+    BuildNode( indices, 0, count );
+
+    // 葉の中のエントリが連続するように並べ替える.
+    std::vector<f32>   features( m_Features.size() );
+    std::vector<Entry> entries ( count );
+    for( u32 i=0; i<count; ++i )
+    {
+        std::copy_n( &m_Features[size_t(indices[i]) * m_Stride], m_Stride, &features[size_t(i) * m_Stride] );
+        entries[i] = m_Entries[indices[i]];
+    }
+
+    m_Features.swap( features );
+    m_Entries .swap( entries );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ノードを構築します.
+//-------------------------------------------------------------------------------------------------
+u32 MotionDatabase::BuildNode( std::vector<u32>& indices, u32 begin, u32 end )
+{
+    auto nodeIndex = static_cast<u32>( m_Nodes.size() );
+    m_Nodes.push_back( Node() );
+
+    auto count = end - begin;
+
+    // 最も広がりの大きい軸を分割軸とする.
+    auto axis      = U32_MAX;
+    auto maxExtent = 0.0f;
+    if ( count > MAX_LEAF_ENTRY_COUNT )
+    {
+        for( u32 d=0; d<m_Dimension; ++d )
+        {
+            auto mini = F32_MAX;
+            auto maxi = -F32_MAX;
+            for( u32 i=begin; i<end; ++i )
+            {
+                auto v = m_Features[size_t(indices[i]) * m_Stride + d];
+                mini = Min( mini, v );
+                maxi = Max( maxi, v );
+            }
+
+            if ( maxi - mini > maxExtent )
+            {
+                maxExtent = maxi - mini;
+                axis      = d;
+            }
+        }
+    }
+
+    // 葉ノード.
+    if ( axis == U32_MAX )
+    {
+        m_Nodes[nodeIndex].Axis  = U32_MAX;
+        m_Nodes[nodeIndex].Split = 0.0f;
+        m_Nodes[nodeIndex].Child = begin;
+        m_Nodes[nodeIndex].Count = count;
+        return nodeIndex;
+    }
+
+    // 中央値で分割.
+    auto mid = begin + count / 2;
+    std::nth_element( indices.begin() + begin, indices.begin() + mid, indices.begin() + end,
+        [&]( u32 a, u32 b )
+        { return m_Features[size_t(a) * m_Stride + axis] < m_Features[size_t(b) * m_Stride + axis]; });
+
+    auto split = m_Features[size_t(indices[mid]) * m_Stride + axis];
+    auto left  = BuildNode( indices, begin, mid );
+    auto right = BuildNode( indices, mid,   end );
+
+    m_Nodes[nodeIndex].Axis  = axis;
+    m_Nodes[nodeIndex].Split = split;
+    m_Nodes[nodeIndex].Child = left;
+    m_Nodes[nodeIndex].Count = right;
+
+    return nodeIndex;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      検索クエリを生成します.
+//-------------------------------------------------------------------------------------------------
+void MotionDatabase::CreateQuery
+(
+    const Matrix*   pWorldTransforms,
+    const Matrix*   pPrevWorldTransforms,
+    const Vector3*  pTrajectoryPositions,
+    const Vector3*  pTrajectoryDirections,
+    f32*            pResult
+) const
+{
+    if ( pResult == nullptr )
+    { return; }
+
+    // Build() 前は正規化パラメータが無いため検索できないクエリ(全て0)を返す.
+    if ( m_Offset.empty() || pWorldTransforms == nullptr || pPrevWorldTransforms == nullptr )
+    {
+        for( u32 d=0; d<m_Stride; ++d )
+        { pResult[d] = 0.0f; }
+        return;
+    }
+
+    const auto& bones = m_Desc.FeatureBones;
+
+    ExtractFeature(
+        pWorldTransforms[m_Desc.RootBone],
+        static_cast<u32>( bones.size() ),
+        [&]( u32 i ) { return GetTranslation( pWorldTransforms    [bones[i]] ); },
+        [&]( u32 i ) { return GetTranslation( pWorldTransforms[bones[i]] ) - GetTranslation( pPrevWorldTransforms[bones[i]] ); },
+        static_cast<u32>( m_Desc.TrajectoryFrames.size() ),
+        pTrajectoryPositions,
+        pTrajectoryDirections,
+        pResult );
+
+    for( u32 d=0; d<m_Dimension; ++d )
+    { pResult[d] = ( pResult[d] - m_Offset[d] ) * m_Scale[d]; }
+
+    for( u32 d=m_Dimension; d<m_Stride; ++d )
+    { pResult[d] = 0.0f; }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      最も近い姿勢を検索します.
+//-------------------------------------------------------------------------------------------------
+bool MotionDatabase::Search( const f32* pQuery, MotionMatchResult& result ) const
+{
+    if ( pQuery == nullptr || m_Nodes.empty() )
+    { return false; }
+
+    auto bestCost  = F32_MAX;
+    auto bestEntry = U32_MAX;
+    SearchNode( 0, pQuery, bestCost, bestEntry );
+
+    if ( bestEntry == U32_MAX )
+    { return false; }
+
+    result.MotionId = m_Entries[bestEntry].MotionId;
+    result.Frame    = m_Entries[bestEntry].Frame;
+    result.Cost     = bestCost;
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ノードを探索します.
+//-------------------------------------------------------------------------------------------------
+void MotionDatabase::SearchNode( u32 index, const f32* pQuery, f32& bestCost, u32& bestEntry ) const
+{
+    const auto& node = m_Nodes[index];
+
+    // 葉ノードは全エントリを走査.
+    if ( node.Axis == U32_MAX )
+    {
+        auto pFeature = &m_Features[size_t(node.Child) * m_Stride];
+        for( u32 i=0; i<node.Count; ++i, pFeature += m_Stride )
+        {
+            auto cost = CalcCost( pQuery, pFeature, m_Stride );
+            if ( cost < bestCost )
+            {
+                bestCost  = cost;
+                bestEntry = node.Child + i;
+            }
+        }
+        return;
+    }
+
+    auto diff = pQuery[node.Axis] - node.Split;
+    auto nearChild = ( diff < 0.0f ) ? node.Child : node.Count;
+    auto farChild  = ( diff < 0.0f ) ? node.Count : node.Child;
+
+    SearchNode( nearChild, pQuery, bestCost, bestEntry );
+
+    // 分割面までの距離が現在の最良値より近ければ反対側も探索.
+    if ( diff * diff < bestCost )
+    { SearchNode( farChild, pQuery, bestCost, bestEntry ); }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      特徴量の次元数を取得します.
+//-------------------------------------------------------------------------------------------------
+u32 MotionDatabase::GetFeatureDimension() const
+{ return m_Dimension; }
+
+//-------------------------------------------------------------------------------------------------
+//      特徴量1つあたりの要素数を取得します.
+//-------------------------------------------------------------------------------------------------
+u32 MotionDatabase::GetFeatureStride() const
+{ return m_Stride; }
+
+//-------------------------------------------------------------------------------------------------
+//      登録されているフレーム数を取得します.
+//-------------------------------------------------------------------------------------------------
+u32 MotionDatabase::GetEntryCount() const
+{ return static_cast<u32>( m_Entries.size() ); }
+
+} // namespace asdx
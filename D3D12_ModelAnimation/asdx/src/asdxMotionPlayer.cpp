@@ -9,6 +9,23 @@
 //-------------------------------------------------------------------------------------------------
 #include <asdxMotionPlayer.h>
 #include <asdxResMesh.h>
+#include <asdxIKSolver.h>
+#include <asdxLogger.h>
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------------
+// Constant Values.
+//-------------------------------------------------------------------------------------------------
+// モーションLODを切り替える画面占有率(画面高さに対するバウンディングスフィア半径の比)です.
+static const f32 MOTION_LOD_SCREEN_RATIO[asdx::MOTION_LOD_COUNT - 1] = {
+    0.25f,      // これ以上なら MOTION_LOD_FULL.
+    0.1f,       // これ以上なら MOTION_LOD_HALF.
+    0.04f,      // これ以上なら MOTION_LOD_QUARTER. 未満なら MOTION_LOD_EIGHTH.
+};
+
+} // namespace /* anonymous */
 
 
 namespace asdx {
@@ -25,10 +42,22 @@ MotionPlayer::MotionPlayer()
 , m_BoneCount      ( 0 )
 , m_pBones         ( nullptr )
 , m_pMotion        ( nullptr )
+, m_pBoneMask      ( nullptr )
+, m_Lod            ( MOTION_LOD_FULL )
+, m_UpdatePhase    ( 0 )
+, m_FrameCount     ( 0 )
+, m_LodStep        ( 0 )
+, m_LodSpan        ( 1 )
+, m_IsDirty        ( true )
 , m_BoneTransforms ()
+, m_PrevTransforms ()
+, m_NextTransforms ()
 , m_WorldTransforms()
 , m_SkinTransforms ()
 , m_IsLoop         ( false )
+, m_pIKSolver      ( nullptr )
+, m_IKTransforms   ()
+, m_IKStatistics   ()
 { /* DO_NOTHING */ }
 
 //-------------------------------------------------------------------------------------------------
@@ -44,7 +73,10 @@ MotionPlayer::~MotionPlayer()
 //      モーションを設定します.
 //-------------------------------------------------------------------------------------------------
 void MotionPlayer::SetMotion( const ResMotion* pMotion )
-{ m_pMotion = pMotion; }
+{
+    m_pMotion = pMotion;
+    m_IsDirty = true;
+}
 
 //-------------------------------------------------------------------------------------------------
 //      ループ再生フラグを設定します.
@@ -58,6 +90,63 @@ void MotionPlayer::SetLoop( bool isLoop )
 bool MotionPlayer::IsLoop() const
 { return m_IsLoop; }
 
+//-------------------------------------------------------------------------------------------------
+//      モーションLODを設定します.
+//-------------------------------------------------------------------------------------------------
+void MotionPlayer::SetLod( MOTION_LOD lod )
+{
+    if ( m_Lod == lod )
+    { return; }
+
+    m_Lod     = lod;
+    m_IsDirty = true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      モーションLODを取得します.
+//-------------------------------------------------------------------------------------------------
+MOTION_LOD MotionPlayer::GetLod() const
+{ return m_Lod; }
+
+//-------------------------------------------------------------------------------------------------
+//      更新フレームのずらし量を設定します.
+//-------------------------------------------------------------------------------------------------
+void MotionPlayer::SetUpdatePhase( u32 phase )
+{
+    if ( m_UpdatePhase == phase )
+    { return; }
+
+    m_UpdatePhase = phase;
+    m_IsDirty     = true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ボーンマスクを設定します.
+//-------------------------------------------------------------------------------------------------
+void MotionPlayer::SetBoneMask( const u8* pMask )
+{
+    // 除外されていたボーンが古い姿勢のまま残らないように, 次の更新で全ボーンをサンプリングする.
+    m_pBoneMask = pMask;
+    m_IsDirty   = true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      IKソルバーを設定します.
+//-------------------------------------------------------------------------------------------------
+bool MotionPlayer::SetIKSolver( const IKSolver* pSolver )
+{
+    // ソルバーはボーン数分の行列を読み書きするため, 数が異なるものは受け付けない.
+    if ( pSolver != nullptr && m_BoneCount > 0 && pSolver->GetBoneCount() != m_BoneCount )
+    {
+        ELOG( "Error : IK Solver Bone Count Mismatch. solver = %u, player = %u",
+            pSolver->GetBoneCount(), m_BoneCount );
+        return false;
+    }
+
+    m_pIKSolver = pSolver;
+    return true;
+}
+
 //-------------------------------------------------------------------------------------------------
 //      ボーンを関連付けします.
 //-------------------------------------------------------------------------------------------------
@@ -66,15 +155,30 @@ void MotionPlayer::Bind( u32 boneCount, const ResBone* pBones )
     m_BoneCount = boneCount;
     m_pBones    = pBones;
 
+    if ( m_pIKSolver != nullptr && m_pIKSolver->GetBoneCount() != boneCount )
+    {
+        ELOG( "Error : IK Solver Bone Count Mismatch. solver = %u, player = %u",
+            m_pIKSolver->GetBoneCount(), boneCount );
+        m_pIKSolver = nullptr;
+    }
+
     m_BoneTransforms .resize( boneCount );
+    m_PrevTransforms .resize( boneCount );
+    m_NextTransforms .resize( boneCount );
     m_WorldTransforms.resize( boneCount );
     m_SkinTransforms .resize( boneCount );
+    m_IKTransforms   .resize( boneCount );
+
+    m_IsDirty = true;
 
     for( u32 i=0; i<boneCount; ++i )
     {
         m_BoneTransforms [i].Identity();
+        m_PrevTransforms [i].Identity();
+        m_NextTransforms [i].Identity();
         m_WorldTransforms[i].Identity();
         m_SkinTransforms [i].Identity();
+        m_IKTransforms   [i].Identity();
     }
 }
 
@@ -84,11 +188,15 @@ void MotionPlayer::Bind( u32 boneCount, const ResBone* pBones )
 void MotionPlayer::Unbind()
 {
     m_BoneTransforms .clear();
+    m_PrevTransforms .clear();
+    m_NextTransforms .clear();
     m_WorldTransforms.clear();
     m_SkinTransforms .clear();
+    m_IKTransforms   .clear();
 
     m_BoneCount = 0;
     m_pBones    = nullptr;
+    m_pBoneMask = nullptr;
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -107,7 +215,12 @@ u32 MotionPlayer::GetTransformCount() const
 //      ボーン行列を取得します.
 //-------------------------------------------------------------------------------------------------
 const Matrix* MotionPlayer::GetBoneTransforms() const
-{ return ( m_BoneCount > 0 ) ? &m_BoneTransforms[0] : nullptr; }
+{
+    if ( m_BoneCount == 0 )
+    { return nullptr; }
+
+    return ( m_pIKSolver != nullptr ) ? &m_IKTransforms[0] : &m_BoneTransforms[0];
+}
 
 //-------------------------------------------------------------------------------------------------
 //      ワールド行列を取得します.
@@ -121,6 +234,12 @@ const Matrix* MotionPlayer::GetWorldTransforms() const
 const Matrix* MotionPlayer::GetSkinTransforms() const
 { return ( m_BoneCount > 0 ) ? &m_SkinTransforms[0] : nullptr; }
 
+//-------------------------------------------------------------------------------------------------
+//      直前の更新でのIKの統計情報を取得します.
+//-------------------------------------------------------------------------------------------------
+const IKStatistics& MotionPlayer::GetIKStatistics() const
+{ return m_IKStatistics; }
+
 //-------------------------------------------------------------------------------------------------
 //      指定時間からボーン行列を計算します.
 //-------------------------------------------------------------------------------------------------
@@ -187,18 +306,93 @@ void MotionPlayer::Update( f32 elapsedTime )
     }
 
     // 行列を更新.
-    UpdateBoneTransforms ();
+    UpdateBoneTransforms ( elapsedTime );
     UpdateWorldTransforms();
+    UpdateIKTransforms   ();
     UpdateSkinTransforms ();
+
+    m_FrameCount++;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      指定時間のボーン行列をサンプリングします.
+//-------------------------------------------------------------------------------------------------
+void MotionPlayer::SampleBoneTransforms( f32 time, Matrix* pResult ) const
+{
+    auto count = Min( static_cast<u32>( m_pMotion->Bones.size() ), m_BoneCount );
+
+    // 初回はマスクに関わらず全ボーンをサンプリングし, 除外ボーンの姿勢を確定させる.
+    auto pMask = ( m_IsDirty ) ? nullptr : m_pBoneMask;
+
+    for( u32 i=0; i<count; ++i )
+    {
+        if ( pMask != nullptr && pMask[i] == 0 )
+        { continue; }
+
+        pResult[i] = CalcBoneMatrix( time, m_pMotion->Bones[i] );
+    }
 }
 
 //-------------------------------------------------------------------------------------------------
 //      ボーン行列を更新します.
 //-------------------------------------------------------------------------------------------------
-void MotionPlayer::UpdateBoneTransforms()
+void MotionPlayer::UpdateBoneTransforms( f32 elapsedTime )
 {
-    for( size_t i=0; i<m_pMotion->Bones.size(); ++i )
-    { m_BoneTransforms[i] = CalcBoneMatrix( m_FrameTime, m_pMotion->Bones[i] ); }
+    if ( m_BoneCount == 0 )
+    { return; }
+
+    auto interval = 1u << m_Lod;
+
+    if ( interval == 1 )
+    {
+        SampleBoneTransforms( m_FrameTime, &m_BoneTransforms[0] );
+        m_IsDirty = false;
+        return;
+    }
+
+    // 自分の担当フレームでのみサンプリングする.
+    auto offset = ( m_FrameCount + m_UpdatePhase ) & ( interval - 1 );
+    if ( m_IsDirty || offset == 0 )
+    {
+        // LOD変更直後は担当外のフレームでサンプリングするため, 次の担当フレームまでの区間を補間して位相を揃える.
+        m_LodSpan = interval - offset;
+
+        // 補間先は次のサンプリングフレームの直前の時刻とする.
+        auto time     = m_FrameTime + elapsedTime * static_cast<f32>( m_LodSpan - 1 );
+        auto duration = static_cast<f32>( m_pMotion->Duration );
+        if ( time >= duration )
+        {
+            if ( m_IsLoop && duration > 0.0f )
+            { time = fmodf( time, duration ); }
+            else
+            { time = duration; }
+        }
+
+        // 補間元は前フレームの時刻の姿勢とする.
+        if ( m_IsDirty )
+        {
+            SampleBoneTransforms( Max( m_FrameTime - elapsedTime, 0.0f ), &m_BoneTransforms[0] );
+            m_IsDirty = false;
+        }
+
+        m_PrevTransforms = m_BoneTransforms;
+        m_NextTransforms = m_BoneTransforms;
+        SampleBoneTransforms( time, &m_NextTransforms[0] );
+
+        m_LodStep = 0;
+    }
+
+    m_LodStep = Min( m_LodStep + 1, m_LodSpan );
+
+    // 間引いたフレームは前後のサンプリング結果を補間する.
+    auto ratio = static_cast<f32>( m_LodStep ) / static_cast<f32>( m_LodSpan );
+    for( u32 i=0; i<m_BoneCount; ++i )
+    {
+        if ( m_pBoneMask != nullptr && m_pBoneMask[i] == 0 )
+        { continue; }
+
+        m_BoneTransforms[i] = Matrix::Lerp( m_PrevTransforms[i], m_NextTransforms[i], ratio );
+    }
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -220,6 +414,25 @@ void MotionPlayer::UpdateWorldTransforms()
     }
 }
 
+//-------------------------------------------------------------------------------------------------
+//      IKを適用します.
+//-------------------------------------------------------------------------------------------------
+void MotionPlayer::UpdateIKTransforms()
+{
+    if ( m_pIKSolver == nullptr || m_BoneCount == 0 )
+    { return; }
+
+    // サンプリング結果は補間やボーンマスクで次のフレームも参照するため, 書き換えずにコピーしてから解く.
+    m_IKTransforms = m_BoneTransforms;
+    m_IKStatistics = IKStatistics();
+
+    // 設定後にソルバーが再初期化されてボーン数が変わった場合は解かない.
+    if ( m_pIKSolver->GetBoneCount() != m_BoneCount )
+    { return; }
+
+    m_pIKSolver->Solve( &m_IKTransforms[0], &m_WorldTransforms[0], &m_IKStatistics );
+}
+
 //-------------------------------------------------------------------------------------------------
 //      スキニング行列を更新します.
 //-------------------------------------------------------------------------------------------------
@@ -229,5 +442,79 @@ void MotionPlayer::UpdateSkinTransforms()
     { m_SkinTransforms[i] = m_pBones[i].InvBindPose * m_WorldTransforms[i]; }
 }
 
+//-------------------------------------------------------------------------------------------------
+//      画面上の大きさからモーションLODを選択します.
+//-------------------------------------------------------------------------------------------------
+MOTION_LOD SelectMotionLod( f32 radius, f32 distance, f32 fovY )
+{
+    auto denom = distance * tanf( fovY * 0.5f );
+    if ( denom <= F_EPSILON )
+    { return MOTION_LOD_FULL; }
+
+    auto ratio = radius / denom;
+    for( u32 i=0; i<MOTION_LOD_COUNT - 1; ++i )
+    {
+        if ( ratio >= MOTION_LOD_SCREEN_RATIO[i] )
+        { return static_cast<MOTION_LOD>( i ); }
+    }
+
+    return MOTION_LOD_EIGHTH;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      指定したボーン以下を除外した簡略化ボーンマスクを生成します.
+//-------------------------------------------------------------------------------------------------
+void CreateReducedBoneMask
+(
+    u32                     boneCount,
+    const ResBone*          pBones,
+    const char16* const*    pDropNames,
+    u32                     dropCount,
+    const char16* const*    pKeepNames,
+    u32                     keepCount,
+    std::vector<u8>&        result
+)
+{
+    result.resize( boneCount );
+
+    for( u32 i=0; i<boneCount; ++i )
+    {
+        result[i] = 1;
+
+        // 親が除外されていれば子も除外する.
+        auto parent = pBones[i].ParentId;
+        if ( parent != U32_MAX && parent < i && result[parent] == 0 )
+        {
+            result[i] = 0;
+            continue;
+        }
+
+        for( u32 j=0; j<dropCount; ++j )
+        {
+            if ( pBones[i].Name == pDropNames[j] )
+            {
+                result[i] = 0;
+                break;
+            }
+        }
+    }
+
+    // 明示的に指定されたボーンは除外範囲内でも更新する.
+    for( u32 i=0; i<boneCount; ++i )
+    {
+        if ( result[i] != 0 )
+        { continue; }
+
+        for( u32 j=0; j<keepCount; ++j )
+        {
+            if ( pBones[i].Name == pKeepNames[j] )
+            {
+                result[i] = 1;
+                break;
+            }
+        }
+    }
+}
+
 } // namespace asdx
 
@@ -0,0 +1,447 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxRenderQueue.cpp
+// Desc : Render Queue Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxRenderQueue.h>
+#include <asdxMath.h>
+#include <asdxStopWatch.h>
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------------
+// Constant Values.
+//-------------------------------------------------------------------------------------------------
+static constexpr u32 kRadixBits         = 8;
+static constexpr u32 kRadixSize         = 1u << kRadixBits;
+static constexpr u32 kMaxThreadCount    = 8;    // 帯域律速のためこれ以上増やしても速くならない.
+
+static constexpr u32 kPassShift         = 64 - asdx::RENDER_KEY_PASS_BITS;
+static constexpr u32 kTranslucentShift  = kPassShift - 1;
+static constexpr u64 kDepthMax          = ( u64(1) << asdx::RENDER_KEY_DEPTH_BITS ) - 1;
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Barrier class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class Barrier
+{
+public:
+    //---------------------------------------------------------------------------------------------
+    //      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    explicit Barrier( u32 count )
+    : m_Count     ( count )
+    , m_Waiting   ( 0 )
+    , m_Generation( 0 )
+    { /* DO_NOTHING */ }
+
+    //---------------------------------------------------------------------------------------------
+    //      全スレッドが到達するまで待機します.
+    //---------------------------------------------------------------------------------------------
+    void Wait()
+    {
+        if ( m_Count <= 1 )
+        { return; }
+
+        std::unique_lock<std::mutex> lock( m_Mutex );
+        auto generation = m_Generation;
+        if ( ++m_Waiting == m_Count )
+        {
+            m_Waiting = 0;
+            m_Generation++;
+            m_Condition.notify_all();
+            return;
+        }
+
+        m_Condition.wait( lock, [&]() { return generation != m_Generation; } );
+    }
+
+private:
+    std::mutex              m_Mutex;
+    std::condition_variable m_Condition;
+    u32                     m_Count;
+    u32                     m_Waiting;
+    u32                     m_Generation;
+};
+
+//-------------------------------------------------------------------------------------------------
+//      指定ビット数のマスクを取得します.
+//-------------------------------------------------------------------------------------------------
+constexpr u64 BitMask( u32 bits )
+{ return ( u64(1) << bits ) - 1; }
+
+} // namespace /* anonymous */
+
+
+namespace asdx {
+
+//-------------------------------------------------------------------------------------------------
+//      ソートキーを生成します.
+//-------------------------------------------------------------------------------------------------
+u64 MakeRenderKey( u32 pass, bool translucent, u32 pipelineId, u32 materialId, f32 depth )
+{
+    auto p = u64(pass)       & BitMask( RENDER_KEY_PASS_BITS );
+    auto s = u64(pipelineId) & BitMask( RENDER_KEY_PIPELINE_BITS );
+    auto m = u64(materialId) & BitMask( RENDER_KEY_MATERIAL_BITS );
+    auto d = static_cast<u64>( Clamp( depth, 0.0f, 1.0f ) * f32(kDepthMax) );
+
+    auto key = p << kPassShift;
+
+    // 不透明はステート切り替えを減らし, 同じステート内は手前から描画する.
+    if ( !translucent )
+    {
+        key |= s << ( RENDER_KEY_MATERIAL_BITS + RENDER_KEY_DEPTH_BITS );
+        key |= m << RENDER_KEY_DEPTH_BITS;
+        key |= d;
+        return key;
+    }
+
+    // 半透明は正しく合成するため奥から描画する.
+    key |= u64(1) << kTranslucentShift;
+    key |= ( kDepthMax - d ) << ( RENDER_KEY_PIPELINE_BITS + RENDER_KEY_MATERIAL_BITS );
+    key |= s << RENDER_KEY_MATERIAL_BITS;
+    key |= m;
+    return key;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ソートキーからパス番号を取得します.
+//-------------------------------------------------------------------------------------------------
+u32 GetRenderKeyPass( u64 key )
+{ return static_cast<u32>( key >> kPassShift ); }
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// RenderQueue class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+//-------------------------------------------------------------------------------------------------
+//      コンストラクタです.
+//-------------------------------------------------------------------------------------------------
+RenderQueue::RenderQueue()
+: m_Items       ()
+, m_Entries     ()
+, m_Temp        ()
+, m_Histograms  ()
+, m_ThreadCount ( 0 )
+, m_Statistics  ()
+{ SetThreadCount( 0 ); }
+
+//-------------------------------------------------------------------------------------------------
+//      デストラクタです.
+//-------------------------------------------------------------------------------------------------
+RenderQueue::~RenderQueue()
+{ /* DO_NOTHING */ }
+
+//-------------------------------------------------------------------------------------------------
+//      メモリを予約します.
+//-------------------------------------------------------------------------------------------------
+void RenderQueue::Reserve( u32 count )
+{
+    m_Items  .reserve( count );
+    m_Entries.reserve( count );
+    m_Temp   .reserve( count );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ソートに使用するスレッド数を設定します.
+//-------------------------------------------------------------------------------------------------
+void RenderQueue::SetThreadCount( u32 count )
+{
+    if ( count == 0 )
+    { count = std::thread::hardware_concurrency(); }
+
+    m_ThreadCount = Clamp( count, 1u, kMaxThreadCount );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      キューを空にします.
+//-------------------------------------------------------------------------------------------------
+void RenderQueue::Clear()
+{
+    m_Items  .clear();
+    m_Entries.clear();
+}
+
+//-------------------------------------------------------------------------------------------------
+//      描画を追加します.
+//-------------------------------------------------------------------------------------------------
+void RenderQueue::Push( u64 key, const RenderItem& item )
+{
+    Entry entry;
+    entry.Key       = key;
+    entry.Index     = static_cast<u32>( m_Items.size() );
+    entry.BindFlags = RENDER_BIND_FLAG_ALL;
+
+    m_Items  .push_back( item );
+    m_Entries.push_back( entry );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ソートキーの昇順に並べ, 直前と同じステートの設定を除去します.
+//-------------------------------------------------------------------------------------------------
+void RenderQueue::Sort()
+{
+    auto count = static_cast<u32>( m_Entries.size() );
+    auto threadCount = ( count >= kParallelThreshold ) ? m_ThreadCount : 1u;
+
+    StopWatch timer;
+
+    timer.Start();
+    RadixSort( threadCount );
+    timer.End();
+    m_Statistics.SortTime = f64(timer.GetElpasedNanoSec()) / 1000000.0;
+
+    timer.Start();
+    Dedupe();
+    timer.End();
+    m_Statistics.DedupeTime = f64(timer.GetElpasedNanoSec()) / 1000000.0;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      基数ソートを行います.
+//-------------------------------------------------------------------------------------------------
+void RenderQueue::RadixSort( u32 threadCount )
+{
+    auto count = static_cast<u32>( m_Entries.size() );
+    if ( count <= 1 )
+    { return; }
+
+    m_Temp.resize( count );
+    m_Histograms.resize( threadCount * kRadixSize );
+
+    Barrier barrier( threadCount );
+    auto    chunk     = ( count + threadCount - 1 ) / threadCount;
+    auto    skipPass  = false;
+    u32     sortCount = 0;
+
+    auto worker = [&]( u32 threadId )
+    {
+        auto begin = Min( threadId * chunk, count );
+        auto end   = Min( begin + chunk, count );
+        auto pHist = m_Histograms.data() + threadId * kRadixSize;
+        auto pSrc  = m_Entries.data();
+        auto pDst  = m_Temp.data();
+
+        for( u32 shift=0; shift<64; shift+=kRadixBits )
+        {
+            // ブロックごとのヒストグラム.
+            memset( pHist, 0, sizeof(u32) * kRadixSize );
+            for( u32 i=begin; i<end; ++i )
+            { pHist[( pSrc[i].Key >> shift ) & ( kRadixSize - 1 )]++; }
+
+            barrier.Wait();
+
+            // 全要素が同じ桁は飛ばし, それ以外はブロック順に書き込み位置を割り当てる.
+            if ( threadId == 0 )
+            {
+                skipPass = false;
+                for( u32 d=0; d<kRadixSize && !skipPass; ++d )
+                {
+                    u32 total = 0;
+                    for( u32 t=0; t<threadCount; ++t )
+                    { total += m_Histograms[t * kRadixSize + d]; }
+
+                    skipPass = ( total == count );
+                }
+
+                if ( !skipPass )
+                {
+                    u32 sum = 0;
+                    for( u32 d=0; d<kRadixSize; ++d )
+                    {
+                        for( u32 t=0; t<threadCount; ++t )
+                        {
+                            auto& value = m_Histograms[t * kRadixSize + d];
+                            auto  c     = value;
+                            value = sum;
+                            sum  += c;
+                        }
+                    }
+                    sortCount++;
+                }
+            }
+
+            barrier.Wait();
+
+            if ( !skipPass )
+            {
+                for( u32 i=begin; i<end; ++i )
+                { pDst[pHist[( pSrc[i].Key >> shift ) & ( kRadixSize - 1 )]++] = pSrc[i]; }
+
+                std::swap( pSrc, pDst );
+            }
+
+            barrier.Wait();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve( threadCount - 1 );
+    for( u32 i=1; i<threadCount; ++i )
+    { threads.emplace_back( worker, i ); }
+
+    worker( 0 );
+
+    for( auto& thread : threads )
+    { thread.join(); }
+
+    // 奇数回書き込んだ場合は作業領域側に結果がある.
+    if ( sortCount & 0x1 )
+    { m_Entries.swap( m_Temp ); }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      冗長なステート設定を除去します.
+//-------------------------------------------------------------------------------------------------
+void RenderQueue::Dedupe()
+{
+    auto count = static_cast<u32>( m_Entries.size() );
+
+    m_Statistics.DrawCount     = count;
+    m_Statistics.PipelineBinds = 0;
+    m_Statistics.MaterialBinds = 0;
+    m_Statistics.GeometryBinds = 0;
+
+    const RenderItem* pPrev = nullptr;
+    for( u32 i=0; i<count; ++i )
+    {
+        auto& entry = m_Entries[i];
+        const auto& item = m_Items[entry.Index];
+
+        u32 flags = RENDER_BIND_FLAG_ALL;
+        if ( pPrev != nullptr )
+        {
+            flags = RENDER_BIND_FLAG_NONE;
+            if ( item.PipelineId != pPrev->PipelineId ) { flags |= RENDER_BIND_FLAG_PIPELINE; }
+            if ( item.MaterialId != pPrev->MaterialId ) { flags |= RENDER_BIND_FLAG_MATERIAL; }
+            if ( item.GeometryId != pPrev->GeometryId ) { flags |= RENDER_BIND_FLAG_GEOMETRY; }
+        }
+
+        entry.BindFlags = flags;
+
+        if ( flags & RENDER_BIND_FLAG_PIPELINE ) { m_Statistics.PipelineBinds++; }
+        if ( flags & RENDER_BIND_FLAG_MATERIAL ) { m_Statistics.MaterialBinds++; }
+        if ( flags & RENDER_BIND_FLAG_GEOMETRY ) { m_Statistics.GeometryBinds++; }
+
+        pPrev = &item;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      指定パスの範囲を検索します.
+//-------------------------------------------------------------------------------------------------
+u32 RenderQueue::FindPassRange( u32 pass, u32* pBegin, u32* pEnd ) const
+{
+    auto less = []( const Entry& entry, u64 key ) { return entry.Key < key; };
+
+    auto lower = u64(pass) << kPassShift;
+    auto first = std::lower_bound( m_Entries.begin(), m_Entries.end(), lower, less );
+    auto last  = m_Entries.end();
+
+    if ( pass < BitMask( RENDER_KEY_PASS_BITS ) )
+    { last = std::lower_bound( first, m_Entries.end(), u64(pass + 1) << kPassShift, less ); }
+    else if ( pass > BitMask( RENDER_KEY_PASS_BITS ) )
+    { first = last; }
+
+    auto begin = static_cast<u32>( first - m_Entries.begin() );
+    auto end   = static_cast<u32>( last  - m_Entries.begin() );
+
+    if ( pBegin != nullptr ) { *pBegin = begin; }
+    if ( pEnd   != nullptr ) { *pEnd   = end; }
+
+    return end - begin;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      描画コマンドを発行します.
+//-------------------------------------------------------------------------------------------------
+void RenderQueue::Execute
+(
+    ID3D12GraphicsCommandList*  pCmd,
+    const RenderStateTable&     table,
+    u32                         begin,
+    u32                         end
+) const
+{
+    if ( pCmd == nullptr )
+    { return; }
+
+    end = Min( end, static_cast<u32>( m_Entries.size() ) );
+
+    for( u32 i=begin; i<end; ++i )
+    {
+        const auto& entry = m_Entries[i];
+        const auto& item  = m_Items[entry.Index];
+        auto flags = ( i == begin ) ? u32(RENDER_BIND_FLAG_ALL) : entry.BindFlags;
+
+        if ( ( flags & RENDER_BIND_FLAG_PIPELINE ) && table.ppPipelineStates != nullptr )
+        { pCmd->SetPipelineState( table.ppPipelineStates[item.PipelineId] ); }
+
+        if ( ( flags & RENDER_BIND_FLAG_MATERIAL ) && table.pMaterialTables != nullptr )
+        {
+            auto pTables = table.pMaterialTables + item.MaterialId * table.MaterialTableCount;
+            for( u32 j=0; j<table.MaterialTableCount; ++j )
+            { pCmd->SetGraphicsRootDescriptorTable( table.MaterialRootIndex + j, pTables[j] ); }
+        }
+
+        if ( flags & RENDER_BIND_FLAG_GEOMETRY )
+        {
+            if ( table.pVertexBufferViews != nullptr )
+            { pCmd->IASetVertexBuffers( 0, 1, &table.pVertexBufferViews[item.GeometryId] ); }
+
+            if ( table.pIndexBufferViews != nullptr )
+            { pCmd->IASetIndexBuffer( &table.pIndexBufferViews[item.GeometryId] ); }
+        }
+
+        pCmd->DrawIndexedInstanced(
+            item.IndexCount,
+            item.InstanceCount,
+            item.StartIndex,
+            item.BaseVertex,
+            item.StartInstance );
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      描画数を取得します.
+//-------------------------------------------------------------------------------------------------
+u32 RenderQueue::GetCount() const
+{ return static_cast<u32>( m_Entries.size() ); }
+
+//-------------------------------------------------------------------------------------------------
+//      ソート後の描画データを取得します.
+//-------------------------------------------------------------------------------------------------
+const RenderItem& RenderQueue::GetItem( u32 index ) const
+{ return m_Items[m_Entries[index].Index]; }
+
+//-------------------------------------------------------------------------------------------------
+//      ソート後のソートキーを取得します.
+//-------------------------------------------------------------------------------------------------
+u64 RenderQueue::GetKey( u32 index ) const
+{ return m_Entries[index].Key; }
+
+//-------------------------------------------------------------------------------------------------
+//      ソート後の描画で必要なステート設定を取得します.
+//-------------------------------------------------------------------------------------------------
+u32 RenderQueue::GetBindFlags( u32 index ) const
+{ return m_Entries[index].BindFlags; }
+
+//-------------------------------------------------------------------------------------------------
+//      直前の Sort() の統計情報を取得します.
+//-------------------------------------------------------------------------------------------------
+const RenderQueueStatistics& RenderQueue::GetStatistics() const
+{ return m_Statistics; }
+
+} // namespace asdx
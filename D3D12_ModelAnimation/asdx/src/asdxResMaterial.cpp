@@ -31,7 +31,7 @@ bool MaterialFactory::Create( const char16* filename, ResMaterial* pResult )
     if ( ext == L"mat" )
     { return LoadResMaterialFromMAT( filename, pResult ); }
 
-    ELOG( "Error : Invalid File Format. Extension is %s", ext.c_str() );
+    ELOG( "Error : Invalid File Format. Extension is %ls", ext.c_str() );
     return false;
 }
 
@@ -35,7 +35,27 @@ bool MeshFactory::Create( const char16* filename, ResMesh* pResult )
     if ( ext == L"msh" )
     { return LoadResMeshFromMSH( filename, pResult ); }
 
-    ELOG( "Error : Invalid File FOrmat. Extension is %s", ext.c_str() );;
+    ELOG( "Error : Invalid File FOrmat. Extension is %ls", ext.c_str() );;
+    return false;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      メッシュファイルをマッピングします.
+//-------------------------------------------------------------------------------------------------
+bool MeshFactory::Map( const char16* filename, MappedFile* pFile, ResMeshView* pResult )
+{
+    if ( filename == nullptr || pFile == nullptr || pResult == nullptr )
+    {
+        ELOG( "Error : Invalid Argument." );
+        return false;
+    }
+
+    auto ext = GetExt( filename );
+
+    if ( ext == L"msh" )
+    { return MapResMeshFromMSH( filename, pFile, pResult ); }
+
+    ELOG( "Error : Invalid File FOrmat. Extension is %ls", ext.c_str() );;
     return false;
 }
 
@@ -55,8 +75,46 @@ void MeshFactory::Dispose( ResMesh*& ptr )
     ptr->VertexIndices.clear();
     ptr->Subsets      .clear();
     ptr->Bones        .clear();
+    ptr->Lods         .clear();
+    ptr->LodIndices   .clear();
+    ptr->LodSubsets   .clear();
+    ptr->VertexStreams.clear();
+    ptr->VertexLayout = ResVertexLayout();
 
     SafeDelete( ptr );
 }
 
+//-------------------------------------------------------------------------------------------------
+//      画面上の誤差から詳細度を選択します.
+//-------------------------------------------------------------------------------------------------
+u32 SelectMeshLod
+(
+    const ResLod*   pLods,
+    u32             lodCount,
+    f32             scale,
+    f32             distance,
+    f32             fovY,
+    f32             screenHeight,
+    f32             pixelThreshold
+)
+{
+    auto denom = distance * tanf( fovY * 0.5f );
+    if ( pLods == nullptr || denom <= F_EPSILON )
+    { return 0; }
+
+    // オブジェクト空間の誤差1単位あたりのピクセル数.
+    auto pixelPerUnit = scale * screenHeight * 0.5f / denom;
+
+    u32 result = 0;
+    for( u32 i=0; i<lodCount; ++i )
+    {
+        if ( pLods[i].Error * pixelPerUnit > pixelThreshold )
+        { break; }
+
+        result = i + 1;
+    }
+
+    return result;
+}
+
 } // namespace asdx
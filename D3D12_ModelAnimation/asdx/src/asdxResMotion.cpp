@@ -35,7 +35,7 @@ bool MotionFactory::Create( const char16* filename, ResMotion* pResult )
     if ( ext == L"mtn" )
     { return LoadResMotionFromMTN( filename, pResult ); }
 
-    ELOG( "Error : Invalid File Format. Extension is %s", ext.c_str() );
+    ELOG( "Error : Invalid File Format. Extension is %ls", ext.c_str() );
     return false;
 }
 
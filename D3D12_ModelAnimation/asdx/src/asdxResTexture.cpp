@@ -10,6 +10,7 @@
 #include <asdxResTexture.h>
 #include <asdxLogger.h>
 #include <asdxMisc.h>
+#include <cstring>
 #include "formats/asdxResTGA.h"
 #include "formats/asdxResDDS.h"
 #include "formats/asdxResHDR.h"
@@ -54,7 +55,27 @@ bool TextureFactory::Create( const char16* filename, ResTexture* pResult )
               ext == L"hdp")
     { return LoadResTextureFromWIC( filename, pResult ); }
 
-    ELOG( "Error : Invalid File Format. Extension is %s", ext.c_str() );
+    ELOG( "Error : Invalid File Format. Extension is %ls", ext.c_str() );
+    return false;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      テクスチャファイルをマッピングします.
+//-------------------------------------------------------------------------------------------------
+bool TextureFactory::Map( const char16* filename, MappedFile* pFile, ResTextureView* pResult )
+{
+    if ( filename == nullptr || pFile == nullptr || pResult == nullptr )
+    {
+        ELOG( "Error : Invalid Argument." );
+        return false;
+    }
+
+    auto ext = GetExt( filename );
+
+    if ( ext == L"dds" )
+    { return MapResTextureFromDDS( filename, pFile, pResult ); }
+
+    ELOG( "Error : Invalid File Format. Extension is %ls", ext.c_str() );
     return false;
 }
 
@@ -79,5 +100,39 @@ void TextureFactory::Dispose( ResTexture*& ptr )
     SafeDelete( ptr );
 }
 
-} // namespace asdx
+//-------------------------------------------------------------------------------------------------
+//      テクスチャビューのピクセルデータをステージングバッファに書き込みます.
+//-------------------------------------------------------------------------------------------------
+void WriteToStagingBuffer( const ResTextureView& view, void* pDst )
+{
+    auto pBase = static_cast<u8*>( pDst );
+
+    for( size_t i=0; i<view.Surfaces.size(); ++i )
+    {
+        auto& surface   = view.Surfaces  [i];
+        auto& footprint = view.Footprints[i];
 
+        for( u32 z=0; z<footprint.Depth; ++z )
+        {
+            auto pSrc   = surface.pPixels + size_t( surface.SlicePitch ) * z;
+            auto pSlice = pBase + footprint.Offset + u64( footprint.RowPitch ) * footprint.RowCount * z;
+
+            // 行ピッチが一致する場合は1回でコピー.
+            if ( footprint.RowPitch == surface.RowPitch )
+            {
+                memcpy( pSlice, pSrc, size_t( footprint.RowPitch ) * footprint.RowCount );
+                continue;
+            }
+
+            for( u32 y=0; y<footprint.RowCount; ++y )
+            {
+                memcpy(
+                    pSlice + size_t( footprint.RowPitch ) * y,
+                    pSrc   + size_t( surface.RowPitch   ) * y,
+                    footprint.RowSize );
+            }
+        }
+    }
+}
+
+} // namespace asdx
@@ -59,7 +59,7 @@ bool Shader::Compile(const char16* filename, const char8* entryPoint, const char
 
     if ( FAILED(hr) )
     {
-        ELOG( "Error : D3DCompileFromFile() Failed. filename = %s, entryPoint = %s, shaderModel = %s",
+        ELOG( "Error : D3DCompileFromFile() Failed. filename = %ls, entryPoint = %s, shaderModel = %s",
             filename,
             entryPoint,
             shaderModel );
@@ -82,7 +82,7 @@ bool Shader::Load( const char16* filename )
     auto hr = D3DReadFileToBlob(filename, m_Blob.GetAddress());
     if ( FAILED(hr) )
     {
-        ELOG( "Error : D3DReadFileToBlob() Failed. filename = %s", filename );
+        ELOG( "Error : D3DReadFileToBlob() Failed. filename = %ls", filename );
         return false;
     }
 
@@ -0,0 +1,511 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxVertexStream.cpp
+// Desc : Vertex Stream Layout Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxVertexStream.h>
+#include <asdxMeshQuantizer.h>
+#include <asdxLogger.h>
+#include <asdxMisc.h>
+#include <cstring>
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------------
+// Constant Values.
+//-------------------------------------------------------------------------------------------------
+static constexpr u32 kStreamAlignment = 16;
+static constexpr u32 kAllPassMask     = ( 1u << asdx::VERTEX_PASS_COUNT ) - 1;
+
+static const char* kSemanticNames[asdx::VERTEX_ATTRIBUTE_COUNT] = {
+    "POSITION",
+    "NORMAL",
+    "TEXCOORD",
+    "BONE_INDEX",
+    "BONE_WEIGHT",
+};
+
+//-------------------------------------------------------------------------------------------------
+//      パスのビットを取得します.
+//-------------------------------------------------------------------------------------------------
+constexpr u32 PassBit( asdx::VERTEX_PASS pass )
+{ return 1u << u32(pass); }
+
+//-------------------------------------------------------------------------------------------------
+//      フォーマットのバイト数を取得します.
+//-------------------------------------------------------------------------------------------------
+u32 GetFormatSize( DXGI_FORMAT format )
+{
+    switch( format )
+    {
+    case DXGI_FORMAT_R32G32B32A32_FLOAT:
+    case DXGI_FORMAT_R32G32B32A32_UINT:
+        return 16;
+
+    case DXGI_FORMAT_R32G32B32_FLOAT:
+        return 12;
+
+    case DXGI_FORMAT_R32G32_FLOAT:
+    case DXGI_FORMAT_R16G16B16A16_UNORM:
+    case DXGI_FORMAT_R16G16B16A16_UINT:
+        return 8;
+
+    case DXGI_FORMAT_R16G16_SNORM:
+    case DXGI_FORMAT_R16G16_FLOAT:
+    case DXGI_FORMAT_R8G8B8A8_UINT:
+    case DXGI_FORMAT_R8G8B8A8_UNORM:
+        return 4;
+
+    default:
+        return 0;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      頂点属性を使用するパスを取得します.
+//-------------------------------------------------------------------------------------------------
+u32 GetPassMask( asdx::VERTEX_ATTRIBUTE attribute )
+{
+    switch( attribute )
+    {
+    // スキニングは全パスで必要.
+    case asdx::VERTEX_ATTRIBUTE_POSITION:
+    case asdx::VERTEX_ATTRIBUTE_BONE_INDEX:
+    case asdx::VERTEX_ATTRIBUTE_BONE_WEIGHT:
+        return kAllPassMask;
+
+    case asdx::VERTEX_ATTRIBUTE_TEXCOORD:
+        return PassBit( asdx::VERTEX_PASS_ALPHA_TEST ) | PassBit( asdx::VERTEX_PASS_FORWARD );
+
+    case asdx::VERTEX_ATTRIBUTE_NORMAL:
+    default:
+        return PassBit( asdx::VERTEX_PASS_FORWARD );
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      頂点属性のフォーマットを選択します.
+//-------------------------------------------------------------------------------------------------
+DXGI_FORMAT SelectFormat( asdx::VERTEX_ATTRIBUTE attribute, bool quantize, u32 maxBoneIndex )
+{
+    switch( attribute )
+    {
+    case asdx::VERTEX_ATTRIBUTE_POSITION:
+        return ( quantize ) ? DXGI_FORMAT_R16G16B16A16_UNORM : DXGI_FORMAT_R32G32B32_FLOAT;
+
+    case asdx::VERTEX_ATTRIBUTE_NORMAL:
+        return ( quantize ) ? DXGI_FORMAT_R16G16_SNORM : DXGI_FORMAT_R32G32B32_FLOAT;
+
+    case asdx::VERTEX_ATTRIBUTE_TEXCOORD:
+        return ( quantize ) ? DXGI_FORMAT_R16G16_FLOAT : DXGI_FORMAT_R32G32_FLOAT;
+
+    case asdx::VERTEX_ATTRIBUTE_BONE_INDEX:
+        {
+            if ( !quantize )
+            { return DXGI_FORMAT_R32G32B32A32_UINT; }
+
+            return ( maxBoneIndex <= 0xFF ) ? DXGI_FORMAT_R8G8B8A8_UINT : DXGI_FORMAT_R16G16B16A16_UINT;
+        }
+
+    case asdx::VERTEX_ATTRIBUTE_BONE_WEIGHT:
+        return ( quantize ) ? DXGI_FORMAT_R8G8B8A8_UNORM : DXGI_FORMAT_R32G32B32A32_FLOAT;
+
+    default:
+        return DXGI_FORMAT_UNKNOWN;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      頂点属性を1頂点分書き込みます.
+//-------------------------------------------------------------------------------------------------
+void WriteAttribute
+(
+    const asdx::ResMesh*                pMesh,
+    const asdx::ResVertexElement&       element,
+    const asdx::PositionQuantization&   quantization,
+    u32                                 index,
+    u8*                                 pDst
+)
+{
+    switch( element.Format )
+    {
+    case DXGI_FORMAT_R32G32B32_FLOAT:
+        {
+            const auto& src = ( element.Attribute == asdx::VERTEX_ATTRIBUTE_POSITION )
+                ? pMesh->Positions[index]
+                : pMesh->Normals  [index];
+            f32 value[3] = { src.x, src.y, src.z };
+            memcpy( pDst, value, sizeof(value) );
+        }
+        break;
+
+    case DXGI_FORMAT_R16G16B16A16_UNORM:
+        {
+            u16 value[4] = {};
+            asdx::QuantizePosition( pMesh->Positions[index], quantization, value );
+            memcpy( pDst, value, sizeof(value) );
+        }
+        break;
+
+    case DXGI_FORMAT_R16G16_SNORM:
+        {
+            s16 value[2];
+            asdx::EncodeOctahedral( pMesh->Normals[index], value );
+            memcpy( pDst, value, sizeof(value) );
+        }
+        break;
+
+    case DXGI_FORMAT_R32G32_FLOAT:
+        {
+            const auto& src = pMesh->TexCoords[index];
+            f32 value[2] = { src.x, src.y };
+            memcpy( pDst, value, sizeof(value) );
+        }
+        break;
+
+    case DXGI_FORMAT_R16G16_FLOAT:
+        {
+            const auto& src = pMesh->TexCoords[index];
+            f16 value[2] = { asdx::EncodeHalf( src.x ), asdx::EncodeHalf( src.y ) };
+            memcpy( pDst, value, sizeof(value) );
+        }
+        break;
+
+    case DXGI_FORMAT_R32G32B32A32_UINT:
+        {
+            const auto& src = pMesh->BoneIndices[index];
+            u32 value[4] = { src.x, src.y, src.z, src.w };
+            memcpy( pDst, value, sizeof(value) );
+        }
+        break;
+
+    case DXGI_FORMAT_R16G16B16A16_UINT:
+        {
+            const auto& src = pMesh->BoneIndices[index];
+            u16 value[4] = { u16(src.x), u16(src.y), u16(src.z), u16(src.w) };
+            memcpy( pDst, value, sizeof(value) );
+        }
+        break;
+
+    case DXGI_FORMAT_R8G8B8A8_UINT:
+        {
+            const auto& src = pMesh->BoneIndices[index];
+            u8 value[4] = { u8(src.x), u8(src.y), u8(src.z), u8(src.w) };
+            memcpy( pDst, value, sizeof(value) );
+        }
+        break;
+
+    case DXGI_FORMAT_R32G32B32A32_FLOAT:
+        {
+            const auto& src = pMesh->BoneWeights[index];
+            f32 value[4] = { src.x, src.y, src.z, src.w };
+            memcpy( pDst, value, sizeof(value) );
+        }
+        break;
+
+    case DXGI_FORMAT_R8G8B8A8_UNORM:
+        {
+            const auto& src = pMesh->BoneWeights[index];
+            f32 weights[4] = { src.x, src.y, src.z, src.w };
+            u8  value[4];
+            asdx::QuantizeBoneWeights( weights, 4, value );
+            memcpy( pDst, value, sizeof(value) );
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+} // namespace /* anonymous */
+
+
+namespace asdx {
+
+//-------------------------------------------------------------------------------------------------
+//      頂点属性をパスごとの使用状況でストリームに振り分けます.
+//-------------------------------------------------------------------------------------------------
+bool PlanVertexStreams( const ResMesh* pMesh, u32 flags, ResVertexLayout* pResult )
+{
+    if ( pMesh == nullptr || pResult == nullptr || pMesh->Positions.empty() )
+    {
+        ELOG( "Error : Invalid Argument." );
+        return false;
+    }
+
+    auto vertexCount = static_cast<u32>( pMesh->Positions.size() );
+    auto quantize    = ( flags & VERTEX_STREAM_FLAG_QUANTIZE ) != 0;
+
+    // 頂点数と一致する属性のみ格納する.
+    bool exist[VERTEX_ATTRIBUTE_COUNT] = {};
+    exist[VERTEX_ATTRIBUTE_POSITION] = true;
+    exist[VERTEX_ATTRIBUTE_NORMAL]   = ( pMesh->Normals  .size() == vertexCount );
+    exist[VERTEX_ATTRIBUTE_TEXCOORD] = ( pMesh->TexCoords.size() == vertexCount );
+
+    auto skinned = ( pMesh->BoneIndices.size() == vertexCount )
+                && ( pMesh->BoneWeights.size() == vertexCount );
+    exist[VERTEX_ATTRIBUTE_BONE_INDEX]  = skinned;
+    exist[VERTEX_ATTRIBUTE_BONE_WEIGHT] = skinned;
+
+    u32 maxBoneIndex = 0;
+    if ( skinned )
+    {
+        for( const auto& index : pMesh->BoneIndices )
+        { maxBoneIndex = Max( maxBoneIndex, Max( Max( index.x, index.y ), Max( index.z, index.w ) ) ); }
+
+        if ( quantize && maxBoneIndex > 0xFFFF )
+        {
+            ELOG( "Error : Bone Index Out Of Range. maxBoneIndex = %u", maxBoneIndex );
+            return false;
+        }
+    }
+
+    ResVertexLayout layout = {};
+    layout.VertexCount = vertexCount;
+    layout.Flags       = flags;
+
+    for( u32 i=0; i<VERTEX_ATTRIBUTE_COUNT; ++i )
+    {
+        if ( !exist[i] )
+        { continue; }
+
+        auto attribute = static_cast<VERTEX_ATTRIBUTE>( i );
+        auto format    = SelectFormat( attribute, quantize, maxBoneIndex );
+        auto mask      = GetPassMask( attribute );
+
+        // 位置座標は必ず単独のストリーム 0 とし, 他の属性は同じパスで使うもの同士をまとめる.
+        u32 stream = layout.StreamCount;
+        if ( attribute != VERTEX_ATTRIBUTE_POSITION )
+        {
+            for( u32 j=1; j<layout.StreamCount; ++j )
+            {
+                if ( layout.Streams[j].PassMask == mask )
+                {
+                    stream = j;
+                    break;
+                }
+            }
+        }
+
+        if ( stream == layout.StreamCount )
+        {
+            layout.Streams[stream].PassMask = mask;
+            layout.StreamCount++;
+        }
+
+        auto& element = layout.Elements[layout.ElementCount++];
+        element.Attribute = attribute;
+        element.Format    = format;
+        element.Stream    = stream;
+        element.Offset    = layout.Streams[stream].Stride;
+
+        layout.Streams[stream].Stride += GetFormatSize( format );
+    }
+
+    // ストリームを16バイト境界に並べる.
+    u64 offset = 0;
+    for( u32 i=0; i<layout.StreamCount; ++i )
+    {
+        auto& stream = layout.Streams[i];
+        auto  size   = u64(stream.Stride) * vertexCount;
+        if ( offset + size > U32_MAX )
+        {
+            ELOG( "Error : Vertex Stream Too Large." );
+            return false;
+        }
+
+        stream.Offset = static_cast<u32>( offset );
+        stream.Size   = static_cast<u32>( size );
+        offset = RoundUp( offset + size, u64(kStreamAlignment) );
+    }
+
+    if ( quantize )
+    {
+        auto quantization = ComputePositionQuantization( pMesh->Positions.data(), vertexCount );
+        layout.QuantizeScale  = quantization.Scale;
+        layout.QuantizeOffset = quantization.Offset;
+    }
+    else
+    {
+        layout.QuantizeScale  = Vector3( 1.0f, 1.0f, 1.0f );
+        layout.QuantizeOffset = Vector3( 0.0f, 0.0f, 0.0f );
+    }
+
+    *pResult = layout;
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      頂点ストリームを構築し, メッシュに格納します.
+//-------------------------------------------------------------------------------------------------
+bool BuildVertexStreams( ResMesh* pMesh, u32 flags )
+{
+    ResVertexLayout layout;
+    if ( !PlanVertexStreams( pMesh, flags, &layout ) )
+    { return false; }
+
+    size_t totalSize = 0;
+    for( u32 i=0; i<layout.StreamCount; ++i )
+    { totalSize = Max( totalSize, size_t(layout.Streams[i].Offset) + layout.Streams[i].Size ); }
+
+    PositionQuantization quantization;
+    quantization.Scale  = layout.QuantizeScale;
+    quantization.Offset = layout.QuantizeOffset;
+
+    std::vector<u8> streams( RoundUp( u64(totalSize), u64(kStreamAlignment) ), 0 );
+
+    for( u32 i=0; i<layout.ElementCount; ++i )
+    {
+        const auto& element = layout.Elements[i];
+        const auto& stream  = layout.Streams[element.Stream];
+
+        auto pDst = streams.data() + stream.Offset + element.Offset;
+        for( u32 v=0; v<layout.VertexCount; ++v, pDst += stream.Stride )
+        { WriteAttribute( pMesh, element, quantization, v, pDst ); }
+    }
+
+    pMesh->VertexLayout = layout;
+    pMesh->VertexStreams.swap( streams );
+
+    ILOG( "Info : Vertex Streams. stream count = %u, depth = %u bytes, alpha test = %u bytes, forward = %u bytes",
+        layout.StreamCount,
+        GetVertexFetchSize( layout, VERTEX_PASS_DEPTH ),
+        GetVertexFetchSize( layout, VERTEX_PASS_ALPHA_TEST ),
+        GetVertexFetchSize( layout, VERTEX_PASS_FORWARD ) );
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      パスで使用するストリーム番号を取得します.
+//-------------------------------------------------------------------------------------------------
+u32 GetVertexStreams( const ResVertexLayout& layout, VERTEX_PASS pass, u32* pStreams )
+{
+    if ( u32(pass) >= VERTEX_PASS_COUNT )
+    { return 0; }
+
+    u32 count = 0;
+    for( u32 i=0; i<layout.StreamCount && i<VERTEX_ATTRIBUTE_COUNT; ++i )
+    {
+        if ( ( layout.Streams[i].PassMask & PassBit( pass ) ) == 0 )
+        { continue; }
+
+        if ( pStreams != nullptr )
+        { pStreams[count] = i; }
+
+        count++;
+    }
+
+    return count;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      パスで読み込む1頂点あたりのバイト数を取得します.
+//-------------------------------------------------------------------------------------------------
+u32 GetVertexFetchSize( const ResVertexLayout& layout, VERTEX_PASS pass )
+{
+    u32 streams[VERTEX_ATTRIBUTE_COUNT];
+    auto count = GetVertexStreams( layout, pass, streams );
+
+    u32 result = 0;
+    for( u32 i=0; i<count; ++i )
+    { result += layout.Streams[streams[i]].Stride; }
+
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      パスに対応する入力要素を取得します.
+//-------------------------------------------------------------------------------------------------
+bool GetInputElements
+(
+    const ResVertexLayout&                  layout,
+    VERTEX_PASS                             pass,
+    std::vector<D3D12_INPUT_ELEMENT_DESC>&  elementDesc
+)
+{
+    elementDesc.clear();
+
+    if ( u32(pass) >= VERTEX_PASS_COUNT
+      || layout.StreamCount  == 0 || layout.StreamCount  > VERTEX_ATTRIBUTE_COUNT
+      || layout.ElementCount == 0 || layout.ElementCount > VERTEX_ATTRIBUTE_COUNT )
+    {
+        ELOG( "Error : Invalid Argument." );
+        return false;
+    }
+
+    // ストリーム番号から入力スロット番号への変換表.
+    u32 slots[VERTEX_ATTRIBUTE_COUNT];
+    for( u32 i=0; i<VERTEX_ATTRIBUTE_COUNT; ++i )
+    { slots[i] = U32_MAX; }
+
+    u32 streams[VERTEX_ATTRIBUTE_COUNT];
+    auto count = GetVertexStreams( layout, pass, streams );
+    for( u32 i=0; i<count; ++i )
+    { slots[streams[i]] = i; }
+
+    elementDesc.reserve( layout.ElementCount );
+
+    for( u32 i=0; i<layout.ElementCount; ++i )
+    {
+        const auto& element = layout.Elements[i];
+        if ( element.Attribute >= VERTEX_ATTRIBUTE_COUNT || element.Stream >= layout.StreamCount )
+        {
+            ELOG( "Error : Invalid Vertex Element. index = %u", i );
+            elementDesc.clear();
+            return false;
+        }
+
+        if ( slots[element.Stream] == U32_MAX )
+        { continue; }
+
+        D3D12_INPUT_ELEMENT_DESC inputElementDesc;
+        inputElementDesc.SemanticName           = kSemanticNames[element.Attribute];
+        inputElementDesc.SemanticIndex          = 0;
+        inputElementDesc.Format                 = static_cast<DXGI_FORMAT>( element.Format );
+        inputElementDesc.InputSlot              = slots[element.Stream];
+        inputElementDesc.AlignedByteOffset      = element.Offset;
+        inputElementDesc.InputSlotClass         = D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA;
+        inputElementDesc.InstanceDataStepRate   = 0;
+
+        elementDesc.push_back( inputElementDesc );
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      パスに対応する頂点バッファビューを取得します.
+//-------------------------------------------------------------------------------------------------
+u32 GetVertexBufferViews
+(
+    const ResVertexLayout&      layout,
+    VERTEX_PASS                 pass,
+    D3D12_GPU_VIRTUAL_ADDRESS   address,
+    D3D12_VERTEX_BUFFER_VIEW*   pViews
+)
+{
+    if ( pViews == nullptr )
+    { return 0; }
+
+    u32 streams[VERTEX_ATTRIBUTE_COUNT];
+    auto count = GetVertexStreams( layout, pass, streams );
+
+    for( u32 i=0; i<count; ++i )
+    {
+        const auto& stream = layout.Streams[streams[i]];
+        pViews[i].BufferLocation = address + stream.Offset;
+        pViews[i].SizeInBytes    = stream.Size;
+        pViews[i].StrideInBytes  = stream.Stride;
+    }
+
+    return count;
+}
+
+} // namespace asdx
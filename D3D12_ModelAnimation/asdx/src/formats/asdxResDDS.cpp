@@ -8,9 +8,10 @@
 // Includes
 //-------------------------------------------------------------------------------------------------
 #include <new>
-#include <cstdio>
+#include <cstring>
 #include <asdxMath.h>
 #include <asdxLogger.h>
+#include <asdxFile.h>
 #include "asdxResDDS.h"
 
 
@@ -54,7 +55,7 @@ static constexpr u32 DDSCAPS2_CUBEMAP_POSITIVE_Y   = 0x00001000;   // CubeMap Y+
 static constexpr u32 DDSCAPS2_CUBEMAP_NEGATIVE_Y   = 0x00002000;   // CubeMap Y-
 static constexpr u32 DDSCAPS2_CUBEMAP_POSITIVE_Z   = 0x00004000;   // CubeMap Z+
 static constexpr u32 DDSCAPS2_CUBEMAP_NEGATIVE_Z   = 0x00008000;   // CubeMap Z-
-static constexpr u32 DDSCAPS2_VOLUME               = 0x00400000;   // VolumeTextureの場合.
+static constexpr u32 DDSCAPS2_VOLUME               = 0x00200000;   // VolumeTextureの場合.
 
 // dwFourCC Value
 static constexpr u32 FOURCC_DXT1           = '1TXD';           // DXT1
@@ -85,6 +86,9 @@ static constexpr u32 FOURCC_Q8W8V8U8       = 0x0000003f;
 
 static constexpr u32 DDS_RESOURCE_MISC_TEXTRECUBE = 0x4L;
 
+static constexpr u32 DDS_MAX_SURFACE_COUNT  = 2048;     // D3D12_REQ_TEXTURE2D_ARRAY_AXIS_DIMENSION.
+static constexpr u32 DDS_PITCH_ALIGNMENT    = 256;      // D3D12_TEXTURE_DATA_PITCH_ALIGNMENT.
+
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 // DDS_RESOURCE_DIMENSION
@@ -322,17 +326,18 @@ u32 GetBitPerPixel( const u32 format )
 //-------------------------------------------------------------------------------------------------
 void GetSurfaceInfo
 (
-    const s32 width,
-    const s32 height,
+    const u32 width,
+    const u32 height,
     const u32 format,
-    u32* pNumBytes, 
-    u32* pRowBytes,
-    u32* pNumRows 
+    u64* pNumBytes,
+    u64* pRowBytes,
+    u64* pNumRows
 )
 {
-    auto numBytes = 0;
-    auto rowBytes = 0;
-    auto numRows  = 0;
+    // 不正なヘッダでも桁あふれしないように64bitで計算する.
+    u64 numBytes = 0;
+    u64 rowBytes = 0;
+    u64 numRows  = 0;
 
     auto bc     = false;
     auto packed = false;
@@ -374,13 +379,13 @@ void GetSurfaceInfo
 
     if ( bc )
     {
-        u32 numBlockWide = 0;
+        u64 numBlockWide = 0;
         if ( width > 0 )
-        { numBlockWide = asdx::Max<u32>( 1, (width + 3) / 4 ); }
+        { numBlockWide = asdx::Max<u64>( 1, ( u64( width ) + 3 ) / 4 ); }
 
-        u32 numBlockHeigh = 0;
+        u64 numBlockHeigh = 0;
         if ( height > 0 )
-        { numBlockHeigh = asdx::Max<u32>( 1, (height + 3) / 4 ); }
+        { numBlockHeigh = asdx::Max<u64>( 1, ( u64( height ) + 3 ) / 4 ); }
 
         rowBytes = numBlockWide * bpe;
         numRows  = numBlockHeigh;
@@ -388,14 +393,14 @@ void GetSurfaceInfo
     }
     else if ( packed )
     {
-        rowBytes = (( width + 1 ) >> 1 ) * bpe;
+        rowBytes = (( u64( width ) + 1 ) >> 1 ) * bpe;
         numRows  = height;
         numBytes = rowBytes * numRows;
     }
     else
     {
         auto bpp = GetBitPerPixel( format );
-        rowBytes = ( width * bpp + 7 ) / 8;
+        rowBytes = ( u64( width ) * bpp + 7 ) / 8;
         numRows  = height;
         numBytes = rowBytes * numRows;
     }
@@ -410,54 +415,102 @@ void GetSurfaceInfo
     { (*pNumBytes) = numBytes; }
 }
 
+//-------------------------------------------------------------------------------------------------
+//      ブロックサイズを取得します.
+//-------------------------------------------------------------------------------------------------
+void GetBlockSize( const u32 format, u32* pBlockWidth, u32* pBlockHeight )
+{
+    switch( format )
+    {
+    case DDS_FORMAT_BC1_UNORM:
+    case DDS_FORMAT_BC2_UNORM:
+    case DDS_FORMAT_BC3_UNORM:
+    case DDS_FORMAT_BC4_UNORM:
+    case DDS_FORMAT_BC4_SNORM:
+    case DDS_FORMAT_BC5_UNORM:
+    case DDS_FORMAT_BC5_SNORM:
+    case DDS_FORMAT_BC6H_UF16:
+    case DDS_FORMAT_BC6H_SF16:
+    case DDS_FORMAT_BC7_UNORM:
+        {
+            (*pBlockWidth)  = 4;
+            (*pBlockHeight) = 4;
+        }
+        break;
 
-} // namespace /* anonymous */
+    case DDS_FORMAT_R8G8_B8G8_UNORM:
+    case DDS_FORMAT_G8R8_G8B8_UNORM:
+    case DDS_FORMAT_YUY2:
+        {
+            (*pBlockWidth)  = 2;
+            (*pBlockHeight) = 1;
+        }
+        break;
 
-namespace asdx {
+    default:
+        {
+            (*pBlockWidth)  = 1;
+            (*pBlockHeight) = 1;
+        }
+        break;
+    }
+}
 
 //-------------------------------------------------------------------------------------------------
-//      DDSからリソーステクスチャを読込します.
+//      アライメントに切り上げます.
 //-------------------------------------------------------------------------------------------------
-bool LoadResTextureFromDDS( const char16* filename, ResTexture* pResult )
+template<typename T>
+inline T AlignUp( T value, T alignment )
+{ return ( value + alignment - 1 ) / alignment * alignment; }
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// DDS_INFO structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct DDS_INFO
 {
-    if ( filename == nullptr )
-    {
-        ELOG( "Error : Invalid Argument." );
-        return false;
-    }
+    u32     Width;          //!< 横幅です.
+    u32     Height;         //!< 縦幅です.
+    u32     Depth;          //!< 奥行きです.
+    u32     MipMapCount;    //!< ミップレベル数です.
+    u32     SurfaceCount;   //!< 配列要素数です.
+    u32     Format;         //!< フォーマットです.
+    u32     Option;         //!< オプションです.
+    size_t  DataOffset;     //!< ファイル先頭からピクセルデータまでのオフセットです.
+};
 
-    FILE* pFile;
-    auto err = _wfopen_s( &pFile, filename, L"rb" );
-    if ( err != 0 )
+//-------------------------------------------------------------------------------------------------
+//      DDSヘッダを解析します.
+//-------------------------------------------------------------------------------------------------
+bool ParseHeader( const u8* pBuffer, size_t size, DDS_INFO* pInfo )
+{
+    size_t offset = 4 + sizeof(DDS_SURFACE_DESC);
+    if ( size < offset )
     {
-        ELOG( "Error : File Open Failed. filename = %s", filename );
+        ELOG( "Error : Invalid File." );
         return false;
     }
 
-    char sig[4];
-    fread( sig, sizeof(char), 4, pFile );
-
-    if ( (sig[0] != 'D')
-      || (sig[1] != 'D')
-      || (sig[2] != 'S')
-      || (sig[3] != ' '))
+    if ( (pBuffer[0] != 'D')
+      || (pBuffer[1] != 'D')
+      || (pBuffer[2] != 'S')
+      || (pBuffer[3] != ' '))
     {
         ELOG( "Error : Invalid File." );
-        fclose( pFile );
         return false;
     }
 
-    auto width        = 0;
-    auto height       = 0;
-    auto depth        = 0;
-    auto mipMapCount  = 1;
-    auto surfaceCount = 1;
+    u32  width        = 0;
+    u32  height       = 0;
+    u32  depth        = 0;
+    u32  mipMapCount  = 1;
+    u32  surfaceCount = 1;
     auto isCubeMap    = false;
     auto isVolume     = false;
     auto format       = (u32)DDS_FORMAT_UNKNOWN;
 
     DDS_SURFACE_DESC desc;
-    fread( &desc, sizeof(desc), 1, pFile );
+    memcpy( &desc, pBuffer + 4, sizeof(desc) );
 
     if ( desc.Flags & DDSD_HEIGHT )
     { height = desc.Height; }
@@ -482,7 +535,6 @@ bool LoadResTextureFromDDS( const char16* filename, ResTexture* pResult )
             if ( desc.Caps2 & DDSCAPS2_CUBEMAP_POSITIVE_X ) { surfaceCount++; }
             if ( desc.Caps2 & DDSCAPS2_CUBEMAP_POSITIVE_Y ) { surfaceCount++; }
             if ( desc.Caps2 & DDSCAPS2_CUBEMAP_POSITIVE_Z ) { surfaceCount++; }
-            assert( surfaceCount == 6 );
 
             if ( surfaceCount == 6 )
             { isCubeMap = true; }
@@ -532,11 +584,18 @@ bool LoadResTextureFromDDS( const char16* filename, ResTexture* pResult )
 
             case FOURCC_DX10:
                 {
+                    if ( size < offset + sizeof(DDS_DXT10_HEADER) )
+                    {
+                        ELOG( "Error : Invalid File." );
+                        return false;
+                    }
+
                     DDS_DXT10_HEADER ext;
-                    fread( &ext, sizeof(ext), 1, pFile );
+                    memcpy( &ext, pBuffer + offset, sizeof(ext) );
+                    offset += sizeof(ext);
 
                     format = ext.DXGIFormat;
-                    surfaceCount = ext.ArraySize;
+                    surfaceCount = asdx::Max<u32>( ext.ArraySize, 1 );
 
                     switch( ext.ResourceDimension )
                     {
@@ -545,7 +604,6 @@ bool LoadResTextureFromDDS( const char16* filename, ResTexture* pResult )
                             if ( height != 1 )
                             {
                                 ELOG( "Error : Texture1D Height is must be 1." );
-                                fclose( pFile );
                                 return false;
                             }
                         }
@@ -554,7 +612,10 @@ bool LoadResTextureFromDDS( const char16* filename, ResTexture* pResult )
                     case DDS_RESOURCE_DIMENSION_TEXTURE2D:
                         {
                             if ( ext.MiscFlag & DDS_RESOURCE_MISC_TEXTRECUBE )
-                            { surfaceCount = ext.ArraySize * 6; }
+                            {
+                                surfaceCount *= 6;
+                                isCubeMap     = true;
+                            }
                         }
                         break;
 
@@ -563,14 +624,12 @@ bool LoadResTextureFromDDS( const char16* filename, ResTexture* pResult )
                             if ( !isVolume )
                             {
                                 ELOG( "Error : Invalid Texture3D. Volume Flag is none." );
-                                fclose( pFile );
                                 return false;
                             }
 
                             if ( surfaceCount > 1 )
                             {
                                 ELOG( "Error : Texture3D is not support array." );
-                                fclose( pFile );
                                 return false;
                             }
                         }
@@ -700,79 +759,104 @@ bool LoadResTextureFromDDS( const char16* filename, ResTexture* pResult )
         }
     }
 
-    if ( format == DDS_FORMAT_UNKNOWN )
+    if ( format == DDS_FORMAT_UNKNOWN || GetBitPerPixel( format ) == 0 )
     {
         ELOG( "Error : Unsupported Format." );
         return false;
     }
 
-    auto cur = ftell( pFile );
-    fseek( pFile, 0, SEEK_END );
-    auto end = ftell( pFile );
-    fseek( pFile, cur, SEEK_SET );
-    auto pixelSize = end - cur;
-
-    auto pPixels = new (std::nothrow) u8 [ pixelSize ];
-    assert( pPixels != nullptr );
-    if ( pPixels == nullptr )
+    if ( width == 0 || height == 0 )
     {
-        ELOG( "Error : Out of Memory." );
-        fclose( pFile );
+        ELOG( "Error : Invalid Size. width = %u, height = %u", width, height );
         return false;
     }
 
-    fread( pPixels, sizeof(u8), pixelSize, pFile );
-    fclose( pFile );
-
-    auto pSurfaces = new (std::nothrow) Surface[ mipMapCount * surfaceCount ];
-    assert( pSurfaces != nullptr );
-    if ( pSurfaces == nullptr )
+    if ( surfaceCount > DDS_MAX_SURFACE_COUNT )
     {
-        ELOG( "Error : Out of Memory." );
-        SafeDeleteArray( pPixels );
+        ELOG( "Error : Too Many Surfaces. count = %u", surfaceCount );
         return false;
     }
 
-    u32 w = width;
-    u32 h = height;
-    u32 d = depth;
-    u32 offset = 0;
+    // ミップマップ数は最大サイズから作れる段数に制限する.
+    {
+        auto size   = asdx::Max<u32>( asdx::Max<u32>( width, height ), ( isVolume ) ? depth : 1 );
+        u32  levels = 1;
+        while( size > 1 )
+        {
+            size >>= 1;
+            levels++;
+        }
+
+        mipMapCount = asdx::Clamp<u32>( mipMapCount, 1, levels );
+    }
 
-    for( auto j=0; j<surfaceCount; ++j )
+    // サーフェイスのサイズは32bitで表せる範囲に制限する.
     {
-        for( auto i=0; i<mipMapCount; ++i )
+        u64 numBytes = 0;
+        u64 rowBytes = 0;
+        GetSurfaceInfo( width, height, format, &numBytes, &rowBytes, nullptr );
+
+        if ( numBytes > U32_MAX || AlignUp<u64>( rowBytes, DDS_PITCH_ALIGNMENT ) > U32_MAX )
         {
-            auto idx = ( mipMapCount * j ) + i;
-            u32 rowBytes = 0;
-            u32 numRows  = 0;
-            u32 numBytes = 0;
+            ELOG( "Error : Too Large Surface. width = %u, height = %u", width, height );
+            return false;
+        }
+    }
 
-            GetSurfaceInfo( w, h, format, &numBytes, &rowBytes, &numRows );
+    u32 option = ( isCubeMap ) ? asdx::RESTEXTURE_OPTION_CUBEMAP : asdx::RESTEXTURE_OPTION_NONE;
+    if ( isVolume )
+    { option |= asdx::RESTEXTURE_OPTION_VOLUME; }
 
-            pSurfaces[ idx ].Width      = w;
-            pSurfaces[ idx ].Height     = h;
-            pSurfaces[ idx ].RowPitch   = rowBytes;
-            pSurfaces[ idx ].SlicePitch = numBytes;
-            pSurfaces[ idx ].pPixels    = new (std::nothrow) u8 [ numBytes ];
-            assert( pSurfaces[ idx ].pPixels != nullptr );
+    (*pInfo).Width          = width;
+    (*pInfo).Height         = height;
+    (*pInfo).Depth          = depth;
+    (*pInfo).MipMapCount    = mipMapCount;
+    (*pInfo).SurfaceCount   = surfaceCount;
+    (*pInfo).Format         = format;
+    (*pInfo).Option         = option;
+    (*pInfo).DataOffset     = offset;
 
-            if ( pSurfaces[ idx ].pPixels == nullptr )
-            {
-                ELOG( "Error : Out of Memory." );
-                for( auto k=0; k<idx; ++k )
-                { SafeDelete( pSurfaces[k].pPixels ); }
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ピクセルデータを指すサーフェイスを設定します.
+//-------------------------------------------------------------------------------------------------
+bool SetupSurfaces( const u8* pData, size_t size, const DDS_INFO& info, asdx::Surface* pSurfaces )
+{
+    size_t offset = 0;
+
+    for( u32 j=0; j<info.SurfaceCount; ++j )
+    {
+        u32 w = info.Width;
+        u32 h = info.Height;
+        u32 d = info.Depth;
+
+        for( u32 i=0; i<info.MipMapCount; ++i )
+        {
+            auto idx = ( info.MipMapCount * j ) + i;
+            u64 rowBytes = 0;
+            u64 numBytes = 0;
 
-                SafeDeleteArray( pPixels );
-                SafeDeleteArray( pSurfaces );
+            // ParseHeader() で先頭ミップが32bitに収まることを確認済み.
+            GetSurfaceInfo( w, h, info.Format, &numBytes, &rowBytes, nullptr );
+
+            // ボリュームテクスチャはスライスが連続して格納されている.
+            auto sliceCount = ( info.Option & asdx::RESTEXTURE_OPTION_VOLUME ) ? asdx::Max<u32>( d, 1 ) : 1;
+            auto sliceSize  = numBytes * sliceCount;
+            if ( size - offset < sliceSize )
+            {
+                ELOG( "Error : Pixel Data is too short." );
                 return false;
             }
 
-            memcpy( pSurfaces[ idx ].pPixels, pPixels + offset, numBytes );
+            pSurfaces[ idx ].Width      = w;
+            pSurfaces[ idx ].Height     = h;
+            pSurfaces[ idx ].RowPitch   = u32( rowBytes );
+            pSurfaces[ idx ].SlicePitch = u32( numBytes );
+            pSurfaces[ idx ].pPixels    = const_cast<u8*>( pData + offset );
 
-            if ( depth != 0 )
-            { offset += numBytes * d; }
-            else
-            { offset += numBytes; }
+            offset += sliceSize;
 
             w = w >> 1;
             h = h >> 1;
@@ -784,22 +868,190 @@ bool LoadResTextureFromDDS( const char16* filename, ResTexture* pResult )
         }
     }
 
-    SafeDeleteArray( pPixels );
+    return true;
+}
 
-    u32 option = ( isCubeMap ) ? RESTEXTURE_OPTION_CUBEMAP : RESTEXTURE_OPTION_NONE;
-    if ( isVolume )
-    { option |= RESTEXTURE_OPTION_VOLUME; }
-
-    (*pResult).Width         = width;
-    (*pResult).Height        = height;
-    (*pResult).Depth         = depth;
-    (*pResult).Format        = format;
-    (*pResult).SurfaceCount  = surfaceCount;
-    (*pResult).MipMapCount   = mipMapCount;
-    (*pResult).Option        = option;
+//-------------------------------------------------------------------------------------------------
+//      ステージングバッファ上の配置を設定します.
+//
+//      ID3D12Device::GetCopyableFootprints() と同じ規則で配置します.
+//      行ピッチは D3D12_TEXTURE_DATA_PITCH_ALIGNMENT(256byte),
+//      サブリソースの先頭は D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT(512byte) に揃えます.
+//-------------------------------------------------------------------------------------------------
+u64 SetupFootprints
+(
+    const DDS_INFO&                 info,
+    const asdx::Surface*            pSurfaces,
+    asdx::ResSubresourceFootprint*  pFootprints
+)
+{
+    static constexpr u64 PLACEMENT_ALIGNMENT = 512;
+
+    u32 blockWidth  = 1;
+    u32 blockHeight = 1;
+    GetBlockSize( info.Format, &blockWidth, &blockHeight );
+
+    u64 offset = 0;
+    u64 total  = 0;
+
+    for( u32 j=0; j<info.SurfaceCount; ++j )
+    {
+        for( u32 i=0; i<info.MipMapCount; ++i )
+        {
+            auto  idx       = ( info.MipMapCount * j ) + i;
+            auto& surface   = pSurfaces  [ idx ];
+            auto& footprint = pFootprints[ idx ];
+
+            u64 rowBytes = 0;
+            u64 numRows  = 0;
+            GetSurfaceInfo( surface.Width, surface.Height, info.Format, nullptr, &rowBytes, &numRows );
+
+            auto depth = ( info.Option & asdx::RESTEXTURE_OPTION_VOLUME ) ? asdx::Max<u32>( info.Depth >> i, 1 ) : 1;
+
+            footprint.Offset   = AlignUp( offset, PLACEMENT_ALIGNMENT );
+            footprint.Width    = AlignUp( surface.Width,  blockWidth  );
+            footprint.Height   = AlignUp( surface.Height, blockHeight );
+            footprint.Depth    = depth;
+            footprint.RowPitch = u32( AlignUp<u64>( rowBytes, DDS_PITCH_ALIGNMENT ) );
+            footprint.RowCount = u32( numRows );
+            footprint.RowSize  = u32( rowBytes );
+
+            // 最後の行はパディングを含めない.
+            auto rows = numRows * depth;
+            total  = footprint.Offset + footprint.RowPitch * ( rows - 1 ) + rowBytes;
+            offset = footprint.Offset + footprint.RowPitch * rows;
+        }
+    }
+
+    return total;
+}
+
+} // namespace /* anonymous */
+
+namespace asdx {
+
+//-------------------------------------------------------------------------------------------------
+//      DDSからリソーステクスチャを読込します.
+//-------------------------------------------------------------------------------------------------
+bool LoadResTextureFromDDS( const char16* filename, ResTexture* pResult )
+{
+    if ( filename == nullptr || pResult == nullptr )
+    {
+        ELOG( "Error : Invalid Argument." );
+        return false;
+    }
+
+    // マッピングしたデータからサーフェイスごとにコピー.
+    MappedFile     file;
+    ResTextureView view;
+    if ( !MapResTextureFromDDS( filename, &file, &view ) )
+    { return false; }
+
+    auto count     = u32( view.Surfaces.size() );
+    auto pSurfaces = new (std::nothrow) Surface[ count ];
+    if ( pSurfaces == nullptr )
+    {
+        ELOG( "Error : Out of Memory." );
+        return false;
+    }
+
+    for( u32 i=0; i<count; ++i )
+    {
+        auto& src  = view.Surfaces[i];
+        auto  size = size_t( src.SlicePitch );
+        if ( view.Option & RESTEXTURE_OPTION_VOLUME )
+        { size *= view.Footprints[i].Depth; }
+
+        pSurfaces[i].Width      = src.Width;
+        pSurfaces[i].Height     = src.Height;
+        pSurfaces[i].RowPitch   = src.RowPitch;
+        pSurfaces[i].SlicePitch = src.SlicePitch;
+        pSurfaces[i].pPixels    = new (std::nothrow) u8 [ size ];
+
+        if ( pSurfaces[i].pPixels == nullptr )
+        {
+            ELOG( "Error : Out of Memory." );
+            for( u32 k=0; k<i; ++k )
+            { SafeDeleteArray( pSurfaces[k].pPixels ); }
+
+            SafeDeleteArray( pSurfaces );
+            return false;
+        }
+
+        memcpy( pSurfaces[i].pPixels, src.pPixels, size );
+    }
+
+    (*pResult).Width         = view.Width;
+    (*pResult).Height        = view.Height;
+    (*pResult).Depth         = view.Depth;
+    (*pResult).Format        = view.Format;
+    (*pResult).SurfaceCount  = view.SurfaceCount;
+    (*pResult).MipMapCount   = view.MipMapCount;
+    (*pResult).Option        = view.Option;
     (*pResult).pSurfaces     = pSurfaces;
 
     return true;
 }
 
+//-------------------------------------------------------------------------------------------------
+//      DDSファイルをマッピングします.
+//-------------------------------------------------------------------------------------------------
+bool MapResTextureFromDDS( const char16* filename, MappedFile* pFile, ResTextureView* pResult )
+{
+    if ( filename == nullptr || pFile == nullptr || pResult == nullptr )
+    {
+        ELOG( "Error : Invalid Argument." );
+        return false;
+    }
+
+    if ( !pFile->Open( filename ) )
+    {
+        ELOGW( "Error : File Open Failed. filename = %ls", filename );
+        return false;
+    }
+
+    auto pBuffer = pFile->GetData();
+    auto size    = size_t( pFile->GetSize() );
+
+    DDS_INFO info;
+    if ( !ParseHeader( pBuffer, size, &info ) )
+    {
+        ELOGW( "Error : Invalid File. filename = %ls", filename );
+        pFile->Close();
+        return false;
+    }
+
+    // 各サーフェイスは最低1byteを占めるので, データ量を超える枚数は不正.
+    auto count = u64( info.MipMapCount ) * info.SurfaceCount;
+    if ( count > size - info.DataOffset )
+    {
+        ELOGW( "Error : Invalid File. filename = %ls", filename );
+        pFile->Close();
+        return false;
+    }
+
+    (*pResult).Surfaces  .resize( count );
+    (*pResult).Footprints.resize( count );
+
+    if ( !SetupSurfaces( pBuffer + info.DataOffset, size - info.DataOffset, info, (*pResult).Surfaces.data() ) )
+    {
+        ELOGW( "Error : Invalid File. filename = %ls", filename );
+        (*pResult).Surfaces  .clear();
+        (*pResult).Footprints.clear();
+        pFile->Close();
+        return false;
+    }
+
+    (*pResult).StagingSize   = SetupFootprints( info, (*pResult).Surfaces.data(), (*pResult).Footprints.data() );
+    (*pResult).Width         = info.Width;
+    (*pResult).Height        = info.Height;
+    (*pResult).Depth         = info.Depth;
+    (*pResult).Format        = info.Format;
+    (*pResult).SurfaceCount  = info.SurfaceCount;
+    (*pResult).MipMapCount   = info.MipMapCount;
+    (*pResult).Option        = info.Option;
+
+    return true;
+}
+
 } // namespace asdx
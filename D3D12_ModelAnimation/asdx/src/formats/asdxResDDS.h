@@ -20,7 +20,21 @@ namespace asdx {
 //! @param[out]     pResult     リソーステクスチャの格納先です
 //! @retval true    生成に成功.
 //! @retval false   生成に失敗.
+//! @note       ファイルはメモリにマッピングし, サーフェイスごとにコピーします.
 //-------------------------------------------------------------------------------------------------
 bool LoadResTextureFromDDS( const char16* filename, ResTexture* pResult );
 
+//-------------------------------------------------------------------------------------------------
+//! @brief      DDSファイルをメモリにマッピングし, リソーステクスチャビューを設定します.
+//!
+//! @param[in]      filename    ファイル名です.
+//! @param[out]     pFile       マッピングしたファイルの格納先です.
+//! @param[out]     pResult     リソーステクスチャビューの格納先です.
+//! @retval true    マッピングに成功.
+//! @retval false   マッピングに失敗.
+//! @note       サーフェイスはミップレベル, 配列要素の順(D3D12のサブリソース番号順)に格納します.
+//!             ボリュームテクスチャのサーフェイスは SlicePitch 間隔で奥行き分のスライスを指します.
+//-------------------------------------------------------------------------------------------------
+bool MapResTextureFromDDS( const char16* filename, MappedFile* pFile, ResTextureView* pResult );
+
 } // namespace asdx
@@ -183,7 +183,7 @@ bool LoadResTextureFromHDR( const char16* filename, ResTexture* pResult )
     auto err = _wfopen_s( &pFile, filename, L"rb" );
     if ( err != 0 )
     {
-        ELOG( "Error : File Open Failed. filename = %s", filename );
+        ELOG( "Error : File Open Failed. filename = %ls", filename );
         return false;
     }
 
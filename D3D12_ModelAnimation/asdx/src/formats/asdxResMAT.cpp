@@ -7,7 +7,9 @@
 //-------------------------------------------------------------------------------------------------
 // Includes
 //-------------------------------------------------------------------------------------------------
+#include <cstring>
 #include <asdxLogger.h>
+#include <asdxFile.h>
 #include "asdxResMAT.h"
 
 
@@ -32,7 +34,7 @@ struct MAT_FILE_HEADER
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 struct MAT_FILE_PATH
 {
-    char16  Path[256];      //!< パス名です.
+    u16     Path[256];      //!< パス名です(UTF-16).
 };
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -61,11 +63,10 @@ bool LoadResMaterialFromMAT( const char16* filename, ResMaterial* pResult )
         return false;
     }
 
-    FILE* pFile;
-    auto err = _wfopen_s( &pFile, filename, L"rb" );
-    if ( err != 0 )
+    auto pFile = FileOpen( filename, L"rb" );
+    if ( pFile == nullptr )
     {
-        ELOG( "Error : File Open Failed. filename = %s", filename );
+        ELOG( "Error : File Open Failed. filename = %ls", filename );
         return false;
     }
 
@@ -100,7 +101,7 @@ bool LoadResMaterialFromMAT( const char16* filename, ResMaterial* pResult )
     {
         MAT_FILE_PATH texture;
         fread( &texture, sizeof(texture), 1, pFile );
-        (*pResult).Paths[i] = texture.Path;
+        (*pResult).Paths[i] = FromUtf16( texture.Path, 255 );
     }
 
     for( u32 i=0; i<material.PhongCount; ++i )
@@ -124,9 +125,8 @@ bool SaveResMaterialToMAT( const char16* filename, const ResMaterial* pMaterial
         return false;
     }
 
-    FILE* pFile;
-    auto err = _wfopen_s( &pFile, filename, L"wb" );
-    if ( err != 0 )
+    auto pFile = FileOpen( filename, L"wb" );
+    if ( pFile == nullptr )
     {
         ELOG( "Error : File Open Failed." );
         return false;
@@ -150,7 +150,7 @@ bool SaveResMaterialToMAT( const char16* filename, const ResMaterial* pMaterial
     for( u32 i=0; i<material.PathCount; ++i )
     {
         MAT_FILE_PATH texture = {};
-        wcscpy_s( texture.Path, pMaterial->Paths[i].c_str() );
+        ToUtf16( pMaterial->Paths[i], texture.Path );
         fwrite( &texture, sizeof(texture), 1, pFile );
     }
 
@@ -8,6 +8,8 @@
 // Includes
 //-------------------------------------------------------------------------------------------------
 #include <asdxLogger.h>
+#include <asdxFile.h>
+#include <asdxMisc.h>
 #include "asdxResMSH.h"
 
 
@@ -16,7 +18,29 @@ namespace /* anonymous */ {
 //-------------------------------------------------------------------------------------------------
 // Constant Values.
 //-------------------------------------------------------------------------------------------------
-static constexpr u32 MSH_VERSION = 0x000003;
+static constexpr u32 MSH_VERSION_3          = 0x000003;     // 要素ごとに詰めて格納する旧形式です.
+static constexpr u32 MSH_VERSION            = 0x000004;     // 16バイト境界のセクション形式です.
+static constexpr u32 MSH_SECTION_ALIGNMENT  = 16;
+
+//-------------------------------------------------------------------------------------------------
+//      セクションタグを生成します.
+//-------------------------------------------------------------------------------------------------
+constexpr u32 MakeTag( char a, char b, char c, char d )
+{ return u32(u8(a)) | ( u32(u8(b)) << 8 ) | ( u32(u8(c)) << 16 ) | ( u32(u8(d)) << 24 ); }
+
+static constexpr u32 MSH_TAG_POSITION      = MakeTag( 'P', 'O', 'S', '\0' );
+static constexpr u32 MSH_TAG_NORMAL        = MakeTag( 'N', 'R', 'M', '\0' );
+static constexpr u32 MSH_TAG_TEXCOORD      = MakeTag( 'T', 'E', 'X', '\0' );
+static constexpr u32 MSH_TAG_BONE_INDEX    = MakeTag( 'B', 'I', 'D', 'X' );
+static constexpr u32 MSH_TAG_BONE_WEIGHT   = MakeTag( 'B', 'W', 'G', 'T' );
+static constexpr u32 MSH_TAG_VERTEX_INDEX  = MakeTag( 'I', 'D', 'X', '\0' );
+static constexpr u32 MSH_TAG_SUBSET        = MakeTag( 'S', 'U', 'B', '\0' );
+static constexpr u32 MSH_TAG_BONE          = MakeTag( 'B', 'O', 'N', 'E' );
+static constexpr u32 MSH_TAG_LOD           = MakeTag( 'L', 'O', 'D', '\0' );
+static constexpr u32 MSH_TAG_LOD_INDEX     = MakeTag( 'L', 'I', 'D', 'X' );
+static constexpr u32 MSH_TAG_LOD_SUBSET    = MakeTag( 'L', 'S', 'U', 'B' );
+static constexpr u32 MSH_TAG_VERTEX_LAYOUT = MakeTag( 'V', 'L', 'A', 'Y' );
+static constexpr u32 MSH_TAG_VERTEX_STREAM = MakeTag( 'V', 'S', 'T', 'R' );
 
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -33,7 +57,7 @@ struct MSH_FILE_HEADER
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 struct MSH_BONE
 {
-    char16          Name[32];       //!< ボーン名です.
+    u16             Name[32];       //!< ボーン名です(UTF-16).
     u32             ParentId;       //!< 親ボーンのIDです.
     asdx::Vector3   Position;       //!< ボーンの位置座標です.
 };
@@ -63,95 +87,466 @@ struct MSH_MESH
     u32     BoneCount;          //!< ボーン数です.
 };
 
-} // namespace /* anonymous */
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// MSH_SECTION_TABLE structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct MSH_SECTION_TABLE
+{
+    u32     SectionCount;       //!< セクション数です.
+    u32     Reserved;           //!< 予約領域です.
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// MSH_SECTION structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct MSH_SECTION
+{
+    u32     Tag;                //!< セクションタグです.
+    u32     Stride;             //!< 1要素あたりのバイト数です.
+    u64     Size;               //!< データサイズ(パディングを含まない)です. データは直後の16バイト境界から始まります.
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// MSH_BONE_V4 structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct MSH_BONE_V4
+{
+    u16             Name[32];       //!< ボーン名です(UTF-16).
+    u32             ParentId;       //!< 親ボーンのIDです.
+    u32             Reserved[3];    //!< 予約領域です.
+    asdx::Matrix    BindPose;       //!< バインドポーズ行列です.
+};
 
+static_assert( sizeof(MSH_BONE) == 80, "Invalid Bone Size." );
+static_assert( sizeof(MSH_FILE_HEADER) + sizeof(MSH_SECTION_TABLE) == MSH_SECTION_ALIGNMENT, "Invalid Header Size." );
+static_assert( sizeof(MSH_SECTION) == MSH_SECTION_ALIGNMENT, "Invalid Section Size." );
+static_assert( sizeof(MSH_BONE_V4) % MSH_SECTION_ALIGNMENT == 0, "Invalid Bone Size." );
+static_assert( sizeof(asdx::ResLod) == MSH_SECTION_ALIGNMENT, "Invalid Lod Size." );
+static_assert( sizeof(asdx::ResVertexLayout) % MSH_SECTION_ALIGNMENT == 0, "Invalid Vertex Layout Size." );
 
-namespace asdx {
 
 //-------------------------------------------------------------------------------------------------
-//      MSHファイルから読込を行います.
+//      頂点要素のフォーマットのバイト数を取得します.
 //-------------------------------------------------------------------------------------------------
-bool LoadResMeshFromMSH( const char16* filename, ResMesh* pResult )
+u32 GetVertexFormatSize( u32 format )
 {
-    if ( filename == nullptr || pResult == nullptr )
+    // D3D のヘッダに依存しないよう DXGI_FORMAT の値で判定する.
+    // asdxVertexStream.cpp の SelectFormat() で選択されるものだけを受け付ける.
+    switch( format )
     {
-        ELOG( "Error : Invalid Argument." );
+    case 2:     // DXGI_FORMAT_R32G32B32A32_FLOAT
+    case 3:     // DXGI_FORMAT_R32G32B32A32_UINT
+        return 16;
+
+    case 6:     // DXGI_FORMAT_R32G32B32_FLOAT
+        return 12;
+
+    case 11:    // DXGI_FORMAT_R16G16B16A16_UNORM
+    case 12:    // DXGI_FORMAT_R16G16B16A16_UINT
+    case 16:    // DXGI_FORMAT_R32G32_FLOAT
+        return 8;
+
+    case 28:    // DXGI_FORMAT_R8G8B8A8_UNORM
+    case 30:    // DXGI_FORMAT_R8G8B8A8_UINT
+    case 34:    // DXGI_FORMAT_R16G16_FLOAT
+    case 37:    // DXGI_FORMAT_R16G16_SNORM
+        return 4;
+
+    default:
+        return 0;
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+//      配列を一括で読み込みます.
+//-------------------------------------------------------------------------------------------------
+template<typename T>
+bool ReadArray( FILE* pFile, u32 count, u64& remaining, std::vector<T>& result )
+{
+    // 壊れた要素数で巨大なメモリを確保しないように, 残りのファイルサイズと比較してから確保する.
+    auto size = u64( count ) * sizeof(T);
+    if ( size > remaining )
+    {
+        result.clear();
         return false;
     }
 
-    FILE* pFile;
-    auto err = _wfopen_s( &pFile, filename, L"rb" );
-    if ( err != 0 )
+    result.resize( count );
+    if ( count == 0 )
+    { return true; }
+
+    remaining -= size;
+    return fread( &result[0], sizeof(T), count, pFile ) == count;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      セクションを一括で書き込みます.
+//-------------------------------------------------------------------------------------------------
+template<typename T>
+bool WriteSection( FILE* pFile, u32 tag, const T* pData, size_t count )
+{
+    static const u8 padding[MSH_SECTION_ALIGNMENT] = {};
+
+    MSH_SECTION section;
+    section.Tag    = tag;
+    section.Stride = sizeof(T);
+    section.Size   = static_cast<u64>( sizeof(T) * count );
+
+    if ( fwrite( &section, sizeof(section), 1, pFile ) != 1 )
+    { return false; }
+
+    if ( count > 0 && fwrite( pData, sizeof(T), count, pFile ) != count )
+    { return false; }
+
+    auto pad = static_cast<size_t>( asdx::RoundUp( section.Size, u64(MSH_SECTION_ALIGNMENT) ) - section.Size );
+    return ( pad == 0 ) || ( fwrite( padding, 1, pad, pFile ) == pad );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      セクションをビューに設定します.
+//-------------------------------------------------------------------------------------------------
+template<typename T>
+bool SetSpan( const MSH_SECTION& section, const u8* pData, asdx::ResSpan<T>& result )
+{
+    if ( section.Stride != sizeof(T) || section.Size / sizeof(T) > U32_MAX )
     {
-        ELOG( "Error : File Open Failed. filename = %s", filename );
+        ELOG( "Error : Invalid Section. tag = 0x%08x", section.Tag );
         return false;
     }
 
-    MSH_FILE_HEADER header;
-    fread( &header, sizeof(header), 1, pFile );
+    result.pData = reinterpret_cast<const T*>( pData );
+    result.Count = static_cast<u32>( section.Size / sizeof(T) );
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      頂点ストリームのレイアウトをチェックします.
+//-------------------------------------------------------------------------------------------------
+bool CheckVertexLayout( const asdx::ResMeshView& view )
+{
+    if ( view.VertexLayout.empty() )
+    { return true; }
+
+    const auto& layout = view.VertexLayout[0];
+    if ( view.VertexLayout.Count != 1
+      || layout.StreamCount  > asdx::VERTEX_ATTRIBUTE_COUNT
+      || layout.ElementCount > asdx::VERTEX_ATTRIBUTE_COUNT )
+    {
+        ELOG( "Error : Invalid Vertex Layout." );
+        return false;
+    }
+
+    // ストリームは位置座標と同じ頂点数で構築されている必要がある.
+    if ( layout.StreamCount > 0 && layout.VertexCount != view.Positions.Count )
+    {
+        ELOG( "Error : Vertex Layout Count Mismatch. layout = %u, positions = %u",
+            layout.VertexCount, u32( view.Positions.Count ) );
+        return false;
+    }
+
+    for( u32 i=0; i<layout.StreamCount; ++i )
+    {
+        const auto& stream = layout.Streams[i];
+        if ( u64(stream.Stride) * layout.VertexCount != stream.Size
+          || u64(stream.Offset) + stream.Size > view.VertexStreams.Count )
+        {
+            ELOG( "Error : Invalid Vertex Stream. index = %u", i );
+            return false;
+        }
+    }
+
+    for( u32 i=0; i<layout.ElementCount; ++i )
+    {
+        const auto& element = layout.Elements[i];
+        auto formatSize = GetVertexFormatSize( element.Format );
+
+        if ( element.Attribute >= asdx::VERTEX_ATTRIBUTE_COUNT
+          || element.Stream    >= layout.StreamCount
+          || formatSize == 0
+          || u64(element.Offset) + formatSize > layout.Streams[element.Stream].Stride )
+        {
+            ELOG( "Error : Invalid Vertex Element. index = %u", i );
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      バージョン4形式のデータを解析します.
+//-------------------------------------------------------------------------------------------------
+bool ParseMSH( const u8* pData, u64 size, asdx::ResMeshView* pResult )
+{
+    if ( size < MSH_SECTION_ALIGNMENT )
+    {
+        ELOG( "Error : Invalid File." );
+        return false;
+    }
+
+    auto pTable = reinterpret_cast<const MSH_SECTION_TABLE*>( pData + sizeof(MSH_FILE_HEADER) );
+    u64  offset = MSH_SECTION_ALIGNMENT;
+
+    *pResult = asdx::ResMeshView();
+
+    for( u32 i=0; i<pTable->SectionCount; ++i )
+    {
+        if ( offset + sizeof(MSH_SECTION) > size )
+        {
+            ELOG( "Error : Unexpected End of File." );
+            return false;
+        }
+
+        auto& section = *reinterpret_cast<const MSH_SECTION*>( pData + offset );
+        offset += sizeof(MSH_SECTION);
+
+        if ( section.Stride == 0 || section.Size % section.Stride != 0 || section.Size > size - offset )
+        {
+            ELOG( "Error : Invalid Section. tag = 0x%08x", section.Tag );
+            return false;
+        }
+
+        auto pSection = pData + offset;
+        auto result   = true;
+
+        switch( section.Tag )
+        {
+        case MSH_TAG_POSITION:      { result = SetSpan( section, pSection, pResult->Positions );     } break;
+        case MSH_TAG_NORMAL:        { result = SetSpan( section, pSection, pResult->Normals );       } break;
+        case MSH_TAG_TEXCOORD:      { result = SetSpan( section, pSection, pResult->TexCoords );     } break;
+        case MSH_TAG_BONE_INDEX:    { result = SetSpan( section, pSection, pResult->BoneIndices );   } break;
+        case MSH_TAG_BONE_WEIGHT:   { result = SetSpan( section, pSection, pResult->BoneWeights );   } break;
+        case MSH_TAG_VERTEX_INDEX:  { result = SetSpan( section, pSection, pResult->VertexIndices ); } break;
+        case MSH_TAG_SUBSET:        { result = SetSpan( section, pSection, pResult->Subsets );       } break;
+        case MSH_TAG_LOD:           { result = SetSpan( section, pSection, pResult->Lods );          } break;
+        case MSH_TAG_LOD_INDEX:     { result = SetSpan( section, pSection, pResult->LodIndices );    } break;
+        case MSH_TAG_LOD_SUBSET:    { result = SetSpan( section, pSection, pResult->LodSubsets );    } break;
+        case MSH_TAG_VERTEX_LAYOUT: { result = SetSpan( section, pSection, pResult->VertexLayout );  } break;
+        case MSH_TAG_VERTEX_STREAM: { result = SetSpan( section, pSection, pResult->VertexStreams ); } break;
+
+        case MSH_TAG_BONE:
+            {
+                asdx::ResSpan<MSH_BONE_V4> bones;
+                result = SetSpan( section, pSection, bones );
+                if ( !result )
+                { break; }
+
+                pResult->Bones.resize( bones.Count );
+                for( u32 j=0; j<bones.Count; ++j )
+                {
+                    auto& dst = pResult->Bones[j];
+                    dst.Name        = asdx::FromUtf16( bones[j].Name, 31 );
+                    dst.ParentId    = bones[j].ParentId;
+                    dst.BindPose    = bones[j].BindPose;
+                    dst.InvBindPose = asdx::Matrix::Invert( dst.BindPose );
+                }
+            }
+            break;
+
+        default:
+            // 未知のセクションは読み飛ばす.
+            break;
+        }
+
+        if ( !result )
+        { return false; }
+
+        offset += asdx::RoundUp( section.Size, u64(MSH_SECTION_ALIGNMENT) );
+    }
 
+    return CheckVertexLayout( *pResult );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ファイルヘッダをチェックします.
+//-------------------------------------------------------------------------------------------------
+bool CheckHeader( const MSH_FILE_HEADER& header )
+{
     if ( header.Magic[0] != 'M' ||
          header.Magic[1] != 'S' ||
          header.Magic[2] != 'H' ||
          header.Magic[3] != '\0' )
     {
         ELOG( "Error : Invalid File." );
-        fclose( pFile );
         return false;
     }
 
-    if ( header.Version != MSH_VERSION )
+    if ( header.Version != MSH_VERSION && header.Version != MSH_VERSION_3 )
     {
         ELOG( "Error : Invalid File Version." );
-        fclose( pFile );
         return false;
     }
 
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      バージョン3形式のファイルを読み込みます.
+//-------------------------------------------------------------------------------------------------
+bool LoadMSHv3( FILE* pFile, asdx::ResMesh* pResult )
+{
     MSH_MESH mesh;
-    fread( &mesh, sizeof(mesh), 1, pFile );
+    if ( fread( &mesh, sizeof(mesh), 1, pFile ) != 1 )
+    {
+        ELOG( "Error : Unexpected End of File." );
+        return false;
+    }
 
-    (*pResult).Positions    .resize( mesh.PositionCount );
-    (*pResult).Normals      .resize( mesh.NormalCount );
-    (*pResult).TexCoords    .resize( mesh.TexCoordCount );
-    (*pResult).BoneIndices  .resize( mesh.BoneIndexCount );
-    (*pResult).BoneWeights  .resize( mesh.BoneWeightCount );
-    (*pResult).VertexIndices.resize( mesh.VertexIndexCount );
-    (*pResult).Subsets      .resize( mesh.SubsetCount );
-    (*pResult).Bones        .resize( mesh.BoneCount );
+    // 要素数の検証に使う残りのサイズを求める.
+    auto current = ftell( pFile );
+    if ( current < 0 || fseek( pFile, 0, SEEK_END ) != 0 )
+    {
+        ELOG( "Error : File Seek Failed." );
+        return false;
+    }
+    auto end = ftell( pFile );
+    if ( end < current || fseek( pFile, current, SEEK_SET ) != 0 )
+    {
+        ELOG( "Error : File Seek Failed." );
+        return false;
+    }
+    auto remaining = u64( end - current );
+
+    // 旧形式には存在しないデータは前回の読み込み結果を残さない.
+    (*pResult).Lods         .clear();
+    (*pResult).LodIndices   .clear();
+    (*pResult).LodSubsets   .clear();
+    (*pResult).VertexStreams.clear();
+    (*pResult).VertexLayout = asdx::ResVertexLayout();
+
+    std::vector<MSH_BONE> bones;
+
+    auto ret = ReadArray( pFile, mesh.PositionCount,    remaining, (*pResult).Positions )
+            && ReadArray( pFile, mesh.NormalCount,      remaining, (*pResult).Normals )
+            && ReadArray( pFile, mesh.TexCoordCount,    remaining, (*pResult).TexCoords )
+            && ReadArray( pFile, mesh.BoneIndexCount,   remaining, (*pResult).BoneIndices )
+            && ReadArray( pFile, mesh.BoneWeightCount,  remaining, (*pResult).BoneWeights )
+            && ReadArray( pFile, mesh.VertexIndexCount, remaining, (*pResult).VertexIndices )
+            && ReadArray( pFile, mesh.SubsetCount,      remaining, (*pResult).Subsets )
+            && ReadArray( pFile, mesh.BoneCount,        remaining, bones );
+    if ( !ret )
+    {
+        ELOG( "Error : Unexpected End of File." );
+        return false;
+    }
 
-    for( u32 i=0; i<mesh.PositionCount; ++i )
-    { fread( &(*pResult).Positions[i], sizeof(Vector3), 1, pFile ); }
+    (*pResult).Bones.resize( mesh.BoneCount );
+    for( u32 i=0; i<mesh.BoneCount; ++i )
+    {
+        (*pResult).Bones[i].Name        = asdx::FromUtf16( bones[i].Name, 31 );
+        (*pResult).Bones[i].ParentId    = bones[i].ParentId;
+        (*pResult).Bones[i].BindPose    = asdx::Matrix::CreateTranslation( bones[i].Position );
+        (*pResult).Bones[i].InvBindPose = asdx::Matrix::Invert( (*pResult).Bones[i].BindPose );
+    }
 
-    for( u32 i=0; i<mesh.NormalCount; ++i )
-    { fread( &(*pResult).Normals[i], sizeof(Vector3), 1, pFile ); }
+    return true;
+}
 
-    for( u32 i=0; i<mesh.TexCoordCount; ++i )
-    { fread( &(*pResult).TexCoords[i], sizeof(Vector2), 1, pFile ); }
+} // namespace /* anonymous */
 
-    for( u32 i=0; i<mesh.BoneIndexCount; ++i )
-    { fread( &(*pResult).BoneIndices[i], sizeof(uint4), 1, pFile ); }
 
-    for( u32 i=0; i<mesh.BoneWeightCount; ++i )
-    { fread( &(*pResult).BoneWeights[i], sizeof(Vector4), 1, pFile ); }
+namespace asdx {
 
-    for( u32 i=0; i<mesh.VertexIndexCount; ++i )
-    { fread( &(*pResult).VertexIndices[i], sizeof(u32), 1, pFile ); }
+//-------------------------------------------------------------------------------------------------
+//      MSHファイルから読込を行います.
+//-------------------------------------------------------------------------------------------------
+bool LoadResMeshFromMSH( const char16* filename, ResMesh* pResult )
+{
+    if ( filename == nullptr || pResult == nullptr )
+    {
+        ELOG( "Error : Invalid Argument." );
+        return false;
+    }
 
-    for( u32 i=0; i<mesh.SubsetCount; ++i )
-    { fread( &(*pResult).Subsets[i], sizeof(ResSubset), 1, pFile ); }
+    auto pFile = FileOpen( filename, L"rb" );
+    if ( pFile == nullptr )
+    {
+        ELOG( "Error : File Open Failed. filename = %ls", filename );
+        return false;
+    }
 
-    for( u32 i=0; i<mesh.BoneCount; ++i )
+    MSH_FILE_HEADER header;
+    if ( fread( &header, sizeof(header), 1, pFile ) != 1 || !CheckHeader( header ) )
     {
-        MSH_BONE bone;
-        fread( &bone, sizeof(bone), 1, pFile );
+        fclose( pFile );
+        return false;
+    }
 
-        (*pResult).Bones[i].Name        = bone.Name;
-        (*pResult).Bones[i].ParentId    = bone.ParentId;
-        (*pResult).Bones[i].BindPose    = asdx::Matrix::CreateTranslation( bone.Position );
-        (*pResult).Bones[i].InvBindPose = asdx::Matrix::Invert( (*pResult).Bones[i].BindPose );
+    // 旧形式は配列ごとに一括読み込み.
+    if ( header.Version == MSH_VERSION_3 )
+    {
+        auto ret = LoadMSHv3( pFile, pResult );
+        fclose( pFile );
+        return ret;
     }
 
     fclose( pFile );
+
+    // マッピングしたデータから各配列に一括コピー.
+    MappedFile  file;
+    ResMeshView view;
+    if ( !MapResMeshFromMSH( filename, &file, &view ) )
+    { return false; }
+
+    (*pResult).Positions    .assign( view.Positions    .begin(), view.Positions    .end() );
+    (*pResult).Normals      .assign( view.Normals      .begin(), view.Normals      .end() );
+    (*pResult).TexCoords    .assign( view.TexCoords    .begin(), view.TexCoords    .end() );
+    (*pResult).BoneIndices  .assign( view.BoneIndices  .begin(), view.BoneIndices  .end() );
+    (*pResult).BoneWeights  .assign( view.BoneWeights  .begin(), view.BoneWeights  .end() );
+    (*pResult).VertexIndices.assign( view.VertexIndices.begin(), view.VertexIndices.end() );
+    (*pResult).Subsets      .assign( view.Subsets      .begin(), view.Subsets      .end() );
+    (*pResult).Bones        .swap  ( view.Bones );
+    (*pResult).Lods         .assign( view.Lods         .begin(), view.Lods         .end() );
+    (*pResult).LodIndices   .assign( view.LodIndices   .begin(), view.LodIndices   .end() );
+    (*pResult).LodSubsets   .assign( view.LodSubsets   .begin(), view.LodSubsets   .end() );
+    (*pResult).VertexStreams.assign( view.VertexStreams.begin(), view.VertexStreams.end() );
+    (*pResult).VertexLayout = ( view.VertexLayout.empty() ) ? ResVertexLayout() : view.VertexLayout[0];
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      MSHファイルをマッピングします.
+//-------------------------------------------------------------------------------------------------
+bool MapResMeshFromMSH( const char16* filename, MappedFile* pFile, ResMeshView* pResult )
+{
+    if ( filename == nullptr || pFile == nullptr || pResult == nullptr )
+    {
+        ELOG( "Error : Invalid Argument." );
+        return false;
+    }
+
+    if ( !pFile->Open( filename ) )
+    { return false; }
+
+    if ( pFile->GetSize() < sizeof(MSH_FILE_HEADER) )
+    {
+        ELOG( "Error : Invalid File." );
+        pFile->Close();
+        return false;
+    }
+
+    auto& header = *reinterpret_cast<const MSH_FILE_HEADER*>( pFile->GetData() );
+    if ( !CheckHeader( header ) )
+    {
+        pFile->Close();
+        return false;
+    }
+
+    if ( header.Version != MSH_VERSION )
+    {
+        ELOG( "Error : File Version %u is not mappable. Resave as version %u.", header.Version, MSH_VERSION );
+        pFile->Close();
+        return false;
+    }
+
+    if ( !ParseMSH( pFile->GetData(), pFile->GetSize(), pResult ) )
+    {
+        pFile->Close();
+        return false;
+    }
+
     return true;
 }
 
@@ -166,9 +561,32 @@ bool SaveResMeshToMSH( const char16* filename, const ResMesh* pMesh )
         return false;
     }
 
-    FILE* pFile;
-    auto err = _wfopen_s( &pFile, filename, L"wb" );
-    if ( err != 0 )
+    std::vector<MSH_BONE_V4> bones( pMesh->Bones.size() );
+    for( size_t i=0; i<bones.size(); ++i )
+    {
+        const auto& src = pMesh->Bones[i];
+        auto&       dst = bones[i];
+
+        ToUtf16( src.Name, dst.Name );
+        dst.ParentId    = src.ParentId;
+        dst.Reserved[0] = 0;
+        dst.Reserved[1] = 0;
+        dst.Reserved[2] = 0;
+        dst.BindPose    = src.BindPose;
+    }
+
+    // 頂点ストリームが未構築, または構築後に頂点が変更された場合はレイアウトを書き込まない.
+    auto layoutCount = ( pMesh->VertexLayout.StreamCount > 0 ) ? size_t(1) : size_t(0);
+    if ( layoutCount > 0 && pMesh->VertexLayout.VertexCount != pMesh->Positions.size() )
+    {
+        ELOG( "Warning : Vertex Streams are out of date. Call BuildVertexStreams() again." );
+        layoutCount = 0;
+    }
+
+    auto streamSize = ( layoutCount > 0 ) ? pMesh->VertexStreams.size() : size_t(0);
+
+    auto pFile = FileOpen( filename, L"wb" );
+    if ( pFile == nullptr )
     {
         ELOG( "Error : File Open Failed." );
         return false;
@@ -181,53 +599,34 @@ bool SaveResMeshToMSH( const char16* filename, const ResMesh* pMesh )
     header.Magic[3] = '\0';
     header.Version = MSH_VERSION;
 
-    fwrite( &header, sizeof(header), 1, pFile );
-
-    MSH_MESH mesh;
-    mesh.PositionCount    = static_cast<u32>( pMesh->Positions    .size() );
-    mesh.NormalCount      = static_cast<u32>( pMesh->Normals      .size() );
-    mesh.TexCoordCount    = static_cast<u32>( pMesh->TexCoords    .size() );
-    mesh.BoneIndexCount   = static_cast<u32>( pMesh->BoneIndices  .size() );
-    mesh.BoneWeightCount  = static_cast<u32>( pMesh->BoneWeights  .size() );
-    mesh.VertexIndexCount = static_cast<u32>( pMesh->VertexIndices.size() );
-    mesh.SubsetCount      = static_cast<u32>( pMesh->Subsets      .size() );
-    mesh.BoneCount        = static_cast<u32>( pMesh->Bones        .size() );
+    MSH_SECTION_TABLE table;
+    table.SectionCount = 13;
+    table.Reserved     = 0;
+
+    auto ret = fwrite( &header, sizeof(header), 1, pFile ) == 1
+            && fwrite( &table,  sizeof(table),  1, pFile ) == 1
+            && WriteSection( pFile, MSH_TAG_POSITION,     pMesh->Positions    .data(), pMesh->Positions    .size() )
+            && WriteSection( pFile, MSH_TAG_NORMAL,       pMesh->Normals      .data(), pMesh->Normals      .size() )
+            && WriteSection( pFile, MSH_TAG_TEXCOORD,     pMesh->TexCoords    .data(), pMesh->TexCoords    .size() )
+            && WriteSection( pFile, MSH_TAG_BONE_INDEX,   pMesh->BoneIndices  .data(), pMesh->BoneIndices  .size() )
+            && WriteSection( pFile, MSH_TAG_BONE_WEIGHT,  pMesh->BoneWeights  .data(), pMesh->BoneWeights  .size() )
+            && WriteSection( pFile, MSH_TAG_VERTEX_INDEX, pMesh->VertexIndices.data(), pMesh->VertexIndices.size() )
+            && WriteSection( pFile, MSH_TAG_SUBSET,       pMesh->Subsets      .data(), pMesh->Subsets      .size() )
+            && WriteSection( pFile, MSH_TAG_BONE,         bones               .data(), bones               .size() )
+            && WriteSection( pFile, MSH_TAG_LOD,          pMesh->Lods         .data(), pMesh->Lods         .size() )
+            && WriteSection( pFile, MSH_TAG_LOD_INDEX,    pMesh->LodIndices   .data(), pMesh->LodIndices   .size() )
+            && WriteSection( pFile, MSH_TAG_LOD_SUBSET,   pMesh->LodSubsets   .data(), pMesh->LodSubsets   .size() )
+            && WriteSection( pFile, MSH_TAG_VERTEX_LAYOUT, &pMesh->VertexLayout,        layoutCount )
+            && WriteSection( pFile, MSH_TAG_VERTEX_STREAM, pMesh->VertexStreams.data(), streamSize );
 
-    fwrite( &mesh, sizeof(mesh), 1, pFile );
-
-    for( u32 i=0; i<mesh.PositionCount; ++i )
-    { fwrite( &pMesh->Positions[i], sizeof(Vector3), 1, pFile ); }
-
-    for( u32 i=0; i<mesh.NormalCount; ++i )
-    { fwrite( &pMesh->Normals[i], sizeof(Vector3), 1, pFile ); }
-
-    for( u32 i=0; i<mesh.TexCoordCount; ++i )
-    { fwrite( &pMesh->TexCoords[i], sizeof(Vector2), 1, pFile ); }
-
-    for( u32 i=0; i<mesh.BoneIndexCount; ++i )
-    { fwrite( &pMesh->BoneIndices[i], sizeof(uint4), 1, pFile ); }
-
-    for( u32 i=0; i<mesh.BoneWeightCount; ++i )
-    { fwrite( &pMesh->BoneWeights[i], sizeof(Vector4), 1, pFile ); }
-
-    for( u32 i=0; i<mesh.VertexIndexCount; ++i )
-    { fwrite( &pMesh->VertexIndices[i], sizeof(u32), 1, pFile ); }
-
-    for( u32 i=0; i<mesh.SubsetCount; ++i )
-    { fwrite( &pMesh->Subsets[i], sizeof(ResSubset), 1, pFile ); }
+    fclose( pFile );
 
-    for( u32 i=0; i<mesh.BoneCount; ++i )
+    if ( !ret )
     {
-        MSH_BONE bone = {};
-        wcscpy_s( bone.Name, pMesh->Bones[i].Name.c_str());
-        bone.ParentId = pMesh->Bones[i].ParentId;
-        bone.Position.x = -pMesh->Bones[i].InvBindPose._41;
-        bone.Position.y = -pMesh->Bones[i].InvBindPose._42;
-        bone.Position.z = -pMesh->Bones[i].InvBindPose._43;
-        fwrite( &bone, sizeof(bone), 1, pFile );
+        ELOG( "Error : File Write Failed." );
+        return false;
     }
 
-    fclose( pFile );
     return true;
 }
 
@@ -23,6 +23,18 @@ namespace asdx {
 //-------------------------------------------------------------------------------------------------
 bool LoadResMeshFromMSH( const char16* filename, ResMesh* pResult );
 
+//-------------------------------------------------------------------------------------------------
+//! @brief      MSHファイルをメモリにマッピングし, リソースメッシュビューを設定します.
+//!
+//! @param[in]      filename        ファイル名です.
+//! @param[out]     pFile           マッピングしたファイルの格納先です.
+//! @param[out]     pResult         リソースメッシュビューの格納先です.
+//! @retval true    マッピングに成功.
+//! @retval false   マッピングに失敗.
+//! @note       バージョン4以降のファイルのみ対応しています.
+//-------------------------------------------------------------------------------------------------
+bool MapResMeshFromMSH( const char16* filename, MappedFile* pFile, ResMeshView* pResult );
+
 //-------------------------------------------------------------------------------------------------
 //! @brief      リソースメッシュをMSHファイルに保存します.
 //!
@@ -7,7 +7,9 @@
 //-------------------------------------------------------------------------------------------------
 // Includes
 //-------------------------------------------------------------------------------------------------
+#include <cstring>
 #include <asdxLogger.h>
+#include <asdxFile.h>
 #include "asdxResMTN.h"
 
 
@@ -43,7 +45,7 @@ struct MTN_KEYFRAME
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 struct MTN_KEYFRAME_SET
 {
-    char16  BoneName[32];       //!< ボーン番号です.
+    u16     BoneName[32];       //!< ボーン名です(UTF-16).
     u32     KeyFrameCount;      //!< キーフレーム数です.
 };
 
@@ -72,11 +74,10 @@ bool LoadResMotionFromMTN( const char16* filename, ResMotion* pResult )
         return false;
     }
 
-    FILE* pFile;
-    auto err = _wfopen_s( &pFile, filename, L"rb" );
-    if ( err != 0 )
+    auto pFile = FileOpen( filename, L"rb" );
+    if ( pFile == nullptr )
     {
-        ELOG( "Error : File Open Failed. filename = %s", filename );
+        ELOG( "Error : File Open Failed. filename = %ls", filename );
         return false;
     }
 
@@ -111,7 +112,7 @@ bool LoadResMotionFromMTN( const char16* filename, ResMotion* pResult )
         MTN_KEYFRAME_SET keyFrameSet;
         fread( &keyFrameSet, sizeof(keyFrameSet), 1, pFile );
 
-        (*pResult).Bones[i].BoneName = keyFrameSet.BoneName;
+        (*pResult).Bones[i].BoneName = FromUtf16( keyFrameSet.BoneName, 31 );
         (*pResult).Bones[i].KeyFrames.resize( keyFrameSet.KeyFrameCount );
 
         for( u32 j=0; j<keyFrameSet.KeyFrameCount; ++j )
@@ -145,9 +146,8 @@ bool SaveResMotionToMTN( const char16* filename, const ResMotion* pMotion )
         return false;
     }
 
-    FILE* pFile;
-    auto err = _wfopen_s( &pFile, filename, L"wb" );
-    if ( err != 0 )
+    auto pFile = FileOpen( filename, L"wb" );
+    if ( pFile == nullptr )
     {
         ELOG( "Error : File Open Failed." );
         return false;
@@ -171,7 +171,7 @@ bool SaveResMotionToMTN( const char16* filename, const ResMotion* pMotion )
     for( u32 i=0; i<motion.KeyFrameSetCount; ++i )
     {
         MTN_KEYFRAME_SET keyFrameSet;
-        wcscpy_s(keyFrameSet.BoneName, pMotion->Bones[i].BoneName.c_str());
+        ToUtf16( pMotion->Bones[i].BoneName, keyFrameSet.BoneName );
         keyFrameSet.KeyFrameCount = static_cast<u32>( pMotion->Bones[i].KeyFrames.size() );
 
         fwrite( &keyFrameSet, sizeof(keyFrameSet), 1, pFile );
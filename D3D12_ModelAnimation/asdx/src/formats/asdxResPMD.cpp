@@ -0,0 +1,526 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxResPMD.cpp
+// Desc : Polygon Model Data Format (*.pmd) Loader
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <cstring>
+#include <asdxLogger.h>
+#include <asdxFile.h>
+#include "asdxResPMD.h"
+
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <iconv.h>
+#endif
+
+
+namespace /* anonymous */ {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// PMD_HEADER strcture
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma pack( push, 1 )
+struct PMD_HEADER
+{
+    u8      Magic[3];           //!< ファイルマジック "Pmd"
+    f32     Version;            //!< ファイルバージョン.
+    char8   ModelName[20];      //!< モデル名.
+    char8   Comment[256];       //!< コメント.
+};
+#pragma pack( pop )
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// PMD_VERTEX structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma pack( push, 1 )
+struct PMD_VERTEX
+{
+    asdx::Vector3   Position;       //!< 位置座標.
+    asdx::Vector3   Normal;         //!< 法線ベクトル.
+    asdx::Vector2   TexCoord;       //!< テクスチャ座標.
+    u16             BoneIndex[2];   //!< ボーン番号.
+    u8              BoneWeight;     //!< ボーン0へ与える影響度 min: 0, max : 100.
+    u8              EdgeFlag;       //!< エッジフラグ.
+};
+#pragma pack( pop )
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// PMD_MATERIAL structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma pack( push, 1 )
+struct PMD_MATERIAL
+{
+    asdx::Vector3   Diffuse;            //!< 拡散反射
+    f32             Alpha;              //!< 透過度.
+    f32             Power;              //!< 鏡面反射強度.
+    asdx::Vector3   Specular;           //!< 鏡面反射.
+    asdx::Vector3   Emissive;           //!< 自己照明.
+    u8              ToonIndex;          //!< トゥーンテクスチャ番号.
+    u8              VisualFlag;         //!< 輪郭. 影
+    u32             VertexCount;        //!< 頂点数.
+    char8           TextureName[20];    //!< テクスチャファイル名(非NULL終端であることに注意).
+};
+#pragma pack( pop )
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// PMD_BONE structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma pack( push, 1 )
+struct PMD_BONE
+{
+    char8           Name[20];           //!< ボーン名.
+    u16             ParentIndex;        //!< 親ボーンの番号(親がいない場合は 0xFFFF).
+    u16             TailIndex;          //!< 末尾のボーン番号
+    u8              BoneType;           //!< ボーンの種類.
+    u16             IKBoneIndex;        //!< IKボーン番号.
+    asdx::Vector3   Position;           //!< ボーンのヘッド位置.
+};
+#pragma pack( pop )
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// PmdReader class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class PmdReader
+{
+public:
+    //---------------------------------------------------------------------------------------------
+    //      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    PmdReader( const u8* pBuffer, size_t size )
+    : m_pBuffer ( pBuffer )
+    , m_Size    ( size )
+    , m_Offset  ( 0 )
+    { /* DO_NOTHING */ }
+
+    //---------------------------------------------------------------------------------------------
+    //      値を読み込みます.
+    //---------------------------------------------------------------------------------------------
+    template<typename T>
+    bool Read( T& value )
+    {
+        if ( GetRemain() < sizeof(T) )
+        { return false; }
+
+        memcpy( &value, m_pBuffer + m_Offset, sizeof(T) );
+        m_Offset += sizeof(T);
+        return true;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //      要素数を残りサイズでチェックしてから配列を一括で読み込みます.
+    //---------------------------------------------------------------------------------------------
+    template<typename T>
+    bool ReadArray( size_t count, std::vector<T>& result )
+    {
+        if ( count > GetRemain() / sizeof(T) )
+        { return false; }
+
+        result.resize( count );
+        if ( count > 0 )
+        { memcpy( static_cast<void*>( &result[0] ), m_pBuffer + m_Offset, sizeof(T) * count ); }
+
+        m_Offset += sizeof(T) * count;
+        return true;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //      残りサイズを取得します.
+    //---------------------------------------------------------------------------------------------
+    size_t GetRemain() const
+    { return m_Size - m_Offset; }
+
+private:
+    const u8*   m_pBuffer;
+    size_t      m_Size;
+    size_t      m_Offset;
+};
+
+//-------------------------------------------------------------------------------------------------
+//      テクスチャ名を取得します.
+//-------------------------------------------------------------------------------------------------
+std::wstring GetTextureName( const PMD_MATERIAL& material )
+{
+    // "diffuse.bmp*sphere.sph" の形式があるので, スフィアマップを取り除く.
+    size_t length = 0;
+    while( length < sizeof(material.TextureName) && material.TextureName[length] != '\0' )
+    { length++; }
+
+    std::string name( material.TextureName, length );
+
+    auto pos = name.find( '*' );
+    if ( pos != std::string::npos )
+    { name = name.substr( 0, pos ); }
+
+    if ( name.size() >= 4 )
+    {
+        auto ext = name.substr( name.size() - 4 );
+        if ( ext == ".sph" || ext == ".spa" )
+        { name.clear(); }
+    }
+
+    return asdx::ToWideFromSJIS( name.c_str(), name.size() );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      親ボーンが子ボーンより前に来るように並べ替えます.
+//
+//      PMD はボーンの並び順を保証しないため, 元の順序をできるだけ保ったまま
+//      未配置の祖先を先に配置します. 循環参照がある場合は false を返します.
+//-------------------------------------------------------------------------------------------------
+bool SortBones( const std::vector<PMD_BONE>& bones, std::vector<u32>& order, std::vector<u32>& remap )
+{
+    auto count = bones.size();
+
+    order.clear();
+    order.reserve( count );
+    remap.assign( count, U32_MAX );
+
+    std::vector<u32> chain;
+    chain.reserve( count );
+
+    for( size_t i=0; i<count; ++i )
+    {
+        // 未配置の祖先をたどる. ボーン数を超えたら循環している.
+        chain.clear();
+        auto index = u32( i );
+        while( index != 0xFFFF && remap[index] == U32_MAX )
+        {
+            if ( chain.size() >= count )
+            {
+                ELOG( "Error : Bone Hierarchy Has Cycle. bone = %u", u32(i) );
+                return false;
+            }
+
+            chain.push_back( index );
+            index = bones[index].ParentIndex;
+        }
+
+        // 根元側から配置.
+        for( auto itr = chain.rbegin(); itr != chain.rend(); ++itr )
+        {
+            remap[*itr] = u32( order.size() );
+            order.push_back( *itr );
+        }
+    }
+
+    return true;
+}
+
+} // namespace /* anonymous */
+
+
+namespace asdx {
+
+//-------------------------------------------------------------------------------------------------
+//      Shift_JIS の固定長文字列をワイド文字列に変換します.
+//-------------------------------------------------------------------------------------------------
+std::wstring ToWideFromSJIS( const char8* pValue, size_t maxLength )
+{
+    if ( pValue == nullptr )
+    { return std::wstring(); }
+
+    size_t length = 0;
+    while( length < maxLength && pValue[length] != '\0' )
+    { length++; }
+
+    if ( length == 0 )
+    { return std::wstring(); }
+
+#if defined(_WIN32)
+    auto count = MultiByteToWideChar( 932, 0, pValue, int(length), nullptr, 0 );
+    if ( count > 0 )
+    {
+        std::wstring result( size_t(count), L'\0' );
+        MultiByteToWideChar( 932, 0, pValue, int(length), &result[0], count );
+        return result;
+    }
+#else
+    auto cd = iconv_open( "WCHAR_T", "CP932" );
+    if ( cd != iconv_t(-1) )
+    {
+        std::wstring result( length, L'\0' );
+
+        auto pSrc      = const_cast<char*>( pValue );
+        auto pDst      = reinterpret_cast<char*>( &result[0] );
+        auto srcRemain = length;
+        auto dstRemain = length * sizeof(wchar_t);
+
+        auto ret = iconv( cd, &pSrc, &srcRemain, &pDst, &dstRemain );
+        iconv_close( cd );
+
+        if ( ret != size_t(-1) )
+        {
+            result.resize( length - dstRemain / sizeof(wchar_t) );
+            return result;
+        }
+    }
+#endif
+
+    // 変換できない場合は ASCII 部分のみ.
+    std::wstring result;
+    for( size_t i=0; i<length && u8(pValue[i]) < 0x80; ++i )
+    { result.push_back( char16( pValue[i] ) ); }
+
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      メモリ上のPMDデータからリソースメッシュとマテリアルを読込します.
+//-------------------------------------------------------------------------------------------------
+bool LoadResMeshFromPMD( const u8* pBuffer, size_t size, ResMesh* pMesh, ResMaterial* pMaterial )
+{
+    if ( pBuffer == nullptr || pMesh == nullptr )
+    {
+        ELOG( "Error : Invalid Argument." );
+        return false;
+    }
+
+    PmdReader reader( pBuffer, size );
+
+    PMD_HEADER header;
+    if ( !reader.Read( header ) )
+    {
+        ELOG( "Error : Unexpected End of File." );
+        return false;
+    }
+
+    if ( header.Magic[0] != 'P' || header.Magic[1] != 'm' || header.Magic[2] != 'd' )
+    {
+        ELOG( "Error : Invalid File Magic." );
+        return false;
+    }
+
+    std::vector<PMD_VERTEX>     vertices;
+    std::vector<u16>            indices;
+    std::vector<PMD_MATERIAL>   materials;
+    std::vector<PMD_BONE>       bones;
+
+    {
+        u32 count = 0;
+        if ( !reader.Read( count ) || !reader.ReadArray( count, vertices ) )
+        {
+            ELOG( "Error : Invalid Vertex Section. count = %u", count );
+            return false;
+        }
+    }
+
+    {
+        u32 count = 0;
+        if ( !reader.Read( count ) || !reader.ReadArray( count, indices ) )
+        {
+            ELOG( "Error : Invalid Index Section. count = %u", count );
+            return false;
+        }
+    }
+
+    {
+        u32 count = 0;
+        if ( !reader.Read( count ) || !reader.ReadArray( count, materials ) )
+        {
+            ELOG( "Error : Invalid Material Section. count = %u", count );
+            return false;
+        }
+    }
+
+    {
+        u16 count = 0;
+        if ( !reader.Read( count ) || !reader.ReadArray( count, bones ) )
+        {
+            ELOG( "Error : Invalid Bone Section. count = %u", count );
+            return false;
+        }
+    }
+
+    // 参照番号をチェック.
+    {
+        auto vertexCount = vertices.size();
+        auto boneCount   = bones.size();
+
+        for( size_t i=0; i<indices.size(); ++i )
+        {
+            if ( indices[i] >= vertexCount )
+            {
+                ELOG( "Error : Vertex Index Out Of Range. index = %u", u32(i) );
+                return false;
+            }
+        }
+
+        for( size_t i=0; i<vertices.size(); ++i )
+        {
+            if ( vertices[i].BoneIndex[0] >= boneCount || vertices[i].BoneIndex[1] >= boneCount )
+            {
+                ELOG( "Error : Vertex Bone Index Out Of Range. vertex = %u", u32(i) );
+                return false;
+            }
+        }
+
+        u64 materialIndexCount = 0;
+        for( size_t i=0; i<materials.size(); ++i )
+        { materialIndexCount += materials[i].VertexCount; }
+
+        if ( materialIndexCount > indices.size() )
+        {
+            ELOG( "Error : Material Vertex Count Out Of Range." );
+            return false;
+        }
+
+        for( size_t i=0; i<bones.size(); ++i )
+        {
+            if ( bones[i].ParentIndex != 0xFFFF && bones[i].ParentIndex >= boneCount )
+            {
+                ELOG( "Error : Parent Bone Index Out Of Range. bone = %u", u32(i) );
+                return false;
+            }
+
+            if ( bones[i].ParentIndex == i )
+            {
+                ELOG( "Error : Bone Is Own Parent. bone = %u", u32(i) );
+                return false;
+            }
+        }
+    }
+
+    // 親子順に並べ替えたボーン番号.
+    std::vector<u32> boneOrder;
+    std::vector<u32> boneRemap;
+    if ( !SortBones( bones, boneOrder, boneRemap ) )
+    { return false; }
+
+    // 頂点データ.
+    {
+        auto count = vertices.size();
+
+        pMesh->Positions  .resize( count );
+        pMesh->Normals    .resize( count );
+        pMesh->TexCoords  .resize( count );
+        pMesh->BoneIndices.resize( count );
+        pMesh->BoneWeights.resize( count );
+
+        for( size_t i=0; i<count; ++i )
+        {
+            const auto& src = vertices[i];
+            auto weight = Clamp( src.BoneWeight / 100.0f, 0.0f, 1.0f );
+
+            pMesh->Positions  [i] = src.Position;
+            pMesh->Normals    [i] = src.Normal;
+            pMesh->TexCoords  [i] = src.TexCoord;
+            pMesh->BoneIndices[i] = uint4( boneRemap[ src.BoneIndex[0] ], boneRemap[ src.BoneIndex[1] ], 0, 0 );
+            pMesh->BoneWeights[i] = Vector4( weight, 1.0f - weight, 0.0f, 0.0f );
+        }
+    }
+
+    // 頂点インデックス.
+    pMesh->VertexIndices.assign( indices.begin(), indices.end() );
+
+    // マテリアルごとのサブセット.
+    {
+        pMesh->Subsets.resize( materials.size() );
+
+        u32 offset = 0;
+        for( size_t i=0; i<materials.size(); ++i )
+        {
+            pMesh->Subsets[i].MaterialId = u32(i);
+            pMesh->Subsets[i].Offset     = offset;
+            pMesh->Subsets[i].Count      = materials[i].VertexCount;
+
+            offset += materials[i].VertexCount;
+        }
+    }
+
+    // ボーン. バインドポーズはヘッド位置への平行移動.
+    {
+        pMesh->Bones.resize( bones.size() );
+
+        for( size_t i=0; i<bones.size(); ++i )
+        {
+            const auto& src = bones[ boneOrder[i] ];
+            auto& dst = pMesh->Bones[i];
+
+            dst.Name        = ToWideFromSJIS( src.Name, sizeof(src.Name) );
+            dst.ParentId    = ( src.ParentIndex == 0xFFFF ) ? U32_MAX : boneRemap[ src.ParentIndex ];
+            dst.BindPose    = Matrix::CreateTranslation( src.Position );
+            dst.InvBindPose = Matrix::CreateTranslation( -src.Position );
+        }
+    }
+
+    pMesh->Lods      .clear();
+    pMesh->LodIndices.clear();
+    pMesh->LodSubsets.clear();
+
+    if ( pMaterial == nullptr )
+    { return true; }
+
+    // マテリアル. 環境色は自己照明として扱う.
+    pMaterial->Paths .clear();
+    pMaterial->Phong .resize( materials.size() );
+    pMaterial->Disney.clear();
+
+    for( size_t i=0; i<materials.size(); ++i )
+    {
+        const auto& src = materials[i];
+        auto& dst = pMaterial->Phong[i];
+
+        dst.Diffuse   = src.Diffuse;
+        dst.Alpha     = src.Alpha;
+        dst.Specular  = src.Specular;
+        dst.Power     = src.Power;
+        dst.Emissive  = src.Emissive;
+        dst.TextureId = U32_MAX;
+
+        auto name = GetTextureName( src );
+        if ( name.empty() )
+        { continue; }
+
+        for( size_t j=0; j<pMaterial->Paths.size(); ++j )
+        {
+            if ( pMaterial->Paths[j] == name )
+            {
+                dst.TextureId = u32(j);
+                break;
+            }
+        }
+
+        if ( dst.TextureId == U32_MAX )
+        {
+            dst.TextureId = u32( pMaterial->Paths.size() );
+            pMaterial->Paths.push_back( name );
+        }
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      PMDファイルからリソースメッシュとマテリアルを読込します.
+//-------------------------------------------------------------------------------------------------
+bool LoadResMeshFromPMD( const char16* filename, ResMesh* pMesh, ResMaterial* pMaterial )
+{
+    if ( filename == nullptr || pMesh == nullptr )
+    {
+        ELOG( "Error : Invalid Argument." );
+        return false;
+    }
+
+    MappedFile file;
+    if ( !file.Open( filename ) )
+    {
+        ELOGW( "Error : File Open Failed. filename = %ls", filename );
+        return false;
+    }
+
+    if ( !LoadResMeshFromPMD( file.GetData(), size_t( file.GetSize() ), pMesh, pMaterial ) )
+    {
+        ELOGW( "Error : Invalid File. filename = %ls", filename );
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace asdx
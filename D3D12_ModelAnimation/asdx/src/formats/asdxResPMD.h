@@ -0,0 +1,52 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxResPMD.h
+// Desc : Polygon Model Data Format (*.pmd) Loader
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+#pragma once
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxResMesh.h>
+#include <asdxResMaterial.h>
+
+
+namespace asdx {
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      Shift_JIS の固定長文字列をワイド文字列に変換します.
+//!
+//! @param[in]      pValue          変換する文字列です(NULL終端されていなくても構いません).
+//! @param[in]      maxLength       最大バイト数です.
+//! @return     変換した文字列を返却します. 変換に失敗した場合は ASCII 部分のみを返却します.
+//-------------------------------------------------------------------------------------------------
+std::wstring ToWideFromSJIS( const char8* pValue, size_t maxLength );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      メモリ上のPMDデータからリソースメッシュとマテリアルを読込します.
+//!
+//! @param[in]      pBuffer         ファイル全体を格納したバッファです.
+//! @param[in]      size            バッファサイズです.
+//! @param[out]     pMesh           リソースメッシュの格納先です.
+//! @param[out]     pMaterial       リソースマテリアルの格納先です(nullptr可).
+//! @retval true    読込に成功.
+//! @retval false   読込に失敗.
+//! @note       要素数は残りサイズで, 参照番号は各要素数でチェックします.
+//!             マテリアルごとにサブセットを1つ生成します.
+//!             表情・IK・剛体などの後続データは変換しないため読み込みません.
+//-------------------------------------------------------------------------------------------------
+bool LoadResMeshFromPMD( const u8* pBuffer, size_t size, ResMesh* pMesh, ResMaterial* pMaterial );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      PMDファイルからリソースメッシュとマテリアルを読込します.
+//!
+//! @param[in]      filename        ファイル名です.
+//! @param[out]     pMesh           リソースメッシュの格納先です.
+//! @param[out]     pMaterial       リソースマテリアルの格納先です(nullptr可).
+//! @retval true    読込に成功.
+//! @retval false   読込に失敗.
+//-------------------------------------------------------------------------------------------------
+bool LoadResMeshFromPMD( const char16* filename, ResMesh* pMesh, ResMaterial* pMaterial );
+
+} // namespace asdx
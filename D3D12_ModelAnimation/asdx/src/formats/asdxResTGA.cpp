@@ -8,13 +8,31 @@
 // Includes
 //-------------------------------------------------------------------------------------------------
 #include <new>
-#include <cassert>
-#include <cstdio>
 #include <cstring>
 #include <dxgiformat.h>
+#include <asdxMath.h>
 #include <asdxLogger.h>
+#include <asdxFile.h>
 #include "asdxResTGA.h"
 
+#if ASDX_IS_SSE2
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#if ASDX_IS_AVX2
+#include <immintrin.h>
+#elif defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif//ASDX_IS_SSE2
+
+#if ASDX_IS_SSE2 && !ASDX_IS_AVX2 && ( defined(__GNUC__) || defined(__clang__) )
+    #define TGA_TARGET_SSSE3    __attribute__((target("ssse3")))
+#else
+    #define TGA_TARGET_SSSE3
+#endif
+
 
 namespace /* anonymous */ {
 
@@ -55,487 +73,566 @@ struct TGA_HEADER
 #pragma pack( pop )
 
 
-////////////////////////////////////////////////////////////////////////////////////////////////////
-// TGA_FOOTER structure
-////////////////////////////////////////////////////////////////////////////////////////////////////
-#pragma pack( push, 1 )
-struct TGA_FOOTER
-{
-    u32  OffsetExt;      // 拡張データへのオフセット(byte数) [オフセットはファイルの先頭から].
-    u32  OffsetDev;      // ディベロッパーエリアへのオフセット(byte数)[オフセットはファイルの先頭から].
-    char Tag[18];        // 'TRUEVISION-XFILE.\0'
-};
-#pragma pack( pop )
+//-------------------------------------------------------------------------------------------------
+//! @brief      ピクセル変換関数です.
+//!
+//! @param[in]      pSrc        変換元のピクセルデータです.
+//! @param[in]      count       変換するピクセル数です.
+//! @param[in]      pPalette    カラーパレットです(インデックスカラー以外では nullptr).
+//! @param[out]     pDst        変換先です.
+//-------------------------------------------------------------------------------------------------
+typedef void (*ConvertFunc)( const u8* pSrc, u32 count, const u32* pPalette, u8* pDst );
 
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
-// TGA_EXTENSION structure
+// PixelDecoder structure
 ///////////////////////////////////////////////////////////////////////////////////////////////////
-#pragma pack( push, 1 )
-struct TGA_EXTENSION
+struct PixelDecoder
 {
-    u16     Size;                       //!< サイズ.
-    char    AuthorName[ 41 ];           //!< 著作者名.
-    char    AuthorComment[ 324 ];       //!< 著作者コメント.
-    u16     StampMonth;                 //!< タイムスタンプ　月(1-12).
-    u16     StampDay;                   //!< タイムスタンプ　日(1-31).
-    u16     StampYear;                  //!< タイムスタンプ　年(4桁, 例1989).
-    u16     StampHour;                  //!< タイムスタンプ　時(0-23).
-    u16     StampMinute;                //!< タイムスタンプ　分(0-59).
-    u16     StampSecond;                //!< タイムスタンプ　秒(0-59).
-    char    JobName[ 41 ];              //!< ジョブ名 (最後のバイトはゼロが必須).
-    u16     JobHour;                    //!< ジョブ時間  時(0-65535)
-    u16     JobMinute;                  //!< ジョブ時間　分(0-59)
-    u16     JobSecond;                  //!< ジョブ時間　秒(0-59)
-    char    SoftwareId[ 41 ];           //!< ソフトウェアID (最後のバイトはゼロが必須).
-    u16     VersionNumber;              //!< ソフトウェアバージョン    VersionNumber * 100になる.
-    u8      VersionLetter;              //!< ソフトウェアバージョン
-    u32     KeyColor;                   //!< キーカラー.
-    u16     PixelNumerator;             //!< ピクセル比分子　ピクセル横幅.
-    u16     PixelDenominator;           //!< ピクセル比分母　ピクセル縦幅.
-    u16     GammaNumerator;             //!< ガンマ値分子.
-    u16     GammaDenominator;           //!< ガンマ値分母
-    u32     ColorCorrectionOffset;      //!< 色補正テーブルへのオフセット.
-    u32     StampOffset;                //!< ポステージスタンプ画像へのオフセット.
-    u32     ScanLineOffset;             //!< スキャンラインオフセット.
-    u8      AttributeType;              //!< アルファチャンネルデータのタイプ
+    ConvertFunc     Convert;        //!< ピクセル変換関数です.
+    u32             SrcBytes;       //!< 変換元の1ピクセル当たりのバイト数です.
+    u32             DstBytes;       //!< 変換先の1ピクセル当たりのバイト数です.
+    const u32*      pPalette;       //!< カラーパレットです.
 };
-#pragma pack( pop )
 
 
+#if ASDX_IS_SSE2 && !ASDX_IS_AVX2
 //-------------------------------------------------------------------------------------------------
-//! @brief      8Bitインデックスカラー形式を解析します.
-//!
-//! @param[in]      pColorMap       カラーマップです.
+//! @brief      SSSE3 命令が使用可能かどうかチェックします.
 //-------------------------------------------------------------------------------------------------
-void Parse8Bits( FILE* pFile, u32 size, u8* pColorMap, u8* pPixels )
+bool IsSupportSSSE3()
 {
-    u8 color = 0;
-    for( u32 i=0; i<size; ++i )
-    {
-        color = (u8)fgetc( pFile );
-        pPixels[ i * 4 + 2 ] = pColorMap[ color * 3 + 0 ];
-        pPixels[ i * 4 + 1 ] = pColorMap[ color * 3 + 1 ];
-        pPixels[ i * 4 + 0 ] = pColorMap[ color * 3 + 2 ];
-        pPixels[ i * 4 + 3 ] = 255;
-    }
+    static const bool result = []()
+    {
+    #if defined(_MSC_VER)
+        int info[4];
+        __cpuid( info, 1 );
+        return ( info[2] & ( 0x1 << 9 ) ) != 0;
+    #else
+        unsigned int a, b, c, d;
+        if ( !__get_cpuid( 1, &a, &b, &c, &d ) )
+        { return false; }
+        return ( c & bit_SSSE3 ) != 0;
+    #endif
+    }();
+
+    return result;
 }
+#endif//ASDX_IS_SSE2 && !ASDX_IS_AVX2
 
+
+#if ASDX_IS_SSE2
 //-------------------------------------------------------------------------------------------------
-//! @brief      16Bitフルカラー形式を解析します.
+//! @brief      BGRA を RGBA に並べ替えます(SSSE3/AVX2).
+//!
+//! @return     変換したピクセル数を返却します.
 //-------------------------------------------------------------------------------------------------
-void Parse16Bits( FILE* pFile, u32 size, u8* pPixels )
+TGA_TARGET_SSSE3
+u32 Swizzle32SIMD( const u8* pSrc, u32 count, u8* pDst )
 {
-    for( u32 i=0; i<size; ++i )
+    u32 i = 0;
+
+#if ASDX_IS_AVX2
     {
-        u16 color = static_cast<u16>(fgetc( pFile ) + ( fgetc( pFile ) << 8 ));
-        pPixels[ i * 4 + 0 ] = (u8)(( ( color & 0x7C00 ) >> 10 ) << 3);
-        pPixels[ i * 4 + 1 ] = (u8)(( ( color & 0x03E0 ) >>  5 ) << 3);
-        pPixels[ i * 4 + 2 ] = (u8)(( ( color & 0x001F ) >>  0 ) << 3);
-        pPixels[ i * 4 + 3 ] = 255;
+        const auto mask = _mm256_setr_epi8(
+            2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+            2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15 );
+
+        for( ; i + 8 <= count; i += 8 )
+        {
+            auto v = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( pSrc + i * 4 ) );
+            _mm256_storeu_si256( reinterpret_cast<__m256i*>( pDst + i * 4 ), _mm256_shuffle_epi8( v, mask ) );
+        }
     }
+#endif
+
+    const auto mask = _mm_setr_epi8( 2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15 );
+
+    for( ; i + 4 <= count; i += 4 )
+    {
+        auto v = _mm_loadu_si128( reinterpret_cast<const __m128i*>( pSrc + i * 4 ) );
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( pDst + i * 4 ), _mm_shuffle_epi8( v, mask ) );
+    }
+
+    return i;
 }
 
 //-------------------------------------------------------------------------------------------------
-//! @brief      24Bitフルカラー形式を解析します.
+//! @brief      BGR を RGBA に並べ替えます(SSSE3/AVX2).
+//!
+//! @return     変換したピクセル数を返却します.
+//! @note       16byte 単位で読み込むため, 末尾の数ピクセルは変換しません.
 //-------------------------------------------------------------------------------------------------
-void Parse24Bits( FILE* pFile, u32 size, u8* pPixels )
+TGA_TARGET_SSSE3
+u32 Swizzle24SIMD( const u8* pSrc, u32 count, u8* pDst )
 {
-    for( u32 i=0; i<size; ++i )
+    u32 i = 0;
+
+#if ASDX_IS_AVX2
     {
-        pPixels[ i * 4 + 2 ] = (u8)fgetc( pFile );
-        pPixels[ i * 4 + 1 ] = (u8)fgetc( pFile );
-        pPixels[ i * 4 + 0 ] = (u8)fgetc( pFile );
-        pPixels[ i * 4 + 3 ] = 255;
+        const auto mask = _mm256_setr_epi8(
+            2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1,
+            2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1 );
+        const auto alpha = _mm256_set1_epi32( int( 0xff000000 ) );
+
+        // 上位レーンは12byte先から読み込み, 各レーンで4ピクセルを並べ替える.
+        for( ; i + 10 <= count; i += 8 )
+        {
+            auto lo = _mm_loadu_si128( reinterpret_cast<const __m128i*>( pSrc + i * 3 ) );
+            auto hi = _mm_loadu_si128( reinterpret_cast<const __m128i*>( pSrc + i * 3 + 12 ) );
+            auto v  = _mm256_inserti128_si256( _mm256_castsi128_si256( lo ), hi, 1 );
+            v = _mm256_or_si256( _mm256_shuffle_epi8( v, mask ), alpha );
+            _mm256_storeu_si256( reinterpret_cast<__m256i*>( pDst + i * 4 ), v );
+        }
     }
+#endif
+
+    const auto mask  = _mm_setr_epi8( 2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1 );
+    const auto alpha = _mm_set1_epi32( int( 0xff000000 ) );
+
+    for( ; i + 6 <= count; i += 4 )
+    {
+        auto v = _mm_loadu_si128( reinterpret_cast<const __m128i*>( pSrc + i * 3 ) );
+        v = _mm_or_si128( _mm_shuffle_epi8( v, mask ), alpha );
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( pDst + i * 4 ), v );
+    }
+
+    return i;
 }
 
 //-------------------------------------------------------------------------------------------------
-//! @brief      32Bitフルカラー形式を解析します.
+//! @brief      SIMD 命令でピクセルを変換するかどうかチェックします.
 //-------------------------------------------------------------------------------------------------
-void Parse32Bits( FILE* pFile, u32 size, u8* pPixels )
+inline bool IsShuffleEnabled()
 {
-    for( u32 i=0; i<size; ++i )
-    {
-        pPixels[ i * 4 + 2 ] = (u8)fgetc( pFile );
-        pPixels[ i * 4 + 1 ] = (u8)fgetc( pFile );
-        pPixels[ i * 4 + 0 ] = (u8)fgetc( pFile );
-        pPixels[ i * 4 + 3 ] = (u8)fgetc( pFile );
-    }
+#if ASDX_IS_AVX2
+    return true;
+#else
+    return IsSupportSSSE3();
+#endif
+}
+#endif//ASDX_IS_SSE2
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      8Bitインデックスカラーを変換します.
+//-------------------------------------------------------------------------------------------------
+void Convert8BitsIndex( const u8* pSrc, u32 count, const u32* pPalette, u8* pDst )
+{
+    for( u32 i=0; i<count; ++i )
+    { memcpy( pDst + i * 4, &pPalette[ pSrc[ i ] ], 4 ); }
 }
 
 //-------------------------------------------------------------------------------------------------
-//! @brief     8Bitグレースケール形式を解析します.
+//! @brief      16Bitフルカラー(5:5:5)を変換します.
 //-------------------------------------------------------------------------------------------------
-void Parse8BitsGrayScale( FILE* pFile, u32 size, u8* pPixels )
+void Convert16Bits( const u8* pSrc, u32 count, const u32*, u8* pDst )
 {
-    for( u32 i=0; i<size; ++i )
+    u32 i = 0;
+
+#if ASDX_IS_SSE2
     {
-        pPixels[ i ] = (u8)fgetc( pFile );
+        const auto maskC = _mm_set1_epi16( 0xf8 );
+        const auto alpha = _mm_set1_epi16( short( 0xff00 ) );
+
+        // 8ピクセルずつ R|G<<8, B|A<<8 の16bit値を作ってインタリーブする.
+        for( ; i + 8 <= count; i += 8 )
+        {
+            auto c  = _mm_loadu_si128( reinterpret_cast<const __m128i*>( pSrc + i * 2 ) );
+            auto r  = _mm_and_si128( _mm_srli_epi16( c, 7 ), maskC );
+            auto g  = _mm_and_si128( _mm_srli_epi16( c, 2 ), maskC );
+            auto b  = _mm_and_si128( _mm_slli_epi16( c, 3 ), maskC );
+            auto rg = _mm_or_si128( r, _mm_slli_epi16( g, 8 ) );
+            auto ba = _mm_or_si128( b, alpha );
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( pDst + i * 4 +  0 ), _mm_unpacklo_epi16( rg, ba ) );
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( pDst + i * 4 + 16 ), _mm_unpackhi_epi16( rg, ba ) );
+        }
+    }
+#endif
+
+    for( ; i<count; ++i )
+    {
+        u16 color = u16( pSrc[ i * 2 + 0 ] | ( pSrc[ i * 2 + 1 ] << 8 ) );
+        pDst[ i * 4 + 0 ] = u8( ( ( color & 0x7C00 ) >> 10 ) << 3 );
+        pDst[ i * 4 + 1 ] = u8( ( ( color & 0x03E0 ) >>  5 ) << 3 );
+        pDst[ i * 4 + 2 ] = u8( ( ( color & 0x001F ) >>  0 ) << 3 );
+        pDst[ i * 4 + 3 ] = 255;
     }
 }
 
 //-------------------------------------------------------------------------------------------------
-//! @brief      16Bitグレースケール形式を解析します.
+//! @brief      24Bitフルカラーを変換します.
 //-------------------------------------------------------------------------------------------------
-void Parse16BitsGrayScale( FILE* pFile, u32 size, u8* pPixels )
+void Convert24Bits( const u8* pSrc, u32 count, const u32*, u8* pDst )
 {
-    for( u32 i=0; i<size; ++i )
-    {
-        u8 gray  = (u8)fgetc( pFile );
-        u8 alpha = (u8)fgetc( pFile );
-        pPixels[ i * 4 + 0 ] = gray;
-        pPixels[ i * 4 + 1 ] = gray;
-        pPixels[ i * 4 + 2 ] = gray;
-        pPixels[ i * 4 + 3 ] = alpha; 
+    u32 i = 0;
+
+#if ASDX_IS_SSE2
+    if ( IsShuffleEnabled() )
+    { i = Swizzle24SIMD( pSrc, count, pDst ); }
+#endif
+
+    for( ; i<count; ++i )
+    {
+        pDst[ i * 4 + 0 ] = pSrc[ i * 3 + 2 ];
+        pDst[ i * 4 + 1 ] = pSrc[ i * 3 + 1 ];
+        pDst[ i * 4 + 2 ] = pSrc[ i * 3 + 0 ];
+        pDst[ i * 4 + 3 ] = 255;
     }
 }
 
 //-------------------------------------------------------------------------------------------------
-//! @brief      8BitRLE圧縮インデックスカラー形式を解析します.
-//!
-//! @param[in]  pColorMap       カラーマップです.
+//! @brief      32Bitフルカラーを変換します.
 //-------------------------------------------------------------------------------------------------
-void Parse8BitsRLE( FILE* pFile, u8* pColorMap, u32 size, u8* pPixels )
+void Convert32Bits( const u8* pSrc, u32 count, const u32*, u8* pDst )
 {
-    u32 count  = 0;
-    u8  color  = 0;
-    u8  header = 0;
-    u8* ptr    = pPixels;
+    u32 i = 0;
 
-    while( ptr < pPixels + size )   // size = width * height * 3.
+#if ASDX_IS_SSE2
+    if ( IsShuffleEnabled() )
+    { i = Swizzle32SIMD( pSrc, count, pDst ); }
+    else
     {
-        header = (u8)fgetc( pFile );
-        count = 1 + ( header & 0x7F );
+        // SSSE3 が使えない場合は R と B をシフトで入れ替える.
+        const auto maskAG = _mm_set1_epi32( int( 0xff00ff00 ) );
+        const auto maskB  = _mm_set1_epi32( 0x000000ff );
 
-        if ( header & 0x80 )
+        for( ; i + 4 <= count; i += 4 )
         {
-            color = (u8)fgetc( pFile );
-
-            for( u32 i=0; i<count; ++i, ptr+=4 )
-            {
-                ptr[ 0 ] = pColorMap[ color * 3 + 2 ];
-                ptr[ 1 ] = pColorMap[ color * 3 + 1 ];
-                ptr[ 2 ] = pColorMap[ color * 3 + 0 ];
-                ptr[ 3 ] = 255;
-            }
+            auto v  = _mm_loadu_si128( reinterpret_cast<const __m128i*>( pSrc + i * 4 ) );
+            auto ag = _mm_and_si128( v, maskAG );
+            auto r  = _mm_and_si128( _mm_srli_epi32( v, 16 ), maskB );
+            auto b  = _mm_slli_epi32( _mm_and_si128( v, maskB ), 16 );
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( pDst + i * 4 ), _mm_or_si128( ag, _mm_or_si128( r, b ) ) );
         }
-        else
-        {
-            for( u32 i=0; i<count; ++i, ptr+=4 )
-            {
-                color = (u8)fgetc( pFile );
+    }
+#endif
 
-                ptr[ 0 ] = pColorMap[ color * 3 + 2 ];
-                ptr[ 1 ] = pColorMap[ color * 3 + 1 ];
-                ptr[ 2 ] = pColorMap[ color * 3 + 0 ];
-                ptr[ 3 ] = 255;
-            }
-        }
+    for( ; i<count; ++i )
+    {
+        pDst[ i * 4 + 0 ] = pSrc[ i * 4 + 2 ];
+        pDst[ i * 4 + 1 ] = pSrc[ i * 4 + 1 ];
+        pDst[ i * 4 + 2 ] = pSrc[ i * 4 + 0 ];
+        pDst[ i * 4 + 3 ] = pSrc[ i * 4 + 3 ];
     }
 }
 
 //-------------------------------------------------------------------------------------------------
-//! @brief      16BitRLE圧縮フルカラー形式を解析します.
+//! @brief      8Bitグレースケールを変換します.
 //-------------------------------------------------------------------------------------------------
-void Parse16BitsRLE( FILE* pFile, u32 size, u8* pPixels )
+void Convert8BitsGrayScale( const u8* pSrc, u32 count, const u32*, u8* pDst )
+{ memcpy( pDst, pSrc, count ); }
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      16Bitグレースケール(輝度+アルファ)を変換します.
+//-------------------------------------------------------------------------------------------------
+void Convert16BitsGrayScale( const u8* pSrc, u32 count, const u32*, u8* pDst )
 {
-    u32 count  = 0;
-    u16 color  = 0;
-    u8  header = 0;
-    u8* ptr    = pPixels;
+    u32 i = 0;
 
-    while( ptr < pPixels + size )   // size = width * height * 3.
+#if ASDX_IS_SSE2
     {
-        header = (u8)fgetc( pFile );
-        count = 1 + ( header & 0x7F );
+        const auto maskL = _mm_set1_epi16( 0xff );
 
-        if ( header & 0x80 )
+        // 16bit値 L|A<<8 から L|L<<8 を作り, インタリーブして L,L,L,A にする.
+        for( ; i + 8 <= count; i += 8 )
         {
-            color = static_cast<u16>(fgetc( pFile ) + ( fgetc( pFile ) << 8 )); 
-
-            for( u32 i=0; i<count; ++i, ptr+=4 )
-            {
-                ptr[ 0 ] = (u8)(( ( color & 0x7C00 ) >> 10 ) << 3);
-                ptr[ 1 ] = (u8)(( ( color & 0x03E0 ) >>  5 ) << 3);
-                ptr[ 2 ] = (u8)(( ( color & 0x001F ) >>  0 ) << 3);
-                ptr[ 3 ] = 255;
-            }
+            auto la = _mm_loadu_si128( reinterpret_cast<const __m128i*>( pSrc + i * 2 ) );
+            auto l  = _mm_and_si128( la, maskL );
+            auto ll = _mm_or_si128( l, _mm_slli_epi16( l, 8 ) );
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( pDst + i * 4 +  0 ), _mm_unpacklo_epi16( ll, la ) );
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( pDst + i * 4 + 16 ), _mm_unpackhi_epi16( ll, la ) );
         }
-        else
-        {
-            for( u32 i=0; i<count; ++i, ptr+=4 )
-            {
-                color = static_cast<u16>(fgetc( pFile ) + ( fgetc( pFile ) << 8 ));
+    }
+#endif
 
-                ptr[ 0 ] = (u8)(( ( color & 0x7C00 ) >> 10 ) << 3);
-                ptr[ 1 ] = (u8)(( ( color & 0x03E0 ) >>  5 ) << 3);
-                ptr[ 2 ] = (u8)(( ( color & 0x001F ) >>  0 ) << 3);
-                ptr[ 3 ] = 255;
-            }
-        }
+    for( ; i<count; ++i )
+    {
+        auto gray  = pSrc[ i * 2 + 0 ];
+        auto alpha = pSrc[ i * 2 + 1 ];
+        pDst[ i * 4 + 0 ] = gray;
+        pDst[ i * 4 + 1 ] = gray;
+        pDst[ i * 4 + 2 ] = gray;
+        pDst[ i * 4 + 3 ] = alpha;
     }
 }
 
 //-------------------------------------------------------------------------------------------------
-//! @brief      24BitRLE圧縮フルカラー形式を解析します.
+//! @brief      同じピクセルで塗りつぶします.
 //-------------------------------------------------------------------------------------------------
-void Parse24BitsRLE( FILE* pFile, u32 size, u8* pPixels )
+void FillPixels( const u8* pPixel, u32 count, u32 bytePerPixel, u8* pDst )
 {
-    u32 count    = 0;
-    u8  color[3] = { 0, 0, 0 };
-    u8  header   = 0;
-    u8* ptr      = pPixels;
+    if ( bytePerPixel == 1 )
+    {
+        memset( pDst, pPixel[0], count );
+        return;
+    }
+
+    u32 value;
+    memcpy( &value, pPixel, sizeof(value) );
+
+    u32 i = 0;
 
-    while( ptr < pPixels + size )   // size = width * height * 3.
+#if ASDX_IS_SSE2
     {
-        header = (u8)fgetc( pFile );
-        count = 1 + ( header & 0x7F );
+        const auto v = _mm_set1_epi32( int( value ) );
+        for( ; i + 4 <= count; i += 4 )
+        { _mm_storeu_si128( reinterpret_cast<__m128i*>( pDst + i * 4 ), v ); }
+    }
+#endif
 
-        if ( header & 0x80 )
-        {
-            fread( color, sizeof(u8), 3, pFile );
+    for( ; i<count; ++i )
+    { memcpy( pDst + i * 4, &value, sizeof(value) ); }
+}
 
-            for( u32 i=0; i<count; ++i, ptr+=4 )
-            {
-                ptr[ 0 ] = color[ 2 ];
-                ptr[ 1 ] = color[ 1 ];
-                ptr[ 2 ] = color[ 0 ];
-                ptr[ 3 ] = 255;
-            }
-        }
-        else
-        {
-            for( u32 i=0; i<count; ++i, ptr+=4 )
-            {
-                ptr[ 2 ] = (u8)fgetc( pFile );
-                ptr[ 1 ] = (u8)fgetc( pFile );
-                ptr[ 0 ] = (u8)fgetc( pFile );
-                ptr[ 3 ] = 255;
-            }
-        }
+//-------------------------------------------------------------------------------------------------
+//! @brief      格納先の行の先頭ポインタを取得します.
+//-------------------------------------------------------------------------------------------------
+inline u8* GetRow( u8* pPixels, u32 rowPitch, u32 height, u32 y, bool bottomUp )
+{ return pPixels + size_t( bottomUp ? ( height - 1 - y ) : y ) * rowPitch; }
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      非圧縮のピクセルデータを解析します.
+//-------------------------------------------------------------------------------------------------
+bool DecodeRaw
+(
+    const u8*           pSrc,
+    size_t              srcSize,
+    const PixelDecoder& decoder,
+    u32                 width,
+    u32                 height,
+    bool                bottomUp,
+    u32                 rowPitch,
+    u8*                 pPixels
+)
+{
+    auto srcPitch = size_t( width ) * decoder.SrcBytes;
+    if ( srcSize < srcPitch * height )
+    { return false; }
+
+    for( u32 y=0; y<height; ++y )
+    {
+        auto pDst = GetRow( pPixels, rowPitch, height, y, bottomUp );
+        decoder.Convert( pSrc + srcPitch * y, width, decoder.pPalette, pDst );
     }
+
+    return true;
 }
 
 //-------------------------------------------------------------------------------------------------
-//! @brief      32BitRLE圧縮フルカラー形式を解析します.
+//! @brief      RLE圧縮されたピクセルデータを解析します.
+//!
+//! @note       パケットが行をまたぐ場合は行ごとに分割して格納します.
 //-------------------------------------------------------------------------------------------------
-void Parse32BitsRLE( FILE* pFile, u32 size, u8* pPixels )
+bool DecodeRLE
+(
+    const u8*           pSrc,
+    size_t              srcSize,
+    const PixelDecoder& decoder,
+    u32                 width,
+    u32                 height,
+    bool                bottomUp,
+    u32                 rowPitch,
+    u8*                 pPixels
+)
 {
-    u32 count    = 0;
-    u8  color[4] = { 0, 0, 0, 0 };
-    u8  header   = 0;
-    u8* ptr      = pPixels;
+    auto pEnd = pSrc + srcSize;
+    u32  x    = 0;
+    u32  y    = 0;
+    auto pRow = GetRow( pPixels, rowPitch, height, 0, bottomUp );
 
-    while( ptr < pPixels + size )   // size = width * height * 4.
+    while( y < height )
     {
-        header = (u8)fgetc( pFile );
-        count = 1 + ( header & 0x7F );
+        if ( pSrc >= pEnd )
+        { return false; }
+
+        auto packet = *pSrc++;
+        auto count  = 1u + ( packet & 0x7F );
 
-        if ( header & 0x80 )
+        if ( packet & 0x80 )
         {
-            fread( color, sizeof(u8), 4, pFile );
+            if ( size_t( pEnd - pSrc ) < decoder.SrcBytes )
+            { return false; }
 
-            for( u32 i=0; i<count; ++i, ptr+=4 )
+            u8 pixel[4];
+            decoder.Convert( pSrc, 1, decoder.pPalette, pixel );
+            pSrc += decoder.SrcBytes;
+
+            while( count > 0 && y < height )
             {
-                ptr[ 0 ] = color[ 2 ];
-                ptr[ 1 ] = color[ 1 ];
-                ptr[ 2 ] = color[ 0 ];
-                ptr[ 3 ] = color[ 3 ];
+                auto n = asdx::Min( count, width - x );
+                FillPixels( pixel, n, decoder.DstBytes, pRow + x * decoder.DstBytes );
+
+                count -= n;
+                x     += n;
+                if ( x == width )
+                {
+                    x = 0;
+                    y++;
+                    if ( y < height )
+                    { pRow = GetRow( pPixels, rowPitch, height, y, bottomUp ); }
+                }
             }
         }
         else
         {
-            for( u32 i=0; i<count; ++i, ptr+=4 )
+            if ( size_t( pEnd - pSrc ) < size_t( count ) * decoder.SrcBytes )
+            { return false; }
+
+            while( count > 0 && y < height )
             {
-                ptr[ 2 ] = (u8)fgetc( pFile );
-                ptr[ 1 ] = (u8)fgetc( pFile );
-                ptr[ 0 ] = (u8)fgetc( pFile );
-                ptr[ 3 ] = (u8)fgetc( pFile );
+                auto n = asdx::Min( count, width - x );
+                decoder.Convert( pSrc, n, decoder.pPalette, pRow + x * decoder.DstBytes );
+                pSrc += size_t( n ) * decoder.SrcBytes;
+
+                count -= n;
+                x     += n;
+                if ( x == width )
+                {
+                    x = 0;
+                    y++;
+                    if ( y < height )
+                    { pRow = GetRow( pPixels, rowPitch, height, y, bottomUp ); }
+                }
             }
         }
     }
+
+    return true;
 }
 
 //-------------------------------------------------------------------------------------------------
-//! @brief      8BitRLE圧縮グレースケール形式を解析します.
+//! @brief      各行のピクセルを左右反転します.
 //-------------------------------------------------------------------------------------------------
-void Parse8BitsGrayScaleRLE( FILE* pFile, u32 size, u8* pPixles )
+void FlipHorizontal( u32 width, u32 height, u32 bytePerPixel, u32 rowPitch, u8* pPixels )
 {
-    u32 count  = 0;
-    u8  color  = 0;
-    u8  header = 0;
-    u8* ptr    = pPixles;
-
-    while( ptr < pPixles + size ) // size = width * height
+    for( u32 y=0; y<height; ++y )
     {
-        header = (u8)fgetc( pFile );
-        count = 1 + ( header & 0x7F );
-
-        if ( header & 0x80 )
-        {
-            color = (u8)fgetc( pFile );
-
-            for( u32 i=0; i<count; ++i, ptr++ )
-            { (*ptr) = color; }
-        }
-        else
+        auto pRow = pPixels + size_t( y ) * rowPitch;
+        for( u32 l=0, r=width-1; l<r; ++l, --r )
         {
-            for( u32 i=0; i<count; ++i, ptr++ )
-            { (*ptr) = (u8)fgetc( pFile ); }
+            u8 temp[4];
+            memcpy( temp, pRow + l * bytePerPixel, bytePerPixel );
+            memcpy( pRow + l * bytePerPixel, pRow + r * bytePerPixel, bytePerPixel );
+            memcpy( pRow + r * bytePerPixel, temp, bytePerPixel );
         }
     }
 }
 
 //-------------------------------------------------------------------------------------------------
-//! @brief      16BitRLE圧縮グレースケール形式を解析します.
+//! @brief      ピクセル変換関数を選択します.
+//!
+//! @param[in]      bitPerPixel     ピクセル当たりのビット数です.
+//! @param[in]      grayScale       グレースケールかどうか.
+//! @param[out]     pDecoder        変換関数の格納先です.
+//! @retval true    対応しているフォーマットです.
+//! @retval false   未対応のフォーマットです.
 //-------------------------------------------------------------------------------------------------
-void Parse16BitsGrayScaleRLE( FILE* pFile, u32 size, u8* pPixles )
+bool SelectDecoder( u32 bitPerPixel, bool grayScale, PixelDecoder* pDecoder )
 {
-    u32 count  = 0;
-    u8  color  = 0;
-    u8  alpha  = 0;
-    u8  header = 0;
-    u8* ptr    = pPixles;
-
-    while( ptr < pPixles + size ) // size = width * height * 2
+    if ( grayScale )
     {
-        header = (u8)fgetc( pFile );
-        count = 1 + ( header & 0x7F );
-
-        if ( header & 0x80 )
-        {
-            color = (u8)fgetc( pFile );
-            alpha = (u8)fgetc( pFile );
-
-            for( u32 i=0; i<count; ++i, ptr+=4 )
-            {
-                ptr[ 0 ] = color;
-                ptr[ 1 ] = color;
-                ptr[ 2 ] = color;
-                ptr[ 3 ] = alpha;
-            }
-        }
-        else
+        switch( bitPerPixel )
         {
-            for( u32 i=0; i<count; ++i, ptr+=4 )
-            {
-                color = (u8)fgetc( pFile );
-                alpha = (u8)fgetc( pFile );
-                ptr[ 0 ] = color;
-                ptr[ 1 ] = color;
-                ptr[ 2 ] = color;
-                ptr[ 3 ] = alpha;
-            }
+        case 8:  { *pDecoder = { Convert8BitsGrayScale,  1, 1, nullptr }; } return true;
+        case 16: { *pDecoder = { Convert16BitsGrayScale, 2, 4, nullptr }; } return true;   // R8L8フォーマットが使えないためR8G8B8A8に変更.
         }
+        return false;
     }
+
+    // R8G8B8が使えないためR8G8B8A8に変更.
+    switch( bitPerPixel )
+    {
+    case 15:
+    case 16: { *pDecoder = { Convert16Bits, 2, 4, nullptr }; } return true;
+    case 24: { *pDecoder = { Convert24Bits, 3, 4, nullptr }; } return true;
+    case 32: { *pDecoder = { Convert32Bits, 4, 4, nullptr }; } return true;
+    }
+
+    return false;
 }
 
 } // namespace /* anonymous */
 
+
 namespace asdx {
 
 //-------------------------------------------------------------------------------------------------
-//      TGAファイルからリソーステクスチャを生成します.
+//      メモリ上のTGAデータからテクスチャを読込します.
 //-------------------------------------------------------------------------------------------------
-bool LoadResTextureFromTGA( const char16* filename, ResTexture* pResult )
+bool LoadResTextureFromTGA( const u8* pBuffer, size_t size, ResTexture* pResult )
 {
-        // 引数チェック.
-    if ( filename == nullptr )
+    // 引数チェック.
+    if ( pBuffer == nullptr || pResult == nullptr )
     {
         ELOG( "Error : Invalid Argument." );
         return false;
     }
 
-    FILE* pFile;
-
-    // ファイルを開く.
-    auto err = _wfopen_s( &pFile, filename, L"rb" );
-    if ( err != 0 )
-    {
-        ELOG( "Error : File Open Failed." );
-        return false;
-    }
-
-    // フッターを読み込み.
-    TGA_FOOTER footer;
-    long offset = sizeof(footer);
-    fseek( pFile, -offset, SEEK_END );
-    fread( &footer, sizeof(footer), 1, pFile );
-
-    // ファイルマジックをチェック.
-    if ( strcmp( footer.Tag, "TRUEVISION-XFILE." ) != 0 &&
-         strcmp( footer.Tag, "TRUEVISION-TARGA." ) != 0 )
+    if ( size < sizeof(TGA_HEADER) )
     {
         ELOG( "Error : Invalid File Format." );
-        fclose( pFile );
         return false;
     }
 
-    // 拡張データがある場合は読み込み.
-    if ( footer.OffsetExt != 0 )
-    {
-        TGA_EXTENSION extension;
-
-        fseek( pFile, footer.OffsetExt, SEEK_SET );
-        fread( &extension, sizeof(extension), 1, pFile );
-    }
+    // ヘッダデータを読み込む.
+    TGA_HEADER header;
+    memcpy( &header, pBuffer, sizeof(header) );
 
-    // ディベロッパーエリアがある場合.
-    if ( footer.OffsetDev != 0 )
+    if ( header.Width == 0 || header.Height == 0 )
     {
-        /* NOT IMPLEMENT */
+        ELOG( "Error : Invalid Image Size." );
+        return false;
     }
 
-    // ファイル先頭に戻す.
-    fseek( pFile, 0, SEEK_SET );
-
-    // ヘッダデータを読み込む.
-    TGA_HEADER header;
-    fread( &header, sizeof(header), 1, pFile );
-
     // フォーマット判定.
-    u32 bytePerPixel;
+    PixelDecoder decoder = {};
+    bool         rle     = false;
+    DXGI_FORMAT  format  = DXGI_FORMAT_R8G8B8A8_UNORM;
     switch( header.Format )
     {
-    // 該当なし.
-    case TGA_FORMAT_NONE:
+    // グレースケール.
+    case TGA_FORMAT_GRAYSCALE:
+    case TGA_FORMAT_RLE_GRAYSCALE:
         {
-            ELOG( "Error : Invalid Format." );
-            fclose( pFile );
-            return false;
+            if ( !SelectDecoder( header.BitPerPixel, true, &decoder ) )
+            {
+                ELOG( "Error : Unsupported Format." );
+                return false;
+            }
+
+            if ( header.BitPerPixel == 8 )
+            { format = DXGI_FORMAT_R8_UNORM; }
+
+            rle = ( header.Format == TGA_FORMAT_RLE_GRAYSCALE );
         }
         break;
 
-    // グレースケール
-    case TGA_FORMAT_GRAYSCALE:
-    case TGA_FORMAT_RLE_GRAYSCALE:
-        { 
-            if ( header.BitPerPixel == 8 )
-            { bytePerPixel = 1; }
-            else
+    // パレット.
+    case TGA_FORMAT_INDEXCOLOR:
+    case TGA_FORMAT_RLE_INDEXCOLOR:
+        {
+            if ( header.BitPerPixel != 8 || !header.HasColorMap )
             {
-            #if 0
-                //bytePerPixel = 2;
-            #endif
-                bytePerPixel = 4;   // R8L8フォーマットが使えないためR8G8B8A8に変更.
+                ELOG( "Error : Unsupported Format." );
+                return false;
             }
+
+            decoder = { Convert8BitsIndex, 1, 4, nullptr };
+            rle     = ( header.Format == TGA_FORMAT_RLE_INDEXCOLOR );
         }
         break;
 
-    // カラー.
-    case TGA_FORMAT_INDEXCOLOR:
+    // フルカラー.
     case TGA_FORMAT_FULLCOLOR:
-    case TGA_FORMAT_RLE_INDEXCOLOR:
     case TGA_FORMAT_RLE_FULLCOLOR:
         {
-        #if 0
-            //if ( header.BitPerPixel <= 24 )
-            //{ bytePerPixel = 3; }
-            //else
-            //{ bytePerPixel = 4; }
-        #endif
-            bytePerPixel = 4;   // R8G8B8が使えないためR8G8B8A8に変更.
+            if ( !SelectDecoder( header.BitPerPixel, false, &decoder ) )
+            {
+                ELOG( "Error : Unsupported Format." );
+                return false;
+            }
+
+            rle = ( header.Format == TGA_FORMAT_RLE_FULLCOLOR );
         }
         break;
 
@@ -543,180 +640,96 @@ bool LoadResTextureFromTGA( const char16* filename, ResTexture* pResult )
     default:
         {
             ELOG( "Error : Unsupported Format." );
-            fclose( pFile );
             return false;
         }
-        break;
     }
 
     // IDフィールドサイズ分だけオフセットを移動させる.
-    fseek( pFile, header.IdFieldLength, SEEK_CUR );
-
-    Surface* pSurface = new (std::nothrow) Surface();
-    if ( pSurface == nullptr )
-    {
-        fclose( pFile );
-        return false;
-    }
+    size_t offset = sizeof(TGA_HEADER) + header.IdFieldLength;
 
-    // ピクセルサイズを決定.
-    auto rowPitch   = header.Width * bytePerPixel;
-    auto slicePitch = rowPitch * header.Height;
-
-    pSurface->Width      = header.Width;
-    pSurface->Height     = header.Height;
-    pSurface->RowPitch   = rowPitch;
-    pSurface->SlicePitch = slicePitch;
-    pSurface->pPixels    = new (std::nothrow) u8 [ slicePitch ];
-    if ( pSurface->pPixels == nullptr )
-    {
-        ELOG( "Error : Out Of Memory." );
-        fclose( pFile );
-        SafeDelete( pSurface );
-        return false;
-    }
-
-    // カラーマップを持つかチェック.
-    u8* pColorMap = nullptr;
+    // カラーマップを持つ場合はパレットを作成.
+    u32 palette[256] = {};
     if ( header.HasColorMap )
     {
-        // カラーマップサイズを算出.
-        u32 colorMapSize = header.ColorMapEntry * ( header.ColorMapEntrySize >> 3 );
-
-        // メモリを確保.
-        pColorMap = new (std::nothrow) u8 [ colorMapSize ];
-        if ( pColorMap == nullptr )
+        PixelDecoder entry = {};
+        if ( !SelectDecoder( header.ColorMapEntrySize, false, &entry ) )
         {
-            ELOG( "Error : Out Of Memory." );
-            SafeDeleteArray( pSurface->pPixels );
-            SafeDelete( pSurface );
-            fclose( pFile );
+            ELOG( "Error : Unsupported Color Map." );
             return false;
         }
 
-        // がばっと読み込む.
-        fread( pColorMap, sizeof(u8), colorMapSize, pFile );
-    }
-
-    DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
-
-    // フォーマットに合わせてピクセルデータを解析する.
-    switch( header.Format )
-    {
-    // パレット.
-    case TGA_FORMAT_INDEXCOLOR:
-        { 
-            Parse8Bits( pFile, pSurface->Width * pSurface->Height, pColorMap, pSurface->pPixels );
-            format = DXGI_FORMAT_R8G8B8A8_UNORM;
-        }
-        break;
-
-    // フルカラー.
-    case TGA_FORMAT_FULLCOLOR:
+        auto colorMapSize = size_t( header.ColorMapLength ) * entry.SrcBytes;
+        if ( offset > size || size - offset < colorMapSize )
         {
-            switch( header.BitPerPixel )
-            {
-            case 16:
-                { 
-                    Parse16Bits( pFile, pSurface->Width * pSurface->Height, pSurface->pPixels );
-                    format = DXGI_FORMAT_R8G8B8A8_UNORM;
-                }
-                break;
-
-            case 24:
-                {
-                    Parse24Bits( pFile, pSurface->Width * pSurface->Height, pSurface->pPixels );
-                    format = DXGI_FORMAT_R8G8B8A8_UNORM;
-                }
-                break;
-
-            case 32:
-                {
-                    Parse32Bits( pFile, pSurface->Width * pSurface->Height, pSurface->pPixels );
-                    format = DXGI_FORMAT_R8G8B8A8_UNORM;
-                }
-                break;
-            }
+            ELOG( "Error : Invalid Color Map." );
+            return false;
         }
-        break;
 
-    // グレースケール.
-    case TGA_FORMAT_GRAYSCALE:
+        // ColorMapEntry は先頭エントリーのインデックス.
+        if ( header.ColorMapEntry < 256 )
         {
-            if ( header.BitPerPixel == 8 )
-            { 
-                Parse8BitsGrayScale( pFile, pSurface->Width * pSurface->Height, pSurface->pPixels );
-                format = DXGI_FORMAT_R8_UNORM;
-            }
-            else
-            { 
-                Parse16BitsGrayScale( pFile, pSurface->Width * pSurface->Height, pSurface->pPixels );
-                format = DXGI_FORMAT_R8G8B8A8_UNORM;
-            }
+            auto count = asdx::Min( u32( header.ColorMapLength ), 256u - header.ColorMapEntry );
+            entry.Convert( pBuffer + offset, count, nullptr, reinterpret_cast<u8*>( palette + header.ColorMapEntry ) );
         }
-        break;
 
-    // パレットRLE圧縮.
-    case TGA_FORMAT_RLE_INDEXCOLOR:
-        { 
-            Parse8BitsRLE( pFile, pColorMap, pSurface->Width * pSurface->Height * 3, pSurface->pPixels );
-            format = DXGI_FORMAT_R8G8B8A8_UNORM;
-        }
-        break;
+        offset += colorMapSize;
+        decoder.pPalette = palette;
+    }
 
-    // フルカラーRLE圧縮.
-    case TGA_FORMAT_RLE_FULLCOLOR:
-        {
-            switch( header.BitPerPixel )
-            {
-            case 16:
-                {
-                    Parse16BitsRLE( pFile, pSurface->Width * pSurface->Height * 3, pSurface->pPixels );
-                    format = DXGI_FORMAT_R8G8B8A8_UNORM;
-                }
-                break;
+    if ( offset > size )
+    {
+        ELOG( "Error : Invalid File Format." );
+        return false;
+    }
 
-            case 24:
-                {
-                    Parse24BitsRLE( pFile, pSurface->Width * pSurface->Height * 3, pSurface->pPixels );
-                    format = DXGI_FORMAT_R8G8B8A8_UNORM;
-                }
-                break;
+    // ピクセルサイズを決定.
+    auto rowPitch   = u32( header.Width ) * decoder.DstBytes;
+    auto slicePitch = size_t( rowPitch ) * header.Height;
 
-            case 32:
-                { 
-                    Parse32BitsRLE( pFile, pSurface->Width * pSurface->Height * 4, pSurface->pPixels ); 
-                    format = DXGI_FORMAT_R8G8B8A8_UNORM;
-                }
-                break;
-            }
-        }
-        break;
+    // Surface::SlicePitch で表せないサイズは扱わない.
+    if ( slicePitch > U32_MAX )
+    {
+        ELOG( "Error : Too Large Image. width = %u, height = %u", u32( header.Width ), u32( header.Height ) );
+        return false;
+    }
 
-    // グレースケールRLE圧縮.
-    case TGA_FORMAT_RLE_GRAYSCALE:
-        {
-            if ( header.BitPerPixel == 8 )
-            { 
-                Parse8BitsGrayScaleRLE( pFile, pSurface->Width * pSurface->Height, pSurface->pPixels );
-                format = DXGI_FORMAT_R8_UNORM;
-            }
-            else
-            {
-                Parse16BitsGrayScaleRLE( pFile, pSurface->Width * pSurface->Height * 2, pSurface->pPixels ); 
-                format = DXGI_FORMAT_R8G8B8A8_UNORM;
-            }
-        }
-        break;
+    Surface* pSurface = new (std::nothrow) Surface[1];
+    if ( pSurface == nullptr )
+    {
+        ELOG( "Error : Out Of Memory." );
+        return false;
+    }
+
+    pSurface->Width      = header.Width;
+    pSurface->Height     = header.Height;
+    pSurface->RowPitch   = rowPitch;
+    pSurface->SlicePitch = u32( slicePitch );
+    pSurface->pPixels    = new (std::nothrow) u8 [ slicePitch ];
+    if ( pSurface->pPixels == nullptr )
+    {
+        ELOG( "Error : Out Of Memory." );
+        SafeDeleteArray( pSurface );
+        return false;
     }
 
-    // 不要なメモリを解放.
-    SafeDeleteArray( pColorMap );
+    // 格納方向はヘッダで指定され, 既定は下から上.
+    auto bottomUp    = ( header.ImageDescriptor & 0x20 ) == 0;
+    auto rightToLeft = ( header.ImageDescriptor & 0x10 ) != 0;
 
-    // ファイルを閉じる.
-    fclose( pFile );
+    // ピクセルデータを解析する.
+    auto result = ( rle )
+        ? DecodeRLE( pBuffer + offset, size - offset, decoder, header.Width, header.Height, bottomUp, rowPitch, pSurface->pPixels )
+        : DecodeRaw( pBuffer + offset, size - offset, decoder, header.Width, header.Height, bottomUp, rowPitch, pSurface->pPixels );
+    if ( !result )
+    {
+        ELOG( "Error : Invalid Pixel Data." );
+        SafeDeleteArray( pSurface->pPixels );
+        SafeDeleteArray( pSurface );
+        return false;
+    }
 
-    assert( format != DXGI_FORMAT_UNKNOWN );
+    if ( rightToLeft )
+    { FlipHorizontal( header.Width, header.Height, decoder.DstBytes, rowPitch, pSurface->pPixels ); }
 
     // リソーステクスチャを設定.
     (*pResult).Width        = pSurface->Width;
@@ -732,6 +745,33 @@ bool LoadResTextureFromTGA( const char16* filename, ResTexture* pResult )
     return true;
 }
 
+//-------------------------------------------------------------------------------------------------
+//      TGAファイルからテクスチャを読込します.
+//-------------------------------------------------------------------------------------------------
+bool LoadResTextureFromTGA( const char16* filename, ResTexture* pResult )
+{
+    // 引数チェック.
+    if ( filename == nullptr || pResult == nullptr )
+    {
+        ELOG( "Error : Invalid Argument." );
+        return false;
+    }
+
+    // ファイルをメモリにマッピング.
+    MappedFile file;
+    if ( !file.Open( filename ) )
+    {
+        ELOGW( "Error : File Open Failed. filename = %ls", filename );
+        return false;
+    }
+
+    if ( !LoadResTextureFromTGA( file.GetData(), size_t( file.GetSize() ), pResult ) )
+    {
+        ELOGW( "Error : Invalid File. filename = %ls", filename );
+        return false;
+    }
 
-} // namespace asdx
+    return true;
+}
 
+} // namespace asdx
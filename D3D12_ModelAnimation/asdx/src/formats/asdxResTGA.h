@@ -8,11 +8,25 @@
 //-------------------------------------------------------------------------------------------------
 // Includes
 //-------------------------------------------------------------------------------------------------
+#include <cstddef>
 #include <asdxResTexture.h>
 
 
 namespace asdx {
 
+//-------------------------------------------------------------------------------------------------
+//! @brief      メモリ上のTGAデータからテクスチャを読込します.
+//!
+//! @param[in]      pBuffer         ファイル全体を格納したバッファです.
+//! @param[in]      size            バッファサイズです.
+//! @param[out]     pResult         リソーステクスチャの格納先です.
+//! @retval true    読込に成功.
+//! @retval false   読込に失敗.
+//! @note       RLEパケットは行単位のまとめ書きで展開し, 格納方向はヘッダに従って上から下に揃えます.
+//!             8Bitグレースケールは R8, それ以外は R8G8B8A8 で格納します.
+//-------------------------------------------------------------------------------------------------
+bool LoadResTextureFromTGA( const u8* pBuffer, size_t size, ResTexture* pResult );
+
 //-------------------------------------------------------------------------------------------------
 //! @brief      TGAからテクスチャを読込します.
 //!
@@ -20,6 +34,7 @@ namespace asdx {
 //! @param[out]     pResult         リソーステクスチャの格納先です.
 //! @retval true    読込に成功.
 //! @retval false   読込に失敗.
+//! @note       ファイルはメモリにマッピングして読み込みます.
 //-------------------------------------------------------------------------------------------------
 bool LoadResTextureFromTGA( const char16* filename, ResTexture* pResult );
 
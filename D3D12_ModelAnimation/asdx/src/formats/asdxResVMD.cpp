@@ -0,0 +1,588 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxResVMD.cpp
+// Desc : Vocaloid Motion Data Format (*.vmd) Loader
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <cstddef>
+#include <cstring>
+#include <cmath>
+#include <unordered_map>
+#include <algorithm>
+#include <asdxLogger.h>
+#include <asdxFile.h>
+#include "asdxResVMD.h"
+#include "asdxResPMD.h"
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------------
+// Constant Values.
+//-------------------------------------------------------------------------------------------------
+static constexpr size_t VMD_HEADER_SIZE     = 30;   //!< ヘッダのサイズです.
+static constexpr size_t VMD_BONE_NAME_SIZE  = 15;   //!< ボーン名のサイズです.
+static constexpr u32    REDUCE_WINDOW_SIZE  = 64;   //!< キー削減で1度に省略できる最大キー数です.
+static constexpr u32    MAX_RETRY_COUNT     = 8;    //!< メモリ予算を超えた場合の最大再試行回数です.
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// VMD_BONE_KEY structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma pack( push, 1 )
+struct VMD_BONE_KEY
+{
+    char8   BoneName[VMD_BONE_NAME_SIZE];   //!< ボーン名です.
+    u32     Frame;                          //!< フレーム番号です.
+    f32     Location[3];                    //!< 位置座標(バインドポーズからの移動量)です.
+    f32     Rotation[4];                    //!< 回転量(x, y, z, w)です.
+    u8      Interpolation[64];              //!< 補間曲線です(先頭16バイトに X, Y, Z, 回転の x1, y1, x2, y2).
+};
+#pragma pack( pop )
+
+static_assert( sizeof(VMD_BONE_KEY) == 111, "VMD_BONE_KEY size mismatch." );
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// BoneGroup structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct BoneGroup
+{
+    u64     Hash;       //!< ボーン名のハッシュ値です.
+    u32     FirstKey;   //!< 名前を取得するキー番号です.
+    u32     Offset;     //!< 並び替えたキー番号の先頭です.
+    u32     Count;      //!< キー数です.
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// BezierCurve structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct BezierCurve
+{
+    f32     X1;
+    f32     Y1;
+    f32     X2;
+    f32     Y2;
+    bool    Linear;
+
+    //---------------------------------------------------------------------------------------------
+    //      補間曲線を設定します.
+    //---------------------------------------------------------------------------------------------
+    void Init( const u8* pInterpolation, u32 channel )
+    {
+        auto x1 = pInterpolation[channel +  0];
+        auto y1 = pInterpolation[channel +  4];
+        auto x2 = pInterpolation[channel +  8];
+        auto y2 = pInterpolation[channel + 12];
+
+        X1 = x1 / 127.0f;
+        Y1 = y1 / 127.0f;
+        X2 = x2 / 127.0f;
+        Y2 = y2 / 127.0f;
+
+        // 制御点が対角線上にあれば直線.
+        Linear = ( x1 == y1 && x2 == y2 );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //      補間係数を求めます.
+    //---------------------------------------------------------------------------------------------
+    f32 Evaluate( f32 t ) const
+    {
+        if ( Linear )
+        { return t; }
+
+        // x(s) = t となる s をニュートン法で求め, 収束しなければ二分法.
+        auto s = t;
+        for( auto i=0; i<8; ++i )
+        {
+            auto x  = Bezier( X1, X2, s ) - t;
+            if ( fabsf( x ) < 1e-6f )
+            { return Bezier( Y1, Y2, s ); }
+
+            auto dx = BezierDerivative( X1, X2, s );
+            if ( fabsf( dx ) < 1e-6f )
+            { break; }
+
+            s -= x / dx;
+            if ( s < 0.0f || s > 1.0f )
+            { break; }
+        }
+
+        auto lo = 0.0f;
+        auto hi = 1.0f;
+        s = t;
+        for( auto i=0; i<24; ++i )
+        {
+            s = ( lo + hi ) * 0.5f;
+            if ( Bezier( X1, X2, s ) < t )
+            { lo = s; }
+            else
+            { hi = s; }
+        }
+
+        return Bezier( Y1, Y2, s );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //      始点(0)と終点(1)を固定した3次ベジェ曲線を評価します.
+    //---------------------------------------------------------------------------------------------
+    static f32 Bezier( f32 p1, f32 p2, f32 s )
+    {
+        auto r = 1.0f - s;
+        return 3.0f * r * r * s * p1 + 3.0f * r * s * s * p2 + s * s * s;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //      3次ベジェ曲線の微分を評価します.
+    //---------------------------------------------------------------------------------------------
+    static f32 BezierDerivative( f32 p1, f32 p2, f32 s )
+    {
+        auto r = 1.0f - s;
+        return 3.0f * r * r * p1 + 6.0f * r * s * ( p2 - p1 ) + 3.0f * s * s * ( 1.0f - p2 );
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// KeyReducer class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class KeyReducer
+{
+public:
+    //---------------------------------------------------------------------------------------------
+    //      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    KeyReducer( f32 tolerance, std::vector<asdx::ResKeyFrame>* pResult )
+    : m_Tolerance   ( tolerance )
+    , m_pResult     ( pResult )
+    , m_Count       ( 0 )
+    { /* DO_NOTHING */ }
+
+    //---------------------------------------------------------------------------------------------
+    //      時間順にキーを追加します.
+    //---------------------------------------------------------------------------------------------
+    void Add( const asdx::ResKeyFrame& key )
+    {
+        // 先頭キーと削減しない場合はそのまま格納.
+        if ( m_Count == 0 || m_Tolerance <= 0.0f )
+        {
+            m_pResult->push_back( key );
+            m_Window[0] = key;
+            m_Count = 1;
+            return;
+        }
+
+        // 確定したキーから key までを線形補間で表せるか?
+        if ( m_Count < REDUCE_WINDOW_SIZE && CanSkip( key ) )
+        {
+            m_Window[m_Count++] = key;
+            return;
+        }
+
+        // 1つ前のキーを確定して, そこから再開.
+        const auto& last = m_Window[m_Count - 1];
+        m_pResult->push_back( last );
+
+        m_Window[0] = last;
+        m_Window[1] = key;
+        m_Count = 2;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //      保留中のキーを確定します.
+    //---------------------------------------------------------------------------------------------
+    void Flush()
+    {
+        if ( m_Count > 1 )
+        { m_pResult->push_back( m_Window[m_Count - 1] ); }
+
+        m_Count = 0;
+    }
+
+private:
+    f32                                 m_Tolerance;
+    std::vector<asdx::ResKeyFrame>*     m_pResult;
+    asdx::ResKeyFrame                   m_Window[REDUCE_WINDOW_SIZE];   // [0] は確定済みのキー.
+    u32                                 m_Count;
+
+    //---------------------------------------------------------------------------------------------
+    //      保留中のキーを線形補間で表せるかどうかチェックします.
+    //---------------------------------------------------------------------------------------------
+    bool CanSkip( const asdx::ResKeyFrame& key ) const
+    {
+        const auto& k0 = m_Window[0];
+        auto invDuration = 1.0f / f32( key.Time - k0.Time );
+
+        for( u32 i=1; i<m_Count; ++i )
+        {
+            const auto& k = m_Window[i];
+            auto t = f32( k.Time - k0.Time ) * invDuration;
+
+            // MotionPlayer と同じく行列の要素ごとの線形補間と比較する.
+            for( auto r=0; r<4; ++r )
+            {
+                for( auto c=0; c<3; ++c )
+                {
+                    auto a = k0.Transform.m[r][c];
+                    auto v = a + ( key.Transform.m[r][c] - a ) * t;
+                    if ( fabsf( v - k.Transform.m[r][c] ) > m_Tolerance )
+                    { return false; }
+                }
+            }
+        }
+
+        return true;
+    }
+};
+
+//-------------------------------------------------------------------------------------------------
+//      ボーン名のハッシュ値を求めます(FNV-1a).
+//-------------------------------------------------------------------------------------------------
+u64 HashName( const char8* pName )
+{
+    u64 hash = 0xcbf29ce484222325ull;
+    for( size_t i=0; i<VMD_BONE_NAME_SIZE && pName[i] != '\0'; ++i )
+    {
+        hash ^= u8( pName[i] );
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      キーを読み込みます.
+//-------------------------------------------------------------------------------------------------
+inline const u8* GetKey( const u8* pKeys, u32 index )
+{ return pKeys + sizeof(VMD_BONE_KEY) * index; }
+
+//-------------------------------------------------------------------------------------------------
+//      キーフレームを生成します.
+//-------------------------------------------------------------------------------------------------
+asdx::ResKeyFrame CreateKeyFrame( u32 time, const asdx::Quaternion& rotation, const asdx::Vector3& location )
+{
+    asdx::ResKeyFrame result;
+    result.Time      = time;
+    result.Transform = asdx::Matrix::CreateFromQuaternion( rotation );
+    result.Transform._41 = location.x;
+    result.Transform._42 = location.y;
+    result.Transform._43 = location.z;
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      1ボーン分のキーを補間曲線に従って変換します.
+//-------------------------------------------------------------------------------------------------
+void ConvertBone
+(
+    const u8*                       pKeys,
+    const u64*                      pOrder,
+    u32                             count,
+    const asdx::Vector3&            bindLocal,
+    f32                             tolerance,
+    std::vector<asdx::ResKeyFrame>* pResult
+)
+{
+    KeyReducer reducer( tolerance, pResult );
+
+    auto                hasPrev   = false;
+    u32                 prevFrame = 0;
+    asdx::Vector3       prevLocation( 0.0f, 0.0f, 0.0f );
+    asdx::Quaternion    prevRotation( 0.0f, 0.0f, 0.0f, 1.0f );
+
+    for( u32 i=0; i<count; ++i )
+    {
+        // 同じフレームのキーは後のものを優先する.
+        if ( i + 1 < count && ( pOrder[i] >> 32 ) == ( pOrder[i + 1] >> 32 ) )
+        { continue; }
+
+        VMD_BONE_KEY key;
+        memcpy( &key, GetKey( pKeys, u32( pOrder[i] ) ), sizeof(key) );
+
+        auto location = bindLocal + asdx::Vector3( key.Location[0], key.Location[1], key.Location[2] );
+        auto rotation = asdx::Quaternion::Normalize( asdx::Quaternion(
+            key.Rotation[0], key.Rotation[1], key.Rotation[2], key.Rotation[3] ) );
+
+        // 回転は最短経路で補間する.
+        if ( hasPrev && asdx::Quaternion::Dot( prevRotation, rotation ) < 0.0f )
+        { rotation = -rotation; }
+
+        auto duration = key.Frame - prevFrame;
+        if ( hasPrev && duration > 1 )
+        {
+            BezierCurve curves[4];
+            for( u32 c=0; c<4; ++c )
+            { curves[c].Init( key.Interpolation, c ); }
+
+            auto sameRotation = ( prevRotation == rotation );
+            auto linear       = curves[0].Linear && curves[1].Linear && curves[2].Linear;
+
+            // 行列の線形補間で表せない区間だけ毎フレーム評価する.
+            if ( !sameRotation || !linear )
+            {
+                auto invDuration = 1.0f / f32( duration );
+                for( u32 f=1; f<duration; ++f )
+                {
+                    auto t = f32( f ) * invDuration;
+
+                    asdx::Vector3 p(
+                        prevLocation.x + ( location.x - prevLocation.x ) * curves[0].Evaluate( t ),
+                        prevLocation.y + ( location.y - prevLocation.y ) * curves[1].Evaluate( t ),
+                        prevLocation.z + ( location.z - prevLocation.z ) * curves[2].Evaluate( t ) );
+
+                    auto q = ( sameRotation )
+                        ? rotation
+                        : asdx::Quaternion::Slerp( prevRotation, rotation, curves[3].Evaluate( t ) );
+
+                    reducer.Add( CreateKeyFrame( prevFrame + f, q, p ) );
+                }
+            }
+        }
+
+        reducer.Add( CreateKeyFrame( key.Frame, rotation, location ) );
+
+        hasPrev      = true;
+        prevFrame    = key.Frame;
+        prevLocation = location;
+        prevRotation = rotation;
+    }
+
+    reducer.Flush();
+}
+
+} // namespace /* anonymous */
+
+
+namespace asdx {
+
+//-------------------------------------------------------------------------------------------------
+//      メモリ上のVMDデータからリソースモーションを読込します.
+//-------------------------------------------------------------------------------------------------
+bool LoadResMotionFromVMD
+(
+    const u8*               pBuffer,
+    size_t                  size,
+    const ResBone*          pBones,
+    u32                     boneCount,
+    const VmdConvertOption& option,
+    ResMotion*              pResult
+)
+{
+    if ( pBuffer == nullptr || pResult == nullptr || ( pBones == nullptr && boneCount > 0 ) )
+    {
+        ELOG( "Error : Invalid Argument." );
+        return false;
+    }
+
+    // ヘッダ. バージョン1はモデル名が10バイト, バージョン2は20バイト.
+    if ( size < VMD_HEADER_SIZE || memcmp( pBuffer, "Vocaloid Motion Data ", 21 ) != 0 )
+    {
+        ELOG( "Error : Invalid File Magic." );
+        return false;
+    }
+
+    auto nameSize = ( memcmp( pBuffer + 21, "0002", 4 ) == 0 ) ? 20 : 10;
+    auto offset   = VMD_HEADER_SIZE + nameSize;
+
+    u32 keyCount = 0;
+    if ( size < offset + sizeof(keyCount) )
+    {
+        ELOG( "Error : Unexpected End of File." );
+        return false;
+    }
+
+    memcpy( &keyCount, pBuffer + offset, sizeof(keyCount) );
+    offset += sizeof(keyCount);
+
+    if ( keyCount > ( size - offset ) / sizeof(VMD_BONE_KEY) )
+    {
+        ELOG( "Error : Invalid Bone Key Section. count = %u", keyCount );
+        return false;
+    }
+
+    auto pKeys = pBuffer + offset;
+
+    // ボーン名のハッシュでまとめる. キーはバッファ上のものを番号で参照する.
+    std::vector<BoneGroup>  groups;
+    std::vector<u32>        keyGroups( keyCount );
+    {
+        std::unordered_map<u64, u32> table;
+
+        u64 lastHash  = 0;
+        u32 lastGroup = U32_MAX;
+
+        for( u32 i=0; i<keyCount; ++i )
+        {
+            auto hash = HashName( reinterpret_cast<const char8*>( GetKey( pKeys, i ) ) );
+
+            // 同じボーンのキーが連続していることが多いので直前の結果を使う.
+            if ( hash != lastHash || lastGroup == U32_MAX )
+            {
+                auto itr = table.find( hash );
+                if ( itr == table.end() )
+                {
+                    BoneGroup group = {};
+                    group.Hash     = hash;
+                    group.FirstKey = i;
+
+                    itr = table.emplace( hash, u32( groups.size() ) ).first;
+                    groups.push_back( group );
+                }
+
+                lastHash  = hash;
+                lastGroup = itr->second;
+            }
+
+            keyGroups[i] = lastGroup;
+            groups[lastGroup].Count++;
+        }
+    }
+
+    // グループごとに (フレーム番号, キー番号) を並べてソート.
+    std::vector<u64> order( keyCount );
+    {
+        u32 total = 0;
+        for( auto& group : groups )
+        {
+            group.Offset = total;
+            total += group.Count;
+        }
+
+        std::vector<u32> cursor( groups.size() );
+        for( size_t i=0; i<groups.size(); ++i )
+        { cursor[i] = groups[i].Offset; }
+
+        for( u32 i=0; i<keyCount; ++i )
+        {
+            u32 frame;
+            memcpy( &frame, GetKey( pKeys, i ) + offsetof( VMD_BONE_KEY, Frame ), sizeof(frame) );
+            order[ cursor[ keyGroups[i] ]++ ] = ( u64( frame ) << 32 ) | i;
+        }
+
+        for( const auto& group : groups )
+        { std::sort( order.begin() + group.Offset, order.begin() + group.Offset + group.Count ); }
+    }
+
+    // ボーン名は種類ごとに1度だけ変換して対応付ける.
+    std::vector<u32> boneGroups( boneCount, U32_MAX );
+    {
+        std::unordered_map<std::wstring, u32> names;
+        for( u32 i=0; i<boneCount; ++i )
+        { names.emplace( pBones[i].Name, i ); }
+
+        for( size_t i=0; i<groups.size(); ++i )
+        {
+            auto pName = reinterpret_cast<const char8*>( GetKey( pKeys, groups[i].FirstKey ) );
+            auto itr = names.find( ToWideFromSJIS( pName, VMD_BONE_NAME_SIZE ) );
+            if ( itr != names.end() )
+            { boneGroups[itr->second] = u32( i ); }
+        }
+    }
+
+    // 親ボーンからの相対位置.
+    std::vector<Vector3> bindLocals( boneCount );
+    for( u32 i=0; i<boneCount; ++i )
+    {
+        const auto& bone = pBones[i];
+        bindLocals[i] = Vector3( bone.BindPose._41, bone.BindPose._42, bone.BindPose._43 );
+
+        if ( bone.ParentId != U32_MAX && bone.ParentId < boneCount )
+        {
+            const auto& parent = pBones[bone.ParentId].BindPose;
+            bindLocals[i] -= Vector3( parent._41, parent._42, parent._43 );
+        }
+    }
+
+    // 予算を超えたら許容誤差を上げてやり直す.
+    auto tolerance = option.Tolerance;
+    for( u32 retry=0; retry<MAX_RETRY_COUNT; ++retry )
+    {
+        pResult->Duration = 0;
+        pResult->Bones.resize( boneCount );
+
+        u64  usage  = 0;
+        auto within = true;
+
+        for( u32 i=0; i<boneCount && within; ++i )
+        {
+            auto& dst = pResult->Bones[i];
+            dst.BoneName = pBones[i].Name;
+            dst.KeyFrames.clear();
+
+            auto index = boneGroups[i];
+            if ( index == U32_MAX )
+            {
+                ResKeyFrame key;
+                key.Time      = 0;
+                key.Transform = Matrix::CreateTranslation( bindLocals[i] );
+                dst.KeyFrames.push_back( key );
+            }
+            else
+            {
+                const auto& group = groups[index];
+                ConvertBone(
+                    pKeys,
+                    order.data() + group.Offset,
+                    group.Count,
+                    bindLocals[i],
+                    tolerance,
+                    &dst.KeyFrames );
+            }
+
+            dst.KeyFrames.shrink_to_fit();
+            pResult->Duration = Max( pResult->Duration, dst.KeyFrames.back().Time );
+
+            usage += dst.KeyFrames.size() * sizeof(ResKeyFrame);
+            within = ( option.MemoryBudget == 0 || usage <= option.MemoryBudget );
+        }
+
+        if ( within )
+        {
+            if ( tolerance != option.Tolerance )
+            { ILOG( "Info : Tolerance Raised For Memory Budget. tolerance = %f", tolerance ); }
+            return true;
+        }
+
+        tolerance = ( tolerance > 0.0f ) ? tolerance * 4.0f : 1e-4f;
+    }
+
+    ELOG( "Error : Memory Budget Exceeded. budget = %llu", static_cast<unsigned long long>( option.MemoryBudget ) );
+    pResult->Bones.clear();
+    return false;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      VMDファイルからリソースモーションを読込します.
+//-------------------------------------------------------------------------------------------------
+bool LoadResMotionFromVMD
+(
+    const char16*           filename,
+    const ResBone*          pBones,
+    u32                     boneCount,
+    const VmdConvertOption& option,
+    ResMotion*              pResult
+)
+{
+    if ( filename == nullptr )
+    {
+        ELOG( "Error : Invalid Argument." );
+        return false;
+    }
+
+    MappedFile file;
+    if ( !file.Open( filename ) )
+    {
+        ELOGW( "Error : File Open Failed. filename = %ls", filename );
+        return false;
+    }
+
+    if ( !LoadResMotionFromVMD( file.GetData(), size_t( file.GetSize() ), pBones, boneCount, option, pResult ) )
+    {
+        ELOGW( "Error : Invalid File. filename = %ls", filename );
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace asdx
@@ -0,0 +1,77 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxResVMD.h
+// Desc : Vocaloid Motion Data Format (*.vmd) Loader
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+#pragma once
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxResMesh.h>
+#include <asdxResMotion.h>
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// VmdConvertOption structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct VmdConvertOption
+{
+    f32     Tolerance;      //!< キーフレーム削減の許容誤差です(0 以下の場合は毎フレームのキーを格納します).
+    u64     MemoryBudget;   //!< 出力するキーフレームの最大バイト数です(0 の場合は無制限).
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    VmdConvertOption()
+    : Tolerance     ( 1e-3f )
+    , MemoryBudget  ( 0 )
+    { /* DO_NOTHING */ }
+};
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      メモリ上のVMDデータからリソースモーションを読込します.
+//!
+//! @param[in]      pBuffer         ファイル全体を格納したバッファです.
+//! @param[in]      size            バッファサイズです.
+//! @param[in]      pBones          適用するスケルトンのボーンです.
+//! @param[in]      boneCount       ボーン数です.
+//! @param[in]      option          変換設定です.
+//! @param[out]     pResult         リソースモーションの格納先です.
+//! @retval true    読込に成功.
+//! @retval false   読込に失敗.
+//! @note       キーはバッファから直接読み, ボーン名のハッシュでまとめてからフレーム順にソートします.
+//!             ボーン番号順にキーフレームセットを格納し, キーを持たないボーンにはバインドポーズのキーを1つ格納します.
+//!             補間曲線(ベジェ)を毎フレーム評価し, 線形補間で誤差が許容値以内のキーを削除しながら格納します.
+//!             出力が MemoryBudget を超える場合は許容誤差を4倍にして変換し直します(ソート結果は再利用します).
+//-------------------------------------------------------------------------------------------------
+bool LoadResMotionFromVMD(
+    const u8*               pBuffer,
+    size_t                  size,
+    const ResBone*          pBones,
+    u32                     boneCount,
+    const VmdConvertOption& option,
+    ResMotion*              pResult );
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      VMDファイルからリソースモーションを読込します.
+//!
+//! @param[in]      filename        ファイル名です.
+//! @param[in]      pBones          適用するスケルトンのボーンです.
+//! @param[in]      boneCount       ボーン数です.
+//! @param[in]      option          変換設定です.
+//! @param[out]     pResult         リソースモーションの格納先です.
+//! @retval true    読込に成功.
+//! @retval false   読込に失敗.
+//! @note       ファイルはメモリにマッピングして読み込みます.
+//-------------------------------------------------------------------------------------------------
+bool LoadResMotionFromVMD(
+    const char16*           filename,
+    const ResBone*          pBones,
+    u32                     boneCount,
+    const VmdConvertOption& option,
+    ResMotion*              pResult );
+
+} // namespace asdx
@@ -0,0 +1,603 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : main.cpp
+// Desc : PMD/VMD to MSH/MAT/MTN Converter.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <filesystem>
+#include <asdxLogger.h>
+#include <asdxFile.h>
+#include <formats/asdxResMSH.h>
+#include <formats/asdxResMAT.h>
+#include <formats/asdxResMTN.h>
+#include <formats/asdxResPMD.h>
+#include <formats/asdxResVMD.h>
+#include <asdxMeshSimplifier.h>
+
+
+namespace /* anonymous */ {
+
+namespace fs = std::filesystem;
+
+//-------------------------------------------------------------------------------------------------
+// Constant Values.
+//-------------------------------------------------------------------------------------------------
+static constexpr u32 CONVERTER_VERSION = 0x000002;      //!< 変換結果に影響する変更をしたら更新します.
+static constexpr f32 DEFAULT_TOLERANCE = 1e-3f;         //!< キーフレーム削減の既定の許容誤差です.
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// JOB_TYPE enum
+///////////////////////////////////////////////////////////////////////////////////////////////////
+enum JOB_TYPE
+{
+    JOB_TYPE_MODEL  = 0,    //!< PMD -> MSH + MAT
+    JOB_TYPE_MOTION = 1,    //!< VMD -> MTN
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// JOB_RESULT enum
+///////////////////////////////////////////////////////////////////////////////////////////////////
+enum JOB_RESULT
+{
+    JOB_RESULT_CONVERTED = 0,   //!< 変換しました.
+    JOB_RESULT_SKIPPED,         //!< 出力が最新のためスキップしました.
+    JOB_RESULT_FAILED,          //!< 変換に失敗しました.
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Option structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct Option
+{
+    std::vector<fs::path>   Inputs;         //!< 入力ファイル・ディレクトリです.
+    fs::path                OutputDir;      //!< 出力ディレクトリです(空の場合は入力と同じ場所).
+    fs::path                ModelPath;      //!< モーションを適用するモデルです(空の場合は同じディレクトリのPMD).
+    asdx::VmdConvertOption  Motion;         //!< モーションの変換設定です.
+    std::vector<f32>        LodErrors;      //!< 詳細度ごとの目標誤差です(空の場合は詳細度を生成しない).
+    u32                     ThreadCount;    //!< スレッド数です(0 の場合はハードウェアスレッド数).
+    bool                    Force;          //!< 最新でも変換するかどうか.
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Job structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct Job
+{
+    JOB_TYPE    Type;       //!< 種類です.
+    fs::path    Input;      //!< 入力ファイルです.
+    fs::path    Model;      //!< モーションを適用するモデルです.
+    fs::path    Output;     //!< 出力ファイル(拡張子なし)です.
+    JOB_RESULT  Result;     //!< 結果です.
+};
+
+//-------------------------------------------------------------------------------------------------
+//      使用方法を表示します.
+//-------------------------------------------------------------------------------------------------
+void PrintUsage()
+{
+    printf( "Usage : MMDConverter [options] <file or directory>...\n" );
+    printf( "  *.pmd -> *.msh, *.mat\n" );
+    printf( "  *.vmd -> *.mtn\n" );
+    printf( "Options :\n" );
+    printf( "  -o <dir>     output directory (default: same as input).\n" );
+    printf( "  -m <pmd>     model for motions (default: first *.pmd in the same directory).\n" );
+    printf( "  -t <value>   key reduction tolerance (default: %g, 0: disable).\n", DEFAULT_TOLERANCE );
+    printf( "  -b <MiB>     keyframe memory budget per motion (default: 0, unlimited).\n" );
+    printf( "  -l <e0,e1..> generate mesh LODs with target errors relative to the bounding radius (e.g. 0.005,0.02).\n" );
+    printf( "  -j <count>   thread count (default: hardware concurrency).\n" );
+    printf( "  -f           convert even if outputs are up to date.\n" );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      カンマ区切りの目標誤差を解析します.
+//-------------------------------------------------------------------------------------------------
+bool ParseErrors( const char* value, std::vector<f32>& errors )
+{
+    errors.clear();
+
+    auto ptr = value;
+    while( *ptr != '\0' )
+    {
+        char* end = nullptr;
+        auto error = strtof( ptr, &end );
+        if ( end == ptr || error <= 0.0f )
+        { return false; }
+
+        // GenerateMeshLods() は昇順を前提とする.
+        if ( !errors.empty() && error <= errors.back() )
+        { return false; }
+
+        errors.push_back( error );
+
+        ptr = end;
+        if ( *ptr == ',' )
+        { ptr++; }
+        else if ( *ptr != '\0' )
+        { return false; }
+    }
+
+    return !errors.empty();
+}
+
+//-------------------------------------------------------------------------------------------------
+//      コマンドライン引数を解析します.
+//-------------------------------------------------------------------------------------------------
+bool ParseArgs( int argc, char** argv, Option& option )
+{
+    option.Motion.Tolerance    = DEFAULT_TOLERANCE;
+    option.Motion.MemoryBudget = 0;
+    option.ThreadCount = 0;
+    option.Force       = false;
+
+    for( auto i=1; i<argc; ++i )
+    {
+        auto hasValue = ( i + 1 < argc );
+
+        if ( strcmp( argv[i], "-o" ) == 0 && hasValue )
+        { option.OutputDir = argv[++i]; }
+        else if ( strcmp( argv[i], "-m" ) == 0 && hasValue )
+        { option.ModelPath = argv[++i]; }
+        else if ( strcmp( argv[i], "-t" ) == 0 && hasValue )
+        { option.Motion.Tolerance = f32( atof( argv[++i] ) ); }
+        else if ( strcmp( argv[i], "-b" ) == 0 && hasValue )
+        { option.Motion.MemoryBudget = u64( atof( argv[++i] ) * 1024.0 * 1024.0 ); }
+        else if ( strcmp( argv[i], "-l" ) == 0 && hasValue )
+        {
+            if ( !ParseErrors( argv[++i], option.LodErrors ) )
+            {
+                ELOG( "Error : Invalid LOD Errors. value = %s", argv[i] );
+                return false;
+            }
+        }
+        else if ( strcmp( argv[i], "-j" ) == 0 && hasValue )
+        { option.ThreadCount = u32( atoi( argv[++i] ) ); }
+        else if ( strcmp( argv[i], "-f" ) == 0 )
+        { option.Force = true; }
+        else if ( argv[i][0] == '-' )
+        {
+            ELOG( "Error : Unknown Option. option = %s", argv[i] );
+            return false;
+        }
+        else
+        { option.Inputs.push_back( argv[i] ); }
+    }
+
+    return !option.Inputs.empty();
+}
+
+//-------------------------------------------------------------------------------------------------
+//      拡張子を小文字で取得します.
+//-------------------------------------------------------------------------------------------------
+std::string GetExt( const fs::path& path )
+{
+    auto ext = path.extension().string();
+    std::transform( ext.begin(), ext.end(), ext.begin(),
+        []( char c ) { return char( ( c >= 'A' && c <= 'Z' ) ? c - 'A' + 'a' : c ); } );
+    return ext;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ディレクトリ内で最初のPMDファイルを探します.
+//-------------------------------------------------------------------------------------------------
+fs::path FindModel( const fs::path& dir )
+{
+    std::vector<fs::path> models;
+
+    std::error_code err;
+    for( const auto& entry : fs::directory_iterator( dir, err ) )
+    {
+        if ( entry.is_regular_file() && GetExt( entry.path() ) == ".pmd" )
+        { models.push_back( entry.path() ); }
+    }
+
+    if ( models.empty() )
+    { return fs::path(); }
+
+    std::sort( models.begin(), models.end() );
+    return models.front();
+}
+
+//-------------------------------------------------------------------------------------------------
+//      変換ジョブを追加します.
+//-------------------------------------------------------------------------------------------------
+void AddJob( const Option& option, const fs::path& input, const fs::path& root, std::vector<Job>& jobs )
+{
+    auto ext = GetExt( input );
+    if ( ext != ".pmd" && ext != ".vmd" )
+    { return; }
+
+    Job job;
+    job.Type   = ( ext == ".pmd" ) ? JOB_TYPE_MODEL : JOB_TYPE_MOTION;
+    job.Input  = input;
+    job.Result = JOB_RESULT_FAILED;
+
+    // 出力ディレクトリ指定時は入力ディレクトリからの相対位置を保つ.
+    if ( option.OutputDir.empty() )
+    { job.Output = input; }
+    else if ( root.empty() )
+    { job.Output = option.OutputDir / input.filename(); }
+    else
+    { job.Output = option.OutputDir / fs::relative( input, root ); }
+
+    job.Output.replace_extension();
+
+    if ( job.Type == JOB_TYPE_MOTION )
+    {
+        job.Model = ( option.ModelPath.empty() )
+            ? FindModel( input.parent_path() )
+            : option.ModelPath;
+    }
+
+    jobs.push_back( job );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      変換ジョブを列挙します.
+//-------------------------------------------------------------------------------------------------
+void CollectJobs( const Option& option, std::vector<Job>& jobs )
+{
+    for( const auto& input : option.Inputs )
+    {
+        std::error_code err;
+        if ( fs::is_directory( input, err ) )
+        {
+            std::vector<fs::path> files;
+            for( const auto& entry : fs::recursive_directory_iterator( input, err ) )
+            {
+                if ( entry.is_regular_file() )
+                { files.push_back( entry.path() ); }
+            }
+
+            // 実行ごとに同じ順番になるようにする.
+            std::sort( files.begin(), files.end() );
+
+            for( const auto& file : files )
+            { AddJob( option, file, input, jobs ); }
+        }
+        else
+        { AddJob( option, input, fs::path(), jobs ); }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      出力先が重複していないかチェックします.
+//-------------------------------------------------------------------------------------------------
+bool CheckOutputs( const std::vector<Job>& jobs )
+{
+    // 種類ごとに拡張子が異なるので, 種類と出力先の組で比較する.
+    std::vector<std::pair<std::pair<JOB_TYPE, fs::path>, size_t>> outputs;
+    outputs.reserve( jobs.size() );
+    for( size_t i=0; i<jobs.size(); ++i )
+    { outputs.push_back( std::make_pair( std::make_pair( jobs[i].Type, jobs[i].Output.lexically_normal() ), i ) ); }
+
+    std::sort( outputs.begin(), outputs.end() );
+
+    auto result = true;
+    for( size_t i=1; i<outputs.size(); ++i )
+    {
+        if ( outputs[i].first != outputs[i - 1].first )
+        { continue; }
+
+        ELOG( "Error : Output Collision. input = %s, %s",
+            jobs[ outputs[i - 1].second ].Input.string().c_str(),
+            jobs[ outputs[i].second ].Input.string().c_str() );
+        result = false;
+    }
+
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      FNV-1a でハッシュ値を更新します.
+//-------------------------------------------------------------------------------------------------
+u64 UpdateHash( u64 hash, const void* pData, size_t size )
+{
+    auto ptr = static_cast<const u8*>( pData );
+    for( size_t i=0; i<size; ++i )
+    {
+        hash ^= ptr[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ファイルの内容でハッシュ値を更新します.
+//-------------------------------------------------------------------------------------------------
+bool UpdateHash( u64& hash, const fs::path& path )
+{
+    asdx::MappedFile file;
+    if ( !file.Open( path.wstring().c_str() ) )
+    { return false; }
+
+    auto size = file.GetSize();
+    hash = UpdateHash( hash, &size, sizeof(size) );
+    hash = UpdateHash( hash, file.GetData(), size_t( size ) );
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      入力と変換設定からハッシュ値を求めます.
+//-------------------------------------------------------------------------------------------------
+bool ComputeHash( const Option& option, const Job& job, u64& hash )
+{
+    hash = 0xcbf29ce484222325ull;
+    hash = UpdateHash( hash, &CONVERTER_VERSION, sizeof(CONVERTER_VERSION) );
+    hash = UpdateHash( hash, &job.Type, sizeof(job.Type) );
+
+    if ( !UpdateHash( hash, job.Input ) )
+    { return false; }
+
+    // 詳細度を生成しない場合は以前と同じハッシュ値とする.
+    if ( job.Type == JOB_TYPE_MODEL && !option.LodErrors.empty() )
+    { hash = UpdateHash( hash, option.LodErrors.data(), sizeof(f32) * option.LodErrors.size() ); }
+
+    if ( job.Type == JOB_TYPE_MOTION )
+    {
+        hash = UpdateHash( hash, &option.Motion.Tolerance,    sizeof(option.Motion.Tolerance) );
+        hash = UpdateHash( hash, &option.Motion.MemoryBudget, sizeof(option.Motion.MemoryBudget) );
+        if ( !UpdateHash( hash, job.Model ) )
+        { return false; }
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      出力ファイルのパスを取得します.
+//-------------------------------------------------------------------------------------------------
+std::vector<fs::path> GetOutputs( const Job& job )
+{
+    std::vector<fs::path> result;
+    if ( job.Type == JOB_TYPE_MODEL )
+    {
+        result.push_back( fs::path( job.Output ).concat( ".msh" ) );
+        result.push_back( fs::path( job.Output ).concat( ".mat" ) );
+    }
+    else
+    { result.push_back( fs::path( job.Output ).concat( ".mtn" ) ); }
+
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      出力が最新かどうかチェックします.
+//-------------------------------------------------------------------------------------------------
+bool IsUpToDate( const Job& job, u64 hash )
+{
+    auto outputs = GetOutputs( job );
+    for( const auto& output : outputs )
+    {
+        std::error_code err;
+        if ( !fs::exists( output, err ) )
+        { return false; }
+    }
+
+    auto hashPath = fs::path( outputs.front() ).concat( ".hash" );
+    auto pFile = asdx::FileOpen( hashPath.wstring().c_str(), L"rb" );
+    if ( pFile == nullptr )
+    { return false; }
+
+    u64 value = 0;
+    auto count = fread( &value, sizeof(value), 1, pFile );
+    fclose( pFile );
+
+    return ( count == 1 && value == hash );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ハッシュ値を削除します.
+//-------------------------------------------------------------------------------------------------
+void RemoveHash( const Job& job )
+{
+    std::error_code err;
+    fs::remove( GetOutputs( job ).front().concat( ".hash" ), err );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ハッシュ値を保存します.
+//-------------------------------------------------------------------------------------------------
+void SaveHash( const Job& job, u64 hash )
+{
+    auto hashPath = GetOutputs( job ).front().concat( ".hash" );
+    auto pFile = asdx::FileOpen( hashPath.wstring().c_str(), L"wb" );
+    if ( pFile == nullptr )
+    { return; }
+
+    fwrite( &hash, sizeof(hash), 1, pFile );
+    fclose( pFile );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      モデルを変換します.
+//-------------------------------------------------------------------------------------------------
+bool ConvertModel( const Option& option, const Job& job )
+{
+    asdx::ResMesh     mesh;
+    asdx::ResMaterial material;
+
+    if ( !asdx::LoadResMeshFromPMD( job.Input.wstring().c_str(), &mesh, &material ) )
+    { return false; }
+
+    if ( !option.LodErrors.empty() )
+    {
+        auto count = asdx::GenerateMeshLods(
+            &mesh,
+            option.LodErrors.data(),
+            static_cast<u32>( option.LodErrors.size() ),
+            asdx::SIMPLIFY_FLAG_NONE );
+
+        auto baseCount = static_cast<u32>( mesh.VertexIndices.size() / 3 );
+        for( u32 i=0; i<count; ++i )
+        {
+            const auto& lod = mesh.Lods[i];
+
+            u32 triCount = 0;
+            for( auto j=lod.SubsetOffset; j<lod.SubsetOffset + lod.SubsetCount; ++j )
+            { triCount += mesh.LodSubsets[j].Count / 3; }
+
+            ILOG( "Info : Mesh Lod. input = %s, lod = %u, error = %f, triangles = %u / %u",
+                job.Input.filename().string().c_str(), i + 1, lod.Error, triCount, baseCount );
+        }
+    }
+
+    auto outputs = GetOutputs( job );
+
+    if ( !asdx::SaveResMeshToMSH( outputs[0].wstring().c_str(), &mesh ) )
+    { return false; }
+
+    if ( !asdx::SaveResMaterialToMAT( outputs[1].wstring().c_str(), &material ) )
+    { return false; }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      モーションを変換します.
+//-------------------------------------------------------------------------------------------------
+bool ConvertMotion( const Option& option, const Job& job )
+{
+    // スケルトンのみ使用する.
+    asdx::ResMesh mesh;
+    if ( !asdx::LoadResMeshFromPMD( job.Model.wstring().c_str(), &mesh, nullptr ) )
+    { return false; }
+
+    asdx::ResMotion motion;
+    if ( !asdx::LoadResMotionFromVMD(
+        job.Input.wstring().c_str(),
+        mesh.Bones.data(),
+        u32( mesh.Bones.size() ),
+        option.Motion,
+        &motion ) )
+    { return false; }
+
+    auto outputs = GetOutputs( job );
+    return asdx::SaveResMotionToMTN( outputs[0].wstring().c_str(), &motion );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      変換ジョブを実行します.
+//-------------------------------------------------------------------------------------------------
+JOB_RESULT Execute( const Option& option, const Job& job )
+{
+    if ( job.Type == JOB_TYPE_MOTION && job.Model.empty() )
+    {
+        ELOG( "Error : Model Not Found. motion = %s", job.Input.string().c_str() );
+        return JOB_RESULT_FAILED;
+    }
+
+    u64 hash = 0;
+    if ( !ComputeHash( option, job, hash ) )
+    {
+        ELOG( "Error : File Read Failed. input = %s", job.Input.string().c_str() );
+        return JOB_RESULT_FAILED;
+    }
+
+    if ( !option.Force && IsUpToDate( job, hash ) )
+    { return JOB_RESULT_SKIPPED; }
+
+    // 途中で失敗しても古いハッシュで最新と判定されないように先に削除する.
+    RemoveHash( job );
+
+    std::error_code err;
+    auto dir = job.Output.parent_path();
+    if ( !dir.empty() )
+    { fs::create_directories( dir, err ); }
+
+    auto succeeded = ( job.Type == JOB_TYPE_MODEL )
+        ? ConvertModel( option, job )
+        : ConvertMotion( option, job );
+
+    if ( !succeeded )
+    {
+        ELOG( "Error : Convert Failed. input = %s", job.Input.string().c_str() );
+        return JOB_RESULT_FAILED;
+    }
+
+    // 全ての出力が揃ってからハッシュを書き込む.
+    SaveHash( job, hash );
+    return JOB_RESULT_CONVERTED;
+}
+
+} // namespace /* anonymous */
+
+
+//-------------------------------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-------------------------------------------------------------------------------------------------
+int main( int argc, char** argv )
+{
+    Option option;
+    if ( !ParseArgs( argc, argv, option ) )
+    {
+        PrintUsage();
+        return -1;
+    }
+
+    std::vector<Job> jobs;
+    CollectJobs( option, jobs );
+
+    if ( jobs.empty() )
+    {
+        ELOG( "Error : Input File Not Found." );
+        return -1;
+    }
+
+    if ( !CheckOutputs( jobs ) )
+    { return -1; }
+
+    auto begin = std::chrono::steady_clock::now();
+
+    auto jobCount    = u32( jobs.size() );
+    auto threadCount = ( option.ThreadCount > 0 )
+        ? option.ThreadCount
+        : std::max( std::thread::hardware_concurrency(), 1u );
+    threadCount = std::min( threadCount, jobCount );
+
+    std::atomic<u32> next( 0 );
+
+    auto worker = [&]()
+    {
+        for( auto i = next++; i < jobCount; i = next++ )
+        { jobs[i].Result = Execute( option, jobs[i] ); }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve( threadCount - 1 );
+    for( auto i = 1u; i < threadCount; ++i )
+    { threads.emplace_back( worker ); }
+
+    worker();
+
+    for( auto& thread : threads )
+    { thread.join(); }
+
+    auto end = std::chrono::steady_clock::now();
+    auto msec = std::chrono::duration<double, std::milli>( end - begin ).count();
+
+    u32 counts[3] = {};
+    for( const auto& job : jobs )
+    { counts[job.Result]++; }
+
+    printf( "converted = %u, skipped = %u, failed = %u, threads = %u, time = %.1f ms\n",
+        counts[JOB_RESULT_CONVERTED],
+        counts[JOB_RESULT_SKIPPED],
+        counts[JOB_RESULT_FAILED],
+        threadCount,
+        msec );
+
+    return ( counts[JOB_RESULT_FAILED] > 0 ) ? -1 : 0;
+}
@@ -0,0 +1,72 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : d3d12.h
+// Desc : Minimal Direct3D 12 declarations for building RenderQueue on non-Windows platforms.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+#pragma once
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <cstdint>
+
+
+typedef uint64_t D3D12_GPU_VIRTUAL_ADDRESS;
+
+enum DXGI_FORMAT
+{
+    DXGI_FORMAT_UNKNOWN = 0,
+    DXGI_FORMAT_R32_UINT = 42,
+    DXGI_FORMAT_R16_UINT = 57,
+};
+
+struct D3D12_VERTEX_BUFFER_VIEW
+{
+    D3D12_GPU_VIRTUAL_ADDRESS   BufferLocation;
+    uint32_t                    SizeInBytes;
+    uint32_t                    StrideInBytes;
+};
+
+struct D3D12_INDEX_BUFFER_VIEW
+{
+    D3D12_GPU_VIRTUAL_ADDRESS   BufferLocation;
+    uint32_t                    SizeInBytes;
+    DXGI_FORMAT                 Format;
+};
+
+struct D3D12_GPU_DESCRIPTOR_HANDLE
+{
+    uint64_t    ptr;
+};
+
+struct ID3D12PipelineState
+{
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ID3D12GraphicsCommandList structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct ID3D12GraphicsCommandList
+{
+    //! コマンド発行回数を数えるだけのコマンドリストです.
+    uint32_t    PipelineStateCount      = 0;
+    uint32_t    DescriptorTableCount    = 0;
+    uint32_t    VertexBufferCount       = 0;
+    uint32_t    IndexBufferCount        = 0;
+    uint32_t    DrawCount               = 0;
+
+    void SetPipelineState( ID3D12PipelineState* )
+    { PipelineStateCount++; }
+
+    void SetGraphicsRootDescriptorTable( uint32_t, D3D12_GPU_DESCRIPTOR_HANDLE )
+    { DescriptorTableCount++; }
+
+    void IASetVertexBuffers( uint32_t, uint32_t, const D3D12_VERTEX_BUFFER_VIEW* )
+    { VertexBufferCount++; }
+
+    void IASetIndexBuffer( const D3D12_INDEX_BUFFER_VIEW* )
+    { IndexBufferCount++; }
+
+    void DrawIndexedInstanced( uint32_t, uint32_t, uint32_t, int32_t, uint32_t )
+    { DrawCount++; }
+};
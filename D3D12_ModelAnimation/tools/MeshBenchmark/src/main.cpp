@@ -0,0 +1,527 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : main.cpp
+// Desc : Mesh Simplifier and Render Queue Benchmark.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <map>
+#include <random>
+#include <algorithm>
+#include <asdxMeshSimplifier.h>
+#include <asdxResMesh.h>
+#include <asdxRenderQueue.h>
+#include <formats/asdxResPMD.h>
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------------
+// Constant Values.
+//-------------------------------------------------------------------------------------------------
+static constexpr u32 SPHERE_DIVISION    = 5;        //!< 正二十面体の分割回数です(20480 三角形).
+static constexpr f32 BUMP_HEIGHT        = 0.05f;    //!< 球面の凹凸の高さです.
+
+//! 計測する目標誤差(バウンディング半径に対する比率)です.
+static const f32 TARGET_ERRORS[] = { 0.0005f, 0.001f, 0.002f, 0.005f, 0.01f, 0.02f, 0.05f, 0.1f };
+static const u32 TARGET_ERROR_COUNT = u32( sizeof(TARGET_ERRORS) / sizeof(TARGET_ERRORS[0]) );
+
+static constexpr u32 QUEUE_FRAME_COUNT      = 50;       //!< 描画キューの計測フレーム数です.
+static constexpr u32 QUEUE_PIPELINE_COUNT   = 32;       //!< 描画キューのパイプライン数です.
+static constexpr u32 QUEUE_MATERIAL_COUNT   = 512;      //!< 描画キューのマテリアル数です.
+static constexpr u32 QUEUE_GEOMETRY_COUNT   = 2000;     //!< 描画キューのジオメトリ数です.
+static constexpr u32 QUEUE_PASS_COUNT       = 3;        //!< 描画キューのパス数です.
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Curve structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct Curve
+{
+    u32     TriangleCount;  //!< 簡略化後の三角形数です.
+    f32     Error;          //!< 簡略化で報告された誤差です.
+    f32     MaxDistance;    //!< 元の頂点から簡略化後の面までの最大距離です.
+    f32     AvgDistance;    //!< 元の頂点から簡略化後の面までの平均距離です.
+    f64     Msec;           //!< 簡略化に要した時間です.
+};
+
+//-------------------------------------------------------------------------------------------------
+//      辺の中点の頂点番号を取得します.
+//-------------------------------------------------------------------------------------------------
+u32 GetMidPoint( u32 a, u32 b, std::vector<asdx::Vector3>& positions, std::map<u64, u32>& cache )
+{
+    auto key = ( a < b ) ? ( u64(a) << 32 ) | b : ( u64(b) << 32 ) | a;
+    auto itr = cache.find( key );
+    if ( itr != cache.end() )
+    { return itr->second; }
+
+    auto p = asdx::Vector3::Normalize( ( positions[a] + positions[b] ) * 0.5f );
+    auto index = u32( positions.size() );
+    positions.push_back( p );
+    cache[key] = index;
+    return index;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      凹凸のある球を作成します.
+//-------------------------------------------------------------------------------------------------
+void CreateBumpySphere( asdx::ResMesh& mesh )
+{
+    const f32 t = ( 1.0f + sqrtf( 5.0f ) ) * 0.5f;
+
+    std::vector<asdx::Vector3> positions = {
+        asdx::Vector3( -1,  t,  0 ), asdx::Vector3(  1,  t,  0 ), asdx::Vector3( -1, -t,  0 ), asdx::Vector3(  1, -t,  0 ),
+        asdx::Vector3(  0, -1,  t ), asdx::Vector3(  0,  1,  t ), asdx::Vector3(  0, -1, -t ), asdx::Vector3(  0,  1, -t ),
+        asdx::Vector3(  t,  0, -1 ), asdx::Vector3(  t,  0,  1 ), asdx::Vector3( -t,  0, -1 ), asdx::Vector3( -t,  0,  1 ),
+    };
+    for( auto& p : positions )
+    { p = asdx::Vector3::Normalize( p ); }
+
+    std::vector<u32> indices = {
+        0, 11, 5,   0, 5, 1,    0, 1, 7,    0, 7, 10,   0, 10, 11,
+        1, 5, 9,    5, 11, 4,   11, 10, 2,  10, 7, 6,   7, 1, 8,
+        3, 9, 4,    3, 4, 2,    3, 2, 6,    3, 6, 8,    3, 8, 9,
+        4, 9, 5,    2, 4, 11,   6, 2, 10,   8, 6, 7,    9, 8, 1,
+    };
+
+    for( u32 d=0; d<SPHERE_DIVISION; ++d )
+    {
+        std::map<u64, u32> cache;
+        std::vector<u32> next;
+        next.reserve( indices.size() * 4 );
+        for( size_t i=0; i<indices.size(); i+=3 )
+        {
+            auto a = indices[i + 0];
+            auto b = indices[i + 1];
+            auto c = indices[i + 2];
+            auto ab = GetMidPoint( a, b, positions, cache );
+            auto bc = GetMidPoint( b, c, positions, cache );
+            auto ca = GetMidPoint( c, a, positions, cache );
+            next.insert( next.end(), { a, ab, ca,  b, bc, ab,  c, ca, bc,  ab, bc, ca } );
+        }
+        indices.swap( next );
+    }
+
+    // 低周波の凹凸を加える.
+    auto vertexCount = u32( positions.size() );
+    mesh.Positions  .resize( vertexCount );
+    mesh.Normals    .resize( vertexCount );
+    mesh.TexCoords  .resize( vertexCount );
+    mesh.BoneIndices.resize( vertexCount );
+    mesh.BoneWeights.resize( vertexCount );
+    for( u32 i=0; i<vertexCount; ++i )
+    {
+        const auto& n = positions[i];
+        auto bump = 1.0f + BUMP_HEIGHT * sinf( n.x * 6.0f ) * sinf( n.y * 5.0f ) * sinf( n.z * 4.0f );
+
+        mesh.Positions  [i] = n * bump;
+        mesh.Normals    [i] = n;
+        mesh.TexCoords  [i] = asdx::Vector2( n.x * 0.5f + 0.5f, n.y * 0.5f + 0.5f );
+        mesh.BoneIndices[i] = asdx::uint4( ( n.y < 0.0f ) ? 0 : 1, 0, 0, 0 );
+        mesh.BoneWeights[i] = asdx::Vector4( 1.0f, 0.0f, 0.0f, 0.0f );
+    }
+
+    // 上下の半球を別サブセットとする.
+    mesh.VertexIndices.clear();
+    mesh.Subsets.clear();
+    for( u32 s=0; s<2; ++s )
+    {
+        asdx::ResSubset subset = { s, u32( mesh.VertexIndices.size() ), 0 };
+        for( size_t i=0; i<indices.size(); i+=3 )
+        {
+            auto y = positions[indices[i]].y + positions[indices[i + 1]].y + positions[indices[i + 2]].y;
+            if ( ( y < 0.0f ) != ( s == 0 ) )
+            { continue; }
+
+            mesh.VertexIndices.insert( mesh.VertexIndices.end(), { indices[i], indices[i + 1], indices[i + 2] } );
+            subset.Count += 3;
+        }
+        mesh.Subsets.push_back( subset );
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      点から三角形までの距離の二乗を求めます.
+//-------------------------------------------------------------------------------------------------
+f32 DistanceSqToTriangle( const asdx::Vector3& p, const asdx::Vector3& a, const asdx::Vector3& b, const asdx::Vector3& c )
+{
+    using asdx::Vector3;
+
+    auto ab = b - a;
+    auto ac = c - a;
+    auto ap = p - a;
+    auto d1 = Vector3::Dot( ab, ap );
+    auto d2 = Vector3::Dot( ac, ap );
+    if ( d1 <= 0.0f && d2 <= 0.0f )
+    { return ap.LengthSq(); }
+
+    auto bp = p - b;
+    auto d3 = Vector3::Dot( ab, bp );
+    auto d4 = Vector3::Dot( ac, bp );
+    if ( d3 >= 0.0f && d4 <= d3 )
+    { return bp.LengthSq(); }
+
+    auto vc = d1 * d4 - d3 * d2;
+    if ( vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f )
+    { return ( p - ( a + ab * ( d1 / ( d1 - d3 ) ) ) ).LengthSq(); }
+
+    auto cp = p - c;
+    auto d5 = Vector3::Dot( ab, cp );
+    auto d6 = Vector3::Dot( ac, cp );
+    if ( d6 >= 0.0f && d5 <= d6 )
+    { return cp.LengthSq(); }
+
+    auto vb = d5 * d2 - d1 * d6;
+    if ( vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f )
+    { return ( p - ( a + ac * ( d2 / ( d2 - d6 ) ) ) ).LengthSq(); }
+
+    auto va = d3 * d6 - d5 * d4;
+    if ( va <= 0.0f && ( d4 - d3 ) >= 0.0f && ( d5 - d6 ) >= 0.0f )
+    { return ( p - ( b + ( c - b ) * ( ( d4 - d3 ) / ( ( d4 - d3 ) + ( d5 - d6 ) ) ) ) ).LengthSq(); }
+
+    auto denom = 1.0f / ( va + vb + vc );
+    auto v = vb * denom;
+    auto w = vc * denom;
+    return ( p - ( a + ab * v + ac * w ) ).LengthSq();
+}
+
+//-------------------------------------------------------------------------------------------------
+//      元の頂点から簡略化後の面までの距離を計測します.
+//-------------------------------------------------------------------------------------------------
+void MeasureDistance( const asdx::ResMesh& mesh, const std::vector<u32>& indices, Curve& curve )
+{
+    // 元の三角形から参照されている頂点のみ計測する.
+    std::vector<u8> used( mesh.Positions.size(), 0 );
+    for( auto index : mesh.VertexIndices )
+    { used[index] = 1; }
+
+    f64 sum   = 0.0;
+    f32 maxi  = 0.0f;
+    u32 count = 0;
+    for( size_t i=0; i<mesh.Positions.size(); ++i )
+    {
+        if ( !used[i] )
+        { continue; }
+
+        auto best = F32_MAX;
+        for( size_t j=0; j<indices.size(); j+=3 )
+        {
+            best = asdx::Min( best, DistanceSqToTriangle(
+                mesh.Positions[i],
+                mesh.Positions[indices[j + 0]],
+                mesh.Positions[indices[j + 1]],
+                mesh.Positions[indices[j + 2]] ) );
+        }
+
+        auto dist = sqrtf( best );
+        maxi = asdx::Max( maxi, dist );
+        sum += dist;
+        count++;
+    }
+
+    curve.MaxDistance = maxi;
+    curve.AvgDistance = ( count > 0 ) ? f32( sum / count ) : 0.0f;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      バウンディングボックスの半径を求めます.
+//-------------------------------------------------------------------------------------------------
+f32 GetRadius( const asdx::ResMesh& mesh )
+{
+    auto mini = mesh.Positions[0];
+    auto maxi = mesh.Positions[0];
+    for( const auto& p : mesh.Positions )
+    {
+        mini = asdx::Vector3::Min( mini, p );
+        maxi = asdx::Vector3::Max( maxi, p );
+    }
+    return ( maxi - mini ).Length() * 0.5f;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      目標誤差ごとの誤差と三角形数を計測します.
+//-------------------------------------------------------------------------------------------------
+bool MeasureCurve( const char* name, const asdx::ResMesh& mesh, bool measureDistance )
+{
+    auto radius     = GetRadius( mesh );
+    auto indexCount = u32( mesh.VertexIndices.size() );
+    auto vertexCount = u32( mesh.Positions.size() );
+
+    // サブセット番号をグループとする.
+    std::vector<u32> groups( indexCount / 3, 0 );
+    for( u32 i=0; i<mesh.Subsets.size(); ++i )
+    {
+        for( auto j=mesh.Subsets[i].Offset / 3; j<( mesh.Subsets[i].Offset + mesh.Subsets[i].Count ) / 3; ++j )
+        { groups[j] = i; }
+    }
+
+    printf( "[%s] vertices = %u, triangles = %u, radius = %f\n", name, vertexCount, indexCount / 3, radius );
+    printf( "  target(ratio)  error(ratio)  triangles   ratio    max dist    avg dist    time(ms)\n" );
+
+    auto result = true;
+    auto prevCount = indexCount;
+
+    std::vector<u32> indices( indexCount );
+    for( u32 i=0; i<TARGET_ERROR_COUNT; ++i )
+    {
+        Curve curve = {};
+
+        auto begin = std::chrono::steady_clock::now();
+        auto count = asdx::SimplifyIndices(
+            &mesh,
+            mesh.VertexIndices.data(),
+            groups.data(),
+            indexCount,
+            0,
+            TARGET_ERRORS[i] * radius,
+            asdx::SIMPLIFY_FLAG_NONE,
+            indices.data(),
+            nullptr,
+            &curve.Error );
+        auto end = std::chrono::steady_clock::now();
+
+        curve.TriangleCount = count / 3;
+        curve.Msec = std::chrono::duration<f64, std::milli>( end - begin ).count();
+
+        indices.resize( count );
+        if ( measureDistance )
+        { MeasureDistance( mesh, indices, curve ); }
+
+        printf( "  %12.4f  %12.6f  %9u  %6.3f  %10.6f  %10.6f  %10.2f\n",
+            TARGET_ERRORS[i], curve.Error / radius, curve.TriangleCount,
+            f32( count ) / f32( indexCount ),
+            curve.MaxDistance / radius, curve.AvgDistance / radius, curve.Msec );
+
+        // 報告される誤差は目標誤差以下, 三角形数は目標誤差に対して単調減少となる.
+        for( auto index : indices )
+        {
+            if ( index >= vertexCount )
+            {
+                printf( "  NG : index out of range. index = %u\n", index );
+                result = false;
+                break;
+            }
+        }
+        if ( curve.Error > TARGET_ERRORS[i] * radius * 1.0001f )
+        {
+            printf( "  NG : error exceeds target.\n" );
+            result = false;
+        }
+        if ( count > prevCount )
+        {
+            printf( "  NG : triangle count increased.\n" );
+            result = false;
+        }
+
+        prevCount = count;
+        indices.resize( indexCount );
+    }
+
+    // 変換ツールと同じ設定で詳細度を生成.
+    const f32 lodErrors[] = { 0.002f, 0.01f, 0.05f };
+    asdx::ResMesh lodMesh = mesh;
+    auto lodCount = asdx::GenerateMeshLods( &lodMesh, lodErrors, 3, asdx::SIMPLIFY_FLAG_NONE );
+    printf( "  GenerateMeshLods : lod count = %u", lodCount );
+    for( u32 i=0; i<lodCount; ++i )
+    {
+        const auto& lod = lodMesh.Lods[i];
+        u32 count = 0;
+        for( auto j=lod.SubsetOffset; j<lod.SubsetOffset + lod.SubsetCount; ++j )
+        { count += lodMesh.LodSubsets[j].Count; }
+        printf( ", [%u] triangles = %u error = %f", i + 1, count / 3, lod.Error / radius );
+    }
+    printf( "\n" );
+
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      描画キューのソート時間とバインド回数を計測します.
+//-------------------------------------------------------------------------------------------------
+bool MeasureRenderQueue( u32 itemCount, u32 threadCount )
+{
+    std::mt19937 rng( 12345 );
+
+    asdx::RenderQueue queue;
+    queue.SetThreadCount( threadCount );
+    queue.Reserve( itemCount );
+
+    std::vector<u64> expected;
+    expected.reserve( itemCount );
+
+    f64 sortTime    = 0.0;
+    f64 dedupeTime  = 0.0;
+    f64 stdTime     = 0.0;
+    auto result     = true;
+
+    for( u32 frame=0; frame<QUEUE_FRAME_COUNT; ++frame )
+    {
+        queue.Clear();
+        expected.clear();
+
+        for( u32 i=0; i<itemCount; ++i )
+        {
+            asdx::RenderItem item = {};
+            item.PipelineId     = rng() % QUEUE_PIPELINE_COUNT;
+            item.MaterialId     = rng() % QUEUE_MATERIAL_COUNT;
+            item.GeometryId     = rng() % QUEUE_GEOMETRY_COUNT;
+            item.IndexCount     = 3;
+            item.InstanceCount  = 1;
+
+            auto pass        = rng() % QUEUE_PASS_COUNT;
+            auto translucent = ( rng() % 10 ) == 0;
+            auto depth       = f32( rng() % 10000 ) / 10000.0f;
+            auto key = asdx::MakeRenderKey( pass, translucent, item.PipelineId, item.MaterialId, depth );
+
+            queue.Push( key, item );
+            expected.push_back( key );
+        }
+
+        queue.Sort();
+        sortTime   += queue.GetStatistics().SortTime;
+        dedupeTime += queue.GetStatistics().DedupeTime;
+
+        // 比較対象として std::stable_sort の時間も計測する.
+        auto begin = std::chrono::steady_clock::now();
+        std::stable_sort( expected.begin(), expected.end() );
+        auto end = std::chrono::steady_clock::now();
+        stdTime += std::chrono::duration<f64, std::milli>( end - begin ).count();
+
+        for( u32 i=0; i<itemCount; ++i )
+        {
+            if ( queue.GetKey( i ) != expected[i] )
+            {
+                printf( "  NG : key mismatch. frame = %u, index = %u\n", frame, i );
+                result = false;
+                break;
+            }
+        }
+    }
+
+    // 計数用コマンドリストに発行してバインド回数を確認する.
+    ID3D12PipelineState  pipelineStates[QUEUE_PIPELINE_COUNT];
+    ID3D12PipelineState* ppPipelineStates[QUEUE_PIPELINE_COUNT];
+    for( u32 i=0; i<QUEUE_PIPELINE_COUNT; ++i )
+    { ppPipelineStates[i] = &pipelineStates[i]; }
+
+    std::vector<D3D12_GPU_DESCRIPTOR_HANDLE> materialTables( QUEUE_MATERIAL_COUNT * 2 );
+    std::vector<D3D12_VERTEX_BUFFER_VIEW>    vertexBufferViews( QUEUE_GEOMETRY_COUNT );
+    std::vector<D3D12_INDEX_BUFFER_VIEW>     indexBufferViews ( QUEUE_GEOMETRY_COUNT );
+
+    asdx::RenderStateTable table = {};
+    table.ppPipelineStates      = ppPipelineStates;
+    table.pMaterialTables       = materialTables.data();
+    table.MaterialTableCount    = 2;
+    table.MaterialRootIndex     = 1;
+    table.pVertexBufferViews    = vertexBufferViews.data();
+    table.pIndexBufferViews     = indexBufferViews.data();
+
+    ID3D12GraphicsCommandList commandList;
+    queue.Execute( &commandList, table );
+
+    const auto& stats = queue.GetStatistics();
+    printf( "  %7u  %7s  %10.3f  %10.3f  %10.3f  %6u  %6u  %6u  %6u\n",
+        itemCount, ( threadCount == 1 ) ? "1" : "auto",
+        sortTime   / QUEUE_FRAME_COUNT,
+        dedupeTime / QUEUE_FRAME_COUNT,
+        stdTime    / QUEUE_FRAME_COUNT,
+        stats.DrawCount, stats.PipelineBinds, stats.MaterialBinds, stats.GeometryBinds );
+
+    if ( commandList.DrawCount           != stats.DrawCount
+      || commandList.PipelineStateCount  != stats.PipelineBinds
+      || commandList.VertexBufferCount   != stats.GeometryBinds )
+    {
+        printf( "  NG : statistics do not match issued commands.\n" );
+        result = false;
+    }
+
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      同一キーの要素が投入順を保つかチェックします.
+//-------------------------------------------------------------------------------------------------
+bool CheckRenderQueueStability( u32 itemCount )
+{
+    asdx::RenderQueue queue;
+    queue.Reserve( itemCount );
+
+    for( u32 i=0; i<itemCount; ++i )
+    {
+        asdx::RenderItem item = {};
+        item.GeometryId = i;
+        queue.Push( u64( i % 7 ) << 40, item );
+    }
+    queue.Sort();
+
+    for( u32 i=1; i<queue.GetCount(); ++i )
+    {
+        if ( queue.GetKey( i ) == queue.GetKey( i - 1 )
+          && queue.GetItem( i ).GeometryId < queue.GetItem( i - 1 ).GeometryId )
+        {
+            printf( "  NG : sort is not stable. index = %u\n", i );
+            return false;
+        }
+    }
+
+    printf( "  stable sort : %u items OK\n", itemCount );
+    return true;
+}
+
+} // namespace /* anonymous */
+
+
+//-------------------------------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-------------------------------------------------------------------------------------------------
+int main( int argc, char** argv )
+{
+    auto result = true;
+
+    {
+        asdx::ResMesh mesh;
+        CreateBumpySphere( mesh );
+        result &= MeasureCurve( "bumpy sphere", mesh, true );
+    }
+
+    // 描画キューのソートを計測.
+    {
+        printf( "[render queue] %u frames, %u pipelines, %u materials, %u geometries\n",
+            QUEUE_FRAME_COUNT, QUEUE_PIPELINE_COUNT, QUEUE_MATERIAL_COUNT, QUEUE_GEOMETRY_COUNT );
+        printf( "    items  threads    sort(ms)  dedupe(ms)  stable(ms)   draws     pso     mat     geo\n" );
+
+        const u32 itemCounts[] = { 1000, 100000 };
+        for( auto itemCount : itemCounts )
+        {
+            result &= MeasureRenderQueue( itemCount, 1 );
+            result &= MeasureRenderQueue( itemCount, 0 );
+        }
+        result &= CheckRenderQueueStability( 100000 );
+    }
+
+    // 引数で指定した PMD ファイルも計測する.
+    for( auto i=1; i<argc; ++i )
+    {
+        std::string path( argv[i] );
+
+        asdx::ResMesh mesh;
+        if ( !asdx::LoadResMeshFromPMD( std::wstring( path.begin(), path.end() ).c_str(), &mesh, nullptr ) )
+        {
+            printf( "Error : Load Failed. path = %s\n", argv[i] );
+            result = false;
+            continue;
+        }
+
+        result &= MeasureCurve( argv[i], mesh, false );
+    }
+
+    printf( "%s\n", result ? "OK" : "NG" );
+    return result ? 0 : -1;
+}
@@ -0,0 +1,781 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : main.cpp
+// Desc : Motion Module Benchmark.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+#include <chrono>
+#include <asdxMotionBlender.h>
+#include <asdxMotionDatabase.h>
+#include <asdxMotionPlayer.h>
+#include <asdxIKSolver.h>
+#include <asdxResMesh.h>
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------------
+// Constant Values.
+//-------------------------------------------------------------------------------------------------
+static constexpr u32 BONE_COUNT     = 128;      //!< ボーン数です.
+static constexpr u32 CLIP_COUNT     = 8;        //!< クリップ数(最大レイヤー数)です.
+static constexpr u32 DURATION       = 300;      //!< クリップの長さ(キーフレーム単位)です.
+static constexpr u32 KEY_INTERVAL   = 5;        //!< キーフレームの間隔です.
+static constexpr u32 FRAME_COUNT    = 20000;    //!< 計測する更新回数です.
+static constexpr f32 FRAME_STEP     = 0.5f;     //!< 1回の更新で進める時間です(60fpsで30fpsのモーション).
+static constexpr u32 DB_BONE_COUNT      = 32;       //!< データベース用スケルトンのボーン数です.
+static constexpr u32 DB_MOTION_COUNT    = 20;       //!< データベースに登録するモーション数です.
+static constexpr u32 DB_DURATION        = 4999;     //!< データベースのモーションの長さです(20本で100kフレーム).
+static constexpr u32 DB_QUERY_COUNT     = 10000;    //!< 計測する検索回数です.
+static constexpr u32 IK_CHAIN_COUNT     = 4;        //!< IK計測用スケルトンのチェーン数です(両手足).
+static constexpr u32 IK_POSE_COUNT      = 2000;     //!< IK計測で解く姿勢の数です.
+static constexpr f32 IK_TOLERANCE       = 1e-3f;    //!< IK計測で収束とみなす距離です.
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Random class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class Random
+{
+public:
+    explicit Random( u32 seed )
+    : m_State( seed )
+    { /* DO_NOTHING */ }
+
+    f32 GetAsF32( f32 mini, f32 maxi )
+    {
+        m_State ^= m_State << 13;
+        m_State ^= m_State >> 17;
+        m_State ^= m_State << 5;
+        return mini + ( maxi - mini ) * f32( m_State & 0xFFFFFF ) / f32( 0xFFFFFF );
+    }
+
+private:
+    u32 m_State;
+};
+
+//-------------------------------------------------------------------------------------------------
+//      一本の鎖状のスケルトンを作成します.
+//-------------------------------------------------------------------------------------------------
+void CreateBones( u32 count, std::vector<asdx::ResBone>& bones )
+{
+    bones.resize( count );
+    for( u32 i=0; i<count; ++i )
+    {
+        auto offset = asdx::Vector3( 0.0f, 1.0f, 0.0f );
+
+        bones[i].ParentId    = ( i == 0 ) ? U32_MAX : i - 1;
+        bones[i].BindPose    = asdx::Matrix::CreateTranslation( offset * f32( i ) );
+        bones[i].InvBindPose = asdx::Matrix::CreateTranslation( -offset * f32( i ) );
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ランダムなモーションを作成します.
+//-------------------------------------------------------------------------------------------------
+void CreateMotion( u32 seed, asdx::ResMotion& motion )
+{
+    Random random( seed );
+
+    motion.Duration = DURATION;
+    motion.Bones.resize( BONE_COUNT );
+
+    for( u32 i=0; i<BONE_COUNT; ++i )
+    {
+        auto& keys = motion.Bones[i].KeyFrames;
+        keys.resize( DURATION / KEY_INTERVAL + 1 );
+
+        for( size_t j=0; j<keys.size(); ++j )
+        {
+            auto rotation = asdx::Matrix::CreateRotationFromYawPitchRoll(
+                random.GetAsF32( -0.5f, 0.5f ),
+                random.GetAsF32( -0.5f, 0.5f ),
+                random.GetAsF32( -0.5f, 0.5f ) );
+
+            keys[j].Time      = u32( j ) * KEY_INTERVAL;
+            keys[j].Transform = rotation * asdx::Matrix::CreateTranslation( 0.0f, 1.0f, 0.0f );
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ランダムに向きを変えながら移動するモーションを作成します.
+//-------------------------------------------------------------------------------------------------
+void CreateLocomotion( u32 seed, u32 duration, asdx::ResMotion& motion )
+{
+    Random random( seed );
+
+    motion.Duration = duration;
+    motion.Bones.resize( DB_BONE_COUNT );
+
+    auto keyCount = duration / KEY_INTERVAL + 1;
+
+    // 基準ボーンは向きを変えながら前進する.
+    {
+        auto& keys = motion.Bones[0].KeyFrames;
+        keys.resize( keyCount );
+
+        auto yaw      = 0.0f;
+        auto position = asdx::Vector3( 0.0f, 0.0f, 0.0f );
+        auto speed    = 0.5f;
+        for( u32 j=0; j<keyCount; ++j )
+        {
+            yaw   += random.GetAsF32( -0.3f, 0.3f );
+            speed  = asdx::Clamp( speed + random.GetAsF32( -0.2f, 0.2f ), 0.0f, 1.5f );
+            position += asdx::Vector3( sinf( yaw ), 0.0f, cosf( yaw ) ) * speed;
+
+            keys[j].Time      = j * KEY_INTERVAL;
+            keys[j].Transform = asdx::Matrix::CreateRotationY( yaw ) * asdx::Matrix::CreateTranslation( position );
+        }
+    }
+
+    for( u32 i=1; i<DB_BONE_COUNT; ++i )
+    {
+        auto& keys = motion.Bones[i].KeyFrames;
+        keys.resize( keyCount );
+
+        for( u32 j=0; j<keyCount; ++j )
+        {
+            auto rotation = asdx::Matrix::CreateRotationFromYawPitchRoll(
+                random.GetAsF32( -0.5f, 0.5f ),
+                random.GetAsF32( -0.5f, 0.5f ),
+                random.GetAsF32( -0.5f, 0.5f ) );
+
+            keys[j].Time      = j * KEY_INTERVAL;
+            keys[j].Transform = rotation * asdx::Matrix::CreateTranslation( 0.0f, 1.0f, 0.0f );
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ボーンの回転量の最大変化角(ラジアン)を求めます.
+//-------------------------------------------------------------------------------------------------
+f32 GetMaxDelta( const asdx::BonePose* pPrev, const asdx::BonePose* pCurr )
+{
+    f32 result = 0.0f;
+    for( u32 i=0; i<BONE_COUNT; ++i )
+    {
+        auto dot = fabsf( asdx::Quaternion::Dot( pPrev[i].Rotation, pCurr[i].Rotation ) );
+        result = asdx::Max( result, 2.0f * acosf( asdx::Min( dot, 1.0f ) ) );
+    }
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      有効レイヤー数ごとの更新時間を計測します.
+//-------------------------------------------------------------------------------------------------
+void MeasureLayers( const std::vector<asdx::ResBone>& bones, const asdx::MotionClip* pClips )
+{
+    printf( "layers, usec/update, usec/update/layer\n" );
+
+    for( u32 count=1; count<=CLIP_COUNT; ++count )
+    {
+        asdx::MotionBlender blender;
+        blender.Bind( BONE_COUNT, bones.data(), count );
+
+        // 先頭は上書き, 残りは加算レイヤー.
+        for( u32 i=0; i<count; ++i )
+        {
+            auto mode = ( i == 0 ) ? asdx::BLEND_MODE_OVERRIDE : asdx::BLEND_MODE_ADDITIVE;
+            blender.SetLayer( i, &pClips[i], mode, ( i == 0 ) ? 1.0f : 0.5f );
+            blender.SetLoop( i, true );
+        }
+
+        auto begin = std::chrono::steady_clock::now();
+        for( u32 i=0; i<FRAME_COUNT; ++i )
+        { blender.Update( FRAME_STEP ); }
+        auto end = std::chrono::steady_clock::now();
+
+        auto usec = std::chrono::duration<double, std::micro>( end - begin ).count() / FRAME_COUNT;
+        printf( "%u, %.3f, %.3f\n", count, usec, usec / count );
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ボーン行列の要素の最大誤差を求めます.
+//-------------------------------------------------------------------------------------------------
+f32 GetMaxError( const asdx::Matrix* pLhs, const asdx::Matrix* pRhs, const u8* pMask = nullptr )
+{
+    f32 result = 0.0f;
+    for( u32 i=0; i<BONE_COUNT; ++i )
+    {
+        if ( pMask != nullptr && pMask[i] == 0 )
+        { continue; }
+
+        for( u32 j=0; j<4; ++j )
+        for( u32 k=0; k<4; ++k )
+        { result = asdx::Max( result, fabsf( pLhs[i].m[j][k] - pRhs[i].m[j][k] ) ); }
+    }
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      モーションLODの位相とボーンマスクの切り替えをチェックします.
+//-------------------------------------------------------------------------------------------------
+bool CheckMotionLod( const std::vector<asdx::ResBone>& bones )
+{
+    static constexpr u32 PHASE = 1;
+
+    asdx::ResMotion motion;
+    CreateMotion( 99, motion );
+
+    asdx::MotionPlayer reference;
+    asdx::MotionPlayer player;
+    for( auto pPlayer : { &reference, &player } )
+    {
+        pPlayer->Bind( BONE_COUNT, bones.data() );
+        pPlayer->SetMotion( &motion );
+        pPlayer->SetLoop( false );
+    }
+    player.SetUpdatePhase( PHASE );
+
+    // 担当外のフレームでLODを切り替え, 各区間の最後(次の担当フレームの直前)で毎フレーム更新と一致するか確認する.
+    const asdx::MOTION_LOD lods[] = {
+        asdx::MOTION_LOD_QUARTER,
+        asdx::MOTION_LOD_HALF,
+        asdx::MOTION_LOD_EIGHTH,
+        asdx::MOTION_LOD_QUARTER
+    };
+
+    f32 phaseError = 0.0f;
+    u32 checkCount = 0;
+    for( u32 frame=0; frame<560; ++frame )
+    {
+        if ( frame % 7 == 3 )
+        { player.SetLod( lods[ ( frame / 7 ) % 4 ] ); }
+
+        reference.Update( FRAME_STEP );
+        player   .Update( FRAME_STEP );
+
+        auto interval = 1u << player.GetLod();
+        if ( ( ( frame + 1 + PHASE ) & ( interval - 1 ) ) == 0 )
+        {
+            phaseError = asdx::Max( phaseError, GetMaxError( reference.GetBoneTransforms(), player.GetBoneTransforms() ) );
+            checkCount++;
+        }
+    }
+
+    auto result = ( phaseError <= 1e-4f );
+    printf( "motion lod phase : checked = %u, max error = %g ... %s\n", checkCount, phaseError, ( result ) ? "OK" : "NG" );
+
+    // マスクを切り替えた更新では全ボーンがサンプリングし直され, 以降は有効なボーンだけが追従する.
+    std::vector<u8> maskA( BONE_COUNT, 1 );
+    std::vector<u8> maskB( BONE_COUNT, 1 );
+    for( u32 i=0; i<BONE_COUNT / 2; ++i )
+    {
+        maskA[BONE_COUNT / 2 + i] = 0;
+        maskB[i] = 0;
+    }
+
+    asdx::MotionPlayer unmasked;
+    asdx::MotionPlayer masked;
+    for( auto pPlayer : { &unmasked, &masked } )
+    {
+        pPlayer->Bind( BONE_COUNT, bones.data() );
+        pPlayer->SetMotion( &motion );
+        pPlayer->SetLoop( false );
+    }
+    masked.SetBoneMask( maskA.data() );
+
+    f32 switchError = 0.0f;
+    f32 activeError = 0.0f;
+    for( u32 frame=0; frame<80; ++frame )
+    {
+        if ( frame == 40 )
+        { masked.SetBoneMask( maskB.data() ); }
+
+        unmasked.Update( FRAME_STEP );
+        masked  .Update( FRAME_STEP );
+
+        if ( frame == 40 )
+        { switchError = GetMaxError( unmasked.GetBoneTransforms(), masked.GetBoneTransforms() ); }
+        else if ( frame > 40 )
+        { activeError = asdx::Max( activeError, GetMaxError( unmasked.GetBoneTransforms(), masked.GetBoneTransforms(), maskB.data() ) ); }
+    }
+
+    auto masking = ( switchError <= 1e-4f ) && ( activeError <= 1e-4f );
+    printf( "motion lod mask : switch error = %g, active error = %g ... %s\n", switchError, activeError, ( masking ) ? "OK" : "NG" );
+
+    return result && masking;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      クロスフェードを中断しても姿勢が飛ばないかチェックします.
+//-------------------------------------------------------------------------------------------------
+bool CheckCrossFade( const std::vector<asdx::ResBone>& bones, const asdx::MotionClip* pClips )
+{
+    asdx::MotionBlender blender;
+    blender.Bind( BONE_COUNT, bones.data(), 2 );
+    blender.SetLayer( 0, &pClips[0], asdx::BLEND_MODE_OVERRIDE, 1.0f );
+    blender.SetLoop( 0, true );
+
+    std::vector<asdx::BonePose> prev( BONE_COUNT );
+    f32 maxSteady = 0.0f;
+    f32 maxSwitch = 0.0f;
+
+    for( u32 frame=0; frame<600; ++frame )
+    {
+        // 30フレームかけて切り替え, 完了前に次々と切り替える.
+        auto isSwitch = ( frame >= 60 && frame % 20 == 0 );
+        if ( isSwitch )
+        { blender.CrossFade( &pClips[ ( frame / 20 ) % CLIP_COUNT ], 30.0f ); }
+
+        blender.Update( FRAME_STEP );
+
+        auto pPoses = blender.GetPoses();
+        if ( frame > 0 )
+        {
+            auto delta = GetMaxDelta( prev.data(), pPoses );
+            if ( isSwitch )
+            { maxSwitch = asdx::Max( maxSwitch, delta ); }
+            else
+            { maxSteady = asdx::Max( maxSteady, delta ); }
+        }
+
+        prev.assign( pPoses, pPoses + BONE_COUNT );
+    }
+
+    // 切り替えた瞬間の変化量が通常の更新と同程度であれば姿勢は飛んでいない.
+    auto result = ( maxSwitch <= maxSteady * 1.5f );
+    printf( "crossfade interruption : max delta = %.4f rad (steady %.4f rad) ... %s\n",
+        maxSwitch, maxSteady, ( result ) ? "OK" : "NG" );
+
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      重み0からのフェードインと逆再生をチェックします.
+//-------------------------------------------------------------------------------------------------
+bool CheckLayerControl( const std::vector<asdx::ResBone>& bones, const asdx::MotionClip* pClips )
+{
+    auto result = true;
+
+    // 重み0で設定したレイヤーは有効なままフェードインでき, フェードアウト完了で無効化される.
+    {
+        asdx::MotionBlender blender;
+        blender.Bind( BONE_COUNT, bones.data(), 2 );
+        blender.SetLayer( 0, &pClips[0], asdx::BLEND_MODE_OVERRIDE, 1.0f );
+        blender.SetLayer( 1, &pClips[1], asdx::BLEND_MODE_ADDITIVE, 0.0f );
+        blender.Update( FRAME_STEP );
+        auto idle = blender.GetActiveLayerCount();
+
+        blender.FadeLayer( 1, 1.0f, 10.0f );
+        for( u32 i=0; i<10; ++i )
+        { blender.Update( FRAME_STEP ); }
+        auto fadeIn = blender.GetWeight( 1 );
+
+        blender.FadeLayer( 1, 0.0f, 5.0f );
+        for( u32 i=0; i<20; ++i )
+        { blender.Update( FRAME_STEP ); }
+        auto fadeOut = blender.GetActiveLayerCount();
+
+        auto ok = ( idle == 2 && fadeIn > 0.49f && fadeOut == 1 );
+        printf( "fade in from zero weight : active = %u, weight = %.2f, active after fade out = %u ... %s\n",
+            idle, fadeIn, fadeOut, ( ok ) ? "OK" : "NG" );
+        result &= ok;
+    }
+
+    // 逆再生は同じ時刻を順方向に再生した姿勢と一致し, 先頭でループまたは停止する.
+    // (acosf の精度により同一姿勢でも 1e-3 rad 程度の差が出る).
+    {
+        asdx::MotionBlender forward;
+        asdx::MotionBlender reverse;
+        forward.Bind( BONE_COUNT, bones.data(), 1 );
+        reverse.Bind( BONE_COUNT, bones.data(), 1 );
+        forward.SetLayer( 0, &pClips[0], asdx::BLEND_MODE_OVERRIDE, 1.0f );
+        reverse.SetLayer( 0, &pClips[0], asdx::BLEND_MODE_OVERRIDE, 1.0f );
+        reverse.SetLoop( 0, true );
+        reverse.SetSpeed( 0, -1.0f );
+        reverse.SetFrameTime( 0, 10.0f );
+
+        f32 maxDelta = 0.0f;
+        for( u32 i=0; i<100; ++i )
+        {
+            reverse.Update( FRAME_STEP * 0.7f );
+
+            forward.SetFrameTime( 0, reverse.GetFrameTime( 0 ) );
+            forward.Update( 0.0f );
+            maxDelta = asdx::Max( maxDelta, GetMaxDelta( forward.GetPoses(), reverse.GetPoses() ) );
+        }
+        auto wrapped = reverse.GetFrameTime( 0 );
+
+        reverse.SetLoop( 0, false );
+        reverse.SetFrameTime( 0, 1.0f );
+        reverse.Update( 5.0f );
+        auto clamped = reverse.GetFrameTime( 0 );
+
+        auto ok = ( maxDelta <= 2e-3f && wrapped > 10.0f && wrapped < f32( DURATION ) && clamped == 0.0f );
+        printf( "reverse playback : max delta = %.6f rad, wrapped time = %.2f, clamped time = %.2f ... %s\n",
+            maxDelta, wrapped, clamped, ( ok ) ? "OK" : "NG" );
+        result &= ok;
+    }
+
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      モーションマッチングの検索時間を計測します.
+//-------------------------------------------------------------------------------------------------
+bool MeasureDatabase()
+{
+    std::vector<asdx::ResBone> bones;
+    CreateBones( DB_BONE_COUNT, bones );
+
+    asdx::MotionFeatureDesc desc;
+    desc.RootBone         = 0;
+    desc.FeatureBones     = { 8, 16, 24 };
+    desc.TrajectoryFrames = { 20, 40, 60 };
+
+    asdx::MotionDatabase database;
+    if ( !database.Init( desc, DB_BONE_COUNT, bones.data() ) )
+    {
+        printf( "database : Init() failed ... NG\n" );
+        return false;
+    }
+
+    std::vector<asdx::ResMotion> motions( DB_MOTION_COUNT );
+    for( u32 i=0; i<DB_MOTION_COUNT; ++i )
+    { CreateLocomotion( 5678 + i, DB_DURATION, motions[i] ); }
+
+    auto stride = database.GetFeatureStride();
+    std::vector<f32> query( stride );
+
+    // Build() 前のクエリは全て0になる.
+    {
+        std::vector<asdx::Matrix> identity( DB_BONE_COUNT, asdx::Matrix::CreateIdentity() );
+        std::vector<asdx::Vector3> trajectory( desc.TrajectoryFrames.size(), asdx::Vector3( 0.0f, 0.0f, 1.0f ) );
+        query.assign( stride, 1.0f );
+        database.CreateQuery( identity.data(), identity.data(), trajectory.data(), trajectory.data(), query.data() );
+
+        auto isZero = true;
+        for( u32 d=0; d<stride; ++d )
+        { isZero &= ( query[d] == 0.0f ); }
+
+        printf( "query before Build() : %s\n", ( isZero ) ? "OK" : "NG" );
+        if ( !isZero )
+        { return false; }
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    for( u32 i=0; i<DB_MOTION_COUNT; ++i )
+    { database.AddMotion( motions[i] ); }
+    auto middle = std::chrono::steady_clock::now();
+    database.Build();
+    auto end = std::chrono::steady_clock::now();
+
+    printf( "database : frames = %u, dimension = %u, extract = %.1f msec, build = %.1f msec\n",
+        database.GetEntryCount(),
+        database.GetFeatureDimension(),
+        std::chrono::duration<double, std::milli>( middle - begin ).count(),
+        std::chrono::duration<double, std::milli>( end - middle ).count() );
+
+    // データベースと同じ手順で姿勢と将来軌道をサンプリングし, クエリを作成する.
+    auto trajectoryCount = static_cast<u32>( desc.TrajectoryFrames.size() );
+    auto frameCount      = DB_DURATION + 1;
+    auto queryStep       = ( frameCount * 2 ) / DB_QUERY_COUNT;
+
+    std::vector<f32>                        queries;
+    std::vector<asdx::MotionMatchResult>    expects;
+    queries.reserve( size_t(DB_QUERY_COUNT) * stride );
+
+    Random random( 42 );
+    for( u32 m=0; m<2; ++m )
+    {
+        asdx::MotionPlayer player;
+        player.Bind( DB_BONE_COUNT, bones.data() );
+        player.SetMotion( &motions[m] );
+        player.SetLoop( false );
+
+        std::vector<asdx::Matrix>              roots( frameCount );
+        std::vector<std::vector<asdx::Matrix>> worlds;
+        for( u32 f=0; f<frameCount; ++f )
+        {
+            player.Update( ( f == 0 ) ? 0.0f : 1.0f );
+            roots[f] = player.GetWorldTransforms()[0];
+            if ( f % queryStep == 0 || f % queryStep == queryStep - 1 )
+            { worlds.emplace_back( player.GetWorldTransforms(), player.GetWorldTransforms() + DB_BONE_COUNT ); }
+            else
+            { worlds.emplace_back(); }
+        }
+
+        std::vector<asdx::Vector3> positions ( trajectoryCount );
+        std::vector<asdx::Vector3> directions( trajectoryCount );
+        for( u32 f=queryStep; f<frameCount; f+=queryStep )
+        {
+            // 半分はデータベースと同じ入力, 残り半分は将来軌道にノイズを加える.
+            auto noise = ( ( f / queryStep ) & 0x1 ) ? 1.0f : 0.0f;
+            for( u32 i=0; i<trajectoryCount; ++i )
+            {
+                auto g = asdx::Min( f + desc.TrajectoryFrames[i], frameCount - 1 );
+                positions [i] = asdx::Vector3( roots[g]._41, roots[g]._42, roots[g]._43 )
+                              + asdx::Vector3( random.GetAsF32( -1.0f, 1.0f ), 0.0f, random.GetAsF32( -1.0f, 1.0f ) ) * noise;
+                directions[i] = asdx::Vector3( roots[g]._31, roots[g]._32, roots[g]._33 );
+            }
+
+            auto offset = queries.size();
+            queries.resize( offset + stride );
+            database.CreateQuery( worlds[f].data(), worlds[f - 1].data(), positions.data(), directions.data(), &queries[offset] );
+
+            asdx::MotionMatchResult expect = {};
+            expect.MotionId = m;
+            expect.Frame    = f;
+            expect.Cost     = noise;
+            expects.push_back( expect );
+        }
+    }
+
+    auto queryCount = static_cast<u32>( expects.size() );
+    std::vector<asdx::MotionMatchResult> results( queryCount );
+
+    begin = std::chrono::steady_clock::now();
+    for( u32 i=0; i<queryCount; ++i )
+    { database.Search( &queries[size_t(i) * stride], results[i] ); }
+    end = std::chrono::steady_clock::now();
+
+    // ノイズ無しのクエリは登録したフレーム自身(またはコスト0の同一姿勢)が見つかるはず.
+    u32 exactCount = 0;
+    u32 exactHit   = 0;
+    for( u32 i=0; i<queryCount; ++i )
+    {
+        if ( expects[i].Cost != 0.0f )
+        { continue; }
+
+        exactCount++;
+        if ( ( results[i].MotionId == expects[i].MotionId && results[i].Frame == expects[i].Frame ) || results[i].Cost <= 1e-6f )
+        { exactHit++; }
+    }
+
+    auto usec = std::chrono::duration<double, std::micro>( end - begin ).count() / queryCount;
+    auto result = ( exactHit == exactCount );
+    printf( "search : queries = %u, %.3f usec/query, exact match %u/%u ... %s\n",
+        queryCount, usec, exactHit, exactCount, ( result ) ? "OK" : "NG" );
+
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      行列の平行移動成分を取得します.
+//-------------------------------------------------------------------------------------------------
+asdx::Vector3 GetTranslation( const asdx::Matrix& value )
+{ return asdx::Vector3( value._41, value._42, value._43 ); }
+
+//-------------------------------------------------------------------------------------------------
+//      ルートから放射状にチェーンが伸びるIK計測用スケルトンを作成します.
+//-------------------------------------------------------------------------------------------------
+void CreateIKBones
+(
+    u32                             linkCount,
+    std::vector<asdx::ResBone>&     bones,
+    std::vector<asdx::Matrix>&      locals,
+    std::vector<asdx::IKChain>&     chains
+)
+{
+    // ルート, チェーンごとにリンクとエフェクタ, 最後に目標ボーンを並べる.
+    auto boneCount = 1 + IK_CHAIN_COUNT * ( linkCount + 1 ) + IK_CHAIN_COUNT;
+    bones .resize( boneCount );
+    locals.resize( boneCount );
+    chains.resize( IK_CHAIN_COUNT );
+
+    bones [0].ParentId = U32_MAX;
+    locals[0] = asdx::Matrix::CreateIdentity();
+
+    for( u32 c=0; c<IK_CHAIN_COUNT; ++c )
+    {
+        auto angle  = asdx::F_2PI * f32( c ) / f32( IK_CHAIN_COUNT );
+        auto offset = asdx::Vector3( cosf( angle ), -1.0f, sinf( angle ) ) * 0.5f;
+        auto base   = 1 + c * ( linkCount + 1 );
+
+        auto& chain = chains[c];
+        chain.GoalBone      = 1 + IK_CHAIN_COUNT * ( linkCount + 1 ) + c;
+        chain.EffectorBone  = base + linkCount;
+        chain.LimitAngle    = asdx::F_PI;
+        chain.Links.resize( linkCount );
+
+        for( u32 i=0; i<=linkCount; ++i )
+        {
+            auto bone = base + i;
+            bones [bone].ParentId = ( i == 0 ) ? 0 : bone - 1;
+            locals[bone] = asdx::Matrix::CreateTranslation( ( i == 0 ) ? asdx::Vector3( 0.0f, 0.0f, 0.0f ) : offset );
+        }
+
+        // リンクはエフェクタ側から並べる.
+        for( u32 i=0; i<linkCount; ++i )
+        {
+            auto& link = chain.Links[i];
+            link.BoneIndex  = base + linkCount - 1 - i;
+            link.IsHinge    = false;
+            link.HingeAxis  = asdx::Vector3( 1.0f, 0.0f, 0.0f );
+            link.MinAngle   = 0.0f;
+            link.MaxAngle   = 0.0f;
+        }
+
+        bones [chain.GoalBone].ParentId = 0;
+        locals[chain.GoalBone] = asdx::Matrix::CreateIdentity();
+    }
+
+    // バインドポーズはローカル行列から求める.
+    for( u32 i=0; i<boneCount; ++i )
+    {
+        auto parent = bones[i].ParentId;
+        bones[i].BindPose    = ( parent != U32_MAX ) ? locals[i] * bones[parent].BindPose : locals[i];
+        bones[i].InvBindPose = asdx::Matrix::Invert( bones[i].BindPose );
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      リンク数と反復回数ごとにIKの処理時間を計測します.
+//-------------------------------------------------------------------------------------------------
+bool MeasureIK()
+{
+    printf( "ik : chains = %u, poses = %u, tolerance = %g\n", IK_CHAIN_COUNT, IK_POSE_COUNT, IK_TOLERANCE );
+    printf( "links, iterations, usec/chain, nsec/iteration, iterations/chain, converged\n" );
+
+    const u32 linkCounts[] = { 2, 4, 8 };
+    const u32 iterations[] = { 1, 4, 16, 40 };
+
+    auto result = true;
+
+    for( auto linkCount : linkCounts )
+    {
+        std::vector<asdx::ResBone> bones;
+        std::vector<asdx::Matrix>  locals;
+        std::vector<asdx::IKChain> chains;
+        CreateIKBones( linkCount, bones, locals, chains );
+
+        auto boneCount = static_cast<u32>( bones.size() );
+
+        // 到達可能な範囲にランダムな目標位置を置いた姿勢を作成する.
+        Random random( 7 + linkCount );
+        std::vector<asdx::Matrix> sourceLocals( size_t(IK_POSE_COUNT) * boneCount );
+        for( u32 p=0; p<IK_POSE_COUNT; ++p )
+        {
+            auto pLocals = &sourceLocals[size_t(p) * boneCount];
+            for( u32 i=0; i<boneCount; ++i )
+            { pLocals[i] = locals[i]; }
+
+            for( const auto& chain : chains )
+            {
+                auto base   = GetTranslation( bones[chain.Links.back().BoneIndex].BindPose );
+                auto reach  = asdx::Vector3::Distance( base, GetTranslation( bones[chain.EffectorBone].BindPose ) );
+                auto dir    = asdx::Vector3::Normalize( asdx::Vector3(
+                    random.GetAsF32( -1.0f, 1.0f ),
+                    random.GetAsF32( -1.0f, 0.2f ),
+                    random.GetAsF32( -1.0f, 1.0f ) ) );
+                auto goal   = base + dir * reach * random.GetAsF32( 0.3f, 0.9f );
+                pLocals[chain.GoalBone] = asdx::Matrix::CreateTranslation( goal );
+            }
+        }
+
+        for( auto count : iterations )
+        {
+            for( auto& chain : chains )
+            { chain.Iterations = count; }
+
+            asdx::IKSolver solver;
+            if ( !solver.Init( boneCount, bones.data(), chains.data(), IK_CHAIN_COUNT ) )
+            {
+                printf( "  NG : IKSolver::Init() Failed.\n" );
+                return false;
+            }
+            solver.SetTolerance( IK_TOLERANCE );
+
+            // 計測対象は Solve() のみとし, ワールド行列は事前に求めておく.
+            auto boneTransforms  = sourceLocals;
+            auto worldTransforms = sourceLocals;
+            std::vector<asdx::IKPose> poses( IK_POSE_COUNT );
+            for( u32 p=0; p<IK_POSE_COUNT; ++p )
+            {
+                auto pLocal = &boneTransforms [size_t(p) * boneCount];
+                auto pWorld = &worldTransforms[size_t(p) * boneCount];
+                for( u32 i=0; i<boneCount; ++i )
+                {
+                    auto parent = bones[i].ParentId;
+                    pWorld[i] = ( parent != U32_MAX ) ? pLocal[i] * pWorld[parent] : pLocal[i];
+                }
+
+                poses[p].pBoneTransforms  = pLocal;
+                poses[p].pWorldTransforms = pWorld;
+            }
+
+            asdx::IKStatistics stats;
+            auto begin = std::chrono::steady_clock::now();
+            solver.Solve( poses.data(), IK_POSE_COUNT, &stats );
+            auto end = std::chrono::steady_clock::now();
+
+            auto usec = std::chrono::duration<double, std::micro>( end - begin ).count();
+            printf( "%u, %u, %.3f, %.1f, %.2f, %.1f%%\n",
+                linkCount, count,
+                usec / stats.SolveCount,
+                ( stats.IterationCount > 0 ) ? usec * 1000.0 / stats.IterationCount : 0.0,
+                f64( stats.IterationCount ) / stats.SolveCount,
+                100.0 * stats.ConvergedCount / stats.SolveCount );
+
+            if ( stats.SolveCount != IK_POSE_COUNT * IK_CHAIN_COUNT )
+            {
+                printf( "  NG : solve count mismatch. count = %u\n", stats.SolveCount );
+                result = false;
+            }
+        }
+    }
+
+    // ボーン数の異なるソルバーはプレイヤーに設定できない.
+    {
+        std::vector<asdx::ResBone> bones, otherBones;
+        std::vector<asdx::Matrix>  locals;
+        std::vector<asdx::IKChain> chains, otherChains;
+        CreateIKBones( 2, bones, locals, chains );
+        CreateIKBones( 4, otherBones, locals, otherChains );
+
+        asdx::IKSolver solver;
+        solver.Init( static_cast<u32>( bones.size() ), bones.data(), chains.data(), IK_CHAIN_COUNT );
+
+        asdx::MotionPlayer player;
+        player.Bind( static_cast<u32>( otherBones.size() ), otherBones.data() );
+        auto rejected = !player.SetIKSolver( &solver );
+
+        player.Bind( static_cast<u32>( bones.size() ), bones.data() );
+        auto accepted = player.SetIKSolver( &solver );
+
+        printf( "ik bone count validation ... %s\n", ( rejected && accepted ) ? "OK" : "NG" );
+        result &= ( rejected && accepted );
+    }
+
+    return result;
+}
+
+} // namespace /* anonymous */
+
+
+//-------------------------------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-------------------------------------------------------------------------------------------------
+int main( int, char** )
+{
+    std::vector<asdx::ResBone> bones;
+    CreateBones( BONE_COUNT, bones );
+
+    std::vector<asdx::MotionClip> clips( CLIP_COUNT );
+    for( u32 i=0; i<CLIP_COUNT; ++i )
+    {
+        asdx::ResMotion motion;
+        CreateMotion( 1234 + i, motion );
+        clips[i].Init( motion );
+    }
+
+    printf( "bones = %u, keys/bone = %u, updates = %u\n", BONE_COUNT, DURATION / KEY_INTERVAL + 1, FRAME_COUNT );
+    MeasureLayers( bones, clips.data() );
+
+    auto result = CheckCrossFade( bones, clips.data() );
+    result &= CheckLayerControl( bones, clips.data() );
+    result &= CheckMotionLod( bones );
+    result &= MeasureDatabase();
+    result &= MeasureIK();
+
+    return ( result ) ? 0 : -1;
+}
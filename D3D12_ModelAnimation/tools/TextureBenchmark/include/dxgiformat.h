@@ -0,0 +1,13 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : dxgiformat.h
+// Desc : Minimal DXGI_FORMAT declarations for building the TGA loaders on non-Windows platforms.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+#pragma once
+
+enum DXGI_FORMAT
+{
+    DXGI_FORMAT_UNKNOWN         = 0,
+    DXGI_FORMAT_R8G8B8A8_UNORM  = 28,
+    DXGI_FORMAT_R8_UNORM        = 61,
+};
@@ -0,0 +1,1184 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : main.cpp
+// Desc : Texture Loader Validation And Benchmark.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <sys/stat.h>
+#include <asdxMath.h>
+#include <asdxResTexture.h>
+#include <asdxFile.h>
+#include <formats/asdxResDDS.h>
+#include <formats/asdxResTGA.h>
+
+
+namespace asdx {
+
+//-------------------------------------------------------------------------------------------------
+// このツールは DDS と TGA のみ扱うため, それ以外のローダーは空の実装で置き換えます.
+//-------------------------------------------------------------------------------------------------
+std::wstring GetExt( const char16* filePath )
+{
+    std::wstring path( filePath );
+    auto pos = path.rfind( L'.' );
+    return ( pos == std::wstring::npos ) ? std::wstring() : path.substr( pos + 1 );
+}
+
+bool LoadResTextureFromHDR( const char16*, ResTexture* ) { return false; }
+bool LoadResTextureFromWIC( const char16*, ResTexture* ) { return false; }
+bool LoadResTextureFromTXM( const char16*, ResTexture* ) { return false; }
+
+//-------------------------------------------------------------------------------------------------
+// 比較用の変更前の TGA ローダーです(OldResTGA.cpp).
+//-------------------------------------------------------------------------------------------------
+bool LoadResTextureFromTGA_Old( const char16* filename, ResTexture* pResult );
+
+} // namespace asdx
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------------
+// Constant Values.
+//-------------------------------------------------------------------------------------------------
+static constexpr u32 DDSD_CAPS          = 0x00000001;
+static constexpr u32 DDSD_HEIGHT        = 0x00000002;
+static constexpr u32 DDSD_WIDTH         = 0x00000004;
+static constexpr u32 DDSD_PIXELFORMAT   = 0x00001000;
+static constexpr u32 DDSD_MIPMAPCOUNT   = 0x00020000;
+static constexpr u32 DDSD_DEPTH         = 0x00800000;
+static constexpr u32 DDPF_ALPHA         = 0x00000002;
+static constexpr u32 DDPF_FOURCC        = 0x00000004;
+static constexpr u32 DDPF_RGB           = 0x00000040;
+static constexpr u32 DDPF_LUMINANCE     = 0x00020000;
+static constexpr u32 DDSCAPS_COMPLEX    = 0x00000008;
+static constexpr u32 DDSCAPS_TEXTURE    = 0x00001000;
+static constexpr u32 DDSCAPS_MIPMAP     = 0x00400000;
+static constexpr u32 DDSCAPS2_CUBEMAP   = 0x0000fe00;   // 全ての面を含みます.
+static constexpr u32 DDSCAPS2_VOLUME    = 0x00200000;
+static constexpr u32 DIMENSION_1D       = 2;
+static constexpr u32 DIMENSION_2D       = 3;
+static constexpr u32 DIMENSION_3D       = 4;
+static constexpr u32 MISC_TEXTURECUBE   = 0x4;
+static constexpr u32 BENCH_COUNT        = 5;            //!< 計測の繰り返し回数です.
+static constexpr u32 TGA_PALETTE_COUNT  = 200;          //!< インデックスカラーのパレット数です.
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// TGA_KIND enum
+///////////////////////////////////////////////////////////////////////////////////////////////////
+enum TGA_KIND
+{
+    TGA_KIND_RGB24 = 0,     //!< 24bit フルカラー.
+    TGA_KIND_RGBA32,        //!< 32bit フルカラー.
+    TGA_KIND_RGB16,         //!< 16bit(5:5:5) フルカラー.
+    TGA_KIND_GRAY8,         //!< 8bit 白黒.
+    TGA_KIND_GRAY16,        //!< 8bit 白黒 + 8bit アルファ.
+    TGA_KIND_INDEX8,        //!< 24bit パレットの 8bit インデックスカラー.
+    TGA_KIND_COUNT,
+};
+
+//! TGA_KIND ごとのファイル上のピクセルあたりのバイト数です.
+static const u32 TGA_BYTES_PER_PIXEL[TGA_KIND_COUNT] = { 3, 4, 2, 1, 2, 1 };
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// TgaCase structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct TgaCase
+{
+    std::string     Name;           //!< ファイル名(拡張子なし)です.
+    u32             Kind;           //!< TGA_KIND の値です.
+    u32             Width;          //!< 横幅です.
+    u32             Height;         //!< 縦幅です.
+    bool            TopDown;        //!< 上から下に並んでいるかどうか(ディスクリプタの bit5).
+    bool            RightToLeft;    //!< 右から左に並んでいるかどうか(ディスクリプタの bit4).
+    bool            RLE;            //!< RLE圧縮するかどうか.
+    bool            Footer;         //!< TGA 2.0 のフッターを付けるかどうか.
+    bool            Noisy;          //!< 同じ色が続きにくい画像にするかどうか.
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// FormatInfo structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct FormatInfo
+{
+    u32     Format;         //!< DXGI_FORMAT の値です.
+    u32     BitsPerPixel;   //!< ピクセルあたりのビット数です(ブロック圧縮の場合はブロックあたりのバイト数).
+    u32     Block;          //!< 0:非圧縮, 1:4x4ブロック圧縮, 2:2x1パック.
+};
+
+//! テスト対象のフォーマットです.
+static const FormatInfo FORMATS[] = {
+    {   2, 128, 0 }, {  10,  64, 0 }, {  11,  64, 0 }, {  16,  64, 0 },
+    {  24,  32, 0 }, {  28,  32, 0 }, {  34,  32, 0 }, {  35,  32, 0 },
+    {  41,  32, 0 }, {  87,  32, 0 }, {  88,  32, 0 }, {  49,  16, 0 },
+    {  54,  16, 0 }, {  56,  16, 0 }, {  85,  16, 0 }, {  86,  16, 0 },
+    { 115,  16, 0 }, {  63,   8, 0 }, {  65,   8, 0 },
+    {  68,  32, 2 }, {  69,  32, 2 }, { 107,  32, 2 },
+    {  71,   8, 1 }, {  80,   8, 1 }, {  81,   8, 1 },
+    {  74,  16, 1 }, {  77,  16, 1 }, {  83,  16, 1 }, {  84,  16, 1 },
+    {  95,  16, 1 }, {  96,  16, 1 }, {  98,  16, 1 },
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// LegacyFormat structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct LegacyFormat
+{
+    u32     Flags;          //!< ピクセルフォーマットのフラグです.
+    u32     FourCC;         //!< FourCC です.
+    u32     BitCount;       //!< ビット数です.
+    u32     Mask[4];        //!< RGBA のマスクです.
+    u32     Format;         //!< 期待する DXGI_FORMAT の値です.
+};
+
+//-------------------------------------------------------------------------------------------------
+//      FourCC を生成します.
+//-------------------------------------------------------------------------------------------------
+constexpr u32 MakeFourCC( char a, char b, char c, char d )
+{ return u32(u8(a)) | ( u32(u8(b)) << 8 ) | ( u32(u8(c)) << 16 ) | ( u32(u8(d)) << 24 ); }
+
+//! DX10 拡張ヘッダを使わないピクセルフォーマットです.
+static const LegacyFormat LEGACY_FORMATS[] = {
+    { DDPF_FOURCC, MakeFourCC('D','X','T','1'), 0, { 0, 0, 0, 0 },  71 },
+    { DDPF_FOURCC, MakeFourCC('D','X','T','3'), 0, { 0, 0, 0, 0 },  74 },
+    { DDPF_FOURCC, MakeFourCC('D','X','T','5'), 0, { 0, 0, 0, 0 },  77 },
+    { DDPF_FOURCC, MakeFourCC('A','T','I','1'), 0, { 0, 0, 0, 0 },  80 },
+    { DDPF_FOURCC, MakeFourCC('A','T','I','2'), 0, { 0, 0, 0, 0 },  83 },
+    { DDPF_FOURCC, MakeFourCC('B','C','4','U'), 0, { 0, 0, 0, 0 },  80 },
+    { DDPF_FOURCC, MakeFourCC('B','C','4','S'), 0, { 0, 0, 0, 0 },  81 },
+    { DDPF_FOURCC, MakeFourCC('B','C','5','U'), 0, { 0, 0, 0, 0 },  83 },
+    { DDPF_FOURCC, MakeFourCC('B','C','5','S'), 0, { 0, 0, 0, 0 },  84 },
+    { DDPF_FOURCC, MakeFourCC('R','G','B','G'), 0, { 0, 0, 0, 0 },  68 },
+    { DDPF_FOURCC, MakeFourCC('G','R','G','B'), 0, { 0, 0, 0, 0 },  69 },
+    { DDPF_FOURCC, MakeFourCC('Y','U','Y','2'), 0, { 0, 0, 0, 0 }, 107 },
+    { DDPF_FOURCC,  36, 0, { 0, 0, 0, 0 },  11 },
+    { DDPF_FOURCC, 110, 0, { 0, 0, 0, 0 },  11 },
+    { DDPF_FOURCC, 111, 0, { 0, 0, 0, 0 },  54 },
+    { DDPF_FOURCC, 112, 0, { 0, 0, 0, 0 },  34 },
+    { DDPF_FOURCC, 113, 0, { 0, 0, 0, 0 },  10 },
+    { DDPF_FOURCC, 114, 0, { 0, 0, 0, 0 },  41 },
+    { DDPF_FOURCC, 115, 0, { 0, 0, 0, 0 },  16 },
+    { DDPF_FOURCC, 116, 0, { 0, 0, 0, 0 },   2 },
+    { DDPF_RGB,       0, 32, { 0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000 },  28 },
+    { DDPF_RGB,       0, 32, { 0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000 },  87 },
+    { DDPF_RGB,       0, 32, { 0x00ff0000, 0x0000ff00, 0x000000ff, 0x00000000 },  88 },
+    { DDPF_RGB,       0, 32, { 0x3ff00000, 0x000ffc00, 0x000003ff, 0xc0000000 },  24 },
+    { DDPF_RGB,       0, 32, { 0x0000ffff, 0xffff0000, 0x00000000, 0x00000000 },  35 },
+    { DDPF_RGB,       0, 32, { 0xffffffff, 0x00000000, 0x00000000, 0x00000000 },  41 },
+    { DDPF_RGB,       0, 16, { 0x00007c00, 0x000003e0, 0x0000001f, 0x00008000 },  86 },
+    { DDPF_RGB,       0, 16, { 0x0000f800, 0x000007e0, 0x0000001f, 0x00000000 },  85 },
+    { DDPF_RGB,       0, 16, { 0x00000f00, 0x000000f0, 0x0000000f, 0x0000f000 }, 115 },
+    { DDPF_LUMINANCE, 0,  8, { 0x000000ff, 0x00000000, 0x00000000, 0x00000000 },  63 },
+    { DDPF_LUMINANCE, 0, 16, { 0x0000ffff, 0x00000000, 0x00000000, 0x00000000 },  56 },
+    { DDPF_LUMINANCE, 0, 16, { 0x000000ff, 0x00000000, 0x00000000, 0x0000ff00 },  49 },
+    { DDPF_ALPHA,     0,  8, { 0x00000000, 0x00000000, 0x00000000, 0x000000ff },  65 },
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// TestCase structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct TestCase
+{
+    std::string     Name;           //!< ファイル名です(拡張子を除く).
+    u32             Format;         //!< DXGI_FORMAT の値です.
+    u32             Width;          //!< 横幅です.
+    u32             Height;         //!< 縦幅です.
+    u32             Depth;          //!< 奥行きです(ボリュームテクスチャ以外は1).
+    u32             MipMapCount;    //!< ミップレベル数です.
+    u32             SurfaceCount;   //!< 配列要素数です(キューブマップの場合は面数を含みます).
+    u32             Option;         //!< 期待する RESTEXTURE_OPTION です.
+    u64             DataOffset;     //!< ピクセルデータの先頭オフセットです.
+};
+
+//-------------------------------------------------------------------------------------------------
+//      フォーマット情報を取得します.
+//-------------------------------------------------------------------------------------------------
+const FormatInfo& GetFormatInfo( u32 format )
+{
+    for( const auto& info : FORMATS )
+    {
+        if ( info.Format == format )
+        { return info; }
+    }
+
+    static const FormatInfo kNone = {};
+    return kNone;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      1行あたりのバイト数と行数を求めます.
+//-------------------------------------------------------------------------------------------------
+void GetRowInfo( u32 format, u32 width, u32 height, u64* pRowBytes, u32* pRowCount )
+{
+    const auto& info = GetFormatInfo( format );
+    if ( info.Block == 1 )
+    {
+        *pRowBytes = u64( asdx::Max<u32>( 1, ( width + 3 ) / 4 ) ) * info.BitsPerPixel;
+        *pRowCount = asdx::Max<u32>( 1, ( height + 3 ) / 4 );
+    }
+    else if ( info.Block == 2 )
+    {
+        *pRowBytes = u64( ( width + 1 ) >> 1 ) * 4;
+        *pRowCount = height;
+    }
+    else
+    {
+        *pRowBytes = ( u64( width ) * info.BitsPerPixel + 7 ) / 8;
+        *pRowCount = height;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ピクセルデータのサイズを求めます.
+//-------------------------------------------------------------------------------------------------
+u64 GetDataSize( const TestCase& test )
+{
+    auto volume = ( test.Option & asdx::RESTEXTURE_OPTION_VOLUME ) != 0;
+
+    u64 result = 0;
+    for( u32 a=0; a<test.SurfaceCount; ++a )
+    {
+        for( u32 m=0; m<test.MipMapCount; ++m )
+        {
+            u64 rowBytes = 0;
+            u32 rowCount = 0;
+            GetRowInfo( test.Format, asdx::Max<u32>( test.Width >> m, 1 ), asdx::Max<u32>( test.Height >> m, 1 ), &rowBytes, &rowCount );
+            result += rowBytes * rowCount * ( volume ? asdx::Max<u32>( test.Depth >> m, 1 ) : 1 );
+        }
+    }
+
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      値を追加します.
+//-------------------------------------------------------------------------------------------------
+void Append( std::vector<u8>& buffer, u32 value )
+{
+    for( u32 i=0; i<4; ++i )
+    { buffer.push_back( u8( value >> ( i * 8 ) ) ); }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      DDSヘッダを生成します.
+//-------------------------------------------------------------------------------------------------
+std::vector<u8> CreateHeader
+(
+    u32                     width,
+    u32                     height,
+    u32                     depth,
+    u32                     mipCount,
+    u32                     caps2,
+    const LegacyFormat&     pf
+)
+{
+    std::vector<u8> result;
+    result.reserve( 148 );
+
+    auto flags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT;
+    if ( caps2 & DDSCAPS2_VOLUME )
+    { flags |= DDSD_DEPTH; }
+
+    auto caps = DDSCAPS_TEXTURE;
+    if ( mipCount > 1 || caps2 != 0 )
+    { caps |= DDSCAPS_COMPLEX | DDSCAPS_MIPMAP; }
+
+    Append( result, MakeFourCC('D','D','S',' ') );
+    Append( result, 124 );
+    Append( result, flags );
+    Append( result, height );
+    Append( result, width );
+    Append( result, 0 );
+    Append( result, depth );
+    Append( result, mipCount );
+    for( u32 i=0; i<11; ++i )
+    { Append( result, 0 ); }
+
+    Append( result, 32 );
+    Append( result, pf.Flags );
+    Append( result, pf.FourCC );
+    Append( result, pf.BitCount );
+    for( u32 i=0; i<4; ++i )
+    { Append( result, pf.Mask[i] ); }
+
+    Append( result, caps );
+    Append( result, caps2 );
+    Append( result, 0 );
+    Append( result, 0 );
+    Append( result, 0 );
+
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      DX10 拡張ヘッダ付きのDDSヘッダを生成します.
+//-------------------------------------------------------------------------------------------------
+std::vector<u8> CreateHeaderDX10
+(
+    u32     format,
+    u32     dimension,
+    u32     width,
+    u32     height,
+    u32     depth,
+    u32     mipCount,
+    u32     arraySize,
+    u32     miscFlags
+)
+{
+    LegacyFormat pf = { DDPF_FOURCC, MakeFourCC('D','X','1','0'), 0, { 0, 0, 0, 0 }, format };
+    auto result = CreateHeader( width, height, depth, mipCount, ( dimension == DIMENSION_3D ) ? DDSCAPS2_VOLUME : 0, pf );
+    Append( result, format );
+    Append( result, dimension );
+    Append( result, miscFlags );
+    Append( result, arraySize );
+    Append( result, 0 );
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ファイルを書き出します.
+//-------------------------------------------------------------------------------------------------
+bool WriteTestFile
+(
+    const std::string&      dir,
+    TestCase&               test,
+    const std::vector<u8>&  header,
+    std::mt19937&           random
+)
+{
+    test.DataOffset = header.size();
+
+    std::vector<u8> data( header );
+    data.resize( header.size() + GetDataSize( test ) );
+    for( size_t i=header.size(); i<data.size(); ++i )
+    { data[i] = u8( random() ); }
+
+    auto path = dir + "/" + test.Name + ".dds";
+    auto pFile = fopen( path.c_str(), "wb" );
+    if ( pFile == nullptr )
+    {
+        printf( "Error : File Open Failed. path = %s\n", path.c_str() );
+        return false;
+    }
+
+    fwrite( data.data(), 1, data.size(), pFile );
+    fclose( pFile );
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      テストケースを設定します.
+//-------------------------------------------------------------------------------------------------
+TestCase MakeTest( const std::string& name, u32 format, u32 w, u32 h, u32 d, u32 mips, u32 surfaces, u32 option )
+{
+    TestCase result;
+    result.Name         = name;
+    result.Format       = format;
+    result.Width        = w;
+    result.Height       = h;
+    result.Depth        = d;
+    result.MipMapCount  = mips;
+    result.SurfaceCount = surfaces;
+    result.Option       = option;
+    result.DataOffset   = 0;
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      検証用のファイルを生成します.
+//-------------------------------------------------------------------------------------------------
+bool CreateTestFiles( const std::string& dir, std::vector<TestCase>& tests )
+{
+    std::mt19937 random( 7 );
+    char name[64];
+
+    // 2Dミップ, キューブ, ボリューム, ピッチが256の倍数にならない大きめの2D.
+    for( size_t i=0; i<sizeof(LEGACY_FORMATS) / sizeof(LEGACY_FORMATS[0]); ++i )
+    {
+        const auto& pf = LEGACY_FORMATS[i];
+
+        sprintf( name, "L%02zu_2d", i );
+        tests.push_back( MakeTest( name, pf.Format, 13, 7, 1, 4, 1, asdx::RESTEXTURE_OPTION_NONE ) );
+        if ( !WriteTestFile( dir, tests.back(), CreateHeader( 13, 7, 0, 4, 0, pf ), random ) )
+        { return false; }
+
+        sprintf( name, "L%02zu_cube", i );
+        tests.push_back( MakeTest( name, pf.Format, 8, 8, 1, 4, 6, asdx::RESTEXTURE_OPTION_CUBEMAP ) );
+        if ( !WriteTestFile( dir, tests.back(), CreateHeader( 8, 8, 0, 4, DDSCAPS2_CUBEMAP, pf ), random ) )
+        { return false; }
+
+        sprintf( name, "L%02zu_vol", i );
+        tests.push_back( MakeTest( name, pf.Format, 9, 5, 6, 4, 1, asdx::RESTEXTURE_OPTION_VOLUME ) );
+        if ( !WriteTestFile( dir, tests.back(), CreateHeader( 9, 5, 6, 4, DDSCAPS2_VOLUME, pf ), random ) )
+        { return false; }
+
+        sprintf( name, "L%02zu_big", i );
+        tests.push_back( MakeTest( name, pf.Format, 300, 130, 1, 1, 1, asdx::RESTEXTURE_OPTION_NONE ) );
+        if ( !WriteTestFile( dir, tests.back(), CreateHeader( 300, 130, 0, 1, 0, pf ), random ) )
+        { return false; }
+    }
+
+    // DX10 拡張ヘッダ経由で全フォーマットの配列, キューブ配列, 3D, 1D.
+    for( const auto& info : FORMATS )
+    {
+        auto f = info.Format;
+
+        sprintf( name, "X%03u_arr", f );
+        tests.push_back( MakeTest( name, f, 13, 7, 1, 4, 3, asdx::RESTEXTURE_OPTION_NONE ) );
+        if ( !WriteTestFile( dir, tests.back(), CreateHeaderDX10( f, DIMENSION_2D, 13, 7, 0, 4, 3, 0 ), random ) )
+        { return false; }
+
+        sprintf( name, "X%03u_cube", f );
+        tests.push_back( MakeTest( name, f, 16, 16, 1, 5, 12, asdx::RESTEXTURE_OPTION_CUBEMAP ) );
+        if ( !WriteTestFile( dir, tests.back(), CreateHeaderDX10( f, DIMENSION_2D, 16, 16, 0, 5, 2, MISC_TEXTURECUBE ), random ) )
+        { return false; }
+
+        sprintf( name, "X%03u_3d", f );
+        tests.push_back( MakeTest( name, f, 10, 6, 5, 3, 1, asdx::RESTEXTURE_OPTION_VOLUME ) );
+        if ( !WriteTestFile( dir, tests.back(), CreateHeaderDX10( f, DIMENSION_3D, 10, 6, 5, 3, 1, 0 ), random ) )
+        { return false; }
+
+        sprintf( name, "X%03u_1d", f );
+        tests.push_back( MakeTest( name, f, 37, 1, 1, 6, 1, asdx::RESTEXTURE_OPTION_NONE ) );
+        if ( !WriteTestFile( dir, tests.back(), CreateHeaderDX10( f, DIMENSION_1D, 37, 1, 0, 6, 1, 0 ), random ) )
+        { return false; }
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ファイル名を変換します.
+//-------------------------------------------------------------------------------------------------
+std::wstring ToPath( const std::string& dir, const std::string& name )
+{
+    auto path = dir + "/" + name + ".dds";
+    return std::wstring( path.begin(), path.end() );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ファイル全体を読み込みます.
+//-------------------------------------------------------------------------------------------------
+bool ReadAll( const std::string& dir, const std::string& name, std::vector<u8>& result )
+{
+    auto path  = dir + "/" + name + ".dds";
+    auto pFile = fopen( path.c_str(), "rb" );
+    if ( pFile == nullptr )
+    { return false; }
+
+    fseek( pFile, 0, SEEK_END );
+    result.resize( size_t( ftell( pFile ) ) );
+    fseek( pFile, 0, SEEK_SET );
+    auto size = fread( result.data(), 1, result.size(), pFile );
+    fclose( pFile );
+    return size == result.size();
+}
+
+//-------------------------------------------------------------------------------------------------
+//      リソーステクスチャを解放します.
+//-------------------------------------------------------------------------------------------------
+void Release( asdx::ResTexture& texture )
+{
+    for( u32 i=0; i<texture.SurfaceCount * texture.MipMapCount; ++i )
+    { delete [] texture.pSurfaces[i].pPixels; }
+
+    delete [] texture.pSurfaces;
+    texture.pSurfaces = nullptr;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      1ファイルを検証します.
+//-------------------------------------------------------------------------------------------------
+bool ValidateFile( const std::string& dir, const TestCase& test )
+{
+    std::vector<u8> file;
+    if ( !ReadAll( dir, test.Name, file ) )
+    {
+        printf( "%s : read failed\n", test.Name.c_str() );
+        return false;
+    }
+
+    auto path = ToPath( dir, test.Name );
+
+    asdx::ResTexture     texture;
+    asdx::MappedFile     mapped;
+    asdx::ResTextureView view;
+    auto loaded = asdx::LoadResTextureFromDDS( path.c_str(), &texture );
+    auto viewed = asdx::MapResTextureFromDDS( path.c_str(), &mapped, &view );
+    if ( !loaded || !viewed )
+    {
+        printf( "%s : load = %d, map = %d\n", test.Name.c_str(), loaded, viewed );
+        if ( loaded )
+        { Release( texture ); }
+        return false;
+    }
+
+    auto volume = ( test.Option & asdx::RESTEXTURE_OPTION_VOLUME ) != 0;
+    auto count  = test.SurfaceCount * test.MipMapCount;
+
+    std::string error;
+    auto Check = [&]( bool condition, const char* message )
+    {
+        if ( !condition && error.empty() )
+        { error = message; }
+    };
+
+    Check( texture.Width  == test.Width  && view.Width  == test.Width,  "width" );
+    Check( texture.Height == test.Height && view.Height == test.Height, "height" );
+    Check( texture.Format == test.Format && view.Format == test.Format, "format" );
+    Check( texture.MipMapCount  == test.MipMapCount  && view.MipMapCount  == test.MipMapCount,  "mip count" );
+    Check( texture.SurfaceCount == test.SurfaceCount && view.SurfaceCount == test.SurfaceCount, "surface count" );
+    Check( texture.Option == test.Option && view.Option == test.Option, "option" );
+    Check( view.Surfaces.size() == count && view.Footprints.size() == count, "view size" );
+
+    u64 offset   = test.DataOffset;
+    u64 placed   = 0;
+    u64 expected = 0;
+    for( u32 a=0; error.empty() && a<test.SurfaceCount; ++a )
+    {
+        for( u32 m=0; error.empty() && m<test.MipMapCount; ++m )
+        {
+            auto idx   = a * test.MipMapCount + m;
+            auto w     = asdx::Max<u32>( test.Width  >> m, 1 );
+            auto h     = asdx::Max<u32>( test.Height >> m, 1 );
+            auto depth = ( volume ) ? asdx::Max<u32>( test.Depth >> m, 1 ) : 1;
+
+            u64 rowBytes = 0;
+            u32 rowCount = 0;
+            GetRowInfo( test.Format, w, h, &rowBytes, &rowCount );
+            auto slicePitch = rowBytes * rowCount;
+
+            const auto& copied  = texture.pSurfaces[idx];
+            const auto& mapping = view.Surfaces[idx];
+            const auto& fp      = view.Footprints[idx];
+
+            // サーフェイスはファイル上の配置と一致する.
+            Check( copied .Width == w && copied .Height == h && copied .RowPitch == rowBytes && copied .SlicePitch == slicePitch, "copied surface" );
+            Check( mapping.Width == w && mapping.Height == h && mapping.RowPitch == rowBytes && mapping.SlicePitch == slicePitch, "mapped surface" );
+            Check( offset + slicePitch * depth <= file.size(), "file size" );
+            if ( !error.empty() )
+            { break; }
+
+            Check( memcmp( copied .pPixels, &file[offset], size_t( slicePitch * depth ) ) == 0, "copied pixels" );
+            Check( memcmp( mapping.pPixels, &file[offset], size_t( slicePitch * depth ) ) == 0, "mapped pixels" );
+
+            // フットプリントは GetCopyableFootprints() と同じ規則.
+            const auto& info = GetFormatInfo( test.Format );
+            auto bw = ( info.Block == 1 ) ? 4u : ( info.Block == 2 ) ? 2u : 1u;
+            auto bh = ( info.Block == 1 ) ? 4u : 1u;
+            auto rowPitch = ( rowBytes + 255 ) & ~u64( 255 );
+            placed = ( placed + 511 ) & ~u64( 511 );
+            Check( fp.Offset == placed, "footprint offset" );
+            Check( fp.Width  == ( w + bw - 1 ) / bw * bw && fp.Height == ( h + bh - 1 ) / bh * bh && fp.Depth == depth, "footprint size" );
+            Check( fp.RowPitch == rowPitch && fp.RowCount == rowCount && fp.RowSize == rowBytes, "footprint pitch" );
+
+            expected = placed + rowPitch * ( u64( rowCount ) * depth - 1 ) + rowBytes;
+            placed  += rowPitch * rowCount * depth;
+            offset  += slicePitch * depth;
+        }
+    }
+
+    Check( error.empty() == false || view.StagingSize == expected, "staging size" );
+
+    // ステージングバッファへの書き込み結果を確認.
+    if ( error.empty() )
+    {
+        static constexpr u8 GUARD = 0xcd;
+        std::vector<u8> staging( size_t( view.StagingSize ) + 64, GUARD );
+        asdx::WriteToStagingBuffer( view, staging.data() );
+
+        for( u32 i=0; error.empty() && i<count; ++i )
+        {
+            const auto& surface = view.Surfaces[i];
+            const auto& fp      = view.Footprints[i];
+            for( u32 z=0; z<fp.Depth; ++z )
+            {
+                for( u32 y=0; y<fp.RowCount; ++y )
+                {
+                    auto pDst = &staging[ size_t( fp.Offset + u64( fp.RowPitch ) * ( u64( fp.RowCount ) * z + y ) ) ];
+                    auto pSrc = surface.pPixels + size_t( surface.SlicePitch ) * z + size_t( surface.RowPitch ) * y;
+                    Check( memcmp( pDst, pSrc, fp.RowSize ) == 0, "staging pixels" );
+                }
+            }
+        }
+
+        for( size_t i=size_t( view.StagingSize ); i<staging.size(); ++i )
+        { Check( staging[i] == GUARD, "staging overrun" ); }
+    }
+
+    Release( texture );
+
+    if ( !error.empty() )
+    {
+        printf( "%s : %s mismatch\n", test.Name.c_str(), error.c_str() );
+        return false;
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      不正なヘッダが拒否されることを確認します.
+//-------------------------------------------------------------------------------------------------
+bool CheckInvalidHeaders( const std::string& dir )
+{
+    struct InvalidCase
+    {
+        const char*     Name;
+        std::vector<u8> Data;
+    };
+
+    LegacyFormat rgba = LEGACY_FORMATS[20];
+    std::vector<InvalidCase> cases;
+
+    // 巨大なサイズ(65536x65536 RGBA32F).
+    cases.push_back( { "bad_huge", CreateHeaderDX10( 2, DIMENSION_2D, 65536, 65536, 0, 1, 1, 0 ) } );
+
+    // 配列数が上限を超える.
+    cases.push_back( { "bad_array", CreateHeaderDX10( 28, DIMENSION_2D, 1, 1, 0, 1, 0xffffffff, 0 ) } );
+
+    // ピクセルデータが足りない.
+    cases.push_back( { "bad_short", CreateHeader( 64, 64, 0, 1, 0, rgba ) } );
+    cases.back().Data.resize( cases.back().Data.size() + 64 );
+
+    // ヘッダが途中で切れている.
+    cases.push_back( { "bad_header", CreateHeader( 4, 4, 0, 1, 0, rgba ) } );
+    cases.back().Data.resize( 64 );
+
+    auto result = true;
+    for( auto& item : cases )
+    {
+        auto path = dir + "/" + item.Name + ".dds";
+        auto pFile = fopen( path.c_str(), "wb" );
+        if ( pFile == nullptr )
+        { return false; }
+        fwrite( item.Data.data(), 1, item.Data.size(), pFile );
+        fclose( pFile );
+
+        auto wpath = ToPath( dir, item.Name );
+
+        asdx::ResTexture     texture;
+        asdx::MappedFile     mapped;
+        asdx::ResTextureView view;
+        auto loaded = asdx::LoadResTextureFromDDS( wpath.c_str(), &texture );
+        auto viewed = asdx::MapResTextureFromDDS( wpath.c_str(), &mapped, &view );
+        if ( loaded )
+        { Release( texture ); }
+
+        if ( loaded || viewed )
+        {
+            printf( "%s : accepted (load = %d, map = %d)\n", item.Name, loaded, viewed );
+            result = false;
+        }
+    }
+
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      読み込みからステージングバッファへの書き込みまでを計測します.
+//-------------------------------------------------------------------------------------------------
+void MeasureUpload( const std::string& dir, const TestCase& test )
+{
+    auto path = ToPath( dir, test.Name );
+
+    f64 copyMsec = 0.0;
+    f64 mapMsec  = 0.0;
+    u64 size     = 0;
+
+    for( u32 k=0; k<BENCH_COUNT; ++k )
+    {
+        // コピーしたサーフェイスから UpdateSubresources と同じ配置で書き込む.
+        auto begin = std::chrono::steady_clock::now();
+        {
+            asdx::ResTexture texture;
+            asdx::LoadResTextureFromDDS( path.c_str(), &texture );
+
+            asdx::MappedFile     mapped;
+            asdx::ResTextureView view;
+            asdx::MapResTextureFromDDS( path.c_str(), &mapped, &view );
+
+            std::vector<u8> staging( size_t( view.StagingSize ) );
+            for( size_t i=0; i<view.Footprints.size(); ++i )
+            {
+                const auto& surface = texture.pSurfaces[i];
+                const auto& fp      = view.Footprints[i];
+                for( u32 z=0; z<fp.Depth; ++z )
+                {
+                    for( u32 y=0; y<fp.RowCount; ++y )
+                    {
+                        memcpy( &staging[ size_t( fp.Offset + u64( fp.RowPitch ) * ( u64( fp.RowCount ) * z + y ) ) ],
+                            surface.pPixels + size_t( surface.SlicePitch ) * z + size_t( surface.RowPitch ) * y,
+                            fp.RowSize );
+                    }
+                }
+            }
+            Release( texture );
+        }
+        auto middle = std::chrono::steady_clock::now();
+        {
+            asdx::MappedFile     mapped;
+            asdx::ResTextureView view;
+            asdx::MapResTextureFromDDS( path.c_str(), &mapped, &view );
+
+            std::vector<u8> staging( size_t( view.StagingSize ) );
+            asdx::WriteToStagingBuffer( view, staging.data() );
+            size = view.StagingSize;
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        copyMsec += std::chrono::duration<f64, std::milli>( middle - begin ).count();
+        mapMsec  += std::chrono::duration<f64, std::milli>( end - middle ).count();
+    }
+
+    printf( "%-18s : staging %6.1f MB, copy %7.2f ms, map %7.2f ms\n",
+        test.Name.c_str(), f64( size ) / ( 1024.0 * 1024.0 ), copyMsec / BENCH_COUNT, mapMsec / BENCH_COUNT );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      DDS の検証と計測を行います.
+//-------------------------------------------------------------------------------------------------
+bool RunDDS( const std::string& dir )
+{
+    std::vector<TestCase> tests;
+    if ( !CreateTestFiles( dir, tests ) )
+    { return false; }
+
+    u32 failed = 0;
+    for( const auto& test : tests )
+    {
+        if ( !ValidateFile( dir, test ) )
+        { failed++; }
+    }
+
+    auto result = ( failed == 0 );
+    printf( "dds : files = %zu, failed = %u ... %s\n", tests.size(), failed, ( result ) ? "OK" : "NG" );
+
+    auto rejected = CheckInvalidHeaders( dir );
+    printf( "dds : invalid headers ... %s\n", ( rejected ) ? "OK" : "NG" );
+    result &= rejected;
+
+    // 大きなテクスチャで読み込み時間を計測.
+    std::vector<TestCase> bench;
+    std::mt19937 random( 11 );
+    bench.push_back( MakeTest( "bench_bc7_4k", 98, 4096, 4096, 1, 13, 1, asdx::RESTEXTURE_OPTION_NONE ) );
+    bench.push_back( MakeTest( "bench_rgba8_4k", 28, 4096, 4096, 1, 13, 1, asdx::RESTEXTURE_OPTION_NONE ) );
+    bench.push_back( MakeTest( "bench_rgba16f_cube", 10, 1024, 1024, 1, 11, 6, asdx::RESTEXTURE_OPTION_CUBEMAP ) );
+
+    for( auto& test : bench )
+    {
+        auto misc = ( test.Option & asdx::RESTEXTURE_OPTION_CUBEMAP ) ? MISC_TEXTURECUBE : 0;
+        auto size = ( misc != 0 ) ? test.SurfaceCount / 6 : test.SurfaceCount;
+        auto header = CreateHeaderDX10( test.Format, DIMENSION_2D, test.Width, test.Height, 0, test.MipMapCount, size, misc );
+        if ( !WriteTestFile( dir, test, header, random ) )
+        { return false; }
+
+        MeasureUpload( dir, test );
+    }
+
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      TGA のテストケースを設定します.
+//-------------------------------------------------------------------------------------------------
+TgaCase MakeTgaCase( const std::string& name, u32 kind, u32 w, u32 h, bool topDown, bool rle, bool rightToLeft, bool footer, bool noisy )
+{
+    TgaCase result;
+    result.Name         = name;
+    result.Kind         = kind;
+    result.Width        = w;
+    result.Height       = h;
+    result.TopDown      = topDown;
+    result.RightToLeft  = rightToLeft;
+    result.RLE          = rle;
+    result.Footer       = footer;
+    result.Noisy        = noisy;
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      TGA のピクセルを RLE 圧縮します.
+//-------------------------------------------------------------------------------------------------
+void EncodeRLE( const std::vector<u8>& pixels, u32 bpp, std::vector<u8>& result )
+{
+    auto count = pixels.size() / bpp;
+    auto equal = [&]( size_t a, size_t b )
+    { return memcmp( &pixels[a * bpp], &pixels[b * bpp], bpp ) == 0; };
+
+    size_t i = 0;
+    while( i < count )
+    {
+        // 同じ色が続く場合は繰り返しパケット.
+        auto j = i;
+        while( j + 1 < count && equal( j + 1, i ) && j - i < 127 )
+        { j++; }
+
+        if ( j > i )
+        {
+            result.push_back( u8( 0x80 | ( j - i ) ) );
+            result.insert( result.end(), &pixels[i * bpp], &pixels[i * bpp] + bpp );
+            i = j + 1;
+            continue;
+        }
+
+        // 異なる色が続く間は生パケット.
+        while( j + 1 < count && !equal( j + 1, j ) && j - i < 127 )
+        { j++; }
+
+        result.push_back( u8( j - i ) );
+        result.insert( result.end(), &pixels[i * bpp], &pixels[( j + 1 ) * bpp] );
+        i = j + 1;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      TGA ファイルを生成し, 左上原点の期待値を求めます.
+//-------------------------------------------------------------------------------------------------
+bool WriteTgaFile( const std::string& dir, const TgaCase& test, std::mt19937& random, std::vector<u8>& expected )
+{
+    static const u32 RUNS[]       = { 1, 1, 2, 3, 5, 20, 200 };
+    static const u32 NOISY_RUNS[] = { 1, 1, 1, 2 };
+
+    auto bpp   = TGA_BYTES_PER_PIXEL[test.Kind];
+    auto count = size_t( test.Width ) * test.Height;
+
+    // インデックスカラーのパレット(BGR).
+    std::vector<u8> palette;
+    if ( test.Kind == TGA_KIND_INDEX8 )
+    {
+        palette.resize( TGA_PALETTE_COUNT * 3 );
+        for( auto& value : palette )
+        { value = u8( random() ); }
+    }
+
+    // 表示順(左上原点)のピクセルを, 同じ色が適度に続くように生成する.
+    std::vector<u8> pixels( count * bpp );
+    for( size_t i=0; i<count; )
+    {
+        u8 value[4];
+        for( u32 c=0; c<bpp; ++c )
+        { value[c] = u8( random() ); }
+        if ( test.Kind == TGA_KIND_INDEX8 )
+        { value[0] = u8( random() % TGA_PALETTE_COUNT ); }
+
+        auto run = ( test.Noisy )
+            ? NOISY_RUNS[ random() % ( sizeof(NOISY_RUNS) / sizeof(NOISY_RUNS[0]) ) ]
+            : RUNS      [ random() % ( sizeof(RUNS)       / sizeof(RUNS[0]) ) ];
+        for( u32 k=0; k<run && i<count; ++k, ++i )
+        { memcpy( &pixels[i * bpp], value, bpp ); }
+    }
+
+    // 期待値は白黒 8bit のみ R8, それ以外は RGBA8.
+    auto outBpp = ( test.Kind == TGA_KIND_GRAY8 ) ? 1u : 4u;
+    expected.resize( count * outBpp );
+    for( size_t i=0; i<count; ++i )
+    {
+        auto pSrc = &pixels  [i * bpp];
+        auto pDst = &expected[i * outBpp];
+        switch( test.Kind )
+        {
+        case TGA_KIND_RGB24:
+            pDst[0] = pSrc[2]; pDst[1] = pSrc[1]; pDst[2] = pSrc[0]; pDst[3] = 255;
+            break;
+
+        case TGA_KIND_RGBA32:
+            pDst[0] = pSrc[2]; pDst[1] = pSrc[1]; pDst[2] = pSrc[0]; pDst[3] = pSrc[3];
+            break;
+
+        case TGA_KIND_RGB16:
+            {
+                auto c = u32( pSrc[0] ) | ( u32( pSrc[1] ) << 8 );
+                pDst[0] = u8( ( ( c >> 10 ) & 0x1f ) << 3 );
+                pDst[1] = u8( ( ( c >>  5 ) & 0x1f ) << 3 );
+                pDst[2] = u8( ( ( c       ) & 0x1f ) << 3 );
+                pDst[3] = 255;
+            }
+            break;
+
+        case TGA_KIND_GRAY8:
+            pDst[0] = pSrc[0];
+            break;
+
+        case TGA_KIND_GRAY16:
+            pDst[0] = pSrc[0]; pDst[1] = pSrc[0]; pDst[2] = pSrc[0]; pDst[3] = pSrc[1];
+            break;
+
+        case TGA_KIND_INDEX8:
+            {
+                auto pColor = &palette[ pSrc[0] * 3 ];
+                pDst[0] = pColor[2]; pDst[1] = pColor[1]; pDst[2] = pColor[0]; pDst[3] = 255;
+            }
+            break;
+        }
+    }
+
+    // ファイル上の並びに入れ替える.
+    auto rowSize = size_t( test.Width ) * bpp;
+    std::vector<u8> ordered( pixels.size() );
+    for( u32 y=0; y<test.Height; ++y )
+    {
+        auto srcY = ( test.TopDown ) ? y : test.Height - 1 - y;
+        for( u32 x=0; x<test.Width; ++x )
+        {
+            auto srcX = ( test.RightToLeft ) ? test.Width - 1 - x : x;
+            memcpy( &ordered[ y * rowSize + x * bpp ], &pixels[ srcY * rowSize + srcX * bpp ], bpp );
+        }
+    }
+
+    static const u8 IMAGE_TYPES[TGA_KIND_COUNT] = { 2, 2, 2, 3, 3, 1 };
+    auto paletteCount = u32( palette.size() / 3 );
+    auto descriptor   = u8( ( test.TopDown ? 0x20 : 0 ) | ( test.RightToLeft ? 0x10 : 0 ) );
+
+    // ヘッダ(18 byte)と ID フィールド.
+    std::vector<u8> data = {
+        3,
+        u8( palette.empty() ? 0 : 1 ),
+        u8( IMAGE_TYPES[test.Kind] + ( test.RLE ? 8 : 0 ) ),
+        0, 0,
+        u8( paletteCount & 0xff ), u8( paletteCount >> 8 ),
+        u8( palette.empty() ? 0 : 24 ),
+        0, 0, 0, 0,
+        u8( test.Width  & 0xff ), u8( test.Width  >> 8 ),
+        u8( test.Height & 0xff ), u8( test.Height >> 8 ),
+        u8( bpp * 8 ),
+        descriptor,
+        'a', 'b', 'c',
+    };
+    data.insert( data.end(), palette.begin(), palette.end() );
+
+    if ( test.RLE )
+    { EncodeRLE( ordered, bpp, data ); }
+    else
+    { data.insert( data.end(), ordered.begin(), ordered.end() ); }
+
+    if ( test.Footer )
+    {
+        static const char SIGNATURE[] = "TRUEVISION-XFILE.";
+        data.insert( data.end(), 8, 0 );
+        data.insert( data.end(), SIGNATURE, SIGNATURE + sizeof(SIGNATURE) );
+    }
+
+    auto path  = dir + "/" + test.Name + ".tga";
+    auto pFile = fopen( path.c_str(), "wb" );
+    if ( pFile == nullptr )
+    {
+        printf( "Error : File Open Failed. path = %s\n", path.c_str() );
+        return false;
+    }
+
+    fwrite( data.data(), 1, data.size(), pFile );
+    fclose( pFile );
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      TGA のファイル名を変換します.
+//-------------------------------------------------------------------------------------------------
+std::wstring ToTgaPath( const std::string& dir, const std::string& name )
+{
+    auto path = dir + "/" + name + ".tga";
+    return std::wstring( path.begin(), path.end() );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      TGA の読み込み結果を期待値と比較します.
+//-------------------------------------------------------------------------------------------------
+bool ValidateTga( const std::string& dir, const TgaCase& test, const std::vector<u8>& expected )
+{
+    asdx::ResTexture texture;
+    if ( !asdx::LoadResTextureFromTGA( ToTgaPath( dir, test.Name ).c_str(), &texture ) )
+    {
+        printf( "  NG : %s load failed.\n", test.Name.c_str() );
+        return false;
+    }
+
+    const auto& surface = texture.pSurfaces[0];
+    auto result = ( texture.Width == test.Width )
+               && ( texture.Height == test.Height )
+               && ( surface.SlicePitch == expected.size() )
+               && ( memcmp( surface.pPixels, expected.data(), expected.size() ) == 0 );
+    if ( !result )
+    { printf( "  NG : %s pixels mismatch.\n", test.Name.c_str() ); }
+
+    Release( texture );
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      途中で切れた TGA が拒否されることを確認します.
+//-------------------------------------------------------------------------------------------------
+bool CheckTruncatedTga( const std::string& dir, const std::string& name )
+{
+    std::vector<u8> data;
+    {
+        auto path  = dir + "/" + name + ".tga";
+        auto pFile = fopen( path.c_str(), "rb" );
+        if ( pFile == nullptr )
+        { return false; }
+
+        fseek( pFile, 0, SEEK_END );
+        data.resize( size_t( ftell( pFile ) ) );
+        fseek( pFile, 0, SEEK_SET );
+        auto size = fread( data.data(), 1, data.size(), pFile );
+        fclose( pFile );
+        if ( size != data.size() )
+        { return false; }
+    }
+
+    // フッター無しのファイルなので, 末尾まで揃っていない限り失敗する必要がある.
+    u32 accepted = 0;
+    for( size_t size=0; size<data.size(); ++size )
+    {
+        std::vector<u8> part( data.begin(), data.begin() + size );
+        part.shrink_to_fit();
+
+        asdx::ResTexture texture;
+        if ( asdx::LoadResTextureFromTGA( part.data(), part.size(), &texture ) )
+        {
+            accepted++;
+            Release( texture );
+        }
+    }
+
+    return accepted == 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      変更前と変更後の TGA ローダーの処理速度を計測します.
+//-------------------------------------------------------------------------------------------------
+void MeasureTga( const std::string& dir, const TgaCase& test )
+{
+    auto path = ToTgaPath( dir, test.Name );
+
+    f64 oldMsec = 0.0;
+    f64 newMsec = 0.0;
+
+    for( u32 k=0; k<BENCH_COUNT; ++k )
+    {
+        auto begin = std::chrono::steady_clock::now();
+        {
+            asdx::ResTexture texture;
+            if ( asdx::LoadResTextureFromTGA_Old( path.c_str(), &texture ) )
+            {
+                // 変更前の実装はサーフェイスを単体の new で確保している.
+                delete [] texture.pSurfaces[0].pPixels;
+                delete texture.pSurfaces;
+            }
+        }
+        auto middle = std::chrono::steady_clock::now();
+        {
+            asdx::ResTexture texture;
+            if ( asdx::LoadResTextureFromTGA( path.c_str(), &texture ) )
+            { Release( texture ); }
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        oldMsec += std::chrono::duration<f64, std::milli>( middle - begin ).count();
+        newMsec += std::chrono::duration<f64, std::milli>( end - middle ).count();
+    }
+
+    // 展開後のサイズを基準に MB/s を求める.
+    auto size = f64( test.Width ) * test.Height * 4.0 / ( 1024.0 * 1024.0 );
+    oldMsec /= BENCH_COUNT;
+    newMsec /= BENCH_COUNT;
+    printf( "%-19s : old %7.2f ms %6.0f MB/s, new %7.2f ms %6.0f MB/s\n",
+        test.Name.c_str(), oldMsec, size / ( oldMsec / 1000.0 ), newMsec, size / ( newMsec / 1000.0 ) );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      TGA の検証と計測を行います.
+//-------------------------------------------------------------------------------------------------
+bool RunTGA( const std::string& dir )
+{
+    std::mt19937 random( 13 );
+    std::vector<u8> expected;
+    char name[64];
+
+    // 全形式 x 原点 x 圧縮の有無 x サイズ. 一部は右から左の並び, フッター無しにする.
+    static const u32 SIZES[][2] = { { 1, 1 }, { 7, 5 }, { 33, 17 } };
+    u32 index  = 0;
+    u32 failed = 0;
+    for( u32 kind=0; kind<TGA_KIND_COUNT; ++kind )
+    {
+        for( auto topDown : { true, false } )
+        {
+            for( auto rle : { false, true } )
+            {
+                for( const auto& size : SIZES )
+                {
+                    sprintf( name, "T%03u", index );
+                    auto test = MakeTgaCase( name, kind, size[0], size[1], topDown, rle, ( index % 5 ) == 0, ( index % 3 ) != 0, false );
+                    if ( !WriteTgaFile( dir, test, random, expected ) )
+                    { return false; }
+
+                    if ( !ValidateTga( dir, test, expected ) )
+                    { failed++; }
+
+                    index++;
+                }
+            }
+        }
+    }
+
+    auto result = ( failed == 0 );
+    printf( "tga : files = %u, failed = %u ... %s\n", index, failed, ( result ) ? "OK" : "NG" );
+
+    // 途中で切れたファイル.
+    auto truncated = MakeTgaCase( "tga_truncated", TGA_KIND_RGB24, 33, 17, false, true, false, false, false );
+    if ( !WriteTgaFile( dir, truncated, random, expected ) )
+    { return false; }
+
+    auto rejected = CheckTruncatedTga( dir, truncated.Name );
+    printf( "tga : truncated file ... %s\n", ( rejected ) ? "OK" : "NG" );
+    result &= rejected;
+
+    // 大きなテクスチャで変更前のローダーと比較.
+    std::vector<TgaCase> bench;
+    bench.push_back( MakeTgaCase( "tga_rgb24_raw_4k",   TGA_KIND_RGB24,  4096, 4096, true, false, false, true, false ) );
+    bench.push_back( MakeTgaCase( "tga_rgba32_raw_4k",  TGA_KIND_RGBA32, 4096, 4096, true, false, false, true, false ) );
+    bench.push_back( MakeTgaCase( "tga_rgb24_rle_4k",   TGA_KIND_RGB24,  4096, 4096, true, true,  false, true, false ) );
+    bench.push_back( MakeTgaCase( "tga_rgba32_rle_4k",  TGA_KIND_RGBA32, 4096, 4096, true, true,  false, true, false ) );
+    bench.push_back( MakeTgaCase( "tga_rgb24_noisy_2k", TGA_KIND_RGB24,  2048, 2048, true, true,  false, true, true  ) );
+    bench.push_back( MakeTgaCase( "tga_rgba32_noisy_2k",TGA_KIND_RGBA32, 2048, 2048, true, true,  false, true, true  ) );
+
+    for( const auto& test : bench )
+    {
+        if ( !WriteTgaFile( dir, test, random, expected ) )
+        { return false; }
+
+        if ( !ValidateTga( dir, test, expected ) )
+        { result = false; }
+
+        MeasureTga( dir, test );
+    }
+
+    return result;
+}
+
+} // namespace /* anonymous */
+
+
+//-------------------------------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-------------------------------------------------------------------------------------------------
+int main( int argc, char** argv )
+{
+    std::string dir = ( argc > 1 ) ? argv[1] : "work";
+    mkdir( dir.c_str(), 0755 );
+
+    auto result = RunDDS( dir );
+    result &= RunTGA( dir );
+
+    return ( result ) ? 0 : -1;
+}
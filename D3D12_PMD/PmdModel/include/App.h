@@ -23,6 +23,8 @@
 #include <asdxIndexBuffer.h>
 #include <asdxConstantBuffer.h>
 #include <asdxTexture.h>
+#include <asdxMorphEngine.h>
+#include <asdxPmdPhysics.h>
 
 //-------------------------------------------------------------------------------------------------
 // Linker
@@ -137,6 +139,11 @@ private:
     asdx::IndexBuffer                        m_ModelIB;
     asdx::ResPmd                             m_ModelData;
     std::vector<asdx::Texture>               m_ModelTexture;
+    asdx::MorphEngine                        m_Morph;
+    FLOAT                                    m_MorphTime;
+    asdx::PmdPhysics                         m_Physics;
+    std::vector<asdx::Matrix>                m_BoneTransforms;
+    std::vector<u32>                         m_PhysicsVertices;
 
     //=============================================================================================
     // private methods.
@@ -2305,13 +2305,6 @@ public:
             f32 _31, _32, _33, _34;
             f32 _41, _42, _43, _44;
         };
-        struct
-        {
-            Vector4 axisX;
-            Vector4 axisY;
-            Vector4 axisZ;
-            Vector4 axisW;
-        };
         f32 m[4][4];
     };
 
@@ -0,0 +1,183 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxMorphEngine.h
+// Desc : Morph Target Evaluation Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+#pragma once
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxTypedef.h>
+#include <asdxMath.h>
+#include <asdxResPMD.h>
+#include <vector>
+#include <string>
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// MorphRange structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct MorphRange
+{
+    u32     Offset;     //!< 先頭の頂点番号.
+    u32     Count;      //!< 頂点数.
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// MorphEngine class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class MorphEngine : private NonCopyable
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    /* NOTHING */
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    /* NOTHING */
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    MorphEngine();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //---------------------------------------------------------------------------------------------
+    ~MorphEngine();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      初期化処理を行います.
+    //!
+    //! @param[in]      pmd         モデルデータです.
+    //! @retval true    初期化に成功.
+    //! @retval false   初期化に失敗.
+    //! @note       base 表情を基準にした頂点番号順の差分リストに変換します.
+    //!             モーフ番号は ResPmd::Morphes の番号と同じです(base 表情の重みは無視されます).
+    //---------------------------------------------------------------------------------------------
+    bool Init( const ResPmd& pmd );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      終了処理を行います.
+    //---------------------------------------------------------------------------------------------
+    void Term();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      モーフ数を取得します.
+    //!
+    //! @return     モーフ数を返却します.
+    //---------------------------------------------------------------------------------------------
+    u32 GetMorphCount() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      モーフ番号を検索します.
+    //!
+    //! @param[in]      name        表情名です.
+    //! @return     モーフ番号を返却します. 見つからない場合は -1 を返却します.
+    //---------------------------------------------------------------------------------------------
+    s32 FindMorph( const char8* name ) const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      重みを設定します.
+    //!
+    //! @param[in]      index       モーフ番号です.
+    //! @param[in]      weight      重みです.
+    //---------------------------------------------------------------------------------------------
+    void SetWeight( u32 index, f32 weight );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      重みを取得します.
+    //!
+    //! @param[in]      index       モーフ番号です.
+    //! @return     重みを返却します.
+    //---------------------------------------------------------------------------------------------
+    f32 GetWeight( u32 index ) const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      全ての重みを0にします.
+    //---------------------------------------------------------------------------------------------
+    void ResetWeights();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      重みを適用して位置座標を更新します.
+    //!
+    //! @retval true    位置座標が更新された.
+    //! @retval false   重みが変化していないため更新されなかった.
+    //! @note       前回と今回の有効なモーフが影響する頂点だけを処理します.
+    //!             更新した頂点の範囲は GetDirtyRanges() で取得できます.
+    //---------------------------------------------------------------------------------------------
+    bool Update();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      位置座標を取得します.
+    //!
+    //! @return     モーフ適用後の全頂点の位置座標を返却します.
+    //---------------------------------------------------------------------------------------------
+    const Vector3* GetPositions() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      頂点数を取得します.
+    //!
+    //! @return     頂点数を返却します.
+    //---------------------------------------------------------------------------------------------
+    u32 GetVertexCount() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      直前の Update() で更新した頂点の範囲を取得します.
+    //!
+    //! @return     頂点番号順に並んだ重なりの無い範囲を返却します.
+    //---------------------------------------------------------------------------------------------
+    const std::vector<MorphRange>& GetDirtyRanges() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      更新した範囲の位置座標をコピーします.
+    //!
+    //! @param[in]      pDst        コピー先の頂点データです(先頭に位置座標を持つ必要があります).
+    //! @param[in]      stride      1頂点あたりのサイズです.
+    //! @return     コピーした頂点数を返却します.
+    //---------------------------------------------------------------------------------------------
+    u32 CopyPositions( void* pDst, u32 stride ) const;
+
+private:
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    // Target structure
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    struct Target
+    {
+        std::string                 Name;           //!< 表情名.
+        std::vector<u32>            Indices;        //!< 頂点番号(昇順).
+        std::vector<Vector4>        Deltas;         //!< 位置座標の差分(w は未使用).
+        std::vector<MorphRange>     Ranges;         //!< 影響する頂点の範囲.
+        f32                         Weight;         //!< 重み.
+        f32                         AppliedWeight;  //!< 適用済みの重み.
+    };
+
+    //=============================================================================================
+    // private variables.
+    //=============================================================================================
+    std::vector<Target>         m_Targets;          //!< モーフターゲットです.
+    std::vector<Vector3>        m_BasePositions;    //!< 変形前の位置座標です.
+    std::vector<Vector3>        m_Positions;        //!< 変形後の位置座標です.
+    std::vector<Vector4>        m_Deltas;           //!< 頂点ごとの差分の合計です.
+    std::vector<u32>            m_Active;           //!< 適用済みのモーフ番号です.
+    std::vector<MorphRange>     m_DirtyRanges;      //!< 更新した範囲です.
+
+    //=============================================================================================
+    // private methods.
+    //=============================================================================================
+    /* NOTHING */
+};
+
+
+} // namespace asdx
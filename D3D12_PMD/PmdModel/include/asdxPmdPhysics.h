@@ -0,0 +1,262 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxPmdPhysics.h
+// Desc : Position Based Dynamics Module for PMD Rigid Bodies.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+#pragma once
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxTypedef.h>
+#include <asdxMath.h>
+#include <asdxResPMD.h>
+#include <vector>
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// PmdPhysics class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class PmdPhysics : private NonCopyable
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    /* NOTHING */
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    /* NOTHING */
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    PmdPhysics();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //---------------------------------------------------------------------------------------------
+    ~PmdPhysics();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      初期化処理を行います.
+    //!
+    //! @param[in]      pmd         モデルデータです.
+    //! @retval true    初期化に成功.
+    //! @retval false   初期化に失敗.
+    //! @note       剛体を粒子, ジョイントを距離拘束と角度制限に変換します.
+    //!             初期状態はバインドポーズです.
+    //---------------------------------------------------------------------------------------------
+    bool Init( const ResPmd& pmd );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      終了処理を行います.
+    //---------------------------------------------------------------------------------------------
+    void Term();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      粒子をボーンの姿勢の位置に戻し, 速度を0にします.
+    //!
+    //! @param[in]      pBoneTransforms     ボーンのワールド行列です.
+    //---------------------------------------------------------------------------------------------
+    void Reset( const Matrix* pBoneTransforms );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      重力加速度を設定します.
+    //---------------------------------------------------------------------------------------------
+    void SetGravity( const Vector3& value );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      固定時間ステップを設定します.
+    //!
+    //! @param[in]      step            1ステップの時間(秒)です.
+    //! @param[in]      subStepCount    1ステップあたりのサブステップ数です.
+    //! @param[in]      iterationCount  サブステップあたりの拘束の反復回数です.
+    //---------------------------------------------------------------------------------------------
+    void SetTimeStep( f32 step, u32 subStepCount, u32 iterationCount );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      決定論的モードを設定します.
+    //!
+    //! @param[in]      enable      有効にする場合は true を指定します.
+    //! @note       有効な場合は経過時間に関わらず Update() 1回につき1ステップだけ進めます.
+    //!             同じ入力に対して常に同じ結果になるため, テストや比較に使用します.
+    //---------------------------------------------------------------------------------------------
+    void SetDeterministic( bool enable );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      シミュレーションを進め, 結果をボーンに書き戻します.
+    //!
+    //! @param[in]      elapsedSec          経過時間(秒)です.
+    //! @param[in,out]  pBoneTransforms     ボーンのワールド行列です(モデル空間).
+    //!                                     バインドポーズはボーンのヘッド位置への平行移動行列です.
+    //! @note       物理演算の剛体が関連付けられたボーンと, その子孫を書き換えます.
+    //---------------------------------------------------------------------------------------------
+    void Update( f32 elapsedSec, Matrix* pBoneTransforms );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      直前の Update() で進めたステップ数を取得します.
+    //---------------------------------------------------------------------------------------------
+    u32 GetStepCount() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      粒子数を取得します.
+    //---------------------------------------------------------------------------------------------
+    u32 GetParticleCount() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      粒子の位置座標を取得します.
+    //!
+    //! @param[in]      index       粒子番号(剛体番号)です.
+    //---------------------------------------------------------------------------------------------
+    Vector3 GetPosition( u32 index ) const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      複数のキャラクターのシミュレーションを並列で進めます.
+    //!
+    //! @param[in]      ppPhysics           キャラクターごとの物理演算です.
+    //! @param[in]      ppBoneTransforms    キャラクターごとのボーンのワールド行列です.
+    //! @param[in]      count               キャラクター数です.
+    //! @param[in]      elapsedSec          経過時間(秒)です.
+    //! @param[in]      threadCount         使用するスレッド数です(0の場合はハードウェアスレッド数).
+    //! @note       キャラクター間で状態を共有しないため, スレッド数に関わらず結果は同じです.
+    //!             ワーカースレッドは初回の呼び出しで作成し, 以降の呼び出しで使い回します.
+    //---------------------------------------------------------------------------------------------
+    static void UpdateBatch(
+        PmdPhysics* const*  ppPhysics,
+        Matrix* const*      ppBoneTransforms,
+        u32                 count,
+        f32                 elapsedSec,
+        u32                 threadCount );
+
+private:
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    // Particles structure
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    struct Particles
+    {
+        std::vector<f32>    PosX;           //!< 位置座標 X.
+        std::vector<f32>    PosY;           //!< 位置座標 Y.
+        std::vector<f32>    PosZ;           //!< 位置座標 Z.
+        std::vector<f32>    PrevX;          //!< 前サブステップの位置座標 X.
+        std::vector<f32>    PrevY;          //!< 前サブステップの位置座標 Y.
+        std::vector<f32>    PrevZ;          //!< 前サブステップの位置座標 Z.
+        std::vector<f32>    InvMass;        //!< 質量の逆数(ボーン追従は0).
+        std::vector<f32>    Damping;        //!< サブステップあたりの速度の保持率.
+        std::vector<f32>    Radius;         //!< 衝突半径.
+
+        //-----------------------------------------------------------------------------------------
+        //! @brief      粒子数を変更します.
+        //-----------------------------------------------------------------------------------------
+        void Resize( size_t count )
+        {
+            PosX   .resize( count, 0.0f );
+            PosY   .resize( count, 0.0f );
+            PosZ   .resize( count, 0.0f );
+            PrevX  .resize( count, 0.0f );
+            PrevY  .resize( count, 0.0f );
+            PrevZ  .resize( count, 0.0f );
+            InvMass.resize( count, 0.0f );
+            Damping.resize( count, 1.0f );
+            Radius .resize( count, 0.0f );
+        }
+    };
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    // Body structure
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    struct Body
+    {
+        u32         Bone;           //!< 関連ボーン番号.
+        u32         Type;           //!< 剛体のタイプ.
+        u32         Parent;         //!< ボーンの書き戻しで回転の基準とする剛体番号.
+        u16         Group;          //!< 自身のグループのビット.
+        u16         Mask;           //!< 衝突するグループのマスク.
+        f32         Damping;        //!< 移動減衰.
+        Matrix      Offset;         //!< ボーンからの相対行列.
+        Vector3     Axis;           //!< カプセルの軸の半分(剛体の座標系).
+    };
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    // Joint structure
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    struct Joint
+    {
+        u32     A;                  //!< 剛体A.
+        u32     B;                  //!< 剛体B.
+        f32     RestLength;         //!< 自然長.
+        f32     Compliance;         //!< 距離拘束の柔らかさ(剛性の逆数).
+        f32     CosLimit;           //!< アニメーション姿勢からの角度制限の余弦(制限無しは-2).
+        f32     SinLimit;           //!< アニメーション姿勢からの角度制限の正弦.
+        f32     Lambda;             //!< XPBD のラグランジュ乗数.
+    };
+
+    //=============================================================================================
+    // private variables.
+    //=============================================================================================
+    Particles               m_Particles;            //!< 粒子です(剛体と同じ番号).
+    std::vector<Body>       m_Bodies;               //!< 剛体です.
+    std::vector<Joint>      m_Joints;               //!< ジョイントです.
+    std::vector<u32>        m_Colliders;            //!< 衝突判定に使うボーン追従剛体の番号です.
+    std::vector<u32>        m_ContactOffsets;       //!< 粒子ごとの m_ContactColliders の開始位置です.
+    std::vector<u32>        m_ContactColliders;     //!< 粒子ごとに衝突判定を行う m_Colliders の番号です.
+    std::vector<u32>        m_BoneParents;          //!< ボーンの親番号です.
+    std::vector<u32>        m_BoneOrder;            //!< 親から順に並べたボーン番号です.
+    std::vector<u32>        m_BoneBodies;           //!< ボーンに書き戻す物理演算の剛体番号です.
+    std::vector<Matrix>     m_BoneDeltas;           //!< 書き戻しによるボーンのワールド空間での変化量です.
+    std::vector<u8>         m_BoneDirty;            //!< 書き戻したボーンかどうか.
+    std::vector<Vector3>    m_AnimPositions;        //!< アニメーション姿勢での剛体の位置です.
+    std::vector<Vector3>    m_PrevAnimPositions;    //!< 最後にステップを進めた時のアニメーション姿勢での剛体の位置です.
+    std::vector<Vector3>    m_ColliderPoints;       //!< 衝突判定用のカプセルの端点です(2つずつ).
+    std::vector<Vector3>    m_PrevColliderPoints;   //!< 最後にステップを進めた時の衝突判定用のカプセルの端点です.
+    Vector3                 m_Gravity;              //!< 重力加速度です.
+    f32                     m_TimeStep;             //!< 固定時間ステップです.
+    u32                     m_SubStepCount;         //!< サブステップ数です.
+    u32                     m_IterationCount;       //!< 拘束の反復回数です.
+    f32                     m_Accumulator;          //!< 未処理の経過時間です.
+    u32                     m_StepCount;            //!< 直前の更新で進めたステップ数です.
+    bool                    m_Deterministic;        //!< 決定論的モードかどうか.
+    bool                    m_IsReset;              //!< 次の更新で粒子を配置し直すかどうか.
+
+    //=============================================================================================
+    // private methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      アニメーション姿勢での剛体の位置と衝突形状を更新します.
+    //---------------------------------------------------------------------------------------------
+    void UpdateAnimPositions( const Matrix* pBoneTransforms );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      サブステップを1回進めます.
+    //!
+    //! @param[in]      ratio       前回から今回のアニメーション姿勢への補間率です.
+    //---------------------------------------------------------------------------------------------
+    void SubStep( f32 ratio );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ジョイントの拘束を解きます.
+    //---------------------------------------------------------------------------------------------
+    void SolveJoints( f32 h, f32 ratio );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      衝突を解決します.
+    //---------------------------------------------------------------------------------------------
+    void SolveCollisions( f32 ratio );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      結果をボーンに書き戻します.
+    //---------------------------------------------------------------------------------------------
+    void WriteBack( Matrix* pBoneTransforms );
+};
+
+
+} // namespace asdx
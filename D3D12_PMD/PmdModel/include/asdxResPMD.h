@@ -323,6 +323,18 @@ public:
     //---------------------------------------------------------------------------------------------
     bool Load( const char16* filename ) override;
 
+    //---------------------------------------------------------------------------------------------
+    //! @brief      メモリから読み込みを行います.
+    //!
+    //! @param[in]      pBuffer         ファイル全体を格納したバッファです.
+    //! @param[in]      size            バッファサイズです.
+    //! @retval true    読み込みに成功.
+    //! @retval false   読み込みに失敗.
+    //! @note       各要素数は残りサイズで検証してから一括でコピーします.
+    //!             参照番号が範囲外のデータは読み込みに失敗します.
+    //---------------------------------------------------------------------------------------------
+    bool Load( const u8* pBuffer, size_t size );
+
     //---------------------------------------------------------------------------------------------
     //! @brief      破棄処理を行います.
     //---------------------------------------------------------------------------------------------
@@ -122,7 +122,7 @@
     #if _MSC_VER
         #define ASDX_ALIGN( alignment )    __declspec( align(alignment) )
     #else
-        #define ASDX_ALIGN( alignment )    __attribute__( aligned(alignment) )
+        #define ASDX_ALIGN( alignment )    __attribute__( (aligned(alignment)) )
     #endif
 #endif//ASDX_ALIGN
 
@@ -137,7 +137,7 @@
 #endif//ASDX_WIDE
 
 
-#if defined(_M_IX86) || defined(_M_X64)
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
     #define ASDX_IS_SSE     (1)     // SSE有効.
 #else
     #define ASDX_IS_SSE     (0)     // SSE無効.
@@ -279,7 +279,11 @@ typedef wchar_t             char16;
 //! @brief      符号付き8bit整数型の最小値です.
 //--------------------------------------------------------------------------------------------------
 #ifndef S8_MIN
+#if defined(_MSC_VER)
 #define S8_MIN          (-127i8 - 1)
+#else
+#define S8_MIN          (-127 - 1)
+#endif
 #endif//S8_MIN
 
 //--------------------------------------------------------------------------------------------------
@@ -287,7 +291,11 @@ typedef wchar_t             char16;
 //! @brief      符号付き16bit整数型の最小値です.
 //--------------------------------------------------------------------------------------------------
 #ifndef S16_MIN
+#if defined(_MSC_VER)
 #define S16_MIN         (-32767i16 - 1)
+#else
+#define S16_MIN         (-32767 - 1)
+#endif
 #endif//S16_MIN
 
 //--------------------------------------------------------------------------------------------------
@@ -295,7 +303,11 @@ typedef wchar_t             char16;
 //! @brief      符号付き32bit整数型の最小値です.
 //--------------------------------------------------------------------------------------------------
 #ifndef S32_MIN
+#if defined(_MSC_VER)
 #define S32_MIN         (-2147483647i32 - 1)
+#else
+#define S32_MIN         (-2147483647 - 1)
+#endif
 #endif//S32_MIN
 
 //--------------------------------------------------------------------------------------------------
@@ -303,7 +315,11 @@ typedef wchar_t             char16;
 //! @brief      符号付き64bit整数型の最小値です.
 //--------------------------------------------------------------------------------------------------
 #ifndef S64_MIN
+#if defined(_MSC_VER)
 #define S64_MIN         (-9223372036854775807i64 - 1)
+#else
+#define S64_MIN         (-9223372036854775807LL - 1)
+#endif
 #endif//S64_MIN
 
 //--------------------------------------------------------------------------------------------------
@@ -311,7 +327,11 @@ typedef wchar_t             char16;
 //! @brief      符号付8bit整数型の最大値です.
 //--------------------------------------------------------------------------------------------------
 #ifndef S8_MAX
+#if defined(_MSC_VER)
 #define S8_MAX          127i8
+#else
+#define S8_MAX          127
+#endif
 #endif//S8_MAX
 
 //--------------------------------------------------------------------------------------------------
@@ -319,7 +339,11 @@ typedef wchar_t             char16;
 //! @brief      符号付き16bit整数型の最大値です.
 //--------------------------------------------------------------------------------------------------
 #ifndef S16_MAX
+#if defined(_MSC_VER)
 #define S16_MAX         32767i16
+#else
+#define S16_MAX         32767
+#endif
 #endif//S16_MAX
 
 //--------------------------------------------------------------------------------------------------
@@ -327,7 +351,11 @@ typedef wchar_t             char16;
 //! @brief      符号付き32bit整数型の最大値です.
 //--------------------------------------------------------------------------------------------------
 #ifndef S32_MAX
+#if defined(_MSC_VER)
 #define S32_MAX         2147483647i32
+#else
+#define S32_MAX         2147483647
+#endif
 #endif//S32_MAX
 
 //--------------------------------------------------------------------------------------------------
@@ -335,7 +363,11 @@ typedef wchar_t             char16;
 //! @brief      符号付き64bit整数型の最大値です.
 //--------------------------------------------------------------------------------------------------
 #ifndef S64_MAX
+#if defined(_MSC_VER)
 #define S64_MAX         9223372036854775807i64
+#else
+#define S64_MAX         9223372036854775807LL
+#endif
 #endif//S64_MAX
 
 //--------------------------------------------------------------------------------------------------
@@ -343,7 +375,11 @@ typedef wchar_t             char16;
 //! @brief      符号無し8bit整数型の最大値です.
 //--------------------------------------------------------------------------------------------------
 #ifndef U8_MAX
+#if defined(_MSC_VER)
 #define U8_MAX          0xffui8
+#else
+#define U8_MAX          0xffu
+#endif
 #endif//U8_MAX
 
 //--------------------------------------------------------------------------------------------------
@@ -351,7 +387,11 @@ typedef wchar_t             char16;
 //! @brief      符号無し16bit整数型の最大値です.
 //--------------------------------------------------------------------------------------------------
 #ifndef U16_MAX
+#if defined(_MSC_VER)
 #define U16_MAX         0xffffui16
+#else
+#define U16_MAX         0xffffu
+#endif
 #endif//U16_MAX
 
 //--------------------------------------------------------------------------------------------------
@@ -359,7 +399,11 @@ typedef wchar_t             char16;
 //! @brief      符号無し32bit整数型の最大値です.
 //--------------------------------------------------------------------------------------------------
 #ifndef U32_MAX
+#if defined(_MSC_VER)
 #define U32_MAX         0xffffffffui32
+#else
+#define U32_MAX         0xffffffffu
+#endif
 #endif//U32_MAX
 
 //--------------------------------------------------------------------------------------------------
@@ -367,7 +411,11 @@ typedef wchar_t             char16;
 //! @brief      符号無し64bit整数型の最大値です.
 //--------------------------------------------------------------------------------------------------
 #ifndef U64_MAX
+#if defined(_MSC_VER)
 #define U64_MAX         0xffffffffffffffffui64
+#else
+#define U64_MAX         0xffffffffffffffffull
+#endif
 #endif//U64_MAX
 
 //--------------------------------------------------------------------------------------------------
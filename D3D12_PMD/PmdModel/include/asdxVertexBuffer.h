@@ -73,6 +73,19 @@ public:
     //---------------------------------------------------------------------------------------------
     D3D12_VERTEX_BUFFER_VIEW GetView() const;
 
+    //---------------------------------------------------------------------------------------------
+    //! @brief      メモリマッピングを行います.
+    //!
+    //! @return     マッピングしたメモリの先頭を返却します. 失敗した場合は nullptr を返却します.
+    //! @note       アップロードヒープ上のバッファのため, GPUが参照中でないときに書き込む必要があります.
+    //---------------------------------------------------------------------------------------------
+    void* Map();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      メモリマッピングを解除します.
+    //---------------------------------------------------------------------------------------------
+    void Unmap();
+
 private:
     //=============================================================================================
     // private variables.
@@ -8,6 +8,7 @@
 // Includes
 //-------------------------------------------------------------------------------------------------
 #include <cstdio>
+#include <cstring>
 #include <string>
 #include <shlwapi.h>
 #include <asdxTimer.h>
@@ -716,6 +717,64 @@ bool App::InitApp()
         }
     }
 
+    // モーフの初期化.
+    {
+        if ( !m_Morph.Init( m_ModelData ) )
+        {
+            ELOG( "Error : MorphEngine::Init() Failed." );
+            return false;
+        }
+
+        m_MorphTime = 0.0f;
+    }
+
+    // 物理演算の初期化.
+    if ( !m_ModelData.RigidBodies.empty() )
+    {
+        if ( !m_Physics.Init( m_ModelData ) )
+        {
+            ELOG( "Error : PmdPhysics::Init() Failed." );
+            return false;
+        }
+
+        auto boneCount = m_ModelData.Bones.size();
+        m_BoneTransforms.resize( boneCount );
+
+        // 物理演算の剛体が書き戻すボーンと, その子孫を求める.
+        std::vector<u8> driven( boneCount, 0 );
+        for( size_t i=0; i<m_ModelData.RigidBodies.size(); ++i )
+        {
+            const auto& body = m_ModelData.RigidBodies[i];
+            if ( body.Type != asdx::PMD_RIGIDBODY_TYPE_FLLOW_BONE && body.RelationBoneIndex < boneCount )
+            { driven[body.RelationBoneIndex] = 1; }
+        }
+
+        // 親が子より後に並ぶ場合もあるので, 変化が無くなるまで伝搬する.
+        auto changed = true;
+        while( changed )
+        {
+            changed = false;
+            for( size_t i=0; i<boneCount; ++i )
+            {
+                auto parent = m_ModelData.Bones[i].ParentIndex;
+                if ( driven[i] == 0 && parent < boneCount && driven[parent] != 0 )
+                {
+                    driven[i] = 1;
+                    changed   = true;
+                }
+            }
+        }
+
+        // 揺れるボーンの影響を受ける頂点だけを毎フレーム更新する.
+        for( size_t i=0; i<m_ModelData.Vertices.size(); ++i )
+        {
+            const auto& vertex = m_ModelData.Vertices[i];
+            if ( ( vertex.BoneIndex[0] < boneCount && driven[vertex.BoneIndex[0]] != 0 )
+              || ( vertex.BoneIndex[1] < boneCount && driven[vertex.BoneIndex[1]] != 0 ) )
+            { m_PhysicsVertices.push_back( u32( i ) ); }
+        }
+    }
+
     // インデックスバッファの生成.
     {
         if ( !m_ModelIB.Init(
@@ -917,6 +976,11 @@ void App::TermApp()
 
     m_ModelVB.Term();
     m_ModelIB.Term();
+    m_Morph  .Term();
+    m_Physics.Term();
+
+    m_BoneTransforms .clear();
+    m_PhysicsVertices.clear();
     m_ModelTB.Term();
     m_ModelMB.Term();
 
@@ -943,6 +1007,68 @@ void App::OnRender(FLOAT elapsedSec)
     // 定数バッファを更新.
     m_ModelTB.Update( &m_ModelParam, sizeof(m_ModelParam), 0 );
 
+    // 表情を順番に再生する.
+    if ( m_Morph.GetMorphCount() > 1 )
+    {
+        m_MorphTime += elapsedSec;
+
+        // 2秒ごとに次の表情に切り替える(0番は base 表情なので除く).
+        auto index = 1 + u32( m_MorphTime * 0.5f ) % ( m_Morph.GetMorphCount() - 1 );
+        auto phase = fmodf( m_MorphTime, 2.0f ) * 0.5f;
+
+        m_Morph.ResetWeights();
+        m_Morph.SetWeight( index, sinf( phase * asdx::F_PI ) );
+
+        // 前フレームのコマンドは完了しているので, 変化した範囲だけを直接書き込む.
+        if ( m_Morph.Update() )
+        {
+            auto pDst = m_ModelVB.Map();
+            if ( pDst != nullptr )
+            {
+                m_Morph.CopyPositions( pDst, sizeof(asdx::PMD_VERTEX) );
+                m_ModelVB.Unmap();
+            }
+        }
+    }
+
+    // 物理演算で揺れる頂点だけをCPUでスキニングする.
+    if ( !m_PhysicsVertices.empty() )
+    {
+        // モデルの回転を姿勢に含めて慣性を与え, スキニング後に打ち消す(描画時にワールド行列で回転するため).
+        auto rotation = asdx::Matrix::CreateRotationY( m_RotateAngle );
+        for( size_t i=0; i<m_BoneTransforms.size(); ++i )
+        { m_BoneTransforms[i] = asdx::Matrix::CreateTranslation( m_ModelData.Bones[i].Position ) * rotation; }
+
+        m_Physics.Update( elapsedSec, &m_BoneTransforms[0] );
+
+        auto invRotation = asdx::Matrix::CreateRotationY( -m_RotateAngle );
+        auto pPositions  = m_Morph.GetPositions();
+        auto pDst        = static_cast<u8*>( m_ModelVB.Map() );
+        if ( pDst != nullptr && pPositions != nullptr )
+        {
+            for( size_t i=0; i<m_PhysicsVertices.size(); ++i )
+            {
+                auto index = m_PhysicsVertices[i];
+                const auto& vertex = m_ModelData.Vertices[index];
+
+                auto b0 = vertex.BoneIndex[0];
+                auto b1 = vertex.BoneIndex[1];
+                auto w  = f32( vertex.BoneWeight ) / 100.0f;
+
+                // バインドポーズはヘッド位置への平行移動なので, ヘッドからの相対位置を変換する.
+                // 法線は元のまま(揺れによる陰影の変化は小さいため).
+                auto p0 = asdx::Vector3::Transform( pPositions[index] - m_ModelData.Bones[b0].Position, m_BoneTransforms[b0] );
+                auto p1 = asdx::Vector3::Transform( pPositions[index] - m_ModelData.Bones[b1].Position, m_BoneTransforms[b1] );
+                auto position = asdx::Vector3::Transform( p0 * w + p1 * ( 1.0f - w ), invRotation );
+
+                memcpy( pDst + sizeof(asdx::PMD_VERTEX) * index, &position, sizeof(position) );
+            }
+        }
+
+        if ( pDst != nullptr )
+        { m_ModelVB.Unmap(); }
+    }
+
     // コマンドアロケータとコマンドリストをリセット.
     m_Immediate.Clear( m_pPipelineState.GetPtr() );
 
@@ -9,12 +9,17 @@
 //-------------------------------------------------------------------------------------------------
 #include <cstdio>
 #include <cstdarg>
-#include <Windows.h>
+#include <cwchar>
 #include <asdxLogger.h>
 
+#if defined(_WIN32)
+#include <Windows.h>
+#endif
+
 
 namespace /* anonymous */ {
 
+#if defined(_WIN32)
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 // ConsoleScreen structure
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -69,6 +74,19 @@ void ConsoleScreen::UnBindColor()
     HANDLE handle = GetStdHandle( STD_OUTPUT_HANDLE );
     SetConsoleTextAttribute( handle, ScreenBuffer.wAttributes );
 }
+#else
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ConsoleScreen structure (Windows 以外では何もしません)
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct ConsoleScreen
+{
+    void BindColor( asdx::LogLevel )
+    { /* DO_NOTHING */ }
+
+    void UnBindColor()
+    { /* DO_NOTHING */ }
+};
+#endif
 
 }// namespace /* anonymous */
 
@@ -111,12 +129,20 @@ void SystemLogger::LogA( const LogLevel level, const char8* format, ... )
             va_list arg;
 
             va_start( arg, format );
+        #if defined(_WIN32)
             vsprintf_s( msg, format, arg );
+        #else
+            vsnprintf( msg, sizeof(msg), format, arg );
+        #endif
             va_end( arg );
 
+        #if defined(_WIN32)
             printf_s( "%s", msg );
 
             OutputDebugStringA( msg );
+        #else
+            fputs( msg, stdout );
+        #endif
         }
 
         // カラー設定解除.
@@ -143,12 +169,21 @@ void SystemLogger::LogW( const LogLevel level, const char16* format, ... )
             va_list arg;
 
             va_start( arg, format );
+        #if defined(_WIN32)
             vswprintf_s( msg, format, arg );
+        #else
+            vswprintf( msg, sizeof(msg) / sizeof(msg[0]), format, arg );
+        #endif
             va_end( arg );
 
+        #if defined(_WIN32)
             wprintf_s( L"%s", msg );
 
             OutputDebugStringW( msg );
+        #else
+            // ストリームの向きが混在しないようにバイト出力する.
+            printf( "%ls", msg );
+        #endif
         }
 
         // カラー設定解除.
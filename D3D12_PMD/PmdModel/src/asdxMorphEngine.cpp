@@ -0,0 +1,414 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxMorphEngine.cpp
+// Desc : Morph Target Evaluation Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxMorphEngine.h>
+#include <asdxSimd.h>
+#include <asdxLogger.h>
+#include <algorithm>
+#include <cstring>
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------------
+// Constant Values
+//-------------------------------------------------------------------------------------------------
+static const u32 kRangeGap = 16;    // この頂点数以下の隙間は1つの範囲にまとめる.
+
+//-------------------------------------------------------------------------------------------------
+//      範囲を追加します.
+//-------------------------------------------------------------------------------------------------
+void AppendRanges( const std::vector<asdx::MorphRange>& src, std::vector<asdx::MorphRange>& dst )
+{ dst.insert( dst.end(), src.begin(), src.end() ); }
+
+//-------------------------------------------------------------------------------------------------
+//      重なり, 隣接する範囲を結合します.
+//-------------------------------------------------------------------------------------------------
+void MergeRanges( std::vector<asdx::MorphRange>& ranges )
+{
+    if ( ranges.empty() )
+    { return; }
+
+    std::sort( ranges.begin(), ranges.end(),
+        []( const asdx::MorphRange& a, const asdx::MorphRange& b ) { return a.Offset < b.Offset; } );
+
+    size_t count = 0;
+    for( size_t i=1; i<ranges.size(); ++i )
+    {
+        auto& last = ranges[count];
+        auto  end  = last.Offset + last.Count;
+
+        if ( ranges[i].Offset <= end )
+        {
+            auto next = ranges[i].Offset + ranges[i].Count;
+            if ( next > end )
+            { last.Count = next - last.Offset; }
+        }
+        else
+        {
+            ranges[++count] = ranges[i];
+        }
+    }
+
+    ranges.resize( count + 1 );
+}
+
+} // namespace /* anonymous */
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// MorphEngine class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+//-------------------------------------------------------------------------------------------------
+//      コンストラクタです.
+//-------------------------------------------------------------------------------------------------
+MorphEngine::MorphEngine()
+{ /* DO_NOTHING */ }
+
+//-------------------------------------------------------------------------------------------------
+//      デストラクタです.
+//-------------------------------------------------------------------------------------------------
+MorphEngine::~MorphEngine()
+{ Term(); }
+
+//-------------------------------------------------------------------------------------------------
+//      初期化処理を行います.
+//-------------------------------------------------------------------------------------------------
+bool MorphEngine::Init( const ResPmd& pmd )
+{
+    Term();
+
+    auto vertexCount = u32( pmd.Vertices.size() );
+    if ( vertexCount == 0 )
+    {
+        ELOG( "Error : Invalid Argument." );
+        return false;
+    }
+
+    m_BasePositions.resize( vertexCount );
+    for( u32 i=0; i<vertexCount; ++i )
+    { m_BasePositions[i] = pmd.Vertices[i].Position; }
+
+    m_Positions = m_BasePositions;
+    m_Deltas.resize( vertexCount, Vector4( 0.0f, 0.0f, 0.0f, 0.0f ) );
+
+    // base 表情を探す.
+    const ResPmdMorph* pBase = nullptr;
+    for( size_t i=0; i<pmd.Morphes.size(); ++i )
+    {
+        if ( pmd.Morphes[i].Type == 0 )
+        {
+            pBase = &pmd.Morphes[i];
+            break;
+        }
+    }
+
+    m_Targets.resize( pmd.Morphes.size() );
+
+    std::vector<std::pair<u32, Vector3>> entries;
+
+    for( size_t i=0; i<pmd.Morphes.size(); ++i )
+    {
+        const auto& morph  = pmd.Morphes[i];
+        auto&       target = m_Targets[i];
+
+        target.Name          = morph.Name;
+        target.Weight        = 0.0f;
+        target.AppliedWeight = 0.0f;
+
+        // base 表情は変形しない.
+        if ( morph.Type == 0 || pBase == nullptr )
+        { continue; }
+
+        // base 表情の頂点番号からモデルの頂点番号に変換する.
+        entries.clear();
+        entries.reserve( morph.Vertices.size() );
+        for( size_t j=0; j<morph.Vertices.size(); ++j )
+        {
+            const auto& src = morph.Vertices[j];
+            if ( src.Index >= pBase->Vertices.size() )
+            {
+                ELOG( "Error : Morph Vertex Index Out Of Range. morph = %u", u32(i) );
+                Term();
+                return false;
+            }
+
+            auto index = pBase->Vertices[src.Index].Index;
+            if ( index >= vertexCount )
+            {
+                ELOG( "Error : Base Morph Vertex Index Out Of Range. morph = %u", u32(i) );
+                Term();
+                return false;
+            }
+
+            entries.push_back( std::make_pair( index, src.Position ) );
+        }
+
+        // 頂点番号順に並べ, 同じ頂点への差分はまとめる.
+        std::sort( entries.begin(), entries.end(),
+            []( const std::pair<u32, Vector3>& a, const std::pair<u32, Vector3>& b ) { return a.first < b.first; } );
+
+        target.Indices.reserve( entries.size() );
+        target.Deltas .reserve( entries.size() );
+
+        for( size_t j=0; j<entries.size(); ++j )
+        {
+            const auto& delta = entries[j].second;
+            if ( !target.Indices.empty() && target.Indices.back() == entries[j].first )
+            {
+                auto& last = target.Deltas.back();
+                last.x += delta.x;
+                last.y += delta.y;
+                last.z += delta.z;
+                continue;
+            }
+
+            target.Indices.push_back( entries[j].first );
+            target.Deltas .push_back( Vector4( delta.x, delta.y, delta.z, 0.0f ) );
+        }
+
+        // 更新範囲を求めておく.
+        for( size_t j=0; j<target.Indices.size(); ++j )
+        {
+            auto index = target.Indices[j];
+            if ( !target.Ranges.empty() )
+            {
+                auto& last = target.Ranges.back();
+                if ( index <= last.Offset + last.Count + kRangeGap )
+                {
+                    last.Count = index - last.Offset + 1;
+                    continue;
+                }
+            }
+
+            MorphRange range;
+            range.Offset = index;
+            range.Count  = 1;
+            target.Ranges.push_back( range );
+        }
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      終了処理を行います.
+//-------------------------------------------------------------------------------------------------
+void MorphEngine::Term()
+{
+    m_Targets      .clear();
+    m_BasePositions.clear();
+    m_Positions    .clear();
+    m_Deltas       .clear();
+    m_Active       .clear();
+    m_DirtyRanges  .clear();
+}
+
+//-------------------------------------------------------------------------------------------------
+//      モーフ数を取得します.
+//-------------------------------------------------------------------------------------------------
+u32 MorphEngine::GetMorphCount() const
+{ return u32( m_Targets.size() ); }
+
+//-------------------------------------------------------------------------------------------------
+//      モーフ番号を検索します.
+//-------------------------------------------------------------------------------------------------
+s32 MorphEngine::FindMorph( const char8* name ) const
+{
+    if ( name == nullptr )
+    { return -1; }
+
+    for( size_t i=0; i<m_Targets.size(); ++i )
+    {
+        if ( m_Targets[i].Name == name )
+        { return s32(i); }
+    }
+
+    return -1;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      重みを設定します.
+//-------------------------------------------------------------------------------------------------
+void MorphEngine::SetWeight( u32 index, f32 weight )
+{
+    if ( index >= m_Targets.size() )
+    { return; }
+
+    m_Targets[index].Weight = weight;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      重みを取得します.
+//-------------------------------------------------------------------------------------------------
+f32 MorphEngine::GetWeight( u32 index ) const
+{
+    if ( index >= m_Targets.size() )
+    { return 0.0f; }
+
+    return m_Targets[index].Weight;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      全ての重みを0にします.
+//-------------------------------------------------------------------------------------------------
+void MorphEngine::ResetWeights()
+{
+    for( size_t i=0; i<m_Targets.size(); ++i )
+    { m_Targets[i].Weight = 0.0f; }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      重みを適用して位置座標を更新します.
+//-------------------------------------------------------------------------------------------------
+bool MorphEngine::Update()
+{
+    m_DirtyRanges.clear();
+
+    // 重みが変化していなければ何もしない.
+    auto changed = false;
+    for( size_t i=0; i<m_Targets.size(); ++i )
+    {
+        if ( m_Targets[i].Weight != m_Targets[i].AppliedWeight )
+        {
+            changed = true;
+            break;
+        }
+    }
+
+    if ( !changed )
+    { return false; }
+
+    auto pDeltas = &m_Deltas[0];
+
+    // 前回適用したモーフの影響をクリア.
+    for( size_t i=0; i<m_Active.size(); ++i )
+    {
+        const auto& target = m_Targets[m_Active[i]];
+        auto count = target.Indices.size();
+
+    #if ASDX_IS_SIMD && ASDX_IS_SSE
+        auto zero = _mm_setzero_ps();
+        for( size_t j=0; j<count; ++j )
+        { _mm_storeu_ps( &pDeltas[target.Indices[j]].x, zero ); }
+    #else
+        for( size_t j=0; j<count; ++j )
+        { pDeltas[target.Indices[j]] = Vector4( 0.0f, 0.0f, 0.0f, 0.0f ); }
+    #endif
+
+        AppendRanges( target.Ranges, m_DirtyRanges );
+    }
+
+    // 重みが0でないモーフを適用.
+    m_Active.clear();
+    for( size_t i=0; i<m_Targets.size(); ++i )
+    {
+        auto& target = m_Targets[i];
+        target.AppliedWeight = target.Weight;
+
+        if ( target.Weight == 0.0f || target.Indices.empty() )
+        { continue; }
+
+        m_Active.push_back( u32(i) );
+
+        auto count   = target.Indices.size();
+        auto pIndex  = &target.Indices[0];
+        auto pSrc    = &target.Deltas[0];
+
+    #if ASDX_IS_SIMD && ASDX_IS_SSE
+        auto weight = _mm_set1_ps( target.Weight );
+        for( size_t j=0; j<count; ++j )
+        {
+            auto pDst  = &pDeltas[pIndex[j]].x;
+            auto delta = _mm_loadu_ps( &pSrc[j].x );
+            _mm_storeu_ps( pDst, Simd::Mad( delta, weight, _mm_loadu_ps( pDst ) ) );
+        }
+    #else
+        auto weight = target.Weight;
+        for( size_t j=0; j<count; ++j )
+        {
+            auto& dst = pDeltas[pIndex[j]];
+            dst.x += pSrc[j].x * weight;
+            dst.y += pSrc[j].y * weight;
+            dst.z += pSrc[j].z * weight;
+        }
+    #endif
+
+        AppendRanges( target.Ranges, m_DirtyRanges );
+    }
+
+    MergeRanges( m_DirtyRanges );
+
+    // 更新範囲の位置座標を求める.
+    for( size_t i=0; i<m_DirtyRanges.size(); ++i )
+    {
+        auto begin = m_DirtyRanges[i].Offset;
+        auto end   = begin + m_DirtyRanges[i].Count;
+
+        for( auto j=begin; j<end; ++j )
+        {
+            const auto& base  = m_BasePositions[j];
+            const auto& delta = pDeltas[j];
+
+            m_Positions[j].x = base.x + delta.x;
+            m_Positions[j].y = base.y + delta.y;
+            m_Positions[j].z = base.z + delta.z;
+        }
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      位置座標を取得します.
+//-------------------------------------------------------------------------------------------------
+const Vector3* MorphEngine::GetPositions() const
+{ return ( m_Positions.empty() ) ? nullptr : &m_Positions[0]; }
+
+//-------------------------------------------------------------------------------------------------
+//      頂点数を取得します.
+//-------------------------------------------------------------------------------------------------
+u32 MorphEngine::GetVertexCount() const
+{ return u32( m_Positions.size() ); }
+
+//-------------------------------------------------------------------------------------------------
+//      直前の Update() で更新した頂点の範囲を取得します.
+//-------------------------------------------------------------------------------------------------
+const std::vector<MorphRange>& MorphEngine::GetDirtyRanges() const
+{ return m_DirtyRanges; }
+
+//-------------------------------------------------------------------------------------------------
+//      更新した範囲の位置座標をコピーします.
+//-------------------------------------------------------------------------------------------------
+u32 MorphEngine::CopyPositions( void* pDst, u32 stride ) const
+{
+    if ( pDst == nullptr || stride < sizeof(Vector3) )
+    { return 0; }
+
+    auto pBytes = static_cast<u8*>( pDst );
+    u32  count  = 0;
+
+    for( size_t i=0; i<m_DirtyRanges.size(); ++i )
+    {
+        auto begin = m_DirtyRanges[i].Offset;
+        auto end   = begin + m_DirtyRanges[i].Count;
+
+        for( auto j=begin; j<end; ++j )
+        { memcpy( pBytes + size_t(j) * stride, &m_Positions[j], sizeof(Vector3) ); }
+
+        count += m_DirtyRanges[i].Count;
+    }
+
+    return count;
+}
+
+} // namespace asdx
@@ -0,0 +1,844 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxPmdPhysics.cpp
+// Desc : Position Based Dynamics Module for PMD Rigid Bodies.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxPmdPhysics.h>
+#include <asdxLogger.h>
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <cmath>
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------------
+// Constant Values
+//-------------------------------------------------------------------------------------------------
+static const u32 kMaxStepCount  = 4;        // 1回の更新で進める最大ステップ数(超過分は切り捨てる).
+static const f32 kEpsilon       = 1e-6f;    // ゼロ除算を避けるための閾値.
+
+//-------------------------------------------------------------------------------------------------
+//      行列の平行移動成分を取得します.
+//-------------------------------------------------------------------------------------------------
+inline asdx::Vector3 GetTranslation( const asdx::Matrix& value )
+{ return asdx::Vector3( value._41, value._42, value._43 ); }
+
+//-------------------------------------------------------------------------------------------------
+//      a を b に向ける回転行列を求めます.
+//-------------------------------------------------------------------------------------------------
+asdx::Matrix RotationBetween( const asdx::Vector3& a, const asdx::Vector3& b )
+{
+    auto axis  = asdx::Vector3::Cross( a, b );
+    auto s     = axis.Length();
+    auto angle = atan2f( s, asdx::Vector3::Dot( a, b ) );
+    if ( s < kEpsilon || angle < kEpsilon )
+    { return asdx::Matrix::CreateIdentity(); }
+
+    return asdx::Matrix::CreateFromAxisAngle( axis / s, angle );
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// WorkerPool class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class WorkerPool
+{
+public:
+    //---------------------------------------------------------------------------------------------
+    //      インスタンスを取得します.
+    //---------------------------------------------------------------------------------------------
+    static WorkerPool& GetInstance()
+    {
+        static WorkerPool s_Instance;
+        return s_Instance;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //      呼び出し元とワーカースレッドで同じ処理を実行し, 全て終わるまで待機します.
+    //---------------------------------------------------------------------------------------------
+    void Run( u32 workerCount, const std::function<void()>& job )
+    {
+        // 同時に呼び出された場合は順番に処理する.
+        std::lock_guard<std::mutex> runLock( m_RunMutex );
+
+        {
+            std::lock_guard<std::mutex> lock( m_Mutex );
+
+            // 足りない分だけ作成し, 以降の呼び出しでは使い回す.
+            while( m_Threads.size() < workerCount )
+            {
+                auto index = u32( m_Threads.size() );
+                m_Threads.emplace_back( [this, index]() { WorkerMain( index ); } );
+            }
+
+            m_pJob        = &job;
+            m_ActiveCount = workerCount;
+            m_Pending     = workerCount;
+            m_Generation++;
+        }
+        m_WakeUp.notify_all();
+
+        job();
+
+        std::unique_lock<std::mutex> lock( m_Mutex );
+        m_Done.wait( lock, [this]() { return m_Pending == 0; } );
+        m_pJob = nullptr;
+    }
+
+private:
+    std::mutex                      m_RunMutex;     //!< Run() の排他制御です.
+    std::mutex                      m_Mutex;        //!< 以下のメンバーの排他制御です.
+    std::condition_variable         m_WakeUp;       //!< 処理の開始を通知します.
+    std::condition_variable         m_Done;         //!< 処理の完了を通知します.
+    std::vector<std::thread>        m_Threads;      //!< ワーカースレッドです.
+    const std::function<void()>*    m_pJob;         //!< 実行する処理です.
+    u32                             m_ActiveCount;  //!< 今回の処理に参加するワーカー数です.
+    u32                             m_Pending;      //!< 処理が終わっていないワーカー数です.
+    u64                             m_Generation;   //!< 処理の通し番号です.
+    bool                            m_Quit;         //!< 終了要求です.
+
+    //---------------------------------------------------------------------------------------------
+    //      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    WorkerPool()
+    : m_pJob        ( nullptr )
+    , m_ActiveCount ( 0 )
+    , m_Pending     ( 0 )
+    , m_Generation  ( 0 )
+    , m_Quit        ( false )
+    { /* DO_NOTHING */ }
+
+    //---------------------------------------------------------------------------------------------
+    //      デストラクタです.
+    //---------------------------------------------------------------------------------------------
+    ~WorkerPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock( m_Mutex );
+            m_Quit = true;
+        }
+        m_WakeUp.notify_all();
+
+        for( auto& thread : m_Threads )
+        { thread.join(); }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //      ワーカースレッドのメインループです.
+    //---------------------------------------------------------------------------------------------
+    void WorkerMain( u32 index )
+    {
+        u64 generation = 0;
+
+        for( ;; )
+        {
+            const std::function<void()>* pJob = nullptr;
+            {
+                std::unique_lock<std::mutex> lock( m_Mutex );
+                m_WakeUp.wait( lock, [&]()
+                { return m_Quit || ( m_Generation != generation && index < m_ActiveCount ); } );
+
+                if ( m_Quit )
+                { return; }
+
+                generation = m_Generation;
+                pJob       = m_pJob;
+            }
+
+            ( *pJob )();
+
+            {
+                std::lock_guard<std::mutex> lock( m_Mutex );
+                if ( --m_Pending == 0 )
+                { m_Done.notify_one(); }
+            }
+        }
+    }
+};
+
+} // namespace /* anonymous */
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// PmdPhysics class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+//-------------------------------------------------------------------------------------------------
+//      コンストラクタです.
+//-------------------------------------------------------------------------------------------------
+PmdPhysics::PmdPhysics()
+: m_Gravity         ( 0.0f, -98.0f, 0.0f )
+, m_TimeStep        ( 1.0f / 60.0f )
+, m_SubStepCount    ( 2 )
+, m_IterationCount  ( 4 )
+, m_Accumulator     ( 0.0f )
+, m_StepCount       ( 0 )
+, m_Deterministic   ( false )
+, m_IsReset         ( true )
+{ /* DO_NOTHING */ }
+
+//-------------------------------------------------------------------------------------------------
+//      デストラクタです.
+//-------------------------------------------------------------------------------------------------
+PmdPhysics::~PmdPhysics()
+{ Term(); }
+
+//-------------------------------------------------------------------------------------------------
+//      初期化処理を行います.
+//-------------------------------------------------------------------------------------------------
+bool PmdPhysics::Init( const ResPmd& pmd )
+{
+    Term();
+
+    auto boneCount = u32( pmd.Bones.size() );
+    auto bodyCount = u32( pmd.RigidBodies.size() );
+    if ( boneCount == 0 )
+    {
+        ELOG( "Error : Invalid Argument." );
+        return false;
+    }
+
+    // 親から順に処理できるようにボーンを並べる.
+    m_BoneParents.resize( boneCount );
+    for( u32 i=0; i<boneCount; ++i )
+    {
+        auto parent = pmd.Bones[i].ParentIndex;
+        m_BoneParents[i] = ( parent < boneCount && parent != i ) ? parent : U32_MAX;
+    }
+
+    {
+        std::vector<u8> visited( boneCount, 0 );
+        m_BoneOrder.reserve( boneCount );
+        while( m_BoneOrder.size() < boneCount )
+        {
+            auto count = m_BoneOrder.size();
+            for( u32 i=0; i<boneCount; ++i )
+            {
+                auto parent = m_BoneParents[i];
+                if ( visited[i] == 0 && ( parent == U32_MAX || visited[parent] != 0 ) )
+                {
+                    visited[i] = 1;
+                    m_BoneOrder.push_back( i );
+                }
+            }
+
+            if ( count == m_BoneOrder.size() )
+            {
+                ELOG( "Error : Bone Hierarchy Is Cyclic." );
+                Term();
+                return false;
+            }
+        }
+    }
+
+    m_BoneBodies.resize( boneCount, U32_MAX );
+    m_BoneDeltas.resize( boneCount );
+    m_BoneDirty .resize( boneCount, 0 );
+
+    // 剛体を粒子に変換する.
+    m_Bodies.resize( bodyCount );
+    m_Particles.Resize( bodyCount );
+    m_AnimPositions    .resize( bodyCount );
+    m_PrevAnimPositions.resize( bodyCount );
+
+    for( u32 i=0; i<bodyCount; ++i )
+    {
+        const auto& src  = pmd.RigidBodies[i];
+        auto&       body = m_Bodies[i];
+
+        body.Bone    = ( src.RelationBoneIndex < boneCount ) ? src.RelationBoneIndex : 0;
+        body.Type    = Min<u32>( src.Type, PMD_RIGIDBODY_TYPE_PHYSICS_FLLOW_POSITION );
+        body.Group   = u16( 1u << ( src.GroupIndex & 0xf ) );
+        body.Mask    = src.GroupTarget;
+        body.Parent  = U32_MAX;
+        body.Damping = Clamp( src.DampingTranslate, 0.0f, 1.0f );
+        body.Offset  = Matrix::CreateRotationX( src.Angle.x )
+                     * Matrix::CreateRotationY( src.Angle.y )
+                     * Matrix::CreateRotationZ( src.Angle.z )
+                     * Matrix::CreateTranslation( src.Position );
+
+        // 形状は半径と軸で表す. 箱は最も長い軸に沿ったカプセルとみなす.
+        auto radius = src.ShapeSize.x;
+        body.Axis   = Vector3( 0.0f, 0.0f, 0.0f );
+        if ( src.ShapeType == PMD_COLLISION_SHAPE_TYPE_CAPSULE )
+        {
+            body.Axis = Vector3( 0.0f, src.ShapeSize.y * 0.5f, 0.0f );
+        }
+        else if ( src.ShapeType == PMD_COLLISION_SHAPE_TYPE_BOX )
+        {
+            const auto& size = src.ShapeSize;
+            if ( size.x >= size.y && size.x >= size.z )
+            {
+                radius = Max( size.y, size.z );
+                body.Axis = Vector3( size.x - radius, 0.0f, 0.0f );
+            }
+            else if ( size.y >= size.z )
+            {
+                radius = Max( size.x, size.z );
+                body.Axis = Vector3( 0.0f, size.y - radius, 0.0f );
+            }
+            else
+            {
+                radius = Max( size.x, size.y );
+                body.Axis = Vector3( 0.0f, 0.0f, size.z - radius );
+            }
+        }
+
+        auto dynamic = ( body.Type != PMD_RIGIDBODY_TYPE_FLLOW_BONE );
+        m_Particles.Radius [i] = Max( radius, 0.0f );
+        m_Particles.InvMass[i] = ( !dynamic ) ? 0.0f : ( src.Mass > 0.0f ) ? 1.0f / src.Mass : 1.0f;
+
+        if ( dynamic )
+        {
+            if ( m_BoneBodies[body.Bone] == U32_MAX )
+            { m_BoneBodies[body.Bone] = i; }
+        }
+        else
+        {
+            m_Colliders.push_back( i );
+        }
+    }
+
+    m_ColliderPoints    .resize( m_Colliders.size() * 2 );
+    m_PrevColliderPoints.resize( m_Colliders.size() * 2 );
+
+    // ジョイントを距離拘束と角度制限に変換する.
+    std::vector<Vector3> bindPositions( bodyCount );
+    for( u32 i=0; i<bodyCount; ++i )
+    {
+        const auto& body = m_Bodies[i];
+        auto world = body.Offset * Matrix::CreateTranslation( pmd.Bones[body.Bone].Position );
+        bindPositions[i] = GetTranslation( world );
+    }
+
+    m_Joints.reserve( pmd.Joints.size() );
+    for( size_t i=0; i<pmd.Joints.size(); ++i )
+    {
+        const auto& src = pmd.Joints[i];
+        if ( src.RigidBodyA >= bodyCount || src.RigidBodyB >= bodyCount || src.RigidBodyA == src.RigidBodyB )
+        { continue; }
+
+        if ( m_Particles.InvMass[src.RigidBodyA] <= 0.0f && m_Particles.InvMass[src.RigidBodyB] <= 0.0f )
+        { continue; }
+
+        // ボーンの書き戻しで回転の基準とする剛体.
+        auto& body = m_Bodies[src.RigidBodyB];
+        if ( body.Parent  == U32_MAX )
+        { body.Parent  = src.RigidBodyA; }
+
+        auto stiffness = Max( Max( src.SpringPosition.x, src.SpringPosition.y ), src.SpringPosition.z );
+
+        auto limit = 0.0f;
+        for( auto j=0; j<2; ++j )
+        {
+            limit = Max( limit, fabsf( src.LimitAngle[j].x ) );
+            limit = Max( limit, fabsf( src.LimitAngle[j].y ) );
+            limit = Max( limit, fabsf( src.LimitAngle[j].z ) );
+        }
+
+        Joint joint;
+        joint.A          = src.RigidBodyA;
+        joint.B          = src.RigidBodyB;
+        joint.RestLength = Vector3::Distance( bindPositions[joint.A], bindPositions[joint.B] );
+        joint.Compliance = ( stiffness > kEpsilon ) ? 1.0f / stiffness : 0.0f;
+        joint.CosLimit   = ( limit < F_PI ) ? cosf( limit ) : -2.0f;
+        joint.SinLimit   = ( limit < F_PI ) ? sinf( limit ) :  0.0f;
+        joint.Lambda     = 0.0f;
+        m_Joints.push_back( joint );
+    }
+
+    // 粒子ごとに衝突判定を行うボーン追従剛体を絞り込んでおく.
+    m_ContactOffsets.resize( bodyCount + 1, 0 );
+    for( u32 i=0; i<bodyCount; ++i )
+    {
+        m_ContactOffsets[i] = u32( m_ContactColliders.size() );
+        if ( m_Particles.InvMass[i] <= 0.0f )
+        { continue; }
+
+        const auto& body = m_Bodies[i];
+        for( u32 j=0; j<u32( m_Colliders.size() ); ++j )
+        {
+            auto index = m_Colliders[j];
+            const auto& other = m_Bodies[index];
+
+            if ( ( body.Mask & other.Group ) == 0 || ( other.Mask & body.Group ) == 0 )
+            { continue; }
+
+            if ( other.Bone == body.Bone || index == body.Parent )
+            { continue; }
+
+            m_ContactColliders.push_back( j );
+        }
+    }
+    m_ContactOffsets[bodyCount] = u32( m_ContactColliders.size() );
+
+    SetTimeStep( m_TimeStep, m_SubStepCount, m_IterationCount );
+    m_IsReset = true;
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      終了処理を行います.
+//-------------------------------------------------------------------------------------------------
+void PmdPhysics::Term()
+{
+    m_Particles.Resize( 0 );
+    m_Bodies            .clear();
+    m_Joints            .clear();
+    m_Colliders         .clear();
+    m_ContactOffsets    .clear();
+    m_ContactColliders  .clear();
+    m_BoneParents       .clear();
+    m_BoneOrder         .clear();
+    m_BoneBodies        .clear();
+    m_BoneDeltas        .clear();
+    m_BoneDirty         .clear();
+    m_AnimPositions     .clear();
+    m_PrevAnimPositions .clear();
+    m_ColliderPoints    .clear();
+    m_PrevColliderPoints.clear();
+
+    m_Accumulator = 0.0f;
+    m_StepCount   = 0;
+    m_IsReset     = true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      粒子をボーンの姿勢の位置に戻します.
+//-------------------------------------------------------------------------------------------------
+void PmdPhysics::Reset( const Matrix* pBoneTransforms )
+{
+    if ( pBoneTransforms == nullptr )
+    { return; }
+
+    UpdateAnimPositions( pBoneTransforms );
+
+    m_PrevAnimPositions  = m_AnimPositions;
+    m_PrevColliderPoints = m_ColliderPoints;
+
+    auto& p = m_Particles;
+    for( size_t i=0; i<m_AnimPositions.size(); ++i )
+    {
+        p.PosX[i] = p.PrevX[i] = m_AnimPositions[i].x;
+        p.PosY[i] = p.PrevY[i] = m_AnimPositions[i].y;
+        p.PosZ[i] = p.PrevZ[i] = m_AnimPositions[i].z;
+    }
+
+    m_Accumulator = 0.0f;
+    m_IsReset     = false;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      重力加速度を設定します.
+//-------------------------------------------------------------------------------------------------
+void PmdPhysics::SetGravity( const Vector3& value )
+{ m_Gravity = value; }
+
+//-------------------------------------------------------------------------------------------------
+//      固定時間ステップを設定します.
+//-------------------------------------------------------------------------------------------------
+void PmdPhysics::SetTimeStep( f32 step, u32 subStepCount, u32 iterationCount )
+{
+    m_TimeStep       = Max( step, kEpsilon );
+    m_SubStepCount   = Max( subStepCount, 1u );
+    m_IterationCount = Max( iterationCount, 1u );
+
+    // 移動減衰はサブステップあたりの速度の保持率にしておく.
+    auto h = m_TimeStep / f32( m_SubStepCount );
+    for( size_t i=0; i<m_Bodies.size(); ++i )
+    { m_Particles.Damping[i] = powf( 1.0f - m_Bodies[i].Damping, h ); }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      決定論的モードを設定します.
+//-------------------------------------------------------------------------------------------------
+void PmdPhysics::SetDeterministic( bool enable )
+{
+    m_Deterministic = enable;
+    m_Accumulator   = 0.0f;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      シミュレーションを進め, 結果をボーンに書き戻します.
+//-------------------------------------------------------------------------------------------------
+void PmdPhysics::Update( f32 elapsedSec, Matrix* pBoneTransforms )
+{
+    m_StepCount = 0;
+
+    if ( pBoneTransforms == nullptr || m_Bodies.empty() )
+    { return; }
+
+    if ( m_IsReset )
+    { Reset( pBoneTransforms ); }
+
+    // m_PrevAnimPositions は最後にステップを進めた時点の姿勢のまま残しておく.
+    UpdateAnimPositions( pBoneTransforms );
+
+    u32 stepCount = 1;
+    if ( !m_Deterministic )
+    {
+        m_Accumulator += Max( elapsedSec, 0.0f );
+        stepCount = u32( m_Accumulator / m_TimeStep );
+        m_Accumulator -= f32( stepCount ) * m_TimeStep;
+
+        if ( stepCount > kMaxStepCount )
+        {
+            stepCount     = kMaxStepCount;
+            m_Accumulator = 0.0f;
+        }
+    }
+
+    // アニメーション姿勢はサブステップごとに前回の姿勢から補間する.
+    auto total = f32( stepCount * m_SubStepCount );
+    for( u32 i=0; i<stepCount * m_SubStepCount; ++i )
+    { SubStep( f32( i + 1 ) / total ); }
+
+    // ステップを進めなかった場合は補間元を更新しない(60Hz を超える更新で補間元を失わないため).
+    if ( stepCount > 0 )
+    {
+        m_PrevAnimPositions  = m_AnimPositions;
+        m_PrevColliderPoints = m_ColliderPoints;
+    }
+
+    m_StepCount = stepCount;
+
+    WriteBack( pBoneTransforms );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      直前の更新で進めたステップ数を取得します.
+//-------------------------------------------------------------------------------------------------
+u32 PmdPhysics::GetStepCount() const
+{ return m_StepCount; }
+
+//-------------------------------------------------------------------------------------------------
+//      粒子数を取得します.
+//-------------------------------------------------------------------------------------------------
+u32 PmdPhysics::GetParticleCount() const
+{ return u32( m_Bodies.size() ); }
+
+//-------------------------------------------------------------------------------------------------
+//      粒子の位置座標を取得します.
+//-------------------------------------------------------------------------------------------------
+Vector3 PmdPhysics::GetPosition( u32 index ) const
+{
+    assert( index < m_Bodies.size() );
+    return Vector3( m_Particles.PosX[index], m_Particles.PosY[index], m_Particles.PosZ[index] );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      複数のキャラクターのシミュレーションを並列で進めます.
+//-------------------------------------------------------------------------------------------------
+void PmdPhysics::UpdateBatch
+(
+    PmdPhysics* const*  ppPhysics,
+    Matrix* const*      ppBoneTransforms,
+    u32                 count,
+    f32                 elapsedSec,
+    u32                 threadCount
+)
+{
+    if ( ppPhysics == nullptr || ppBoneTransforms == nullptr || count == 0 )
+    { return; }
+
+    if ( threadCount == 0 )
+    { threadCount = Max( std::thread::hardware_concurrency(), 1u ); }
+    threadCount = Min( threadCount, count );
+
+    std::atomic<u32> next( 0 );
+
+    std::function<void()> worker = [&]()
+    {
+        for( auto i = next++; i < count; i = next++ )
+        {
+            if ( ppPhysics[i] != nullptr )
+            { ppPhysics[i]->Update( elapsedSec, ppBoneTransforms[i] ); }
+        }
+    };
+
+    if ( threadCount == 1 )
+    {
+        worker();
+        return;
+    }
+
+    // 毎フレームのスレッド生成を避けるため, 常駐するワーカースレッドで処理する.
+    WorkerPool::GetInstance().Run( threadCount - 1, worker );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      アニメーション姿勢での剛体の位置を更新します.
+//-------------------------------------------------------------------------------------------------
+void PmdPhysics::UpdateAnimPositions( const Matrix* pBoneTransforms )
+{
+    for( size_t i=0; i<m_Bodies.size(); ++i )
+    {
+        const auto& body = m_Bodies[i];
+        m_AnimPositions[i] = GetTranslation( body.Offset * pBoneTransforms[body.Bone] );
+    }
+
+    for( size_t i=0; i<m_Colliders.size(); ++i )
+    {
+        const auto& body = m_Bodies[m_Colliders[i]];
+        auto world = body.Offset * pBoneTransforms[body.Bone];
+        auto axis  = Vector3::TransformNormal( body.Axis, world );
+        auto pos   = GetTranslation( world );
+
+        m_ColliderPoints[i * 2 + 0] = pos - axis;
+        m_ColliderPoints[i * 2 + 1] = pos + axis;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      サブステップを1回進めます.
+//-------------------------------------------------------------------------------------------------
+void PmdPhysics::SubStep( f32 ratio )
+{
+    auto& p = m_Particles;
+    auto  h = m_TimeStep / f32( m_SubStepCount );
+    auto  n = m_Bodies.size();
+
+    auto gx = m_Gravity.x * h * h;
+    auto gy = m_Gravity.y * h * h;
+    auto gz = m_Gravity.z * h * h;
+
+    // 位置を予測する. ボーン追従の粒子はアニメーション姿勢を補間した位置に置く.
+    for( size_t i=0; i<n; ++i )
+    {
+        auto x = p.PosX[i];
+        auto y = p.PosY[i];
+        auto z = p.PosZ[i];
+
+        if ( p.InvMass[i] > 0.0f )
+        {
+            auto d = p.Damping[i];
+            p.PosX[i] = x + ( x - p.PrevX[i] ) * d + gx;
+            p.PosY[i] = y + ( y - p.PrevY[i] ) * d + gy;
+            p.PosZ[i] = z + ( z - p.PrevZ[i] ) * d + gz;
+        }
+        else
+        {
+            auto pos = Vector3::Lerp( m_PrevAnimPositions[i], m_AnimPositions[i], ratio );
+            p.PosX[i] = pos.x;
+            p.PosY[i] = pos.y;
+            p.PosZ[i] = pos.z;
+        }
+
+        p.PrevX[i] = x;
+        p.PrevY[i] = y;
+        p.PrevZ[i] = z;
+    }
+
+    for( size_t i=0; i<m_Joints.size(); ++i )
+    { m_Joints[i].Lambda = 0.0f; }
+
+    for( u32 i=0; i<m_IterationCount; ++i )
+    {
+        SolveJoints( h, ratio );
+        SolveCollisions( ratio );
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ジョイントの拘束を解きます.
+//-------------------------------------------------------------------------------------------------
+void PmdPhysics::SolveJoints( f32 h, f32 ratio )
+{
+    auto& p = m_Particles;
+
+    for( size_t i=0; i<m_Joints.size(); ++i )
+    {
+        auto& joint = m_Joints[i];
+        auto a = joint.A;
+        auto b = joint.B;
+
+        auto wa = p.InvMass[a];
+        auto wb = p.InvMass[b];
+        auto w  = wa + wb;
+
+        auto dx = p.PosX[b] - p.PosX[a];
+        auto dy = p.PosY[b] - p.PosY[a];
+        auto dz = p.PosZ[b] - p.PosZ[a];
+        auto length = sqrtf( dx * dx + dy * dy + dz * dz );
+        if ( length < kEpsilon )
+        { continue; }
+
+        auto inv = 1.0f / length;
+        dx *= inv;
+        dy *= inv;
+        dz *= inv;
+
+        // XPBD の距離拘束.
+        auto alpha  = joint.Compliance / ( h * h );
+        auto c      = length - joint.RestLength;
+        auto lambda = ( -c - alpha * joint.Lambda ) / ( w + alpha );
+        joint.Lambda += lambda;
+
+        p.PosX[a] -= dx * lambda * wa;
+        p.PosY[a] -= dy * lambda * wa;
+        p.PosZ[a] -= dz * lambda * wa;
+        p.PosX[b] += dx * lambda * wb;
+        p.PosY[b] += dy * lambda * wb;
+        p.PosZ[b] += dz * lambda * wb;
+
+        if ( joint.CosLimit < -1.0f )
+        { continue; }
+
+        // アニメーション姿勢の向きを中心とした円錐に収める.
+        auto target = Vector3::Lerp( m_PrevAnimPositions[b], m_AnimPositions[b], ratio )
+                    - Vector3::Lerp( m_PrevAnimPositions[a], m_AnimPositions[a], ratio );
+        auto targetLength = target.Length();
+        if ( targetLength < kEpsilon )
+        { continue; }
+        target /= targetLength;
+
+        auto dir = Vector3( p.PosX[b] - p.PosX[a], p.PosY[b] - p.PosY[a], p.PosZ[b] - p.PosZ[a] );
+        length = dir.Length();
+        if ( length < kEpsilon )
+        { continue; }
+        dir /= length;
+
+        auto cosAngle = Vector3::Dot( dir, target );
+        if ( cosAngle >= joint.CosLimit )
+        { continue; }
+
+        auto perp = dir - target * cosAngle;
+        auto perpLength = perp.Length();
+        if ( perpLength < kEpsilon )
+        { continue; }
+        perp /= perpLength;
+
+        auto goal = ( target * joint.CosLimit + perp * joint.SinLimit ) * length;
+        auto diff = goal - dir * length;
+
+        p.PosX[a] -= diff.x * ( wa / w );
+        p.PosY[a] -= diff.y * ( wa / w );
+        p.PosZ[a] -= diff.z * ( wa / w );
+        p.PosX[b] += diff.x * ( wb / w );
+        p.PosY[b] += diff.y * ( wb / w );
+        p.PosZ[b] += diff.z * ( wb / w );
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      衝突を解決します.
+//-------------------------------------------------------------------------------------------------
+void PmdPhysics::SolveCollisions( f32 ratio )
+{
+    auto& p = m_Particles;
+
+    for( size_t i=0; i<m_Bodies.size(); ++i )
+    {
+        auto begin = m_ContactOffsets[i];
+        auto end   = m_ContactOffsets[i + 1];
+
+        for( auto j=begin; j<end; ++j )
+        {
+            auto index = m_ContactColliders[j];
+            auto p0 = Vector3::Lerp( m_PrevColliderPoints[index * 2 + 0], m_ColliderPoints[index * 2 + 0], ratio );
+            auto p1 = Vector3::Lerp( m_PrevColliderPoints[index * 2 + 1], m_ColliderPoints[index * 2 + 1], ratio );
+
+            // カプセルの軸上の最近接点.
+            auto pos = Vector3( p.PosX[i], p.PosY[i], p.PosZ[i] );
+            auto seg = p1 - p0;
+            auto lengthSq = Vector3::Dot( seg, seg );
+            auto t = ( lengthSq > kEpsilon ) ? Saturate( Vector3::Dot( pos - p0, seg ) / lengthSq ) : 0.0f;
+
+            auto diff = pos - ( p0 + seg * t );
+            auto distSq = Vector3::Dot( diff, diff );
+            auto radius = p.Radius[i] + p.Radius[m_Colliders[index]];
+            if ( distSq >= radius * radius )
+            { continue; }
+
+            // 軸上に重なっている場合は軸に垂直な方向へ押し出す(軸が無い場合は上方向).
+            auto dist   = sqrtf( distSq );
+            auto normal = diff;
+            auto length = dist;
+            if ( length < kEpsilon )
+            {
+                normal = Vector3::Cross( seg, Vector3( 0.0f, 0.0f, 1.0f ) );
+                length = normal.Length();
+                if ( length < kEpsilon )
+                {
+                    normal = Vector3( 0.0f, 1.0f, 0.0f );
+                    length = 1.0f;
+                }
+            }
+
+            auto push = normal * ( ( radius - dist ) / length );
+
+            p.PosX[i] += push.x;
+            p.PosY[i] += push.y;
+            p.PosZ[i] += push.z;
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      結果をボーンに書き戻します.
+//-------------------------------------------------------------------------------------------------
+void PmdPhysics::WriteBack( Matrix* pBoneTransforms )
+{
+    const auto& p = m_Particles;
+
+    // 親から順に処理し, 剛体の無い子ボーンには親のワールド空間での変化量を伝搬する.
+    for( size_t i=0; i<m_BoneOrder.size(); ++i )
+    {
+        auto bone   = m_BoneOrder[i];
+        auto parent = m_BoneParents[bone];
+        auto index  = m_BoneBodies[bone];
+
+        m_BoneDirty[bone] = 0;
+
+        if ( index != U32_MAX )
+        {
+            const auto& body = m_Bodies[index];
+            auto& world = pBoneTransforms[bone];
+
+            auto sim  = Vector3( p.PosX[index], p.PosY[index], p.PosZ[index] );
+            auto anim = m_AnimPositions[index];
+            auto head = GetTranslation( world );
+
+            // ジョイントで繋がる剛体からの向きの変化を回転とする.
+            auto rotation = Matrix::CreateIdentity();
+            if ( body.Parent != U32_MAX )
+            {
+                auto parentSim = Vector3(
+                    p.PosX[body.Parent],
+                    p.PosY[body.Parent],
+                    p.PosZ[body.Parent] );
+                rotation = RotationBetween( anim - m_AnimPositions[body.Parent], sim - parentSim );
+            }
+
+            auto pivot = ( body.Type == PMD_RIGIDBODY_TYPE_PHYSICS_FLLOW_POSITION )
+                ? head
+                : sim - Vector3::TransformNormal( anim - head, rotation );
+
+            auto delta = Matrix::CreateTranslation( -head ) * rotation * Matrix::CreateTranslation( pivot );
+
+            m_BoneDeltas[bone] = delta;
+            m_BoneDirty [bone] = 1;
+            world = world * delta;
+        }
+        else if ( parent != U32_MAX && m_BoneDirty[parent] != 0 )
+        {
+            m_BoneDeltas[bone] = m_BoneDeltas[parent];
+            m_BoneDirty [bone] = 1;
+            pBoneTransforms[bone] = pBoneTransforms[bone] * m_BoneDeltas[bone];
+        }
+    }
+}
+
+} // namespace asdx
@@ -10,6 +10,297 @@
 #include <asdxResPMD.h>
 #include <asdxLogger.h>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cwchar>
+#include <algorithm>
+
+
+namespace /* anonymous */ {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// PmdReader class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class PmdReader
+{
+public:
+    //---------------------------------------------------------------------------------------------
+    //      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    PmdReader( const u8* pBuffer, size_t size )
+    : m_pBuffer ( pBuffer )
+    , m_Size    ( size )
+    , m_Offset  ( 0 )
+    { /* DO_NOTHING */ }
+
+    //---------------------------------------------------------------------------------------------
+    //      値を読み込みます.
+    //---------------------------------------------------------------------------------------------
+    template<typename T>
+    bool Read( T& value )
+    {
+        if ( GetRemain() < sizeof(T) )
+        { return false; }
+
+        memcpy( &value, m_pBuffer + m_Offset, sizeof(T) );
+        m_Offset += sizeof(T);
+        return true;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //      要素数を残りサイズでチェックしてから配列を一括で読み込みます.
+    //---------------------------------------------------------------------------------------------
+    template<typename T>
+    bool ReadArray( size_t count, std::vector<T>& result )
+    {
+        if ( count > GetRemain() / sizeof(T) )
+        { return false; }
+
+        result.resize( count );
+        if ( count > 0 )
+        { memcpy( static_cast<void*>( &result[0] ), m_pBuffer + m_Offset, sizeof(T) * count ); }
+
+        m_Offset += sizeof(T) * count;
+        return true;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //      指定サイズを読み飛ばします.
+    //---------------------------------------------------------------------------------------------
+    bool Skip( size_t size )
+    {
+        if ( GetRemain() < size )
+        { return false; }
+
+        m_Offset += size;
+        return true;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //      残りサイズを取得します.
+    //---------------------------------------------------------------------------------------------
+    size_t GetRemain() const
+    { return m_Size - m_Offset; }
+
+private:
+    const u8*   m_pBuffer;
+    size_t      m_Size;
+    size_t      m_Offset;
+};
+
+//-------------------------------------------------------------------------------------------------
+//      NULL終端されていない可能性のある固定長文字列を変換します.
+//-------------------------------------------------------------------------------------------------
+template<size_t N>
+std::string ToString( const char8 (&value)[N] )
+{
+    size_t length = 0;
+    while( length < N && value[length] != '\0' )
+    { length++; }
+
+    return std::string( value, length );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      範囲外のボーン番号を補正します.
+//-------------------------------------------------------------------------------------------------
+void FixBoneReferences( asdx::ResPmd& pmd )
+{
+    // 従来は範囲外のボーン番号もそのまま読み込んでいたため, 読み込みを失敗させずに補正する.
+    auto boneCount = pmd.Bones.size();
+    if ( boneCount == 0 )
+    { return; }
+
+    // 頂点は先頭のボーンに割り当てる.
+    u32 count = 0;
+    for( auto& vertex : pmd.Vertices )
+    {
+        for( auto& index : vertex.BoneIndex )
+        {
+            if ( index >= boneCount )
+            {
+                index = 0;
+                count++;
+            }
+        }
+    }
+    if ( count > 0 )
+    { ILOG( "Warning : Vertex Bone Index Out Of Range. Replaced with 0. count = %u", count ); }
+
+    // 親ボーンは親無しとして扱う.
+    count = 0;
+    for( auto& bone : pmd.Bones )
+    {
+        if ( bone.ParentIndex != 0xFFFF && bone.ParentIndex >= boneCount )
+        {
+            bone.ParentIndex = 0xFFFF;
+            count++;
+        }
+    }
+    if ( count > 0 )
+    { ILOG( "Warning : Parent Bone Index Out Of Range. Treated as root. count = %u", count ); }
+
+    // IK と表示枠は補正できないため, 該当する要素を取り除く.
+    auto isInvalidIK = [boneCount]( const asdx::ResPmdIK& ik )
+    {
+        if ( ik.BoneIndex >= boneCount || ik.TargetBoneIndex >= boneCount )
+        { return true; }
+
+        for( auto index : ik.ChildBoneIndices )
+        {
+            if ( index >= boneCount )
+            { return true; }
+        }
+
+        return false;
+    };
+
+    auto ikCount = pmd.IKs.size();
+    pmd.IKs.erase( std::remove_if( pmd.IKs.begin(), pmd.IKs.end(), isInvalidIK ), pmd.IKs.end() );
+    if ( pmd.IKs.size() != ikCount )
+    { ILOG( "Warning : IK Bone Index Out Of Range. Removed. count = %u", u32( ikCount - pmd.IKs.size() ) ); }
+
+    auto labelCount = pmd.BoneLabelIndices.size();
+    pmd.BoneLabelIndices.erase(
+        std::remove_if( pmd.BoneLabelIndices.begin(), pmd.BoneLabelIndices.end(),
+            [boneCount]( const asdx::PMD_BONE_LABEL_INDEX& label ) { return label.BoneIndex >= boneCount; } ),
+        pmd.BoneLabelIndices.end() );
+    if ( pmd.BoneLabelIndices.size() != labelCount )
+    { ILOG( "Warning : Bone Label Index Out Of Range. Removed. count = %u", u32( labelCount - pmd.BoneLabelIndices.size() ) ); }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      データ間の参照番号が範囲内かどうかチェックします.
+//-------------------------------------------------------------------------------------------------
+bool CheckReferences( const asdx::ResPmd& pmd )
+{
+    auto vertexCount = pmd.Vertices.size();
+    auto boneCount   = pmd.Bones.size();
+
+    for( size_t i=0; i<pmd.Indices.size(); ++i )
+    {
+        if ( pmd.Indices[i] >= vertexCount )
+        {
+            ELOG( "Error : Vertex Index Out Of Range. index = %u", u32(i) );
+            return false;
+        }
+    }
+
+    for( size_t i=0; i<pmd.Vertices.size(); ++i )
+    {
+        const auto& vertex = pmd.Vertices[i];
+        if ( vertex.BoneIndex[0] >= boneCount || vertex.BoneIndex[1] >= boneCount )
+        {
+            ELOG( "Error : Vertex Bone Index Out Of Range. vertex = %u", u32(i) );
+            return false;
+        }
+    }
+
+    // マテリアルの頂点数はインデックス数の合計.
+    u64 materialIndexCount = 0;
+    for( size_t i=0; i<pmd.Materials.size(); ++i )
+    { materialIndexCount += pmd.Materials[i].VertexCount; }
+
+    if ( materialIndexCount > pmd.Indices.size() )
+    {
+        ELOG( "Error : Material Vertex Count Out Of Range." );
+        return false;
+    }
+
+    for( size_t i=0; i<pmd.Bones.size(); ++i )
+    {
+        const auto& bone = pmd.Bones[i];
+        if ( bone.ParentIndex != 0xFFFF && bone.ParentIndex >= boneCount )
+        {
+            ELOG( "Error : Parent Bone Index Out Of Range. bone = %u", u32(i) );
+            return false;
+        }
+    }
+
+    for( size_t i=0; i<pmd.IKs.size(); ++i )
+    {
+        const auto& ik = pmd.IKs[i];
+        if ( ik.BoneIndex >= boneCount || ik.TargetBoneIndex >= boneCount )
+        {
+            ELOG( "Error : IK Bone Index Out Of Range. ik = %u", u32(i) );
+            return false;
+        }
+
+        for( size_t j=0; j<ik.ChildBoneIndices.size(); ++j )
+        {
+            if ( ik.ChildBoneIndices[j] >= boneCount )
+            {
+                ELOG( "Error : IK Chain Bone Index Out Of Range. ik = %u", u32(i) );
+                return false;
+            }
+        }
+    }
+
+    // base 以外の表情の頂点番号は base 表情の頂点を指す.
+    size_t baseCount = 0;
+    for( size_t i=0; i<pmd.Morphes.size(); ++i )
+    {
+        const auto& morph = pmd.Morphes[i];
+        auto limit = ( morph.Type == 0 ) ? vertexCount : baseCount;
+
+        for( size_t j=0; j<morph.Vertices.size(); ++j )
+        {
+            if ( morph.Vertices[j].Index >= limit )
+            {
+                ELOG( "Error : Morph Vertex Index Out Of Range. morph = %u", u32(i) );
+                return false;
+            }
+        }
+
+        if ( morph.Type == 0 )
+        { baseCount = morph.Vertices.size(); }
+    }
+
+    for( size_t i=0; i<pmd.MorphLabelIndices.size(); ++i )
+    {
+        if ( pmd.MorphLabelIndices[i] >= pmd.Morphes.size() )
+        {
+            ELOG( "Error : Morph Label Index Out Of Range. label = %u", u32(i) );
+            return false;
+        }
+    }
+
+    for( size_t i=0; i<pmd.BoneLabelIndices.size(); ++i )
+    {
+        if ( pmd.BoneLabelIndices[i].BoneIndex >= boneCount )
+        {
+            ELOG( "Error : Bone Label Index Out Of Range. label = %u", u32(i) );
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      読み込み用にファイルを開きます.
+//-------------------------------------------------------------------------------------------------
+FILE* OpenFile( const char16* filename )
+{
+#if defined(_WIN32)
+    FILE* pFile = nullptr;
+    if ( _wfopen_s( &pFile, filename, L"rb" ) != 0 )
+    { return nullptr; }
+
+    return pFile;
+#else
+    // Windows 以外ではロケールに従ってマルチバイト文字列に変換してから開く.
+    std::string path( wcslen( filename ) * MB_CUR_MAX + 1, '\0' );
+    auto length = wcstombs( &path[0], filename, path.size() );
+    if ( length == size_t(-1) )
+    { return nullptr; }
+
+    path.resize( length );
+    return fopen( path.c_str(), "rb" );
+#endif
+}
+
+} // namespace /* anonymous */
 
 
 namespace asdx {
@@ -41,226 +332,297 @@ bool ResPmd::Load( const char16* filename )
         return false;
     }
 
-    FILE* pFile;
-    auto err = _wfopen_s( &pFile, filename, L"rb" );
-    if ( err != 0 )
+    FILE* pFile = OpenFile( filename );
+    if ( pFile == nullptr )
     {
-        ELOG( "Error : File Open Failed. filename = %s", filename );
+        ELOG( "Error : File Open Failed. filename = %ls", filename );
         return false;
     }
 
+    // ファイル全体を一括で読み込む.
+    std::vector<u8> buffer;
+    {
+        fseek( pFile, 0, SEEK_END );
+        auto size = ftell( pFile );
+        fseek( pFile, 0, SEEK_SET );
+
+        if ( size <= 0 )
+        {
+            ELOG( "Error : Invalid File. filename = %ls", filename );
+            fclose( pFile );
+            return false;
+        }
+
+        buffer.resize( size_t(size) );
+        if ( fread( &buffer[0], 1, buffer.size(), pFile ) != buffer.size() )
+        {
+            ELOG( "Error : File Read Failed. filename = %ls", filename );
+            fclose( pFile );
+            return false;
+        }
+    }
+
+    // ファイルを閉じる.
+    fclose( pFile );
+
+    if ( !Load( &buffer[0], buffer.size() ) )
+    {
+        ELOG( "Error : Invalid File. filename = %ls", filename );
+        return false;
+    }
+
+    // 正常終了.
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      メモリから読み込みを行います.
+//-------------------------------------------------------------------------------------------------
+bool ResPmd::Load( const u8* pBuffer, size_t size )
+{
+    Dispose();
+
+    if ( pBuffer == nullptr )
+    {
+        ELOG( "Error : Invalid Argument." );
+        return false;
+    }
+
+    PmdReader reader( pBuffer, size );
+
     // ヘッダ読み込み.
     PMD_HEADER header;
-    fread( &header, sizeof(header), 1, pFile );
+    if ( !reader.Read( header ) )
+    {
+        ELOG( "Error : Unexpected End of File." );
+        return false;
+    }
 
     // ファイルマジックをチェック.
     if ( header.Magic[0] != 'P' || header.Magic[1] != 'm' || header.Magic[2] != 'd' )
     {
-        ELOG( "Error : Invalid File. filename = %s", filename );
+        ELOG( "Error : Invalid File Magic." );
         return false;
     }
 
-    Name    = header.ModelName;
+    Name    = ToString( header.ModelName );
     Version = header.Version;
-    Comment = header.Comment;
+    Comment = ToString( header.Comment );
 
     // 頂点リストを読み込み.
     {
         u32 vertexCount = 0;
-        fread( &vertexCount, sizeof(vertexCount), 1, pFile );
-
-        Vertices.resize( vertexCount );
-
-        for( u32 i=0; i<vertexCount; ++i )
-        { fread( &Vertices[i], sizeof(PMD_VERTEX), 1, pFile ); }
+        if ( !reader.Read( vertexCount ) || !reader.ReadArray( vertexCount, Vertices ) )
+        {
+            ELOG( "Error : Invalid Vertex Section. count = %u", vertexCount );
+            Dispose();
+            return false;
+        }
     }
 
     // 頂点インデックスを読み込み.
     {
-        u32 vertexCount = 0;
-        fread( &vertexCount, sizeof(vertexCount), 1, pFile );
-
-        Indices.resize(vertexCount);
-
-        for( u32 i=0; i<vertexCount; ++i )
-        { fread( &Indices[i], sizeof(u16), 1, pFile ); }
+        u32 indexCount = 0;
+        if ( !reader.Read( indexCount ) || !reader.ReadArray( indexCount, Indices ) )
+        {
+            ELOG( "Error : Invalid Index Section. count = %u", indexCount );
+            Dispose();
+            return false;
+        }
     }
 
     // マテリアルを読み込み.
     {
         u32 materialCount = 0;
-        fread( &materialCount, sizeof(materialCount), 1, pFile );
-
-        Materials.resize( materialCount );
-
-        for( u32 i=0; i<materialCount; ++i )
-        { fread( &Materials[i], sizeof(PMD_MATERIAL), 1, pFile ); }
+        if ( !reader.Read( materialCount ) || !reader.ReadArray( materialCount, Materials ) )
+        {
+            ELOG( "Error : Invalid Material Section. count = %u", materialCount );
+            Dispose();
+            return false;
+        }
     }
 
     // ボーンデータを読み込み.
     {
         u16 boneCount = 0;
-        fread( &boneCount, sizeof(boneCount), 1, pFile );
-
-        Bones.resize( boneCount );
-
-        for( u16 i=0; i<boneCount; ++i )
-        { fread( &Bones[i], sizeof(PMD_BONE), 1, pFile ); }
+        if ( !reader.Read( boneCount ) || !reader.ReadArray( boneCount, Bones ) )
+        {
+            ELOG( "Error : Invalid Bone Section. count = %u", boneCount );
+            Dispose();
+            return false;
+        }
     }
 
     // IKデータを読み込み.
     {
         u16 count = 0;
-        fread( &count, sizeof(count), 1, pFile );
+        if ( !reader.Read( count ) || count > reader.GetRemain() / sizeof(PMD_IK) )
+        {
+            ELOG( "Error : Invalid IK Section. count = %u", count );
+            Dispose();
+            return false;
+        }
 
         IKs.resize( count );
 
         for( u32 i=0; i<count; ++i )
         {
             PMD_IK data;
-            fread( &data, sizeof(data), 1, pFile );
+            if ( !reader.Read( data ) || !reader.ReadArray( data.ChainCount, IKs[i].ChildBoneIndices ) )
+            {
+                ELOG( "Error : Invalid IK Section. index = %u", i );
+                Dispose();
+                return false;
+            }
 
             IKs[i].BoneIndex       = data.BoneIndex;
             IKs[i].TargetBoneIndex = data.TargetBoneIndex;
             IKs[i].RecursiveCount  = data.RecursiveCount;
             IKs[i].ControlWeight   = data.ControlWeight;
-
-            IKs[i].ChildBoneIndices.resize( data.ChainCount );
-
-            for( u32 j=0; j<data.ChainCount; ++j )
-            { fread( &IKs[i].ChildBoneIndices[j], sizeof(u16), 1, pFile ); }
         }
     }
 
     // モーフデータを読み込み.
     {
         u16 morphCount = 0;
-        fread( &morphCount, sizeof(morphCount), 1, pFile );
+        if ( !reader.Read( morphCount ) || morphCount > reader.GetRemain() / sizeof(PMD_MORPH) )
+        {
+            ELOG( "Error : Invalid Morph Section. count = %u", morphCount );
+            Dispose();
+            return false;
+        }
 
         Morphes.resize( morphCount );
 
         for( u16 i=0; i<morphCount; ++i )
         {
             PMD_MORPH morph;
-            fread( &morph, sizeof(morph), 1, pFile );
+            if ( !reader.Read( morph ) || !reader.ReadArray( morph.VertexCount, Morphes[i].Vertices ) )
+            {
+                ELOG( "Error : Invalid Morph Section. index = %u", i );
+                Dispose();
+                return false;
+            }
 
-            Morphes[i].Name = morph.Name;
+            Morphes[i].Name = ToString( morph.Name );
             Morphes[i].Type = morph.Type;
-
-            Morphes[i].Vertices.resize( morph.VertexCount );
-
-            for( u32 j=0; j<morph.VertexCount; ++j )
-            { fread( &Morphes[i].Vertices[j], sizeof(PMD_MORPH_VERTEX), 1, pFile ); }
         }
     }
 
     // 表情枠用表示リスト.
     {
         u8 count = 0;
-        fread( &count, sizeof(count), 1, pFile );
-
-        MorphLabelIndices.resize( count );
-
-        for( u8 i=0; i<count; ++i )
-        { fread( &MorphLabelIndices[i], sizeof(u16), 1, pFile ); }
+        if ( !reader.Read( count ) || !reader.ReadArray( count, MorphLabelIndices ) )
+        {
+            ELOG( "Error : Invalid Morph Label Section. count = %u", count );
+            Dispose();
+            return false;
+        }
     }
 
     // ボーン枠用枠名リスト.
     {
         u8 count = 0;
-        fread( &count, sizeof(count), 1, pFile );
+        if ( !reader.Read( count ) || count > reader.GetRemain() / 50 )
+        {
+            ELOG( "Error : Invalid Bone Label Section. count = %u", count );
+            Dispose();
+            return false;
+        }
 
         BoneLabels.resize( count );
 
         for( u32 i=0; i<count; ++i )
         {
-            char name[50];
-            fread( name, sizeof(char), 50, pFile );
+            char8 name[50];
+            reader.Read( name );
 
-            BoneLabels[i] = name;
+            BoneLabels[i] = ToString( name );
         }
     }
 
     // ボーン枠用表示リスト.
     {
         u32 count = 0;
-        fread( &count, sizeof(count), 1, pFile );
-
-        BoneLabelIndices.resize( count );
+        if ( !reader.Read( count ) || !reader.ReadArray( count, BoneLabelIndices ) )
+        {
+            ELOG( "Error : Invalid Bone Label Index Section. count = %u", count );
+            Dispose();
+            return false;
+        }
+    }
 
-        for( u32 i=0; i<count; ++i )
-        { fread( &BoneLabelIndices[i], sizeof(PMD_BONE_LABEL_INDEX), 1, pFile ); }
+    // 参照番号をチェック.
+    FixBoneReferences( *this );
+    if ( !CheckReferences( *this ) )
+    {
+        Dispose();
+        return false;
     }
 
+    // 以降は拡張データのため, 途中で終わっていても読み込めた所までを有効とする.
+    // ただし, 剛体とジョイントは対で使用するため, どちらかが不正な場合は両方とも破棄する.
+
     // 拡張データ ローカライズデータ.
-    if ( feof( pFile ) == 0 )
+    if ( reader.GetRemain() > 0 )
     {
         PMD_LOCALIZE_HEADER headerEn;
-        fread( &headerEn, sizeof(headerEn), 1, pFile );
+        if ( !reader.Read( headerEn ) )
+        { return true; }
 
         if ( headerEn.LocalizeFlag == 0x1 )
         {
-            //std::string modelName = headerEn.ModelName;
-            //std::string comment = headerEn.Comment;
-            //ILOGA( "ModelName[EN] : %s", modelName.c_str() );
-            //ILOGA( "Comment[EN] : %s", comment.c_str() );
-
-            for( size_t i=0; i<Bones.size(); ++i )
-            {
-                char boneName[20];
-                fread( boneName, sizeof(char), 20, pFile );
-                //ILOGA( "BoneName[EN] : %s", boneName );
-            }
-
-            for( size_t i=0; i<Morphes.size() - 1; ++i )
-            {
-                char morphName[20];
-                fread( morphName, sizeof(char), 20, pFile );
-                //ILOGA( "MorphName[EN] : %s", morphName );
-            }
-
-            for( size_t i=0; i<BoneLabels.size(); ++i )
-            {
-                char label[50];
-                fread( label, sizeof(char), 50, pFile );
-                //ILOGA( "BoneLabel[EN] : %s", label );
-            }
+            // 英名(ボーン名, base を除く表情名, ボーン枠名)は使用しないので読み飛ばす.
+            size_t morphCount = ( Morphes.empty() ) ? 0 : Morphes.size() - 1;
+            size_t skipSize   = Bones.size() * 20 + morphCount * 20 + BoneLabels.size() * 50;
+            if ( !reader.Skip( skipSize ) )
+            { return true; }
         }
     }
 
     // 拡張データ トゥーンテクスチャリスト.
-    if ( feof( pFile ) == 0 )
+    if ( reader.GetRemain() > 0 )
     {
-        fread( &ToonTextureList, sizeof(ToonTextureList), 1, pFile );
+        if ( !reader.Read( ToonTextureList ) )
+        { return true; }
     }
 
     // 拡張データ 剛体データ.
-    if ( feof( pFile ) == 0 )
+    if ( reader.GetRemain() > 0 )
     {
         u32 rigidBodyCount = 0;
-        fread( &rigidBodyCount, sizeof(rigidBodyCount), 1, pFile );
-
-        RigidBodies.resize( rigidBodyCount );
-
-        for( u32 i=0; i<rigidBodyCount; ++i )
-        { fread( &RigidBodies[i], sizeof(PMD_RIGIDBODY), 1, pFile ); }
+        if ( !reader.Read( rigidBodyCount ) || !reader.ReadArray( rigidBodyCount, RigidBodies ) )
+        {
+            ELOG( "Warning : Rigid Body Section is truncated. physics data is ignored. count = %u", rigidBodyCount );
+            RigidBodies.clear();
+            return true;
+        }
     }
 
     // 拡張データ ジョイントリスト.
-    if ( feof( pFile ) == 0 )
+    if ( reader.GetRemain() > 0 )
     {
         u32 jointCount = 0;
-        fread( &jointCount, sizeof(jointCount), 1, pFile );
-
-        Joints.resize( jointCount );
+        if ( !reader.Read( jointCount ) || !reader.ReadArray( jointCount, Joints ) )
+        {
+            ELOG( "Warning : Joint Section is truncated. physics data is ignored. count = %u", jointCount );
+            RigidBodies.clear();
+            Joints     .clear();
+            return true;
+        }
 
-        for( u32 i=0; i<jointCount; ++i )
-        { fread( &Joints[i], sizeof(PMD_PHYSICS_JOINT), 1, pFile ); }
+        for( size_t i=0; i<Joints.size(); ++i )
+        {
+            if ( Joints[i].RigidBodyA >= RigidBodies.size() || Joints[i].RigidBodyB >= RigidBodies.size() )
+            {
+                ELOG( "Warning : Joint Rigid Body Index Out Of Range. physics data is ignored. joint = %u", u32(i) );
+                RigidBodies.clear();
+                Joints     .clear();
+                return true;
+            }
+        }
     }
 
-    // ファイルを閉じる.
-    fclose( pFile );
-
     // 正常終了.
     return true;
 }
@@ -276,6 +638,9 @@ void ResPmd::Dispose()
     for( size_t i=0; i<Morphes.size(); ++i )
     { Morphes[i].Vertices.clear(); }
 
+    Version = 0.0f;
+    memset( &ToonTextureList, 0, sizeof(ToonTextureList) );
+
     Name     .clear();
     Comment  .clear();
     Vertices .clear();
@@ -122,4 +122,37 @@ ID3D12Resource* VertexBuffer::GetResource() const
 D3D12_VERTEX_BUFFER_VIEW VertexBuffer::GetView() const
 { return m_View; }
 
+//-------------------------------------------------------------------------------------------------
+//      メモリマッピングを行います.
+//-------------------------------------------------------------------------------------------------
+void* VertexBuffer::Map()
+{
+    if ( m_Resource.GetPtr() == nullptr )
+    { return nullptr; }
+
+    // CPUからは読み取らない.
+    D3D12_RANGE range = { 0, 0 };
+
+    void* pData;
+    auto hr = m_Resource->Map( 0, &range, &pData );
+    if ( FAILED( hr ) )
+    {
+        ELOG( "Error : ID3D12Resource::Map() Failed." );
+        return nullptr;
+    }
+
+    return pData;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      メモリマッピングを解除します.
+//-------------------------------------------------------------------------------------------------
+void VertexBuffer::Unmap()
+{
+    if ( m_Resource.GetPtr() == nullptr )
+    { return; }
+
+    m_Resource->Unmap( 0, nullptr );
+}
+
 } // namespace asdx
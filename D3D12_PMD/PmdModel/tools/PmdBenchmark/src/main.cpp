@@ -0,0 +1,784 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : main.cpp
+// Desc : PMD Loader, Morph and Physics Benchmark.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <cstdio>
+#include <cstring>
+#include <cstddef>
+#include <cmath>
+#include <vector>
+#include <chrono>
+#include <string>
+#include <algorithm>
+#include <asdxResPMD.h>
+#include <asdxPmdPhysics.h>
+#include <asdxMorphEngine.h>
+#include <asdxLogger.h>
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------------
+// Constant Values.
+//-------------------------------------------------------------------------------------------------
+static constexpr u32 LOAD_COUNT     = 50;       //!< 読み込み時間を計測する回数です.
+static constexpr u32 FUZZ_COUNT     = 100000;   //!< 破損データを読み込む回数です.
+static constexpr u32 CHARA_COUNT    = 64;       //!< 物理演算を比較するキャラクター数です.
+static constexpr u32 HAIR_COUNT     = 8;        //!< 物理演算用モデルの髪の房の数です.
+static constexpr u32 HAIR_LENGTH    = 6;        //!< 髪の房あたりのボーン数です.
+static constexpr u32 STEP_COUNT     = 600;      //!< 物理演算を進めるフレーム数です.
+static constexpr u32 MORPH_VERTICES = 60000;    //!< モーフ計測用モデルの頂点数です.
+static constexpr u32 FACE_VERTICES  = 4000;     //!< base 表情の頂点数です.
+static constexpr u32 FACE_MORPHS    = 64;       //!< base 以外の表情数です.
+static constexpr u32 MORPH_FRAMES   = 2000;     //!< モーフの計測フレーム数です.
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Random class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class Random
+{
+public:
+    explicit Random( u32 seed )
+    : m_State( seed )
+    { /* DO_NOTHING */ }
+
+    u32 GetAsU32()
+    {
+        m_State ^= m_State << 13;
+        m_State ^= m_State >> 17;
+        m_State ^= m_State << 5;
+        return m_State;
+    }
+
+    u32 GetAsU32( u32 maxi )
+    { return ( maxi == 0 ) ? 0 : GetAsU32() % maxi; }
+
+private:
+    u32 m_State;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ModelDesc structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct ModelDesc
+{
+    u32     VertexCount;        //!< 頂点数です.
+    u32     IndexCount;         //!< 頂点インデックス数です.
+    u16     BoneCount;          //!< ボーン数です.
+    u16     MorphCount;         //!< base を含む表情数です.
+    u32     RigidBodyCount;     //!< 剛体数です.
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ModelData structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct ModelData
+{
+    std::vector<u8>     Buffer;             //!< PMDファイルのイメージです.
+    size_t              ExtensionOffset;    //!< 拡張データの開始位置です.
+    size_t              PhysicsOffset;      //!< 剛体データの開始位置です.
+    size_t              JointOffset;        //!< ジョイントデータの開始位置です.
+};
+
+//-------------------------------------------------------------------------------------------------
+//      値をバッファの末尾に書き込みます.
+//-------------------------------------------------------------------------------------------------
+template<typename T>
+void Write( std::vector<u8>& buffer, const T& value )
+{
+    auto ptr = reinterpret_cast<const u8*>( &value );
+    buffer.insert( buffer.end(), ptr, ptr + sizeof(T) );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      構造体をゼロクリアしてから名前を設定します.
+//-------------------------------------------------------------------------------------------------
+template<typename T, size_t N>
+void SetName( T& value, char8 (&name)[N], const char8* text )
+{
+    memset( static_cast<void*>( &value ), 0, sizeof(T) );
+    strncpy( name, text, N );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      参照関係が正しいPMDファイルのイメージを作成します.
+//-------------------------------------------------------------------------------------------------
+void CreateModel( const ModelDesc& desc, ModelData& result )
+{
+    Random random( 1234 );
+    auto& buffer = result.Buffer;
+    buffer.clear();
+
+    {
+        asdx::PMD_HEADER header;
+        SetName( header, header.ModelName, "benchmark" );
+        header.Magic[0] = 'P';
+        header.Magic[1] = 'm';
+        header.Magic[2] = 'd';
+        header.Version  = 1.0f;
+        Write( buffer, header );
+    }
+
+    // 頂点.
+    Write( buffer, desc.VertexCount );
+    for( u32 i=0; i<desc.VertexCount; ++i )
+    {
+        asdx::PMD_VERTEX vertex;
+        memset( static_cast<void*>( &vertex ), 0, sizeof(vertex) );
+        vertex.BoneIndex[0] = u16( i % desc.BoneCount );
+        vertex.BoneIndex[1] = u16( ( i + 1 ) % desc.BoneCount );
+        vertex.BoneWeight   = 50;
+        Write( buffer, vertex );
+    }
+
+    // 頂点インデックス.
+    Write( buffer, desc.IndexCount );
+    for( u32 i=0; i<desc.IndexCount; ++i )
+    { Write( buffer, u16( random.GetAsU32( asdx::Min( desc.VertexCount, 0xFFFFu ) ) ) ); }
+
+    // マテリアル.
+    {
+        u32 count = 4;
+        Write( buffer, count );
+        for( u32 i=0; i<count; ++i )
+        {
+            asdx::PMD_MATERIAL material;
+            SetName( material, material.TextureName, "texture.bmp" );
+            material.VertexCount = desc.IndexCount / count;
+            Write( buffer, material );
+        }
+    }
+
+    // ボーン(一本の鎖).
+    Write( buffer, desc.BoneCount );
+    for( u16 i=0; i<desc.BoneCount; ++i )
+    {
+        asdx::PMD_BONE bone;
+        SetName( bone, bone.Name, "bone" );
+        bone.ParentIndex = ( i == 0 ) ? 0xFFFF : u16( i - 1 );
+        Write( buffer, bone );
+    }
+
+    // IK.
+    {
+        u16 count = 2;
+        Write( buffer, count );
+        for( u16 i=0; i<count; ++i )
+        {
+            asdx::PMD_IK ik = {};
+            ik.BoneIndex       = i;
+            ik.TargetBoneIndex = u16( i + 1 );
+            ik.ChainCount      = 2;
+            ik.RecursiveCount  = 8;
+            ik.ControlWeight   = 0.5f;
+            Write( buffer, ik );
+
+            for( u8 j=0; j<ik.ChainCount; ++j )
+            { Write( buffer, u16( i + 2 + j ) ); }
+        }
+    }
+
+    // 表情(先頭は base).
+    auto baseCount = desc.VertexCount / 10 + 1;
+    Write( buffer, desc.MorphCount );
+    for( u16 i=0; i<desc.MorphCount; ++i )
+    {
+        asdx::PMD_MORPH morph;
+        SetName( morph, morph.Name, ( i == 0 ) ? "base" : "morph" );
+        morph.Type        = ( i == 0 ) ? 0 : 1;
+        morph.VertexCount = ( i == 0 ) ? baseCount : 64;
+        Write( buffer, morph );
+
+        for( u32 j=0; j<morph.VertexCount; ++j )
+        {
+            asdx::PMD_MORPH_VERTEX vertex;
+            memset( static_cast<void*>( &vertex ), 0, sizeof(vertex) );
+            vertex.Index = ( i == 0 ) ? j : random.GetAsU32( baseCount );
+            Write( buffer, vertex );
+        }
+    }
+
+    // 表情枠用表示リスト.
+    Write( buffer, u8( 1 ) );
+    Write( buffer, u16( 0 ) );
+
+    // ボーン枠用枠名リスト.
+    Write( buffer, u8( 1 ) );
+    {
+        char8 name[50] = "label";
+        Write( buffer, name );
+    }
+
+    // ボーン枠用表示リスト.
+    Write( buffer, u32( 1 ) );
+    {
+        asdx::PMD_BONE_LABEL_INDEX label = {};
+        label.FrameIndex = 1;
+        Write( buffer, label );
+    }
+
+    result.ExtensionOffset = buffer.size();
+
+    // 英名.
+    {
+        asdx::PMD_LOCALIZE_HEADER header;
+        SetName( header, header.ModelName, "benchmark" );
+        header.LocalizeFlag = 0x1;
+        Write( buffer, header );
+
+        size_t size = desc.BoneCount * 20 + ( desc.MorphCount - 1 ) * 20 + 50;
+        buffer.resize( buffer.size() + size, 0 );
+    }
+
+    // トゥーンテクスチャリスト.
+    {
+        asdx::PMD_TOON_TEXTURE_LIST list = {};
+        Write( buffer, list );
+    }
+
+    result.PhysicsOffset = buffer.size();
+
+    // 剛体.
+    Write( buffer, desc.RigidBodyCount );
+    for( u32 i=0; i<desc.RigidBodyCount; ++i )
+    {
+        asdx::PMD_RIGIDBODY body;
+        SetName( body, body.Name, "body" );
+        body.RelationBoneIndex = u16( i % desc.BoneCount );
+        body.Mass              = 1.0f;
+        Write( buffer, body );
+    }
+
+    result.JointOffset = buffer.size();
+
+    // ジョイント(隣り合う剛体を接続).
+    Write( buffer, desc.RigidBodyCount - 1 );
+    for( u32 i=0; i+1<desc.RigidBodyCount; ++i )
+    {
+        asdx::PMD_PHYSICS_JOINT joint;
+        SetName( joint, joint.Name, "joint" );
+        joint.RigidBodyA = i;
+        joint.RigidBodyB = i + 1;
+        Write( buffer, joint );
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      読み込み結果の参照番号が範囲内かどうかチェックします.
+//-------------------------------------------------------------------------------------------------
+bool IsValid( const asdx::ResPmd& pmd )
+{
+    for( size_t i=0; i<pmd.Indices.size(); ++i )
+    {
+        if ( pmd.Indices[i] >= pmd.Vertices.size() )
+        { return false; }
+    }
+
+    for( size_t i=0; i<pmd.Joints.size(); ++i )
+    {
+        if ( pmd.Joints[i].RigidBodyA >= pmd.RigidBodies.size()
+          || pmd.Joints[i].RigidBodyB >= pmd.RigidBodies.size() )
+        { return false; }
+    }
+
+    for( const auto& vertex : pmd.Vertices )
+    {
+        if ( vertex.BoneIndex[0] >= pmd.Bones.size() || vertex.BoneIndex[1] >= pmd.Bones.size() )
+        { return false; }
+    }
+
+    for( const auto& bone : pmd.Bones )
+    {
+        if ( bone.ParentIndex != 0xFFFF && bone.ParentIndex >= pmd.Bones.size() )
+        { return false; }
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      範囲外のボーン番号が補正されて読み込めるかチェックします.
+//-------------------------------------------------------------------------------------------------
+bool CheckBoneIndexFix( const ModelData& model )
+{
+    // 先頭の頂点のボーン番号を範囲外にする.
+    auto buffer = model.Buffer;
+    auto offset = sizeof(asdx::PMD_HEADER) + sizeof(u32) + offsetof(asdx::PMD_VERTEX, BoneIndex);
+    buffer[offset + 0] = 0xFF;
+    buffer[offset + 1] = 0xFF;
+
+    asdx::ResPmd pmd;
+    auto result = pmd.Load( buffer.data(), buffer.size() )
+               && IsValid( pmd )
+               && ( pmd.Vertices[0].BoneIndex[0] == 0 );
+
+    printf( "bone index fix ... %s\n", ( result ) ? "OK" : "NG" );
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      読み込み時間を計測します.
+//-------------------------------------------------------------------------------------------------
+bool MeasureLoad()
+{
+    ModelDesc desc = { 60000, 300000, 300, 120, 64 };
+
+    ModelData model;
+    CreateModel( desc, model );
+
+    asdx::ResPmd pmd;
+    auto result = true;
+
+    auto begin = std::chrono::steady_clock::now();
+    for( u32 i=0; i<LOAD_COUNT; ++i )
+    { result &= pmd.Load( model.Buffer.data(), model.Buffer.size() ); }
+    auto end = std::chrono::steady_clock::now();
+
+    auto msec = std::chrono::duration<double, std::milli>( end - begin ).count() / LOAD_COUNT;
+    auto mb   = double( model.Buffer.size() ) / ( 1024.0 * 1024.0 );
+
+    result &= ( pmd.Vertices.size()    == desc.VertexCount )
+           && ( pmd.Morphes.size()     == desc.MorphCount )
+           && ( pmd.RigidBodies.size() == desc.RigidBodyCount )
+           && ( pmd.Joints.size()      == desc.RigidBodyCount - 1 );
+
+    printf( "load : size = %.2f MB, %.3f msec/load, %.1f MB/sec ... %s\n",
+        mb, msec, mb * 1000.0 / msec, ( result ) ? "OK" : "NG" );
+
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      途中で切れたファイルの読み込み結果をチェックします.
+//-------------------------------------------------------------------------------------------------
+bool CheckTruncation( const ModelData& model )
+{
+    asdx::ResPmd pmd;
+    u32 errors = 0;
+
+    for( size_t size=0; size<model.Buffer.size(); ++size )
+    {
+        // ASan などで範囲外読み込みを検出できるようにちょうどのサイズで確保する.
+        std::vector<u8> buffer( model.Buffer.begin(), model.Buffer.begin() + size );
+        auto result = pmd.Load( buffer.data(), buffer.size() );
+
+        // 拡張データより前で切れていたら失敗, 以降なら読み込めた所までで成功.
+        auto expect = ( size >= model.ExtensionOffset );
+
+        // 剛体とジョイントは両方揃っているか, 両方とも無いかのどちらか(ジョイントの直前で切れた場合を除く).
+        auto isPair = ( pmd.RigidBodies.empty() == pmd.Joints.empty() ) || ( size == model.JointOffset );
+
+        if ( result != expect || ( result && ( !isPair || !IsValid( pmd ) ) ) )
+        { errors++; }
+    }
+
+    printf( "truncation : %zu cases, %u errors ... %s\n",
+        model.Buffer.size(), errors, ( errors == 0 ) ? "OK" : "NG" );
+
+    return errors == 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      破損したファイルを読み込んでも不正な状態にならないかチェックします.
+//-------------------------------------------------------------------------------------------------
+bool CheckCorruption( const ModelData& model )
+{
+    Random random( 42 );
+    asdx::ResPmd pmd;
+    u32 accepted = 0;
+    u32 errors   = 0;
+
+    for( u32 i=0; i<FUZZ_COUNT; ++i )
+    {
+        std::vector<u8> buffer( model.Buffer );
+
+        // 数バイトを書き換え, 半分は末尾も切り詰める.
+        auto count = 1 + random.GetAsU32( 8 );
+        for( u32 j=0; j<count; ++j )
+        { buffer[ random.GetAsU32( u32( buffer.size() ) ) ] = u8( random.GetAsU32() ); }
+
+        if ( random.GetAsU32( 2 ) == 0 )
+        { buffer.resize( buffer.size() - random.GetAsU32( u32( buffer.size() ) ) ); }
+
+        buffer.shrink_to_fit();
+
+        if ( pmd.Load( buffer.data(), buffer.size() ) )
+        {
+            accepted++;
+            if ( !IsValid( pmd ) )
+            { errors++; }
+        }
+    }
+
+    printf( "corruption : %u cases, %u accepted, %u errors ... %s\n",
+        FUZZ_COUNT, accepted, errors, ( errors == 0 ) ? "OK" : "NG" );
+
+    return errors == 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      頭と髪の房を持つ物理演算用のモデルを作成します.
+//-------------------------------------------------------------------------------------------------
+void CreatePhysicsModel( asdx::ResPmd& pmd )
+{
+    pmd.Dispose();
+
+    // ボーン : センター, 頭, 髪の房(頭から下に伸びる鎖).
+    auto boneCount = 2 + HAIR_COUNT * HAIR_LENGTH;
+    pmd.Bones.resize( boneCount );
+    for( u32 i=0; i<boneCount; ++i )
+    { SetName( pmd.Bones[i], pmd.Bones[i].Name, "bone" ); }
+
+    pmd.Bones[0].ParentIndex = 0xFFFF;
+    pmd.Bones[0].Position    = asdx::Vector3( 0.0f, 10.0f, 0.0f );
+    pmd.Bones[1].ParentIndex = 0;
+    pmd.Bones[1].Position    = asdx::Vector3( 0.0f, 15.0f, 0.0f );
+
+    for( u32 h=0; h<HAIR_COUNT; ++h )
+    {
+        auto angle = asdx::F_2PI * f32( h ) / f32( HAIR_COUNT );
+        auto root  = asdx::Vector3( cosf( angle ), 0.5f, sinf( angle ) ) * 1.2f;
+        for( u32 j=0; j<HAIR_LENGTH; ++j )
+        {
+            auto index = 2 + h * HAIR_LENGTH + j;
+            pmd.Bones[index].ParentIndex = u16( ( j == 0 ) ? 1 : index - 1 );
+            pmd.Bones[index].Position    = pmd.Bones[1].Position + root * ( 1.0f + 0.2f * j ) - asdx::Vector3( 0.0f, 0.8f * j, 0.0f );
+        }
+    }
+
+    // 剛体 : 頭はボーン追従の球, 髪は物理演算の球.
+    pmd.RigidBodies.resize( 1 + HAIR_COUNT * HAIR_LENGTH );
+    {
+        auto& body = pmd.RigidBodies[0];
+        SetName( body, body.Name, "head" );
+        body.RelationBoneIndex = 1;
+        body.GroupIndex        = 0;
+        body.GroupTarget       = 0xFFFF;
+        body.ShapeType         = asdx::PMD_COLLISION_SHAPE_TYPE_SPHERE;
+        body.ShapeSize         = asdx::Vector3( 1.5f, 0.0f, 0.0f );
+        body.Mass              = 1.0f;
+        body.Type              = asdx::PMD_RIGIDBODY_TYPE_FLLOW_BONE;
+    }
+    for( u32 i=1; i<pmd.RigidBodies.size(); ++i )
+    {
+        auto& body = pmd.RigidBodies[i];
+        SetName( body, body.Name, "hair" );
+        body.RelationBoneIndex = u16( 1 + i );
+        body.GroupIndex        = 1;
+        body.GroupTarget       = 0x1;
+        body.ShapeType         = asdx::PMD_COLLISION_SHAPE_TYPE_SPHERE;
+        body.ShapeSize         = asdx::Vector3( 0.2f, 0.0f, 0.0f );
+        body.Mass              = 0.5f;
+        body.DampingTranslate  = 0.2f;
+        body.Type              = asdx::PMD_RIGIDBODY_TYPE_PHYSICS;
+    }
+
+    // ジョイント : 頭と房の根元, 房の中を順に接続.
+    for( u32 h=0; h<HAIR_COUNT; ++h )
+    {
+        for( u32 j=0; j<HAIR_LENGTH; ++j )
+        {
+            asdx::PMD_PHYSICS_JOINT joint;
+            SetName( joint, joint.Name, "joint" );
+            joint.RigidBodyA     = ( j == 0 ) ? 0 : 1 + h * HAIR_LENGTH + j - 1;
+            joint.RigidBodyB     = 1 + h * HAIR_LENGTH + j;
+            joint.LimitAngle[0]  = asdx::Vector3( -0.5f, -0.5f, -0.5f );
+            joint.LimitAngle[1]  = asdx::Vector3(  0.5f,  0.5f,  0.5f );
+            joint.SpringPosition = asdx::Vector3( 200.0f, 200.0f, 200.0f );
+            pmd.Joints.push_back( joint );
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      頭を揺らすアニメーション姿勢を求めます.
+//-------------------------------------------------------------------------------------------------
+void AnimatePose( const asdx::ResPmd& pmd, u32 chara, u32 frame, asdx::Matrix* pTransforms )
+{
+    // キャラクターごとに周期と位相をずらす.
+    auto t     = f32( frame ) / 60.0f;
+    auto speed = 1.0f + 0.05f * f32( chara );
+    auto phase = 0.37f * f32( chara );
+    auto sway  = asdx::Matrix::CreateRotationY( 0.8f * sinf( speed * t + phase ) )
+               * asdx::Matrix::CreateTranslation( 2.0f * sinf( 1.7f * speed * t + phase ), 0.0f, 0.0f );
+
+    for( size_t i=0; i<pmd.Bones.size(); ++i )
+    { pTransforms[i] = asdx::Matrix::CreateTranslation( pmd.Bones[i].Position ) * sway; }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      スレッド数を変えても物理演算の結果がビット単位で一致するかチェックします.
+//-------------------------------------------------------------------------------------------------
+bool CheckPhysicsDeterminism()
+{
+    asdx::ResPmd pmd;
+    CreatePhysicsModel( pmd );
+
+    auto boneCount = u32( pmd.Bones.size() );
+    const u32 threadCounts[] = { 1, 4 };
+    std::vector<asdx::Matrix> results[2];
+
+    printf( "physics : characters = %u, bodies = %u, joints = %u, frames = %u\n",
+        CHARA_COUNT, u32( pmd.RigidBodies.size() ), u32( pmd.Joints.size() ), STEP_COUNT );
+
+    for( u32 t=0; t<2; ++t )
+    {
+        std::vector<asdx::PmdPhysics>   physics( CHARA_COUNT );
+        std::vector<asdx::PmdPhysics*>  ppPhysics( CHARA_COUNT );
+        std::vector<asdx::Matrix*>      ppTransforms( CHARA_COUNT );
+
+        auto& transforms = results[t];
+        transforms.resize( size_t(CHARA_COUNT) * boneCount );
+
+        for( u32 i=0; i<CHARA_COUNT; ++i )
+        {
+            if ( !physics[i].Init( pmd ) )
+            {
+                printf( "  NG : PmdPhysics::Init() Failed.\n" );
+                return false;
+            }
+            physics[i].SetDeterministic( true );
+
+            ppPhysics   [i] = &physics[i];
+            ppTransforms[i] = &transforms[size_t(i) * boneCount];
+        }
+
+        f64 elapsed = 0.0;
+        for( u32 frame=0; frame<STEP_COUNT; ++frame )
+        {
+            for( u32 i=0; i<CHARA_COUNT; ++i )
+            { AnimatePose( pmd, i, frame, ppTransforms[i] ); }
+
+            auto begin = std::chrono::steady_clock::now();
+            asdx::PmdPhysics::UpdateBatch( ppPhysics.data(), ppTransforms.data(), CHARA_COUNT, 1.0f / 60.0f, threadCounts[t] );
+            auto end = std::chrono::steady_clock::now();
+            elapsed += std::chrono::duration<f64, std::milli>( end - begin ).count();
+        }
+
+        printf( "  threads = %u : %.3f msec/frame\n", threadCounts[t], elapsed / STEP_COUNT );
+    }
+
+    // 髪がアニメーション姿勢から動いており, 発散していないことも確認する.
+    std::vector<asdx::Matrix> anim( boneCount );
+    AnimatePose( pmd, 0, STEP_COUNT - 1, anim.data() );
+    auto moved = false;
+    for( u32 i=0; i<boneCount; ++i )
+    {
+        if ( memcmp( &anim[i], &results[0][i], sizeof(asdx::Matrix) ) != 0 )
+        { moved = true; }
+    }
+    for( const auto& transform : results[0] )
+    {
+        if ( !std::isfinite( transform._41 ) || !std::isfinite( transform._42 ) || !std::isfinite( transform._43 ) )
+        { moved = false; }
+    }
+
+    auto identical = ( memcmp( results[0].data(), results[1].data(), results[0].size() * sizeof(asdx::Matrix) ) == 0 );
+    printf( "  bitwise identical = %s, simulated = %s ... %s\n",
+        ( identical ) ? "yes" : "no",
+        ( moved ) ? "yes" : "no",
+        ( identical && moved ) ? "OK" : "NG" );
+
+    return identical && moved;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      モーフ計測用のモデルを生成します.
+//-------------------------------------------------------------------------------------------------
+void CreateMorphModel( asdx::ResPmd& pmd )
+{
+    Random random( 3 );
+
+    pmd.Vertices.resize( MORPH_VERTICES );
+    for( u32 i=0; i<MORPH_VERTICES; ++i )
+    {
+        pmd.Vertices[i] = asdx::PMD_VERTEX();
+        pmd.Vertices[i].Position = asdx::Vector3( f32(i) * 0.001f, 0.0f, 0.0f );
+    }
+
+    // 顔の頂点を base 表情とし, 各表情はその一部の 600 頂点の範囲から 400 頂点を動かす.
+    const u32 faceOffset = 20000;
+    pmd.Morphes.resize( FACE_MORPHS + 1 );
+
+    auto& base = pmd.Morphes[0];
+    base.Name = "base";
+    base.Type = 0;
+    for( u32 i=0; i<FACE_VERTICES; ++i )
+    {
+        asdx::PMD_MORPH_VERTEX vertex;
+        vertex.Index    = faceOffset + i;
+        vertex.Position = pmd.Vertices[faceOffset + i].Position;
+        base.Vertices.push_back( vertex );
+    }
+
+    for( u32 i=1; i<=FACE_MORPHS; ++i )
+    {
+        auto& morph = pmd.Morphes[i];
+        morph.Name = "morph" + std::to_string( i );
+        morph.Type = u8( 1 + i % 4 );
+
+        auto start = random.GetAsU32( FACE_VERTICES - 600 );
+        for( u32 j=0; j<400; ++j )
+        {
+            asdx::PMD_MORPH_VERTEX vertex;
+            vertex.Index    = start + random.GetAsU32( 600 );
+            vertex.Position = asdx::Vector3(
+                random.GetAsU32( 100 ) * 0.01f,
+                random.GetAsU32( 100 ) * 0.01f,
+                random.GetAsU32( 100 ) * 0.01f );
+            morph.Vertices.push_back( vertex );
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      モーフの結果を全頂点で計算した結果と比較します.
+//-------------------------------------------------------------------------------------------------
+f32 GetMorphError( const asdx::ResPmd& pmd, const asdx::MorphEngine& engine, const std::vector<f32>& weights )
+{
+    std::vector<asdx::Vector3> expected( pmd.Vertices.size() );
+    for( size_t i=0; i<pmd.Vertices.size(); ++i )
+    { expected[i] = pmd.Vertices[i].Position; }
+
+    const auto& base = pmd.Morphes[0];
+    for( size_t i=1; i<pmd.Morphes.size(); ++i )
+    {
+        for( const auto& vertex : pmd.Morphes[i].Vertices )
+        {
+            auto& dst = expected[ base.Vertices[vertex.Index].Index ];
+            dst.x += vertex.Position.x * weights[i];
+            dst.y += vertex.Position.y * weights[i];
+            dst.z += vertex.Position.z * weights[i];
+        }
+    }
+
+    auto pPositions = engine.GetPositions();
+    f32 error = 0.0f;
+    for( size_t i=0; i<expected.size(); ++i )
+    {
+        error = std::max( error, std::abs( expected[i].x - pPositions[i].x ) );
+        error = std::max( error, std::abs( expected[i].y - pPositions[i].y ) );
+        error = std::max( error, std::abs( expected[i].z - pPositions[i].z ) );
+    }
+
+    return error;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      有効な表情数ごとのモーフの処理時間を計測します.
+//-------------------------------------------------------------------------------------------------
+bool MeasureMorph()
+{
+    asdx::ResPmd pmd;
+    CreateMorphModel( pmd );
+
+    asdx::MorphEngine engine;
+    if ( !engine.Init( pmd ) )
+    {
+        printf( "  NG : MorphEngine::Init() Failed.\n" );
+        return false;
+    }
+
+    Random random( 7 );
+    std::vector<f32> weights( pmd.Morphes.size(), 0.0f );
+
+    // 有効な表情を入れ替えて, 前回の影響が正しく取り消されることを確認する.
+    auto result = true;
+    f32  error  = 0.0f;
+    for( u32 pass=0; pass<2; ++pass )
+    {
+        for( u32 i=1; i<=FACE_MORPHS; ++i )
+        {
+            weights[i] = ( i % ( pass + 3 ) == 0 ) ? random.GetAsU32( 100 ) * 0.01f : 0.0f;
+            engine.SetWeight( i, weights[i] );
+        }
+        result &= engine.Update();
+        error = std::max( error, GetMorphError( pmd, engine, weights ) );
+    }
+
+    // 重みが変わらなければ更新されない.
+    result &= !engine.Update();
+
+    // 全て0に戻すと元の位置に戻る.
+    engine.ResetWeights();
+    std::fill( weights.begin(), weights.end(), 0.0f );
+    engine.Update();
+    error = std::max( error, GetMorphError( pmd, engine, weights ) );
+
+    result &= ( error <= 1e-4f );
+    printf( "morph : vertices = %u, face vertices = %u, morphs = %u, max error = %g ... %s\n",
+        MORPH_VERTICES, FACE_VERTICES, FACE_MORPHS, error, ( result ) ? "OK" : "NG" );
+
+    // 有効な表情数ごとの1フレームあたりの処理時間とアップロードする頂点数.
+    std::vector<u8> buffer( size_t( MORPH_VERTICES ) * sizeof(asdx::PMD_VERTEX) );
+    for( u32 active : { 0u, 1u, 2u, 4u, 8u, 16u, 32u, 64u } )
+    {
+        size_t copied = 0;
+
+        auto begin = std::chrono::steady_clock::now();
+        for( u32 frame=0; frame<MORPH_FRAMES; ++frame )
+        {
+            for( u32 i=1; i<=active; ++i )
+            { engine.SetWeight( i, 0.5f + 0.5f * sinf( frame * 0.1f + f32(i) ) ); }
+
+            if ( engine.Update() )
+            { copied += engine.CopyPositions( buffer.data(), sizeof(asdx::PMD_VERTEX) ); }
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        auto usec = std::chrono::duration<f64, std::micro>( end - begin ).count() / MORPH_FRAMES;
+        printf( "  active = %2u : %8.2f usec/frame, %6zu vertices/frame\n", active, usec, copied / MORPH_FRAMES );
+
+        engine.ResetWeights();
+        engine.Update();
+    }
+
+    // 比較用に全頂点の位置座標を毎フレーム書き込んだ場合.
+    {
+        auto begin = std::chrono::steady_clock::now();
+        for( u32 frame=0; frame<MORPH_FRAMES; ++frame )
+        {
+            auto pDst = buffer.data();
+            for( u32 i=0; i<MORPH_VERTICES; ++i, pDst += sizeof(asdx::PMD_VERTEX) )
+            { memcpy( pDst, &pmd.Vertices[i].Position, sizeof(asdx::Vector3) ); }
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        auto usec = std::chrono::duration<f64, std::micro>( end - begin ).count() / MORPH_FRAMES;
+        printf( "  full copy   : %8.2f usec/frame, %6u vertices/frame\n", usec, MORPH_VERTICES );
+    }
+
+    return result;
+}
+
+} // namespace /* anonymous */
+
+
+//-------------------------------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-------------------------------------------------------------------------------------------------
+int main( int, char** )
+{
+    auto result = MeasureLoad();
+    result &= MeasureMorph();
+    result &= CheckPhysicsDeterminism();
+
+    // 破損データのエラーログは大量に出るので全て抑制する.
+    asdx::SystemLogger::GetInstance().SetFilter( asdx::LogLevel( u32( asdx::LogLevel::Error ) + 1 ) );
+
+    ModelDesc desc = { 300, 900, 16, 6, 8 };
+
+    ModelData model;
+    CreateModel( desc, model );
+
+    result &= CheckBoneIndexFix( model );
+    result &= CheckTruncation( model );
+    result &= CheckCorruption( model );
+
+    return ( result ) ? 0 : -1;
+}
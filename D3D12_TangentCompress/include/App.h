@@ -11,6 +11,7 @@
 #include <fw/asdxApp.h>
 #include <fw/asdxAppCamera.h>
 #include <gfx/asdxCommandQueue.h>
+#include <TangentEncoder.h>
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -42,10 +43,20 @@ private:
     asdx::AppCamera m_Camera;
     asdx::WaitPoint m_WaitPoint;
 
+    std::vector<asdx::Vector3>          m_Normals;                          //!< 検証用メッシュの法線.
+    std::vector<asdx::Vector4>          m_Tangents;                         //!< 検証用メッシュの接線.
+    uint32_t                            m_SplitCount     = 0;               //!< 分割した頂点数.
+    float                               m_MaxErrorDegree = 1.0f;            //!< 許容する最大誤差(度).
+    TANGENT_FORMAT                      m_TangentFormat  = TANGENT_FORMAT_QTANGENT16;
+    std::vector<TangentErrorStatistics> m_TangentStats;                     //!< フォーマットごとの誤差.
+    double                              m_EncodeTime[TANGENT_FORMAT_COUNT]; //!< エンコード時間(ミリ秒).
+    double                              m_DecodeTime[TANGENT_FORMAT_COUNT]; //!< デコード時間(ミリ秒).
+
     //=========================================================================
     // private methods.
     //=========================================================================
     bool OnInit() override;
+    bool InitTangent();
     void OnTerm() override;
     void OnFrameRender(asdx::FrameEventArgs& args) override;
     void OnKey(const asdx::KeyEventArgs& args) override;
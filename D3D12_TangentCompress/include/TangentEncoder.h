@@ -0,0 +1,168 @@
+﻿//-----------------------------------------------------------------------------
+// File : TangentEncoder.h
+// Desc : Compact Tangent Frame Encoding.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <vector>
+#include <fnd/asdxMath.h>
+
+
+///////////////////////////////////////////////////////////////////////////////
+// TANGENT_FORMAT enum
+///////////////////////////////////////////////////////////////////////////////
+enum TANGENT_FORMAT
+{
+    TANGENT_FORMAT_QTANGENT16   = 0,    //!< 16bit snorm のクォータニオン. wの符号が従法線の符号(8バイト).
+    TANGENT_FORMAT_OCT_ANGLE32  = 1,    //!< 11:11 八面体法線 + 9bit 接線角度 + 1bit 符号(4バイト).
+    TANGENT_FORMAT_FRAME32      = 2,    //!< 10:10:9 smallest-three クォータニオン + 1bit 符号 + 2bit 番号(4バイト).
+    TANGENT_FORMAT_COUNT,
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// TangentErrorStatistics structure
+///////////////////////////////////////////////////////////////////////////////
+struct TangentErrorStatistics
+{
+    TANGENT_FORMAT  Format              = TANGENT_FORMAT_QTANGENT16;
+    uint32_t        BytesPerVertex      = 0;    //!< 頂点あたりのバイト数.
+    uint32_t        VertexCount         = 0;    //!< 頂点数.
+    float           MaxNormalError      = 0.0f; //!< 法線の最大誤差(度).
+    float           AverageNormalError  = 0.0f; //!< 法線の平均誤差(度).
+    float           MaxTangentError     = 0.0f; //!< 接線の最大誤差(度).
+    float           AverageTangentError = 0.0f; //!< 接線の平均誤差(度).
+    float           MaxBitangentError   = 0.0f; //!< 従法線の最大誤差(度).
+    uint32_t        SignMismatchCount   = 0;    //!< 従法線の符号が一致しなかった頂点数.
+};
+
+//-----------------------------------------------------------------------------
+//! @brief      頂点あたりのバイト数を取得します.
+//-----------------------------------------------------------------------------
+uint32_t GetTangentFormatSize(TANGENT_FORMAT format);
+
+//-----------------------------------------------------------------------------
+//! @brief      QTangent にエンコードします.
+//!
+//! @param[in]      normal          法線ベクトルです.
+//! @param[in]      tangent         接線ベクトルです(w:従法線の符号).
+//! @return     R16G16B16A16_SNORM として読み出せる値を返却します.
+//! @note       デコードは DecodeQTangent() を参照してください.
+//-----------------------------------------------------------------------------
+uint64_t EncodeQTangent(const asdx::Vector3& normal, const asdx::Vector4& tangent);
+
+//-----------------------------------------------------------------------------
+//! @brief      QTangent をデコードします.
+//!
+//! @param[in]      value           エンコードした値です.
+//! @param[out]     normal          法線ベクトルの格納先です.
+//! @param[out]     tangent         接線ベクトルの格納先です(w:従法線の符号).
+//! @note       q を正規化した後, 以下で復元します. 従法線は w * cross(normal, tangent) です.
+//!             tangent = (1 - 2(y^2 + z^2), 2(xy + wz), 2(xz - wy))
+//!             normal  = (2(xz + wy), 2(yz - wx), 1 - 2(x^2 + y^2))
+//-----------------------------------------------------------------------------
+void DecodeQTangent(uint64_t value, asdx::Vector3& normal, asdx::Vector4& tangent);
+
+//-----------------------------------------------------------------------------
+//! @brief      八面体法線 + 接線角度にエンコードします.
+//!
+//! @param[in]      normal          法線ベクトルです.
+//! @param[in]      tangent         接線ベクトルです(w:従法線の符号).
+//! @return     R32_UINT として読み出せる値を返却します.
+//! @note       接線角度は量子化後の法線から求めた基準軸に対する角度です.
+//-----------------------------------------------------------------------------
+uint32_t EncodeOctAngle(const asdx::Vector3& normal, const asdx::Vector4& tangent);
+
+//-----------------------------------------------------------------------------
+//! @brief      八面体法線 + 接線角度をデコードします.
+//-----------------------------------------------------------------------------
+void DecodeOctAngle(uint32_t value, asdx::Vector3& normal, asdx::Vector4& tangent);
+
+//-----------------------------------------------------------------------------
+//! @brief      32bit の smallest-three クォータニオンにエンコードします.
+//!
+//! @param[in]      normal          法線ベクトルです.
+//! @param[in]      tangent         接線ベクトルです(w:従法線の符号).
+//! @return     R32_UINT として読み出せる値を返却します.
+//-----------------------------------------------------------------------------
+uint32_t EncodeFrame32(const asdx::Vector3& normal, const asdx::Vector4& tangent);
+
+//-----------------------------------------------------------------------------
+//! @brief      32bit の smallest-three クォータニオンをデコードします.
+//-----------------------------------------------------------------------------
+void DecodeFrame32(uint32_t value, asdx::Vector3& normal, asdx::Vector4& tangent);
+
+//-----------------------------------------------------------------------------
+//! @brief      接線空間をまとめてエンコードします.
+//!
+//! @param[in]      format          フォーマットです.
+//! @param[in]      pNormals        法線ベクトルです.
+//! @param[in]      pTangents       接線ベクトルです(w:従法線の符号).
+//! @param[in]      count           頂点数です.
+//! @param[out]     result          GetTangentFormatSize(format) * count バイトの格納先です.
+//! @retval true    エンコードに成功.
+//! @retval false   エンコードに失敗.
+//! @note       SSE2 が使える場合は4頂点ずつ処理します.
+//-----------------------------------------------------------------------------
+bool EncodeTangentFrames(
+    TANGENT_FORMAT          format,
+    const asdx::Vector3*    pNormals,
+    const asdx::Vector4*    pTangents,
+    uint32_t                count,
+    std::vector<uint8_t>&   result);
+
+//-----------------------------------------------------------------------------
+//! @brief      接線空間をまとめてデコードします.
+//!
+//! @param[in]      format          フォーマットです.
+//! @param[in]      pData           エンコードしたデータです.
+//! @param[in]      count           頂点数です.
+//! @param[out]     pNormals        法線ベクトルの格納先です.
+//! @param[out]     pTangents       接線ベクトルの格納先です.
+//! @retval true    デコードに成功.
+//! @retval false   デコードに失敗.
+//! @note       SSE2 が使える場合は4頂点ずつ処理します.
+//-----------------------------------------------------------------------------
+bool DecodeTangentFrames(
+    TANGENT_FORMAT          format,
+    const uint8_t*          pData,
+    uint32_t                count,
+    asdx::Vector3*          pNormals,
+    asdx::Vector4*          pTangents);
+
+//-----------------------------------------------------------------------------
+//! @brief      浮動小数の接線空間に対する誤差を集計します.
+//!
+//! @param[in]      format          フォーマットです.
+//! @param[in]      pNormals        法線ベクトルです.
+//! @param[in]      pTangents       接線ベクトルです(w:従法線の符号).
+//! @param[in]      count           頂点数です.
+//! @return     集計結果を返却します.
+//! @note       接線は法線に対してグラム・シュミットで直交化したものを基準とします.
+//-----------------------------------------------------------------------------
+TangentErrorStatistics ComputeTangentError(
+    TANGENT_FORMAT          format,
+    const asdx::Vector3*    pNormals,
+    const asdx::Vector4*    pTangents,
+    uint32_t                count);
+
+//-----------------------------------------------------------------------------
+//! @brief      許容誤差を満たす最も小さいフォーマットを選択します.
+//!
+//! @param[in]      pNormals        法線ベクトルです.
+//! @param[in]      pTangents       接線ベクトルです(w:従法線の符号).
+//! @param[in]      count           頂点数です.
+//! @param[in]      maxErrorDegree  許容する最大誤差(度)です.
+//! @param[out]     pStatistics     全フォーマットの集計結果の格納先です(nullptr可).
+//! @return     選択したフォーマットを返却します. 満たすものが無い場合は最も誤差の小さいフォーマットです.
+//-----------------------------------------------------------------------------
+TANGENT_FORMAT SelectTangentFormat(
+    const asdx::Vector3*                    pNormals,
+    const asdx::Vector4*                    pTangents,
+    uint32_t                                count,
+    float                                   maxErrorDegree,
+    std::vector<TangentErrorStatistics>*    pStatistics);
@@ -0,0 +1,66 @@
+﻿//-----------------------------------------------------------------------------
+// File : TangentSpace.h
+// Desc : Angle Weighted Tangent Generation.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <vector>
+#include <fnd/asdxMath.h>
+#include <res/asdxResModel.h>
+
+
+///////////////////////////////////////////////////////////////////////////////
+// TangentSpaceData structure
+///////////////////////////////////////////////////////////////////////////////
+struct TangentSpaceData
+{
+    std::vector<asdx::Vector4>  Tangents;       //!< 接線ベクトル(xyz:接線, w:従法線の符号).
+    std::vector<uint32_t>       VertexRemap;    //!< 出力頂点が参照する元の頂点番号.
+    std::vector<uint32_t>       Indices;        //!< 出力頂点を参照するインデックス.
+    uint32_t                    SplitCount = 0; //!< 向きの異なる三角形が共有していたため分割した頂点数.
+};
+
+//-----------------------------------------------------------------------------
+//! @brief      角度で重み付けした頂点ごとの接線ベクトルを生成します.
+//!
+//! @param[in]      pPositions      位置座標です.
+//! @param[in]      pNormals        法線ベクトルです.
+//! @param[in]      pTexCoords      テクスチャ座標です(nullptrの場合は法線に直交する任意の接線を生成します).
+//! @param[in]      vertexCount     頂点数です.
+//! @param[in]      pIndices        三角形リストのインデックスです.
+//! @param[in]      indexCount      インデックス数です.
+//! @param[out]     result          生成結果の格納先です.
+//! @retval true    生成に成功.
+//! @retval false   生成に失敗.
+//! @note       三角形ごとの dP/du を頂点法線の接平面に射影し, 角度で重み付けして
+//!             頂点ごとに平均します. 従法線は sign * cross(normal, tangent) で復元します.
+//!             UVが鏡像になっている三角形とそうでない三角形が共有する頂点は分割し,
+//!             元の頂点の後ろに追加します(VertexRemap で元の頂点番号を参照できます).
+//!             分割するのはUVの向きが異なる場合のみで, 同一座標の頂点の溶接や
+//!             扇形の分割は行わないため, MikkTSpace の結果とは一致しません.
+//-----------------------------------------------------------------------------
+bool GenerateTangents(
+    const asdx::Vector3*    pPositions,
+    const asdx::Vector3*    pNormals,
+    const asdx::Vector2*    pTexCoords,
+    uint32_t                vertexCount,
+    const uint32_t*         pIndices,
+    uint32_t                indexCount,
+    TangentSpaceData&       result);
+
+//-----------------------------------------------------------------------------
+//! @brief      メッシュごとに並列で接線ベクトルを生成します.
+//!
+//! @param[in]      model           モデルです. TexCoords[0] を使用します.
+//! @param[out]     results         メッシュごとの生成結果の格納先です.
+//! @retval true    全てのメッシュで生成に成功.
+//! @retval false   いずれかのメッシュで生成に失敗.
+//-----------------------------------------------------------------------------
+bool GenerateTangents(
+    const asdx::ResModel&           model,
+    std::vector<TangentSpaceData>&  results);
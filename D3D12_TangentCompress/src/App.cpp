@@ -11,10 +11,91 @@
 #include <fnd/asdxLogger.h>
 #include <edit/asdxGuiMgr.h>
 #include <gfx/asdxDevice.h>
+#include <TangentSpace.h>
+#include <imgui.h>
+#include <chrono>
+#include <cmath>
 
 
 namespace {
 
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t   kTestStacks     = 128;      // 検証用メッシュの緯度方向の分割数.
+static const uint32_t   kTestSlices     = 256;      // 検証用メッシュの経度方向の分割数.
+static const uint32_t   kTestRepeat     = 16;       // 計測の繰り返し回数.
+
+//-----------------------------------------------------------------------------
+//      フォーマット名を取得します.
+//-----------------------------------------------------------------------------
+const char* GetFormatName(TANGENT_FORMAT format)
+{
+    switch(format)
+    {
+    case TANGENT_FORMAT_QTANGENT16:  return "QTangent16";
+    case TANGENT_FORMAT_OCT_ANGLE32: return "OctAngle32";
+    case TANGENT_FORMAT_FRAME32:     return "Frame32";
+    default:                         return "Unknown";
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      検証用の球メッシュを生成します.
+//-----------------------------------------------------------------------------
+void CreateTestSphere
+(
+    std::vector<asdx::Vector3>& positions,
+    std::vector<asdx::Vector3>& normals,
+    std::vector<asdx::Vector2>& texcoords,
+    std::vector<uint32_t>&      indices
+)
+{
+    const auto kPi  = 3.14159265358979323846f;
+    const auto half = kTestSlices / 2;
+
+    positions.clear();
+    normals  .clear();
+    texcoords.clear();
+    indices  .clear();
+
+    for (auto i = 0u; i <= kTestStacks; ++i)
+    {
+        auto theta = kPi * float(i) / float(kTestStacks);
+        for (auto j = 0u; j <= kTestSlices; ++j)
+        {
+            auto phi = 2.0f * kPi * float(j) / float(kTestSlices);
+            auto n   = asdx::Vector3(sinf(theta) * cosf(phi), cosf(theta), sinf(theta) * sinf(phi));
+
+            // 後ろ半分はUVを鏡像にして, 境界の頂点を両方の向きで共有させる.
+            auto u = (j <= half) ? float(j) / float(half) : float(kTestSlices - j) / float(half);
+            auto v = float(i) / float(kTestStacks);
+
+            positions.push_back(n);
+            normals  .push_back(n);
+            texcoords.push_back(asdx::Vector2(u, v));
+        }
+    }
+
+    for (auto i = 0u; i < kTestStacks; ++i)
+    {
+        for (auto j = 0u; j < kTestSlices; ++j)
+        {
+            auto i0 = i * (kTestSlices + 1) + j;
+            auto i1 = i0 + 1;
+            auto i2 = i0 + kTestSlices + 1;
+            auto i3 = i2 + 1;
+
+            indices.push_back(i0);
+            indices.push_back(i2);
+            indices.push_back(i1);
+
+            indices.push_back(i1);
+            indices.push_back(i2);
+            indices.push_back(i3);
+        }
+    }
+}
 
 } // namespace
 
@@ -45,9 +126,11 @@ App::~App()
 //-----------------------------------------------------------------------------
 bool App::OnInit()
 {
-
-
-
+    if (!InitTangent())
+    {
+        ELOG("Error : InitTangent() Failed.");
+        return false;
+    }
 
     auto pos = asdx::Vector3(1000.0f, 100.0f, 0.0f);
     auto at  = asdx::Vector3(0.0f, 100.0f, 0.0f);
@@ -83,6 +166,91 @@ bool App::OnInit()
     return true;
 }
 
+//-----------------------------------------------------------------------------
+//      接線空間の圧縮結果を検証します.
+//-----------------------------------------------------------------------------
+bool App::InitTangent()
+{
+    std::vector<asdx::Vector3>  positions;
+    std::vector<asdx::Vector3>  normals;
+    std::vector<asdx::Vector2>  texcoords;
+    std::vector<uint32_t>       indices;
+    CreateTestSphere(positions, normals, texcoords, indices);
+
+    TangentSpaceData tangentSpace;
+    if (!GenerateTangents(
+        positions.data(),
+        normals  .data(),
+        texcoords.data(),
+        uint32_t(positions.size()),
+        indices.data(),
+        uint32_t(indices.size()),
+        tangentSpace))
+    {
+        ELOG("Error : GenerateTangents() Failed.");
+        return false;
+    }
+
+    // 分割した頂点は元の頂点の法線を参照する.
+    auto count = uint32_t(tangentSpace.Tangents.size());
+    m_Normals.resize(count);
+    for (auto i = 0u; i < count; ++i)
+    { m_Normals[i] = normals[tangentSpace.VertexRemap[i]]; }
+
+    m_Tangents   = tangentSpace.Tangents;
+    m_SplitCount = tangentSpace.SplitCount;
+
+    m_TangentFormat = SelectTangentFormat(
+        m_Normals.data(), m_Tangents.data(), count, m_MaxErrorDegree, &m_TangentStats);
+
+    // エンコード・デコードの所要時間を計測.
+    std::vector<uint8_t>        encoded;
+    std::vector<asdx::Vector3>  decodedNormals (count);
+    std::vector<asdx::Vector4>  decodedTangents(count);
+
+    for (auto i = 0; i < TANGENT_FORMAT_COUNT; ++i)
+    {
+        auto format = TANGENT_FORMAT(i);
+
+        auto begin = std::chrono::high_resolution_clock::now();
+        for (auto r = 0u; r < kTestRepeat; ++r)
+        {
+            if (!EncodeTangentFrames(format, m_Normals.data(), m_Tangents.data(), count, encoded))
+            {
+                ELOG("Error : EncodeTangentFrames() Failed. format = %s", GetFormatName(format));
+                return false;
+            }
+        }
+        auto middle = std::chrono::high_resolution_clock::now();
+        for (auto r = 0u; r < kTestRepeat; ++r)
+        {
+            if (!DecodeTangentFrames(format, encoded.data(), count, decodedNormals.data(), decodedTangents.data()))
+            {
+                ELOG("Error : DecodeTangentFrames() Failed. format = %s", GetFormatName(format));
+                return false;
+            }
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+
+        m_EncodeTime[i] = std::chrono::duration<double, std::milli>(middle - begin).count() / kTestRepeat;
+        m_DecodeTime[i] = std::chrono::duration<double, std::milli>(end - middle).count() / kTestRepeat;
+
+        const auto& stats = m_TangentStats[i];
+        ILOG("Info : %-10s %u bytes, normal max %.3f deg, tangent max %.3f deg, bitangent max %.3f deg, sign mismatch %u, encode %.3f ms, decode %.3f ms",
+            GetFormatName(format),
+            stats.BytesPerVertex,
+            stats.MaxNormalError,
+            stats.MaxTangentError,
+            stats.MaxBitangentError,
+            stats.SignMismatchCount,
+            m_EncodeTime[i],
+            m_DecodeTime[i]);
+    }
+
+    ILOG("Info : vertex = %u, split = %u, selected = %s", count, m_SplitCount, GetFormatName(m_TangentFormat));
+    return true;
+}
+
 //-----------------------------------------------------------------------------
 //      終了処理を行います.
 //-----------------------------------------------------------------------------
@@ -101,9 +269,48 @@ void App::OnFrameRender(asdx::FrameEventArgs& args)
 
     auto idx  = GetCurrentBackBufferIndex();
 
+    float clearColor[] = { 0.2f, 0.2f, 0.2f, 1.0f };
 
+    // カラーバッファ.
     {
-
+        asdx::ScopedBarrier barrier(
+            pCmd, m_ColorTarget[idx].GetResource(),
+            D3D12_RESOURCE_STATE_PRESENT,
+            D3D12_RESOURCE_STATE_RENDER_TARGET);
+
+        // バッファをクリア.
+        m_GfxCmdList.ClearRTV(m_ColorTarget[idx].GetRTV(), clearColor);
+
+        m_GfxCmdList.SetTarget(m_ColorTarget[idx].GetRTV(), nullptr);
+
+        asdx::GuiMgr::Instance().Update(m_Width, m_Height);
+        ImGui::SetNextWindowSize(ImVec2(520, 200), ImGuiCond_Once);
+        if (ImGui::Begin(u8"接線空間の圧縮"))
+        {
+            ImGui::Text(u8"頂点数 : %u (分割 %u)", uint32_t(m_Tangents.size()), m_SplitCount);
+            if (ImGui::DragFloat(u8"許容誤差(度)", &m_MaxErrorDegree, 0.01f, 0.0f, 180.0f, "%.2f"))
+            {
+                m_TangentFormat = SelectTangentFormat(
+                    m_Normals.data(), m_Tangents.data(), uint32_t(m_Tangents.size()), m_MaxErrorDegree, nullptr);
+            }
+            ImGui::Text(u8"選択 : %s", GetFormatName(m_TangentFormat));
+            ImGui::Separator();
+
+            for (size_t i = 0; i < m_TangentStats.size(); ++i)
+            {
+                const auto& stats = m_TangentStats[i];
+                ImGui::Text("%-10s %u B  N %.3f  T %.3f  B %.3f  enc %.3f ms  dec %.3f ms",
+                    GetFormatName(stats.Format),
+                    stats.BytesPerVertex,
+                    stats.MaxNormalError,
+                    stats.MaxTangentError,
+                    stats.MaxBitangentError,
+                    m_EncodeTime[i],
+                    m_DecodeTime[i]);
+            }
+            ImGui::End();
+        }
+        asdx::GuiMgr::Instance().Draw(pCmd);
     }
 
 
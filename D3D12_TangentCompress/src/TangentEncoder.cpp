@@ -0,0 +1,1284 @@
+﻿//-----------------------------------------------------------------------------
+// File : TangentEncoder.cpp
+// Desc : Compact Tangent Frame Encoding.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <TangentEncoder.h>
+#include <fnd/asdxLogger.h>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define TANGENT_ENCODER_SSE     (1)
+#include <emmintrin.h>
+#endif
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const float      kPi             = 3.14159265358979323846f;
+static const float      kInvSqrt2       = 0.70710678118654752440f;
+static const float      kQTangentBias   = 1.0f / 32767.0f;
+static const float      kDegenerate     = 1e-12f;       // 長さの2乗がこれ以下のベクトルは縮退とみなす.
+static const uint32_t   kOctBits        = 11;
+static const uint32_t   kOctMax         = (1u << kOctBits) - 1;
+static const uint32_t   kAngleBits      = 9;
+static const uint32_t   kAngleCount     = 1u << kAngleBits;
+
+///////////////////////////////////////////////////////////////////////////////
+// Frame structure
+///////////////////////////////////////////////////////////////////////////////
+struct Frame
+{
+    float   N[3];       // 法線.
+    float   T[3];       // 接線.
+    float   Sign;       // 従法線の符号.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// AngleTable structure
+///////////////////////////////////////////////////////////////////////////////
+struct AngleTable
+{
+    float   Cos[kAngleCount];
+    float   Sin[kAngleCount];
+
+    AngleTable()
+    {
+        for (auto i = 0u; i < kAngleCount; ++i)
+        {
+            auto angle = float(i) * (2.0f * kPi / float(kAngleCount));
+            Cos[i] = cosf(angle);
+            Sin[i] = sinf(angle);
+        }
+    }
+};
+
+//-----------------------------------------------------------------------------
+//      接線角度の三角関数テーブルを取得します.
+//-----------------------------------------------------------------------------
+const AngleTable& GetAngleTable()
+{
+    static const AngleTable s_Table;
+    return s_Table;
+}
+
+//-----------------------------------------------------------------------------
+//      外積を求めます.
+//-----------------------------------------------------------------------------
+inline void Cross(const float* a, const float* b, float* result)
+{
+    result[0] = a[1] * b[2] - a[2] * b[1];
+    result[1] = a[2] * b[0] - a[0] * b[2];
+    result[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+//-----------------------------------------------------------------------------
+//      内積を求めます.
+//-----------------------------------------------------------------------------
+inline float Dot(const float* a, const float* b)
+{ return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]; }
+
+//-----------------------------------------------------------------------------
+//      正規化します.
+//-----------------------------------------------------------------------------
+inline void Normalize(float* value)
+{
+    auto invLength = 1.0f / sqrtf(Dot(value, value));
+    value[0] *= invLength;
+    value[1] *= invLength;
+    value[2] *= invLength;
+}
+
+//-----------------------------------------------------------------------------
+//      法線と接線を正規直交化します.
+//-----------------------------------------------------------------------------
+Frame MakeFrame(const asdx::Vector3& normal, const asdx::Vector4& tangent)
+{
+    Frame result;
+    result.N[0] = normal.x;
+    result.N[1] = normal.y;
+    result.N[2] = normal.z;
+    result.Sign = (tangent.w < 0.0f) ? -1.0f : 1.0f;
+
+    if (Dot(result.N, result.N) <= kDegenerate)
+    {
+        result.N[0] = 0.0f;
+        result.N[1] = 0.0f;
+        result.N[2] = 1.0f;
+    }
+    Normalize(result.N);
+
+    float t[3] = { tangent.x, tangent.y, tangent.z };
+    auto d = Dot(result.N, t);
+    result.T[0] = t[0] - result.N[0] * d;
+    result.T[1] = t[1] - result.N[1] * d;
+    result.T[2] = t[2] - result.N[2] * d;
+
+    // 法線と平行な接線は任意の直交ベクトルに置き換える.
+    if (Dot(result.T, result.T) <= kDegenerate)
+    {
+        float axis[3] = { 1.0f, 0.0f, 0.0f };
+        if (fabsf(result.N[0]) > 0.9f)
+        {
+            axis[0] = 0.0f;
+            axis[1] = 1.0f;
+        }
+        d = Dot(result.N, axis);
+        result.T[0] = axis[0] - result.N[0] * d;
+        result.T[1] = axis[1] - result.N[1] * d;
+        result.T[2] = axis[2] - result.N[2] * d;
+    }
+    Normalize(result.T);
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      接線空間を回転クォータニオン(x, y, z, w)に変換します(w >= 0).
+//-----------------------------------------------------------------------------
+void FrameToQuat(const Frame& frame, float* q)
+{
+    // 列が (T, cross(N, T), N) の回転行列.
+    float b[3];
+    Cross(frame.N, frame.T, b);
+
+    auto m00 = frame.T[0], m01 = b[0], m02 = frame.N[0];
+    auto m10 = frame.T[1], m11 = b[1], m12 = frame.N[1];
+    auto m20 = frame.T[2], m21 = b[2], m22 = frame.N[2];
+
+    auto tw = 1.0f + m00 + m11 + m22;
+    auto tx = 1.0f + m00 - m11 - m22;
+    auto ty = 1.0f - m00 + m11 - m22;
+    auto tz = 1.0f - m00 - m11 + m22;
+
+    // SIMD版と同じ優先順位(w, x, y, z)で最大の対角項を選ぶ.
+    auto t = std::max(std::max(tw, tx), std::max(ty, tz));
+    auto k = 0.5f * sqrtf(t);
+    auto f = 0.25f / k;
+
+    if (tw == t)
+    {
+        q[0] = (m21 - m12) * f;
+        q[1] = (m02 - m20) * f;
+        q[2] = (m10 - m01) * f;
+        q[3] = k;
+    }
+    else if (tx == t)
+    {
+        q[0] = k;
+        q[1] = (m01 + m10) * f;
+        q[2] = (m02 + m20) * f;
+        q[3] = (m21 - m12) * f;
+    }
+    else if (ty == t)
+    {
+        q[0] = (m01 + m10) * f;
+        q[1] = k;
+        q[2] = (m12 + m21) * f;
+        q[3] = (m02 - m20) * f;
+    }
+    else
+    {
+        q[0] = (m02 + m20) * f;
+        q[1] = (m12 + m21) * f;
+        q[2] = k;
+        q[3] = (m10 - m01) * f;
+    }
+
+    if (q[3] < 0.0f)
+    {
+        q[0] = -q[0];
+        q[1] = -q[1];
+        q[2] = -q[2];
+        q[3] = -q[3];
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      回転クォータニオンから法線と接線を復元します.
+//-----------------------------------------------------------------------------
+void QuatToFrame(float x, float y, float z, float w, float sign, asdx::Vector3& normal, asdx::Vector4& tangent)
+{
+    auto invLength = 1.0f / sqrtf(x * x + y * y + z * z + w * w);
+    x *= invLength;
+    y *= invLength;
+    z *= invLength;
+    w *= invLength;
+
+    tangent = asdx::Vector4(
+        1.0f - 2.0f * (y * y + z * z),
+        2.0f * (x * y + w * z),
+        2.0f * (x * z - w * y),
+        sign);
+
+    normal = asdx::Vector3(
+        2.0f * (x * z + w * y),
+        2.0f * (y * z - w * x),
+        1.0f - 2.0f * (x * x + y * y));
+}
+
+//-----------------------------------------------------------------------------
+//      符号付きで四捨五入します.
+//-----------------------------------------------------------------------------
+inline int32_t RoundToInt(float value)
+{ return int32_t(value + ((value < 0.0f) ? -0.5f : 0.5f)); }
+
+//-----------------------------------------------------------------------------
+//      [0, 1] を指定ビット数の unorm に変換します.
+//-----------------------------------------------------------------------------
+inline uint32_t QuantizeUnorm(float value, uint32_t maxValue)
+{
+    value = std::min(std::max(value, 0.0f), 1.0f);
+    return uint32_t(value * float(maxValue) + 0.5f);
+}
+
+//-----------------------------------------------------------------------------
+//      八面体マッピングで [0, 1]^2 に変換します.
+//-----------------------------------------------------------------------------
+void OctEncode(const float* n, float& u, float& v)
+{
+    auto invL1 = 1.0f / (fabsf(n[0]) + fabsf(n[1]) + fabsf(n[2]));
+    auto px = n[0] * invL1;
+    auto py = n[1] * invL1;
+
+    if (n[2] < 0.0f)
+    {
+        auto ox = (1.0f - fabsf(py)) * ((px >= 0.0f) ? 1.0f : -1.0f);
+        auto oy = (1.0f - fabsf(px)) * ((py >= 0.0f) ? 1.0f : -1.0f);
+        px = ox;
+        py = oy;
+    }
+
+    u = px * 0.5f + 0.5f;
+    v = py * 0.5f + 0.5f;
+}
+
+//-----------------------------------------------------------------------------
+//      八面体マッピングから法線を復元します.
+//-----------------------------------------------------------------------------
+void OctDecode(uint32_t ox, uint32_t oy, float* n)
+{
+    auto px = float(ox) * (2.0f / float(kOctMax)) - 1.0f;
+    auto py = float(oy) * (2.0f / float(kOctMax)) - 1.0f;
+    auto pz = 1.0f - fabsf(px) - fabsf(py);
+
+    if (pz < 0.0f)
+    {
+        auto x = (1.0f - fabsf(py)) * ((px >= 0.0f) ? 1.0f : -1.0f);
+        auto y = (1.0f - fabsf(px)) * ((py >= 0.0f) ? 1.0f : -1.0f);
+        px = x;
+        py = y;
+    }
+
+    n[0] = px;
+    n[1] = py;
+    n[2] = pz;
+    Normalize(n);
+}
+
+//-----------------------------------------------------------------------------
+//      法線から接線角度の基準軸を求めます.
+//-----------------------------------------------------------------------------
+void TangentBasis(const float* n, float* t0, float* b0)
+{
+    if (fabsf(n[0]) > fabsf(n[2]))
+    {
+        t0[0] = -n[1];
+        t0[1] =  n[0];
+        t0[2] =  0.0f;
+    }
+    else
+    {
+        t0[0] =  0.0f;
+        t0[1] = -n[2];
+        t0[2] =  n[1];
+    }
+    Normalize(t0);
+    Cross(n, t0, b0);
+}
+
+//-----------------------------------------------------------------------------
+//      接線角度を量子化します.
+//-----------------------------------------------------------------------------
+inline uint32_t QuantizeAngle(float angle)
+{
+    // [-pi, pi] を正の範囲にずらしてから周期的に量子化する.
+    auto value = angle * (float(kAngleCount) / (2.0f * kPi)) + float(kAngleCount) + 0.5f;
+    return uint32_t(value) & (kAngleCount - 1);
+}
+
+//-----------------------------------------------------------------------------
+//      smallest-three の成分を量子化します.
+//-----------------------------------------------------------------------------
+inline uint32_t QuantizeSmallest(float value, uint32_t maxValue)
+{ return QuantizeUnorm(value * (kInvSqrt2 * 2.0f) * 0.5f + 0.5f, maxValue); }
+
+//-----------------------------------------------------------------------------
+//      smallest-three の成分を復元します.
+//-----------------------------------------------------------------------------
+inline float DequantizeSmallest(uint32_t value, uint32_t maxValue)
+{ return (float(value) * (2.0f / float(maxValue)) - 1.0f) * kInvSqrt2; }
+
+//-----------------------------------------------------------------------------
+//      2つの単位ベクトルのなす角を求めます(度).
+//-----------------------------------------------------------------------------
+double AngleDegree(const double* a, const double* b)
+{
+    auto la = sqrt(a[0] * a[0] + a[1] * a[1] + a[2] * a[2]);
+    auto lb = sqrt(b[0] * b[0] + b[1] * b[1] + b[2] * b[2]);
+    auto c  = (a[0] * b[0] + a[1] * b[1] + a[2] * b[2]) / (la * lb);
+    c = std::min(std::max(c, -1.0), 1.0);
+    return acos(c) * (180.0 / 3.14159265358979323846);
+}
+
+#if TANGENT_ENCODER_SSE
+///////////////////////////////////////////////////////////////////////////////
+// Frame4 structure
+///////////////////////////////////////////////////////////////////////////////
+struct Frame4
+{
+    __m128  nx, ny, nz;     // 法線.
+    __m128  tx, ty, tz;     // 接線.
+    __m128  s;              // 従法線の符号.
+};
+
+//-----------------------------------------------------------------------------
+//      マスクで選択します.
+//-----------------------------------------------------------------------------
+inline __m128 Select(__m128 mask, __m128 a, __m128 b)
+{ return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+
+//-----------------------------------------------------------------------------
+//      4要素の内積を求めます.
+//-----------------------------------------------------------------------------
+inline __m128 Dot3(__m128 ax, __m128 ay, __m128 az, __m128 bx, __m128 by, __m128 bz)
+{ return _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)), _mm_mul_ps(az, bz)); }
+
+//-----------------------------------------------------------------------------
+//      絶対値を求めます.
+//-----------------------------------------------------------------------------
+inline __m128 Abs(__m128 value)
+{ return _mm_andnot_ps(_mm_set1_ps(-0.0f), value); }
+
+//-----------------------------------------------------------------------------
+//      符号(0以上は1)を求めます.
+//-----------------------------------------------------------------------------
+inline __m128 SignNotZero(__m128 value)
+{ return _mm_or_ps(_mm_and_ps(value, _mm_set1_ps(-0.0f)), _mm_set1_ps(1.0f)); }
+
+//-----------------------------------------------------------------------------
+//      3要素を正規化します.
+//-----------------------------------------------------------------------------
+inline void Normalize3(__m128& x, __m128& y, __m128& z)
+{
+    auto invLength = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(Dot3(x, y, z, x, y, z)));
+    x = _mm_mul_ps(x, invLength);
+    y = _mm_mul_ps(y, invLength);
+    z = _mm_mul_ps(z, invLength);
+}
+
+//-----------------------------------------------------------------------------
+//      Vector3 を4つ読み込んで SoA に変換します.
+//-----------------------------------------------------------------------------
+inline void LoadVector3x4(const asdx::Vector3* pValues, __m128& x, __m128& y, __m128& z)
+{
+    auto p = reinterpret_cast<const float*>(pValues);
+    auto a = _mm_loadu_ps(p + 0);   // x0 y0 z0 x1
+    auto b = _mm_loadu_ps(p + 4);   // y1 z1 x2 y2
+    auto c = _mm_loadu_ps(p + 8);   // z2 x3 y3 z3
+
+    x = _mm_shuffle_ps(a, _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+    y = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+    z = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)), _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+}
+
+//-----------------------------------------------------------------------------
+//      SoA を Vector3 と Vector4 に書き出します.
+//-----------------------------------------------------------------------------
+inline void StoreFrame4(const Frame4& frame, asdx::Vector3* pNormals, asdx::Vector4* pTangents)
+{
+    auto nx = frame.nx, ny = frame.ny, nz = frame.nz, nw = _mm_setzero_ps();
+    _MM_TRANSPOSE4_PS(nx, ny, nz, nw);
+
+    alignas(16) float temp[4][4];
+    _mm_store_ps(temp[0], nx);
+    _mm_store_ps(temp[1], ny);
+    _mm_store_ps(temp[2], nz);
+    _mm_store_ps(temp[3], nw);
+    for (auto i = 0; i < 4; ++i)
+    { pNormals[i] = asdx::Vector3(temp[i][0], temp[i][1], temp[i][2]); }
+
+    auto tx = frame.tx, ty = frame.ty, tz = frame.tz, tw = frame.s;
+    _MM_TRANSPOSE4_PS(tx, ty, tz, tw);
+
+    auto p = reinterpret_cast<float*>(pTangents);
+    _mm_storeu_ps(p +  0, tx);
+    _mm_storeu_ps(p +  4, ty);
+    _mm_storeu_ps(p +  8, tz);
+    _mm_storeu_ps(p + 12, tw);
+}
+
+//-----------------------------------------------------------------------------
+//      4頂点を読み込んで正規直交化します.
+//-----------------------------------------------------------------------------
+inline bool LoadFrame4(const asdx::Vector3* pNormals, const asdx::Vector4* pTangents, Frame4& frame)
+{
+    LoadVector3x4(pNormals, frame.nx, frame.ny, frame.nz);
+
+    auto p  = reinterpret_cast<const float*>(pTangents);
+    auto tx = _mm_loadu_ps(p +  0);
+    auto ty = _mm_loadu_ps(p +  4);
+    auto tz = _mm_loadu_ps(p +  8);
+    auto tw = _mm_loadu_ps(p + 12);
+    _MM_TRANSPOSE4_PS(tx, ty, tz, tw);
+
+    auto eps = _mm_set1_ps(kDegenerate);
+    auto degenerate = _mm_cmple_ps(Dot3(frame.nx, frame.ny, frame.nz, frame.nx, frame.ny, frame.nz), eps);
+    Normalize3(frame.nx, frame.ny, frame.nz);
+
+    auto d = Dot3(frame.nx, frame.ny, frame.nz, tx, ty, tz);
+    frame.tx = _mm_sub_ps(tx, _mm_mul_ps(frame.nx, d));
+    frame.ty = _mm_sub_ps(ty, _mm_mul_ps(frame.ny, d));
+    frame.tz = _mm_sub_ps(tz, _mm_mul_ps(frame.nz, d));
+    degenerate = _mm_or_ps(degenerate, _mm_cmple_ps(Dot3(frame.tx, frame.ty, frame.tz, frame.tx, frame.ty, frame.tz), eps));
+    Normalize3(frame.tx, frame.ty, frame.tz);
+
+    frame.s = Select(_mm_cmplt_ps(tw, _mm_setzero_ps()), _mm_set1_ps(-1.0f), _mm_set1_ps(1.0f));
+
+    // 縮退した頂点を含む場合はスカラー版で処理する.
+    return _mm_movemask_ps(degenerate) == 0;
+}
+
+//-----------------------------------------------------------------------------
+//      接線空間を回転クォータニオンに変換します(w >= 0).
+//-----------------------------------------------------------------------------
+inline void FrameToQuat4(const Frame4& frame, __m128& qx, __m128& qy, __m128& qz, __m128& qw)
+{
+    // b = cross(n, t).
+    auto bx = _mm_sub_ps(_mm_mul_ps(frame.ny, frame.tz), _mm_mul_ps(frame.nz, frame.ty));
+    auto by = _mm_sub_ps(_mm_mul_ps(frame.nz, frame.tx), _mm_mul_ps(frame.nx, frame.tz));
+    auto bz = _mm_sub_ps(_mm_mul_ps(frame.nx, frame.ty), _mm_mul_ps(frame.ny, frame.tx));
+
+    auto m00 = frame.tx, m01 = bx, m02 = frame.nx;
+    auto m10 = frame.ty, m11 = by, m12 = frame.ny;
+    auto m20 = frame.tz, m21 = bz, m22 = frame.nz;
+
+    auto one = _mm_set1_ps(1.0f);
+    auto tw = _mm_add_ps(_mm_add_ps(one, m00), _mm_add_ps(m11, m22));
+    auto tx = _mm_sub_ps(_mm_add_ps(one, m00), _mm_add_ps(m11, m22));
+    auto ty = _mm_sub_ps(_mm_add_ps(one, m11), _mm_add_ps(m00, m22));
+    auto tz = _mm_sub_ps(_mm_add_ps(one, m22), _mm_add_ps(m00, m11));
+
+    auto t = _mm_max_ps(_mm_max_ps(tw, tx), _mm_max_ps(ty, tz));
+    auto k = _mm_mul_ps(_mm_set1_ps(0.5f), _mm_sqrt_ps(t));
+    auto f = _mm_div_ps(_mm_set1_ps(0.25f), k);
+
+    auto selW = _mm_cmpeq_ps(tw, t);
+    auto selX = _mm_andnot_ps(selW, _mm_cmpeq_ps(tx, t));
+    auto selY = _mm_andnot_ps(_mm_or_ps(selW, selX), _mm_cmpeq_ps(ty, t));
+
+    auto d1  = _mm_mul_ps(_mm_sub_ps(m21, m12), f);
+    auto d2  = _mm_mul_ps(_mm_sub_ps(m02, m20), f);
+    auto d3  = _mm_mul_ps(_mm_sub_ps(m10, m01), f);
+    auto s01 = _mm_mul_ps(_mm_add_ps(m01, m10), f);
+    auto s02 = _mm_mul_ps(_mm_add_ps(m02, m20), f);
+    auto s12 = _mm_mul_ps(_mm_add_ps(m12, m21), f);
+
+    qx = Select(selW, d1, Select(selX, k,   Select(selY, s01, s02)));
+    qy = Select(selW, d2, Select(selX, s01, Select(selY, k,   s12)));
+    qz = Select(selW, d3, Select(selX, s02, Select(selY, s12, k  )));
+    qw = Select(selW, k,  Select(selX, d1,  Select(selY, d2,  d3 )));
+
+    auto flip = _mm_and_ps(_mm_cmplt_ps(qw, _mm_setzero_ps()), _mm_set1_ps(-0.0f));
+    qx = _mm_xor_ps(qx, flip);
+    qy = _mm_xor_ps(qy, flip);
+    qz = _mm_xor_ps(qz, flip);
+    qw = _mm_xor_ps(qw, flip);
+}
+
+//-----------------------------------------------------------------------------
+//      回転クォータニオンから法線と接線を復元します.
+//-----------------------------------------------------------------------------
+inline void QuatToFrame4(__m128 x, __m128 y, __m128 z, __m128 w, Frame4& frame)
+{
+    auto invLength = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(
+        _mm_add_ps(Dot3(x, y, z, x, y, z), _mm_mul_ps(w, w))));
+    x = _mm_mul_ps(x, invLength);
+    y = _mm_mul_ps(y, invLength);
+    z = _mm_mul_ps(z, invLength);
+    w = _mm_mul_ps(w, invLength);
+
+    auto one = _mm_set1_ps(1.0f);
+    auto two = _mm_set1_ps(2.0f);
+    auto xx = _mm_mul_ps(x, x), yy = _mm_mul_ps(y, y), zz = _mm_mul_ps(z, z);
+    auto xy = _mm_mul_ps(x, y), xz = _mm_mul_ps(x, z), yz = _mm_mul_ps(y, z);
+    auto wx = _mm_mul_ps(w, x), wy = _mm_mul_ps(w, y), wz = _mm_mul_ps(w, z);
+
+    frame.tx = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz)));
+    frame.ty = _mm_mul_ps(two, _mm_add_ps(xy, wz));
+    frame.tz = _mm_mul_ps(two, _mm_sub_ps(xz, wy));
+
+    frame.nx = _mm_mul_ps(two, _mm_add_ps(xz, wy));
+    frame.ny = _mm_mul_ps(two, _mm_sub_ps(yz, wx));
+    frame.nz = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy)));
+}
+
+//-----------------------------------------------------------------------------
+//      符号付きで四捨五入して整数に変換します.
+//-----------------------------------------------------------------------------
+inline __m128i RoundToInt4(__m128 value)
+{
+    auto half = _mm_or_ps(_mm_and_ps(value, _mm_set1_ps(-0.0f)), _mm_set1_ps(0.5f));
+    return _mm_cvttps_epi32(_mm_add_ps(value, half));
+}
+
+//-----------------------------------------------------------------------------
+//      [0, 1] を unorm に変換します.
+//-----------------------------------------------------------------------------
+inline __m128i QuantizeUnorm4(__m128 value, uint32_t maxValue)
+{
+    value = _mm_min_ps(_mm_max_ps(value, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+    return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(value, _mm_set1_ps(float(maxValue))), _mm_set1_ps(0.5f)));
+}
+
+//-----------------------------------------------------------------------------
+//      atan2 を近似します(最大誤差 1e-5 ラジアン程度).
+//-----------------------------------------------------------------------------
+inline __m128 Atan2(__m128 y, __m128 x)
+{
+    auto ax = Abs(x);
+    auto ay = Abs(y);
+    auto mx = _mm_max_ps(ax, ay);
+    auto mn = _mm_min_ps(ax, ay);
+    auto a  = _mm_div_ps(mn, _mm_max_ps(mx, _mm_set1_ps(1e-30f)));
+    auto s  = _mm_mul_ps(a, a);
+
+    auto r = _mm_set1_ps(-0.0464964749f);
+    r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps(0.15931422f));
+    r = _mm_sub_ps(_mm_mul_ps(r, s), _mm_set1_ps(0.327622764f));
+    r = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(r, s), a), a);
+
+    r = Select(_mm_cmpgt_ps(ay, ax), _mm_sub_ps(_mm_set1_ps(0.5f * kPi), r), r);
+    r = Select(_mm_cmplt_ps(x, _mm_setzero_ps()), _mm_sub_ps(_mm_set1_ps(kPi), r), r);
+    return _mm_xor_ps(r, _mm_and_ps(y, _mm_set1_ps(-0.0f)));
+}
+
+//-----------------------------------------------------------------------------
+//      整数の一致でマスクを作成します.
+//-----------------------------------------------------------------------------
+inline __m128 Equal(__m128i value, int32_t target)
+{ return _mm_castsi128_ps(_mm_cmpeq_epi32(value, _mm_set1_epi32(target))); }
+
+//-----------------------------------------------------------------------------
+//      QTangent を4頂点分エンコードします.
+//-----------------------------------------------------------------------------
+void EncodeQTangent4(const Frame4& frame, uint8_t* pOutput)
+{
+    __m128 qx, qy, qz, qw;
+    FrameToQuat4(frame, qx, qy, qz, qw);
+
+    // w が 0 だと符号を保持できないのでバイアスを掛ける.
+    auto bias  = _mm_set1_ps(kQTangentBias);
+    auto small = _mm_cmplt_ps(qw, bias);
+    auto scale = _mm_div_ps(_mm_set1_ps(sqrtf(1.0f - kQTangentBias * kQTangentBias)), _mm_sqrt_ps(Dot3(qx, qy, qz, qx, qy, qz)));
+    scale = Select(small, scale, _mm_set1_ps(1.0f));
+    qx = _mm_mul_ps(qx, scale);
+    qy = _mm_mul_ps(qy, scale);
+    qz = _mm_mul_ps(qz, scale);
+    qw = _mm_max_ps(qw, bias);
+
+    // 従法線の符号を w の符号に格納.
+    auto full = _mm_set1_ps(32767.0f);
+    auto s = _mm_mul_ps(frame.s, full);
+    auto ix = _mm_castsi128_ps(RoundToInt4(_mm_mul_ps(qx, s)));
+    auto iy = _mm_castsi128_ps(RoundToInt4(_mm_mul_ps(qy, s)));
+    auto iz = _mm_castsi128_ps(RoundToInt4(_mm_mul_ps(qz, s)));
+    auto iw = _mm_castsi128_ps(RoundToInt4(_mm_mul_ps(qw, s)));
+    _MM_TRANSPOSE4_PS(ix, iy, iz, iw);
+
+    auto lo = _mm_packs_epi32(_mm_castps_si128(ix), _mm_castps_si128(iy));
+    auto hi = _mm_packs_epi32(_mm_castps_si128(iz), _mm_castps_si128(iw));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(pOutput +  0), lo);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(pOutput + 16), hi);
+}
+
+//-----------------------------------------------------------------------------
+//      QTangent を4頂点分デコードします.
+//-----------------------------------------------------------------------------
+void DecodeQTangent4(const uint8_t* pInput, Frame4& frame)
+{
+    auto lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pInput +  0));
+    auto hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pInput + 16));
+
+    // 符号拡張して頂点ごとの (x, y, z, w) に展開.
+    auto v0 = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(lo, lo), 16));
+    auto v1 = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(lo, lo), 16));
+    auto v2 = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(hi, hi), 16));
+    auto v3 = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(hi, hi), 16));
+    _MM_TRANSPOSE4_PS(v0, v1, v2, v3);
+
+    auto scale = _mm_set1_ps(1.0f / 32767.0f);
+    auto minus = _mm_set1_ps(-1.0f);
+    auto x = _mm_max_ps(_mm_mul_ps(v0, scale), minus);
+    auto y = _mm_max_ps(_mm_mul_ps(v1, scale), minus);
+    auto z = _mm_max_ps(_mm_mul_ps(v2, scale), minus);
+    auto w = _mm_max_ps(_mm_mul_ps(v3, scale), minus);
+
+    QuatToFrame4(x, y, z, w, frame);
+    frame.s = SignNotZero(w);
+}
+
+//-----------------------------------------------------------------------------
+//      八面体法線 + 接線角度を4頂点分エンコードします.
+//-----------------------------------------------------------------------------
+void EncodeOctAngle4(const Frame4& frame, uint8_t* pOutput)
+{
+    auto one = _mm_set1_ps(1.0f);
+    auto half = _mm_set1_ps(0.5f);
+
+    auto invL1 = _mm_div_ps(one, _mm_add_ps(_mm_add_ps(Abs(frame.nx), Abs(frame.ny)), Abs(frame.nz)));
+    auto px = _mm_mul_ps(frame.nx, invL1);
+    auto py = _mm_mul_ps(frame.ny, invL1);
+
+    auto lower = _mm_cmplt_ps(frame.nz, _mm_setzero_ps());
+    auto wx = _mm_mul_ps(_mm_sub_ps(one, Abs(py)), SignNotZero(px));
+    auto wy = _mm_mul_ps(_mm_sub_ps(one, Abs(px)), SignNotZero(py));
+    px = Select(lower, wx, px);
+    py = Select(lower, wy, py);
+
+    auto ox = QuantizeUnorm4(_mm_add_ps(_mm_mul_ps(px, half), half), kOctMax);
+    auto oy = QuantizeUnorm4(_mm_add_ps(_mm_mul_ps(py, half), half), kOctMax);
+
+    // デコード側と同じ量子化後の法線から基準軸を求める.
+    auto scale = _mm_set1_ps(2.0f / float(kOctMax));
+    auto dx = _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(ox), scale), one);
+    auto dy = _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(oy), scale), one);
+    auto dz = _mm_sub_ps(_mm_sub_ps(one, Abs(dx)), Abs(dy));
+    auto fold = _mm_cmplt_ps(dz, _mm_setzero_ps());
+    auto fx = _mm_mul_ps(_mm_sub_ps(one, Abs(dy)), SignNotZero(dx));
+    auto fy = _mm_mul_ps(_mm_sub_ps(one, Abs(dx)), SignNotZero(dy));
+    dx = Select(fold, fx, dx);
+    dy = Select(fold, fy, dy);
+    Normalize3(dx, dy, dz);
+
+    auto useX = _mm_cmpgt_ps(Abs(dx), Abs(dz));
+    auto zero = _mm_setzero_ps();
+    auto t0x = Select(useX, _mm_sub_ps(zero, dy), zero);
+    auto t0y = Select(useX, dx, _mm_sub_ps(zero, dz));
+    auto t0z = Select(useX, zero, dy);
+    Normalize3(t0x, t0y, t0z);
+
+    auto b0x = _mm_sub_ps(_mm_mul_ps(dy, t0z), _mm_mul_ps(dz, t0y));
+    auto b0y = _mm_sub_ps(_mm_mul_ps(dz, t0x), _mm_mul_ps(dx, t0z));
+    auto b0z = _mm_sub_ps(_mm_mul_ps(dx, t0y), _mm_mul_ps(dy, t0x));
+
+    auto angle = Atan2(
+        Dot3(frame.tx, frame.ty, frame.tz, b0x, b0y, b0z),
+        Dot3(frame.tx, frame.ty, frame.tz, t0x, t0y, t0z));
+
+    auto a = _mm_add_ps(_mm_mul_ps(angle, _mm_set1_ps(float(kAngleCount) / (2.0f * kPi))), _mm_set1_ps(float(kAngleCount) + 0.5f));
+    auto ia = _mm_and_si128(_mm_cvttps_epi32(a), _mm_set1_epi32(kAngleCount - 1));
+
+    auto sign = _mm_castps_si128(_mm_and_ps(frame.s, _mm_set1_ps(-0.0f)));
+
+    auto bits = _mm_or_si128(
+        _mm_or_si128(ox, _mm_slli_epi32(oy, kOctBits)),
+        _mm_or_si128(_mm_slli_epi32(ia, kOctBits * 2), sign));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(pOutput), bits);
+}
+
+//-----------------------------------------------------------------------------
+//      八面体法線 + 接線角度を4頂点分デコードします.
+//-----------------------------------------------------------------------------
+void DecodeOctAngle4(const uint8_t* pInput, Frame4& frame)
+{
+    auto bits = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pInput));
+    auto mask = _mm_set1_epi32(kOctMax);
+    auto ox = _mm_and_si128(bits, mask);
+    auto oy = _mm_and_si128(_mm_srli_epi32(bits, kOctBits), mask);
+    auto ia = _mm_and_si128(_mm_srli_epi32(bits, kOctBits * 2), _mm_set1_epi32(kAngleCount - 1));
+
+    auto one = _mm_set1_ps(1.0f);
+    auto scale = _mm_set1_ps(2.0f / float(kOctMax));
+    auto dx = _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(ox), scale), one);
+    auto dy = _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(oy), scale), one);
+    auto dz = _mm_sub_ps(_mm_sub_ps(one, Abs(dx)), Abs(dy));
+    auto fold = _mm_cmplt_ps(dz, _mm_setzero_ps());
+    auto fx = _mm_mul_ps(_mm_sub_ps(one, Abs(dy)), SignNotZero(dx));
+    auto fy = _mm_mul_ps(_mm_sub_ps(one, Abs(dx)), SignNotZero(dy));
+    dx = Select(fold, fx, dx);
+    dy = Select(fold, fy, dy);
+    Normalize3(dx, dy, dz);
+
+    auto useX = _mm_cmpgt_ps(Abs(dx), Abs(dz));
+    auto zero = _mm_setzero_ps();
+    auto t0x = Select(useX, _mm_sub_ps(zero, dy), zero);
+    auto t0y = Select(useX, dx, _mm_sub_ps(zero, dz));
+    auto t0z = Select(useX, zero, dy);
+    Normalize3(t0x, t0y, t0z);
+
+    auto b0x = _mm_sub_ps(_mm_mul_ps(dy, t0z), _mm_mul_ps(dz, t0y));
+    auto b0y = _mm_sub_ps(_mm_mul_ps(dz, t0x), _mm_mul_ps(dx, t0z));
+    auto b0z = _mm_sub_ps(_mm_mul_ps(dx, t0y), _mm_mul_ps(dy, t0x));
+
+    // 角度は 512 段階なのでテーブルから引く.
+    alignas(16) int32_t index[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(index), ia);
+
+    const auto& table = GetAngleTable();
+    auto c = _mm_setr_ps(table.Cos[index[0]], table.Cos[index[1]], table.Cos[index[2]], table.Cos[index[3]]);
+    auto s = _mm_setr_ps(table.Sin[index[0]], table.Sin[index[1]], table.Sin[index[2]], table.Sin[index[3]]);
+
+    frame.nx = dx;
+    frame.ny = dy;
+    frame.nz = dz;
+    frame.tx = _mm_add_ps(_mm_mul_ps(t0x, c), _mm_mul_ps(b0x, s));
+    frame.ty = _mm_add_ps(_mm_mul_ps(t0y, c), _mm_mul_ps(b0y, s));
+    frame.tz = _mm_add_ps(_mm_mul_ps(t0z, c), _mm_mul_ps(b0z, s));
+
+    auto sign = _mm_castsi128_ps(_mm_and_si128(bits, _mm_set1_epi32(int32_t(0x80000000u))));
+    frame.s = _mm_or_ps(sign, one);
+}
+
+//-----------------------------------------------------------------------------
+//      smallest-three クォータニオンを4頂点分エンコードします.
+//-----------------------------------------------------------------------------
+void EncodeFrame32x4(const Frame4& frame, uint8_t* pOutput)
+{
+    __m128 qx, qy, qz, qw;
+    FrameToQuat4(frame, qx, qy, qz, qw);
+
+    auto ax = Abs(qx), ay = Abs(qy), az = Abs(qz), aw = Abs(qw);
+    auto m = _mm_max_ps(_mm_max_ps(ax, ay), _mm_max_ps(az, aw));
+
+    // スカラー版と同じ優先順位(x, y, z, w)で最大成分を選ぶ.
+    auto isX = _mm_cmpeq_ps(ax, m);
+    auto isY = _mm_andnot_ps(isX, _mm_cmpeq_ps(ay, m));
+    auto isZ = _mm_andnot_ps(_mm_or_ps(isX, isY), _mm_cmpeq_ps(az, m));
+    auto isW = _mm_andnot_ps(_mm_or_ps(_mm_or_ps(isX, isY), isZ), _mm_castsi128_ps(_mm_set1_epi32(-1)));
+
+    // 最大成分が正になるよう符号を反転.
+    auto largest = Select(isX, qx, Select(isY, qy, Select(isZ, qz, qw)));
+    auto flip = _mm_and_ps(_mm_cmplt_ps(largest, _mm_setzero_ps()), _mm_set1_ps(-0.0f));
+    qx = _mm_xor_ps(qx, flip);
+    qy = _mm_xor_ps(qy, flip);
+    qz = _mm_xor_ps(qz, flip);
+    qw = _mm_xor_ps(qw, flip);
+
+    auto a = Select(isX, qy, qx);
+    auto b = Select(_mm_or_ps(isX, isY), qz, qy);
+    auto c = Select(isW, qz, qw);
+
+    auto scale = _mm_set1_ps(kInvSqrt2 * 2.0f * 0.5f);
+    auto half  = _mm_set1_ps(0.5f);
+    auto ia = QuantizeUnorm4(_mm_add_ps(_mm_mul_ps(a, scale), half), 1023);
+    auto ib = QuantizeUnorm4(_mm_add_ps(_mm_mul_ps(b, scale), half), 1023);
+    auto ic = QuantizeUnorm4(_mm_add_ps(_mm_mul_ps(c, scale), half), 511);
+
+    auto k = _mm_or_si128(
+        _mm_or_si128(_mm_and_si128(_mm_castps_si128(isY), _mm_set1_epi32(1)),
+                     _mm_and_si128(_mm_castps_si128(isZ), _mm_set1_epi32(2))),
+        _mm_and_si128(_mm_castps_si128(isW), _mm_set1_epi32(3)));
+
+    auto reflect = _mm_and_si128(_mm_castps_si128(_mm_cmplt_ps(frame.s, _mm_setzero_ps())), _mm_set1_epi32(1 << 29));
+
+    auto bits = _mm_or_si128(
+        _mm_or_si128(ia, _mm_slli_epi32(ib, 10)),
+        _mm_or_si128(_mm_or_si128(_mm_slli_epi32(ic, 20), reflect), _mm_slli_epi32(k, 30)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(pOutput), bits);
+}
+
+//-----------------------------------------------------------------------------
+//      smallest-three クォータニオンを4頂点分デコードします.
+//-----------------------------------------------------------------------------
+void DecodeFrame32x4(const uint8_t* pInput, Frame4& frame)
+{
+    auto bits = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pInput));
+
+    auto one   = _mm_set1_ps(1.0f);
+    auto scale10 = _mm_set1_ps(2.0f / 1023.0f);
+    auto scale9  = _mm_set1_ps(2.0f / 511.0f);
+    auto invSqrt2 = _mm_set1_ps(kInvSqrt2);
+
+    auto a = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(bits, _mm_set1_epi32(1023))), scale10), one), invSqrt2);
+    auto b = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(bits, 10), _mm_set1_epi32(1023))), scale10), one), invSqrt2);
+    auto c = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(bits, 20), _mm_set1_epi32(511))), scale9), one), invSqrt2);
+    auto k = _mm_srli_epi32(bits, 30);
+
+    auto l = _mm_sqrt_ps(_mm_max_ps(_mm_sub_ps(one, Dot3(a, b, c, a, b, c)), _mm_setzero_ps()));
+
+    auto isX = Equal(k, 0);
+    auto isY = Equal(k, 1);
+    auto isZ = Equal(k, 2);
+    auto isW = Equal(k, 3);
+
+    auto x = Select(isX, l, a);
+    auto y = Select(isX, a, Select(isY, l, b));
+    auto z = Select(_mm_or_ps(isX, isY), b, Select(isZ, l, c));
+    auto w = Select(isW, l, c);
+
+    QuatToFrame4(x, y, z, w, frame);
+
+    auto reflect = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(bits, _mm_set1_epi32(1 << 29)), _mm_setzero_si128()));
+    frame.s = Select(reflect, one, _mm_set1_ps(-1.0f));
+}
+#endif//TANGENT_ENCODER_SSE
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      頂点あたりのバイト数を取得します.
+//-----------------------------------------------------------------------------
+uint32_t GetTangentFormatSize(TANGENT_FORMAT format)
+{
+    switch (format)
+    {
+    case TANGENT_FORMAT_QTANGENT16:  return sizeof(uint64_t);
+    case TANGENT_FORMAT_OCT_ANGLE32: return sizeof(uint32_t);
+    case TANGENT_FORMAT_FRAME32:     return sizeof(uint32_t);
+    default:                         return 0;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      QTangent にエンコードします.
+//-----------------------------------------------------------------------------
+uint64_t EncodeQTangent(const asdx::Vector3& normal, const asdx::Vector4& tangent)
+{
+    auto frame = MakeFrame(normal, tangent);
+
+    float q[4];
+    FrameToQuat(frame, q);
+
+    // w が 0 だと符号を保持できないのでバイアスを掛ける.
+    if (q[3] < kQTangentBias)
+    {
+        auto scale = sqrtf(1.0f - kQTangentBias * kQTangentBias) / sqrtf(q[0] * q[0] + q[1] * q[1] + q[2] * q[2]);
+        q[0] *= scale;
+        q[1] *= scale;
+        q[2] *= scale;
+        q[3] = kQTangentBias;
+    }
+
+    uint64_t result = 0;
+    for (auto i = 0; i < 4; ++i)
+    {
+        auto value = RoundToInt(q[i] * frame.Sign * 32767.0f);
+        value = std::min(std::max(value, -32767), 32767);
+        result |= uint64_t(uint16_t(int16_t(value))) << (16 * i);
+    }
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      QTangent をデコードします.
+//-----------------------------------------------------------------------------
+void DecodeQTangent(uint64_t value, asdx::Vector3& normal, asdx::Vector4& tangent)
+{
+    float q[4];
+    for (auto i = 0; i < 4; ++i)
+    {
+        auto v = int16_t(uint16_t(value >> (16 * i)));
+        q[i] = std::max(float(v) / 32767.0f, -1.0f);
+    }
+
+    QuatToFrame(q[0], q[1], q[2], q[3], (q[3] < 0.0f) ? -1.0f : 1.0f, normal, tangent);
+}
+
+//-----------------------------------------------------------------------------
+//      八面体法線 + 接線角度にエンコードします.
+//-----------------------------------------------------------------------------
+uint32_t EncodeOctAngle(const asdx::Vector3& normal, const asdx::Vector4& tangent)
+{
+    auto frame = MakeFrame(normal, tangent);
+
+    float u, v;
+    OctEncode(frame.N, u, v);
+
+    auto ox = QuantizeUnorm(u, kOctMax);
+    auto oy = QuantizeUnorm(v, kOctMax);
+
+    // デコード側と同じ量子化後の法線から基準軸を求める.
+    float n[3], t0[3], b0[3];
+    OctDecode(ox, oy, n);
+    TangentBasis(n, t0, b0);
+
+    auto angle = atan2f(Dot(frame.T, b0), Dot(frame.T, t0));
+    auto ia = QuantizeAngle(angle);
+
+    auto sign = (frame.Sign < 0.0f) ? 0x80000000u : 0u;
+    return ox | (oy << kOctBits) | (ia << (kOctBits * 2)) | sign;
+}
+
+//-----------------------------------------------------------------------------
+//      八面体法線 + 接線角度をデコードします.
+//-----------------------------------------------------------------------------
+void DecodeOctAngle(uint32_t value, asdx::Vector3& normal, asdx::Vector4& tangent)
+{
+    auto ox = value & kOctMax;
+    auto oy = (value >> kOctBits) & kOctMax;
+    auto ia = (value >> (kOctBits * 2)) & (kAngleCount - 1);
+
+    float n[3], t0[3], b0[3];
+    OctDecode(ox, oy, n);
+    TangentBasis(n, t0, b0);
+
+    const auto& table = GetAngleTable();
+    auto c = table.Cos[ia];
+    auto s = table.Sin[ia];
+
+    normal  = asdx::Vector3(n[0], n[1], n[2]);
+    tangent = asdx::Vector4(
+        t0[0] * c + b0[0] * s,
+        t0[1] * c + b0[1] * s,
+        t0[2] * c + b0[2] * s,
+        (value & 0x80000000u) ? -1.0f : 1.0f);
+}
+
+//-----------------------------------------------------------------------------
+//      32bit の smallest-three クォータニオンにエンコードします.
+//-----------------------------------------------------------------------------
+uint32_t EncodeFrame32(const asdx::Vector3& normal, const asdx::Vector4& tangent)
+{
+    auto frame = MakeFrame(normal, tangent);
+
+    float q[4];
+    FrameToQuat(frame, q);
+
+    // 最大成分を探す.
+    uint32_t k = 0;
+    for (auto i = 1u; i < 4; ++i)
+    {
+        if (fabsf(q[i]) > fabsf(q[k]))
+        { k = i; }
+    }
+
+    // 最大成分が正になるよう符号を反転.
+    if (q[k] < 0.0f)
+    {
+        for (auto i = 0; i < 4; ++i)
+        { q[i] = -q[i]; }
+    }
+
+    float rest[3];
+    for (auto i = 0u, j = 0u; i < 4; ++i)
+    {
+        if (i != k)
+        { rest[j++] = q[i]; }
+    }
+
+    auto reflect = (frame.Sign < 0.0f) ? (1u << 29) : 0u;
+    return QuantizeSmallest(rest[0], 1023)
+        | (QuantizeSmallest(rest[1], 1023) << 10)
+        | (QuantizeSmallest(rest[2], 511)  << 20)
+        | reflect
+        | (k << 30);
+}
+
+//-----------------------------------------------------------------------------
+//      32bit の smallest-three クォータニオンをデコードします.
+//-----------------------------------------------------------------------------
+void DecodeFrame32(uint32_t value, asdx::Vector3& normal, asdx::Vector4& tangent)
+{
+    float rest[3];
+    rest[0] = DequantizeSmallest(value & 1023, 1023);
+    rest[1] = DequantizeSmallest((value >> 10) & 1023, 1023);
+    rest[2] = DequantizeSmallest((value >> 20) & 511, 511);
+
+    auto k = value >> 30;
+    auto l = sqrtf(std::max(1.0f - (rest[0] * rest[0] + rest[1] * rest[1] + rest[2] * rest[2]), 0.0f));
+
+    float q[4];
+    for (auto i = 0u, j = 0u; i < 4; ++i)
+    { q[i] = (i == k) ? l : rest[j++]; }
+
+    QuatToFrame(q[0], q[1], q[2], q[3], (value & (1u << 29)) ? -1.0f : 1.0f, normal, tangent);
+}
+
+//-----------------------------------------------------------------------------
+//      接線空間をまとめてエンコードします.
+//-----------------------------------------------------------------------------
+bool EncodeTangentFrames
+(
+    TANGENT_FORMAT          format,
+    const asdx::Vector3*    pNormals,
+    const asdx::Vector4*    pTangents,
+    uint32_t                count,
+    std::vector<uint8_t>&   result
+)
+{
+    auto stride = GetTangentFormatSize(format);
+    if (stride == 0 || (count > 0 && (pNormals == nullptr || pTangents == nullptr)))
+    {
+        ELOG("Error : Invalid Argument.");
+        return false;
+    }
+
+    result.resize(size_t(stride) * count);
+    auto pOutput = result.data();
+
+    auto EncodeScalar = [&](uint32_t i)
+    {
+        auto dst = pOutput + size_t(stride) * i;
+        switch (format)
+        {
+        case TANGENT_FORMAT_QTANGENT16:
+            {
+                auto value = EncodeQTangent(pNormals[i], pTangents[i]);
+                memcpy(dst, &value, sizeof(value));
+            }
+            break;
+
+        case TANGENT_FORMAT_OCT_ANGLE32:
+            {
+                auto value = EncodeOctAngle(pNormals[i], pTangents[i]);
+                memcpy(dst, &value, sizeof(value));
+            }
+            break;
+
+        case TANGENT_FORMAT_FRAME32:
+            {
+                auto value = EncodeFrame32(pNormals[i], pTangents[i]);
+                memcpy(dst, &value, sizeof(value));
+            }
+            break;
+
+        default:
+            break;
+        }
+    };
+
+    auto i = 0u;
+
+#if TANGENT_ENCODER_SSE
+    for (; i + 4 <= count; i += 4)
+    {
+        Frame4 frame;
+        if (!LoadFrame4(pNormals + i, pTangents + i, frame))
+        {
+            for (auto j = 0u; j < 4; ++j)
+            { EncodeScalar(i + j); }
+            continue;
+        }
+
+        auto dst = pOutput + size_t(stride) * i;
+        switch (format)
+        {
+        case TANGENT_FORMAT_QTANGENT16:  EncodeQTangent4(frame, dst); break;
+        case TANGENT_FORMAT_OCT_ANGLE32: EncodeOctAngle4(frame, dst); break;
+        case TANGENT_FORMAT_FRAME32:     EncodeFrame32x4(frame, dst); break;
+        default: break;
+        }
+    }
+#endif//TANGENT_ENCODER_SSE
+
+    for (; i < count; ++i)
+    { EncodeScalar(i); }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      接線空間をまとめてデコードします.
+//-----------------------------------------------------------------------------
+bool DecodeTangentFrames
+(
+    TANGENT_FORMAT          format,
+    const uint8_t*          pData,
+    uint32_t                count,
+    asdx::Vector3*          pNormals,
+    asdx::Vector4*          pTangents
+)
+{
+    auto stride = GetTangentFormatSize(format);
+    if (stride == 0 || (count > 0 && (pData == nullptr || pNormals == nullptr || pTangents == nullptr)))
+    {
+        ELOG("Error : Invalid Argument.");
+        return false;
+    }
+
+    auto i = 0u;
+
+#if TANGENT_ENCODER_SSE
+    for (; i + 4 <= count; i += 4)
+    {
+        Frame4 frame;
+        auto src = pData + size_t(stride) * i;
+        switch (format)
+        {
+        case TANGENT_FORMAT_QTANGENT16:  DecodeQTangent4(src, frame); break;
+        case TANGENT_FORMAT_OCT_ANGLE32: DecodeOctAngle4(src, frame); break;
+        case TANGENT_FORMAT_FRAME32:     DecodeFrame32x4(src, frame); break;
+        default: break;
+        }
+        StoreFrame4(frame, pNormals + i, pTangents + i);
+    }
+#endif//TANGENT_ENCODER_SSE
+
+    for (; i < count; ++i)
+    {
+        auto src = pData + size_t(stride) * i;
+        switch (format)
+        {
+        case TANGENT_FORMAT_QTANGENT16:
+            {
+                uint64_t value;
+                memcpy(&value, src, sizeof(value));
+                DecodeQTangent(value, pNormals[i], pTangents[i]);
+            }
+            break;
+
+        case TANGENT_FORMAT_OCT_ANGLE32:
+            {
+                uint32_t value;
+                memcpy(&value, src, sizeof(value));
+                DecodeOctAngle(value, pNormals[i], pTangents[i]);
+            }
+            break;
+
+        case TANGENT_FORMAT_FRAME32:
+            {
+                uint32_t value;
+                memcpy(&value, src, sizeof(value));
+                DecodeFrame32(value, pNormals[i], pTangents[i]);
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      浮動小数の接線空間に対する誤差を集計します.
+//-----------------------------------------------------------------------------
+TangentErrorStatistics ComputeTangentError
+(
+    TANGENT_FORMAT          format,
+    const asdx::Vector3*    pNormals,
+    const asdx::Vector4*    pTangents,
+    uint32_t                count
+)
+{
+    TangentErrorStatistics result;
+    result.Format         = format;
+    result.BytesPerVertex = GetTangentFormatSize(format);
+    result.VertexCount    = count;
+
+    std::vector<uint8_t> encoded;
+    if (count == 0 || !EncodeTangentFrames(format, pNormals, pTangents, count, encoded))
+    { return result; }
+
+    std::vector<asdx::Vector3> normals(count);
+    std::vector<asdx::Vector4> tangents(count);
+    DecodeTangentFrames(format, encoded.data(), count, normals.data(), tangents.data());
+
+    double sumNormal  = 0.0;
+    double sumTangent = 0.0;
+
+    for (auto i = 0u; i < count; ++i)
+    {
+        auto ref = MakeFrame(pNormals[i], pTangents[i]);
+
+        double n0[3] = { ref.N[0], ref.N[1], ref.N[2] };
+        double t0[3] = { ref.T[0], ref.T[1], ref.T[2] };
+        double b0[3] = {
+            (n0[1] * t0[2] - n0[2] * t0[1]) * ref.Sign,
+            (n0[2] * t0[0] - n0[0] * t0[2]) * ref.Sign,
+            (n0[0] * t0[1] - n0[1] * t0[0]) * ref.Sign };
+
+        const auto& n = normals[i];
+        const auto& t = tangents[i];
+        double n1[3] = { n.x, n.y, n.z };
+        double t1[3] = { t.x, t.y, t.z };
+        double s1 = (t.w < 0.0f) ? -1.0 : 1.0;
+        double b1[3] = {
+            (n1[1] * t1[2] - n1[2] * t1[1]) * s1,
+            (n1[2] * t1[0] - n1[0] * t1[2]) * s1,
+            (n1[0] * t1[1] - n1[1] * t1[0]) * s1 };
+
+        auto errorN = AngleDegree(n0, n1);
+        auto errorT = AngleDegree(t0, t1);
+        auto errorB = AngleDegree(b0, b1);
+
+        result.MaxNormalError    = std::max(result.MaxNormalError,    float(errorN));
+        result.MaxTangentError   = std::max(result.MaxTangentError,   float(errorT));
+        result.MaxBitangentError = std::max(result.MaxBitangentError, float(errorB));
+        sumNormal  += errorN;
+        sumTangent += errorT;
+
+        if (s1 != double(ref.Sign))
+        { result.SignMismatchCount++; }
+    }
+
+    result.AverageNormalError  = float(sumNormal  / double(count));
+    result.AverageTangentError = float(sumTangent / double(count));
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      許容誤差を満たす最も小さいフォーマットを選択します.
+//-----------------------------------------------------------------------------
+TANGENT_FORMAT SelectTangentFormat
+(
+    const asdx::Vector3*                    pNormals,
+    const asdx::Vector4*                    pTangents,
+    uint32_t                                count,
+    float                                   maxErrorDegree,
+    std::vector<TangentErrorStatistics>*    pStatistics
+)
+{
+    std::vector<TangentErrorStatistics> statistics;
+    statistics.reserve(TANGENT_FORMAT_COUNT);
+
+    for (auto i = 0; i < TANGENT_FORMAT_COUNT; ++i)
+    { statistics.push_back(ComputeTangentError(TANGENT_FORMAT(i), pNormals, pTangents, count)); }
+
+    auto MaxError = [](const TangentErrorStatistics& value)
+    {
+        return std::max(std::max(value.MaxNormalError, value.MaxTangentError), value.MaxBitangentError);
+    };
+
+    // 許容誤差を満たすものの中でサイズ優先, 同じサイズなら誤差の小さいものを選ぶ.
+    auto best = -1;
+    for (auto i = 0; i < TANGENT_FORMAT_COUNT; ++i)
+    {
+        const auto& value = statistics[i];
+        if (MaxError(value) > maxErrorDegree || value.SignMismatchCount > 0)
+        { continue; }
+
+        if (best < 0
+         || value.BytesPerVertex < statistics[best].BytesPerVertex
+         || (value.BytesPerVertex == statistics[best].BytesPerVertex && MaxError(value) < MaxError(statistics[best])))
+        { best = i; }
+    }
+
+    if (best < 0)
+    {
+        best = 0;
+        for (auto i = 1; i < TANGENT_FORMAT_COUNT; ++i)
+        {
+            if (MaxError(statistics[i]) < MaxError(statistics[best]))
+            { best = i; }
+        }
+    }
+
+    if (pStatistics != nullptr)
+    { *pStatistics = statistics; }
+
+    return TANGENT_FORMAT(best);
+}
@@ -0,0 +1,370 @@
+﻿//-----------------------------------------------------------------------------
+// File : TangentSpace.cpp
+// Desc : Angle Weighted Tangent Generation.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <TangentSpace.h>
+#include <fnd/asdxLogger.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <cmath>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const float kEpsilon = 1.17549435e-38f;  // MikkTSpace の NotZero() と同じ閾値.
+
+///////////////////////////////////////////////////////////////////////////////
+// TriangleInfo structure
+///////////////////////////////////////////////////////////////////////////////
+struct TriangleInfo
+{
+    asdx::Vector3   Os;             // 正規化した dP/du.
+    bool            Preserving;     // UVの向きが保存されているかどうか.
+    bool            Degenerate;     // UV上の面積が無いかどうか.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// VertexGroup structure
+///////////////////////////////////////////////////////////////////////////////
+struct VertexGroup
+{
+    asdx::Vector3   Sum;            // 角度で重み付けした接線の和.
+    float           Weight;         // 重みの和.
+};
+
+//-----------------------------------------------------------------------------
+//      ゼロでないかどうかチェックします.
+//-----------------------------------------------------------------------------
+inline bool NotZero(float value)
+{ return fabsf(value) > kEpsilon; }
+
+//-----------------------------------------------------------------------------
+//      長さを求めます.
+//-----------------------------------------------------------------------------
+inline float Length(const asdx::Vector3& value)
+{ return sqrtf(value.x * value.x + value.y * value.y + value.z * value.z); }
+
+//-----------------------------------------------------------------------------
+//      内積を求めます.
+//-----------------------------------------------------------------------------
+inline float Dot(const asdx::Vector3& a, const asdx::Vector3& b)
+{ return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+//-----------------------------------------------------------------------------
+//      正規化します(ゼロベクトルはそのまま返却します).
+//-----------------------------------------------------------------------------
+inline asdx::Vector3 SafeNormalize(const asdx::Vector3& value)
+{
+    auto length = Length(value);
+    if (!NotZero(length))
+    { return value; }
+
+    return value * (1.0f / length);
+}
+
+//-----------------------------------------------------------------------------
+//      法線に直交する任意の接線を求めます.
+//-----------------------------------------------------------------------------
+asdx::Vector3 OrthogonalTangent(const asdx::Vector3& normal)
+{
+    auto axis = (fabsf(normal.x) > 0.9f)
+        ? asdx::Vector3(0.0f, 1.0f, 0.0f)
+        : asdx::Vector3(1.0f, 0.0f, 0.0f);
+    return SafeNormalize(axis - normal * Dot(normal, axis));
+}
+
+//-----------------------------------------------------------------------------
+//      三角形ごとの接線を求めます.
+//-----------------------------------------------------------------------------
+TriangleInfo EvalTriangle
+(
+    const asdx::Vector3*    pPositions,
+    const asdx::Vector2*    pTexCoords,
+    uint32_t                i0,
+    uint32_t                i1,
+    uint32_t                i2
+)
+{
+    TriangleInfo result = {};
+
+    const auto& p0 = pPositions[i0];
+    const auto& t0 = pTexCoords[i0];
+
+    auto d1 = pPositions[i1] - p0;
+    auto d2 = pPositions[i2] - p0;
+
+    auto t21x = pTexCoords[i1].x - t0.x;
+    auto t21y = pTexCoords[i1].y - t0.y;
+    auto t31x = pTexCoords[i2].x - t0.x;
+    auto t31y = pTexCoords[i2].y - t0.y;
+
+    auto signedArea = t21x * t31y - t21y * t31x;
+    auto os = d1 * t31y - d2 * t21y;
+
+    result.Preserving = (signedArea > 0.0f);
+    result.Degenerate = !NotZero(signedArea);
+
+    auto lengthOs = Length(os);
+    if (result.Degenerate || !NotZero(lengthOs))
+    {
+        result.Degenerate = true;
+        result.Os = asdx::Vector3(0.0f, 0.0f, 0.0f);
+        return result;
+    }
+
+    // 鏡像の場合も dP/du の向きになるよう符号を掛ける.
+    auto s = (result.Preserving) ? 1.0f : -1.0f;
+    result.Os = os * (s / lengthOs);
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      三角形の角における重みを求めます.
+//-----------------------------------------------------------------------------
+float CornerAngle
+(
+    const asdx::Vector3&    normal,
+    const asdx::Vector3&    p,
+    const asdx::Vector3&    prev,
+    const asdx::Vector3&    next
+)
+{
+    auto e1 = prev - p;
+    auto e2 = next - p;
+
+    // 接平面に射影してから角度を求める.
+    e1 = SafeNormalize(e1 - normal * Dot(normal, e1));
+    e2 = SafeNormalize(e2 - normal * Dot(normal, e2));
+
+    auto c = Dot(e1, e2);
+    c = (c < -1.0f) ? -1.0f : ((c > 1.0f) ? 1.0f : c);
+    return acosf(c);
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      角度で重み付けした頂点ごとの接線ベクトルを生成します.
+//-----------------------------------------------------------------------------
+bool GenerateTangents
+(
+    const asdx::Vector3*    pPositions,
+    const asdx::Vector3*    pNormals,
+    const asdx::Vector2*    pTexCoords,
+    uint32_t                vertexCount,
+    const uint32_t*         pIndices,
+    uint32_t                indexCount,
+    TangentSpaceData&       result
+)
+{
+    result.Tangents   .clear();
+    result.VertexRemap.clear();
+    result.Indices    .clear();
+    result.SplitCount = 0;
+
+    if (pPositions == nullptr || pNormals == nullptr || pIndices == nullptr || (indexCount % 3) != 0)
+    {
+        ELOG("Error : Invalid Argument.");
+        return false;
+    }
+
+    for (auto i = 0u; i < indexCount; ++i)
+    {
+        if (pIndices[i] >= vertexCount)
+        {
+            ELOG("Error : Index Out Of Range. index = %u, vertexCount = %u", pIndices[i], vertexCount);
+            return false;
+        }
+    }
+
+    result.Tangents   .resize(vertexCount);
+    result.VertexRemap.resize(vertexCount);
+    result.Indices    .assign(pIndices, pIndices + indexCount);
+
+    for (auto i = 0u; i < vertexCount; ++i)
+    { result.VertexRemap[i] = i; }
+
+    // テクスチャ座標が無い場合は任意の接線とする.
+    if (pTexCoords == nullptr)
+    {
+        for (auto i = 0u; i < vertexCount; ++i)
+        {
+            auto t = OrthogonalTangent(pNormals[i]);
+            result.Tangents[i] = asdx::Vector4(t.x, t.y, t.z, 1.0f);
+        }
+        return true;
+    }
+
+    auto triangleCount = indexCount / 3;
+
+    // 三角形ごとの接線.
+    std::vector<TriangleInfo> triangles(triangleCount);
+    for (auto i = 0u; i < triangleCount; ++i)
+    {
+        triangles[i] = EvalTriangle(
+            pPositions,
+            pTexCoords,
+            pIndices[i * 3 + 0],
+            pIndices[i * 3 + 1],
+            pIndices[i * 3 + 2]);
+    }
+
+    // 頂点ごとに向き別で角度重み付き平均を取る. [0]:鏡像, [1]:保存.
+    std::vector<VertexGroup> groups(size_t(vertexCount) * 2);
+    for (auto& group : groups)
+    {
+        group.Sum    = asdx::Vector3(0.0f, 0.0f, 0.0f);
+        group.Weight = 0.0f;
+    }
+
+    for (auto i = 0u; i < triangleCount; ++i)
+    {
+        const auto& tri = triangles[i];
+        if (tri.Degenerate)
+        { continue; }
+
+        for (auto c = 0u; c < 3; ++c)
+        {
+            auto v    = pIndices[i * 3 + c];
+            auto prev = pIndices[i * 3 + (c + 2) % 3];
+            auto next = pIndices[i * 3 + (c + 1) % 3];
+
+            const auto& n = pNormals[v];
+            auto os = SafeNormalize(tri.Os - n * Dot(n, tri.Os));
+            auto angle = CornerAngle(n, pPositions[v], pPositions[prev], pPositions[next]);
+
+            auto& group = groups[v * 2 + (tri.Preserving ? 1 : 0)];
+            group.Sum    += os * angle;
+            group.Weight += angle;
+        }
+    }
+
+    // 両方の向きから参照される頂点は重みの小さい方を分割する.
+    std::vector<uint32_t> splitVertex(vertexCount, UINT32_MAX);
+    std::vector<uint8_t>  primary(vertexCount, 1);
+
+    for (auto v = 0u; v < vertexCount; ++v)
+    {
+        const auto& mirror   = groups[v * 2 + 0];
+        const auto& preserve = groups[v * 2 + 1];
+
+        primary[v] = (preserve.Weight >= mirror.Weight) ? 1 : 0;
+
+        auto ToTangent = [&](const VertexGroup& group, float sign)
+        {
+            auto t = SafeNormalize(group.Sum);
+            if (!NotZero(Length(t)))
+            { t = OrthogonalTangent(pNormals[v]); }
+            return asdx::Vector4(t.x, t.y, t.z, sign);
+        };
+
+        const auto& main = (primary[v] != 0) ? preserve : mirror;
+        result.Tangents[v] = ToTangent(main, (primary[v] != 0) ? 1.0f : -1.0f);
+
+        if (mirror.Weight > 0.0f && preserve.Weight > 0.0f)
+        {
+            const auto& sub = (primary[v] != 0) ? mirror : preserve;
+            splitVertex[v] = uint32_t(result.Tangents.size());
+            result.Tangents   .push_back(ToTangent(sub, (primary[v] != 0) ? -1.0f : 1.0f));
+            result.VertexRemap.push_back(v);
+            result.SplitCount++;
+        }
+    }
+
+    // 分割した頂点を参照するようインデックスを書き換え.
+    // UV上の面積が無い三角形は元の頂点の向きに従う.
+    if (result.SplitCount > 0)
+    {
+        for (auto i = 0u; i < triangleCount; ++i)
+        {
+            const auto& tri = triangles[i];
+            if (tri.Degenerate)
+            { continue; }
+
+            auto preserving = uint8_t(tri.Preserving ? 1 : 0);
+            for (auto c = 0u; c < 3; ++c)
+            {
+                auto& index = result.Indices[i * 3 + c];
+                if (splitVertex[index] != UINT32_MAX && primary[index] != preserving)
+                { index = splitVertex[index]; }
+            }
+        }
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      メッシュごとに並列で接線ベクトルを生成します.
+//-----------------------------------------------------------------------------
+bool GenerateTangents
+(
+    const asdx::ResModel&           model,
+    std::vector<TangentSpaceData>&  results
+)
+{
+    auto meshCount = uint32_t(model.Meshes.size());
+
+    results.clear();
+    results.resize(meshCount);
+
+    if (meshCount == 0)
+    { return true; }
+
+    std::atomic<uint32_t> next(0);
+    std::atomic<bool>     succeeded(true);
+
+    auto worker = [&]()
+    {
+        for (auto i = next++; i < meshCount; i = next++)
+        {
+            const auto& mesh = model.Meshes[i];
+            auto vertexCount = uint32_t(mesh.Positions.size());
+
+            if (mesh.Normals.size() != vertexCount)
+            {
+                ELOG("Error : Normals Not Found. mesh = %u", i);
+                succeeded = false;
+                continue;
+            }
+
+            auto pTexCoords = (mesh.TexCoords[0].size() == vertexCount)
+                ? mesh.TexCoords[0].data()
+                : nullptr;
+
+            if (!GenerateTangents(
+                mesh.Positions.data(),
+                mesh.Normals.data(),
+                pTexCoords,
+                vertexCount,
+                mesh.Indices.data(),
+                uint32_t(mesh.Indices.size()),
+                results[i]))
+            { succeeded = false; }
+        }
+    };
+
+    auto threadCount = std::min(std::max(std::thread::hardware_concurrency(), 1u), meshCount);
+
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount - 1);
+    for (auto i = 1u; i < threadCount; ++i)
+    { threads.emplace_back(worker); }
+
+    worker();
+
+    for (auto& thread : threads)
+    { thread.join(); }
+
+    return succeeded;
+}